@@ -0,0 +1,93 @@
+/// <reference path="../../node_modules/babylonjs/babylon.module.d.ts" />
+
+let engine = null;
+let scene = null;
+let outputTexture = null;
+let outputWidth = 0;
+let outputHeight = 0;
+let sceneFactory = null;
+
+/**
+ * Creates the engine that every scene in the batch shares. Keeping one engine
+ * (and so one set of compiled programs and one warmed shader cache) alive
+ * across scenes is the point of rendering them in a single process.
+ */
+function startup(width, height) {
+    engine = new BABYLON.NativeEngine();
+    outputWidth = width;
+    outputHeight = height;
+}
+
+/**
+ * Receives the `createScene` defined by a scene script. The app evaluates each
+ * scene script in a function scope of its own and passes on what it defined,
+ * so scenes may declare it with function, var, let or const.
+ */
+function setSceneFactory(factory) {
+    sceneFactory = factory;
+}
+
+/**
+ * Runs the `createScene(engine)` function defined by the scene script that was
+ * loaded just before this call, disposing the previous scene first.
+ */
+async function loadSceneAsync() {
+    if (scene) {
+        scene.dispose();
+        scene = null;
+        outputTexture = null;
+    }
+
+    // Taken, so a later script that fails before defining one fails loudly
+    // instead of silently re-rendering the previous scene.
+    const factory = sceneFactory;
+    sceneFactory = null;
+
+    if (typeof factory !== "function") {
+        throw new Error("Scene script did not define a createScene(engine) function.");
+    }
+
+    scene = await factory(engine);
+    if (!scene) {
+        throw new Error("createScene(engine) did not return a scene.");
+    }
+
+    if (!scene.activeCamera) {
+        scene.createDefaultCamera(true, true);
+    }
+
+    outputTexture = new BABYLON.RenderTargetTexture(
+        "outputTexture",
+        {
+            width: outputWidth,
+            height: outputHeight,
+        },
+        scene,
+        {
+            generateDepthBuffer: true,
+            generateStencilBuffer: true,
+        }
+    );
+    scene.activeCamera.outputRenderTarget = outputTexture;
+}
+
+/**
+ * Waits until every material, texture and effect in the scene is ready, which
+ * is where shader compilation (or shader cache hits) happens.
+ */
+async function warmUpSceneAsync() {
+    await scene.whenReadyAsync();
+}
+
+/**
+ * Renders one frame into the output texture and, when a path is given, reads
+ * it back and writes it out as a PNG.
+ */
+async function renderSceneAsync(outputPath) {
+    scene.render();
+
+    if (outputPath) {
+        const pixels = await outputTexture.readPixels();
+        TestUtils.writePNG(new Uint8Array(pixels.buffer, pixels.byteOffset, pixels.byteLength), outputWidth, outputHeight, outputPath);
+    }
+}
@@ -0,0 +1,440 @@
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Graphics/Device.h>
+#include <Babylon/ScriptLoader.h>
+#include <Babylon/Plugins/NativeEngine.h>
+#include <Babylon/Plugins/ShaderCache.h>
+#include <Babylon/Plugins/TestUtils.h>
+#include <Babylon/Polyfills/Console.h>
+#include <Babylon/Polyfills/Window.h>
+#include <Babylon/Polyfills/XMLHttpRequest.h>
+
+#include "Surface.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    struct Options
+    {
+        bool Noop{false};
+        uint32_t Width{1024};
+        uint32_t Height{1024};
+        std::filesystem::path OutputDirectory{};
+        std::filesystem::path ShaderCachePath{};
+        std::vector<std::filesystem::path> Scenes{};
+    };
+
+    struct SceneTimings
+    {
+        double LoadMs{};
+        double WarmUpMs{};
+        double RenderMs{};
+    };
+
+    void PrintUsage(const char* argv0)
+    {
+        std::printf("Renders a batch of Babylon.js scenes headlessly with one graphics device and JavaScript runtime.\n\n");
+        std::printf("Usage: %s [options] <scene.js>...\n\n", argv0);
+        std::printf("Each scene script must define a createScene(engine) function returning a scene (or a promise of one).\n\n");
+        std::printf("Options:\n");
+        std::printf("  --noop                 Use the Noop renderer. Only timings are reported; no images are written.\n");
+        std::printf("  --width <pixels>       Output width (default 1024).\n");
+        std::printf("  --height <pixels>      Output height (default 1024).\n");
+        std::printf("  --output <directory>   Directory for the output PNGs (default: Output next to the executable).\n");
+        std::printf("  --shader-cache <file>  Load the shader cache from this file before the first scene and save it after the last.\n");
+        std::printf("  --list <file>          Read additional scene script paths from this file, one per line.\n");
+        std::printf("  --help                 Show this message.\n");
+    }
+
+    std::filesystem::path GetExecutableDirectory(const char* argv0)
+    {
+#if defined(__linux__)
+        (void)argv0;
+        return std::filesystem::canonical("/proc/self/exe").parent_path();
+#else
+        return std::filesystem::absolute(argv0).parent_path();
+#endif
+    }
+
+    std::optional<Options> ParseCommandLine(int argc, const char* const* argv)
+    {
+        Options options{};
+        options.OutputDirectory = GetExecutableDirectory(argv[0]) / "Output";
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg{argv[i]};
+            const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+            if (arg == "--help" || arg == "-h")
+            {
+                return {};
+            }
+            else if (arg == "--noop")
+            {
+                options.Noop = true;
+            }
+            else if ((arg == "--width" || arg == "--height") && value != nullptr)
+            {
+                const auto pixels = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+                if (pixels == 0)
+                {
+                    std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                    return {};
+                }
+                (arg == "--width" ? options.Width : options.Height) = pixels;
+                ++i;
+            }
+            else if (arg == "--output" && value != nullptr)
+            {
+                options.OutputDirectory = value;
+                ++i;
+            }
+            else if (arg == "--shader-cache" && value != nullptr)
+            {
+                options.ShaderCachePath = value;
+                ++i;
+            }
+            else if (arg == "--list" && value != nullptr)
+            {
+                std::ifstream list{value};
+                if (!list)
+                {
+                    std::cerr << "Unable to open scene list " << value << std::endl;
+                    return {};
+                }
+
+                std::string line;
+                while (std::getline(list, line))
+                {
+                    if (!line.empty() && line.back() == '\r')
+                    {
+                        line.pop_back();
+                    }
+                    if (!line.empty() && line.front() != '#')
+                    {
+                        options.Scenes.emplace_back(line);
+                    }
+                }
+                ++i;
+            }
+            else if (arg.substr(0, 2) == "--")
+            {
+                std::cerr << "Unknown or incomplete option " << arg << std::endl;
+                return {};
+            }
+            else
+            {
+                options.Scenes.emplace_back(arg);
+            }
+        }
+
+        if (options.Scenes.empty())
+        {
+            std::cerr << "No scenes given." << std::endl;
+            return {};
+        }
+
+        return options;
+    }
+
+    // A file:/// URL for a local path, as ScriptLoader expects URLs rather than paths.
+    std::string GetUrlFromPath(const std::filesystem::path& path)
+    {
+        const auto utf8 = std::filesystem::absolute(path).generic_u8string();
+        const std::string absolute{utf8.begin(), utf8.end()};
+
+        std::string url{"file://"};
+        if (absolute.empty() || absolute.front() != '/')
+        {
+            // A drive letter, as in file:///C:/Scenes/scene.js.
+            url += '/';
+        }
+
+        constexpr char hex[] = "0123456789ABCDEF";
+        for (const auto character : absolute)
+        {
+            const auto byte = static_cast<unsigned char>(character);
+            if (std::isalnum(byte) || std::string_view{"/:-._~!$&'()*+,;="}.find(static_cast<char>(byte)) != std::string_view::npos)
+            {
+                url += static_cast<char>(byte);
+            }
+            else
+            {
+                url += '%';
+                url += hex[byte >> 4];
+                url += hex[byte & 0xF];
+            }
+        }
+        return url;
+    }
+
+    // Evaluates the scene script at `path` in a function scope of its own, so the names it
+    // declares, createScene included, cannot clash with those of the scenes before it. The
+    // createScene it defines is handed to setSceneFactory for loadSceneAsync to call.
+    void LoadSceneScript(Babylon::ScriptLoader& loader, const std::filesystem::path& path)
+    {
+        std::ifstream stream{path, std::ios::binary};
+        if (!stream)
+        {
+            throw std::runtime_error{"Unable to open " + path.string()};
+        }
+
+        std::string source{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+        if (source.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        {
+            source.erase(0, 3);
+        }
+
+        // The wrapper opens on the first line, so errors keep the line numbers of the file.
+        loader.Eval("setSceneFactory((function () { " + source + "\nreturn typeof createScene === \"function\" ? createScene : undefined;\n})());", GetUrlFromPath(path));
+    }
+
+    // Uncaught JavaScript errors, reported from the JavaScript thread. They fail the scene that
+    // is being rendered rather than the whole batch.
+    class UncaughtErrors
+    {
+    public:
+        void Report(std::string message)
+        {
+            std::scoped_lock lock{m_mutex};
+            if (!m_message)
+            {
+                m_message = std::move(message);
+            }
+        }
+
+        // Throws the first error reported since the last call, if any.
+        void ThrowIfAny()
+        {
+            std::scoped_lock lock{m_mutex};
+            if (m_message)
+            {
+                const std::string message{"Uncaught error: " + *m_message};
+                m_message.reset();
+                throw std::runtime_error{message};
+            }
+        }
+
+    private:
+        std::mutex m_mutex{};
+        std::optional<std::string> m_message{};
+    };
+
+    // Calls the global async JavaScript function `name` and returns a future
+    // that completes when its promise settles. A rejection surfaces as an
+    // exception from the future so one broken scene does not end the batch.
+    std::future<void> CallAsync(Babylon::ScriptLoader& loader, std::string name, std::function<std::vector<napi_value>(Napi::Env)> getArgs = {})
+    {
+        auto promise = std::make_shared<std::promise<void>>();
+        auto future = promise->get_future();
+
+        loader.Dispatch([promise, name = std::move(name), getArgs = std::move(getArgs)](Napi::Env env) {
+            try
+            {
+                const auto args = getArgs ? getArgs(env) : std::vector<napi_value>{};
+                auto jsPromise = env.Global().Get(name).As<Napi::Function>().Call(args).As<Napi::Promise>();
+
+                auto jsOnFulfilled = Napi::Function::New(env, [promise](const Napi::CallbackInfo&) {
+                    promise->set_value();
+                });
+
+                auto jsOnRejected = Napi::Function::New(env, [promise](const Napi::CallbackInfo& info) {
+                    const auto message = info[0].ToString().Utf8Value();
+                    promise->set_exception(std::make_exception_ptr(std::runtime_error{message}));
+                });
+
+                jsPromise.Get("then").As<Napi::Function>().Call(jsPromise, {jsOnFulfilled, jsOnRejected});
+            }
+            catch (const Napi::Error& error)
+            {
+                promise->set_exception(std::make_exception_ptr(std::runtime_error{error.Message()}));
+            }
+        });
+
+        return future;
+    }
+
+    // Keeps frames flowing while waiting: the JavaScript side only makes
+    // progress on GPU work (texture uploads, readbacks) as frames complete.
+    // An uncaught error ends the wait, as the promise may never settle.
+    double PumpFramesUntil(Babylon::Graphics::Device& device, std::future<void>& future, UncaughtErrors& errors)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        while (future.wait_for(1ms) != std::future_status::ready)
+        {
+            errors.ThrowIfAny();
+            device.FinishRenderingCurrentFrame();
+            device.StartRenderingCurrentFrame();
+        }
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        future.get();
+        errors.ThrowIfAny();
+        return elapsed;
+    }
+}
+
+int main(int argc, const char* const* argv)
+{
+    const auto options = ParseCommandLine(argc, argv);
+    if (!options)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // The cache is process-wide, so every scene after the first reuses the
+    // shaders the earlier ones compiled.
+    Babylon::Plugins::ShaderCache::Enable();
+    if (!options->ShaderCachePath.empty() && std::filesystem::exists(options->ShaderCachePath))
+    {
+        std::ifstream stream{options->ShaderCachePath, std::ios::binary};
+        const auto count = Babylon::Plugins::ShaderCache::Load(stream);
+        std::cout << "Loaded " << count << " shaders from " << options->ShaderCachePath.string() << std::endl;
+    }
+
+    // The Noop renderer is selected by a configuration with no window and no
+    // size, which also means there is nothing to read back.
+    std::optional<Surface> surface{};
+    Babylon::Graphics::Configuration config{};
+    if (!options->Noop)
+    {
+        surface.emplace(options->Width, options->Height);
+        config.Window = surface->GetWindow();
+        config.Width = options->Width;
+        config.Height = options->Height;
+        std::filesystem::create_directories(options->OutputDirectory);
+    }
+
+    Babylon::Graphics::Device device{config};
+    device.StartRenderingCurrentFrame();
+
+    UncaughtErrors errors{};
+
+    Babylon::AppRuntime::Options runtimeOptions{};
+    runtimeOptions.UnhandledExceptionHandler = [&errors](const Napi::Error& error) {
+        const auto message = Napi::GetErrorString(error);
+        std::cerr << "[Uncaught Error] " << message << std::endl;
+        errors.Report(message);
+    };
+
+    Babylon::AppRuntime runtime{runtimeOptions};
+    runtime.Dispatch([&device, window = config.Window](Napi::Env env) {
+        device.AddToJavaScript(env);
+
+        Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+            std::cout << message << std::endl;
+        });
+
+        Babylon::Polyfills::Window::Initialize(env);
+        Babylon::Polyfills::XMLHttpRequest::Initialize(env);
+        Babylon::Plugins::NativeEngine::Initialize(env);
+        Babylon::Plugins::TestUtils::Initialize(env, window);
+    });
+
+    Babylon::ScriptLoader loader{runtime};
+    loader.LoadScript("app:///Scripts/babylon.max.js");
+    loader.LoadScript("app:///Scripts/babylonjs.loaders.js");
+    loader.LoadScript("app:///Scripts/index.js");
+
+    std::promise<void> startup{};
+    loader.Dispatch([&startup, width = options->Width, height = options->Height](Napi::Env env) {
+        env.Global().Get("startup").As<Napi::Function>().Call({Napi::Value::From(env, width), Napi::Value::From(env, height)});
+        startup.set_value();
+    });
+
+    auto startupFuture = startup.get_future();
+    try
+    {
+        const auto startupMs = PumpFramesUntil(device, startupFuture, errors);
+        std::cout << "Startup: " << startupMs << " ms" << std::endl;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Startup failed: " << ex.what() << std::endl;
+        device.FinishRenderingCurrentFrame();
+        return 1;
+    }
+
+    int failures{0};
+    SceneTimings total{};
+    for (const auto& scenePath : options->Scenes)
+    {
+        const auto sceneName = scenePath.stem().string();
+        SceneTimings timings{};
+
+        try
+        {
+            // Load: evaluating the scene script plus createScene(), including
+            // any assets it imports.
+            LoadSceneScript(loader, scenePath);
+            auto load = CallAsync(loader, "loadSceneAsync");
+            timings.LoadMs = PumpFramesUntil(device, load, errors);
+
+            // Warm-up: whenReadyAsync(), which is where shaders are compiled
+            // or served from the cache.
+            auto warmUp = CallAsync(loader, "warmUpSceneAsync");
+            timings.WarmUpMs = PumpFramesUntil(device, warmUp, errors);
+
+            // Render: one frame plus, with a real renderer, the readback and
+            // PNG encode.
+            std::string outputPath{};
+            if (!options->Noop)
+            {
+                outputPath = (options->OutputDirectory / (sceneName + ".png")).string();
+            }
+            auto render = CallAsync(loader, "renderSceneAsync", [outputPath](Napi::Env env) {
+                return std::vector<napi_value>{outputPath.empty() ? env.Null() : Napi::Value{Napi::String::New(env, outputPath)}};
+            });
+            timings.RenderMs = PumpFramesUntil(device, render, errors);
+        }
+        catch (const std::exception& ex)
+        {
+            std::cerr << "[" << sceneName << "] failed: " << ex.what() << std::endl;
+            ++failures;
+            continue;
+        }
+
+        total.LoadMs += timings.LoadMs;
+        total.WarmUpMs += timings.WarmUpMs;
+        total.RenderMs += timings.RenderMs;
+
+        std::printf("[%s] load %.2f ms, warm-up %.2f ms, render %.2f ms\n", sceneName.c_str(), timings.LoadMs, timings.WarmUpMs, timings.RenderMs);
+        std::fflush(stdout);
+    }
+
+    std::printf("Rendered %zu of %zu scenes: load %.2f ms, warm-up %.2f ms, render %.2f ms\n",
+        options->Scenes.size() - static_cast<size_t>(failures), options->Scenes.size(), total.LoadMs, total.WarmUpMs, total.RenderMs);
+
+    device.FinishRenderingCurrentFrame();
+
+    if (!options->ShaderCachePath.empty())
+    {
+        std::ofstream stream{options->ShaderCachePath, std::ios::binary};
+        const auto count = Babylon::Plugins::ShaderCache::Save(stream);
+        std::cout << "Saved " << count << " shaders to " << options->ShaderCachePath.string() << std::endl;
+    }
+
+    Babylon::Plugins::ShaderCache::Disable();
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+#include "Surface.h"
+
+// Renderers on these platforms create their device without a swap chain when
+// no window is supplied, so the surface is just the configured size.
+Surface::Surface(uint32_t, uint32_t)
+{
+}
+
+Surface::~Surface() = default;
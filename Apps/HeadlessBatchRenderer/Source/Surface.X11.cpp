@@ -0,0 +1,34 @@
+#include "Surface.h"
+
+#include <X11/Xlib.h> // will include X11 which #defines None... Don't mess with order of includes.
+#include <X11/Xutil.h>
+#undef None
+
+#include <stdexcept>
+
+Surface::Surface(uint32_t width, uint32_t height)
+{
+    XInitThreads();
+    Display* display = XOpenDisplay(nullptr);
+    if (display == nullptr)
+    {
+        throw std::runtime_error{"Unable to open an X display. Set DISPLAY (e.g. run under Xvfb) or pass --noop."};
+    }
+
+    const int32_t screen = DefaultScreen(display);
+    XSetWindowAttributes windowAttrs{};
+    const Window window = XCreateWindow(display, RootWindow(display, screen), 0, 0, width, height, 0,
+        DefaultDepth(display, screen), InputOutput, DefaultVisual(display, screen), CWBorderPixel, &windowAttrs);
+
+    // The window is deliberately never mapped; it only exists to give the
+    // OpenGL context a drawable. Rendering goes to an offscreen target.
+    m_window = window;
+    m_platformState = display;
+}
+
+Surface::~Surface()
+{
+    auto* display = static_cast<Display*>(m_platformState);
+    XDestroyWindow(display, static_cast<Window>(m_window));
+    XCloseDisplay(display);
+}
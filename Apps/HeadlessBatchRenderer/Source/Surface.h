@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Babylon/Graphics/Device.h>
+
+#include <cstdint>
+
+// A render surface the graphics device can be created against without ever
+// being presented. Some renderers (D3D11, Metal) run headless with no window
+// at all; OpenGL on X11 needs a drawable to make its context current, so that
+// platform backs the surface with a window that is never mapped.
+class Surface final
+{
+public:
+    Surface(uint32_t width, uint32_t height);
+    ~Surface();
+
+    Surface(const Surface&) = delete;
+    Surface& operator=(const Surface&) = delete;
+
+    Babylon::Graphics::WindowT GetWindow() const
+    {
+        return m_window;
+    }
+
+private:
+    Babylon::Graphics::WindowT m_window{};
+    void* m_platformState{};
+};
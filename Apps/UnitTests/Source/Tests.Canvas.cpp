@@ -0,0 +1,1289 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Graphics/Device.h>
+#include <Babylon/Graphics/DeviceContext.h>
+#include <Babylon/Polyfills/Canvas.h>
+#include <Babylon/Polyfills/CanvasInternal.h>
+#include <Babylon/Polyfills/Console.h>
+#include <Babylon/Polyfills/Window.h>
+#include <Babylon/ScriptLoader.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    using Result = std::map<std::string, double>;
+
+    // Runs `script` in a fresh runtime with the Canvas polyfill on a headless (Noop) device,
+    // pumping frames until the script calls reportResult with an object of numbers. `setup` runs
+    // on the JavaScript thread before the script, e.g. to pass it data.
+    Result RunCanvasScript(const std::string& script, const std::string& name, std::function<void(Napi::Env)> setup = {})
+    {
+        Babylon::Graphics::Configuration config{};
+        Babylon::Graphics::Device device{config};
+
+        device.StartRenderingCurrentFrame();
+
+        std::optional<Babylon::Polyfills::Canvas> nativeCanvas;
+        std::promise<Result> resultPromise{};
+
+        Babylon::AppRuntime::Options options{};
+        options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+            std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+            std::quick_exit(1);
+        };
+
+        std::optional<Babylon::AppRuntime> runtime{std::in_place, options};
+        runtime->Dispatch([&device, &nativeCanvas, &resultPromise, setup = std::move(setup)](Napi::Env env) {
+            device.AddToJavaScript(env);
+
+            Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+                std::cout << message << std::endl;
+            });
+            Babylon::Polyfills::Window::Initialize(env);
+            nativeCanvas.emplace(Babylon::Polyfills::Canvas::Initialize(env));
+
+            env.Global().Set("reportResult", Napi::Function::New(env, [&resultPromise](const Napi::CallbackInfo& info) {
+                const auto object = info[0].As<Napi::Object>();
+                const auto names = object.GetPropertyNames();
+
+                Result result{};
+                for (uint32_t index = 0; index < names.Length(); ++index)
+                {
+                    const auto key = names.Get(index).As<Napi::String>();
+                    result[key.Utf8Value()] = object.Get(key).As<Napi::Number>().DoubleValue();
+                }
+                resultPromise.set_value(std::move(result));
+            }, "reportResult"));
+
+            if (setup)
+            {
+                setup(env);
+            }
+        });
+
+        Babylon::ScriptLoader loader{*runtime};
+        loader.Eval(script, name);
+
+        auto resultFuture{resultPromise.get_future()};
+        const auto start{std::chrono::steady_clock::now()};
+        while (resultFuture.wait_for(1ms) != std::future_status::ready)
+        {
+            device.FinishRenderingCurrentFrame();
+            device.StartRenderingCurrentFrame();
+
+            if (std::chrono::steady_clock::now() - start > 120s)
+            {
+                ADD_FAILURE() << name << " did not complete";
+                std::quick_exit(1);
+            }
+        }
+
+        // Runtime destructor joins the JS thread; must happen before Finish.
+        runtime.reset();
+        nativeCanvas.reset();
+
+        device.FinishRenderingCurrentFrame();
+
+        return resultFuture.get();
+    }
+}
+
+// One canvas cycling through three sizes with a blur filter. Every size keeps its own pooled
+// buffers, so after the first cycle every filter pass is a pool hit; sizes that then go unused
+// are trimmed away.
+TEST(Canvas, FrameBufferPoolMixedSizes)
+{
+    const auto result = RunCanvasScript(R"(
+        const canvas = new _native.Canvas();
+        const context = canvas.getContext("2d");
+        const sizes = [[64, 64], [128, 96], [256, 256]];
+
+        function drawFiltered(width, height) {
+            canvas.width = width;
+            canvas.height = height;
+            context.filter = "blur(4px)";
+            context.fillStyle = "red";
+            context.fillRect(0, 0, width / 2, height / 2);
+            context.flush();
+        }
+
+        for (const [width, height] of sizes) {
+            drawFiltered(width, height);
+        }
+        const firstCycle = canvas.getFrameBufferPoolStats();
+
+        for (let cycle = 0; cycle < 10; ++cycle) {
+            for (const [width, height] of sizes) {
+                drawFiltered(width, height);
+            }
+        }
+        const warm = canvas.getFrameBufferPoolStats();
+
+        // Long enough for the trim to drop the two sizes that are no longer used.
+        for (let i = 0; i < 200; ++i) {
+            drawFiltered(64, 64);
+        }
+        const trimmed = canvas.getFrameBufferPoolStats();
+
+        reportResult({
+            firstCycleMisses: firstCycle.misses,
+            firstCycleBuffers: firstCycle.buffers,
+            warmMisses: warm.misses,
+            warmHits: warm.hits,
+            warmEvictions: warm.evictions,
+            warmAcquired: warm.acquired,
+            trimmedBuffers: trimmed.buffers,
+            trimmedEvictions: trimmed.evictions,
+            trimmedBytes: trimmed.bytes,
+        });
+    )", "canvas_frame_buffer_pool.js");
+
+    EXPECT_GT(result.at("firstCycleMisses"), 0);
+    EXPECT_EQ(result.at("firstCycleBuffers"), result.at("firstCycleMisses"));
+    EXPECT_EQ(result.at("warmMisses"), result.at("firstCycleMisses"));
+    EXPECT_GT(result.at("warmHits"), 0);
+    EXPECT_EQ(result.at("warmEvictions"), 0);
+    EXPECT_EQ(result.at("warmAcquired"), 0);
+
+    // Only the 64x64 buffers survive.
+    EXPECT_LT(result.at("trimmedBuffers"), result.at("firstCycleBuffers"));
+    EXPECT_EQ(result.at("trimmedEvictions"), result.at("firstCycleBuffers") - result.at("trimmedBuffers"));
+    EXPECT_EQ(result.at("trimmedBytes"), result.at("trimmedBuffers") * 64 * 64 * 8);
+}
+
+// Counts the bgfx views each flush acquires. Unfiltered draw calls share the canvas' view,
+// including across a filtered call, whose final pass leaves the canvas bound to a view the
+// following calls keep drawing into. A filtered call costs one view per filter pass plus one
+// for its final pass: three for a two-pass gaussian blur, seven for a six-pass box blur.
+TEST(Canvas, ViewsPerFlush)
+{
+    constexpr int FILTERED_CALLS = 8;
+
+    const auto result = RunCanvasScript(R"(
+        const filteredCalls = )" + std::to_string(FILTERED_CALLS) + R"(;
+        const canvas = new _native.Canvas();
+        canvas.width = 128;
+        canvas.height = 128;
+        const context = canvas.getContext("2d");
+
+        function drawUnfiltered(count) {
+            context.filter = "none";
+            for (let i = 0; i < count; ++i) {
+                context.fillStyle = i % 2 ? "red" : "green";
+                context.fillRect(i % 100, i % 50, 20, 20);
+            }
+        }
+
+        function drawInterleaved(filter) {
+            drawUnfiltered(10);
+            for (let i = 0; i < filteredCalls; ++i) {
+                context.filter = filter;
+                context.fillStyle = "blue";
+                context.fillRect(32, 32, 64, 64);
+                drawUnfiltered(10);
+            }
+        }
+
+        drawUnfiltered(1000);
+        context.flush();
+        const cleared = context.getFlushStats().views;
+
+        drawUnfiltered(1000);
+        context.flush();
+        const unfiltered = context.getFlushStats().views;
+
+        context.flush();
+        const empty = context.getFlushStats().views;
+
+        drawInterleaved("blur(1px)");
+        context.flush();
+        const gaussian = context.getFlushStats().views;
+
+        drawInterleaved("blur(5px)");
+        context.flush();
+        const box = context.getFlushStats().views;
+
+        reportResult({ cleared, unfiltered, empty, gaussian, box });
+    )", "canvas_views_per_flush.js");
+
+    std::cout << "views per flush: cleared " << result.at("cleared") << ", unfiltered " << result.at("unfiltered")
+              << ", empty " << result.at("empty") << ", gaussian " << result.at("gaussian") << ", box " << result.at("box") << std::endl;
+
+    EXPECT_EQ(result.at("cleared"), 1);
+    EXPECT_EQ(result.at("unfiltered"), 1);
+    EXPECT_EQ(result.at("empty"), 0);
+    EXPECT_EQ(result.at("gaussian"), 1 + FILTERED_CALLS * 3);
+    EXPECT_EQ(result.at("box"), 1 + FILTERED_CALLS * 7);
+}
+
+// 50 contexts drawing text with one font, after its glyphs were prewarmed. The font data and the
+// glyph atlases are held once for the process, so the contexts add no glyph memory and their
+// first fillText does not rasterize or upload anything.
+TEST(Canvas, SharedGlyphCache)
+{
+    constexpr int CONTEXTS = 50;
+
+    std::ifstream file{UNIT_TESTS_FONT_PATH, std::ios::binary};
+    if (!file)
+    {
+        GTEST_SKIP() << "font not found at " << UNIT_TESTS_FONT_PATH;
+    }
+    const std::vector<uint8_t> fontData{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+    const auto result = RunCanvasScript(R"(
+        const contexts = )" + std::to_string(CONTEXTS) + R"(;
+        const characters = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789 .,:;!?";
+        _native.Canvas.loadTTF("droidsans", fontData);
+
+        function createContext() {
+            const canvas = new _native.Canvas();
+            canvas.width = 256;
+            canvas.height = 64;
+            const context = canvas.getContext("2d");
+            context.fillStyle = "black";
+            return context;
+        }
+
+        function firstFillText(context) {
+            const start = Date.now();
+            context.font = "16px droidsans";
+            context.fillText("Hello, glyph cache 0123", 4, 20);
+            context.font = "80px droidsans";
+            context.fillText("Hello", 4, 60);
+            context.flush();
+            return Date.now() - start;
+        }
+
+        // Sizes 16 and 80 fall in two different SDF buckets.
+        const cold = firstFillText(createContext());
+        _native.Canvas.prewarmGlyphs("droidsans", characters, [16, 80]);
+        const prewarmed = _native.Canvas.getGlyphCacheStats();
+
+        let warm = 0;
+        for (let i = 0; i < contexts; ++i) {
+            warm += firstFillText(createContext());
+        }
+        const shared = _native.Canvas.getGlyphCacheStats();
+
+        reportResult({
+            cold,
+            warm,
+            fonts: shared.fonts,
+            fontBytes: shared.fontBytes,
+            atlases: shared.atlases,
+            atlasBytes: shared.atlasBytes,
+            prewarmedAtlasBytes: prewarmed.atlasBytes,
+            prewarmedUploads: prewarmed.uploads,
+            uploads: shared.uploads,
+        });
+    )", "canvas_shared_glyph_cache.js", [&fontData](Napi::Env env) {
+        auto buffer = Napi::ArrayBuffer::New(env, fontData.size());
+        std::memcpy(buffer.Data(), fontData.data(), fontData.size());
+        env.Global().Set("fontData", buffer);
+    });
+
+    // Before, every context copied the font into its own stash and grew its own 512x512 atlas
+    // (CPU copy plus texture).
+    const double perContextBytes = result.at("fontBytes") + 512 * 512 * 2;
+    std::cout << "glyph memory for " << CONTEXTS << " contexts: " << result.at("fontBytes") + result.at("atlasBytes")
+              << " bytes shared (" << result.at("atlases") << " atlases), " << perContextBytes * CONTEXTS
+              << " bytes with a cache per context; first fillText " << result.at("cold") << " ms cold, "
+              << result.at("warm") / CONTEXTS << " ms per prewarmed context" << std::endl;
+
+    EXPECT_EQ(result.at("fonts"), 1);
+    EXPECT_EQ(result.at("fontBytes"), static_cast<double>(fontData.size()));
+    EXPECT_EQ(result.at("atlases"), 2);
+    EXPECT_EQ(result.at("atlasBytes"), result.at("prewarmedAtlasBytes"));
+    EXPECT_EQ(result.at("uploads"), result.at("prewarmedUploads"));
+}
+
+// One context records text and, before it flushes, another fills the same atlas until it grows.
+// The first context's draws sample the texture the atlas had when they were recorded, so that
+// texture is retired rather than destroyed, and only goes once both contexts have flushed.
+TEST(Canvas, GlyphAtlasGrowthWithPendingDraws)
+{
+    std::ifstream file{UNIT_TESTS_FONT_PATH, std::ios::binary};
+    if (!file)
+    {
+        GTEST_SKIP() << "font not found at " << UNIT_TESTS_FONT_PATH;
+    }
+    const std::vector<uint8_t> fontData{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+    const auto result = RunCanvasScript(R"(
+        _native.Canvas.loadTTF("droidsans", fontData);
+
+        function createContext() {
+            const canvas = new _native.Canvas();
+            canvas.width = 512;
+            canvas.height = 128;
+            const context = canvas.getContext("2d");
+            context.fillStyle = "black";
+            context.font = "80px droidsans";
+            return context;
+        }
+
+        const first = createContext();
+        const second = createContext();
+
+        first.fillText("Hi", 4, 100);
+        const recorded = _native.Canvas.getGlyphCacheStats();
+
+        // Large glyphs, so the 512x512 atlas of their bucket fills after a few of them.
+        second.fillText("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", 4, 100);
+        const grown = _native.Canvas.getGlyphCacheStats();
+
+        first.flush();
+        const firstFlushed = _native.Canvas.getGlyphCacheStats();
+
+        second.flush();
+        const secondFlushed = _native.Canvas.getGlyphCacheStats();
+
+        reportResult({
+            growths: grown.growths - recorded.growths,
+            recordedRetired: recorded.retiredTextures,
+            grownRetired: grown.retiredTextures,
+            firstFlushedRetired: firstFlushed.retiredTextures,
+            secondFlushedRetired: secondFlushed.retiredTextures,
+        });
+    )", "canvas_glyph_atlas_growth.js", [&fontData](Napi::Env env) {
+        auto buffer = Napi::ArrayBuffer::New(env, fontData.size());
+        std::memcpy(buffer.Data(), fontData.data(), fontData.size());
+        env.Global().Set("fontData", buffer);
+    });
+
+    ASSERT_GE(result.at("growths"), 1);
+    EXPECT_EQ(result.at("recordedRetired"), 0);
+
+    // Every texture the atlas moved off while draws were pending, the first one included.
+    EXPECT_EQ(result.at("grownRetired"), result.at("growths"));
+
+    // The second context also drew against the textures it grew out of, so they outlive the
+    // first flush.
+    EXPECT_EQ(result.at("firstFlushedRetired"), result.at("grownRetired"));
+    EXPECT_EQ(result.at("secondFlushedRetired"), 0);
+}
+
+// Several canvases of different sizes, alternating between a two-pass gaussian and a six-pass
+// box blur chain on every flush. Reports flush throughput and the pool hit rate.
+TEST(Canvas, FrameBufferPoolBenchmark)
+{
+    const auto result = RunCanvasScript(R"(
+        const sizes = [[96, 96], [200, 120], [256, 256], [512, 128]];
+        const flushesPerCanvas = 250;
+        const canvases = sizes.map(([width, height]) => {
+            const canvas = new _native.Canvas();
+            canvas.width = width;
+            canvas.height = height;
+            return { canvas, context: canvas.getContext("2d"), width, height };
+        });
+
+        const start = Date.now();
+        for (let i = 0; i < flushesPerCanvas; ++i) {
+            for (const { context, width, height } of canvases) {
+                context.filter = i % 2 ? "blur(1px)" : "blur(5px)";
+                context.fillStyle = "blue";
+                context.fillRect(width / 4, height / 4, width / 2, height / 2);
+                context.flush();
+            }
+        }
+        const elapsed = Date.now() - start;
+
+        let hits = 0;
+        let misses = 0;
+        for (const { canvas } of canvases) {
+            const stats = canvas.getFrameBufferPoolStats();
+            hits += stats.hits;
+            misses += stats.misses;
+        }
+
+        reportResult({ flushes: flushesPerCanvas * canvases.length, elapsed, hits, misses });
+    )", "canvas_frame_buffer_pool_benchmark.js");
+
+    const auto flushes = result.at("flushes");
+    const auto hits = result.at("hits");
+    const auto misses = result.at("misses");
+    std::cout << flushes << " filtered flushes in " << result.at("elapsed") << " ms ("
+              << flushes * 1000 / std::max(result.at("elapsed"), 1.0) << " flushes/s), pool hit rate "
+              << 100 * hits / (hits + misses) << "% (" << misses << " misses)" << std::endl;
+
+    // Each canvas only ever misses while its chain first reaches its deepest nesting.
+    EXPECT_GT(hits, misses * 100);
+}
+
+// Replays a command stream and checks the state it leaves behind through the regular getters,
+// then that a stream with a truncated command or an unknown opcode is rejected.
+TEST(Canvas, CommandBufferReplay)
+{
+    const auto result = RunCanvasScript(R"(
+        const Context = _native.Context;
+        const canvas = new _native.Canvas();
+        canvas.width = 64;
+        canvas.height = 64;
+        const context = canvas.getContext("2d");
+
+        const words = new Uint32Array(64);
+        const floats = new Float32Array(words.buffer);
+        let length = 0;
+        function command(opcode, ...args) {
+            words[length++] = opcode;
+            for (const arg of args) {
+                floats[length++] = arg;
+            }
+        }
+        function string(index) {
+            words[length++] = index;
+        }
+
+        command(Context.COMMAND_SAVE);
+        command(Context.COMMAND_SETFILLSTYLE); string(0);
+        command(Context.COMMAND_FILLRECT, 0, 0, 8, 8);
+        command(Context.COMMAND_RESTORE);
+        command(Context.COMMAND_SETSTROKESTYLE); string(1);
+        command(Context.COMMAND_SETLINEWIDTH, 3);
+        command(Context.COMMAND_SETGLOBALALPHA, 0.5);
+        command(Context.COMMAND_TRANSLATE, 10, 20);
+        command(Context.COMMAND_SCALE, 2, 2);
+        command(Context.COMMAND_BEGINPATH);
+        command(Context.COMMAND_MOVETO, 0, 0);
+        command(Context.COMMAND_LINETO, 8, 8);
+        command(Context.COMMAND_STROKE);
+        context.flush(words, length, ["red", "blue"]);
+
+        const transform = context.getTransform();
+
+        function rejects(stream) {
+            try {
+                context.submitCommands(stream, stream.length, []);
+                return 0;
+            } catch (e) {
+                return 1;
+            }
+        }
+
+        reportResult({
+            fillStyleRestored: context.fillStyle !== "red" ? 1 : 0,
+            strokeStyleBlue: context.strokeStyle === "blue" ? 1 : 0,
+            lineWidth: context.lineWidth,
+            globalAlpha: context.globalAlpha,
+            a: transform.a,
+            d: transform.d,
+            e: transform.e,
+            f: transform.f,
+            truncatedRejected: rejects(new Uint32Array([Context.COMMAND_MOVETO, 0])),
+            unknownRejected: rejects(new Uint32Array([0xffff])),
+            badStringRejected: rejects(new Uint32Array([Context.COMMAND_SETFILLSTYLE, 3])),
+        });
+    )", "canvas_command_buffer_replay.js");
+
+    EXPECT_EQ(result.at("fillStyleRestored"), 1);
+    EXPECT_EQ(result.at("strokeStyleBlue"), 1);
+    EXPECT_EQ(result.at("lineWidth"), 3);
+    EXPECT_EQ(result.at("globalAlpha"), 0.5);
+    EXPECT_EQ(result.at("a"), 2);
+    EXPECT_EQ(result.at("d"), 2);
+    EXPECT_EQ(result.at("e"), 10);
+    EXPECT_EQ(result.at("f"), 20);
+    EXPECT_EQ(result.at("truncatedRejected"), 1);
+    EXPECT_EQ(result.at("unknownRejected"), 1);
+    EXPECT_EQ(result.at("badStringRejected"), 1);
+}
+
+// Draws 50k line segments per frame through the method calls and through a command stream
+// encoded in a reused typed array and replayed by flush, and reports the time per frame of each.
+TEST(Canvas, CommandBufferBenchmark)
+{
+    const auto result = RunCanvasScript(R"(
+        const Context = _native.Context;
+        const segments = 50000;
+        const frames = 10;
+
+        const canvas = new _native.Canvas();
+        canvas.width = 512;
+        canvas.height = 512;
+        const context = canvas.getContext("2d");
+
+        function point(i) {
+            return [(i * 37) % 512, (i * 91) % 512];
+        }
+
+        function drawCalls() {
+            context.strokeStyle = "black";
+            context.lineWidth = 1;
+            context.beginPath();
+            for (let i = 0; i < segments; ++i) {
+                const [x0, y0] = point(i);
+                const [x1, y1] = point(i + 1);
+                context.moveTo(x0, y0);
+                context.lineTo(x1, y1);
+            }
+            context.stroke();
+            context.flush();
+        }
+
+        // Encoded every frame, as a polyfill would, into a buffer allocated once.
+        const words = new Uint32Array(segments * 6 + 16);
+        const floats = new Float32Array(words.buffer);
+        function drawCommands() {
+            let length = 0;
+            words[length++] = Context.COMMAND_SETSTROKESTYLE; words[length++] = 0;
+            words[length++] = Context.COMMAND_SETLINEWIDTH; floats[length++] = 1;
+            words[length++] = Context.COMMAND_BEGINPATH;
+            for (let i = 0; i < segments; ++i) {
+                const [x0, y0] = point(i);
+                const [x1, y1] = point(i + 1);
+                words[length++] = Context.COMMAND_MOVETO; floats[length++] = x0; floats[length++] = y0;
+                words[length++] = Context.COMMAND_LINETO; floats[length++] = x1; floats[length++] = y1;
+            }
+            words[length++] = Context.COMMAND_STROKE;
+            context.flush(words, length, ["black"]);
+        }
+
+        function measure(draw) {
+            draw(); // warm up
+            const start = Date.now();
+            for (let frame = 0; frame < frames; ++frame) {
+                draw();
+            }
+            return (Date.now() - start) / frames;
+        }
+
+        const calls = measure(drawCalls);
+        const commands = measure(drawCommands);
+        reportResult({ calls, commands, callViews: context.getFlushStats().views });
+    )", "canvas_command_buffer_benchmark.js");
+
+    std::cout << "50k line segments per frame: " << result.at("calls") << " ms with method calls, "
+              << result.at("commands") << " ms with a command stream" << std::endl;
+
+    // Both modes draw one stroke, so the command stream must not cost extra views.
+    EXPECT_EQ(result.at("callViews"), 1);
+}
+
+TEST(Canvas, Path2DTessellationCache)
+{
+    const auto result = RunCanvasScript(R"(
+        const Path2D = _native.Path2D;
+        const iconCount = 1000;
+        const frames = 5;
+
+        const canvas = new _native.Canvas();
+        canvas.width = 1024;
+        canvas.height = 1024;
+        const context = canvas.getContext("2d");
+
+        function makeTemplate(i) {
+            if (i % 2 === 0) {
+                const path = new Path2D();
+                path.moveTo(0, 16);
+                for (let petal = 0; petal < 8; ++petal) {
+                    const angle = (petal + 1) * Math.PI / 4;
+                    path.bezierCurveTo(8 + i, 4, 24, 8 - i, 16 + 16 * Math.sin(angle), 16 - 16 * Math.cos(angle));
+                }
+                path.closePath();
+                path.arc(16, 16, 4 + i % 5, 0, Math.PI * 2);
+                path.moveTo(4, 28);
+                path.quadraticCurveTo(16, 20 + i, 28, 28);
+                return path;
+            }
+            return new Path2D("M2 16 C2 4 14 2 16 " + (2 + i) + " C18 2 30 4 30 16 C30 28 18 30 16 30 C14 30 2 28 2 16 Z");
+        }
+
+        const templates = [];
+        for (let i = 0; i < 10; ++i) {
+            templates.push(makeTemplate(i));
+        }
+
+        const icons = [];
+        for (let i = 0; i < iconCount; ++i) {
+            icons.push(new Path2D(templates[i % templates.length]));
+        }
+
+        function draw(frame) {
+            context.clearRect(0, 0, canvas.width, canvas.height);
+            context.fillStyle = "orange";
+            context.strokeStyle = "black";
+            context.lineWidth = 1.5;
+            for (let i = 0; i < iconCount; ++i) {
+                context.save();
+                context.translate((i % 30) * 34 + frame, Math.floor(i / 30) * 30 + frame * 0.5);
+                context.fill(icons[i]);
+                context.stroke(icons[i]);
+                context.restore();
+            }
+            context.flush();
+        }
+
+        function measure() {
+            draw(0); // warm up
+            const start = Date.now();
+            for (let frame = 1; frame <= frames; ++frame) {
+                draw(frame);
+            }
+            return (Date.now() - start) / frames;
+        }
+
+        Path2D.setTessellationCacheEnabled(false);
+        const uncached = measure();
+        Path2D.setTessellationCacheEnabled(true);
+        const cached = measure();
+
+        let hits = 0, misses = 0;
+        for (const icon of icons) {
+            const stats = icon.getTessellationStats();
+            hits += stats.hits;
+            misses += stats.misses;
+        }
+
+        // A rotation is a new entry; changing the path drops them all.
+        const path = icons[0];
+        context.rotate(0.5);
+        context.fill(path);
+        context.setTransform(1, 0, 0, 1, 0, 0);
+        const rotatedEntries = path.getTessellationStats().entries;
+        path.lineTo(0, 0);
+        const entriesAfterChange = path.getTessellationStats().entries;
+        const missesBeforeRedraw = path.getTessellationStats().misses;
+        context.fill(path);
+        const missesAfterRedraw = path.getTessellationStats().misses;
+        context.flush();
+
+        reportResult({ uncached, cached, hits, misses, rotatedEntries, entriesAfterChange,
+            redrawMisses: missesAfterRedraw - missesBeforeRedraw });
+    )", "canvas_path2d_tessellation_cache.js");
+
+    std::cout << "1000 Path2D icons per frame: " << result.at("uncached") << " ms without the tessellation cache, "
+              << result.at("cached") << " ms with it" << std::endl;
+
+    // Each icon is tessellated once for its fill and once for its stroke; translating it
+    // afterwards reuses them.
+    constexpr double draws{1000 * 2};
+    EXPECT_EQ(result.at("misses"), draws);
+    EXPECT_EQ(result.at("hits"), draws * 5);
+
+    EXPECT_EQ(result.at("rotatedEntries"), 3);
+    EXPECT_EQ(result.at("entriesAfterChange"), 0);
+    EXPECT_EQ(result.at("redrawMisses"), 1);
+}
+
+// getImageDataAsync flushes and reads the canvas back through a pooled GPU readback. The Noop
+// renderer never writes readback data, so this checks the region handling, the readbacks issued
+// and the timing; the conversion of the readback into ImageData is checked by
+// ReadbackToImageData below.
+TEST(Canvas, GetImageDataAsync)
+{
+    const auto result = RunCanvasScript(R"(
+        const reads = 100;
+
+        const canvas = new _native.Canvas();
+        canvas.width = 64;
+        canvas.height = 64;
+        const context = canvas.getContext("2d");
+        context.fillStyle = "red";
+        context.fillRect(30, 30, 10, 10);
+
+        async function run() {
+            const requestsBefore = getReadbackRequests();
+
+            const whole = await context.getImageDataAsync(0, 0, 32, 32);
+
+            // Partly outside the canvas: the outside stays transparent black.
+            const clipped = await context.getImageDataAsync(-4, -4, 16, 16);
+            const corner = clipped.data.slice(0, 4).every((value) => value === 0);
+
+            const outside = await context.getImageDataAsync(100, 100, 8, 8);
+
+            let invalidArguments = 0;
+            try {
+                context.getImageDataAsync(0, 0);
+            } catch (error) {
+                invalidArguments = 1;
+            }
+
+            let start = Date.now();
+            let resolved = 0;
+            for (let i = 0; i < reads; ++i) {
+                const data = await context.getImageDataAsync(i % 32, 0, 32, 32);
+                resolved += data.width === 32 && data.height === 32 && data.data.length === 32 * 32 * 4 ? 1 : 0;
+            }
+            const asyncMs = (Date.now() - start) / reads;
+
+            start = Date.now();
+            for (let i = 0; i < reads; ++i) {
+                context.getImageData(i % 32, 0, 32, 32);
+            }
+            const syncMs = (Date.now() - start) / reads;
+
+            reportResult({
+                wholeWidth: whole.width, wholeHeight: whole.height,
+                clippedWidth: clipped.width,
+                corner: corner ? 1 : 0,
+                outsideWidth: outside.width,
+                outsideEmpty: outside.data.every((value) => value === 0) ? 1 : 0,
+                invalidArguments,
+                resolved, asyncMs, syncMs,
+                readbacks: getReadbackRequests() - requestsBefore,
+            });
+        }
+
+        run().catch((error) => {
+            console.log(error.message);
+            reportResult({ error: 1 });
+        });
+    )", "canvas_get_image_data_async.js", [](Napi::Env env) {
+        auto& deviceContext = Babylon::Graphics::DeviceContext::GetFromJavaScript(env);
+        env.Global().Set("getReadbackRequests", Napi::Function::New(env, [&deviceContext](const Napi::CallbackInfo& info) {
+            return Napi::Value::From(info.Env(), static_cast<double>(deviceContext.GetReadbackStats().Requests));
+        }, "getReadbackRequests"));
+    });
+
+    ASSERT_EQ(result.count("error"), 0u);
+
+    std::cout << "32x32 getImageData: " << result.at("asyncMs") << " ms per awaited getImageDataAsync, "
+              << result.at("syncMs") << " ms per getImageData" << std::endl;
+
+    EXPECT_EQ(result.at("wholeWidth"), 32);
+    EXPECT_EQ(result.at("wholeHeight"), 32);
+    EXPECT_EQ(result.at("clippedWidth"), 16);
+    EXPECT_EQ(result.at("corner"), 1);
+    EXPECT_EQ(result.at("outsideWidth"), 8);
+    EXPECT_EQ(result.at("outsideEmpty"), 1);
+    EXPECT_EQ(result.at("invalidArguments"), 1);
+    EXPECT_EQ(result.at("resolved"), 100);
+
+    // Every read overlapping the canvas goes through a readback; the one outside it does not.
+    EXPECT_EQ(result.at("readbacks"), 2 + 100);
+}
+
+// A 2x2 premultiplied readback placed at (1, 1) in a 4x3 ImageData, as getImageDataAsync does with
+// the part of a region inside the canvas.
+TEST(Canvas, ReadbackToImageData)
+{
+    using Pixel = std::array<uint8_t, 4>;
+
+    // Top row: opaque, and red at half alpha. Bottom row: transparent with stray color, and
+    // (100, 50, 0) at alpha 51. Premultiplied, as nanovg renders them.
+    const std::array<Pixel, 4> topDown{{{200, 100, 50, 255}, {128, 0, 0, 128}, {10, 20, 30, 0}, {20, 10, 0, 51}}};
+    const std::array<Pixel, 4> expected{{{200, 100, 50, 255}, {255, 0, 0, 128}, {0, 0, 0, 0}, {100, 50, 0, 51}}};
+
+    constexpr uint32_t WIDTH = 4;
+    constexpr uint32_t HEIGHT = 3;
+    constexpr uint8_t UNTOUCHED = 0xEE;
+
+    const auto read = [](const std::vector<uint8_t>& imageData, uint32_t x, uint32_t y) {
+        Pixel pixel{};
+        std::memcpy(pixel.data(), imageData.data() + (y * WIDTH + x) * 4, 4);
+        return pixel;
+    };
+
+    for (const bool bottomUp : {true, false})
+    {
+        // The rows as the renderer returns them.
+        std::vector<uint8_t> readback{};
+        for (const size_t index : bottomUp ? std::array<size_t, 4>{2, 3, 0, 1} : std::array<size_t, 4>{0, 1, 2, 3})
+        {
+            readback.insert(readback.end(), topDown[index].begin(), topDown[index].end());
+        }
+
+        std::vector<uint8_t> imageData(WIDTH * HEIGHT * 4, UNTOUCHED);
+        Babylon::Polyfills::Internal::CopyReadbackToImageData(readback.data(), 2, 2, bottomUp, imageData.data(), WIDTH, 1, 1);
+
+        EXPECT_EQ(read(imageData, 1, 1), expected[0]) << "bottomUp " << bottomUp;
+        EXPECT_EQ(read(imageData, 2, 1), expected[1]) << "bottomUp " << bottomUp;
+        EXPECT_EQ(read(imageData, 1, 2), expected[2]) << "bottomUp " << bottomUp;
+        EXPECT_EQ(read(imageData, 2, 2), expected[3]) << "bottomUp " << bottomUp;
+
+        // Everything outside the placed region is left alone.
+        size_t untouched{};
+        for (uint32_t y = 0; y < HEIGHT; ++y)
+        {
+            for (uint32_t x = 0; x < WIDTH; ++x)
+            {
+                untouched += read(imageData, x, y) == Pixel{UNTOUCHED, UNTOUCHED, UNTOUCHED, UNTOUCHED} ? 1 : 0;
+            }
+        }
+        EXPECT_EQ(untouched, WIDTH * HEIGHT - 4) << "bottomUp " << bottomUp;
+    }
+
+    // A channel above its alpha is not valid premultiplied data; it saturates.
+    const Pixel invalid{200, 0, 0, 100};
+    Pixel converted{};
+    Babylon::Polyfills::Internal::CopyReadbackToImageData(invalid.data(), 1, 1, true, converted.data(), 1, 0, 0);
+    EXPECT_EQ(converted, (Pixel{255, 0, 0, 100}));
+}
+
+// Streams 1,000 512x512 frames through putImageData, one per rendered frame, as video or a heatmap
+// would. Each frame waits for the previous one's image to be released, so a single image is
+// created and then updated in place. A second pass only marks a 64x64 dirty rectangle, which is
+// all that gets uploaded.
+TEST(Canvas, PutImageDataImageCache)
+{
+    const auto result = RunCanvasScript(R"(
+        const frames = 1000;
+        const size = 512;
+        const dirtySize = 64;
+
+        const canvas = new _native.Canvas();
+        canvas.width = size;
+        canvas.height = size;
+        const context = canvas.getContext("2d");
+
+        const image = context.createImageData(size, size);
+
+        function nextFrame() {
+            return new Promise((resolve) => {
+                const poll = () => context.getImageUploadStats().acquired === 0 ? resolve() : setTimeout(poll, 0);
+                poll();
+            });
+        }
+
+        async function stream(dirty) {
+            const before = context.getImageUploadStats();
+            const start = Date.now();
+            for (let frame = 0; frame < frames; ++frame) {
+                image.data.fill(frame % 256);
+                if (dirty) {
+                    context.putImageData(image, 0, 0, frame % (size - dirtySize), 0, dirtySize, dirtySize);
+                } else {
+                    context.putImageData(image, 0, 0);
+                }
+                context.flush();
+                await nextFrame();
+            }
+            const after = context.getImageUploadStats();
+            return {
+                ms: (Date.now() - start) / frames,
+                created: after.imagesCreated - before.imagesCreated,
+                bytes: after.uploadedBytes - before.uploadedBytes,
+            };
+        }
+
+        async function run() {
+            const full = await stream(false);
+            const dirty = await stream(true);
+
+            // Two uploads drawn by one flush cannot share an image.
+            const before = context.getImageUploadStats().imagesCreated;
+            context.putImageData(image, 0, 0);
+            context.putImageData(image, 0, 0);
+            context.flush();
+            const sameFrameCreated = context.getImageUploadStats().imagesCreated - before;
+            await nextFrame();
+
+            const pixel = context.getImageData(10, 0, 1, 1).data[0];
+
+            reportResult({
+                fullMs: full.ms, fullCreated: full.created, fullBytes: full.bytes,
+                dirtyMs: dirty.ms, dirtyCreated: dirty.created, dirtyBytes: dirty.bytes,
+                sameFrameCreated, pixel,
+                images: context.getImageUploadStats().images,
+            });
+        }
+
+        run().catch((error) => {
+            console.log(error.message);
+            reportResult({ error: 1 });
+        });
+    )", "canvas_put_image_data_cache.js");
+
+    ASSERT_EQ(result.count("error"), 0u);
+
+    std::cout << "1000 512x512 putImageData: " << result.at("fullCreated") << " textures created, "
+              << result.at("fullBytes") << " bytes uploaded, " << result.at("fullMs") << " ms per frame; with a 64x64 dirty rect: "
+              << result.at("dirtyCreated") << " textures created, " << result.at("dirtyBytes") << " bytes uploaded, "
+              << result.at("dirtyMs") << " ms per frame" << std::endl;
+
+    EXPECT_EQ(result.at("fullCreated"), 1);
+    EXPECT_EQ(result.at("fullBytes"), 1000.0 * 512 * 512 * 4);
+    EXPECT_EQ(result.at("dirtyCreated"), 0);
+    EXPECT_EQ(result.at("dirtyBytes"), 1000.0 * 64 * 64 * 4);
+    EXPECT_EQ(result.at("sameFrameCreated"), 1);
+    EXPECT_EQ(result.at("images"), 2);
+
+    // The CPU mirror still follows the last upload (frame 999 filled every byte with 231).
+    EXPECT_EQ(result.at("pixel"), 999 % 256);
+}
+
+// Shadows are drawn as an offset copy of the shape, blurred by the filter stack before the shape
+// itself, so a shadowed call costs the views of its blur passes (three for a gaussian, seven for
+// a box blur) while an offset-only shadow, clearRect and the shape share the canvas' view. The
+// copy is one more draw with the shape's triangles. Pixels are not checked: the headless device
+// does not rasterize.
+TEST(Canvas, Shadows)
+{
+    constexpr int SHADOWED_CALLS = 8;
+    // An antialiased rectangle fill: two triangles inside and eight for the fringe.
+    constexpr int RECT_TRIANGLES = 10;
+
+    const auto result = RunCanvasScript(R"(
+        const shadowedCalls = )" + std::to_string(SHADOWED_CALLS) + R"(;
+        const canvas = new _native.Canvas();
+        canvas.width = 128;
+        canvas.height = 128;
+        const context = canvas.getContext("2d");
+        context.shadowColor = "rgba(0, 0, 0, 0.5)";
+        context.flush();
+
+        function drawShadowed(blur, offset, draw) {
+            context.shadowBlur = 0;
+            context.shadowOffsetX = 0;
+            context.fillRect(0, 0, 8, 8);
+            for (let i = 0; i < shadowedCalls; ++i) {
+                context.shadowBlur = blur;
+                context.shadowOffsetX = offset;
+                draw();
+            }
+            context.flush();
+            return context.getFlushStats();
+        }
+
+        const fillRect = () => context.fillRect(32, 32, 64, 64);
+        const strokeArc = () => {
+            context.beginPath();
+            context.arc(64, 64, 32, 0, Math.PI * 2);
+            context.stroke();
+        };
+        const gaussian = drawShadowed(2, 4, fillRect);
+        const box = drawShadowed(10, 4, fillRect);
+        const offsetOnly = drawShadowed(0, 4, fillRect);
+        const cleared = drawShadowed(10, 4, () => context.clearRect(0, 0, 16, 16));
+        const stroke = drawShadowed(2, 0, strokeArc);
+
+        context.shadowColor = "rgba(0, 0, 0, 0)";
+        const transparent = drawShadowed(10, 4, fillRect);
+        const transparentStroke = drawShadowed(2, 0, strokeArc);
+
+        const pool = canvas.getFrameBufferPoolStats();
+        reportResult({
+            gaussian: gaussian.views, box: box.views, offsetOnly: offsetOnly.views, cleared: cleared.views,
+            stroke: stroke.views, transparent: transparent.views,
+            gaussianDrawCalls: gaussian.drawCalls, gaussianTriangles: gaussian.fillTriangles,
+            offsetOnlyDrawCalls: offsetOnly.drawCalls, offsetOnlyTriangles: offsetOnly.fillTriangles,
+            transparentDrawCalls: transparent.drawCalls, transparentTriangles: transparent.fillTriangles,
+            strokeDrawCalls: stroke.drawCalls, strokeTriangles: stroke.strokeTriangles, strokeFillTriangles: stroke.fillTriangles,
+            transparentStrokeDrawCalls: transparentStroke.drawCalls, transparentStrokeTriangles: transparentStroke.strokeTriangles,
+            poolHits: pool.hits, poolAcquired: pool.acquired });
+    )", "canvas_shadows.js");
+
+    EXPECT_EQ(result.at("gaussian"), 1 + SHADOWED_CALLS * 3);
+    EXPECT_EQ(result.at("box"), 1 + SHADOWED_CALLS * 7);
+    EXPECT_EQ(result.at("offsetOnly"), 1);
+    EXPECT_EQ(result.at("cleared"), 1);
+    EXPECT_EQ(result.at("stroke"), 1 + SHADOWED_CALLS * 3);
+    EXPECT_EQ(result.at("transparent"), 1);
+
+    // The unshadowed fillRect takes both passes of a fill; each shadowed one adds a single draw
+    // for its copy, with the same triangles whether or not it is blurred.
+    EXPECT_EQ(result.at("gaussianDrawCalls"), 2 + SHADOWED_CALLS * 3);
+    EXPECT_EQ(result.at("gaussianTriangles"), RECT_TRIANGLES + SHADOWED_CALLS * RECT_TRIANGLES * 2);
+    EXPECT_EQ(result.at("offsetOnlyDrawCalls"), 2 + SHADOWED_CALLS * 3);
+    EXPECT_EQ(result.at("offsetOnlyTriangles"), RECT_TRIANGLES + SHADOWED_CALLS * RECT_TRIANGLES * 2);
+
+    // A transparent shadow is not drawn at all.
+    EXPECT_EQ(result.at("transparentDrawCalls"), 2 + SHADOWED_CALLS * 2);
+    EXPECT_EQ(result.at("transparentTriangles"), RECT_TRIANGLES + SHADOWED_CALLS * RECT_TRIANGLES);
+
+    // A stroke's shadow repeats the stroke's geometry.
+    EXPECT_GT(result.at("transparentStrokeTriangles"), 0);
+    EXPECT_EQ(result.at("strokeTriangles"), 2 * result.at("transparentStrokeTriangles"));
+    EXPECT_EQ(result.at("strokeDrawCalls"), 2 + SHADOWED_CALLS * 2);
+    EXPECT_EQ(result.at("transparentStrokeDrawCalls"), 2 + SHADOWED_CALLS);
+    EXPECT_EQ(result.at("strokeFillTriangles"), RECT_TRIANGLES);
+
+    // The blur passes render into pooled buffers, all returned by the end of the flush.
+    EXPECT_GT(result.at("poolHits"), 0);
+    EXPECT_EQ(result.at("poolAcquired"), 0);
+}
+
+// Strokes a 10,000 segment polyline solid and dashed. Dashes are split from the flattened path
+// when stroking, so they neither cost views nor change the path a later fill or stroke sees.
+// The dashes of a 100px line are counted from the draws of its stroke, one per dash.
+TEST(Canvas, LineDashes)
+{
+    // A 2px wide, butt capped, antialiased segment.
+    constexpr int DASH_TRIANGLES = 6;
+
+    const auto result = RunCanvasScript(R"(
+        const segments = 10000;
+        const frames = 10;
+
+        const canvas = new _native.Canvas();
+        canvas.width = 512;
+        canvas.height = 512;
+        const context = canvas.getContext("2d");
+
+        function draw(dash) {
+            context.setLineDash(dash);
+            context.lineDashOffset = 2;
+            context.beginPath();
+            context.moveTo(0, 0);
+            for (let i = 1; i <= segments; ++i) {
+                context.lineTo((i * 37) % 512, (i * 91) % 512);
+            }
+            context.stroke();
+            context.stroke();
+            context.fill();
+            context.flush();
+        }
+
+        function measure(dash) {
+            draw(dash); // warm up
+            const start = Date.now();
+            for (let frame = 0; frame < frames; ++frame) {
+                draw(dash);
+            }
+            return (Date.now() - start) / frames;
+        }
+
+        const solid = measure([]);
+        const dashed = measure([4, 2, 1]);
+        const dashedViews = context.getFlushStats().views;
+
+        context.lineDashOffset = 3;
+        context.save();
+        context.lineDashOffset = Number.NaN;
+        const keptOffset = context.lineDashOffset;
+        context.lineDashOffset = -7;
+        context.restore();
+
+        const restoredOffset = context.lineDashOffset;
+        const dash = context.getLineDash().length;
+
+        function strokeLine(dash, offset) {
+            context.lineWidth = 2;
+            context.setLineDash(dash);
+            context.lineDashOffset = offset;
+            context.beginPath();
+            context.moveTo(10, 50);
+            context.lineTo(110, 50);
+            context.stroke();
+            context.flush();
+            return context.getFlushStats();
+        }
+
+        // Dashes at 0, 20, 40, 60 and 80.
+        const even = strokeLine([10, 10], 0);
+        // Shifted by half a dash: 0-5, 15-25, ... 75-85 and 95-100.
+        const offset = strokeLine([10, 10], 5);
+        // Repeated to [10, 5, 5, 10, 5, 5]: 0-10, 15-20, 30-35 and 40-50, 55-60, 70-75, then 80-90 and 95-100.
+        const odd = strokeLine([10, 5, 5], 0);
+        const solidLine = strokeLine([], 0);
+
+        reportResult({
+            solid, dashed, dashedViews, keptOffset, restoredOffset, dash,
+            evenDashes: even.drawCalls, evenTriangles: even.strokeTriangles,
+            offsetDashes: offset.drawCalls, offsetTriangles: offset.strokeTriangles,
+            oddDashes: odd.drawCalls, oddTriangles: odd.strokeTriangles,
+            solidDashes: solidLine.drawCalls, solidTriangles: solidLine.strokeTriangles });
+    )", "canvas_line_dashes.js");
+
+    std::cout << "10k segment polyline: " << result.at("solid") << " ms solid, " << result.at("dashed") << " ms dashed" << std::endl;
+
+    EXPECT_EQ(result.at("dashedViews"), 1);
+    EXPECT_EQ(result.at("keptOffset"), 3);
+    EXPECT_EQ(result.at("restoredOffset"), 3);
+
+    // Per spec the odd pattern is repeated, and getLineDash returns it that way.
+    EXPECT_EQ(result.at("dash"), 6);
+
+    EXPECT_EQ(result.at("solidDashes"), 1);
+    EXPECT_EQ(result.at("solidTriangles"), DASH_TRIANGLES);
+    EXPECT_EQ(result.at("evenDashes"), 5);
+    EXPECT_EQ(result.at("evenTriangles"), 5 * DASH_TRIANGLES);
+    EXPECT_EQ(result.at("offsetDashes"), 6);
+    EXPECT_EQ(result.at("offsetTriangles"), 6 * DASH_TRIANGLES);
+    EXPECT_EQ(result.at("oddDashes"), 8);
+    EXPECT_EQ(result.at("oddTriangles"), 8 * DASH_TRIANGLES);
+}
+
+// Sets and applies a five-function filter 10,000 times. The string is parsed once and then found
+// in the cache, and the color functions are fused into one matrix applied to the colors of the
+// draw, so they cost no views; only a blur adds passes.
+TEST(Canvas, FilterCache)
+{
+    constexpr int DRAWS = 10000;
+    constexpr int BLURRED_CALLS = 8;
+
+    const auto result = RunCanvasScript(R"(
+        const draws = )" + std::to_string(DRAWS) + R"(;
+        const blurredCalls = )" + std::to_string(BLURRED_CALLS) + R"(;
+        const canvas = new _native.Canvas();
+        canvas.width = 256;
+        canvas.height = 256;
+        const context = canvas.getContext("2d");
+        const colorFilter = "sepia(0.5) contrast(120%) saturate(1.5) hue-rotate(20deg) brightness(0.9)";
+        const blurFilter = "sepia(1) grayscale(50%) blur(1px) invert(10%) opacity(0.8)";
+
+        const before = context.getFilterCacheStats();
+        const start = Date.now();
+        for (let i = 0; i < draws; ++i) {
+            context.filter = colorFilter;
+            context.fillStyle = i % 2 ? "red" : "blue";
+            context.fillRect(i % 200, (i * 7) % 200, 32, 32);
+            if (i % 1000 === 999) {
+                context.flush();
+            }
+        }
+        const elapsed = Date.now() - start;
+        const colorViews = context.getFlushStats().views;
+        const after = context.getFilterCacheStats();
+
+        context.filter = "none";
+        context.fillRect(0, 0, 8, 8);
+        for (let i = 0; i < blurredCalls; ++i) {
+            context.filter = blurFilter;
+            context.fillRect(32, 32, 64, 64);
+            context.filter = "none";
+            context.fillRect(0, 0, 8, 8);
+        }
+        context.flush();
+        const blurViews = context.getFlushStats().views;
+
+        // An invalid list leaves the filter unchanged.
+        context.filter = colorFilter;
+        context.filter = "sepia(1) blur(2deg)";
+        const kept = context.filter === colorFilter ? 1 : 0;
+
+        reportResult({
+            elapsed, colorViews, blurViews, kept,
+            misses: after.misses - before.misses,
+            hits: after.hits - before.hits,
+        });
+    )", "canvas_filter_cache.js");
+
+    std::cout << DRAWS << " draws with a five-function filter in " << result.at("elapsed") << " ms ("
+              << result.at("misses") << " parses)" << std::endl;
+
+    EXPECT_EQ(result.at("misses"), 1);
+    EXPECT_EQ(result.at("hits"), DRAWS - 1);
+    EXPECT_EQ(result.at("colorViews"), 1);
+    EXPECT_EQ(result.at("blurViews"), 1 + BLURRED_CALLS * 3);
+    EXPECT_EQ(result.at("kept"), 1);
+}
+
+#ifdef HAS_CANVAS_IMAGES
+// Color filters apply to drawn images through their CPU copy, which the CPU mirror then holds.
+// An image that has not loaded draws nothing, filtered or not.
+TEST(Canvas, FilteredDrawImage)
+{
+    const auto result = RunCanvasScript(R"(
+        const canvas = new _native.Canvas();
+        canvas.width = 4;
+        canvas.height = 4;
+        const context = canvas.getContext("2d");
+        context.filter = "invert(1)";
+
+        const image = new _native.Image();
+        context.drawImage(image, 0, 0);
+        context.flush();
+        const unloadedDrawCalls = context.getFlushStats().drawCalls;
+
+        image.onerror = () => reportResult({ error: 1 });
+        image.onload = () => {
+            context.drawImage(image, 0, 0);
+            context.flush();
+            const pixel = context.getImageData(0, 0, 1, 1).data;
+            reportResult({
+                unloadedDrawCalls, drawCalls: context.getFlushStats().drawCalls,
+                r: pixel[0], g: pixel[1], b: pixel[2], a: pixel[3] });
+        };
+        // One opaque pixel of rgb(200, 100, 50).
+        image.src = "data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAYAAAAfFcSJAAAADUlEQVR4nGM4kWL0HwAFtAJeHzr7ywAAAABJRU5ErkJggg==";
+    )", "canvas_filtered_draw_image.js");
+
+    ASSERT_EQ(result.count("error"), 0u);
+    EXPECT_EQ(result.at("unloadedDrawCalls"), 0);
+    EXPECT_EQ(result.at("drawCalls"), 2);
+    EXPECT_EQ(result.at("r"), 255 - 200);
+    EXPECT_EQ(result.at("g"), 255 - 100);
+    EXPECT_EQ(result.at("b"), 255 - 50);
+    EXPECT_EQ(result.at("a"), 255);
+}
+#endif
+
+// Fills 5,000 shapes with 500 distinct linear gradients. Their ramps are packed into the rows of
+// two shared atlas pages instead of 500 textures, and gradients with the same stops share a row.
+TEST(Canvas, GradientAtlas)
+{
+    constexpr int SHAPES = 5000;
+    constexpr int GRADIENTS = 500;
+
+    const auto result = RunCanvasScript(R"(
+        const shapes = )" + std::to_string(SHAPES) + R"(;
+        const gradientCount = )" + std::to_string(GRADIENTS) + R"(;
+        const canvas = new _native.Canvas();
+        canvas.width = 256;
+        canvas.height = 256;
+        const context = canvas.getContext("2d");
+
+        const createGradient = (i) => {
+            const gradient = context.createLinearGradient(0, 0, 32 + (i % 7), 0);
+            gradient.addColorStop(0, `rgb(${i % 256}, ${Math.floor(i / 256)}, 0)`);
+            gradient.addColorStop(1, "white");
+            return gradient;
+        };
+
+        const gradients = [];
+        for (let i = 0; i < gradientCount; ++i) {
+            gradients.push(createGradient(i));
+        }
+
+        const start = Date.now();
+        for (let i = 0; i < shapes; ++i) {
+            context.fillStyle = gradients[i % gradientCount];
+            context.fillRect((i * 13) % 224, (i * 7) % 224, 32, 32);
+        }
+        context.flush();
+        const elapsed = Date.now() - start;
+        const drawCalls = context.getFlushStats().drawCalls;
+        const distinct = context.getGradientAtlasStats();
+
+        // Gradients with the same stops share a row, filtered or not.
+        for (let i = 0; i < gradientCount; ++i) {
+            context.fillStyle = createGradient((i % 10) * 25);
+            context.fillRect(0, 0, 8, 8);
+            context.filter = "sepia(1)";
+            context.fillRect(0, 0, 8, 8);
+            context.filter = "none";
+        }
+        context.flush();
+        const shared = context.getGradientAtlasStats();
+
+        reportResult({
+            elapsed, drawCalls,
+            pagesCreated: distinct.pagesCreated,
+            rowsUploaded: distinct.rowsUploaded,
+            rowsInUse: distinct.rowsInUse,
+            sharedPagesCreated: shared.pagesCreated,
+            sharedRowsUploaded: shared.rowsUploaded - distinct.rowsUploaded,
+        });
+    )", "canvas_gradient_atlas.js");
+
+    std::cout << SHAPES << " shapes with " << GRADIENTS << " gradients in " << result.at("elapsed") << " ms: "
+              << result.at("pagesCreated") << " textures created, " << result.at("drawCalls") << " draw calls" << std::endl;
+
+    EXPECT_EQ(result.at("pagesCreated"), 2);
+    EXPECT_EQ(result.at("rowsUploaded"), GRADIENTS);
+    EXPECT_EQ(result.at("rowsInUse"), GRADIENTS);
+    EXPECT_EQ(result.at("drawCalls"), 2 * SHAPES);
+
+    // The 10 sepia ramps are the only new content.
+    EXPECT_EQ(result.at("sharedPagesCreated"), 2);
+    EXPECT_EQ(result.at("sharedRowsUploaded"), 10);
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/Embedding/Runtime.h>
+#include <Babylon/Embedding/View.h>
+#include <Babylon/Graphics/Device.h>
+#include <napi/napi.h>
+
+#if BABYLON_NATIVE_PLUGIN_SHADERCACHE
+#include <Babylon/Plugins/ShaderCache.h>
+#include <Babylon/Plugins/ShaderCacheInternal.h>
+#endif
+
+#include "App.h"
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std::chrono_literals;
+
+extern Babylon::Graphics::Configuration g_deviceConfig;
+
+namespace
+{
+    // Renders frames until the startup timeline is available, the way a host's draw callback
+    // would. Returns empty if it never completes.
+    std::optional<Babylon::Embedding::StartupTimeline> RenderUntilStartupTimeline(Babylon::Embedding::Runtime& runtime, Babylon::Embedding::View& view)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + 30s;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            view.RenderFrame();
+            if (auto timeline = runtime.GetStartupTimeline())
+            {
+                return timeline;
+            }
+        }
+        return {};
+    }
+
+    // Fulfills once every script queued before it has run, and reports the value of `name`.
+    std::future<bool> ReadGlobalFlag(Babylon::Embedding::Runtime& runtime, const char* name)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        auto future = promise->get_future();
+        runtime.RunOnJsThread([promise, name](Napi::Env env) {
+            const auto value = env.Global().Get(name);
+            promise->set_value(value.IsBoolean() && value.As<Napi::Boolean>().Value());
+        },
+            true);
+        return future;
+    }
+}
+
+TEST(Embedding, StartupTimeline)
+{
+    Babylon::Embedding::Runtime runtime{};
+    runtime.Eval("globalThis.startupScriptRan = true;", "app:///startup.js");
+    auto startupScriptRan = ReadGlobalFlag(runtime, "startupScriptRan");
+
+    // Nothing has been rendered yet, and plugins only initialize on the first attach.
+    EXPECT_FALSE(runtime.GetStartupTimeline().has_value());
+
+    Babylon::Embedding::View view{runtime, g_deviceConfig.Window};
+    view.Resize(static_cast<uint32_t>(g_deviceConfig.Width), static_cast<uint32_t>(g_deviceConfig.Height), Babylon::Embedding::CoordinateUnits::Physical);
+
+    const auto timeline = RenderUntilStartupTimeline(runtime, view);
+    ASSERT_TRUE(timeline.has_value()) << "The startup timeline never completed";
+
+    // The timeline is only reported once the scripts queued before the first frame have run.
+    ASSERT_EQ(startupScriptRan.wait_for(0s), std::future_status::ready);
+    EXPECT_TRUE(startupScriptRan.get());
+
+    // Every phase from the first attach on happens inside the measured cold start.
+    EXPECT_GT(timeline->timeToFirstFrame.count(), 0);
+    EXPECT_LE(timeline->untilFirstAttach, timeline->timeToFirstFrame);
+    EXPECT_LE(timeline->device, timeline->timeToFirstFrame);
+    EXPECT_LE(timeline->pluginInitialization, timeline->timeToFirstFrame);
+    EXPECT_LE(timeline->scriptLoading, timeline->timeToFirstFrame);
+    EXPECT_LE(timeline->firstFrame, timeline->timeToFirstFrame);
+
+    // Without Prewarm, nothing is reported for it.
+    EXPECT_EQ(timeline->prewarm.count(), 0);
+    EXPECT_EQ(timeline->prewarmedShaders, 0u);
+
+    // The timeline is fixed once complete.
+    view.RenderFrame();
+    const auto later = runtime.GetStartupTimeline();
+    ASSERT_TRUE(later.has_value());
+    EXPECT_EQ(later->timeToFirstFrame, timeline->timeToFirstFrame);
+}
+
+#if BABYLON_NATIVE_PLUGIN_SHADERCACHE
+TEST(Embedding, PrewarmHydratesShaderCache)
+{
+    const auto path = GetExecutableDirectory() / "embeddingPrewarm.bin";
+    std::filesystem::remove(path);
+
+    const std::string vertexSource{"void main() { gl_Position = vec4(1.0); }"};
+    const std::string fragmentSource{"void main() { gl_FragColor = vec4(1.0); }"};
+
+    // A journal left behind by a previous run of the app. The entry is fabricated: prewarming
+    // a cached entry only loads it, it never compiles it.
+    {
+        Babylon::Graphics::BgfxShaderInfo info{};
+        info.VertexBytes.assign(64, 1);
+        info.FragmentBytes.assign(32, 2);
+
+        Babylon::Plugins::ShaderCache::Enable();
+        Babylon::Plugins::ShaderCache::OpenJournal(path.string());
+        Babylon::Plugins::ShaderCache::AddShader(vertexSource, fragmentSource, info);
+        Babylon::Plugins::ShaderCache::Disable();
+    }
+    ASSERT_FALSE(Babylon::Plugins::ShaderCache::IsEnabled());
+
+    {
+        Babylon::Embedding::RuntimeOptions options{};
+        options.shaderCachePath = path.string();
+        Babylon::Embedding::Runtime runtime{options};
+        runtime.Prewarm();
+
+        Babylon::Embedding::View view{runtime, g_deviceConfig.Window};
+        view.Resize(static_cast<uint32_t>(g_deviceConfig.Width), static_cast<uint32_t>(g_deviceConfig.Height), Babylon::Embedding::CoordinateUnits::Physical);
+
+        const auto timeline = RenderUntilStartupTimeline(runtime, view);
+        ASSERT_TRUE(timeline.has_value()) << "The startup timeline never completed";
+
+        // The persisted entry was loaded, not compiled.
+        EXPECT_TRUE(Babylon::Plugins::ShaderCache::IsEnabled());
+        EXPECT_TRUE(Babylon::Plugins::ShaderCache::GetShader(vertexSource, fragmentSource) != nullptr);
+        EXPECT_EQ(timeline->prewarmedShaders, 0u);
+        EXPECT_LE(timeline->shaderCache, timeline->timeToFirstFrame);
+
+        // Prewarm may only run before the first attach.
+        EXPECT_THROW(runtime.Prewarm(), std::runtime_error);
+    }
+
+    // The last Runtime using the cache releases it.
+    EXPECT_FALSE(Babylon::Plugins::ShaderCache::IsEnabled());
+    std::filesystem::remove(path);
+}
+#endif
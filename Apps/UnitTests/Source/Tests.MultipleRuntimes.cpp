@@ -0,0 +1,341 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Graphics/Device.h>
+#include <Babylon/Graphics/DeviceContext.h>
+#include <Babylon/Polyfills/Console.h>
+#include <Babylon/Polyfills/Window.h>
+#include <Babylon/Plugins/NativeEngine.h>
+#include <Babylon/Plugins/ShaderCache.h>
+#include <Babylon/ScriptLoader.h>
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    constexpr uint8_t RUNTIME_COUNT = 8;
+    constexpr uint32_t FRAMES_PER_RUNTIME = 30;
+
+    struct RuntimeResult
+    {
+        int32_t RuntimeIndex{-1};
+        uint32_t MeshCount{};
+        uint32_t Frames{};
+    };
+
+    // One isolated JavaScript runtime with its own engine, scene and offscreen render target,
+    // recording into a device shared with the other runtimes.
+    class IsolatedRuntime final
+    {
+    public:
+        // Each frame also renders `renderTargetCount` extra render targets, a bgfx view each.
+        IsolatedRuntime(Babylon::Graphics::Device& device, uint32_t index, uint32_t renderTargetCount = 0)
+        {
+            Babylon::AppRuntime::Options options{};
+            options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+                std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+                std::quick_exit(1);
+            };
+
+            m_runtime = std::make_unique<Babylon::AppRuntime>(options);
+            m_runtime->Dispatch([&device, this](Napi::Env env) {
+                device.AddToJavaScript(env);
+
+                Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+                    std::cout << message << std::endl;
+                });
+                Babylon::Polyfills::Window::Initialize(env);
+                Babylon::Plugins::NativeEngine::Initialize(env);
+
+                env.Global().Set("reportResult", Napi::Function::New(env, [this](const Napi::CallbackInfo& info) {
+                    RuntimeResult result{};
+                    result.RuntimeIndex = info[0].As<Napi::Number>().Int32Value();
+                    result.MeshCount = info[1].As<Napi::Number>().Uint32Value();
+                    result.Frames = info[2].As<Napi::Number>().Uint32Value();
+                    m_result.set_value(result);
+                }, "reportResult"));
+            });
+
+            m_loader = std::make_unique<Babylon::ScriptLoader>(*m_runtime);
+            m_loader->LoadScript("app:///Assets/babylon.max.js");
+
+            // Every runtime stores its index in a global and builds a scene with index + 1 meshes.
+            // If any JavaScript state leaked between runtimes the reported pair would not match.
+            std::ostringstream script{};
+            script << "globalThis.runtimeIndex = " << index << ";\n"
+                   << "const meshCount = " << index + 1 << ";\n"
+                   << "const frameCount = " << FRAMES_PER_RUNTIME << ";\n"
+                   << "const renderTargetCount = " << renderTargetCount << ";\n"
+                   << R"(
+                const engine = new BABYLON.NativeEngine();
+                const scene = new BABYLON.Scene(engine);
+                scene.clearColor = new BABYLON.Color4(runtimeIndex / 8, 0, 0, 1);
+                const camera = new BABYLON.ArcRotateCamera("camera", 0, 1, 10, BABYLON.Vector3.Zero(), scene);
+                camera.outputRenderTarget = new BABYLON.RenderTargetTexture("target", { width: 128, height: 128 }, scene);
+                for (let i = 0; i < meshCount; ++i) {
+                    const box = BABYLON.MeshBuilder.CreateBox("box" + i, { size: 1 }, scene);
+                    box.position.x = i;
+                }
+                for (let i = 0; i < renderTargetCount; ++i) {
+                    const renderTarget = new BABYLON.RenderTargetTexture("extra" + i, { width: 16, height: 16 }, scene);
+                    renderTarget.renderList = scene.meshes.slice();
+                    scene.customRenderTargets.push(renderTarget);
+                }
+
+                let frames = 0;
+                engine.runRenderLoop(() => {
+                    scene.render();
+                    if (++frames === frameCount) {
+                        engine.stopRenderLoop();
+                        reportResult(globalThis.runtimeIndex, scene.meshes.length, frames);
+                    }
+                });
+            )";
+            m_loader->Eval(script.str(), "multiple_runtimes_" + std::to_string(index) + ".js");
+        }
+
+        std::future<RuntimeResult> GetResult()
+        {
+            return m_result.get_future();
+        }
+
+    private:
+        std::promise<RuntimeResult> m_result{};
+        std::unique_ptr<Babylon::AppRuntime> m_runtime{};
+        std::unique_ptr<Babylon::ScriptLoader> m_loader{};
+    };
+}
+
+// Runs RUNTIME_COUNT AppRuntimes in parallel against one headless (Noop) device. Each runtime
+// records into the same bgfx frame from its own thread, so this exercises the per-thread
+// encoders and the shared, locked shader cache. Checks that every runtime saw only its own
+// JavaScript state and reports aggregate throughput.
+TEST(MultipleRuntimes, SharedDeviceStress)
+{
+    Babylon::Plugins::ShaderCache::Enable();
+
+    Babylon::Graphics::Configuration config{};
+    config.MaxConcurrentRuntimes = RUNTIME_COUNT;
+    Babylon::Graphics::Device device{config};
+
+    device.StartRenderingCurrentFrame();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::array<std::unique_ptr<IsolatedRuntime>, RUNTIME_COUNT> runtimes{};
+    std::array<std::future<RuntimeResult>, RUNTIME_COUNT> results{};
+    for (uint32_t index = 0; index < RUNTIME_COUNT; ++index)
+    {
+        runtimes[index] = std::make_unique<IsolatedRuntime>(device, index);
+        results[index] = runtimes[index]->GetResult();
+    }
+
+    uint32_t deviceFrames{0};
+    for (auto& result : results)
+    {
+        while (result.wait_for(1ms) != std::future_status::ready)
+        {
+            device.FinishRenderingCurrentFrame();
+            device.StartRenderingCurrentFrame();
+            ++deviceFrames;
+
+            ASSERT_LT(std::chrono::steady_clock::now() - start, 120s) << "Runtimes did not finish rendering";
+        }
+    }
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (uint32_t index = 0; index < RUNTIME_COUNT; ++index)
+    {
+        const auto result = results[index].get();
+        EXPECT_EQ(result.RuntimeIndex, static_cast<int32_t>(index));
+        EXPECT_EQ(result.MeshCount, index + 1);
+        EXPECT_EQ(result.Frames, FRAMES_PER_RUNTIME);
+    }
+
+    std::cout << RUNTIME_COUNT << " runtimes rendered " << RUNTIME_COUNT * FRAMES_PER_RUNTIME << " scene frames in "
+              << deviceFrames << " device frames over " << elapsed << " s ("
+              << (RUNTIME_COUNT * FRAMES_PER_RUNTIME) / elapsed << " scene frames/s)" << std::endl;
+
+    // Every runtime compiled the same standard material, so the shared cache holds it once.
+    std::stringstream cache{};
+    EXPECT_GT(Babylon::Plugins::ShaderCache::Save(cache), 0u);
+
+    // Let any requestAnimationFrame already scheduled drain before the runtimes are torn down.
+    device.FinishRenderingCurrentFrame();
+    device.StartRenderingCurrentFrame();
+
+    for (auto& runtime : runtimes)
+    {
+        runtime.reset();
+    }
+
+    device.FinishRenderingCurrentFrame();
+
+    Babylon::Plugins::ShaderCache::Disable();
+}
+
+// Several runtimes that together render more bgfx views per frame than bgfx allows, so that the
+// frame has to be flushed midway while the other runtimes are recording into encoders of their
+// own. Without the flush, AcquireNewViewId throws "Too many views".
+TEST(MultipleRuntimes, MidFrameViewFlush)
+{
+    constexpr uint32_t runtimeCount{4};
+    constexpr uint32_t renderTargetCount{96};
+
+    Babylon::Graphics::Configuration config{};
+    config.MaxConcurrentRuntimes = runtimeCount;
+    Babylon::Graphics::Device device{config};
+
+    device.StartRenderingCurrentFrame();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::array<std::unique_ptr<IsolatedRuntime>, runtimeCount> runtimes{};
+    std::array<std::future<RuntimeResult>, runtimeCount> results{};
+    for (uint32_t index = 0; index < runtimeCount; ++index)
+    {
+        runtimes[index] = std::make_unique<IsolatedRuntime>(device, index, renderTargetCount);
+        results[index] = runtimes[index]->GetResult();
+    }
+
+    for (auto& result : results)
+    {
+        while (result.wait_for(1ms) != std::future_status::ready)
+        {
+            device.FinishRenderingCurrentFrame();
+            device.StartRenderingCurrentFrame();
+
+            ASSERT_LT(std::chrono::steady_clock::now() - start, 120s) << "Runtimes did not finish rendering";
+        }
+    }
+
+    for (uint32_t index = 0; index < runtimeCount; ++index)
+    {
+        const auto result = results[index].get();
+        EXPECT_EQ(result.RuntimeIndex, static_cast<int32_t>(index));
+        EXPECT_EQ(result.Frames, FRAMES_PER_RUNTIME);
+    }
+
+    device.FinishRenderingCurrentFrame();
+    device.StartRenderingCurrentFrame();
+
+    for (auto& runtime : runtimes)
+    {
+        runtime.reset();
+    }
+
+    device.FinishRenderingCurrentFrame();
+}
+
+// A runtime that stops in the middle of recording, here by blocking on its JavaScript thread
+// between draws, holds up the mid-frame view flush that another runtime asks for. The flush gives
+// up after a bounded wait instead of stalling the frame, and the runtime that asked for it runs out
+// of views for the rest of the frame, as documented on Configuration::MaxConcurrentRuntimes. The
+// next frame flushes again.
+TEST(MultipleRuntimes, MidFrameViewFlushTimeout)
+{
+    Babylon::Graphics::Configuration config{};
+    config.MaxConcurrentRuntimes = 2;
+    Babylon::Graphics::Device device{config};
+
+    device.StartRenderingCurrentFrame();
+    device.FinishRenderingCurrentFrame();
+
+    Babylon::AppRuntime busyRuntime{};
+    Babylon::AppRuntime flushingRuntime{};
+
+    std::promise<Babylon::Graphics::DeviceContext*> busyContextPromise{};
+    std::promise<Babylon::Graphics::DeviceContext*> flushingContextPromise{};
+    busyRuntime.Dispatch([&device, &busyContextPromise](Napi::Env env) {
+        device.AddToJavaScript(env);
+        busyContextPromise.set_value(&Babylon::Graphics::DeviceContext::GetFromJavaScript(env));
+    });
+    flushingRuntime.Dispatch([&device, &flushingContextPromise](Napi::Env env) {
+        device.AddToJavaScript(env);
+        flushingContextPromise.set_value(&Babylon::Graphics::DeviceContext::GetFromJavaScript(env));
+    });
+    auto* busyContext{busyContextPromise.get_future().get()};
+    auto* flushingContext{flushingContextPromise.get_future().get()};
+
+    // Acquires views as a frame rendering many passes does, checking for a flush before each.
+    // Returns the error that ended it, if any.
+    const auto acquireViews = [](Babylon::Graphics::DeviceContext& context, uint32_t count) -> std::string {
+        try
+        {
+            for (uint32_t view = 0; view < count; ++view)
+            {
+                context.FlushViewsIfNeeded();
+                context.GetActiveEncoder();
+                context.AcquireNewViewId();
+            }
+        }
+        catch (const std::runtime_error& error)
+        {
+            return error.what();
+        }
+        return {};
+    };
+
+    constexpr uint32_t VIEW_COUNT{1024};
+
+    {
+        device.StartRenderingCurrentFrame();
+
+        std::promise<void> recording{};
+        std::promise<void> release{};
+        busyRuntime.Dispatch([busyContext, &recording, releaseFuture{release.get_future().share()}](Napi::Env) {
+            auto scope{busyContext->AcquireFrameCompletionScope()};
+            busyContext->GetActiveEncoder();
+            recording.set_value();
+            releaseFuture.wait();
+        });
+        recording.get_future().wait();
+
+        std::promise<std::pair<std::string, std::chrono::steady_clock::duration>> flushed{};
+        flushingRuntime.Dispatch([flushingContext, &acquireViews, &flushed, &release](Napi::Env) {
+            auto scope{flushingContext->AcquireFrameCompletionScope()};
+            const auto start{std::chrono::steady_clock::now()};
+            auto error{acquireViews(*flushingContext, VIEW_COUNT)};
+            flushed.set_value({std::move(error), std::chrono::steady_clock::now() - start});
+            release.set_value();
+        });
+
+        // Services the flush request, then waits for both runtimes to release their scopes.
+        device.FinishRenderingCurrentFrame();
+
+        const auto [error, elapsed]{flushed.get_future().get()};
+        EXPECT_EQ(error, "Too many views");
+        EXPECT_GE(elapsed, 200ms);
+        EXPECT_LT(elapsed, 10s);
+    }
+
+    {
+        device.StartRenderingCurrentFrame();
+
+        std::promise<void> acquired{};
+        std::promise<std::string> flushed{};
+        flushingRuntime.Dispatch([flushingContext, &acquireViews, &acquired, &flushed](Napi::Env) {
+            auto scope{flushingContext->AcquireFrameCompletionScope()};
+            acquired.set_value();
+            flushed.set_value(acquireViews(*flushingContext, VIEW_COUNT));
+        });
+
+        // The scope must be held before the frame is finished, for the flushes to be serviced.
+        acquired.get_future().wait();
+        device.FinishRenderingCurrentFrame();
+
+        EXPECT_EQ(flushed.get_future().get(), "");
+    }
+}
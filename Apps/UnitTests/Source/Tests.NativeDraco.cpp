@@ -0,0 +1,370 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Plugins/NativeDraco.h>
+#include <Babylon/Plugins/NativeDracoInternal.h>
+#include <Babylon/Polyfills/Console.h>
+#include <Babylon/ScriptLoader.h>
+
+#include <draco/attributes/geometry_attribute.h>
+#include <draco/attributes/point_attribute.h>
+#include <draco/compression/decode.h>
+#include <draco/compression/encode.h>
+#include <draco/core/decoder_buffer.h>
+#include <draco/core/encoder_buffer.h>
+#include <draco/mesh/mesh.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    namespace Decoding = Babylon::Plugins::NativeDraco::Decoding;
+
+    using Encoded = std::vector<char>;
+
+    // A size x size grid of vertices, two triangles per cell, with positions, normals and uvs.
+    // The phase makes distinct meshes of the same size.
+    Encoded EncodeGrid(int size, float phase)
+    {
+        draco::Mesh mesh;
+        const int vertices{size * size};
+        mesh.set_num_points(vertices);
+
+        const auto addAttribute = [&mesh, vertices](draco::GeometryAttribute::Type type, int components) {
+            draco::GeometryAttribute attribute;
+            attribute.Init(type, nullptr, static_cast<uint8_t>(components), draco::DT_FLOAT32, false, sizeof(float) * components, 0);
+            return mesh.attribute(mesh.AddAttribute(attribute, true, vertices));
+        };
+        auto* position{addAttribute(draco::GeometryAttribute::POSITION, 3)};
+        auto* normal{addAttribute(draco::GeometryAttribute::NORMAL, 3)};
+        auto* uv{addAttribute(draco::GeometryAttribute::TEX_COORD, 2)};
+
+        for (int y = 0; y < size; ++y)
+        {
+            for (int x = 0; x < size; ++x)
+            {
+                const draco::AttributeValueIndex index(y * size + x);
+                const float height{std::sin(x * 0.1f + phase) * std::cos(y * 0.1f)};
+                const float p[3]{static_cast<float>(x), height, static_cast<float>(y)};
+                const float n[3]{0.0f, 1.0f, 0.0f};
+                const float t[2]{static_cast<float>(x) / size, static_cast<float>(y) / size};
+                position->SetAttributeValue(index, p);
+                normal->SetAttributeValue(index, n);
+                uv->SetAttributeValue(index, t);
+            }
+        }
+
+        for (int y = 0; y + 1 < size; ++y)
+        {
+            for (int x = 0; x + 1 < size; ++x)
+            {
+                const draco::PointIndex corner(y * size + x);
+                const draco::PointIndex right(y * size + x + 1);
+                const draco::PointIndex below((y + 1) * size + x);
+                const draco::PointIndex diagonal((y + 1) * size + x + 1);
+                mesh.AddFace({corner, below, right});
+                mesh.AddFace({right, below, diagonal});
+            }
+        }
+
+        draco::Encoder encoder;
+        encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 14);
+        encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 10);
+        encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 12);
+        draco::EncoderBuffer buffer;
+        const auto status{encoder.EncodeMeshToBuffer(mesh, &buffer)};
+        EXPECT_TRUE(status.ok()) << status.error_msg();
+        return {buffer.data(), buffer.data() + buffer.size()};
+    }
+
+    // Decodes the float attributes of `encoded` one point at a time, as the plugin did before the
+    // bulk copy.
+    std::vector<std::vector<float>> DecodePerPoint(const Encoded& encoded)
+    {
+        draco::DecoderBuffer buffer;
+        buffer.Init(encoded.data(), encoded.size());
+        draco::Decoder decoder;
+        auto meshStatus{decoder.DecodeMeshFromBuffer(&buffer)};
+        EXPECT_TRUE(meshStatus.ok());
+        const auto mesh{std::move(meshStatus).value()};
+
+        std::vector<std::vector<float>> attributes;
+        for (const auto type : {draco::GeometryAttribute::POSITION, draco::GeometryAttribute::NORMAL, draco::GeometryAttribute::TEX_COORD})
+        {
+            const auto* attribute{mesh->GetNamedAttribute(type)};
+            const int components{attribute->num_components()};
+            std::vector<float> values(static_cast<size_t>(mesh->num_points()) * components);
+            for (draco::PointIndex i(0); i < mesh->num_points(); ++i)
+            {
+                attribute->ConvertValue<float>(attribute->mapped_index(i), components, values.data() + static_cast<size_t>(i.value()) * components);
+            }
+            attributes.push_back(std::move(values));
+        }
+        return attributes;
+    }
+
+    bool SameMesh(const Decoding::Mesh& a, const Decoding::Mesh& b)
+    {
+        if (a.HasIndices != b.HasIndices || a.Indices != b.Indices || a.TotalVertices != b.TotalVertices || a.Attributes.size() != b.Attributes.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.Attributes.size(); ++i)
+        {
+            if (a.Attributes[i].Kind != b.Attributes[i].Kind || a.Attributes[i].Data != b.Attributes[i].Data)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double Milliseconds(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TEST(NativeDraco, DecodeMatchesPerPointCopy)
+{
+    const auto encoded{EncodeGrid(64, 0.0f)};
+    const auto mesh{Decoding::Decode(encoded.data(), encoded.size(), nullptr)};
+    const auto expected{DecodePerPoint(encoded)};
+
+    EXPECT_TRUE(mesh.HasIndices);
+    EXPECT_EQ(mesh.Indices.size(), 63u * 63u * 2u * 3u);
+    ASSERT_EQ(mesh.Attributes.size(), 3u);
+    EXPECT_EQ(mesh.Attributes[0].Kind, "position");
+    EXPECT_EQ(mesh.Attributes[1].Kind, "normal");
+    EXPECT_EQ(mesh.Attributes[2].Kind, "uv");
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        ASSERT_EQ(mesh.Attributes[i].Data.size(), expected[i].size() * sizeof(float));
+        EXPECT_EQ(std::memcmp(mesh.Attributes[i].Data.data(), expected[i].data(), mesh.Attributes[i].Data.size()), 0) << mesh.Attributes[i].Kind;
+    }
+
+    // The glTF path takes the kinds of the caller, in its order.
+    const Decoding::AttributeIds ids{{"uv", 2}, {"position", 0}, {"missing", 7}};
+    const auto byId{Decoding::Decode(encoded.data(), encoded.size(), &ids)};
+    ASSERT_EQ(byId.Attributes.size(), 2u);
+    EXPECT_EQ(byId.Attributes[0].Kind, "uv");
+    EXPECT_EQ(byId.Attributes[0].Data, mesh.Attributes[2].Data);
+    EXPECT_EQ(byId.Attributes[1].Data, mesh.Attributes[0].Data);
+
+    const char garbage[64]{};
+    EXPECT_THROW(Decoding::Decode(garbage, sizeof(garbage), nullptr), std::runtime_error);
+}
+
+TEST(NativeDraco, CopyAttributeDataWithPointMapping)
+{
+    // Four points sharing two values, as a seam does, so the copy goes point by point.
+    draco::Mesh mesh;
+    mesh.set_num_points(4);
+    draco::GeometryAttribute uv;
+    uv.Init(draco::GeometryAttribute::TEX_COORD, nullptr, 2, draco::DT_FLOAT32, false, sizeof(float) * 2, 0);
+    auto* attribute{mesh.attribute(mesh.AddAttribute(uv, false, 2))};
+    const float values[2][2]{{0.25f, 0.5f}, {0.75f, 1.0f}};
+    attribute->SetAttributeValue(draco::AttributeValueIndex(0), values[0]);
+    attribute->SetAttributeValue(draco::AttributeValueIndex(1), values[1]);
+    const int mapping[4]{1, 0, 0, 1};
+    for (uint32_t point = 0; point < 4; ++point)
+    {
+        attribute->SetPointMapEntry(draco::PointIndex(point), draco::AttributeValueIndex(mapping[point]));
+    }
+
+    float output[8]{};
+    Decoding::CopyAttributeData(mesh, *attribute, reinterpret_cast<std::byte*>(output));
+    for (uint32_t point = 0; point < 4; ++point)
+    {
+        EXPECT_EQ(output[point * 2 + 0], values[mapping[point]][0]);
+        EXPECT_EQ(output[point * 2 + 1], values[mapping[point]][1]);
+    }
+}
+
+TEST(NativeDraco, ConcurrentDecodesAreDeterministic)
+{
+    constexpr size_t THREADS = 8;
+    constexpr size_t ITERATIONS = 4;
+
+    std::vector<Encoded> encoded{};
+    std::vector<Decoding::Mesh> expected{};
+    for (int i = 0; i < 3; ++i)
+    {
+        encoded.push_back(EncodeGrid(96 + 16 * i, static_cast<float>(i)));
+        expected.push_back(Decoding::Decode(encoded.back().data(), encoded.back().size(), nullptr));
+    }
+
+    std::vector<std::future<size_t>> mismatches{};
+    for (size_t thread = 0; thread < THREADS; ++thread)
+    {
+        mismatches.push_back(std::async(std::launch::async, [&encoded, &expected, thread]() {
+            size_t count{};
+            for (size_t iteration = 0; iteration < ITERATIONS; ++iteration)
+            {
+                const size_t mesh{(thread + iteration) % encoded.size()};
+                count += !SameMesh(Decoding::Decode(encoded[mesh].data(), encoded[mesh].size(), nullptr), expected[mesh]);
+            }
+            return count;
+        }));
+    }
+
+    for (auto& count : mismatches)
+    {
+        EXPECT_EQ(count.get(), 0u);
+    }
+}
+
+TEST(NativeDraco, DecodeAsync)
+{
+    std::vector<Encoded> encoded{};
+    for (int i = 0; i < 4; ++i)
+    {
+        encoded.push_back(EncodeGrid(48 + 8 * i, static_cast<float>(i)));
+    }
+
+    std::promise<std::string> resultPromise{};
+
+    Babylon::AppRuntime::Options options{};
+    options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+        std::quick_exit(1);
+    };
+
+    std::optional<Babylon::AppRuntime> runtime{std::in_place, options};
+    runtime->Dispatch([&encoded, &resultPromise](Napi::Env env) {
+        Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+            std::cout << message << std::endl;
+        });
+        Babylon::Plugins::NativeDraco::Initialize(env);
+
+        auto meshes = Napi::Array::New(env, encoded.size());
+        for (uint32_t i = 0; i < encoded.size(); ++i)
+        {
+            auto bytes = Napi::Uint8Array::New(env, encoded[i].size());
+            std::memcpy(bytes.Data(), encoded[i].data(), encoded[i].size());
+            meshes.Set(i, bytes);
+        }
+        env.Global().Set("meshes", meshes);
+
+        env.Global().Set("reportResult", Napi::Function::New(env, [&resultPromise](const Napi::CallbackInfo& info) {
+            resultPromise.set_value(info[0].As<Napi::String>().Utf8Value());
+        }, "reportResult"));
+    });
+
+    // Decodes every mesh twice concurrently, and compares each result with the synchronous one.
+    Babylon::ScriptLoader loader{*runtime};
+    loader.Eval(R"(
+        function same(a, b) {
+            if (a.totalVertices !== b.totalVertices || a.attributes.length !== b.attributes.length) { return false; }
+            const arrays = [[a.indices, b.indices]].concat(a.attributes.map((attribute, i) => [attribute.data, b.attributes[i].data]));
+            return arrays.every(([x, y]) => x.constructor === y.constructor && x.length === y.length && x.every((value, i) => value === y[i]));
+        }
+        const codec = _native.DracoCodec;
+        const pending = meshes.concat(meshes).map((mesh) => codec.DecodeAsync(mesh, { position: 0, normal: 1, uv: 2 }));
+        Promise.all(pending).then((decoded) => {
+            const mismatch = decoded.findIndex((result, i) => !same(result, codec.Decode(meshes[i % meshes.length], { position: 0, normal: 1, uv: 2 })));
+            return codec.DecodeAsync(new Uint8Array(64)).then(
+                () => reportResult("garbage resolved"),
+                () => reportResult(mismatch === -1 ? "ok" : "mismatch at " + mismatch));
+        }).catch((error) => reportResult("error: " + error));
+    )", "DecodeAsync");
+
+    auto resultFuture{resultPromise.get_future()};
+    ASSERT_EQ(resultFuture.wait_for(60s), std::future_status::ready);
+    EXPECT_EQ(resultFuture.get(), "ok");
+    runtime.reset();
+}
+
+TEST(NativeDraco, DecodeAsyncTeardown)
+{
+    // Decodes are still queued or running on the thread pool when the runtime goes away. Tearing
+    // it down cancels them and waits for the running ones.
+    constexpr uint32_t DECODES = 32;
+    const auto encoded{EncodeGrid(256, 0.0f)};
+
+    Babylon::AppRuntime::Options options{};
+    options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+        std::quick_exit(1);
+    };
+
+    for (int round = 0; round < 5; ++round)
+    {
+        SCOPED_TRACE(round);
+
+        std::promise<uint32_t> issuedPromise{};
+        std::optional<Babylon::AppRuntime> runtime{std::in_place, options};
+        runtime->Dispatch([&encoded, &issuedPromise](Napi::Env env) {
+            Babylon::Plugins::NativeDraco::Initialize(env);
+
+            auto bytes = Napi::Uint8Array::New(env, encoded.size());
+            std::memcpy(bytes.Data(), encoded.data(), encoded.size());
+            env.Global().Set("mesh", bytes);
+
+            env.Global().Set("reportIssued", Napi::Function::New(env, [&issuedPromise](const Napi::CallbackInfo& info) {
+                issuedPromise.set_value(info[0].As<Napi::Number>().Uint32Value());
+            }, "reportIssued"));
+        });
+
+        Babylon::ScriptLoader loader{*runtime};
+        loader.Eval(R"(
+            const decodes = )" + std::to_string(DECODES) + R"(;
+            for (let decode = 0; decode < decodes; ++decode) {
+                _native.DracoCodec.DecodeAsync(mesh, { position: 0, normal: 1, uv: 2 });
+            }
+            reportIssued(decodes);
+        )", "DecodeAsyncTeardown");
+
+        auto issuedFuture{issuedPromise.get_future()};
+        ASSERT_EQ(issuedFuture.wait_for(60s), std::future_status::ready);
+        EXPECT_EQ(issuedFuture.get(), DECODES);
+
+        const auto start{std::chrono::steady_clock::now()};
+        runtime.reset();
+        EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+    }
+}
+
+// Decoding a 1M vertex mesh, and the share of it the attribute copy takes with the bulk copy and
+// with the per-point copy it replaced.
+TEST(NativeDraco, DecodeBenchmark)
+{
+    const auto encoded{EncodeGrid(1024, 0.0f)};
+
+    auto start{std::chrono::steady_clock::now()};
+    const auto mesh{Decoding::Decode(encoded.data(), encoded.size(), nullptr)};
+    const double decodeMilliseconds{Milliseconds(start)};
+
+    draco::DecoderBuffer buffer;
+    buffer.Init(encoded.data(), encoded.size());
+    draco::Decoder decoder;
+    auto meshStatus{decoder.DecodeMeshFromBuffer(&buffer)};
+    ASSERT_TRUE(meshStatus.ok());
+    const auto dracoMesh{std::move(meshStatus).value()};
+
+    std::vector<float> values(static_cast<size_t>(dracoMesh->num_points()) * 3);
+    const auto* position{dracoMesh->GetNamedAttribute(draco::GeometryAttribute::POSITION)};
+
+    start = std::chrono::steady_clock::now();
+    Decoding::CopyAttributeData(*dracoMesh, *position, reinterpret_cast<std::byte*>(values.data()));
+    const double bulkMilliseconds{Milliseconds(start)};
+
+    start = std::chrono::steady_clock::now();
+    for (draco::PointIndex i(0); i < dracoMesh->num_points(); ++i)
+    {
+        position->ConvertValue<float>(position->mapped_index(i), 3, values.data() + static_cast<size_t>(i.value()) * 3);
+    }
+    const double perPointMilliseconds{Milliseconds(start)};
+
+    std::cout << "Draco decode of " << mesh.TotalVertices << " vertices: " << decodeMilliseconds << " ms; position copy: bulk "
+              << bulkMilliseconds << " ms, per point " << perPointMilliseconds << " ms" << std::endl;
+}
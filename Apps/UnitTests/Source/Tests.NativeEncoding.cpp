@@ -0,0 +1,959 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Plugins/NativeEncoding.h>
+#include <Babylon/Plugins/NativeEncodingInternal.h>
+#include <Babylon/Polyfills/Blob.h>
+#include <Babylon/Polyfills/Console.h>
+#include <Babylon/ScriptLoader.h>
+
+#include <arcana/threading/task_schedulers.h>
+
+#include <bimg/decode.h>
+#include <bx/allocator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    namespace Png = Babylon::Plugins::NativeEncoding::Png;
+    namespace Jpeg = Babylon::Plugins::NativeEncoding::Jpeg;
+    namespace WebP = Babylon::Plugins::NativeEncoding::WebP;
+    using Babylon::Plugins::NativeEncoding::EncodeQueue;
+    using Babylon::Plugins::NativeEncoding::RowRange;
+
+    // Something like a rendered frame: a sky gradient, flat and shaded shapes, and a band of
+    // noisy texture, so that every filter and match length gets used.
+    std::vector<std::byte> MakeFrame(uint32_t width, uint32_t height)
+    {
+        std::mt19937 random{42};
+        std::vector<std::byte> pixels(size_t{width} * height * 4);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                auto* pixel{&pixels[(size_t{y} * width + x) * 4]};
+                const float u{static_cast<float>(x) / width};
+                const float v{static_cast<float>(y) / height};
+                const float dx{u - 0.3f};
+                const float dy{v - 0.4f};
+                uint8_t r{static_cast<uint8_t>(60 + 100 * v)};
+                uint8_t g{static_cast<uint8_t>(120 + 80 * v)};
+                uint8_t b{230};
+                if (dx * dx + dy * dy < 0.04f)
+                {
+                    const float shade{0.5f + 2.0f * (0.2f - dx - dy)};
+                    r = static_cast<uint8_t>(std::clamp(200 * shade, 0.0f, 255.0f));
+                    g = static_cast<uint8_t>(std::clamp(80 * shade, 0.0f, 255.0f));
+                    b = static_cast<uint8_t>(std::clamp(40 * shade, 0.0f, 255.0f));
+                }
+                else if (u > 0.6f && u < 0.9f && v > 0.2f && v < 0.5f)
+                {
+                    r = 30;
+                    g = 30;
+                    b = 35;
+                }
+                else if (v > 0.75f)
+                {
+                    const auto grain{static_cast<uint8_t>(random() % 24)};
+                    r = static_cast<uint8_t>(90 + grain);
+                    g = static_cast<uint8_t>(70 + grain);
+                    b = static_cast<uint8_t>(40 + grain / 2);
+                }
+                pixel[0] = std::byte{r};
+                pixel[1] = std::byte{g};
+                pixel[2] = std::byte{b};
+                pixel[3] = std::byte{255};
+            }
+        }
+        return pixels;
+    }
+
+    // Decodes an image file with bimg to RGBA8 rows, top row first.
+    std::vector<std::byte> Decode(const std::vector<std::byte>& file, uint32_t width, uint32_t height)
+    {
+        bx::DefaultAllocator allocator{};
+        auto* image{bimg::imageParse(&allocator, file.data(), static_cast<uint32_t>(file.size()), bimg::TextureFormat::RGBA8)};
+        if (image == nullptr)
+        {
+            throw std::runtime_error("bimg could not parse the image");
+        }
+
+        std::vector<std::byte> pixels{};
+        if (image->m_width == width && image->m_height == height && image->m_size == size_t{width} * height * 4)
+        {
+            const auto* data{static_cast<const std::byte*>(image->m_data)};
+            pixels.assign(data, data + image->m_size);
+        }
+        bimg::imageFree(image);
+        return pixels;
+    }
+
+    std::vector<std::byte> FlipRows(const std::vector<std::byte>& pixels, uint32_t width, uint32_t height)
+    {
+        const size_t rowBytes{size_t{width} * 4};
+        std::vector<std::byte> flipped(pixels.size());
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            std::memcpy(&flipped[(height - 1 - y) * rowBytes], &pixels[y * rowBytes], rowBytes);
+        }
+        return flipped;
+    }
+
+    // The peak signal to noise ratio of the color channels, in dB.
+    double Psnr(const std::vector<std::byte>& expected, const std::vector<std::byte>& actual)
+    {
+        if (expected.size() != actual.size())
+        {
+            return 0;
+        }
+        double squaredError{};
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            if (i % 4 != 3)
+            {
+                const double difference{static_cast<double>(expected[i]) - static_cast<double>(actual[i])};
+                squaredError += difference * difference;
+            }
+        }
+        const double meanSquaredError{squaredError / (expected.size() / 4 * 3)};
+        return meanSquaredError == 0 ? 100 : 10 * std::log10(255 * 255 / meanSquaredError);
+    }
+
+    // Encodes the ranges on threads of their own, in the way EncodeImageAsync spreads them over
+    // the thread pool.
+    template<typename EncodeRowsT>
+    auto EncodeRangesInParallel(const std::vector<RowRange>& ranges, EncodeRowsT encodeRows)
+    {
+        std::vector<decltype(encodeRows(ranges.front()))> encoded(ranges.size());
+        std::atomic<size_t> next{};
+        std::vector<std::thread> threads{};
+        for (unsigned int thread = 0; thread < std::max(std::thread::hardware_concurrency(), 1u); ++thread)
+        {
+            threads.emplace_back([&]() {
+                for (size_t index = next++; index < ranges.size(); index = next++)
+                {
+                    encoded[index] = encodeRows(ranges[index]);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        return encoded;
+    }
+
+    std::vector<std::byte> ParallelEncode(const std::vector<std::byte>& pixels, uint32_t width, uint32_t height, const Png::Options& options)
+    {
+        const auto encoded{EncodeRangesInParallel(Png::SplitRows(width, height), [&](RowRange rows) {
+            return Png::EncodeRows(pixels.data(), width, height, rows, options);
+        })};
+        return Png::Assemble(width, height, encoded);
+    }
+
+    std::vector<std::byte> ParallelEncodeJpeg(const std::vector<std::byte>& pixels, uint32_t width, uint32_t height, const Jpeg::Options& options)
+    {
+        const auto encoded{EncodeRangesInParallel(Jpeg::SplitRows(width, height, options), [&](RowRange rows) {
+            return Jpeg::EncodeRows(pixels.data(), width, height, rows, options);
+        })};
+        return Jpeg::Assemble(width, height, options, encoded);
+    }
+
+    template<typename CallableT>
+    double MeasureMilliseconds(CallableT callable)
+    {
+        const auto start{std::chrono::steady_clock::now()};
+        callable();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Random content of one of the kinds the encoders treat differently: translucent noise, a
+    // single color, runs of a few colors, a repeated tile and a rendered frame.
+    std::vector<std::byte> MakeRandomImage(std::mt19937& random, uint32_t width, uint32_t height)
+    {
+        std::vector<std::byte> pixels(size_t{width} * height * 4);
+        switch (random() % 5)
+        {
+            case 0:
+                for (auto& byte : pixels)
+                {
+                    byte = static_cast<std::byte>(random());
+                }
+                break;
+            case 1:
+            {
+                const uint32_t color{static_cast<uint32_t>(random())};
+                for (size_t i = 0; i < pixels.size(); ++i)
+                {
+                    pixels[i] = static_cast<std::byte>(color >> (8 * (i % 4)));
+                }
+                break;
+            }
+            case 2:
+            {
+                std::vector<uint32_t> palette(2 + random() % 15);
+                for (auto& color : palette)
+                {
+                    color = static_cast<uint32_t>(random());
+                }
+                uint32_t color{};
+                for (size_t pixel = 0, run = 0; pixel < pixels.size() / 4; ++pixel, --run)
+                {
+                    if (run == 0)
+                    {
+                        color = palette[random() % palette.size()];
+                        run = 1 + random() % 64;
+                    }
+                    for (size_t channel = 0; channel < 4; ++channel)
+                    {
+                        pixels[pixel * 4 + channel] = static_cast<std::byte>(color >> (8 * channel));
+                    }
+                }
+                break;
+            }
+            case 3:
+            {
+                const uint32_t tileSize{1 + static_cast<uint32_t>(random() % 32)};
+                std::vector<std::byte> tile(size_t{tileSize} * tileSize * 4);
+                for (auto& byte : tile)
+                {
+                    byte = static_cast<std::byte>(random());
+                }
+                for (uint32_t y = 0; y < height; ++y)
+                {
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        std::memcpy(&pixels[(size_t{y} * width + x) * 4], &tile[(size_t{y % tileSize} * tileSize + x % tileSize) * 4], 4);
+                    }
+                }
+                break;
+            }
+            default:
+                pixels = MakeFrame(width, height);
+                break;
+        }
+        return pixels;
+    }
+
+    // Checks the marker structure of a baseline JPEG without a decoder, which may be lenient: the
+    // tables and frame header before the scan, and entropy-coded data holding nothing but stuffed
+    // bytes and `restartCount` restart markers in sequence, up to the end of the image.
+    ::testing::AssertionResult IsWellFormedJpeg(const std::vector<std::byte>& jpeg, uint32_t width, uint32_t height, size_t restartCount)
+    {
+        const auto byteAt = [&](size_t offset) {
+            return static_cast<uint8_t>(jpeg[offset]);
+        };
+        const auto bigEndian16 = [&](size_t offset) {
+            return static_cast<uint32_t>(byteAt(offset) << 8 | byteAt(offset + 1));
+        };
+        const auto hex = [](uint8_t marker) {
+            constexpr char digits[]{"0123456789ABCDEF"};
+            return std::string{'0', 'x', digits[marker >> 4], digits[marker & 0xF]};
+        };
+
+        if (jpeg.size() < 4 || byteAt(0) != 0xFF || byteAt(1) != 0xD8)
+        {
+            return ::testing::AssertionFailure() << "no start of image";
+        }
+
+        bool quantization{};
+        bool huffman{};
+        bool frame{};
+        uint32_t restartInterval{};
+        size_t offset{2};
+        for (bool scan = false; !scan;)
+        {
+            if (offset + 4 > jpeg.size() || byteAt(offset) != 0xFF)
+            {
+                return ::testing::AssertionFailure() << "no marker at offset " << offset;
+            }
+            const uint8_t marker{byteAt(offset + 1)};
+            const size_t length{bigEndian16(offset + 2)};
+            if (length < 2 || offset + 2 + length > jpeg.size())
+            {
+                return ::testing::AssertionFailure() << "segment " << hex(marker) << " overruns the file";
+            }
+
+            const size_t body{offset + 4};
+            switch (marker)
+            {
+                case 0xC0:
+                    if (byteAt(body) != 8 || bigEndian16(body + 1) != height || bigEndian16(body + 3) != width || byteAt(body + 5) != 3)
+                    {
+                        return ::testing::AssertionFailure() << "frame header does not match the image";
+                    }
+                    frame = true;
+                    break;
+                case 0xC4:
+                    huffman = true;
+                    break;
+                case 0xDB:
+                    quantization = true;
+                    break;
+                case 0xDD:
+                    restartInterval = bigEndian16(body);
+                    break;
+                case 0xDA:
+                    scan = true;
+                    break;
+                case 0xE0:
+                    break;
+                default:
+                    return ::testing::AssertionFailure() << "unexpected marker " << hex(marker);
+            }
+            offset += 2 + length;
+        }
+
+        if (!quantization || !huffman || !frame)
+        {
+            return ::testing::AssertionFailure() << "tables or frame header missing before the scan";
+        }
+        if ((restartInterval != 0) != (restartCount != 0))
+        {
+            return ::testing::AssertionFailure() << "restart interval " << restartInterval << " for " << restartCount << " restarts";
+        }
+
+        size_t restarts{};
+        for (; offset + 1 < jpeg.size(); ++offset)
+        {
+            if (byteAt(offset) != 0xFF)
+            {
+                continue;
+            }
+            const uint8_t next{byteAt(++offset)};
+            if (next == 0xD9 && offset + 1 == jpeg.size())
+            {
+                return restarts == restartCount ? ::testing::AssertionSuccess() : ::testing::AssertionFailure() << restarts << " restarts, expected " << restartCount;
+            }
+            if (next >= 0xD0 && next <= 0xD7 && next == 0xD0 + restarts % 8)
+            {
+                ++restarts;
+            }
+            else if (next != 0x00)
+            {
+                return ::testing::AssertionFailure() << "marker " << hex(next) << " in the scan at offset " << offset;
+            }
+        }
+        return ::testing::AssertionFailure() << "no end of image";
+    }
+
+    // Checks the RIFF container and VP8L header of a lossless WebP without a decoder.
+    ::testing::AssertionResult IsWellFormedWebP(const std::vector<std::byte>& webp, uint32_t width, uint32_t height)
+    {
+        const auto littleEndian32 = [&](size_t offset) {
+            uint32_t value{};
+            for (size_t i = 0; i < 4; ++i)
+            {
+                value |= static_cast<uint32_t>(webp[offset + i]) << (8 * i);
+            }
+            return value;
+        };
+
+        if (webp.size() < 25 || std::memcmp(webp.data(), "RIFF", 4) != 0 || std::memcmp(webp.data() + 8, "WEBPVP8L", 8) != 0)
+        {
+            return ::testing::AssertionFailure() << "not a lossless WebP";
+        }
+        if (littleEndian32(4) != webp.size() - 8)
+        {
+            return ::testing::AssertionFailure() << "RIFF size " << littleEndian32(4) << " for a file of " << webp.size() << " bytes";
+        }
+        const uint32_t chunkSize{littleEndian32(16)};
+        if (20 + size_t{chunkSize} + (chunkSize & 1) != webp.size())
+        {
+            return ::testing::AssertionFailure() << "VP8L chunk size " << chunkSize << " for a file of " << webp.size() << " bytes";
+        }
+        if (static_cast<uint8_t>(webp[20]) != 0x2F)
+        {
+            return ::testing::AssertionFailure() << "no VP8L signature";
+        }
+        const uint32_t header{littleEndian32(21)};
+        if ((header & 0x3FFF) + 1 != width || ((header >> 14) & 0x3FFF) + 1 != height || (header >> 29) != 0)
+        {
+            return ::testing::AssertionFailure() << "VP8L header does not match the image";
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+    bool IsCancelled(const std::exception_ptr& error)
+    {
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (const std::system_error& exception)
+        {
+            return exception.code() == std::errc::operation_canceled;
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
+}
+
+TEST(NativeEncoding, PngRoundTrip)
+{
+    // Wide enough rows that the image splits into several ranges, and an odd size.
+    constexpr uint32_t width{1001};
+    constexpr uint32_t height{701};
+    const auto pixels{MakeFrame(width, height)};
+    ASSERT_GT(Png::SplitRows(width, height).size(), 2u);
+
+    size_t storedSize{};
+    for (int level = Png::MIN_COMPRESSION_LEVEL; level <= Png::MAX_COMPRESSION_LEVEL; ++level)
+    {
+        SCOPED_TRACE(level);
+        const auto png{Png::Encode(pixels.data(), width, height, {level, false})};
+        EXPECT_EQ(Decode(png, width, height), pixels);
+
+        if (level == 0)
+        {
+            storedSize = png.size();
+            EXPECT_GT(storedSize, pixels.size());
+        }
+        else
+        {
+            EXPECT_LT(png.size(), storedSize / 4);
+        }
+    }
+
+    // By default EncodeImageAsync writes the rows bottom-up.
+    const auto flipped{Png::Encode(pixels.data(), width, height, {Png::DEFAULT_COMPRESSION_LEVEL, true})};
+    EXPECT_EQ(Decode(flipped, width, height), FlipRows(pixels, width, height));
+}
+
+TEST(NativeEncoding, PngEdgeCases)
+{
+    // A single pixel, a single row and a single column, and noise, which gets stored.
+    std::mt19937 random{7};
+    for (const auto& [width, height] : {std::pair{1u, 1u}, std::pair{517u, 1u}, std::pair{1u, 517u}, std::pair{256u, 256u}})
+    {
+        std::vector<std::byte> pixels(size_t{width} * height * 4);
+        for (auto& byte : pixels)
+        {
+            byte = static_cast<std::byte>(random());
+        }
+        for (const int level : {0, 1, 6, 9})
+        {
+            SCOPED_TRACE(std::to_string(width) + " x " + std::to_string(height) + " at " + std::to_string(level));
+            const auto png{Png::Encode(pixels.data(), width, height, {level, false})};
+            EXPECT_EQ(Decode(png, width, height), pixels);
+            EXPECT_LT(png.size(), pixels.size() + 1024);
+        }
+    }
+
+    const std::vector<std::byte> pixel(4);
+    EXPECT_THROW(Png::Encode(pixel.data(), 1, 1, {Png::MAX_COMPRESSION_LEVEL + 1, false}), std::invalid_argument);
+    EXPECT_THROW(Png::Encode(pixel.data(), 1, 1, {Png::MIN_COMPRESSION_LEVEL - 1, false}), std::invalid_argument);
+    EXPECT_THROW(Png::Encode(pixel.data(), 0, 1, {}), std::invalid_argument);
+}
+
+TEST(NativeEncoding, PngRangesEncodeIndependently)
+{
+    constexpr uint32_t width{640};
+    constexpr uint32_t height{2000};
+    const auto pixels{MakeFrame(width, height)};
+
+    for (const int level : {0, 1, 6})
+    {
+        SCOPED_TRACE(level);
+        EXPECT_EQ(ParallelEncode(pixels, width, height, {level, true}), Png::Encode(pixels.data(), width, height, {level, true}));
+    }
+}
+
+TEST(NativeEncoding, PngBenchmark)
+{
+    // A 4K frame, on the calling thread and with the ranges spread over every core.
+    constexpr uint32_t width{3840};
+    constexpr uint32_t height{2160};
+    const auto pixels{MakeFrame(width, height)};
+
+    std::cout << "PNG encode of " << width << " x " << height << " RGBA, " << std::max(std::thread::hardware_concurrency(), 1u) << " threads:" << std::endl;
+    for (const int level : {0, 1, 3, 6, 9})
+    {
+        std::vector<std::byte> serial{};
+        std::vector<std::byte> parallel{};
+        const double serialMilliseconds{MeasureMilliseconds([&]() { serial = Png::Encode(pixels.data(), width, height, {level, false}); })};
+        const double parallelMilliseconds{MeasureMilliseconds([&]() { parallel = ParallelEncode(pixels, width, height, {level, false}); })};
+        EXPECT_EQ(serial, parallel);
+
+        std::cout << "  level " << level << ": " << serial.size() / 1024 << " KB, " << serialMilliseconds << " ms on one thread, "
+                  << parallelMilliseconds << " ms parallel" << std::endl;
+    }
+}
+
+TEST(NativeEncoding, JpegRoundTrip)
+{
+    // Several restart intervals, and a size that is not a whole number of blocks.
+    constexpr uint32_t width{1001};
+    constexpr uint32_t height{701};
+    const auto pixels{MakeFrame(width, height)};
+
+    size_t previousSize{};
+    double previousPsnr{};
+    for (const auto& [quality, minimumPsnr] : {std::pair{10, 25.0}, std::pair{50, 32.0}, std::pair{75, 34.0}, std::pair{92, 38.0}, std::pair{100, 42.0}})
+    {
+        SCOPED_TRACE(quality);
+        const Jpeg::Options options{quality, false};
+        ASSERT_GT(Jpeg::SplitRows(width, height, options).size(), 2u);
+        const auto jpeg{Jpeg::Encode(pixels.data(), width, height, options)};
+        EXPECT_EQ(ParallelEncodeJpeg(pixels, width, height, options), jpeg);
+
+        const double psnr{Psnr(pixels, Decode(jpeg, width, height))};
+        EXPECT_GT(psnr, minimumPsnr);
+        EXPECT_GT(psnr, previousPsnr);
+        EXPECT_GT(jpeg.size(), previousSize);
+        EXPECT_LT(jpeg.size(), pixels.size() / 4);
+        previousSize = jpeg.size();
+        previousPsnr = psnr;
+    }
+
+    const auto flipped{Jpeg::Encode(pixels.data(), width, height, {Jpeg::DEFAULT_QUALITY, true})};
+    EXPECT_GT(Psnr(FlipRows(pixels, width, height), Decode(flipped, width, height)), 38.0);
+}
+
+TEST(NativeEncoding, JpegEdgeCases)
+{
+    // Sizes that leave partial blocks on every side, and translucent pixels, which are
+    // composited onto black.
+    for (const auto& [width, height] : {std::pair{1u, 1u}, std::pair{517u, 1u}, std::pair{1u, 517u}, std::pair{17u, 33u}})
+    {
+        std::vector<std::byte> pixels(size_t{width} * height * 4);
+        std::vector<std::byte> composited(pixels.size());
+        for (size_t i = 0; i < pixels.size(); i += 4)
+        {
+            const auto alpha{static_cast<uint8_t>(i % 3 == 0 ? 128 : 255)};
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                const auto value{static_cast<uint8_t>(64 + channel * 64)};
+                pixels[i + channel] = std::byte{value};
+                composited[i + channel] = std::byte{static_cast<uint8_t>((value * alpha + 127) / 255)};
+            }
+            pixels[i + 3] = std::byte{alpha};
+            composited[i + 3] = std::byte{255};
+        }
+        for (const int quality : {Jpeg::MIN_QUALITY, 60, Jpeg::MAX_QUALITY})
+        {
+            SCOPED_TRACE(std::to_string(width) + " x " + std::to_string(height) + " at " + std::to_string(quality));
+            const auto decoded{Decode(Jpeg::Encode(pixels.data(), width, height, {quality, false}), width, height)};
+            ASSERT_EQ(decoded.size(), pixels.size());
+            EXPECT_GT(Psnr(composited, decoded), quality == Jpeg::MAX_QUALITY ? 45.0 : 15.0);
+        }
+    }
+
+    const std::vector<std::byte> pixel(4);
+    EXPECT_THROW(Jpeg::Encode(pixel.data(), 1, 1, {Jpeg::MAX_QUALITY + 1, false}), std::invalid_argument);
+    EXPECT_THROW(Jpeg::Encode(pixel.data(), 1, 1, {Jpeg::MIN_QUALITY - 1, false}), std::invalid_argument);
+    EXPECT_THROW(Jpeg::Encode(pixel.data(), 0, 1, {}), std::invalid_argument);
+    EXPECT_THROW(Jpeg::Validate(65536, 1, {}), std::invalid_argument);
+}
+
+TEST(NativeEncoding, WebPRoundTrip)
+{
+    EXPECT_THROW(WebP::Validate(16385, 1), std::invalid_argument);
+    EXPECT_THROW(WebP::Validate(1, 0), std::invalid_argument);
+
+#ifdef HAS_BIMG_WEBP
+    // Noise with translucent pixels, which has to be stored more or less as is, and frames,
+    // which the predictors and backward references compress.
+    std::mt19937 random{11};
+    for (const auto& [width, height] : {std::pair{1u, 1u}, std::pair{517u, 1u}, std::pair{1u, 517u}, std::pair{123u, 45u}})
+    {
+        SCOPED_TRACE(std::to_string(width) + " x " + std::to_string(height));
+        std::vector<std::byte> pixels(size_t{width} * height * 4);
+        for (auto& byte : pixels)
+        {
+            byte = static_cast<std::byte>(random());
+        }
+        const auto webp{WebP::Encode(pixels.data(), width, height, {})};
+        EXPECT_EQ(Decode(webp, width, height), pixels);
+        EXPECT_LT(webp.size(), pixels.size() + 1024);
+    }
+
+    constexpr uint32_t width{1001};
+    constexpr uint32_t height{701};
+    const auto pixels{MakeFrame(width, height)};
+    const auto webp{WebP::Encode(pixels.data(), width, height, {})};
+    EXPECT_EQ(Decode(webp, width, height), pixels);
+    EXPECT_LT(webp.size(), Png::Encode(pixels.data(), width, height, {}).size());
+    EXPECT_EQ(Decode(WebP::Encode(pixels.data(), width, height, {true}), width, height), FlipRows(pixels, width, height));
+#else
+    GTEST_SKIP() << "bimg is built without WebP parsing.";
+#endif
+}
+
+TEST(NativeEncoding, JpegRandomizedRoundTrip)
+{
+    // Random sizes, content, qualities and orientations, decoded by bimg. Large images get
+    // several restart intervals.
+    std::mt19937 random{2049};
+    for (int iteration = 0; iteration < 200; ++iteration)
+    {
+        const bool large{iteration % 10 == 0};
+        const auto width{static_cast<uint32_t>(1 + random() % (large ? 1200 : 96))};
+        const auto height{static_cast<uint32_t>(1 + random() % (large ? 700 : 96))};
+        const auto pixels{MakeRandomImage(random, width, height)};
+        const Jpeg::Options options{static_cast<int>(Jpeg::MIN_QUALITY + random() % Jpeg::MAX_QUALITY), random() % 2 == 0};
+        SCOPED_TRACE(std::to_string(width) + " x " + std::to_string(height) + " at " + std::to_string(options.Quality) + (options.FlipY ? ", flipped" : ""));
+
+        const auto jpeg{Jpeg::Encode(pixels.data(), width, height, options)};
+        EXPECT_TRUE(IsWellFormedJpeg(jpeg, width, height, Jpeg::SplitRows(width, height, options).size() - 1));
+        EXPECT_EQ(ParallelEncodeJpeg(pixels, width, height, options), jpeg);
+
+        // Composited onto black, as the encoder does.
+        std::vector<std::byte> composited(pixels.size());
+        for (size_t i = 0; i < pixels.size(); i += 4)
+        {
+            const auto alpha{static_cast<uint32_t>(pixels[i + 3])};
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                composited[i + channel] = std::byte{static_cast<uint8_t>((static_cast<uint32_t>(pixels[i + channel]) * alpha + 127) / 255)};
+            }
+            composited[i + 3] = std::byte{255};
+        }
+        if (options.FlipY)
+        {
+            composited = FlipRows(composited, width, height);
+        }
+
+        const auto decoded{Decode(jpeg, width, height)};
+        ASSERT_EQ(decoded.size(), pixels.size());
+        EXPECT_GT(Psnr(composited, decoded), options.Quality >= 50 ? 12.0 : 8.0);
+    }
+}
+
+TEST(NativeEncoding, WebPRandomizedRoundTrip)
+{
+    // Random sizes, content and orientations, which bimg has to decode to exactly the pixels.
+    std::mt19937 random{2049};
+    for (int iteration = 0; iteration < 200; ++iteration)
+    {
+        const auto width{static_cast<uint32_t>(1 + random() % (iteration % 10 == 0 ? 600 : 96))};
+        const auto height{static_cast<uint32_t>(1 + random() % (iteration % 10 == 0 ? 400 : 96))};
+        const auto pixels{MakeRandomImage(random, width, height)};
+        const WebP::Options options{random() % 2 == 0};
+        SCOPED_TRACE(std::to_string(width) + " x " + std::to_string(height) + (options.FlipY ? ", flipped" : ""));
+
+        const auto webp{WebP::Encode(pixels.data(), width, height, options)};
+        EXPECT_TRUE(IsWellFormedWebP(webp, width, height));
+#ifdef HAS_BIMG_WEBP
+        EXPECT_EQ(Decode(webp, width, height), options.FlipY ? FlipRows(pixels, width, height) : pixels);
+#endif
+    }
+}
+
+TEST(NativeEncoding, FormatBenchmark)
+{
+    // Size and time of each format against PNG for a 4K frame, with the ranges of PNG and JPEG
+    // spread over every core as EncodeImageAsync does. WebP is encoded by a single task.
+    constexpr uint32_t width{3840};
+    constexpr uint32_t height{2160};
+    const auto pixels{MakeFrame(width, height)};
+
+    const auto report = [&](const std::string& name, const std::vector<std::byte>& file, double milliseconds) {
+        std::cout << "  " << name << ": " << file.size() / 1024 << " KB, " << milliseconds << " ms, " << Psnr(pixels, Decode(file, width, height)) << " dB" << std::endl;
+    };
+
+    std::cout << "Encode of " << width << " x " << height << " RGBA, " << std::max(std::thread::hardware_concurrency(), 1u) << " threads:" << std::endl;
+    for (const int level : {1, Png::DEFAULT_COMPRESSION_LEVEL})
+    {
+        std::vector<std::byte> png{};
+        const double milliseconds{MeasureMilliseconds([&]() { png = ParallelEncode(pixels, width, height, {level, false}); })};
+        report("PNG level " + std::to_string(level), png, milliseconds);
+    }
+    for (const int quality : {75, Jpeg::DEFAULT_QUALITY})
+    {
+        std::vector<std::byte> jpeg{};
+        const double milliseconds{MeasureMilliseconds([&]() { jpeg = ParallelEncodeJpeg(pixels, width, height, {quality, false}); })};
+        report("JPEG quality " + std::to_string(quality), jpeg, milliseconds);
+    }
+#ifdef HAS_BIMG_WEBP
+    std::vector<std::byte> webp{};
+    const double milliseconds{MeasureMilliseconds([&]() { webp = WebP::Encode(pixels.data(), width, height, {}); })};
+    report("WebP lossless", webp, milliseconds);
+#endif
+}
+
+TEST(NativeEncoding, EncodeQueueBoundsConcurrency)
+{
+    constexpr size_t maxInFlight{2};
+    constexpr size_t count{200};
+    EncodeQueue queue{maxInFlight, count};
+
+    std::mutex mutex{};
+    size_t running{};
+    size_t peakRunning{};
+    size_t completed{};
+    size_t peakReported{};
+    std::promise<void> done{};
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        queue.Submit([&](arcana::cancellation& cancellation) {
+                 return arcana::make_task(arcana::threadpool_scheduler, cancellation, [&]() {
+                     {
+                         std::scoped_lock lock{mutex};
+                         peakRunning = std::max(peakRunning, ++running);
+                     }
+                     std::this_thread::sleep_for(100us);
+                     std::scoped_lock lock{mutex};
+                     --running;
+                 });
+             })
+            .then(arcana::inline_scheduler, arcana::cancellation::none(), [&](const arcana::expected<EncodeQueue::Timings, std::exception_ptr>& result) {
+                std::scoped_lock lock{mutex};
+                EXPECT_FALSE(result.has_error());
+                peakReported = std::max(peakReported, result.has_error() ? 0 : result.value().InFlight);
+                if (++completed == count)
+                {
+                    done.set_value();
+                }
+            });
+    }
+
+    ASSERT_EQ(done.get_future().wait_for(60s), std::future_status::ready);
+    queue.Wait();
+
+    EXPECT_LE(peakRunning, maxInFlight);
+    EXPECT_LE(peakReported, maxInFlight);
+    const auto stats{queue.GetStats()};
+    EXPECT_EQ(stats.Submitted, count);
+    EXPECT_EQ(stats.Completed, count);
+    EXPECT_EQ(stats.Failed + stats.Rejected + stats.Cancelled, 0u);
+    EXPECT_LE(stats.PeakInFlight, maxInFlight);
+    EXPECT_LE(stats.PeakQueued, count);
+}
+
+TEST(NativeEncoding, EncodeQueueBackpressureAndCancel)
+{
+    constexpr size_t maxQueued{4};
+    EncodeQueue queue{1, maxQueued};
+
+    // Runs until the gate opens, and skips its last step once cancelled.
+    arcana::task_completion_source<void, std::exception_ptr> gate{};
+    std::atomic<bool> skipped{true};
+    std::atomic<size_t> cancelled{};
+    std::promise<bool> blockerFailed{};
+
+    queue.Submit([&](arcana::cancellation& cancellation) {
+             return gate.as_task().then(arcana::threadpool_scheduler, cancellation, [&]() { skipped = false; });
+         })
+        .then(arcana::inline_scheduler, arcana::cancellation::none(), [&](const arcana::expected<EncodeQueue::Timings, std::exception_ptr>& result) {
+            blockerFailed.set_value(result.has_error());
+        });
+
+    for (size_t index = 0; index < maxQueued; ++index)
+    {
+        queue.Submit([](arcana::cancellation&) -> arcana::task<void, std::exception_ptr> {
+                 ADD_FAILURE() << "A cancelled encode started.";
+                 return arcana::task_from_result<std::exception_ptr>();
+             })
+            .then(arcana::inline_scheduler, arcana::cancellation::none(), [&](const arcana::expected<EncodeQueue::Timings, std::exception_ptr>& result) {
+                if (result.has_error() && IsCancelled(result.error()))
+                {
+                    ++cancelled;
+                }
+            });
+    }
+    EXPECT_THROW(queue.Submit([](arcana::cancellation&) { return arcana::task_from_result<std::exception_ptr>(); }), std::length_error);
+
+    // The waiting encodes are cancelled straight away, the running one when it next checks.
+    queue.Cancel();
+    EXPECT_EQ(cancelled.load(), maxQueued);
+
+    queue.Submit([](arcana::cancellation&) { return arcana::task_from_result<std::exception_ptr>(); })
+        .then(arcana::inline_scheduler, arcana::cancellation::none(), [&](const arcana::expected<EncodeQueue::Timings, std::exception_ptr>& result) {
+            EXPECT_TRUE(result.has_error() && IsCancelled(result.error()));
+        });
+
+    gate.complete();
+    queue.Wait();
+    auto blockerFuture{blockerFailed.get_future()};
+    ASSERT_EQ(blockerFuture.wait_for(0s), std::future_status::ready);
+    EXPECT_TRUE(blockerFuture.get());
+    EXPECT_TRUE(skipped.load());
+
+    const auto stats{queue.GetStats()};
+    EXPECT_EQ(stats.Submitted, maxQueued + 1);
+    EXPECT_EQ(stats.Rejected, 1u);
+    EXPECT_EQ(stats.Cancelled, maxQueued + 1);
+    EXPECT_EQ(stats.Failed, 1u);
+    EXPECT_EQ(stats.Completed, 0u);
+    EXPECT_EQ(stats.PeakInFlight, 1u);
+    EXPECT_EQ(stats.PeakQueued, maxQueued);
+}
+
+TEST(NativeEncoding, EncodeImageAsync)
+{
+    constexpr uint32_t width{300};
+    constexpr uint32_t height{200};
+    const auto pixels{MakeFrame(width, height)};
+
+    struct Result
+    {
+        std::vector<std::byte> Stored{};
+        std::vector<std::byte> Compressed{};
+        bool RangeError{};
+        std::vector<std::byte> Lossy{};
+        std::string Types{};
+    };
+    std::promise<Result> resultPromise{};
+
+    Babylon::AppRuntime::Options options{};
+    options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+        std::quick_exit(1);
+    };
+
+    std::optional<Babylon::AppRuntime> runtime{std::in_place, options};
+    runtime->Dispatch([&pixels, &resultPromise](Napi::Env env) {
+        Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+            std::cout << message << std::endl;
+        });
+        Babylon::Polyfills::Blob::Initialize(env);
+        Babylon::Plugins::NativeEncoding::Initialize(env);
+
+        auto pixelData = Napi::Uint8Array::New(env, pixels.size());
+        std::memcpy(pixelData.Data(), pixels.data(), pixels.size());
+        env.Global().Set("pixelData", pixelData);
+
+        env.Global().Set("reportResult", Napi::Function::New(env, [&resultPromise](const Napi::CallbackInfo& info) {
+            const auto bytes = [](const Napi::Value& value) {
+                const auto buffer = value.As<Napi::ArrayBuffer>();
+                const auto* data = static_cast<const std::byte*>(buffer.Data());
+                return std::vector<std::byte>(data, data + buffer.ByteLength());
+            };
+            resultPromise.set_value({bytes(info[0]), bytes(info[1]), info[2].As<Napi::Boolean>().Value(), bytes(info[3]), info[4].As<Napi::String>().Utf8Value()});
+        }, "reportResult"));
+    });
+
+    Babylon::ScriptLoader loader{*runtime};
+    loader.Eval(R"(
+        const rangeError = _native.EncodeImageAsync(pixelData, 300, 200, "image/png", true, { compressionLevel: 11 })
+            .then(() => false, (error) => error instanceof RangeError);
+        Promise.all([
+            _native.EncodeImageAsync(pixelData, 300, 200, "image/png", true, { compressionLevel: 0 }).then((blob) => blob.arrayBuffer()),
+            _native.EncodeImageAsync(pixelData, 300, 200, "image/png", true).then((blob) => blob.arrayBuffer()),
+            rangeError,
+            _native.EncodeImageAsync(pixelData, 300, 200, "image/jpeg", true, { quality: 0.75 }).then((blob) => blob.arrayBuffer()),
+            Promise.all(["image/png", "image/jpeg", "image/webp", "image/bmp"].map((type) =>
+                _native.EncodeImageAsync(pixelData, 300, 200, type, true).then((blob) => blob.type))),
+        ]).then(([stored, compressed, rangeError, jpeg, types]) => reportResult(stored, compressed, rangeError, jpeg, types.join()));
+    )", "EncodeImageAsync");
+
+    auto resultFuture{resultPromise.get_future()};
+    ASSERT_EQ(resultFuture.wait_for(60s), std::future_status::ready);
+    const auto result{resultFuture.get()};
+    runtime.reset();
+
+    EXPECT_EQ(Decode(result.Stored, width, height), pixels);
+    EXPECT_EQ(Decode(result.Compressed, width, height), pixels);
+    EXPECT_EQ(result.Compressed, Png::Encode(pixels.data(), width, height, {Png::DEFAULT_COMPRESSION_LEVEL, false}));
+    EXPECT_LT(result.Compressed.size(), result.Stored.size() / 4);
+    EXPECT_TRUE(result.RangeError);
+    EXPECT_EQ(result.Lossy, Jpeg::Encode(pixels.data(), width, height, {75, false}));
+    // As with canvas.toBlob, a type that is not supported falls back to PNG.
+    EXPECT_EQ(result.Types, "image/png,image/jpeg,image/webp,image/png");
+}
+
+TEST(NativeEncoding, EncodeImageAsyncTeardown)
+{
+    // Hundreds of encodes of a few frames each, behind a small queue: the first runtime waits for
+    // them and checks their timings, the others are torn down as soon as they are issued.
+    constexpr uint32_t width{256};
+    constexpr uint32_t height{256};
+    constexpr uint32_t count{300};
+    const auto pixels{MakeFrame(width, height)};
+
+    Babylon::AppRuntime::Options options{};
+    options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+        std::quick_exit(1);
+    };
+
+    const auto run = [&](const Babylon::Plugins::NativeEncoding::Configuration& configuration, const char* script, std::promise<std::pair<uint32_t, uint32_t>>& resultPromise) {
+        std::optional<Babylon::AppRuntime> runtime{std::in_place, options};
+        runtime->Dispatch([&](Napi::Env env) {
+            Babylon::Polyfills::Blob::Initialize(env);
+            Babylon::Plugins::NativeEncoding::Initialize(env, configuration);
+
+            auto pixelData = Napi::Uint8Array::New(env, pixels.size());
+            std::memcpy(pixelData.Data(), pixels.data(), pixels.size());
+            env.Global().Set("pixelData", pixelData);
+
+            env.Global().Set("reportResult", Napi::Function::New(env, [&resultPromise](const Napi::CallbackInfo& info) {
+                resultPromise.set_value({info[0].As<Napi::Number>().Uint32Value(), info[1].As<Napi::Number>().Uint32Value()});
+            }, "reportResult"));
+        });
+
+        Babylon::ScriptLoader loader{*runtime};
+        loader.Eval(script, "EncodeImageAsyncTeardown");
+
+        auto resultFuture{resultPromise.get_future()};
+        EXPECT_EQ(resultFuture.wait_for(120s), std::future_status::ready);
+        const auto result{resultFuture.get()};
+
+        // Only the running encodes are waited for, and their rows skipped once cancelled.
+        const double milliseconds{MeasureMilliseconds([&]() { runtime.reset(); })};
+        EXPECT_LT(milliseconds, 10000.0);
+        return result;
+    };
+
+    {
+        std::promise<std::pair<uint32_t, uint32_t>> resultPromise{};
+        const auto [resolved, peakInFlight]{run({2, count}, R"(
+            let peakInFlight = 0;
+            const onTimings = (timings) => {
+                if (timings.queuedMilliseconds < 0 || timings.encodeMilliseconds < 0 || timings.byteLength === 0) {
+                    throw new Error("Invalid timings.");
+                }
+                peakInFlight = Math.max(peakInFlight, timings.inFlight);
+            };
+            const types = ["image/png", "image/jpeg", "image/webp"];
+            Promise.all(Array.from({ length: 300 }, (_, index) =>
+                _native.EncodeImageAsync(pixelData, 256, 256, types[index % 3], true, { onTimings })))
+                .then((blobs) => reportResult(blobs.length, peakInFlight));
+        )", resultPromise)};
+        EXPECT_EQ(resolved, count);
+        EXPECT_GE(peakInFlight, 1u);
+        EXPECT_LE(peakInFlight, 2u);
+    }
+
+    for (int round = 0; round < 5; ++round)
+    {
+        SCOPED_TRACE(round);
+
+        // The rejections of a full queue are handled before issued is reported, the encodes that
+        // were accepted are still queued or running when the runtime goes away.
+        std::promise<std::pair<uint32_t, uint32_t>> resultPromise{};
+        const auto [issued, rejected]{run({1, 64}, R"(
+            let rejected = 0;
+            const types = ["image/png", "image/jpeg", "image/webp"];
+            for (let index = 0; index < 300; ++index) {
+                _native.EncodeImageAsync(pixelData, 256, 256, types[index % 3], true).catch(() => ++rejected);
+            }
+            Promise.resolve().then(() => reportResult(300, rejected));
+        )", resultPromise)};
+        EXPECT_EQ(issued, count);
+        EXPECT_GT(rejected, 0u);
+        EXPECT_LE(rejected, count - 64 - 1);
+    }
+}
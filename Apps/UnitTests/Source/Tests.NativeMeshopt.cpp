@@ -0,0 +1,586 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Plugins/NativeMeshopt.h>
+#include <Babylon/Plugins/NativeMeshoptInternal.h>
+#include <Babylon/Polyfills/Console.h>
+#include <Babylon/ScriptLoader.h>
+
+#include <meshoptimizer.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    namespace Decoding = Babylon::Plugins::NativeMeshopt::Decoding;
+    namespace Processing = Babylon::Plugins::NativeMeshopt::Processing;
+
+    struct EncodedView
+    {
+        std::vector<unsigned char> Encoded{};
+        size_t Count{};
+        size_t Stride{};
+        const char* Mode{};
+        const char* Filter{};
+    };
+
+    std::vector<unsigned char> EncodeVertices(size_t count, size_t stride, uint32_t seed)
+    {
+        // Slowly varying floats, as vertex attributes are, with some noise.
+        std::mt19937 random{seed};
+        std::vector<float> vertices(count * stride / sizeof(float));
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            vertices[i] = std::sin(static_cast<float>(i / (stride / sizeof(float))) * 0.01f) + static_cast<float>(random() % 16) / 1024.0f;
+        }
+
+        std::vector<unsigned char> encoded(meshopt_encodeVertexBufferBound(count, stride));
+        encoded.resize(meshopt_encodeVertexBuffer(encoded.data(), encoded.size(), vertices.data(), count, stride));
+        return encoded;
+    }
+
+    std::vector<unsigned int> GridIndices(size_t triangles)
+    {
+        std::vector<unsigned int> indices{};
+        for (unsigned int cell = 0; indices.size() < triangles * 3; ++cell)
+        {
+            const unsigned int row{cell / 64}, column{cell % 64};
+            const unsigned int corner{row * 65 + column};
+            indices.insert(indices.end(), {corner, corner + 65, corner + 1, corner + 1, corner + 65, corner + 66});
+        }
+        indices.resize(triangles * 3);
+        return indices;
+    }
+
+    // The views of an asset: mostly vertex attributes, some with filters, and index buffers of
+    // both kinds, with counts that are not multiples of 4.
+    std::vector<EncodedView> EncodeAsset(size_t viewCount)
+    {
+        std::vector<EncodedView> views{};
+        for (size_t i = 0; i < viewCount; ++i)
+        {
+            const size_t count{1000 + (i * 7919) % 20000};
+            EncodedView view{};
+            switch (i % 5)
+            {
+                case 0:
+                    view = {EncodeVertices(count, 16, static_cast<uint32_t>(i)), count, 16, "ATTRIBUTES", "NONE"};
+                    break;
+                case 1:
+                    view = {EncodeVertices(count, 16, static_cast<uint32_t>(i)), count, 16, "ATTRIBUTES", "EXPONENTIAL"};
+                    break;
+                case 2:
+                    view = {EncodeVertices(count, 8, static_cast<uint32_t>(i)), count, 8, "ATTRIBUTES", i % 2 ? "OCTAHEDRAL" : "QUATERNION"};
+                    break;
+                case 3:
+                {
+                    const auto indices{GridIndices(count / 3)};
+                    view.Encoded.resize(meshopt_encodeIndexBufferBound(indices.size(), 65 * 65 * 64));
+                    view.Encoded.resize(meshopt_encodeIndexBuffer(view.Encoded.data(), view.Encoded.size(), indices.data(), indices.size()));
+                    view.Count = indices.size();
+                    view.Stride = i % 2 ? 4 : 2;
+                    view.Mode = "TRIANGLES";
+                    view.Filter = "NONE";
+                    break;
+                }
+                default:
+                {
+                    const auto indices{GridIndices(count / 3)};
+                    view.Encoded.resize(meshopt_encodeIndexSequenceBound(indices.size(), 65 * 65 * 64));
+                    view.Encoded.resize(meshopt_encodeIndexSequence(view.Encoded.data(), view.Encoded.size(), indices.data(), indices.size()));
+                    view.Count = indices.size();
+                    view.Stride = 4;
+                    view.Mode = "INDICES";
+                    view.Filter = "NONE";
+                    break;
+                }
+            }
+            views.push_back(std::move(view));
+        }
+        return views;
+    }
+
+    // A wavy square of `cells` x `cells` quads, with its triangles in a random order, as a mesh
+    // that was never optimized has them.
+    struct Surface
+    {
+        std::vector<uint32_t> Indices{};
+        std::vector<float> Positions{};
+        size_t VertexCount{};
+    };
+
+    Surface MakeSurface(uint32_t cells)
+    {
+        Surface surface{};
+        const uint32_t side{cells + 1};
+        surface.VertexCount = side * side;
+        for (uint32_t row = 0; row < side; ++row)
+        {
+            for (uint32_t column = 0; column < side; ++column)
+            {
+                const float x{static_cast<float>(column) / cells}, z{static_cast<float>(row) / cells};
+                surface.Positions.insert(surface.Positions.end(), {x, 0.05f * std::sin(x * 6.0f) * std::cos(z * 6.0f), z});
+            }
+        }
+
+        std::vector<std::array<uint32_t, 3>> triangles{};
+        for (uint32_t row = 0; row < cells; ++row)
+        {
+            for (uint32_t column = 0; column < cells; ++column)
+            {
+                const uint32_t corner{row * side + column};
+                triangles.push_back({corner, corner + side, corner + 1});
+                triangles.push_back({corner + 1, corner + side, corner + side + 1});
+            }
+        }
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937{cells});
+        for (const auto& triangle : triangles)
+        {
+            surface.Indices.insert(surface.Indices.end(), triangle.begin(), triangle.end());
+        }
+        return surface;
+    }
+
+    size_t UsedVertexCount(const std::vector<uint32_t>& indices)
+    {
+        return std::set<uint32_t>{indices.begin(), indices.end()}.size();
+    }
+
+    template<typename CallableT>
+    double MeasureMilliseconds(CallableT callable)
+    {
+        const auto start{std::chrono::steady_clock::now()};
+        callable();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // The reference meshopt_decoder.js decode(): decode and filter count rounded up to a
+    // multiple of 4, and keep the first count elements.
+    std::vector<unsigned char> DecodeReference(const EncodedView& view)
+    {
+        const size_t count4{(view.Count + 3) & ~size_t{3}};
+        std::vector<unsigned char> decoded(count4 * view.Stride);
+        const std::string mode{view.Mode};
+        const int result{mode == "ATTRIBUTES" ? meshopt_decodeVertexBuffer(decoded.data(), view.Count, view.Stride, view.Encoded.data(), view.Encoded.size())
+                         : mode == "TRIANGLES" ? meshopt_decodeIndexBuffer(decoded.data(), view.Count, view.Stride, view.Encoded.data(), view.Encoded.size())
+                                               : meshopt_decodeIndexSequence(decoded.data(), view.Count, view.Stride, view.Encoded.data(), view.Encoded.size())};
+        EXPECT_EQ(result, 0);
+
+        const std::string filter{view.Filter};
+        if (filter == "OCTAHEDRAL")
+        {
+            meshopt_decodeFilterOct(decoded.data(), count4, view.Stride);
+        }
+        else if (filter == "QUATERNION")
+        {
+            meshopt_decodeFilterQuat(decoded.data(), count4, view.Stride);
+        }
+        else if (filter == "EXPONENTIAL")
+        {
+            meshopt_decodeFilterExp(decoded.data(), count4, view.Stride);
+        }
+
+        decoded.resize(view.Count * view.Stride);
+        return decoded;
+    }
+}
+
+TEST(NativeMeshopt, DecodeInPlaceMatchesReference)
+{
+    for (const auto& encoded : EncodeAsset(40))
+    {
+        Decoding::BufferView view{};
+        view.Source = encoded.Encoded.data();
+        view.SourceSize = encoded.Encoded.size();
+        view.Count = encoded.Count;
+        view.Stride = encoded.Stride;
+        view.Mode = Decoding::ParseMode(encoded.Mode);
+        view.Filter = Decoding::ParseFilter(encoded.Filter);
+        Decoding::Validate(static_cast<int64_t>(view.Count), static_cast<int64_t>(view.Stride), view.Mode);
+
+        std::vector<unsigned char> decoded(view.Count * view.Stride);
+        view.Destination = decoded.data();
+        Decoding::Decode(view);
+        EXPECT_EQ(decoded, DecodeReference(encoded)) << encoded.Mode << " " << encoded.Filter << ", " << encoded.Count << " x " << encoded.Stride;
+    }
+
+    EXPECT_THROW(Decoding::ParseMode("NOT_A_MODE"), std::invalid_argument);
+    EXPECT_THROW(Decoding::Validate(9, 6, Decoding::Mode::Attributes), std::out_of_range);
+    EXPECT_THROW(Decoding::Validate(10, 4, Decoding::Mode::Triangles), std::out_of_range);
+
+    const unsigned char garbage[16]{};
+    std::vector<unsigned char> decoded(64 * 16);
+    Decoding::BufferView view{garbage, sizeof(garbage), 64, 16, Decoding::Mode::Attributes, Decoding::Filter::None, decoded.data()};
+    EXPECT_THROW(Decoding::Decode(view), std::runtime_error);
+}
+
+// Decodes a 500 buffer view asset with one DecodeBatchAsync call and with a Decode call per view,
+// checking they agree and printing how long each took.
+TEST(NativeMeshopt, DecodeBatchAsync)
+{
+    constexpr size_t VIEWS = 500;
+    const auto views{EncodeAsset(VIEWS)};
+
+    std::promise<std::map<std::string, double>> resultPromise{};
+
+    Babylon::AppRuntime::Options options{};
+    options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+        std::quick_exit(1);
+    };
+
+    std::optional<Babylon::AppRuntime> runtime{std::in_place, options};
+    runtime->Dispatch([&views, &resultPromise](Napi::Env env) {
+        Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+            std::cout << message << std::endl;
+        });
+        Babylon::Plugins::NativeMeshopt::Initialize(env);
+
+        auto array = Napi::Array::New(env, views.size());
+        for (uint32_t i = 0; i < views.size(); ++i)
+        {
+            auto source = Napi::Uint8Array::New(env, views[i].Encoded.size());
+            std::memcpy(source.Data(), views[i].Encoded.data(), views[i].Encoded.size());
+
+            auto view = Napi::Object::New(env);
+            view.Set("source", source);
+            view.Set("count", Napi::Number::New(env, static_cast<double>(views[i].Count)));
+            view.Set("stride", Napi::Number::New(env, static_cast<double>(views[i].Stride)));
+            view.Set("mode", Napi::String::New(env, views[i].Mode));
+            view.Set("filter", Napi::String::New(env, views[i].Filter));
+            array.Set(i, view);
+        }
+        env.Global().Set("views", array);
+
+        env.Global().Set("reportResult", Napi::Function::New(env, [&resultPromise](const Napi::CallbackInfo& info) {
+            const auto object = info[0].As<Napi::Object>();
+            std::map<std::string, double> result{};
+            for (const char* key : {"mismatch", "rejected", "decodeMilliseconds", "batchMilliseconds"})
+            {
+                result[key] = object.Get(key).As<Napi::Number>().DoubleValue();
+            }
+            resultPromise.set_value(std::move(result));
+        }, "reportResult"));
+    });
+
+    Babylon::ScriptLoader loader{*runtime};
+    loader.Eval(R"(
+        const codec = _native.MeshoptCodec;
+        const same = (a, b) => a.length === b.length && a.every((value, i) => value === b[i]);
+
+        let start = Date.now();
+        const expected = views.map((view) => codec.Decode(view.source, view.count, view.stride, view.mode, view.filter));
+        const decodeMilliseconds = Date.now() - start;
+
+        const batch = views.map((view) => Object.assign({ destination: new Uint8Array(view.count * view.stride) }, view));
+        start = Date.now();
+        codec.DecodeBatchAsync(batch).then(() => {
+            const batchMilliseconds = Date.now() - start;
+            const mismatch = batch.findIndex((view, i) => !same(view.destination, expected[i]));
+            const malformed = batch.slice(0, 3);
+            malformed[1] = Object.assign({}, malformed[1], { source: new Uint8Array(16) });
+            return codec.DecodeBatchAsync(malformed).then(
+                () => reportResult({ mismatch, rejected: 0, decodeMilliseconds, batchMilliseconds }),
+                () => reportResult({ mismatch, rejected: 1, decodeMilliseconds, batchMilliseconds }));
+        });
+    )", "DecodeBatchAsync");
+
+    auto resultFuture{resultPromise.get_future()};
+    ASSERT_EQ(resultFuture.wait_for(120s), std::future_status::ready);
+    const auto result{resultFuture.get()};
+    runtime.reset();
+
+    EXPECT_EQ(result.at("mismatch"), -1);
+    EXPECT_EQ(result.at("rejected"), 1);
+    std::cout << "Meshopt decode of " << VIEWS << " buffer views: " << result.at("decodeMilliseconds") << " ms with Decode, "
+              << result.at("batchMilliseconds") << " ms with DecodeBatchAsync" << std::endl;
+}
+
+TEST(NativeMeshopt, AsyncTeardown)
+{
+    // Batches and processing calls are still queued or running on the thread pool when the
+    // runtime goes away. Tearing it down cancels them and waits for the running ones, before the
+    // arrays they write to are freed.
+    constexpr uint32_t BATCHES = 8;
+    const auto views{EncodeAsset(500)};
+    const auto surface{MakeSurface(128)};
+
+    Babylon::AppRuntime::Options options{};
+    options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+        std::quick_exit(1);
+    };
+
+    for (int round = 0; round < 5; ++round)
+    {
+        SCOPED_TRACE(round);
+
+        std::promise<uint32_t> issuedPromise{};
+        std::optional<Babylon::AppRuntime> runtime{std::in_place, options};
+        runtime->Dispatch([&views, &surface, &issuedPromise](Napi::Env env) {
+            Babylon::Plugins::NativeMeshopt::Initialize(env);
+
+            auto array = Napi::Array::New(env, views.size());
+            for (uint32_t i = 0; i < views.size(); ++i)
+            {
+                auto source = Napi::Uint8Array::New(env, views[i].Encoded.size());
+                std::memcpy(source.Data(), views[i].Encoded.data(), views[i].Encoded.size());
+
+                auto view = Napi::Object::New(env);
+                view.Set("source", source);
+                view.Set("count", Napi::Number::New(env, static_cast<double>(views[i].Count)));
+                view.Set("stride", Napi::Number::New(env, static_cast<double>(views[i].Stride)));
+                view.Set("mode", Napi::String::New(env, views[i].Mode));
+                view.Set("filter", Napi::String::New(env, views[i].Filter));
+                array.Set(i, view);
+            }
+            env.Global().Set("views", array);
+
+            auto indices = Napi::Uint32Array::New(env, surface.Indices.size());
+            std::copy(surface.Indices.begin(), surface.Indices.end(), indices.Data());
+            auto positions = Napi::Float32Array::New(env, surface.Positions.size());
+            std::copy(surface.Positions.begin(), surface.Positions.end(), positions.Data());
+            env.Global().Set("indices", indices);
+            env.Global().Set("positions", positions);
+
+            env.Global().Set("reportIssued", Napi::Function::New(env, [&issuedPromise](const Napi::CallbackInfo& info) {
+                issuedPromise.set_value(info[0].As<Napi::Number>().Uint32Value());
+            }, "reportIssued"));
+        });
+
+        Babylon::ScriptLoader loader{*runtime};
+        loader.Eval(R"(
+            const batches = )" + std::to_string(BATCHES) + R"(;
+            for (let batch = 0; batch < batches; ++batch) {
+                _native.MeshoptCodec.DecodeBatchAsync(views.map((view) => Object.assign({ destination: new Uint8Array(view.count * view.stride) }, view)));
+                _native.MeshoptProcessing.SimplifyAsync(indices, positions, 3, indices.length / 8, 1);
+            }
+            reportIssued(batches);
+        )", "AsyncTeardown");
+
+        auto issuedFuture{issuedPromise.get_future()};
+        ASSERT_EQ(issuedFuture.wait_for(60s), std::future_status::ready);
+        EXPECT_EQ(issuedFuture.get(), BATCHES);
+
+        // Only the running work is waited for, and a batch stops after the views it is decoding.
+        const double milliseconds{MeasureMilliseconds([&]() { runtime.reset(); })};
+        EXPECT_LT(milliseconds, 10000.0);
+    }
+}
+
+TEST(NativeMeshopt, OptimizeVertexCacheReducesCacheMisses)
+{
+    const auto surface{MakeSurface(64)};
+    const float shuffled{Processing::AverageCacheMissRatio(surface.Indices, surface.VertexCount)};
+
+    const auto optimized{Processing::OptimizeVertexCache(surface.Indices, surface.VertexCount)};
+    ASSERT_EQ(optimized.size(), surface.Indices.size());
+    const float cacheOptimized{Processing::AverageCacheMissRatio(optimized, surface.VertexCount)};
+
+    // A shuffled grid misses nearly every vertex, about 3 per triangle, while an optimized one
+    // approaches the 0.5 of a regular grid.
+    EXPECT_GT(shuffled, 2.0f);
+    EXPECT_LT(cacheOptimized, 0.8f);
+
+    const auto overdraw{Processing::OptimizeOverdraw(optimized, surface.Positions, 3, 1.05f)};
+    ASSERT_EQ(overdraw.size(), surface.Indices.size());
+    EXPECT_LE(Processing::AverageCacheMissRatio(overdraw, surface.VertexCount), cacheOptimized * 1.05f + 0.05f);
+
+    std::cout << "Meshopt ACMR of a " << surface.Indices.size() / 3 << " triangle grid: " << shuffled << " shuffled, "
+              << cacheOptimized << " after OptimizeVertexCache" << std::endl;
+}
+
+TEST(NativeMeshopt, SimplifyReducesIndexAndVertexCounts)
+{
+    const auto surface{MakeSurface(64)};
+    const size_t target{surface.Indices.size() / 4 / 3 * 3};
+
+    const auto simplified{Processing::Simplify(surface.Indices, surface.Positions, 3, target, 1.0f, false)};
+    EXPECT_GT(simplified.Indices.size(), 0u);
+    EXPECT_LE(simplified.Indices.size(), target);
+    EXPECT_EQ(simplified.Indices.size() % 3, 0u);
+    EXPECT_LT(UsedVertexCount(simplified.Indices), surface.VertexCount / 2);
+
+    // Locking the border keeps every vertex on it.
+    const auto locked{Processing::Simplify(surface.Indices, surface.Positions, 3, target, 1.0f, true)};
+    const std::set<uint32_t> lockedVertices{locked.Indices.begin(), locked.Indices.end()};
+    for (uint32_t column = 0; column <= 64; ++column)
+    {
+        EXPECT_EQ(lockedVertices.count(column), 1u) << column;
+    }
+
+    // An error bound below what the target needs stops simplification early.
+    const auto bounded{Processing::Simplify(surface.Indices, surface.Positions, 3, 0, 1e-3f, false)};
+    EXPECT_GT(bounded.Indices.size(), 0u);
+    EXPECT_LE(bounded.Error, 1e-3f);
+
+    const auto sloppy{Processing::SimplifySloppy(surface.Indices, surface.Positions, 3, surface.Indices.size() / 10, 1.0f)};
+    EXPECT_GT(sloppy.Indices.size(), 0u);
+    EXPECT_LE(sloppy.Indices.size(), surface.Indices.size() / 10);
+    EXPECT_LT(UsedVertexCount(sloppy.Indices), surface.VertexCount / 5);
+
+    EXPECT_THROW(Processing::ValidateIndices({0, 1}, 3), std::out_of_range);
+    EXPECT_THROW(Processing::ValidateIndices({0, 1, 3}, 3), std::out_of_range);
+    EXPECT_NO_THROW(Processing::ValidateIndices({0, 1, 2}, 3));
+    EXPECT_THROW(Processing::ValidatePositionStride(2), std::out_of_range);
+    EXPECT_THROW(Processing::ValidateVertexSize(0), std::out_of_range);
+}
+
+TEST(NativeMeshopt, BuildLods)
+{
+    const auto surface{MakeSurface(64)};
+    const auto lods{Processing::BuildLods(surface.Indices, surface.Positions, 3, {0.5f, 0.25f, 0.125f}, 1.0f)};
+    ASSERT_EQ(lods.size(), 3u);
+
+    size_t previousCount{surface.Indices.size()};
+    float previousError{};
+    for (const auto& lod : lods)
+    {
+        EXPECT_LT(lod.Indices.size(), previousCount);
+        EXPECT_GE(lod.Error, previousError);
+        EXPECT_LT(Processing::AverageCacheMissRatio(lod.Indices, surface.VertexCount), 1.0f);
+        previousCount = lod.Indices.size();
+        previousError = lod.Error;
+    }
+    EXPECT_LE(lods.back().Indices.size(), surface.Indices.size() / 8);
+    EXPECT_TRUE(Processing::BuildLods(surface.Indices, surface.Positions, 3, {}, 1.0f).empty());
+}
+
+TEST(NativeMeshopt, OptimizeVertexFetchPreservesTriangles)
+{
+    const auto surface{MakeSurface(32)};
+    const auto indices{Processing::OptimizeVertexCache(surface.Indices, surface.VertexCount)};
+
+    // Vertices are the positions plus one unused vertex at the end, which is dropped.
+    std::vector<unsigned char> vertices((surface.VertexCount + 1) * 3 * sizeof(float));
+    std::memcpy(vertices.data(), surface.Positions.data(), surface.Positions.size() * sizeof(float));
+
+    const auto optimized{Processing::OptimizeVertexFetch(indices, vertices, 3 * sizeof(float))};
+    EXPECT_EQ(optimized.VertexCount, surface.VertexCount);
+    ASSERT_EQ(optimized.Vertices.size(), surface.VertexCount * 3 * sizeof(float));
+    ASSERT_EQ(optimized.Indices.size(), indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        ASSERT_EQ(std::memcmp(optimized.Vertices.data() + optimized.Indices[i] * 3 * sizeof(float), vertices.data() + indices[i] * 3 * sizeof(float), 3 * sizeof(float)), 0) << i;
+    }
+
+    // The vertices are in the order the indices first use them.
+    uint32_t next{};
+    for (const uint32_t index : optimized.Indices)
+    {
+        ASSERT_LE(index, next);
+        next = std::max(next, index + 1);
+    }
+}
+
+// Times each operation on a million triangle mesh, the size LODs are generated for at load time.
+TEST(NativeMeshopt, ProcessingBenchmark)
+{
+    const auto surface{MakeSurface(708)};
+    std::vector<uint32_t> cacheOptimized{};
+    std::vector<Processing::Simplified> lods{};
+
+    const double cache{MeasureMilliseconds([&]() { cacheOptimized = Processing::OptimizeVertexCache(surface.Indices, surface.VertexCount); })};
+    const double overdraw{MeasureMilliseconds([&]() { Processing::OptimizeOverdraw(cacheOptimized, surface.Positions, 3, 1.05f); })};
+    const double simplify{MeasureMilliseconds([&]() { Processing::Simplify(surface.Indices, surface.Positions, 3, surface.Indices.size() / 10, 1e-2f, false); })};
+    const double sloppy{MeasureMilliseconds([&]() { Processing::SimplifySloppy(surface.Indices, surface.Positions, 3, surface.Indices.size() / 10, 1e-2f); })};
+    const double buildLods{MeasureMilliseconds([&]() { lods = Processing::BuildLods(surface.Indices, surface.Positions, 3, {0.5f, 0.25f, 0.125f, 0.0625f}, 1e-2f); })};
+    EXPECT_FALSE(lods.empty());
+
+    std::cout << "Meshopt processing of " << surface.Indices.size() / 3 << " triangles: OptimizeVertexCache " << cache
+              << " ms, OptimizeOverdraw " << overdraw << " ms, Simplify " << simplify << " ms, SimplifySloppy " << sloppy
+              << " ms, BuildLods (" << lods.size() << " levels) " << buildLods << " ms" << std::endl;
+}
+
+// Runs the MeshoptProcessing functions from JavaScript on a small surface.
+TEST(NativeMeshopt, ProcessingAsync)
+{
+    const auto surface{MakeSurface(32)};
+
+    std::promise<std::map<std::string, double>> resultPromise{};
+
+    Babylon::AppRuntime::Options options{};
+    options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+        std::quick_exit(1);
+    };
+
+    std::optional<Babylon::AppRuntime> runtime{std::in_place, options};
+    runtime->Dispatch([&surface, &resultPromise](Napi::Env env) {
+        Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+            std::cout << message << std::endl;
+        });
+        Babylon::Plugins::NativeMeshopt::Initialize(env);
+
+        auto indices = Napi::Uint16Array::New(env, surface.Indices.size());
+        for (size_t i = 0; i < surface.Indices.size(); ++i)
+        {
+            indices.Data()[i] = static_cast<uint16_t>(surface.Indices[i]);
+        }
+        auto positions = Napi::Float32Array::New(env, surface.Positions.size());
+        std::copy(surface.Positions.begin(), surface.Positions.end(), positions.Data());
+        env.Global().Set("indices", indices);
+        env.Global().Set("positions", positions);
+
+        env.Global().Set("reportResult", Napi::Function::New(env, [&resultPromise](const Napi::CallbackInfo& info) {
+            const auto object = info[0].As<Napi::Object>();
+            std::map<std::string, double> result{};
+            for (const char* key : {"simplified", "lods", "cacheOptimized", "vertexCount", "rangeError"})
+            {
+                result[key] = object.Get(key).As<Napi::Number>().DoubleValue();
+            }
+            resultPromise.set_value(std::move(result));
+        }, "reportResult"));
+    });
+
+    Babylon::ScriptLoader loader{*runtime};
+    loader.Eval(R"(
+        const processing = _native.MeshoptProcessing;
+        const vertexCount = positions.length / 3;
+        let rangeError = 0;
+        try {
+            processing.OptimizeVertexCacheAsync(indices, vertexCount - 1);
+        } catch (error) {
+            rangeError = error instanceof RangeError ? 1 : 0;
+        }
+
+        Promise.all([
+            processing.SimplifyAsync(indices, positions, 3, indices.length / 4, 1),
+            processing.BuildLodsAsync(indices, positions, 3, [0.5, 0.25], 1),
+            processing.OptimizeVertexCacheAsync(indices, vertexCount),
+        ]).then(([simplified, lods, cacheOptimized]) =>
+            processing.OptimizeVertexFetchAsync(cacheOptimized, positions, 12).then((fetchOptimized) => reportResult({
+                simplified: simplified.indices.length,
+                lods: lods.length,
+                cacheOptimized: cacheOptimized.length,
+                vertexCount: fetchOptimized.vertexCount,
+                rangeError,
+            })));
+    )", "ProcessingAsync");
+
+    auto resultFuture{resultPromise.get_future()};
+    ASSERT_EQ(resultFuture.wait_for(60s), std::future_status::ready);
+    const auto result{resultFuture.get()};
+    runtime.reset();
+
+    EXPECT_GT(result.at("simplified"), 0);
+    EXPECT_LE(result.at("simplified"), static_cast<double>(surface.Indices.size() / 4));
+    EXPECT_EQ(result.at("lods"), 2);
+    EXPECT_EQ(result.at("cacheOptimized"), static_cast<double>(surface.Indices.size()));
+    EXPECT_EQ(result.at("vertexCount"), static_cast<double>(surface.VertexCount));
+    EXPECT_EQ(result.at("rangeError"), 1);
+}
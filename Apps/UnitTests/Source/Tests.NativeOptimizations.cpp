@@ -0,0 +1,806 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Plugins/NativeOptimizations.h>
+#include <Babylon/Plugins/NativeOptimizationsInternal.h>
+#include <Babylon/ScriptLoader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace Kernels = Babylon::Plugins::NativeOptimizations::Kernels;
+
+namespace
+{
+    constexpr size_t BENCHMARK_VERTICES = 1'000'000;
+
+    std::vector<float> RandomFloats(size_t count, uint32_t seed, float range = 100.0f)
+    {
+        std::mt19937 random{seed};
+        std::uniform_real_distribution<float> distribution{-range, range};
+        std::vector<float> values(count);
+        std::generate(values.begin(), values.end(), [&]() { return distribution(random); });
+        return values;
+    }
+
+    // A projective matrix, so the coordinates path divides by a w that is not 1.
+    std::vector<float> RandomMatrix(uint32_t seed)
+    {
+        auto matrix{RandomFloats(16, seed, 1.0f)};
+        matrix[15] += 4.0f;
+        return matrix;
+    }
+
+    bool SameBits(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+    }
+
+    bool SameBits(const Kernels::Bounds& a, const Kernels::Bounds& b)
+    {
+        return std::memcmp(&a, &b, sizeof(a)) == 0;
+    }
+
+    Kernels::Bounds EmptyBounds()
+    {
+        constexpr float max{std::numeric_limits<float>::max()};
+        return {{max, max, max}, {-max, -max, -max}};
+    }
+
+    using TransformKernel = void (*)(float*, size_t, size_t, const float*);
+
+    // Runs both kernels over ranges that start off a block boundary and leave a tail of each size.
+    void ExpectSameTransform(TransformKernel kernel, TransformKernel scalar, size_t stride)
+    {
+        const auto matrix{RandomMatrix(1)};
+        for (size_t offset : {size_t{0}, size_t{1}, stride})
+        {
+            for (size_t vertices : {size_t{1}, size_t{4}, size_t{5}, size_t{7}, size_t{1001}})
+            {
+                auto data{RandomFloats(offset + vertices * stride + 4, 2)};
+                // A non-finite input has to come out the same as well.
+                data[offset] = std::numeric_limits<float>::quiet_NaN();
+                auto expected{data};
+
+                kernel(data.data(), offset, vertices * stride, matrix.data());
+                scalar(expected.data(), offset, vertices * stride, matrix.data());
+                EXPECT_TRUE(SameBits(data, expected)) << Kernels::SimdName() << ", offset " << offset << ", " << vertices << " vertices";
+            }
+        }
+    }
+
+    double MeasureMilliseconds(const std::function<void()>& function, int runs = 10)
+    {
+        const auto start{std::chrono::steady_clock::now()};
+        for (int run = 0; run < runs; ++run)
+        {
+            function();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+    }
+
+    // The sort sortSplats did before the radix sort, as the benchmark's baseline.
+    void QSortSplats(const float* positions, size_t count, const float direction[3], float depthFactor, float* indices)
+    {
+        std::vector<float> depthMix(count * 2);
+        for (size_t i = 0; i < count; i++)
+        {
+            depthMix[i * 2 + 0] = float(i);
+            depthMix[i * 2 + 1] = 10000.f + (direction[0] * positions[4 * i + 0] + direction[1] * positions[4 * i + 1] + direction[2] * positions[4 * i + 2]) * depthFactor;
+        }
+
+        qsort(depthMix.data(), count, 2 * sizeof(float), [](const void* p1, const void* p2) {
+            const float a{static_cast<const float*>(p1)[1]};
+            const float b{static_cast<const float*>(p2)[1]};
+            return a < b ? -1 : (a > b ? 1 : 0);
+        });
+
+        for (size_t i = 0; i < count; i++)
+        {
+            indices[i] = depthMix[i * 2 + 0];
+        }
+    }
+
+    // A skinned, morphed mesh for SkinAndMorph, with interleaved positions and normals and all 8
+    // influences, some of them unused.
+    struct Character
+    {
+        size_t VertexCount{};
+        std::vector<float> Vertices{};
+        std::vector<std::vector<float>> TargetPositions{};
+        std::vector<std::vector<float>> TargetNormals{};
+        std::vector<float> Influences{};
+        std::vector<float> SkeletonMatrices{};
+        std::vector<float> Indices{}, Weights{}, IndicesExtra{}, WeightsExtra{};
+
+        Kernels::SkinMorphVertices Input(bool interleaved, std::vector<float>& positions, std::vector<float>& normals, float* outPositions, float* outNormals)
+        {
+            Kernels::SkinMorphVertices vertices{};
+            vertices.VertexCount = VertexCount;
+            if (interleaved)
+            {
+                vertices.Positions = Vertices.data();
+                vertices.PositionStride = 6;
+                vertices.Normals = Vertices.data() + 3;
+                vertices.NormalStride = 6;
+            }
+            else
+            {
+                positions.resize(VertexCount * 3);
+                normals.resize(VertexCount * 3);
+                for (size_t vertex = 0; vertex < VertexCount; ++vertex)
+                {
+                    std::copy_n(Vertices.data() + vertex * 6, 3, positions.data() + vertex * 3);
+                    std::copy_n(Vertices.data() + vertex * 6 + 3, 3, normals.data() + vertex * 3);
+                }
+                vertices.Positions = positions.data();
+                vertices.Normals = normals.data();
+            }
+            for (size_t target = 0; target < TargetPositions.size(); ++target)
+            {
+                vertices.MorphTargets.push_back({TargetPositions[target].data(), TargetNormals[target].empty() ? nullptr : TargetNormals[target].data(), Influences[target]});
+            }
+            vertices.SkeletonMatrices = SkeletonMatrices.data();
+            vertices.MatricesIndices = Indices.data();
+            vertices.MatricesWeights = Weights.data();
+            vertices.MatricesIndicesExtra = IndicesExtra.data();
+            vertices.MatricesWeightsExtra = WeightsExtra.data();
+            vertices.OutPositions = outPositions;
+            vertices.OutNormals = outNormals;
+            return vertices;
+        }
+    };
+
+    Character MakeCharacter(size_t vertexCount, size_t targetCount, size_t boneCount, uint32_t seed)
+    {
+        Character character{};
+        character.VertexCount = vertexCount;
+        character.Vertices = RandomFloats(vertexCount * 6, seed, 1.0f);
+
+        std::mt19937 random{seed};
+        for (size_t target = 0; target < targetCount; ++target)
+        {
+            auto positions{RandomFloats(vertexCount * 3, seed + static_cast<uint32_t>(target) + 1, 1.0f)};
+            character.TargetPositions.push_back(std::move(positions));
+            // Not every target has normals, and some are not in use.
+            character.TargetNormals.push_back(target % 3 ? RandomFloats(vertexCount * 3, seed + static_cast<uint32_t>(target) + 1000, 1.0f) : std::vector<float>{});
+            character.Influences.push_back(target % 4 ? static_cast<float>(random() % 1000) / 1000.0f : 0.0f);
+        }
+
+        character.SkeletonMatrices = RandomFloats(boneCount * 16, seed + 2000, 1.0f);
+        for (size_t bone = 0; bone < boneCount; ++bone)
+        {
+            character.SkeletonMatrices[bone * 16 + 15] = 1.0f;
+        }
+
+        for (auto* indices : {&character.Indices, &character.IndicesExtra})
+        {
+            indices->resize(vertexCount * 4);
+            std::generate(indices->begin(), indices->end(), [&]() { return static_cast<float>(random() % boneCount); });
+        }
+        character.Weights.resize(vertexCount * 4);
+        std::generate(character.Weights.begin(), character.Weights.end(), [&]() { return random() % 4 ? 0.2f : 0.0f; });
+        character.WeightsExtra.resize(vertexCount * 4);
+        std::generate(character.WeightsExtra.begin(), character.WeightsExtra.end(), [&]() { return random() % 2 ? 0.05f : 0.0f; });
+        return character;
+    }
+
+    // SkinAndMorph as separate passes: each morph target blended over the whole mesh, then
+    // ApplySkeleton on the positions and again on the normals.
+    void SeparateSkinAndMorph(const Kernels::SkinMorphVertices& vertices, decltype(&Kernels::ApplySkeleton) applySkeleton)
+    {
+        const size_t length{vertices.VertexCount * 3};
+        std::vector<float> basePositions(length), baseNormals(length);
+        for (size_t vertex = 0; vertex < vertices.VertexCount; ++vertex)
+        {
+            std::copy_n(vertices.Positions + vertex * vertices.PositionStride, 3, basePositions.data() + vertex * 3);
+            std::copy_n(vertices.Normals + vertex * vertices.NormalStride, 3, baseNormals.data() + vertex * 3);
+        }
+        std::copy(basePositions.begin(), basePositions.end(), vertices.OutPositions);
+        std::copy(baseNormals.begin(), baseNormals.end(), vertices.OutNormals);
+
+        for (const auto& target : vertices.MorphTargets)
+        {
+            if (target.Influence == 0.0f)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < length; ++i)
+            {
+                vertices.OutPositions[i] += (target.Positions[i] - basePositions[i]) * target.Influence;
+            }
+            if (target.Normals != nullptr)
+            {
+                for (size_t i = 0; i < length; ++i)
+                {
+                    vertices.OutNormals[i] += (target.Normals[i] - baseNormals[i]) * target.Influence;
+                }
+            }
+        }
+
+        applySkeleton(vertices.OutPositions, length, false, vertices.SkeletonMatrices, vertices.MatricesIndices, vertices.MatricesWeights,
+            vertices.MatricesIndicesExtra, vertices.MatricesWeightsExtra);
+        applySkeleton(vertices.OutNormals, length, true, vertices.SkeletonMatrices, vertices.MatricesIndices, vertices.MatricesWeights,
+            vertices.MatricesIndicesExtra, vertices.MatricesWeightsExtra);
+    }
+
+    // SkinAndMorph split in one range per hardware thread, as skinAndMorphAsync does.
+    void ParallelSkinAndMorph(const Kernels::SkinMorphVertices& vertices)
+    {
+        const size_t threadCount{std::max(std::thread::hardware_concurrency(), 1u)};
+        const size_t verticesPerThread{(vertices.VertexCount + threadCount - 1) / threadCount};
+        std::vector<std::thread> threads{};
+        for (size_t start = 0; start < vertices.VertexCount; start += verticesPerThread)
+        {
+            threads.emplace_back([&vertices, start, count{std::min(verticesPerThread, vertices.VertexCount - start)}]() {
+                Kernels::SkinAndMorph(vertices, start, count);
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // A scene of objects for CullBoundingBoxes: local boxes, and world matrices rotating, scaling
+    // and placing them around a frustum looking down +z.
+    struct CullingScene
+    {
+        std::vector<float> LocalBoxes{};
+        std::vector<float> WorldMatrices{};
+        float Planes[24]{};
+    };
+
+    CullingScene MakeCullingScene(size_t objects, uint32_t seed)
+    {
+        CullingScene scene{};
+        std::mt19937 random{seed};
+        std::uniform_real_distribution<float> unit{-1.0f, 1.0f};
+
+        for (size_t object = 0; object < objects; ++object)
+        {
+            const float cx{unit(random)}, cy{unit(random)}, cz{unit(random)};
+            const float ex{0.1f + std::abs(unit(random))}, ey{0.1f + std::abs(unit(random))}, ez{0.1f + std::abs(unit(random))};
+            scene.LocalBoxes.insert(scene.LocalBoxes.end(), {cx - ex, cy - ey, cz - ez, cx + ex, cy + ey, cz + ez});
+
+            // A rotation about an arbitrary axis, a non-uniform scale and a translation.
+            float ax{unit(random)}, ay{unit(random)}, az{unit(random)};
+            const float length{std::sqrt(ax * ax + ay * ay + az * az) + 1e-6f};
+            ax /= length, ay /= length, az /= length;
+            const float angle{unit(random) * 3.14159265f};
+            const float c{std::cos(angle)}, s{std::sin(angle)}, t{1.0f - c};
+            const float sx{0.5f + std::abs(unit(random)) * 2.0f}, sy{0.5f + std::abs(unit(random)) * 2.0f}, sz{0.5f + std::abs(unit(random)) * 2.0f};
+            scene.WorldMatrices.insert(scene.WorldMatrices.end(), {
+                (t * ax * ax + c) * sx, (t * ax * ay + s * az) * sx, (t * ax * az - s * ay) * sx, 0.0f,
+                (t * ax * ay - s * az) * sy, (t * ay * ay + c) * sy, (t * ay * az + s * ax) * sy, 0.0f,
+                (t * ax * az + s * ay) * sz, (t * ay * az - s * ax) * sz, (t * az * az + c) * sz, 0.0f,
+                unit(random) * 150.0f, unit(random) * 150.0f, unit(random) * 60.0f + 50.0f, 1.0f});
+        }
+
+        // Near at 1, far at 100 and a 90 degree field of view, the normals pointing inwards.
+        const float n{1.0f / std::sqrt(2.0f)};
+        const float planes[24]{0, 0, 1, -1, 0, 0, -1, 100, n, 0, n, 0, -n, 0, n, 0, 0, n, n, 0, 0, -n, n, 0};
+        std::copy_n(planes, 24, scene.Planes);
+        return scene;
+    }
+
+    // BoundingInfo.update and isInFrustum as Babylon.js computes them: the 8 corners transformed
+    // and tested against every plane. Returns whether the object is visible, and how far its
+    // nearest deciding test was from flipping.
+    bool ReferenceCull(const float* box, const float* m, const float* planes, float worldBox[6], float worldSphere[4], float& margin)
+    {
+        float corners[8][3];
+        for (size_t corner = 0; corner < 8; ++corner)
+        {
+            float x{box[(corner & 1) ? 3 : 0]}, y{box[(corner & 2) ? 4 : 1]}, z{box[(corner & 4) ? 5 : 2]};
+            const float w{1.0f / (x * m[3] + y * m[7] + z * m[11] + m[15])};
+            corners[corner][0] = (x * m[0] + y * m[4] + z * m[8] + m[12]) * w;
+            corners[corner][1] = (x * m[1] + y * m[5] + z * m[9] + m[13]) * w;
+            corners[corner][2] = (x * m[2] + y * m[6] + z * m[10] + m[14]) * w;
+        }
+
+        for (size_t component = 0; component < 3; ++component)
+        {
+            worldBox[component] = worldBox[component + 3] = corners[0][component];
+            for (const auto& corner : corners)
+            {
+                worldBox[component] = std::min(worldBox[component], corner[component]);
+                worldBox[component + 3] = std::max(worldBox[component + 3], corner[component]);
+            }
+        }
+
+        const float center[3]{(box[0] + box[3]) * 0.5f, (box[1] + box[4]) * 0.5f, (box[2] + box[5]) * 0.5f};
+        for (size_t component = 0; component < 3; ++component)
+        {
+            worldSphere[component] = center[0] * m[component] + center[1] * m[4 + component] + center[2] * m[8 + component] + m[12 + component];
+        }
+        const float radius{std::sqrt((box[3] - box[0]) * (box[3] - box[0]) + (box[4] - box[1]) * (box[4] - box[1]) + (box[5] - box[2]) * (box[5] - box[2])) * 0.5f};
+        worldSphere[3] = std::max({std::abs(m[0] + m[4] + m[8]), std::abs(m[1] + m[5] + m[9]), std::abs(m[2] + m[6] + m[10])}) * radius;
+
+        margin = std::numeric_limits<float>::max();
+        bool visible{true};
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            const float* p{planes + plane * 4};
+            const float distance{p[0] * worldSphere[0] + p[1] * worldSphere[1] + p[2] * worldSphere[2] + p[3]};
+            margin = std::min(margin, std::abs(distance + worldSphere[3]));
+            visible = visible && distance > -worldSphere[3];
+
+            float furthest{-std::numeric_limits<float>::max()};
+            for (const auto& corner : corners)
+            {
+                furthest = std::max(furthest, p[0] * corner[0] + p[1] * corner[1] + p[2] * corner[2] + p[3]);
+            }
+            margin = std::min(margin, std::abs(furthest));
+            visible = visible && furthest >= 0.0f;
+        }
+        return visible;
+    }
+
+    bool Visible(const std::vector<uint32_t>& visibility, size_t object)
+    {
+        return (visibility[object / 32] >> (object % 32)) & 1;
+    }
+
+    void PrintThroughput(const char* kernel, size_t vertices, double simdMilliseconds, double scalarMilliseconds)
+    {
+        std::cout << kernel << " on " << vertices << " vertices: " << Kernels::SimdName() << " " << simdMilliseconds << " ms ("
+                  << vertices / std::max(simdMilliseconds, 1e-3) / 1000 << " Mvertices/s), scalar " << scalarMilliseconds << " ms ("
+                  << vertices / std::max(scalarMilliseconds, 1e-3) / 1000 << " Mvertices/s)" << std::endl;
+    }
+}
+
+TEST(NativeOptimizations, TransformBitExact)
+{
+    ExpectSameTransform(Kernels::TransformVector3Coordinates, Kernels::Scalar::TransformVector3Coordinates, 3);
+    ExpectSameTransform(Kernels::TransformVector3Normals, Kernels::Scalar::TransformVector3Normals, 3);
+    ExpectSameTransform(Kernels::TransformVector4Normals, Kernels::Scalar::TransformVector4Normals, 4);
+}
+
+TEST(NativeOptimizations, ExtractMinAndMaxBitExact)
+{
+    for (size_t stride : {size_t{3}, size_t{4}, size_t{8}})
+    {
+        for (size_t count : {size_t{1}, size_t{3}, size_t{4}, size_t{1003}})
+        {
+            auto positions{RandomFloats((count + 2) * stride, 3)};
+            positions[stride] = std::numeric_limits<float>::quiet_NaN();
+
+            auto bounds{EmptyBounds()};
+            auto expected{EmptyBounds()};
+            Kernels::ExtractMinAndMax(positions.data(), 1, count, stride, bounds);
+            Kernels::Scalar::ExtractMinAndMax(positions.data(), 1, count, stride, expected);
+            EXPECT_TRUE(SameBits(bounds, expected)) << Kernels::SimdName() << ", stride " << stride << ", " << count << " vertices";
+        }
+    }
+}
+
+TEST(NativeOptimizations, ExtractMinAndMaxIndexedBitExact)
+{
+    constexpr size_t VERTICES = 1000;
+    const auto positions{RandomFloats(VERTICES * 3, 4)};
+
+    std::mt19937 random{5};
+    std::vector<uint32_t> indices32(VERTICES * 3 + 3);
+    std::generate(indices32.begin(), indices32.end(), [&]() { return static_cast<uint32_t>(random() % VERTICES); });
+    const std::vector<int32_t> indicesSigned(indices32.begin(), indices32.end());
+    const std::vector<uint16_t> indices16(indices32.begin(), indices32.end());
+
+    for (size_t count : {size_t{1}, size_t{6}, size_t{VERTICES * 3}})
+    {
+        auto bounds{EmptyBounds()};
+        auto expected{EmptyBounds()};
+        Kernels::ExtractMinAndMaxIndexed(positions.data(), indices32.data(), 3, count, bounds);
+        Kernels::Scalar::ExtractMinAndMaxIndexed(positions.data(), indices32.data(), 3, count, expected);
+        EXPECT_TRUE(SameBits(bounds, expected)) << "uint32, " << count << " indices";
+
+        bounds = expected = EmptyBounds();
+        Kernels::ExtractMinAndMaxIndexed(positions.data(), indicesSigned.data(), 3, count, bounds);
+        Kernels::Scalar::ExtractMinAndMaxIndexed(positions.data(), indicesSigned.data(), 3, count, expected);
+        EXPECT_TRUE(SameBits(bounds, expected)) << "int32, " << count << " indices";
+
+        bounds = expected = EmptyBounds();
+        Kernels::ExtractMinAndMaxIndexed(positions.data(), indices16.data(), 3, count, bounds);
+        Kernels::Scalar::ExtractMinAndMaxIndexed(positions.data(), indices16.data(), 3, count, expected);
+        EXPECT_TRUE(SameBits(bounds, expected)) << "uint16, " << count << " indices";
+    }
+}
+
+TEST(NativeOptimizations, ApplySkeletonBitExact)
+{
+    constexpr size_t BONES = 32;
+    constexpr size_t VERTICES = 1001;
+
+    auto skeletonMatrices{RandomFloats(BONES * 16, 6, 1.0f)};
+    for (size_t bone = 0; bone < BONES; ++bone)
+    {
+        skeletonMatrices[bone * 16 + 15] = 1.0f;
+    }
+
+    std::mt19937 random{7};
+    std::vector<float> indices(VERTICES * 4), weights(VERTICES * 4), indicesExtra(VERTICES * 4), weightsExtra(VERTICES * 4);
+    for (size_t i = 0; i < VERTICES * 4; ++i)
+    {
+        indices[i] = static_cast<float>(random() % BONES);
+        indicesExtra[i] = static_cast<float>(random() % BONES);
+        // Some influences are unused, which both paths skip.
+        weights[i] = random() % 3 ? 0.25f + static_cast<float>(random() % 1000) / 2000.0f : 0.0f;
+        weightsExtra[i] = random() % 2 ? 0.05f : 0.0f;
+    }
+
+    for (bool normals : {false, true})
+    {
+        for (bool extra : {false, true})
+        {
+            auto data{RandomFloats(VERTICES * 3, 8)};
+            auto expected{data};
+            Kernels::ApplySkeleton(data.data(), data.size(), normals, skeletonMatrices.data(), indices.data(), weights.data(),
+                extra ? indicesExtra.data() : nullptr, extra ? weightsExtra.data() : nullptr);
+            Kernels::Scalar::ApplySkeleton(expected.data(), expected.size(), normals, skeletonMatrices.data(), indices.data(), weights.data(),
+                extra ? indicesExtra.data() : nullptr, extra ? weightsExtra.data() : nullptr);
+            EXPECT_TRUE(SameBits(data, expected)) << Kernels::SimdName() << (normals ? ", normals" : ", positions") << (extra ? ", 8 influences" : ", 4 influences");
+        }
+    }
+}
+
+TEST(NativeOptimizations, SkinAndMorphBitExact)
+{
+    // More than two blocks of the kernel.
+    constexpr size_t VERTICES = 2501;
+    auto character{MakeCharacter(VERTICES, 6, 32, 20)};
+
+    for (bool interleaved : {false, true})
+    {
+        std::vector<float> positions, normals;
+        std::vector<float> outPositions(VERTICES * 3), outNormals(VERTICES * 3);
+        std::vector<float> expectedPositions(VERTICES * 3), expectedNormals(VERTICES * 3);
+        std::vector<float> separatePositions(VERTICES * 3), separateNormals(VERTICES * 3);
+
+        auto vertices{character.Input(interleaved, positions, normals, outPositions.data(), outNormals.data())};
+        auto expected{vertices};
+        expected.OutPositions = expectedPositions.data();
+        expected.OutNormals = expectedNormals.data();
+        auto separate{vertices};
+        separate.OutPositions = separatePositions.data();
+        separate.OutNormals = separateNormals.data();
+
+        // Ranges that end off a block and off a SIMD width give the same as a single call.
+        for (size_t start = 0; start < VERTICES; start += 1277)
+        {
+            Kernels::SkinAndMorph(vertices, start, std::min<size_t>(1277, VERTICES - start));
+        }
+        Kernels::Scalar::SkinAndMorph(expected, 0, VERTICES);
+        SeparateSkinAndMorph(separate, Kernels::Scalar::ApplySkeleton);
+
+        const auto description{std::string{Kernels::SimdName()} + (interleaved ? ", interleaved" : ", separate arrays")};
+        EXPECT_TRUE(SameBits(outPositions, expectedPositions)) << description;
+        EXPECT_TRUE(SameBits(outNormals, expectedNormals)) << description;
+        EXPECT_TRUE(SameBits(separatePositions, expectedPositions)) << description;
+        EXPECT_TRUE(SameBits(separateNormals, expectedNormals)) << description;
+    }
+
+    // Without a skeleton, only the morph targets apply, and without normals only positions are
+    // written. With a stride of 3 the output can be the input.
+    std::vector<float> positions, normals;
+    auto vertices{character.Input(false, positions, normals, nullptr, nullptr)};
+    vertices.SkeletonMatrices = nullptr;
+    vertices.Normals = nullptr;
+    std::vector<float> expected(VERTICES * 3);
+    auto reference{vertices};
+    reference.OutPositions = expected.data();
+    Kernels::Scalar::SkinAndMorph(reference, 0, VERTICES);
+    vertices.OutPositions = positions.data();
+    Kernels::SkinAndMorph(vertices, 0, VERTICES);
+    EXPECT_TRUE(SameBits(positions, expected));
+    EXPECT_FALSE(SameBits(expected, std::vector<float>(character.Vertices.begin(), character.Vertices.begin() + VERTICES * 3)));
+}
+
+TEST(NativeOptimizations, CullBoundingBoxes)
+{
+    constexpr size_t OBJECTS = 10'003;
+    const auto scene{MakeCullingScene(OBJECTS, 30)};
+
+    // Unrelated bits are left alone, so start from a mask of ones past the end.
+    std::vector<uint32_t> visibility((OBJECTS + 31) / 32, ~0u), expectedVisibility(visibility);
+    std::vector<float> worldBoxes(OBJECTS * 6), worldSpheres(OBJECTS * 4), expectedBoxes(OBJECTS * 6), expectedSpheres(OBJECTS * 4);
+
+    // Ranges off a SIMD width give the same bits as a single scalar call.
+    for (size_t start = 0; start < OBJECTS; start += 1001)
+    {
+        Kernels::CullBoundingBoxes(scene.LocalBoxes.data(), scene.WorldMatrices.data(), scene.Planes, start, std::min<size_t>(1001, OBJECTS - start),
+            visibility.data(), worldBoxes.data(), worldSpheres.data());
+    }
+    Kernels::Scalar::CullBoundingBoxes(scene.LocalBoxes.data(), scene.WorldMatrices.data(), scene.Planes, 0, OBJECTS,
+        expectedVisibility.data(), expectedBoxes.data(), expectedSpheres.data());
+    EXPECT_EQ(visibility, expectedVisibility) << Kernels::SimdName();
+    EXPECT_TRUE(SameBits(worldBoxes, expectedBoxes)) << Kernels::SimdName();
+    EXPECT_TRUE(SameBits(worldSpheres, expectedSpheres)) << Kernels::SimdName();
+    EXPECT_EQ(visibility.back() >> (OBJECTS % 32), ~0u >> (OBJECTS % 32));
+
+    // Against Babylon.js, up to rounding: objects within a hair of a plane may go either way.
+    size_t visible{}, mismatches{}, undecided{};
+    for (size_t object = 0; object < OBJECTS; ++object)
+    {
+        float box[6], sphere[4], margin;
+        const bool expected{ReferenceCull(&scene.LocalBoxes[object * 6], &scene.WorldMatrices[object * 16], scene.Planes, box, sphere, margin)};
+        visible += expected;
+        if (Visible(visibility, object) != expected)
+        {
+            (margin < 1e-3f ? undecided : mismatches) += 1;
+        }
+        for (size_t component = 0; component < 6; ++component)
+        {
+            EXPECT_NEAR(worldBoxes[object * 6 + component], box[component], 1e-3f) << object;
+        }
+        for (size_t component = 0; component < 4; ++component)
+        {
+            EXPECT_NEAR(worldSpheres[object * 4 + component], sphere[component], 1e-3f) << object;
+        }
+    }
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_LE(undecided, 2u);
+    // The scene has objects on both sides.
+    EXPECT_GT(visible, OBJECTS / 10);
+    EXPECT_LT(visible, OBJECTS * 9 / 10);
+
+    // Without outputs for the bounds only the mask is written.
+    std::vector<uint32_t> maskOnly(visibility.size());
+    Kernels::CullBoundingBoxes(scene.LocalBoxes.data(), scene.WorldMatrices.data(), scene.Planes, 0, OBJECTS, maskOnly.data(), nullptr, nullptr);
+    for (size_t object = 0; object < OBJECTS; ++object)
+    {
+        ASSERT_EQ(Visible(maskOnly, object), Visible(visibility, object)) << object;
+    }
+}
+
+TEST(NativeOptimizations, SortSplats)
+{
+    constexpr size_t SPLATS = 100'003;
+    const float direction[3]{0.3f, -0.5f, 0.8f};
+
+    for (float range : {1.0f, 100.0f, 100'000.0f})
+    {
+        // The large range puts depths below zero, and the copies give ties.
+        auto positions{RandomFloats(SPLATS * 4, 12, range)};
+        std::copy_n(positions.begin(), 4000, positions.begin() + 8000);
+
+        for (float depthFactor : {-1.0f, 1.0f})
+        {
+            // Keys computed in chunks, as sortSplatsAsync does, match the ones of a single call.
+            std::vector<uint32_t> keys(SPLATS);
+            Kernels::ComputeSplatDepthKeys(positions.data(), 0, SPLATS, direction, depthFactor, keys.data());
+            std::vector<uint32_t> chunkedKeys(SPLATS);
+            for (size_t start = 0; start < SPLATS; start += 7000)
+            {
+                Kernels::ComputeSplatDepthKeys(positions.data(), start, std::min<size_t>(7000, SPLATS - start), direction, depthFactor, chunkedKeys.data());
+            }
+            EXPECT_EQ(keys, chunkedKeys);
+
+            std::vector<float> depths(SPLATS);
+            for (size_t i = 0; i < SPLATS; ++i)
+            {
+                depths[i] = 10000.f + (direction[0] * positions[4 * i + 0] + direction[1] * positions[4 * i + 1] + direction[2] * positions[4 * i + 2]) * depthFactor;
+            }
+
+            // Reused buffers, sized by a larger sort before, give the same result.
+            Kernels::SplatSortBuffers buffers{};
+            std::vector<float> indices(SPLATS);
+            for (size_t run = 0; run < 2; ++run)
+            {
+                Kernels::SortSplats(positions.data(), SPLATS, direction, depthFactor, buffers, indices.data());
+
+                std::vector<uint32_t> expected(SPLATS);
+                std::iota(expected.begin(), expected.end(), 0u);
+                std::stable_sort(expected.begin(), expected.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+                size_t mismatches{};
+                bool increasingDepth{true};
+                for (size_t i = 0; i < SPLATS; ++i)
+                {
+                    mismatches += static_cast<uint32_t>(indices[i]) != expected[i];
+                    increasingDepth = increasingDepth && (i == 0 || depths[static_cast<size_t>(indices[i - 1])] <= depths[static_cast<size_t>(indices[i])]);
+                }
+                EXPECT_EQ(mismatches, 0u) << "range " << range << ", depth factor " << depthFactor;
+                EXPECT_TRUE(increasingDepth) << "range " << range << ", depth factor " << depthFactor;
+            }
+        }
+    }
+
+    // Splats at the same depth keep their order.
+    const std::vector<float> flat(40, 1.0f);
+    Kernels::SplatSortBuffers buffers{};
+    std::vector<float> indices(10);
+    Kernels::SortSplats(flat.data(), indices.size(), direction, 1.0f, buffers, indices.data());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        EXPECT_EQ(indices[i], static_cast<float>(i));
+    }
+    Kernels::SortSplats(flat.data(), 0, direction, 1.0f, buffers, indices.data());
+}
+
+// Sorts and skinning are still queued or running on the thread pool when the runtime goes away.
+// Tearing it down cancels them and waits for the running ones, before the arrays they read and
+// write are freed.
+TEST(NativeOptimizations, AsyncTeardown)
+{
+    constexpr uint32_t CALLS = 8;
+
+    Babylon::AppRuntime::Options options{};
+    options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+        std::quick_exit(1);
+    };
+
+    for (int round = 0; round < 5; ++round)
+    {
+        SCOPED_TRACE(round);
+
+        std::promise<uint32_t> issuedPromise{};
+        std::optional<Babylon::AppRuntime> runtime{std::in_place, options};
+        runtime->Dispatch([&issuedPromise](Napi::Env env) {
+            Babylon::Plugins::NativeOptimizations::Initialize(env);
+
+            env.Global().Set("reportIssued", Napi::Function::New(env, [&issuedPromise](const Napi::CallbackInfo& info) {
+                issuedPromise.set_value(info[0].As<Napi::Number>().Uint32Value());
+            }, "reportIssued"));
+        });
+
+        Babylon::ScriptLoader loader{*runtime};
+        loader.Eval(R"(
+            const calls = )" + std::to_string(CALLS) + R"(;
+            const splats = 1 << 20;
+            const positions = new Float32Array(splats * 4).map((_, i) => (i * 7919) % 1000);
+            const modelView = { _m: new Float32Array([1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1]) };
+            const vertexCount = 1 << 18;
+            const morphTargets = [0.25, 0.5].map((influence) => ({ positions: new Float32Array(vertexCount * 3).fill(influence), influence }));
+            const vertices = new Float32Array(vertexCount * 3).map((_, i) => i % 97);
+            for (let call = 0; call < calls; ++call) {
+                _native.sortSplatsAsync(modelView, positions, new Float32Array(splats), true);
+                _native.skinAndMorphAsync({ vertexCount, positions: vertices, morphTargets, outPositions: new Float32Array(vertexCount * 3) });
+            }
+            reportIssued(calls);
+        )", "AsyncTeardown");
+
+        auto issuedFuture{issuedPromise.get_future()};
+        ASSERT_EQ(issuedFuture.wait_for(60s), std::future_status::ready);
+        EXPECT_EQ(issuedFuture.get(), CALLS);
+
+        const auto start{std::chrono::steady_clock::now()};
+        runtime.reset();
+        EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+    }
+}
+
+// The radix splat sort against the qsort it replaced.
+TEST(NativeOptimizations, SortSplatsBenchmark)
+{
+    const float direction[3]{0.3f, -0.5f, 0.8f};
+    for (size_t splats : {size_t{1'000'000}, size_t{4'000'000}})
+    {
+        const auto positions{RandomFloats(splats * 4, 13, 50.0f)};
+        std::vector<float> indices(splats);
+        Kernels::SplatSortBuffers buffers{};
+
+        const auto radixMilliseconds{MeasureMilliseconds([&]() { Kernels::SortSplats(positions.data(), splats, direction, -1.0f, buffers, indices.data()); })};
+        const auto qsortMilliseconds{MeasureMilliseconds([&]() { QSortSplats(positions.data(), splats, direction, -1.0f, indices.data()); }, 2)};
+        std::cout << "sortSplats on " << splats << " splats: radix " << radixMilliseconds << " ms, qsort " << qsortMilliseconds << " ms" << std::endl;
+    }
+}
+
+// A 200k vertex character with 50 morph targets and 8 influences per vertex, skinned and morphed
+// in one pass, on one thread and on all of them, against separate passes.
+TEST(NativeOptimizations, SkinAndMorphBenchmark)
+{
+    constexpr size_t VERTICES = 200'000;
+    auto character{MakeCharacter(VERTICES, 50, 100, 21)};
+    std::fill(character.Influences.begin(), character.Influences.end(), 0.02f);
+
+    std::vector<float> positions, normals;
+    std::vector<float> outPositions(VERTICES * 3), outNormals(VERTICES * 3);
+    const auto vertices{character.Input(true, positions, normals, outPositions.data(), outNormals.data())};
+
+    const auto separateMilliseconds{MeasureMilliseconds([&]() { SeparateSkinAndMorph(vertices, Kernels::ApplySkeleton); }, 3)};
+    const auto scalarMilliseconds{MeasureMilliseconds([&]() { Kernels::Scalar::SkinAndMorph(vertices, 0, VERTICES); }, 3)};
+    const auto simdMilliseconds{MeasureMilliseconds([&]() { Kernels::SkinAndMorph(vertices, 0, VERTICES); }, 3)};
+    const auto parallelMilliseconds{MeasureMilliseconds([&]() { ParallelSkinAndMorph(vertices); }, 3)};
+    std::cout << "SkinAndMorph on " << VERTICES << " vertices, 50 morph targets, 8 influences: separate passes " << separateMilliseconds
+              << " ms, scalar " << scalarMilliseconds << " ms, " << Kernels::SimdName() << " " << simdMilliseconds << " ms, "
+              << Kernels::SimdName() << " on " << std::max(std::thread::hardware_concurrency(), 1u) << " threads " << parallelMilliseconds << " ms" << std::endl;
+}
+
+// Culling of 20k and 100k objects, against the Babylon.js corner by corner reference.
+TEST(NativeOptimizations, CullBoundingBoxesBenchmark)
+{
+    for (size_t objects : {size_t{20'000}, size_t{100'000}})
+    {
+        const auto scene{MakeCullingScene(objects, 31)};
+        std::vector<uint32_t> visibility((objects + 31) / 32);
+        std::vector<float> worldBoxes(objects * 6), worldSpheres(objects * 4);
+
+        const auto simdMilliseconds{MeasureMilliseconds([&]() {
+            Kernels::CullBoundingBoxes(scene.LocalBoxes.data(), scene.WorldMatrices.data(), scene.Planes, 0, objects, visibility.data(), worldBoxes.data(), worldSpheres.data());
+        })};
+        const auto scalarMilliseconds{MeasureMilliseconds([&]() {
+            Kernels::Scalar::CullBoundingBoxes(scene.LocalBoxes.data(), scene.WorldMatrices.data(), scene.Planes, 0, objects, visibility.data(), worldBoxes.data(), worldSpheres.data());
+        })};
+        const auto referenceMilliseconds{MeasureMilliseconds([&]() {
+            for (size_t object = 0; object < objects; ++object)
+            {
+                float margin;
+                const bool visible{ReferenceCull(&scene.LocalBoxes[object * 6], &scene.WorldMatrices[object * 16], scene.Planes, &worldBoxes[object * 6], &worldSpheres[object * 4], margin)};
+                visibility[object / 32] = (visibility[object / 32] & ~(1u << (object % 32))) | (static_cast<uint32_t>(visible) << (object % 32));
+            }
+        })};
+        std::cout << "CullBoundingBoxes on " << objects << " objects: " << Kernels::SimdName() << " " << simdMilliseconds << " ms, scalar "
+                  << scalarMilliseconds << " ms, per corner reference " << referenceMilliseconds << " ms" << std::endl;
+    }
+}
+
+// Throughput of each kernel and of its scalar version on 1M-vertex buffers.
+TEST(NativeOptimizations, Benchmark)
+{
+    const auto matrix{RandomMatrix(9)};
+    const auto source{RandomFloats(BENCHMARK_VERTICES * 4, 10)};
+    std::vector<float> data;
+
+    const auto transform = [&](const char* name, TransformKernel kernel, TransformKernel scalar, size_t stride) {
+        const size_t length{BENCHMARK_VERTICES * stride};
+        const auto simdMilliseconds{MeasureMilliseconds([&]() { data.assign(source.begin(), source.begin() + length); kernel(data.data(), 0, length, matrix.data()); })};
+        const auto scalarMilliseconds{MeasureMilliseconds([&]() { data.assign(source.begin(), source.begin() + length); scalar(data.data(), 0, length, matrix.data()); })};
+        PrintThroughput(name, BENCHMARK_VERTICES, simdMilliseconds, scalarMilliseconds);
+    };
+    transform("TransformVector3Coordinates", Kernels::TransformVector3Coordinates, Kernels::Scalar::TransformVector3Coordinates, 3);
+    transform("TransformVector3Normals", Kernels::TransformVector3Normals, Kernels::Scalar::TransformVector3Normals, 3);
+    transform("TransformVector4Normals", Kernels::TransformVector4Normals, Kernels::Scalar::TransformVector4Normals, 4);
+
+    {
+        auto bounds{EmptyBounds()};
+        const auto simdMilliseconds{MeasureMilliseconds([&]() { Kernels::ExtractMinAndMax(source.data(), 0, BENCHMARK_VERTICES, 3, bounds); })};
+        const auto scalarMilliseconds{MeasureMilliseconds([&]() { Kernels::Scalar::ExtractMinAndMax(source.data(), 0, BENCHMARK_VERTICES, 3, bounds); })};
+        PrintThroughput("ExtractMinAndMax", BENCHMARK_VERTICES, simdMilliseconds, scalarMilliseconds);
+    }
+
+    {
+        std::vector<uint32_t> indices(BENCHMARK_VERTICES);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            indices[i] = static_cast<uint32_t>((i * 7919) % BENCHMARK_VERTICES);
+        }
+        auto bounds{EmptyBounds()};
+        const auto simdMilliseconds{MeasureMilliseconds([&]() { Kernels::ExtractMinAndMaxIndexed(source.data(), indices.data(), 0, indices.size(), bounds); })};
+        const auto scalarMilliseconds{MeasureMilliseconds([&]() { Kernels::Scalar::ExtractMinAndMaxIndexed(source.data(), indices.data(), 0, indices.size(), bounds); })};
+        PrintThroughput("ExtractMinAndMaxIndexed", BENCHMARK_VERTICES, simdMilliseconds, scalarMilliseconds);
+    }
+
+    {
+        constexpr size_t BONES = 64;
+        auto skeletonMatrices{RandomFloats(BONES * 16, 11, 1.0f)};
+        std::vector<float> indices(BENCHMARK_VERTICES * 4), weights(BENCHMARK_VERTICES * 4, 0.25f);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            indices[i] = static_cast<float>(i % BONES);
+        }
+        const auto skin = [&](decltype(&Kernels::ApplySkeleton) kernel) {
+            data.assign(source.begin(), source.begin() + BENCHMARK_VERTICES * 3);
+            kernel(data.data(), data.size(), false, skeletonMatrices.data(), indices.data(), weights.data(), nullptr, nullptr);
+        };
+        const auto simdMilliseconds{MeasureMilliseconds([&]() { skin(Kernels::ApplySkeleton); })};
+        const auto scalarMilliseconds{MeasureMilliseconds([&]() { skin(Kernels::Scalar::ApplySkeleton); })};
+        PrintThroughput("ApplySkeleton", BENCHMARK_VERTICES, simdMilliseconds, scalarMilliseconds);
+    }
+}
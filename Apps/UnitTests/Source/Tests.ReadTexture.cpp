@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Graphics/Device.h>
+#include <Babylon/Graphics/DeviceContext.h>
+#include <Babylon/Polyfills/Console.h>
+#include <Babylon/Polyfills/Window.h>
+#include <Babylon/Plugins/NativeEngine.h>
+#include <Babylon/ScriptLoader.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <sstream>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    constexpr uint32_t READ_COUNT = 1000;
+    constexpr uint32_t READS_PER_FRAME = 10;
+    constexpr uint32_t READ_SIZE = 32;
+}
+
+// Issues READ_COUNT texture.readPixels calls against a headless (Noop) device, READS_PER_FRAME per
+// frame. Every read crops the texture, so each one that is not coalesced goes through a blit into
+// a pooled readback texture. Half the reads in a frame are of one quadrant and half of another,
+// so identical reads within the frame share a readback, and every read lands in a caller-provided
+// buffer.
+TEST(ReadTexture, PooledAndCoalescedReads)
+{
+    Babylon::Graphics::Configuration config{};
+    Babylon::Graphics::Device device{config};
+
+    device.StartRenderingCurrentFrame();
+
+    std::promise<uint32_t> completedReads{};
+    Babylon::Graphics::DeviceContext* context{};
+
+    Babylon::AppRuntime::Options options{};
+    options.UnhandledExceptionHandler = [](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << Napi::GetErrorString(error) << std::endl;
+        std::quick_exit(1);
+    };
+
+    Babylon::AppRuntime runtime{options};
+    runtime.Dispatch([&device, &completedReads, &context](Napi::Env env) {
+        device.AddToJavaScript(env);
+        context = &Babylon::Graphics::DeviceContext::GetFromJavaScript(env);
+
+        Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+            std::cout << message << std::endl;
+        });
+        Babylon::Polyfills::Window::Initialize(env);
+        Babylon::Plugins::NativeEngine::Initialize(env);
+
+        env.Global().Set("reportResult", Napi::Function::New(env, [&completedReads](const Napi::CallbackInfo& info) {
+            completedReads.set_value(info[0].As<Napi::Number>().Uint32Value());
+        }, "reportResult"));
+    });
+
+    Babylon::ScriptLoader loader{runtime};
+    loader.LoadScript("app:///Assets/babylon.max.js");
+
+    std::ostringstream script{};
+    script << "const readCount = " << READ_COUNT << ";\n"
+           << "const readsPerFrame = " << READS_PER_FRAME << ";\n"
+           << "const readSize = " << READ_SIZE << ";\n"
+           << R"(
+        const engine = new BABYLON.NativeEngine();
+        const scene = new BABYLON.Scene(engine);
+        const textureSize = readSize * 2;
+        const texture = new BABYLON.RawTexture(new Uint8Array(textureSize * textureSize * 4), textureSize, textureSize,
+            BABYLON.Constants.TEXTUREFORMAT_RGBA, scene, false, false, BABYLON.Texture.NEAREST_SAMPLINGMODE);
+
+        const buffers = [];
+        for (let i = 0; i < readsPerFrame; ++i) {
+            buffers.push(new Uint8Array(readSize * readSize * 4));
+        }
+
+        let issued = 0;
+        let completed = 0;
+        engine.runRenderLoop(() => {
+            for (let i = 0; i < readsPerFrame && issued < readCount; ++i, ++issued) {
+                const x = (i % 2) * readSize;
+                texture.readPixels(0, 0, buffers[i], true, false, x, 0, readSize, readSize).then((pixels) => {
+                    if (pixels.buffer !== buffers[i].buffer) {
+                        throw new Error("readPixels did not return the provided buffer");
+                    }
+                    if (++completed === readCount) {
+                        engine.stopRenderLoop();
+                        reportResult(completed);
+                    }
+                });
+            }
+        });
+    )";
+    loader.Eval(script.str(), "read_texture.js");
+
+    auto result{completedReads.get_future()};
+    const auto start{std::chrono::steady_clock::now()};
+    while (result.wait_for(1ms) != std::future_status::ready)
+    {
+        device.FinishRenderingCurrentFrame();
+        device.StartRenderingCurrentFrame();
+
+        ASSERT_LT(std::chrono::steady_clock::now() - start, 60s) << "Reads did not complete";
+    }
+
+    EXPECT_EQ(result.get(), READ_COUNT);
+
+    const auto stats{context->GetReadbackStats()};
+    std::cout << stats.Requests << " reads: " << stats.Readbacks << " readbacks, " << stats.CoalescedRequests << " coalesced, "
+              << stats.ReadbackTexturesCreated << " readback textures created, " << stats.ReadbackTexturesReused << " reused, "
+              << stats.BytesRead << " bytes" << std::endl;
+
+    EXPECT_EQ(stats.Requests, READ_COUNT);
+    EXPECT_EQ(stats.Readbacks + stats.CoalescedRequests, READ_COUNT);
+    EXPECT_GT(stats.CoalescedRequests, 0u);
+    EXPECT_EQ(stats.Blits, stats.Readbacks);
+    EXPECT_EQ(stats.ReadbackTexturesCreated + stats.ReadbackTexturesReused, stats.Blits);
+    EXPECT_LT(stats.ReadbackTexturesCreated, stats.Blits);
+    EXPECT_EQ(stats.BytesRead, uint64_t{READ_COUNT} * READ_SIZE * READ_SIZE * 4);
+
+    device.FinishRenderingCurrentFrame();
+}
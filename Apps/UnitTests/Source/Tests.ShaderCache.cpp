@@ -6,6 +6,7 @@
 #include <Babylon/Polyfills/Window.h>
 #include <Babylon/Plugins/NativeEngine.h>
 #include <Babylon/Plugins/ShaderCache.h>
+#include <Babylon/Plugins/ShaderCacheInternal.h>
 #include <Babylon/ScriptLoader.h>
 
 #include "App.h"
@@ -17,11 +18,67 @@
 #include <future>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
+#include <string>
 
 using namespace std::chrono_literals;
 
 extern Babylon::Graphics::Configuration g_deviceConfig;
 
+namespace
+{
+    // The journal tests only exercise persistence, so they add fabricated entries instead of
+    // compiling real shaders.
+    Babylon::Graphics::BgfxShaderInfo MakeShaderInfo(uint8_t seed)
+    {
+        Babylon::Graphics::BgfxShaderInfo info{};
+        info.VertexBytes.assign(64 + seed, seed);
+        info.FragmentBytes.assign(32 + seed, static_cast<uint8_t>(seed + 1));
+        info.VertexAttributeLocations["position"] = seed;
+        info.UniformStages["world"] = static_cast<uint8_t>(seed % 2);
+        return info;
+    }
+
+    std::string VertexSource(uint8_t seed)
+    {
+        return "void main() { gl_Position = vec4(" + std::to_string(seed) + ".0); }";
+    }
+
+    std::string FragmentSource(uint8_t seed)
+    {
+        return "void main() { gl_FragColor = vec4(" + std::to_string(seed) + ".0); }";
+    }
+
+    void AddShaders(uint8_t first, uint8_t count)
+    {
+        for (uint8_t seed = first; seed < first + count; ++seed)
+        {
+            Babylon::Plugins::ShaderCache::AddShader(VertexSource(seed), FragmentSource(seed), MakeShaderInfo(seed));
+        }
+    }
+
+    bool HasShader(uint8_t seed)
+    {
+        const auto info = Babylon::Plugins::ShaderCache::GetShader(VertexSource(seed), FragmentSource(seed));
+        return info && info->VertexBytes == MakeShaderInfo(seed).VertexBytes && info->UniformStages == MakeShaderInfo(seed).UniformStages;
+    }
+
+    // Simulates a process restart: drops the in-memory cache and reopens the journal.
+    uint32_t Reopen(const std::filesystem::path& path)
+    {
+        Babylon::Plugins::ShaderCache::Disable();
+        Babylon::Plugins::ShaderCache::Enable();
+        return Babylon::Plugins::ShaderCache::OpenJournal(path.string());
+    }
+
+    std::filesystem::path JournalPath(const char* name)
+    {
+        const auto path = GetExecutableDirectory() / name;
+        std::filesystem::remove(path);
+        return path;
+    }
+}
+
 TEST(ShaderCache, SaveAndLoad)
 {
     Babylon::Plugins::ShaderCache::Enable();
@@ -99,3 +156,168 @@ TEST(ShaderCache, SaveAndLoad)
 
     Babylon::Plugins::ShaderCache::Disable();
 }
+
+TEST(ShaderCache, JournalAppendsAndReloads)
+{
+    const auto path = JournalPath("shaderCacheJournal.bin");
+
+    Babylon::Plugins::ShaderCache::Enable();
+    EXPECT_EQ(Babylon::Plugins::ShaderCache::OpenJournal(path.string()), 0u);
+
+    AddShaders(0, 3);
+    Babylon::Plugins::ShaderCache::FlushJournal();
+
+    // Re-adding an existing shader must not append a second record.
+    AddShaders(0, 1);
+
+    EXPECT_EQ(Reopen(path), 3u);
+    for (uint8_t seed = 0; seed < 3; ++seed)
+    {
+        EXPECT_TRUE(HasShader(seed)) << "Missing shader " << static_cast<int>(seed);
+    }
+
+    Babylon::Plugins::ShaderCache::Disable();
+    std::filesystem::remove(path);
+}
+
+TEST(ShaderCache, JournalIgnoresTornTail)
+{
+    const auto path = JournalPath("shaderCacheJournalTorn.bin");
+
+    Babylon::Plugins::ShaderCache::Enable();
+    Babylon::Plugins::ShaderCache::OpenJournal(path.string());
+    AddShaders(0, 3);
+    Babylon::Plugins::ShaderCache::Disable();
+
+    // A crash mid-append leaves a partial last record.
+    const auto intactSize = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, intactSize - 7);
+
+    Babylon::Plugins::ShaderCache::Enable();
+    EXPECT_EQ(Babylon::Plugins::ShaderCache::OpenJournal(path.string()), 2u);
+    EXPECT_TRUE(HasShader(0));
+    EXPECT_TRUE(HasShader(1));
+    EXPECT_FALSE(HasShader(2));
+
+    // The torn bytes are cut off, so records appended afterwards are readable.
+    AddShaders(2, 2);
+    EXPECT_EQ(Reopen(path), 4u);
+    for (uint8_t seed = 0; seed < 4; ++seed)
+    {
+        EXPECT_TRUE(HasShader(seed)) << "Missing shader " << static_cast<int>(seed);
+    }
+
+    Babylon::Plugins::ShaderCache::Disable();
+    std::filesystem::remove(path);
+}
+
+TEST(ShaderCache, JournalIgnoresCorruptTail)
+{
+    const auto path = JournalPath("shaderCacheJournalCorrupt.bin");
+
+    Babylon::Plugins::ShaderCache::Enable();
+    Babylon::Plugins::ShaderCache::OpenJournal(path.string());
+    AddShaders(0, 2);
+    Babylon::Plugins::ShaderCache::Disable();
+
+    // A full-length last record whose bytes never reached the disk fails its checksum.
+    {
+        std::fstream stream{path, std::ios::binary | std::ios::in | std::ios::out};
+        stream.seekp(-1, std::ios::end);
+        stream.put('\x5A');
+    }
+
+    EXPECT_EQ(Reopen(path), 1u);
+    EXPECT_TRUE(HasShader(0));
+    EXPECT_FALSE(HasShader(1));
+
+    Babylon::Plugins::ShaderCache::Disable();
+    std::filesystem::remove(path);
+}
+
+TEST(ShaderCache, JournalCompaction)
+{
+    const auto path = JournalPath("shaderCacheJournalCompaction.bin");
+
+    Babylon::Plugins::ShaderCache::Enable();
+    Babylon::Plugins::ShaderCache::OpenJournal(path.string());
+    AddShaders(0, 4);
+    Babylon::Plugins::ShaderCache::FlushJournal();
+    const auto fullSize = std::filesystem::file_size(path);
+
+    // Clearing the cache compacts the journal down to nothing; shaders added while that
+    // runs in the background must survive the swap.
+    Babylon::Plugins::ShaderCache::Clear();
+    AddShaders(10, 1);
+    Babylon::Plugins::ShaderCache::CloseJournal();
+
+    EXPECT_LT(std::filesystem::file_size(path), fullSize);
+    EXPECT_EQ(Reopen(path), 1u);
+    EXPECT_TRUE(HasShader(10));
+    EXPECT_FALSE(HasShader(0));
+
+    // An explicit compaction keeps every entry.
+    AddShaders(0, 2);
+    Babylon::Plugins::ShaderCache::CompactJournal();
+    AddShaders(2, 1);
+    EXPECT_EQ(Reopen(path), 4u);
+
+    Babylon::Plugins::ShaderCache::Disable();
+    std::filesystem::remove(path);
+}
+
+TEST(ShaderCache, JournalMigratesSnapshot)
+{
+    const auto path = JournalPath("shaderCacheJournalSnapshot.bin");
+
+    Babylon::Plugins::ShaderCache::Enable();
+    AddShaders(0, 2);
+    {
+        std::ofstream stream{path, std::ios::binary};
+        EXPECT_EQ(Babylon::Plugins::ShaderCache::Save(stream), 2u);
+    }
+    Babylon::Plugins::ShaderCache::Disable();
+
+    Babylon::Plugins::ShaderCache::Enable();
+    EXPECT_EQ(Babylon::Plugins::ShaderCache::OpenJournal(path.string()), 2u);
+    EXPECT_EQ(Reopen(path), 2u);
+    EXPECT_TRUE(HasShader(0));
+    EXPECT_TRUE(HasShader(1));
+
+    Babylon::Plugins::ShaderCache::Disable();
+    std::filesystem::remove(path);
+}
+
+TEST(ShaderCache, JournalReopen)
+{
+    const auto path = JournalPath("shaderCacheJournalReopen.bin");
+    const auto otherPath = JournalPath("shaderCacheJournalReopenOther.bin");
+
+    Babylon::Plugins::ShaderCache::Enable();
+    EXPECT_EQ(Babylon::Plugins::ShaderCache::OpenJournal(path.string()), 0u);
+    AddShaders(0, 2);
+
+    // Opening the same file again (e.g. from a second runtime) shares the open journal, even
+    // when the path is spelled differently.
+    const auto respelled = path.parent_path() / "." / path.filename();
+    EXPECT_EQ(Babylon::Plugins::ShaderCache::OpenJournal(respelled.string()), 0u);
+
+    // A different file is refused rather than silently ignored, and the open journal keeps
+    // receiving shaders.
+    EXPECT_THROW(Babylon::Plugins::ShaderCache::OpenJournal(otherPath.string()), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(otherPath));
+    AddShaders(2, 1);
+
+    // Switching files takes an explicit close.
+    Babylon::Plugins::ShaderCache::CloseJournal();
+    EXPECT_EQ(Babylon::Plugins::ShaderCache::OpenJournal(otherPath.string()), 0u);
+    AddShaders(3, 1);
+    Babylon::Plugins::ShaderCache::CloseJournal();
+
+    EXPECT_EQ(Reopen(path), 3u);
+    EXPECT_EQ(Reopen(otherPath), 4u);
+
+    Babylon::Plugins::ShaderCache::Disable();
+    std::filesystem::remove(path);
+    std::filesystem::remove(otherPath);
+}
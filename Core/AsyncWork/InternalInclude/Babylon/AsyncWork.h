@@ -0,0 +1,142 @@
+#pragma once
+
+#include <Babylon/JsRuntime.h>
+#include <Babylon/JsRuntimeScheduler.h>
+
+#include <napi/napi.h>
+
+#include <arcana/threading/cancellation.h>
+#include <arcana/threading/task.h>
+#include <arcana/threading/task_schedulers.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace Babylon
+{
+    // Tracks in-flight threadpool work. Cancellation only short-circuits scheduling, so a task
+    // already running on a threadpool thread keeps going; Wait() drains these before teardown
+    // frees the resources they reference.
+    class AsyncTaskTracker final
+    {
+    public:
+        // RAII token: increments the in-flight count on construction and decrements it
+        // (notifying any waiter) on destruction. Counting is tied to the token's lifetime
+        // so the Enter/Leave pair can never be split by an exception.
+        class Scope final
+        {
+        public:
+            explicit Scope(std::shared_ptr<AsyncTaskTracker> tracker)
+                : m_tracker{std::move(tracker)}
+            {
+                std::lock_guard<std::mutex> lock{m_tracker->m_mutex};
+                ++m_tracker->m_count;
+            }
+
+            ~Scope()
+            {
+                {
+                    std::lock_guard<std::mutex> lock{m_tracker->m_mutex};
+                    --m_tracker->m_count;
+                }
+                m_tracker->m_condition.notify_all();
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            std::shared_ptr<AsyncTaskTracker> m_tracker;
+        };
+
+        // Blocks until the in-flight count reaches zero.
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_condition.wait(lock, [this]() { return m_count == 0; });
+        }
+
+    private:
+        std::mutex m_mutex{};
+        std::condition_variable m_condition{};
+        uint32_t m_count{};
+    };
+
+    // The threadpool work the plugins run for one JavaScript environment. The environment owns
+    // it, so tearing the environment down cancels the work that has not started, and waits for
+    // the running work before the arrays it reads and writes are freed.
+    class AsyncWork final
+    {
+    public:
+        // Creates the AsyncWork of the environment, unless a plugin initialized before did.
+        static void CreateForJavaScript(Napi::Env env)
+        {
+            auto nativeObject{JsRuntime::NativeObject::GetFromJavaScript(env)};
+            if (!nativeObject.Has(JS_ASYNC_WORK_NAME))
+            {
+                nativeObject.Set(JS_ASYNC_WORK_NAME, Napi::External<AsyncWork>::New(env, new AsyncWork(env), [](Napi::Env, AsyncWork* asyncWork) { delete asyncWork; }));
+            }
+        }
+
+        static AsyncWork& GetFromJavaScript(Napi::Env env)
+        {
+            return *JsRuntime::NativeObject::GetFromJavaScript(env).Get(JS_ASYNC_WORK_NAME).As<Napi::External<AsyncWork>>().Data();
+        }
+
+        ~AsyncWork()
+        {
+            m_cancellationSource->cancel();
+            m_tracker->Wait();
+        }
+
+        AsyncWork(const AsyncWork&) = delete;
+        AsyncWork& operator=(const AsyncWork&) = delete;
+
+        // Runs `work` on the threadpool, unless the environment is torn down first. `work` is
+        // passed the cancellation, to stop early once it is.
+        template<typename WorkT>
+        auto Run(WorkT work)
+        {
+            return arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource,
+                [work{std::move(work)}, cancellationSource{m_cancellationSource}, scope{std::make_shared<AsyncTaskTracker::Scope>(m_tracker)}]() {
+                    return work(static_cast<const arcana::cancellation&>(*cancellationSource));
+                });
+        }
+
+        // Runs `work` on the threadpool with the result of `task`, unless the environment is torn
+        // down first.
+        template<typename ResultT, typename WorkT>
+        auto ThenRun(arcana::task<ResultT, std::exception_ptr> task, WorkT work)
+        {
+            return task.then(arcana::threadpool_scheduler, *m_cancellationSource,
+                [work{std::move(work)}, cancellationSource{m_cancellationSource}, scope{std::make_shared<AsyncTaskTracker::Scope>(m_tracker)}](const ResultT& result) {
+                    return work(result);
+                });
+        }
+
+        // Calls `callback` with the result of `task` on the JavaScript thread, unless the
+        // environment is torn down first.
+        template<typename ResultT, typename CallbackT>
+        void Then(arcana::task<ResultT, std::exception_ptr> task, CallbackT callback)
+        {
+            task.then(m_runtimeScheduler, *m_cancellationSource,
+                [callback{std::move(callback)}, cancellationSource{m_cancellationSource}](const arcana::expected<ResultT, std::exception_ptr>& result) {
+                    callback(result);
+                });
+        }
+
+    private:
+        static constexpr auto JS_ASYNC_WORK_NAME{"_nativeAsyncWork"};
+
+        explicit AsyncWork(Napi::Env env)
+            : m_runtimeScheduler{JsRuntime::GetFromJavaScript(env)}
+        {
+        }
+
+        JsRuntimeScheduler m_runtimeScheduler;
+        std::shared_ptr<arcana::cancellation_source> m_cancellationSource{std::make_shared<arcana::cancellation_source>()};
+        std::shared_ptr<AsyncTaskTracker> m_tracker{std::make_shared<AsyncTaskTracker>()};
+    };
+}
@@ -56,6 +56,17 @@ namespace Babylon::Graphics
         // Format to use when creating the depth/stencil texture for the back buffer.
         // Specify DepthStencilFormat::None to not create a depth/stencil texture.
         DepthStencilFormat BackBufferDepthStencilFormat{DepthStencilFormat::Depth24Stencil8};
+
+        // Number of JavaScript runtimes that will record rendering commands into this device
+        // concurrently, each on its own thread (e.g. several AppRuntimes sharing one device).
+        // @remarks Every runtime beyond the first gets its own bgfx encoder, and bgfx caps the
+        // total at BGFX_CONFIG_MAX_ENCODERS (8 by default) including one it keeps for itself.
+        // @remarks A runtime that runs out of bgfx views mid-frame has the frame flushed, which
+        // waits for every other runtime to reach a draw boundary. One that keeps running
+        // JavaScript between two draws holds that up, and both the render thread and the runtime
+        // that asked wait for it. After 250 ms the flush is abandoned for the rest of the frame,
+        // and that runtime throws "Too many views" once it runs out.
+        uint8_t MaxConcurrentRuntimes{1};
     };
 
     class DeviceImpl;
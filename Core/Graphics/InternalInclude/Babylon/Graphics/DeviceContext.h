@@ -10,8 +10,10 @@
 
 #include <bgfx/bgfx.h>
 
+#include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace Babylon::Graphics
 {
@@ -28,6 +30,38 @@ namespace Babylon::Graphics
         bgfx::TextureFormat::Enum Format{};
     };
 
+    // Region of one mip (and cube face or array layer) of a texture to read back.
+    struct TextureRegion final
+    {
+        uint8_t MipLevel{};
+        uint16_t X{};
+        uint16_t Y{};
+        uint16_t Layer{};
+        uint16_t Width{};
+        uint16_t Height{};
+    };
+
+    // Running totals for ReadTextureRegionAsync, since the device was created.
+    struct ReadbackStats final
+    {
+        // Region reads requested.
+        uint64_t Requests{};
+
+        // Requests served by the readback of an identical request in the same frame.
+        uint64_t CoalescedRequests{};
+
+        // bgfx::readTexture calls issued, and how many of them first needed a blit.
+        uint64_t Readbacks{};
+        uint64_t Blits{};
+
+        // Bytes delivered into caller buffers, counting every coalesced request.
+        uint64_t BytesRead{};
+
+        // Blit destinations created, and how often a pooled one was reused instead.
+        uint64_t ReadbackTexturesCreated{};
+        uint64_t ReadbackTexturesReused{};
+    };
+
     // FrameCompletionScope is an RAII guard that prevents the render thread from
     // closing a bgfx frame while JS-thread work is still in flight. While any
     // scope is alive, FinishRenderingCurrentFrame() blocks before bgfx::frame()
@@ -104,6 +138,15 @@ namespace Babylon::Graphics
 
         arcana::task<void, std::exception_ptr> ReadTextureAsync(bgfx::TextureHandle handle, gsl::span<uint8_t> data, uint8_t mipLevel = 0);
 
+        // Reads `region` of a texture back into native memory owned by the read, which the task
+        // yields once the data is available. With `blit` set, the region is first copied into a
+        // pooled readback texture of the same format and size; otherwise the whole mip is read
+        // directly, which requires BGFX_TEXTURE_READ_BACK. Identical reads requested within one
+        // frame share a single blit, readback and result, so the result must not be modified.
+        // Must be called while holding a FrameCompletionScope.
+        arcana::task<std::shared_ptr<const std::vector<uint8_t>>, std::exception_ptr> ReadTextureRegionAsync(bgfx::TextureHandle handle, bgfx::TextureFormat::Enum format, const TextureRegion& region, bool blit);
+        ReadbackStats GetReadbackStats() const;
+
         float GetHardwareScalingLevel();
         void SetHardwareScalingLevel(float level);
 
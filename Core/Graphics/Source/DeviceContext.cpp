@@ -97,6 +97,16 @@ namespace Babylon::Graphics
         return m_graphicsImpl.ReadTextureAsync(handle, data, mipLevel);
     }
 
+    arcana::task<std::shared_ptr<const std::vector<uint8_t>>, std::exception_ptr> DeviceContext::ReadTextureRegionAsync(bgfx::TextureHandle handle, bgfx::TextureFormat::Enum format, const TextureRegion& region, bool blit)
+    {
+        return m_graphicsImpl.ReadTextureRegionAsync(handle, format, region, blit);
+    }
+
+    ReadbackStats DeviceContext::GetReadbackStats() const
+    {
+        return m_graphicsImpl.GetReadbackStats();
+    }
+
     float DeviceContext::GetHardwareScalingLevel()
     {
         return m_graphicsImpl.GetHardwareScalingLevel();
@@ -4,7 +4,10 @@
 #include <Babylon/Graphics/Platform.h>
 #include <Babylon/Graphics/RendererType.h>
 #include <Babylon/JsRuntime.h>
+#include <arcana/threading/task_schedulers.h>
 #include <arcana/tracing/trace_region.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -23,6 +26,11 @@ namespace
 {
     constexpr auto JS_GRAPHICS_NAME = "_Graphics";
 
+    // Idle blit destinations kept for ReadTextureRegionAsync. Past the cap the least recently
+    // used one is destroyed, as is any left unused for READBACK_TEXTURE_IDLE_FRAMES frames.
+    constexpr size_t MAX_POOLED_READBACK_TEXTURES = 16;
+    constexpr uint32_t READBACK_TEXTURE_IDLE_FRAMES = 120;
+
     bool FuzzyEqual(float a, float b, float epsilon = std::numeric_limits<float>::epsilon())
     {
         return std::abs(a - b) < epsilon;
@@ -35,14 +43,26 @@ namespace
     {
         return value != nullptr && value[0] != '\0' && std::strcmp(value, "0") != 0;
     }
+
+    // How long a mid-frame view flush waits for every recording thread to reach a draw
+    // boundary before it gives up for the rest of the frame. Documented on
+    // Configuration::MaxConcurrentRuntimes.
+    constexpr auto FLUSH_BARRIER_TIMEOUT = std::chrono::milliseconds{250};
+
+    // Source of DeviceImpl::m_encoderEpoch values, shared by all devices so that a thread's
+    // cached encoder can never match a different device. 0 is never handed out.
+    std::atomic<uint64_t> s_nextEncoderEpoch{1};
 }
 
 namespace Babylon::Graphics
 {
+    thread_local DeviceImpl::EncoderCache DeviceImpl::s_encoderCache{};
+
     DeviceImpl::DeviceImpl(const Configuration& config)
         : m_bgfxCallback{[this](const auto& data) { CaptureCallback(data); }}
         , m_context{*this}
         , m_bgfxId{0}
+        , m_encoderEpoch{s_nextEncoderEpoch.fetch_add(1)}
     {
         std::scoped_lock lock{m_state.Mutex};
         m_state.Bgfx.Initialized = false;
@@ -107,6 +127,13 @@ namespace Babylon::Graphics
         init.resolution.reset = BGFX_RESET_VSYNC | BGFX_RESET_MAXANISOTROPY | BGFX_RESET_FLIP_AFTER_RENDER;
         init.resolution.maxFrameLatency = 1;
 
+        // One encoder per concurrently recording runtime, plus the one bgfx reserves for its
+        // API thread. Only raised, never lowered below the build's default.
+        if (config.MaxConcurrentRuntimes > 1)
+        {
+            init.limits.maxEncoders = std::max<uint16_t>(init.limits.maxEncoders, static_cast<uint16_t>(config.MaxConcurrentRuntimes + 1));
+        }
+
         UpdateSize(config.Width, config.Height);
         UpdateMSAA(config.MSAASamples);
         UpdateAlphaPremultiplied(config.AlphaPremultiplied);
@@ -280,12 +307,25 @@ namespace Babylon::Graphics
 
         if (m_state.Bgfx.Initialized)
         {
-            // Drain readTextures queue, completing them in an error state.
-            while (!m_readTextureRequests.empty())
+            // Drain readTextures queue, completing them in an error state. The requests are kept
+            // until bgfx is shut down, since a read still in flight writes into their storage.
+            std::vector<std::shared_ptr<ReadTextureRequest>> drainedRequests{};
             {
-                auto error = arcana::make_unexpected(std::make_exception_ptr(std::system_error(std::make_error_code(std::errc::operation_canceled))));
-                m_readTextureRequests.front().second.complete(error);
-                m_readTextureRequests.pop();
+                std::scoped_lock readTextureLock{m_readTextureRequestsMutex};
+                m_coalescableReadTextureRequests.clear();
+                while (!m_readTextureRequests.empty())
+                {
+                    auto error = arcana::make_unexpected(std::make_exception_ptr(std::system_error(std::make_error_code(std::errc::operation_canceled))));
+                    auto& request{*m_readTextureRequests.front()};
+                    ReleaseReadbackTexture(request);
+                    request.Completion.complete(error);
+                    for (auto& follower : request.Followers)
+                    {
+                        follower.complete(error);
+                    }
+                    drainedRequests.push_back(std::move(m_readTextureRequests.front()));
+                    m_readTextureRequests.pop();
+                }
             }
 
             // HACK: Render one more frame to drain the before/after render work queues.
@@ -294,6 +334,8 @@ namespace Babylon::Graphics
 
             m_cancellationSource->cancel();
 
+            DestroyReadbackTextures();
+
             bgfx::shutdown();
             m_state.Bgfx.Initialized = false;
             m_bgfxId++;
@@ -333,6 +375,7 @@ namespace Babylon::Graphics
         // Open the gate: allow JS thread to acquire FrameCompletionScopes and use the encoder.
         {
             std::lock_guard lock{m_frameSyncMutex};
+            InvalidateEncoderCaches();
             m_frameBlocked = false;
         }
         m_frameSyncCV.notify_all();
@@ -377,8 +420,20 @@ namespace Babylon::Graphics
 
                 if (m_flushRequested)
                 {
-                    PerformMidFrameViewFlush();
+                    // Other runtimes may be recording into encoders of their own. They park at
+                    // their next draw boundary, or become idle when they release their scope.
+                    if (m_frameSyncCV.wait_for(lock, FLUSH_BARRIER_TIMEOUT, [this] { return EncoderThreadsIdle(); }))
+                    {
+                        PerformMidFrameViewFlush();
+                    }
+                    else
+                    {
+                        m_flushBarrierTimedOut = true;
+                    }
+
                     m_flushRequested = false;
+                    m_flushPending.store(false);
+                    ++m_flushGeneration;
                     m_flushCompleteCV.notify_all();
                     continue;
                 }
@@ -399,6 +454,8 @@ namespace Babylon::Graphics
             m_frameEncoder = nullptr;
         }
 
+        EndThreadEncoders();
+
         Frame();
 
         m_afterRenderDispatcher.tick(*m_cancellationSource);
@@ -463,6 +520,9 @@ namespace Babylon::Graphics
     // in FinishRenderingCurrentFrame for all scopes to be released.
     void DeviceImpl::DecrementPendingFrameScopes()
     {
+        // Releasing a scope ends a batch of recording, so the releasing thread is at a boundary.
+        MarkEncoderIdle();
+
         {
             std::lock_guard lock{m_frameSyncMutex};
             m_pendingFrameScopes--;
@@ -472,12 +532,138 @@ namespace Babylon::Graphics
 
     void DeviceImpl::SetActiveEncoder(bgfx::Encoder* encoder)
     {
+        std::scoped_lock lock{m_frameSyncMutex};
         m_frameEncoder = encoder;
+        InvalidateEncoderCaches();
+    }
+
+    // Called for every draw, so once the calling thread has an encoder for the frame it is
+    // found through the thread's cache, without a lock.
+    bgfx::Encoder* DeviceImpl::GetActiveEncoder()
+    {
+        auto& cache = s_encoderCache;
+        if (cache.Epoch != m_encoderEpoch.load())
+        {
+            return AcquireEncoder(false);
+        }
+
+        if (!cache.Thread)
+        {
+            // No frame in progress.
+            return nullptr;
+        }
+
+        // Publish that the thread is recording before checking for a flush, which checks the
+        // other way round, so that the flush never ends an encoder that is being used. The
+        // epoch is checked again as a flush may have completed since it was first read.
+        const bool recording = cache.Thread->Recording.exchange(true);
+        if (!m_flushPending.load() && cache.Epoch == m_encoderEpoch.load())
+        {
+            return cache.Thread->Encoder;
+        }
+
+        if (!recording)
+        {
+            cache.Thread->Recording.store(false);
+        }
+        return AcquireEncoder(recording);
+    }
+
+    // `recording` tells that the thread is in the middle of recording, so must not wait for a
+    // pending flush, which in turn waits for it.
+    bgfx::Encoder* DeviceImpl::AcquireEncoder(bool recording)
+    {
+        std::unique_lock lock{m_frameSyncMutex};
+
+        if (m_flushRequested && !recording && !m_renderThreadAffinity.check())
+        {
+            // Only wakes the render thread when this thread was what it waited for.
+            m_frameSyncCV.notify_all();
+            const auto generation = m_flushGeneration;
+            m_flushCompleteCV.wait(lock, [this, generation] { return m_flushGeneration != generation; });
+        }
+
+        auto& cache = s_encoderCache;
+        cache.Epoch = m_encoderEpoch.load();
+        cache.Thread = {};
+
+        if (m_frameEncoder == nullptr)
+        {
+            return nullptr;
+        }
+
+        const auto threadId = std::this_thread::get_id();
+        for (const auto& thread : m_encoderThreads)
+        {
+            if (thread->Id == threadId)
+            {
+                cache.Thread = thread;
+                thread->Recording.store(true);
+                return thread->Encoder;
+            }
+        }
+
+        // The common case is a single runtime, whose thread claims the frame encoder. Another
+        // runtime recording into the same frame gets an encoder of its own.
+        const bool ownsFrameEncoder = std::none_of(m_encoderThreads.begin(), m_encoderThreads.end(), [](const auto& thread) { return thread->OwnsFrameEncoder; });
+        bgfx::Encoder* encoder = ownsFrameEncoder ? m_frameEncoder : bgfx::begin(true);
+        if (encoder == nullptr)
+        {
+            throw std::runtime_error{"Too many runtimes are rendering concurrently. Raise Configuration::MaxConcurrentRuntimes."};
+        }
+
+        auto thread = std::make_shared<EncoderThread>();
+        thread->Id = threadId;
+        thread->Encoder = encoder;
+        thread->OwnsFrameEncoder = ownsFrameEncoder;
+        thread->Recording.store(true);
+        m_encoderThreads.push_back(thread);
+        cache.Thread = std::move(thread);
+        return encoder;
+    }
+
+    // Called with m_frameSyncMutex held whenever the encoders change, so that every thread
+    // looks its encoder up again.
+    void DeviceImpl::InvalidateEncoderCaches()
+    {
+        m_encoderEpoch.store(s_nextEncoderEpoch.fetch_add(1));
+    }
+
+    void DeviceImpl::MarkEncoderIdle()
+    {
+        const auto& cache = s_encoderCache;
+        if (cache.Thread && cache.Epoch == m_encoderEpoch.load())
+        {
+            cache.Thread->Recording.store(false);
+        }
+    }
+
+    // Called on the render thread with m_frameSyncMutex held. The render thread itself does
+    // not record while it waits for the other threads.
+    bool DeviceImpl::EncoderThreadsIdle() const
+    {
+        const auto threadId = std::this_thread::get_id();
+        return std::all_of(m_encoderThreads.begin(), m_encoderThreads.end(), [threadId](const auto& thread) {
+            return thread->Id == threadId || !thread->Recording.load();
+        });
     }
 
-    bgfx::Encoder* DeviceImpl::GetActiveEncoder() const
+    // Called on the render thread once every FrameCompletionScope has been released, so no
+    // other thread can still be recording into these encoders.
+    void DeviceImpl::EndThreadEncoders()
     {
-        return m_frameEncoder;
+        std::scoped_lock lock{m_frameSyncMutex};
+
+        for (const auto& thread : m_encoderThreads)
+        {
+            if (!thread->OwnsFrameEncoder)
+            {
+                bgfx::end(thread->Encoder);
+            }
+        }
+
+        m_encoderThreads.clear();
+        InvalidateEncoderCaches();
     }
 
     void DeviceImpl::RequestScreenShot(std::function<void(std::vector<uint8_t>)> callback)
@@ -492,9 +678,165 @@ namespace Babylon::Graphics
 
     arcana::task<void, std::exception_ptr> DeviceImpl::ReadTextureAsync(bgfx::TextureHandle handle, gsl::span<uint8_t> data, uint8_t mipLevel)
     {
-        arcana::task_completion_source<void, std::exception_ptr> completionSource{};
-        m_readTextureRequests.emplace(bgfx::readTexture(handle, data.data(), mipLevel), completionSource);
-        return completionSource.as_task();
+        auto request{std::make_shared<ReadTextureRequest>()};
+        request->Data = data;
+
+        std::scoped_lock lock{m_readTextureRequestsMutex};
+        request->FrameNumber = bgfx::readTexture(handle, data.data(), mipLevel);
+        m_readTextureRequests.push(request);
+        return request->Completion.as_task();
+    }
+
+    arcana::task<std::shared_ptr<const std::vector<uint8_t>>, std::exception_ptr> DeviceImpl::ReadTextureRegionAsync(bgfx::TextureHandle handle, bgfx::TextureFormat::Enum format, const TextureRegion& region, bool blit)
+    {
+        bgfx::Encoder* encoder{blit ? GetActiveEncoder() : nullptr};
+        if (blit && encoder == nullptr)
+        {
+            throw std::runtime_error{"ReadTextureRegionAsync called outside of a frame."};
+        }
+
+        const ReadTextureKey key{handle.idx, region.MipLevel, region.X, region.Y, region.Layer, region.Width, region.Height, blit};
+
+        bgfx::TextureInfo info{};
+        bgfx::calcTextureSize(info, region.Width, region.Height, /*depth*/ 1, /*cubeMap*/ false, /*hasMips*/ false, /*numLayers*/ 1, format);
+
+        const auto yieldStorage{[](std::shared_ptr<std::vector<uint8_t>> storage) {
+            return [storage{std::move(storage)}]() -> std::shared_ptr<const std::vector<uint8_t>> {
+                return storage;
+            };
+        }};
+
+        std::scoped_lock lock{m_readTextureRequestsMutex};
+        ++m_readbackStats.Requests;
+
+        // A read identical to one already recorded this frame would blit and read back the same
+        // texels, so it just shares that read's data.
+        if (const auto it{m_coalescableReadTextureRequests.find(key)}; it != m_coalescableReadTextureRequests.end() && it->second->Storage->size() == info.storageSize)
+        {
+            arcana::task_completion_source<void, std::exception_ptr> completionSource{};
+            it->second->Followers.push_back(completionSource);
+            ++m_readbackStats.CoalescedRequests;
+            return completionSource.as_task().then(arcana::inline_scheduler, arcana::cancellation::none(), yieldStorage(it->second->Storage));
+        }
+
+        auto request{std::make_shared<ReadTextureRequest>()};
+        request->Storage = std::make_shared<std::vector<uint8_t>>(info.storageSize);
+        request->Data = *request->Storage;
+
+        bgfx::TextureHandle readHandle{handle};
+        uint8_t readMipLevel{region.MipLevel};
+        if (blit)
+        {
+            request->ReadbackTexture = AcquireReadbackTexture(format, region.Width, region.Height);
+            request->ReadbackFormat = format;
+            request->ReadbackWidth = region.Width;
+            request->ReadbackHeight = region.Height;
+
+            encoder->blit(static_cast<uint16_t>(bgfx::getCaps()->limits.maxViews - 1), request->ReadbackTexture, /*dstMip*/ 0, /*dstX*/ 0, /*dstY*/ 0, /*dstZ*/ 0, handle, region.MipLevel, region.X, region.Y, region.Layer, region.Width, region.Height, /*depth*/ 0);
+            ++m_readbackStats.Blits;
+
+            readHandle = request->ReadbackTexture;
+            readMipLevel = 0;
+        }
+
+        request->FrameNumber = bgfx::readTexture(readHandle, request->Data.data(), readMipLevel);
+        ++m_readbackStats.Readbacks;
+
+        auto task{request->Completion.as_task().then(arcana::inline_scheduler, arcana::cancellation::none(), yieldStorage(request->Storage))};
+        m_readTextureRequests.push(request);
+        m_coalescableReadTextureRequests[key] = std::move(request);
+        return task;
+    }
+
+    ReadbackStats DeviceImpl::GetReadbackStats() const
+    {
+        std::scoped_lock lock{m_readTextureRequestsMutex};
+        return m_readbackStats;
+    }
+
+    // Called with m_readTextureRequestsMutex held. Prefers the most recently released match so
+    // that the least recently used textures are the ones left to age out of the pool.
+    bgfx::TextureHandle DeviceImpl::AcquireReadbackTexture(bgfx::TextureFormat::Enum format, uint16_t width, uint16_t height)
+    {
+        for (auto it = m_readbackTexturePool.rbegin(); it != m_readbackTexturePool.rend(); ++it)
+        {
+            if (it->Format == format && it->Width == width && it->Height == height)
+            {
+                const bgfx::TextureHandle handle{it->Handle};
+                m_readbackTexturePool.erase(std::next(it).base());
+                ++m_readbackStats.ReadbackTexturesReused;
+                return handle;
+            }
+        }
+
+        ++m_readbackStats.ReadbackTexturesCreated;
+        return bgfx::createTexture2D(width, height, /*hasMips*/ false, /*numLayers*/ 1, format, BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK);
+    }
+
+    // Called with m_readTextureRequestsMutex held.
+    void DeviceImpl::ReleaseReadbackTexture(const ReadTextureRequest& request)
+    {
+        if (!bgfx::isValid(request.ReadbackTexture))
+        {
+            return;
+        }
+
+        m_readbackTexturePool.push_back({request.ReadbackTexture, request.ReadbackFormat, request.ReadbackWidth, request.ReadbackHeight, m_lastFrameNumber});
+        if (m_readbackTexturePool.size() > MAX_POOLED_READBACK_TEXTURES)
+        {
+            bgfx::destroy(m_readbackTexturePool.front().Handle);
+            m_readbackTexturePool.erase(m_readbackTexturePool.begin());
+        }
+    }
+
+    void DeviceImpl::CompleteReadTextureRequests(uint32_t frameNumber)
+    {
+        std::vector<std::shared_ptr<ReadTextureRequest>> completedRequests{};
+        {
+            std::scoped_lock lock{m_readTextureRequestsMutex};
+
+            // Reads recorded from here on land in a later frame and may see different contents.
+            m_coalescableReadTextureRequests.clear();
+            m_lastFrameNumber = frameNumber;
+
+            while (!m_readTextureRequests.empty() && m_readTextureRequests.front()->FrameNumber <= frameNumber)
+            {
+                auto& request{m_readTextureRequests.front()};
+                ReleaseReadbackTexture(*request);
+                m_readbackStats.BytesRead += request->Data.size() * (request->Followers.size() + 1);
+                completedRequests.push_back(std::move(request));
+                m_readTextureRequests.pop();
+            }
+
+            m_readbackTexturePool.erase(std::remove_if(m_readbackTexturePool.begin(), m_readbackTexturePool.end(), [frameNumber](const PooledReadbackTexture& texture) {
+                if (frameNumber - texture.LastUsedFrame > READBACK_TEXTURE_IDLE_FRAMES)
+                {
+                    bgfx::destroy(texture.Handle);
+                    return true;
+                }
+                return false;
+            }), m_readbackTexturePool.end());
+        }
+
+        // Completed outside the lock: continuations may issue new reads.
+        for (auto& request : completedRequests)
+        {
+            request->Completion.complete();
+            for (auto& follower : request->Followers)
+            {
+                follower.complete();
+            }
+        }
+    }
+
+    void DeviceImpl::DestroyReadbackTextures()
+    {
+        std::scoped_lock lock{m_readTextureRequestsMutex};
+        for (const auto& texture : m_readbackTexturePool)
+        {
+            bgfx::destroy(texture.Handle);
+        }
+        m_readbackTexturePool.clear();
     }
 
     DeviceImpl::CaptureCallbackTicketT DeviceImpl::AddCaptureCallback(std::function<void(const BgfxCallback::CaptureData&)> callback)
@@ -562,6 +904,21 @@ namespace Babylon::Graphics
         // rather than an error.
         constexpr uint32_t kMaxMidFrameViewFlushes = 64;
 
+        // A draw boundary: the calling thread holds no encoder state, so a flush may end its
+        // encoder. If another thread already asked for one, wait for it here.
+        MarkEncoderIdle();
+        if (m_flushPending.load() && !m_renderThreadAffinity.check())
+        {
+            std::unique_lock lock{m_frameSyncMutex};
+            if (m_flushRequested)
+            {
+                m_frameSyncCV.notify_all();
+                const auto generation = m_flushGeneration;
+                m_flushCompleteCV.wait(lock, [this, generation] { return m_flushGeneration != generation; });
+            }
+            return;
+        }
+
         const bgfx::ViewId maxViews = static_cast<bgfx::ViewId>(bgfx::getCaps()->limits.maxViews);
         if (maxViews <= kViewFlushMargin)
         {
@@ -605,22 +962,30 @@ namespace Babylon::Graphics
         // parked to service the request, and parking the JS thread on
         // m_flushCompleteCV would deadlock. Skip the flush in that case; the hard
         // cap in AcquireNewViewId remains as a backstop. Likewise skip if the gate
-        // is currently closed (bgfx::frame() in progress).
-        if (m_frameBlocked || m_pendingFrameScopes == 0)
+        // is currently closed (bgfx::frame() in progress), or if a flush already
+        // timed out in this frame waiting for another runtime to stop recording.
+        if (m_frameBlocked || m_pendingFrameScopes == 0 || m_flushBarrierTimedOut)
         {
             return;
         }
 
-        m_flushRequested = true;
+        // With several runtimes the flush also ends the encoders of the others, so the render
+        // thread waits for them to reach a boundary, where they park until it is done.
+        const auto generation = m_flushGeneration;
+        if (!m_flushRequested)
+        {
+            m_flushRequested = true;
+            m_flushPending.store(true);
+        }
         m_frameSyncCV.notify_all();
-        m_flushCompleteCV.wait(lock, [this] { return !m_flushRequested; });
+        m_flushCompleteCV.wait(lock, [this, generation] { return m_flushGeneration != generation; });
     }
 
     // Called on the render thread from FinishRenderingCurrentFrame while holding
     // m_frameSyncMutex, with the requesting JS thread parked in FlushViewsIfNeeded
-    // (so the frame encoder is idle). End the current encoder, advance a non-presenting
-    // bgfx frame to submit the accumulated views and reset the view counter, then begin
-    // a fresh encoder for the remainder of the logical frame.
+    // and every other thread idle (so no encoder is in use). End the encoders, advance
+    // a non-presenting bgfx frame to submit the accumulated views and reset the view
+    // counter, then begin a fresh encoder for the remainder of the logical frame.
     void DeviceImpl::PerformMidFrameViewFlush()
     {
         ASSERT_THREAD_AFFINITY(m_renderThreadAffinity);
@@ -631,6 +996,17 @@ namespace Babylon::Graphics
             m_frameEncoder = nullptr;
         }
 
+        // The other runtimes' encoders too: every thread is parked or between batches of
+        // recording, and gets a new encoder from GetActiveEncoder.
+        for (const auto& thread : m_encoderThreads)
+        {
+            if (!thread->OwnsFrameEncoder)
+            {
+                bgfx::end(thread->Encoder);
+            }
+        }
+        m_encoderThreads.clear();
+
         // BGFX_FRAME_FLUSH executes all queued rendering commands and resets bgfx's per-frame
         // state (including the view counter) without presenting the backbuffer. A plain
         // bgfx::frame() would flip a half-drawn backbuffer to the screen partway through the
@@ -638,6 +1014,12 @@ namespace Babylon::Graphics
         // still flips exactly once.
         bgfx::frame(BGFX_FRAME_FLUSH);
         m_nextViewId.store(0);
+
+        // Reads recorded after the flush may see contents the earlier ones did not.
+        {
+            std::scoped_lock lock{m_readTextureRequestsMutex};
+            m_coalescableReadTextureRequests.clear();
+        }
         m_midFrameFlushCount.fetch_add(1);
 
         // Publish a new generation so holders of cached view ids (FrameBuffer's m_viewId, the
@@ -647,6 +1029,7 @@ namespace Babylon::Graphics
         m_viewIdGeneration.fetch_add(1);
 
         m_frameEncoder = bgfx::begin(true);
+        InvalidateEncoderCaches();
     }
 
     void DeviceImpl::UpdateBgfxState()
@@ -712,14 +1095,15 @@ namespace Babylon::Graphics
         uint32_t frameNumber{bgfx::frame(frameFlags)};
 
         // Process read texture requests.
-        while (!m_readTextureRequests.empty() && m_readTextureRequests.front().first <= frameNumber)
-        {
-            m_readTextureRequests.front().second.complete();
-            m_readTextureRequests.pop();
-        }
+        CompleteReadTextureRequests(frameNumber);
 
         m_nextViewId.store(0);
         m_midFrameFlushCount.store(0);
+
+        {
+            std::scoped_lock lock{m_frameSyncMutex};
+            m_flushBarrierTimedOut = false;
+        }
     }
 
     void DeviceImpl::CaptureCallback(const BgfxCallback::CaptureData& data)
@@ -16,9 +16,13 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <optional>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
 namespace Babylon::Graphics
 {
@@ -88,6 +92,8 @@ namespace Babylon::Graphics
         void RequestCaptureNextFrame();
 
         arcana::task<void, std::exception_ptr> ReadTextureAsync(bgfx::TextureHandle handle, gsl::span<uint8_t> data, uint8_t mipLevel);
+        arcana::task<std::shared_ptr<const std::vector<uint8_t>>, std::exception_ptr> ReadTextureRegionAsync(bgfx::TextureHandle handle, bgfx::TextureFormat::Enum format, const TextureRegion& region, bool blit);
+        ReadbackStats GetReadbackStats() const;
 
         using CaptureCallbackTicketT = arcana::ticketed_collection<std::function<void(const BgfxCallback::CaptureData&)>>::ticket;
         CaptureCallbackTicketT AddCaptureCallback(std::function<void(const BgfxCallback::CaptureData&)> callback);
@@ -108,9 +114,11 @@ namespace Babylon::Graphics
         void IncrementPendingFrameScopes();
         void DecrementPendingFrameScopes();
 
-        // Active encoder for the current frame.
+        // Active encoder for the current frame and the calling thread. A mid-frame view flush
+        // may replace it at FlushViewsIfNeeded or when the thread releases a
+        // FrameCompletionScope, so callers must not keep encoder state across either.
         void SetActiveEncoder(bgfx::Encoder* encoder);
-        bgfx::Encoder* GetActiveEncoder() const;
+        bgfx::Encoder* GetActiveEncoder();
 
         /* ********** END DEVICE CONTEXT CONTRACT ********** */
 
@@ -138,17 +146,58 @@ namespace Babylon::Graphics
         void RequestScreenShots();
         void Frame();
         void PerformMidFrameViewFlush();
+        void EndThreadEncoders();
         void CaptureCallback(const BgfxCallback::CaptureData&);
 
+        struct ReadTextureRequest;
+        bgfx::TextureHandle AcquireReadbackTexture(bgfx::TextureFormat::Enum format, uint16_t width, uint16_t height);
+        void ReleaseReadbackTexture(const ReadTextureRequest& request);
+        void CompleteReadTextureRequests(uint32_t frameNumber);
+        void DestroyReadbackTextures();
+
         arcana::affinity m_renderThreadAffinity{};
         bool m_rendering{};
         bool m_firstFrameStarted{};
 
-        // The single bgfx encoder for the current frame. Acquired in
+        // The primary bgfx encoder for the current frame. Acquired in
         // StartRenderingCurrentFrame, ended in FinishRenderingCurrentFrame.
         // Read by all consumers via DeviceContext::GetActiveEncoder() → DeviceImpl::GetActiveEncoder().
         bgfx::Encoder* m_frameEncoder{nullptr};
 
+        // bgfx encoders are not thread-safe, so when several runtimes share this device only
+        // the first thread to ask for an encoder in a frame gets m_frameEncoder. Every other
+        // thread gets its own encoder, begun lazily in GetActiveEncoder and ended alongside
+        // m_frameEncoder before bgfx::frame(), or by a mid-frame view flush.
+        struct EncoderThread
+        {
+            std::thread::id Id{};
+            bgfx::Encoder* Encoder{};
+            bool OwnsFrameEncoder{};
+
+            // Set when GetActiveEncoder hands out the encoder, cleared when the thread reaches
+            // a draw boundary (FlushViewsIfNeeded) or releases a FrameCompletionScope. A
+            // mid-frame view flush waits until it is clear for every thread.
+            std::atomic<bool> Recording{};
+        };
+
+        // The calling thread's encoder, looked up without a lock for as long as Epoch matches
+        // m_encoderEpoch. The epochs are unique across devices, so one cache serves them all.
+        struct EncoderCache
+        {
+            uint64_t Epoch{};
+            std::shared_ptr<EncoderThread> Thread{};
+        };
+        static thread_local EncoderCache s_encoderCache;
+
+        bgfx::Encoder* AcquireEncoder(bool recording);
+        void InvalidateEncoderCaches();
+        void MarkEncoderIdle();
+        bool EncoderThreadsIdle() const;
+
+        // Guarded by m_frameSyncMutex. Changing it, or m_frameEncoder, bumps m_encoderEpoch.
+        std::vector<std::shared_ptr<EncoderThread>> m_encoderThreads{};
+        std::atomic<uint64_t> m_encoderEpoch{};
+
         // Widened to uint32_t so that a run of failed acquisitions cannot wrap the counter
         // back into the valid view range. AcquireNewViewId saturates it at limits.maxViews,
         // so it is always safe to narrow back to a bgfx::ViewId.
@@ -243,9 +292,18 @@ namespace Babylon::Graphics
 
         // Mid-frame view-flush handshake (guarded by m_frameSyncMutex):
         //   - JS thread sets m_flushRequested and waits on m_flushCompleteCV.
-        //   - Render thread (parked in FinishRenderingCurrentFrame) services the
-        //     request via PerformMidFrameViewFlush, clears the flag, and notifies.
+        //   - Other threads with an encoder park at their next draw boundary, and
+        //     threads without one in GetActiveEncoder.
+        //   - Render thread (parked in FinishRenderingCurrentFrame) waits until no
+        //     thread is recording, services the request via PerformMidFrameViewFlush,
+        //     clears the flag, bumps m_flushGeneration, and notifies.
+        // m_flushPending mirrors m_flushRequested for the lock-free GetActiveEncoder path.
+        // m_flushBarrierTimedOut stops further requests for the rest of the frame once a
+        // thread failed to reach a boundary in time.
         bool m_flushRequested{false};
+        bool m_flushBarrierTimedOut{false};
+        uint32_t m_flushGeneration{0};
+        std::atomic<bool> m_flushPending{false};
         std::condition_variable m_flushCompleteCV{};
 
         std::mutex m_captureCallbacksMutex{};
@@ -253,7 +311,48 @@ namespace Babylon::Graphics
 
         arcana::blocking_concurrent_queue<std::function<void(std::vector<uint8_t>)>> m_screenShotCallbacks{};
 
-        std::queue<std::pair<uint32_t, arcana::task_completion_source<void, std::exception_ptr>>> m_readTextureRequests{};
+        struct ReadTextureRequest
+        {
+            // bgfx frame number in which the data is available.
+            uint32_t FrameNumber{};
+            gsl::span<uint8_t> Data{};
+            arcana::task_completion_source<void, std::exception_ptr> Completion{};
+
+            // Native memory Data points into for region reads. The request owns it, so whatever bgfx
+            // writes on the render thread stays valid however long the caller lives.
+            std::shared_ptr<std::vector<uint8_t>> Storage{};
+
+            // Identical requests coalesced into this one; they are all handed Storage.
+            std::vector<arcana::task_completion_source<void, std::exception_ptr>> Followers{};
+
+            // Pooled blit destination, returned to the pool once the read completes.
+            bgfx::TextureHandle ReadbackTexture{BGFX_INVALID_HANDLE};
+            bgfx::TextureFormat::Enum ReadbackFormat{};
+            uint16_t ReadbackWidth{};
+            uint16_t ReadbackHeight{};
+        };
+
+        // Identifies reads that can share one readback: same texture, region and path.
+        using ReadTextureKey = std::tuple<uint16_t, uint8_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool>;
+
+        struct PooledReadbackTexture
+        {
+            bgfx::TextureHandle Handle{BGFX_INVALID_HANDLE};
+            bgfx::TextureFormat::Enum Format{};
+            uint16_t Width{};
+            uint16_t Height{};
+            uint32_t LastUsedFrame{};
+        };
+
+        // Requests can arrive from any runtime sharing the device, so the queue, the pool and the
+        // stats are locked. m_coalescableReadTextureRequests only holds requests recorded since the
+        // last bgfx::frame(); anything older may see different texture contents.
+        mutable std::mutex m_readTextureRequestsMutex{};
+        std::queue<std::shared_ptr<ReadTextureRequest>> m_readTextureRequests{};
+        std::map<ReadTextureKey, std::shared_ptr<ReadTextureRequest>> m_coalescableReadTextureRequests{};
+        std::vector<PooledReadbackTexture> m_readbackTexturePool{};
+        uint32_t m_lastFrameNumber{};
+        ReadbackStats m_readbackStats{};
 
         DeviceContext m_context;
         uintptr_t m_bgfxId = 0;
@@ -1,18 +1,33 @@
 #pragma once
 
 #include <Babylon/Embedding/RuntimeOptions.h>
+#include <Babylon/Embedding/StartupTimeline.h>
 
 #include <napi/env.h>
 
 #include <functional>
 #include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace Babylon::Embedding
 {
     class View;
     struct RuntimeImpl;
 
+#if BABYLON_NATIVE_PLUGIN_SHADERCACHE
+    // A vertex/fragment source pair for `Runtime::Prewarm`. Must be the
+    // exact sources NativeEngine receives from Babylon.js (i.e. after
+    // preprocessing), since the shader cache is keyed on them.
+    struct PrewarmShader
+    {
+        std::string vertexSource;
+        std::string fragmentSource;
+    };
+#endif
+
     // Long-lived: typically created once per app/process. Sets up the
     // AppRuntime (JS thread + Napi env), JsRuntime, and non-GPU
     // polyfills/plugins. Construction is cheap and synchronous; the GPU
@@ -88,6 +103,28 @@ namespace Babylon::Embedding
         void Resume();
         bool IsSuspended() const;
 
+        // ----- Startup -----
+        //
+        // Phase durations of this Runtime's cold start. Empty until the first
+        // `View::RenderFrame` that runs after engine initialization and after
+        // every `LoadScript` / `Eval` queued before it has executed. Safe to
+        // call from any thread.
+        std::optional<StartupTimeline> GetStartupTimeline() const;
+
+#if BABYLON_NATIVE_PLUGIN_SHADERCACHE
+        // Moves shader work off the first attach. Starts, on background
+        // threads, loading `RuntimeOptions::shaderCachePath` into the shader
+        // cache and then compiling each of `shaders` that is not already
+        // cached. With no shaders this only hydrates the cache.
+        //
+        // Call at most once, before the first `View` is attached; throws
+        // otherwise. The first attach waits for any work still in flight,
+        // so call this as early as possible (e.g. right after constructing
+        // the Runtime, before creating the window). Throws if `shaders` is
+        // non-empty and this build has no shader compiler.
+        void Prewarm(std::vector<PrewarmShader> shaders = {});
+#endif
+
 #if BABYLON_NATIVE_PLUGIN_NATIVEXR
         // ----- XR session control -----
         //
@@ -46,12 +46,16 @@ namespace Babylon::Embedding
 
 #if BABYLON_NATIVE_PLUGIN_SHADERCACHE
         // Optional path for persisting the GPU shader cache across sessions.
-        // If non-empty:
+        // The file is an append-only journal. If non-empty:
         //   - Loaded synchronously during the first View attach (missing
-        //     or unreadable file: ignored).
-        //   - Saved synchronously during `Runtime::Suspend` (after the
-        //     in-flight frame is closed, when the engine is quiescent).
-        //   - Saved synchronously during `~Runtime`.
+        //     file: created; a record torn by a crash: dropped), or in the
+        //     background by `Runtime::Prewarm`.
+        //   - Each newly compiled shader is appended on a background thread.
+        //   - `Runtime::Suspend` and `~Runtime` only wait for those appends
+        //     to be synced to disk.
+        //   - The cache is process-wide, so Runtimes alive at the same time
+        //     must use the same path; attaching one with a different path
+        //     throws.
         std::string shaderCachePath;
 #endif
     };
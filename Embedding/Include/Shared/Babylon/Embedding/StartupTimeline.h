@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace Babylon::Embedding
+{
+    // Wall-clock breakdown of a Runtime's cold start, returned by
+    // `Runtime::GetStartupTimeline` once the first frame has been rendered.
+    //
+    // The phases are measured on the thread that runs them and may overlap
+    // (e.g. `prewarm` runs on background threads while the host is still
+    // creating its window), so they do not sum to `timeToFirstFrame`.
+    struct StartupTimeline
+    {
+        using Duration = std::chrono::microseconds;
+
+        // `AppRuntime` construction: JS engine creation and JS thread start.
+        Duration appRuntime{};
+
+        // Runtime construction until the first `View` was sized and began
+        // initializing. Host-controlled; usually window creation.
+        Duration untilFirstAttach{};
+
+        // Graphics `Device` construction plus opening its first frame.
+        Duration device{};
+
+        // Shader cache hydration on the first attach: loading
+        // `RuntimeOptions::shaderCachePath`, or waiting for any `Prewarm`
+        // work still in flight.
+        Duration shaderCache{};
+
+        // Polyfill and plugin `Initialize` calls on the JS thread.
+        Duration pluginInitialization{};
+
+        // From plugin initialization completing until every script queued
+        // with `LoadScript` / `Eval` before the first frame had run.
+        Duration scriptLoading{};
+
+        // From the scripts finishing until the end of the first
+        // `View::RenderFrame` after them. Includes the first frame's shader
+        // compiles (or cache hits).
+        Duration firstFrame{};
+
+        // Runtime construction until the end of that first frame.
+        Duration timeToFirstFrame{};
+
+        // Duration of `Runtime::Prewarm`, from its call until every shader
+        // was in the cache. Zero when Prewarm was not used.
+        Duration prewarm{};
+
+        // Number of shaders `Runtime::Prewarm` compiled. Sources already
+        // present in the cache are not counted.
+        uint32_t prewarmedShaders{};
+    };
+}
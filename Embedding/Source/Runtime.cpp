@@ -28,6 +28,10 @@
 #endif
 #if BABYLON_NATIVE_PLUGIN_SHADERCACHE
 #include <Babylon/Plugins/ShaderCache.h>
+#include <Babylon/Plugins/ShaderCacheInternal.h>
+#endif
+#if BABYLON_NATIVE_EMBEDDING_COMPILE_SHADERS
+#include <Babylon/Plugins/ShaderCompiler.h>
 #endif
 #if BABYLON_NATIVE_PLUGIN_TESTUTILS
 #include <Babylon/Plugins/TestUtils.h>
@@ -62,9 +66,15 @@
 #include <Babylon/Polyfills/Window.h>
 #endif
 
+#include <arcana/threading/task_schedulers.h>
+
+#include <algorithm>
 #include <cassert>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <utility>
 
 namespace Babylon::Embedding
@@ -83,10 +93,88 @@ namespace Babylon::Embedding
             }
             return LogLevel::Log;
         }
+
+#if BABYLON_NATIVE_PLUGIN_SHADERCACHE
+        // The shader cache is process-wide and shared by every Runtime, so only
+        // the first Runtime to attach enables it and only the last to go away
+        // disables it. Otherwise one Runtime's teardown would drop the cache out
+        // from under the others.
+        std::mutex s_shaderCacheUsersMutex{};
+        uint32_t s_shaderCacheUsers{0};
+
+        void AcquireShaderCache()
+        {
+            std::scoped_lock lock{s_shaderCacheUsersMutex};
+            if (s_shaderCacheUsers++ == 0)
+            {
+                Babylon::Plugins::ShaderCache::Enable();
+            }
+        }
+
+        void ReleaseShaderCache()
+        {
+            std::scoped_lock lock{s_shaderCacheUsersMutex};
+            if (--s_shaderCacheUsers == 0)
+            {
+                Babylon::Plugins::ShaderCache::Disable();
+            }
+        }
+
+        // Shared by the Runtime::Prewarm workers. The last worker to finish
+        // records the results and fulfills `done`.
+        struct PrewarmState
+        {
+            explicit PrewarmState(std::vector<PrewarmShader> shaders)
+                : shaders{std::move(shaders)}
+                , remaining{this->shaders.size()}
+            {
+            }
+
+            std::vector<PrewarmShader> shaders;
+            std::atomic<size_t> remaining;
+            std::atomic<uint32_t> compiled{0};
+            std::promise<void> done;
+        };
+
+        // Compiles `shader` into the cache unless it is already there.
+        // Returns whether it compiled. Compile errors are left for
+        // NativeEngine to report when the shader is actually requested.
+        bool CompileIntoShaderCache([[maybe_unused]] const PrewarmShader& shader)
+        {
+#if BABYLON_NATIVE_EMBEDDING_COMPILE_SHADERS
+            if (Babylon::Plugins::ShaderCache::GetShader(shader.vertexSource, shader.fragmentSource))
+            {
+                return false;
+            }
+
+            try
+            {
+                Babylon::Plugins::ShaderCompiler compiler{};
+                Babylon::Plugins::ShaderCache::AddShader(shader.vertexSource, shader.fragmentSource,
+                    compiler.Compile(shader.vertexSource, shader.fragmentSource));
+                return true;
+            }
+            catch (const std::exception&)
+            {
+                return false;
+            }
+#else
+            return false;
+#endif
+        }
+#endif
+
+        StartupTimeline::Duration Elapsed(RuntimeImpl::Clock::time_point from, RuntimeImpl::Clock::time_point to)
+        {
+            return std::chrono::duration_cast<StartupTimeline::Duration>(std::max(to - from, RuntimeImpl::Clock::duration::zero()));
+        }
     }
+
     RuntimeImpl::RuntimeImpl(RuntimeOptions options)
         : m_options{std::move(options)}
     {
+        MarkStartup(&StartupMarks::constructed);
+
         // Forward DebugTrace through the host log callback (Verbose level
         // for easy filtering). DebugTrace is process-wide.
         if (m_options.log)
@@ -122,6 +210,8 @@ namespace Babylon::Embedding
         // ScriptLoader's dispatcher captures &m_appRuntime, so ~ScriptLoader
         // must run before ~AppRuntime.
         m_scriptLoader.emplace(*m_appRuntime);
+
+        MarkStartup(&StartupMarks::appRuntimeCreated);
     }
 
     RuntimeImpl::~RuntimeImpl()
@@ -131,17 +221,25 @@ namespace Babylon::Embedding
 
         // Teardown order:
         //   1. SaveShaderCache: ~ViewImpl already ran ViewImpl::Suspend, so
-        //      the engine is quiescent and a host-thread Save is race-free.
+        //      the engine is quiescent; syncs the journal tail.
         //   2. ~ScriptLoader before ~AppRuntime (dispatcher captures it).
         //   3. Canvas / NativeInput / NativeXr hold JS-thread-bound state;
         //      drop them before joining the JS thread.
         //   4. ~AppRuntime joins the JS thread.
-        //   5. ShaderCache::Disable balances first-attach Enable.
+        //   5. ReleaseShaderCache balances first-attach AcquireShaderCache.
         //   6. Device + DeviceUpdate last (JS thread referenced them).
         //
         // m_initTcs: if complete() was never called (no View ever attached),
         // queued continuations are dropped on destruction, which is correct.
+        //
+        // Prewarm workers reference this object; let them finish first. The
+        // cache they filled is then saved like any other.
 #if BABYLON_NATIVE_PLUGIN_SHADERCACHE
+        if (m_prewarm.valid())
+        {
+            m_prewarm.wait();
+        }
+
         SaveShaderCache();
 #endif
 
@@ -162,9 +260,9 @@ namespace Babylon::Embedding
         m_appRuntime.reset();
 
 #if BABYLON_NATIVE_PLUGIN_SHADERCACHE
-        if (m_device)
+        if (m_shaderCacheAcquired)
         {
-            Babylon::Plugins::ShaderCache::Disable();
+            ReleaseShaderCache();
         }
 #endif
 
@@ -180,14 +278,26 @@ namespace Babylon::Embedding
     void RuntimeImpl::RunFirstAttachInit(Babylon::Graphics::WindowT window)
     {
 #if BABYLON_NATIVE_PLUGIN_SHADERCACHE
-        // Enable + hydrate before any JS-thread shader compilation. Both
-        // calls are host-thread safe since NativeEngine hasn't been
-        // initialized yet.
-        Babylon::Plugins::ShaderCache::Enable();
-        LoadShaderCache();
+        // Enable + hydrate before any JS-thread shader compilation. The
+        // cache is internally locked, so hydrating it while another Runtime
+        // is compiling is safe. If Prewarm already started this, just wait
+        // for it (rethrowing a failed load, as the synchronous path would).
+        if (m_prewarm.valid())
+        {
+            m_prewarm.get();
+        }
+        else
+        {
+            AcquireShaderCache();
+            m_shaderCacheAcquired = true;
+            LoadShaderCache();
+        }
 #endif
+        MarkStartup(&StartupMarks::shaderCacheReady);
 
         m_appRuntime->Dispatch([implPtr = this, window](Napi::Env env) {
+            implPtr->MarkStartup(&StartupMarks::pluginsInitStarted);
+
             // 0. Install the ES2020 `globalThis` self-reference. V8/JSC/Chakra
             //    provide it intrinsically, but the embedded Hermes runtime does
             //    not, and Hermes evaluates eval()'d code as indirect (global
@@ -317,11 +427,14 @@ namespace Babylon::Embedding
 #endif
 
             // 4. Fire any host calls queued before the first View attach.
+            implPtr->MarkStartup(&StartupMarks::pluginsInitialized);
             implPtr->m_initTcs.complete();
         });
     }
 
-    // Persistent shader cache (no-ops when shaderCachePath is empty).
+    // Persistent shader cache (no-ops when shaderCachePath is empty). The
+    // file is an append-only journal: shaders are written in the background
+    // as they are compiled, so "saving" only has to sync the tail.
 #if BABYLON_NATIVE_PLUGIN_SHADERCACHE
     void RuntimeImpl::LoadShaderCache()
     {
@@ -329,12 +442,10 @@ namespace Babylon::Embedding
         {
             return;
         }
-        std::ifstream stream{m_options.shaderCachePath, std::ios::binary};
-        if (stream.good())
-        {
-            Babylon::Plugins::ShaderCache::Load(stream);
-        }
-        // Missing/unreadable file: start with an empty cache.
+        // Missing file: starts an empty journal. Unreadable or torn
+        // records: dropped. Another Runtime's journal already open: shared if
+        // it is the same file, an error if it is not.
+        Babylon::Plugins::ShaderCache::OpenJournal(m_options.shaderCachePath);
     }
 
     void RuntimeImpl::SaveShaderCache()
@@ -343,13 +454,123 @@ namespace Babylon::Embedding
         {
             return;
         }
-        std::ofstream stream{m_options.shaderCachePath, std::ios::binary};
-        if (stream.good())
+        Babylon::Plugins::ShaderCache::FlushJournal();
+    }
+
+    // Hydrates the cache, then fans the shader compiles out across the
+    // thread pool. The cache is internally locked, so workers add to it
+    // concurrently.
+    std::future<void> RuntimeImpl::StartPrewarm(std::vector<PrewarmShader> shaders)
+    {
+        MarkStartup(&StartupMarks::prewarmStarted);
+
+        auto state = std::make_shared<PrewarmState>(std::move(shaders));
+        auto future = state->done.get_future();
+
+        const auto finish = [this](PrewarmState& prewarm) {
+            {
+                std::scoped_lock lock{m_startupMutex};
+                m_startupMarks.prewarmCompleted = Clock::now();
+                m_prewarmedShaders = prewarm.compiled.load();
+            }
+            // Last touch of `this`: ~RuntimeImpl may proceed once set.
+            prewarm.done.set_value();
+        };
+
+        arcana::make_task(arcana::threadpool_scheduler, arcana::cancellation::none(), [this, state, finish] {
+            try
+            {
+                LoadShaderCache();
+            }
+            catch (...)
+            {
+                state->done.set_exception(std::current_exception());
+                return;
+            }
+
+            if (state->shaders.empty())
+            {
+                finish(*state);
+                return;
+            }
+
+            for (size_t index = 0; index < state->shaders.size(); ++index)
+            {
+                arcana::make_task(arcana::threadpool_scheduler, arcana::cancellation::none(), [state, index, finish] {
+                    if (CompileIntoShaderCache(state->shaders[index]))
+                    {
+                        ++state->compiled;
+                    }
+
+                    if (--state->remaining == 0)
+                    {
+                        finish(*state);
+                    }
+                });
+            }
+        });
+
+        return future;
+    }
+#endif
+
+    void RuntimeImpl::MarkStartup(Clock::time_point StartupMarks::*mark)
+    {
+        std::scoped_lock lock{m_startupMutex};
+        m_startupMarks.*mark = Clock::now();
+    }
+
+    bool RuntimeImpl::BeginStartupScript()
+    {
+        if (m_startupTimelineReady.load(std::memory_order_acquire))
         {
-            Babylon::Plugins::ShaderCache::Save(stream);
+            return false;
         }
+
+        std::scoped_lock lock{m_startupMutex};
+        ++m_pendingStartupScripts;
+        return true;
+    }
+
+    void RuntimeImpl::EndStartupScript()
+    {
+        m_scriptLoader->Dispatch([this](Napi::Env) {
+            std::scoped_lock lock{m_startupMutex};
+            m_startupMarks.scriptsLoaded = Clock::now();
+            --m_pendingStartupScripts;
+        });
+    }
+
+    void RuntimeImpl::TryCompleteStartupTimeline()
+    {
+        std::scoped_lock lock{m_startupMutex};
+        if (m_startupTimeline || m_pendingStartupScripts > 0 || m_startupMarks.pluginsInitialized == Clock::time_point{})
+        {
+            return;
+        }
+
+        const auto now = Clock::now();
+        const auto& marks = m_startupMarks;
+        const auto scriptsLoaded = std::max(marks.scriptsLoaded, marks.pluginsInitialized);
+
+        StartupTimeline timeline{};
+        timeline.appRuntime = Elapsed(marks.constructed, marks.appRuntimeCreated);
+        timeline.untilFirstAttach = Elapsed(marks.constructed, marks.attachStarted);
+        timeline.device = Elapsed(marks.attachStarted, marks.deviceCreated);
+        timeline.shaderCache = Elapsed(marks.deviceCreated, marks.shaderCacheReady);
+        timeline.pluginInitialization = Elapsed(marks.pluginsInitStarted, marks.pluginsInitialized);
+        timeline.scriptLoading = Elapsed(marks.pluginsInitialized, scriptsLoaded);
+        timeline.firstFrame = Elapsed(scriptsLoaded, now);
+        timeline.timeToFirstFrame = Elapsed(marks.constructed, now);
+        if (marks.prewarmStarted != Clock::time_point{})
+        {
+            timeline.prewarm = Elapsed(marks.prewarmStarted, marks.prewarmCompleted);
+            timeline.prewarmedShaders = m_prewarmedShaders;
+        }
+
+        m_startupTimeline = timeline;
+        m_startupTimelineReady.store(true, std::memory_order_release);
     }
-#endif
 
     Runtime::Runtime(RuntimeOptions options)
         : m_impl{std::make_unique<RuntimeImpl>(std::move(options))}
@@ -363,18 +584,27 @@ namespace Babylon::Embedding
     void Runtime::LoadScript(std::string_view url)
     {
         m_impl->m_initTcs.as_task().then(arcana::inline_scheduler, arcana::cancellation::none(),
-            [scriptLoader = &*m_impl->m_scriptLoader, url = std::string{url}]() mutable {
-                scriptLoader->LoadScript(std::move(url));
+            [implPtr = m_impl.get(), url = std::string{url}, trackStartup = m_impl->BeginStartupScript()]() mutable {
+                implPtr->m_scriptLoader->LoadScript(std::move(url));
+                if (trackStartup)
+                {
+                    implPtr->EndStartupScript();
+                }
             });
     }
 
     void Runtime::Eval(std::string_view source, std::string_view sourceUrl)
     {
         m_impl->m_initTcs.as_task().then(arcana::inline_scheduler, arcana::cancellation::none(),
-            [scriptLoader = &*m_impl->m_scriptLoader,
+            [implPtr = m_impl.get(),
              source = std::string{source},
-             url = std::string{sourceUrl}]() mutable {
-                scriptLoader->Eval(std::move(source), std::move(url));
+             url = std::string{sourceUrl},
+             trackStartup = m_impl->BeginStartupScript()]() mutable {
+                implPtr->m_scriptLoader->Eval(std::move(source), std::move(url));
+                if (trackStartup)
+                {
+                    implPtr->EndStartupScript();
+                }
             });
     }
 
@@ -418,8 +648,8 @@ namespace Babylon::Embedding
             }
 #if BABYLON_NATIVE_PLUGIN_SHADERCACHE
             // Engine is quiescent here (ViewImpl::Suspend just closed the
-            // frame and locked the update safe-timespan), so the save is
-            // race-free with any pending shader compilation.
+            // frame and locked the update safe-timespan). Shaders were
+            // journaled as they compiled, so this only syncs the tail.
             m_impl->SaveShaderCache();
 #endif
             m_impl->m_appRuntime->Suspend();
@@ -452,6 +682,36 @@ namespace Babylon::Embedding
         return m_impl->m_suspendCount.load(std::memory_order_relaxed) > 0;
     }
 
+    std::optional<StartupTimeline> Runtime::GetStartupTimeline() const
+    {
+        std::scoped_lock lock{m_impl->m_startupMutex};
+        return m_impl->m_startupTimeline;
+    }
+
+#if BABYLON_NATIVE_PLUGIN_SHADERCACHE
+    void Runtime::Prewarm(std::vector<PrewarmShader> shaders)
+    {
+        if (m_impl->m_device)
+        {
+            throw std::runtime_error{"Runtime::Prewarm must be called before the first View is attached."};
+        }
+        if (m_impl->m_prewarm.valid())
+        {
+            throw std::runtime_error{"Runtime::Prewarm may only be called once."};
+        }
+#if !BABYLON_NATIVE_EMBEDDING_COMPILE_SHADERS
+        if (!shaders.empty())
+        {
+            throw std::runtime_error{"Runtime::Prewarm was given shader sources, but this build has no shader compiler."};
+        }
+#endif
+
+        AcquireShaderCache();
+        m_impl->m_shaderCacheAcquired = true;
+        m_impl->m_prewarm = m_impl->StartPrewarm(std::move(shaders));
+    }
+#endif
+
 #if BABYLON_NATIVE_PLUGIN_NATIVEXR
     void Runtime::SetXrWindow(void* nativeWindow)
     {
@@ -22,9 +22,12 @@
 #include <arcana/threading/task.h>
 
 #include <atomic>
+#include <chrono>
+#include <future>
 #include <mutex>
 #include <optional>
 #include <utility>
+#include <vector>
 
 namespace Babylon::Embedding
 {
@@ -88,6 +91,49 @@ namespace Babylon::Embedding
         // thread; atomic so `IsSuspended()` can be polled from any thread.
         std::atomic<int> m_suspendCount{0};
 
+        // ----- Startup instrumentation -----
+        //
+        // Timestamps are written from the host, JS and prewarm threads, so
+        // every field below is guarded by m_startupMutex.
+        // m_startupTimeline is filled in exactly once, by the first
+        // RenderFrame that runs with init complete and no startup scripts
+        // pending; m_startupTimelineReady lets RenderFrame skip the lock
+        // from then on.
+        using Clock = std::chrono::steady_clock;
+
+        struct StartupMarks
+        {
+            Clock::time_point constructed;
+            Clock::time_point appRuntimeCreated;
+            Clock::time_point attachStarted;
+            Clock::time_point deviceCreated;
+            Clock::time_point shaderCacheReady;
+            Clock::time_point pluginsInitStarted;
+            Clock::time_point pluginsInitialized;
+            Clock::time_point scriptsLoaded;
+            Clock::time_point prewarmStarted;
+            Clock::time_point prewarmCompleted;
+        };
+
+        mutable std::mutex m_startupMutex;
+        StartupMarks m_startupMarks;
+        uint32_t m_pendingStartupScripts{0};
+        uint32_t m_prewarmedShaders{0};
+        std::optional<StartupTimeline> m_startupTimeline;
+        std::atomic<bool> m_startupTimelineReady{false};
+
+        void MarkStartup(Clock::time_point StartupMarks::*mark);
+
+        // LoadScript / Eval bracket each script queued before the first
+        // frame: Begin on the host thread (returns false once the timeline
+        // is complete), End right after the script is handed to the
+        // ScriptLoader, which queues a marker that runs once it executed.
+        bool BeginStartupScript();
+        void EndStartupScript();
+
+        // Called by View::RenderFrame after FinishRenderingCurrentFrame.
+        void TryCompleteStartupTimeline();
+
         // 0..1 — enforces "at most one View attached at a time". Points
         // at the ViewImpl directly (not the outer View), so the back-ref
         // stays valid across moves of the outer View.
@@ -101,12 +147,23 @@ namespace Babylon::Embedding
 
 #if BABYLON_NATIVE_PLUGIN_SHADERCACHE
         // Persistent shader cache. No-ops when `m_options.shaderCachePath`
-        // is empty. Both run synchronously on the host thread at points
-        // where the engine is known not to be compiling shaders
-        // (first-attach, post-view-Suspend, ~RuntimeImpl) — no JS-thread
-        // coordination required.
+        // is empty. Load opens the cache journal (on the host thread at
+        // first attach, or on a Prewarm worker); from then on new shaders
+        // are appended in the background. Save only waits for those appends
+        // to reach disk (post-view-Suspend, ~RuntimeImpl).
         void LoadShaderCache();
         void SaveShaderCache();
+
+        // Set by whichever of Prewarm / first attach enabled the
+        // process-wide cache for this Runtime; balanced in ~RuntimeImpl.
+        bool m_shaderCacheAcquired{false};
+
+        // Pending Runtime::Prewarm work. Waited on (and any load error
+        // rethrown) by the first attach; waited on by ~RuntimeImpl if no
+        // View ever attached, since the workers reference this object.
+        std::future<void> m_prewarm;
+
+        std::future<void> StartPrewarm(std::vector<PrewarmShader> shaders);
 #endif
     };
 
@@ -120,6 +120,8 @@ namespace Babylon::Embedding
         const bool firstAttachEver = !m_runtime.m_device;
         if (firstAttachEver)
         {
+            m_runtime.MarkStartup(&RuntimeImpl::StartupMarks::attachStarted);
+
             Babylon::Graphics::Configuration config{};
             config.Window = m_window;
             config.Width = lw;
@@ -146,6 +148,7 @@ namespace Babylon::Embedding
 
         if (firstAttachEver)
         {
+            m_runtime.MarkStartup(&RuntimeImpl::StartupMarks::deviceCreated);
             m_runtime.RunFirstAttachInit(m_window);
         }
     }
@@ -172,6 +175,10 @@ namespace Babylon::Embedding
         // Babylon's JS render loop runs between Start and Finish, scheduled
         // via DeviceUpdate's SafeTimespanGuarantor onto the JS thread.
         impl.m_device->FinishRenderingCurrentFrame();
+        if (!impl.m_startupTimelineReady.load(std::memory_order_acquire))
+        {
+            impl.TryCompleteStartupTimeline();
+        }
         impl.m_device->StartRenderingCurrentFrame();
     }
 
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace draco
+{
+    class PointAttribute;
+    class PointCloud;
+}
+
+namespace Babylon::Plugins::NativeDraco::Decoding
+{
+    // The JavaScript-free part of DracoCodec: decoding a buffer into plain arrays, which
+    // DecodeAsync runs on the thread pool and the JavaScript objects are built from.
+
+    // A decoded vertex attribute, its values tightly packed in point order as emscripten's
+    // GetAttributeDataArrayForAllPoints returns them.
+    struct Attribute
+    {
+        std::string Kind{};
+        // The draco::DataType of the values.
+        int DataType{};
+        uint32_t Size{};
+        uint32_t BytesPerComponent{};
+        bool Normalized{};
+        std::vector<std::byte> Data{};
+    };
+
+    struct Mesh
+    {
+        // False for a point cloud.
+        bool HasIndices{};
+        std::vector<uint32_t> Indices{};
+        std::vector<Attribute> Attributes{};
+        uint32_t TotalVertices{};
+    };
+
+    // The Babylon vertex buffer kind and Draco unique id of each attribute to decode.
+    using AttributeIds = std::vector<std::pair<std::string, uint32_t>>;
+
+    // Decodes a Draco mesh or point cloud, with the attributes of `attributeIds` that it has, or
+    // its standard named attributes if `attributeIds` is null. Throws std::runtime_error if the
+    // data cannot be decoded. Safe to call from any thread.
+    Mesh Decode(const void* data, size_t size, const AttributeIds* attributeIds);
+
+    // Copies the values of every point of `attribute` into `output`, which must hold
+    // num_points * num_components values of the attribute's type. Attributes whose values are
+    // stored in point order, the common case, are copied with a single memcpy.
+    void CopyAttributeData(const draco::PointCloud& pointCloud, const draco::PointAttribute& attribute, std::byte* output);
+}
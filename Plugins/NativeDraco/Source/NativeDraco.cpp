@@ -1,20 +1,19 @@
 #include <Babylon/Plugins/NativeDraco.h>
+#include <Babylon/Plugins/NativeDracoInternal.h>
+#include <Babylon/AsyncWork.h>
 #include <Babylon/JsRuntime.h>
 
 #include <napi/napi.h>
 
-#include <draco/compression/decode.h>
-#include <draco/core/decoder_buffer.h>
-#include <draco/mesh/mesh.h>
-#include <draco/point_cloud/point_cloud.h>
-#include <draco/attributes/geometry_attribute.h>
-#include <draco/attributes/point_attribute.h>
+#include <draco/core/draco_types.h>
 #include <draco/core/draco_version.h>
 
+#include <arcana/threading/task.h>
+#include <arcana/threading/task_schedulers.h>
+
 #include <cstdint>
-#include <cstring>
-#include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -22,6 +21,8 @@ namespace Babylon::Plugins
 {
     namespace
     {
+        namespace Decoding = NativeDraco::Decoding;
+
         // Enumerates an object's own keys.
         //
         // Deliberately not Napi::Object::GetPropertyNames(). JsRuntimeHost's JavaScriptCore
@@ -48,177 +49,164 @@ namespace Babylon::Plugins
             return keys.Call(objectCtor, {object}).As<Napi::Array>();
         }
 
-        // De-interleaves and tightly packs one Draco attribute's per-point values into a
-        // freshly allocated JS typed array of type T. This mirrors emscripten's
-        // GetAttributeDataArrayForAllPoints, which Babylon's WASM decoder relies on.
+        // Hands `data` to JavaScript without a copy, as the backing store of an ArrayBuffer that
+        // frees it once collected.
         template<typename T>
-        Napi::Value CopyAttributeData(Napi::Env env, const draco::PointCloud& pointCloud, const draco::PointAttribute& attribute)
+        Napi::ArrayBuffer NewExternalArrayBuffer(Napi::Env env, std::vector<T>&& data)
         {
-            const int8_t numComponents = attribute.num_components();
-            const uint32_t numPoints = pointCloud.num_points();
-            const size_t numValues = static_cast<size_t>(numPoints) * numComponents;
-
-            auto array = Napi::TypedArrayOf<T>::New(env, numValues);
-            T* out = array.Data();
-
-            for (draco::PointIndex i(0); i < numPoints; ++i)
+            if (data.empty())
             {
-                const draco::AttributeValueIndex valueIndex = attribute.mapped_index(i);
-                attribute.ConvertValue<T>(valueIndex, numComponents, out + static_cast<size_t>(i.value()) * numComponents);
+                return Napi::ArrayBuffer::New(env, 0);
             }
 
-            return array;
+            auto owner{std::make_shared<std::vector<T>>(std::move(data))};
+            return Napi::ArrayBuffer::New(env, owner->data(), owner->size() * sizeof(T), [owner](Napi::Env, void*) {});
+        }
+
+        template<typename T>
+        Napi::Value NewAttributeArray(Napi::Env env, Decoding::Attribute& attribute)
+        {
+            const size_t length = attribute.Data.size() / sizeof(T);
+            return Napi::TypedArrayOf<T>::New(env, length, NewExternalArrayBuffer(env, std::move(attribute.Data)), 0);
         }
 
         // Builds the { kind, data, size, byteOffset, byteStride, normalized } record that
         // Babylon's DracoDecoder consumes for each decoded vertex attribute.
-        Napi::Value DecodeAttribute(Napi::Env env, const draco::PointCloud& pointCloud, const draco::PointAttribute& attribute, const std::string& kind)
+        Napi::Value ToJavaScript(Napi::Env env, Decoding::Attribute& attribute)
         {
-            const int8_t numComponents = attribute.num_components();
-
             Napi::Value data;
-            uint32_t bytesPerComponent = 0;
-            switch (attribute.data_type())
+            switch (attribute.DataType)
             {
-                case draco::DT_FLOAT32: data = CopyAttributeData<float>(env, pointCloud, attribute); bytesPerComponent = 4; break;
-                case draco::DT_INT8: data = CopyAttributeData<int8_t>(env, pointCloud, attribute); bytesPerComponent = 1; break;
-                case draco::DT_UINT8: data = CopyAttributeData<uint8_t>(env, pointCloud, attribute); bytesPerComponent = 1; break;
-                case draco::DT_INT16: data = CopyAttributeData<int16_t>(env, pointCloud, attribute); bytesPerComponent = 2; break;
-                case draco::DT_UINT16: data = CopyAttributeData<uint16_t>(env, pointCloud, attribute); bytesPerComponent = 2; break;
-                case draco::DT_INT32: data = CopyAttributeData<int32_t>(env, pointCloud, attribute); bytesPerComponent = 4; break;
-                case draco::DT_UINT32: data = CopyAttributeData<uint32_t>(env, pointCloud, attribute); bytesPerComponent = 4; break;
+                case draco::DT_FLOAT32: data = NewAttributeArray<float>(env, attribute); break;
+                case draco::DT_INT8: data = NewAttributeArray<int8_t>(env, attribute); break;
+                case draco::DT_UINT8: data = NewAttributeArray<uint8_t>(env, attribute); break;
+                case draco::DT_INT16: data = NewAttributeArray<int16_t>(env, attribute); break;
+                case draco::DT_UINT16: data = NewAttributeArray<uint16_t>(env, attribute); break;
+                case draco::DT_INT32: data = NewAttributeArray<int32_t>(env, attribute); break;
+                case draco::DT_UINT32: data = NewAttributeArray<uint32_t>(env, attribute); break;
                 default:
-                    throw Napi::Error::New(env, "Draco: Cannot decode invalid attribute data type " + std::to_string(attribute.data_type()));
+                    throw Napi::Error::New(env, "Draco: Cannot decode invalid attribute data type " + std::to_string(attribute.DataType));
             }
 
             auto result = Napi::Object::New(env);
-            result.Set("kind", Napi::String::New(env, kind));
+            result.Set("kind", Napi::String::New(env, attribute.Kind));
             result.Set("data", data);
-            result.Set("size", Napi::Number::New(env, numComponents));
+            result.Set("size", Napi::Number::New(env, attribute.Size));
             // GetAttributeDataArrayForAllPoints returns a tightly packed array, so the
             // consumable buffer has offset 0 and a stride of one full vertex.
             result.Set("byteOffset", Napi::Number::New(env, 0));
-            result.Set("byteStride", Napi::Number::New(env, static_cast<double>(numComponents) * bytesPerComponent));
-            result.Set("normalized", Napi::Boolean::New(env, attribute.normalized()));
+            result.Set("byteStride", Napi::Number::New(env, static_cast<double>(attribute.Size) * attribute.BytesPerComponent));
+            result.Set("normalized", Napi::Boolean::New(env, attribute.Normalized));
             return result;
         }
 
-        Napi::Value DecodeDracoMesh(const Napi::CallbackInfo& info)
+        // Moves the arrays of `mesh` into the result object of Decode.
+        Napi::Value ToJavaScript(Napi::Env env, Decoding::Mesh& mesh)
         {
-            auto env = info.Env();
-
-            if (info.Length() < 1 || !info[0].IsTypedArray())
+            Napi::Value indices = env.Null();
+            if (mesh.HasIndices)
             {
-                throw Napi::TypeError::New(env, "decodeDracoMesh: expected a typed array of compressed Draco data");
+                const size_t length = mesh.Indices.size();
+                indices = Napi::Uint32Array::New(env, length, NewExternalArrayBuffer(env, std::move(mesh.Indices)), 0);
             }
 
-            const auto typedArray = info[0].As<Napi::TypedArray>();
-            const auto* data = static_cast<const char*>(typedArray.ArrayBuffer().Data()) + typedArray.ByteOffset();
-            const size_t size = typedArray.ByteLength();
-
-            draco::DecoderBuffer buffer;
-            buffer.Init(data, size);
-
-            draco::Decoder decoder;
-            const auto geometryTypeStatus = draco::Decoder::GetEncodedGeometryType(&buffer);
-            if (!geometryTypeStatus.ok())
+            auto attributes = Napi::Array::New(env, mesh.Attributes.size());
+            for (uint32_t i = 0; i < mesh.Attributes.size(); ++i)
             {
-                throw Napi::Error::New(env, geometryTypeStatus.status().error_msg());
+                attributes.Set(i, ToJavaScript(env, mesh.Attributes[i]));
             }
 
-            std::unique_ptr<draco::PointCloud> geometry;
-            Napi::Value indices = env.Null();
-
-            switch (geometryTypeStatus.value())
-            {
-                case draco::TRIANGULAR_MESH:
-                {
-                    auto meshStatus = decoder.DecodeMeshFromBuffer(&buffer);
-                    if (!meshStatus.ok())
-                    {
-                        throw Napi::Error::New(env, meshStatus.status().error_msg());
-                    }
+            auto result = Napi::Object::New(env);
+            result.Set("indices", indices);
+            result.Set("attributes", attributes);
+            result.Set("totalVertices", Napi::Number::New(env, static_cast<double>(mesh.TotalVertices)));
+            return result;
+        }
 
-                    std::unique_ptr<draco::Mesh> mesh = std::move(meshStatus).value();
+        // The compressed data of a Decode call, and its attribute id map if it has one.
+        struct DecodeArguments
+        {
+            const std::byte* Data{};
+            size_t Size{};
+            std::optional<Decoding::AttributeIds> AttributeIds{};
+        };
 
-                    const uint32_t numFaces = mesh->num_faces();
-                    auto indicesArray = Napi::Uint32Array::New(env, static_cast<size_t>(numFaces) * 3);
-                    uint32_t* out = indicesArray.Data();
-                    for (uint32_t f = 0; f < numFaces; ++f)
-                    {
-                        const draco::Mesh::Face& face = mesh->face(draco::FaceIndex(f));
-                        out[f * 3 + 0] = face[0].value();
-                        out[f * 3 + 1] = face[1].value();
-                        out[f * 3 + 2] = face[2].value();
-                    }
-                    indices = indicesArray;
+        DecodeArguments ReadDecodeArguments(const Napi::CallbackInfo& info, const char* function)
+        {
+            auto env = info.Env();
 
-                    geometry = std::move(mesh);
-                    break;
-                }
-                case draco::POINT_CLOUD:
-                {
-                    auto pointCloudStatus = decoder.DecodePointCloudFromBuffer(&buffer);
-                    if (!pointCloudStatus.ok())
-                    {
-                        throw Napi::Error::New(env, pointCloudStatus.status().error_msg());
-                    }
-                    geometry = std::move(pointCloudStatus).value();
-                    break;
-                }
-                default:
-                    throw Napi::Error::New(env, "Draco: Cannot decode invalid geometry type");
+            if (info.Length() < 1 || !info[0].IsTypedArray())
+            {
+                throw Napi::TypeError::New(env, std::string{function} + ": expected a typed array of compressed Draco data");
             }
 
-            auto attributes = Napi::Array::New(env);
-            uint32_t attributeCount = 0;
+            const auto typedArray = info[0].As<Napi::TypedArray>();
+            DecodeArguments arguments{};
+            arguments.Data = static_cast<const std::byte*>(typedArray.ArrayBuffer().Data()) + typedArray.ByteOffset();
+            arguments.Size = typedArray.ByteLength();
 
             if (info.Length() > 1 && info[1].IsObject())
             {
                 // glTF path: caller provides a map of Babylon vertex-buffer kind -> Draco unique id.
                 const auto attributeIds = info[1].As<Napi::Object>();
                 const auto keys = OwnPropertyNames(env, attributeIds);
+                arguments.AttributeIds.emplace();
                 for (uint32_t i = 0; i < keys.Length(); ++i)
                 {
-                    const auto kind = keys.Get(i).As<Napi::String>().Utf8Value();
+                    auto kind = keys.Get(i).As<Napi::String>().Utf8Value();
                     const uint32_t id = attributeIds.Get(kind).As<Napi::Number>().Uint32Value();
-                    const draco::PointAttribute* attribute = geometry->GetAttributeByUniqueId(id);
-                    if (attribute != nullptr)
-                    {
-                        attributes.Set(attributeCount++, DecodeAttribute(env, *geometry, *attribute, kind));
-                    }
+                    arguments.AttributeIds->emplace_back(std::move(kind), id);
                 }
             }
-            else
+
+            return arguments;
+        }
+
+        Napi::Value DecodeDracoMesh(const Napi::CallbackInfo& info)
+        {
+            auto env = info.Env();
+            const auto arguments = ReadDecodeArguments(info, "decodeDracoMesh");
+
+            Decoding::Mesh mesh;
+            try
             {
-                // Standalone path: probe the standard named attributes.
-                const struct
-                {
-                    const char* kind;
-                    draco::GeometryAttribute::Type type;
-                } namedAttributes[] = {
-                    {"position", draco::GeometryAttribute::POSITION},
-                    {"normal", draco::GeometryAttribute::NORMAL},
-                    {"color", draco::GeometryAttribute::COLOR},
-                    {"uv", draco::GeometryAttribute::TEX_COORD},
-                };
-
-                for (const auto& named : namedAttributes)
-                {
-                    if (geometry->GetNamedAttributeId(named.type) != -1)
-                    {
-                        attributes.Set(attributeCount++, DecodeAttribute(env, *geometry, *geometry->GetNamedAttribute(named.type), named.kind));
-                    }
-                }
+                mesh = Decoding::Decode(arguments.Data, arguments.Size, arguments.AttributeIds ? &*arguments.AttributeIds : nullptr);
+            }
+            catch (const std::exception& exception)
+            {
+                throw Napi::Error::New(env, exception.what());
             }
 
-            auto result = Napi::Object::New(env);
-            result.Set("indices", indices);
-            result.Set("attributes", attributes);
-            result.Set("totalVertices", Napi::Number::New(env, static_cast<double>(geometry->num_points())));
-            return result;
+            return ToJavaScript(env, mesh);
         }
 
+        // Decodes as Decode on the thread pool, and returns a promise of its result. The
+        // compressed data is copied, so the caller may reuse its buffer right away. The promise
+        // never settles if the environment is torn down first.
+        Napi::Value DecodeDracoMeshAsync(const Napi::CallbackInfo& info)
+        {
+            auto env = info.Env();
+            auto arguments = ReadDecodeArguments(info, "decodeDracoMeshAsync");
+
+            auto deferred{Napi::Promise::Deferred::New(env)};
+
+            auto& asyncWork{AsyncWork::GetFromJavaScript(env)};
+            asyncWork.Then(asyncWork.Run(
+                [data = std::vector<std::byte>(arguments.Data, arguments.Data + arguments.Size), attributeIds = std::move(arguments.AttributeIds)](const arcana::cancellation&) {
+                    return std::make_shared<Decoding::Mesh>(Decoding::Decode(data.data(), data.size(), attributeIds ? &*attributeIds : nullptr));
+                }),
+                [deferred, env](const arcana::expected<std::shared_ptr<Decoding::Mesh>, std::exception_ptr>& result) {
+                    if (result.has_error())
+                    {
+                        deferred.Reject(Napi::Error::New(env, result.error()).Value());
+                        return;
+                    }
+
+                    deferred.Resolve(ToJavaScript(env, *result.value()));
+                });
+
+            return deferred.Promise();
+        }
     }
 }
 
@@ -226,6 +214,8 @@ namespace Babylon::Plugins::NativeDraco
 {
     void BABYLON_API Initialize(Napi::Env env)
     {
+        AsyncWork::CreateForJavaScript(env);
+
         auto native{JsRuntime::NativeObject::GetFromJavaScript(env)};
 
         // Exposed as a single object rather than free functions so that the JavaScript side
@@ -240,6 +230,7 @@ namespace Babylon::Plugins::NativeDraco
         // authoring path that Babylon Native does not exercise.
         auto codec = Napi::Object::New(env);
         codec.Set("Decode", Napi::Function::New(env, DecodeDracoMesh, "Decode"));
+        codec.Set("DecodeAsync", Napi::Function::New(env, DecodeDracoMeshAsync, "DecodeAsync"));
         codec.Set("Version", Napi::String::New(env, draco::kDracoVersion));
         native.Set("DracoCodec", codec);
     }
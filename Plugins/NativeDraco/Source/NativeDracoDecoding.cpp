@@ -0,0 +1,168 @@
+#include <Babylon/Plugins/NativeDracoInternal.h>
+
+#include <draco/compression/decode.h>
+#include <draco/core/decoder_buffer.h>
+#include <draco/core/draco_types.h>
+#include <draco/mesh/mesh.h>
+#include <draco/point_cloud/point_cloud.h>
+#include <draco/attributes/geometry_attribute.h>
+#include <draco/attributes/point_attribute.h>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+    using Babylon::Plugins::NativeDraco::Decoding::Attribute;
+
+    // Builds the record Babylon's DracoDecoder consumes for each decoded vertex attribute.
+    Attribute DecodeAttribute(const draco::PointCloud& pointCloud, const draco::PointAttribute& attribute, const std::string& kind)
+    {
+        switch (attribute.data_type())
+        {
+            case draco::DT_FLOAT32:
+            case draco::DT_INT8:
+            case draco::DT_UINT8:
+            case draco::DT_INT16:
+            case draco::DT_UINT16:
+            case draco::DT_INT32:
+            case draco::DT_UINT32:
+                break;
+            default:
+                throw std::runtime_error("Draco: Cannot decode invalid attribute data type " + std::to_string(attribute.data_type()));
+        }
+
+        Attribute result{};
+        result.Kind = kind;
+        result.DataType = attribute.data_type();
+        result.Size = attribute.num_components();
+        result.BytesPerComponent = static_cast<uint32_t>(draco::DataTypeLength(attribute.data_type()));
+        result.Normalized = attribute.normalized();
+        result.Data.resize(static_cast<size_t>(pointCloud.num_points()) * result.Size * result.BytesPerComponent);
+        Babylon::Plugins::NativeDraco::Decoding::CopyAttributeData(pointCloud, attribute, result.Data.data());
+        return result;
+    }
+}
+
+namespace Babylon::Plugins::NativeDraco::Decoding
+{
+    Mesh Decode(const void* data, size_t size, const AttributeIds* attributeIds)
+    {
+        draco::DecoderBuffer buffer;
+        buffer.Init(static_cast<const char*>(data), size);
+
+        draco::Decoder decoder;
+        const auto geometryTypeStatus = draco::Decoder::GetEncodedGeometryType(&buffer);
+        if (!geometryTypeStatus.ok())
+        {
+            throw std::runtime_error(geometryTypeStatus.status().error_msg());
+        }
+
+        Mesh result{};
+        std::unique_ptr<draco::PointCloud> geometry;
+
+        switch (geometryTypeStatus.value())
+        {
+            case draco::TRIANGULAR_MESH:
+            {
+                auto meshStatus = decoder.DecodeMeshFromBuffer(&buffer);
+                if (!meshStatus.ok())
+                {
+                    throw std::runtime_error(meshStatus.status().error_msg());
+                }
+
+                std::unique_ptr<draco::Mesh> mesh = std::move(meshStatus).value();
+
+                const uint32_t numFaces = mesh->num_faces();
+                result.HasIndices = true;
+                result.Indices.resize(static_cast<size_t>(numFaces) * 3);
+                for (uint32_t f = 0; f < numFaces; ++f)
+                {
+                    const draco::Mesh::Face& face = mesh->face(draco::FaceIndex(f));
+                    result.Indices[f * 3 + 0] = face[0].value();
+                    result.Indices[f * 3 + 1] = face[1].value();
+                    result.Indices[f * 3 + 2] = face[2].value();
+                }
+
+                geometry = std::move(mesh);
+                break;
+            }
+            case draco::POINT_CLOUD:
+            {
+                auto pointCloudStatus = decoder.DecodePointCloudFromBuffer(&buffer);
+                if (!pointCloudStatus.ok())
+                {
+                    throw std::runtime_error(pointCloudStatus.status().error_msg());
+                }
+                geometry = std::move(pointCloudStatus).value();
+                break;
+            }
+            default:
+                throw std::runtime_error("Draco: Cannot decode invalid geometry type");
+        }
+
+        if (attributeIds != nullptr)
+        {
+            // glTF path: caller provides a map of Babylon vertex-buffer kind -> Draco unique id.
+            for (const auto& [kind, id] : *attributeIds)
+            {
+                const draco::PointAttribute* attribute = geometry->GetAttributeByUniqueId(id);
+                if (attribute != nullptr)
+                {
+                    result.Attributes.push_back(DecodeAttribute(*geometry, *attribute, kind));
+                }
+            }
+        }
+        else
+        {
+            // Standalone path: probe the standard named attributes.
+            const struct
+            {
+                const char* kind;
+                draco::GeometryAttribute::Type type;
+            } namedAttributes[] = {
+                {"position", draco::GeometryAttribute::POSITION},
+                {"normal", draco::GeometryAttribute::NORMAL},
+                {"color", draco::GeometryAttribute::COLOR},
+                {"uv", draco::GeometryAttribute::TEX_COORD},
+            };
+
+            for (const auto& named : namedAttributes)
+            {
+                if (geometry->GetNamedAttributeId(named.type) != -1)
+                {
+                    result.Attributes.push_back(DecodeAttribute(*geometry, *geometry->GetNamedAttribute(named.type), named.kind));
+                }
+            }
+        }
+
+        result.TotalVertices = geometry->num_points();
+        return result;
+    }
+
+    // De-interleaves and tightly packs one attribute's per-point values, as emscripten's
+    // GetAttributeDataArrayForAllPoints does. The values keep the attribute's own type, so they
+    // are copied as bytes.
+    void CopyAttributeData(const draco::PointCloud& pointCloud, const draco::PointAttribute& attribute, std::byte* output)
+    {
+        const size_t valueSize = static_cast<size_t>(attribute.num_components()) * draco::DataTypeLength(attribute.data_type());
+        const uint32_t numPoints = pointCloud.num_points();
+        if (numPoints == 0)
+        {
+            return;
+        }
+
+        // Point i holds value i, and the values are packed: the buffer already is the output.
+        if (attribute.is_mapping_identity() && attribute.byte_stride() == static_cast<int64_t>(valueSize) && attribute.size() >= numPoints)
+        {
+            std::memcpy(output, attribute.GetAddress(draco::AttributeValueIndex(0)), valueSize * numPoints);
+            return;
+        }
+
+        for (draco::PointIndex i(0); i < numPoints; ++i)
+        {
+            std::memcpy(output + static_cast<size_t>(i.value()) * valueSize, attribute.GetAddress(attribute.mapped_index(i)), valueSize);
+        }
+    }
+}
@@ -3,7 +3,21 @@
 #include <napi/env.h>
 #include <Babylon/Api.h>
 
+#include <cstdint>
+
 namespace Babylon::Plugins::NativeEncoding
 {
+    struct Configuration
+    {
+        // The most encodes that run at a time, each of which still spreads its rows over the
+        // thread pool. 0 means half the hardware threads, and at least one.
+        uint32_t MaxInFlightEncodes{};
+
+        // The most encodes that wait for one of those to finish. EncodeImageAsync rejects the
+        // encodes beyond that.
+        uint32_t MaxQueuedEncodes{1024};
+    };
+
     void BABYLON_API Initialize(Napi::Env env);
+    void BABYLON_API Initialize(Napi::Env env, const Configuration& configuration);
 }
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <arcana/threading/cancellation.h>
+#include <arcana/threading/task.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Babylon::Plugins::NativeEncoding
+{
+    // Rows [FirstRow, FirstRow + RowCount) of an image, top row first.
+    struct RowRange
+    {
+        uint32_t FirstRow{};
+        uint32_t RowCount{};
+    };
+
+    // Runs the encodes of EncodeImageAsync, at most `maxInFlight` at a time and in the order they
+    // were submitted, so that a burst of screenshots does not crowd other work off the thread
+    // pool. Destroying the queue cancels it and waits for the running encodes.
+    class EncodeQueue final
+    {
+    public:
+        struct Timings
+        {
+            // From Submit to the start of the encode, and from there to its end.
+            std::chrono::steady_clock::duration Queued{};
+            std::chrono::steady_clock::duration Encoding{};
+
+            // The encodes running when this one started, itself included.
+            size_t InFlight{};
+        };
+
+        // Running totals, since the queue was created.
+        struct Stats final
+        {
+            uint64_t Submitted{};
+
+            // Submissions refused because `maxQueued` encodes were already waiting.
+            uint64_t Rejected{};
+
+            uint64_t Completed{};
+            uint64_t Failed{};
+
+            // Encodes that never started because the queue was cancelled.
+            uint64_t Cancelled{};
+
+            size_t PeakInFlight{};
+            size_t PeakQueued{};
+        };
+
+        // Starts an encode on the thread pool. Its tasks should be made with the cancellation, so
+        // that the rest of the encode is skipped once the queue is cancelled.
+        using Encode = std::function<arcana::task<void, std::exception_ptr>(arcana::cancellation& cancellation)>;
+
+        EncodeQueue(size_t maxInFlight, size_t maxQueued);
+        ~EncodeQueue();
+
+        EncodeQueue(const EncodeQueue&) = delete;
+        EncodeQueue& operator=(const EncodeQueue&) = delete;
+
+        // Throws std::length_error if `maxQueued` encodes are already waiting. The task completes
+        // with the timings of the encode or its error, or with std::errc::operation_canceled if
+        // the queue is cancelled before the encode starts.
+        arcana::task<Timings, std::exception_ptr> Submit(Encode encode);
+
+        // Cancels the waiting encodes, and the rest of the running ones. Encodes submitted later
+        // are cancelled straight away.
+        void Cancel();
+
+        // Blocks until no encode is running.
+        void Wait();
+
+        // Cancelled by Cancel, for the continuations of the encodes. They capture it, since they
+        // can run after the queue is gone.
+        std::shared_ptr<arcana::cancellation_source> Cancellation();
+
+        Stats GetStats() const;
+
+    private:
+        struct State;
+        std::shared_ptr<State> m_state;
+    };
+}
+
+namespace Babylon::Plugins::NativeEncoding::Png
+{
+    // The JavaScript-free PNG encoder behind EncodeImageAsync, for RGBA8 pixels.
+    //
+    // The rows are split into ranges that are filtered and deflated independently, each into its
+    // own IDAT chunk, so that EncodeImageAsync can encode them on the thread pool. The output only
+    // depends on the pixels and the options, not on how the ranges were scheduled.
+
+    // miniz levels. 0 stores the rows uncompressed, and 1 to 10 search increasingly far for
+    // matches, trading speed for size. Level 1 also only tries one filter per image.
+    constexpr int MIN_COMPRESSION_LEVEL{0};
+    constexpr int MAX_COMPRESSION_LEVEL{10};
+    constexpr int DEFAULT_COMPRESSION_LEVEL{6};
+
+    struct Options
+    {
+        int CompressionLevel{DEFAULT_COMPRESSION_LEVEL};
+        // Writes the last row of pixels first, as for the bottom-up rows of a texture readback.
+        bool FlipY{};
+    };
+
+    // Throw std::invalid_argument for an empty image or a level out of range.
+    void Validate(uint32_t width, uint32_t height, const Options& options);
+
+    // Splits the image into ranges of about 1 MB of filtered rows each.
+    std::vector<RowRange> SplitRows(uint32_t width, uint32_t height);
+
+    struct EncodedRows
+    {
+        // A complete IDAT chunk.
+        std::vector<std::byte> Chunk{};
+        // Adler-32 and size of the filtered rows, which the zlib stream ends with.
+        uint32_t Adler{};
+        size_t FilteredSize{};
+    };
+
+    // Filters and deflates one range of a validated image. Safe to call from any thread.
+    EncodedRows EncodeRows(const std::byte* pixels, uint32_t width, uint32_t height, RowRange rows, const Options& options);
+
+    // The PNG file of all ranges, in the order SplitRows returned them.
+    std::vector<std::byte> Assemble(uint32_t width, uint32_t height, const std::vector<EncodedRows>& ranges);
+
+    // Encodes the whole image on the calling thread. Throws as Validate does.
+    std::vector<std::byte> Encode(const std::byte* pixels, uint32_t width, uint32_t height, const Options& options);
+}
+
+namespace Babylon::Plugins::NativeEncoding::Jpeg
+{
+    // A baseline JPEG encoder for RGBA8 pixels, which are composited onto black as a canvas does.
+    //
+    // Like the PNG encoder it splits the rows into ranges, each of which is a restart interval
+    // that can be encoded concurrently, with the standard Huffman tables.
+
+    // Quality from 1 to 100 scales the standard quantization tables as libjpeg does. From 90 up
+    // the chroma keeps its full resolution, below it is subsampled 2x2.
+    constexpr int MIN_QUALITY{1};
+    constexpr int MAX_QUALITY{100};
+    constexpr int DEFAULT_QUALITY{92};
+
+    struct Options
+    {
+        int Quality{DEFAULT_QUALITY};
+        // Writes the last row of pixels first, as for the bottom-up rows of a texture readback.
+        bool FlipY{};
+    };
+
+    // Throw std::invalid_argument for an image that is empty or larger than 65535 pixels on a
+    // side, or a quality out of range.
+    void Validate(uint32_t width, uint32_t height, const Options& options);
+
+    // Splits the image into ranges of whole blocks of rows, about 1 MB of pixels each.
+    std::vector<RowRange> SplitRows(uint32_t width, uint32_t height, const Options& options);
+
+    // Encodes one range of a validated image into its entropy-coded segment, followed by a
+    // restart marker unless it is the last range. Safe to call from any thread.
+    std::vector<std::byte> EncodeRows(const std::byte* pixels, uint32_t width, uint32_t height, RowRange rows, const Options& options);
+
+    // The JPEG file of all segments, in the order SplitRows returned them.
+    std::vector<std::byte> Assemble(uint32_t width, uint32_t height, const Options& options, const std::vector<std::vector<std::byte>>& segments);
+
+    // Encodes the whole image on the calling thread. Throws as Validate does.
+    std::vector<std::byte> Encode(const std::byte* pixels, uint32_t width, uint32_t height, const Options& options);
+}
+
+namespace Babylon::Plugins::NativeEncoding::WebP
+{
+    // A lossless WebP encoder for RGBA8 pixels, with the subtract green and predictor transforms
+    // and backward references. The bitstream is sequential, so it runs on a single thread.
+
+    struct Options
+    {
+        // Writes the last row of pixels first, as for the bottom-up rows of a texture readback.
+        bool FlipY{};
+    };
+
+    // Throws std::invalid_argument for an image that is empty or larger than 16384 pixels on a
+    // side.
+    void Validate(uint32_t width, uint32_t height);
+
+    // Encodes the whole image on the calling thread, which may be any thread. Throws as Validate
+    // does.
+    std::vector<std::byte> Encode(const std::byte* pixels, uint32_t width, uint32_t height, const Options& options);
+}
@@ -0,0 +1,206 @@
+#include <Babylon/Plugins/NativeEncodingInternal.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace Babylon::Plugins::NativeEncoding
+{
+    namespace
+    {
+        auto CancelledError()
+        {
+            return arcana::make_unexpected(std::make_exception_ptr(std::system_error(std::make_error_code(std::errc::operation_canceled))));
+        }
+    }
+
+    // Shared with the continuations of the running encodes, which can outlive the queue by the
+    // time it takes them to return after Wait.
+    struct EncodeQueue::State : std::enable_shared_from_this<State>
+    {
+        struct Pending
+        {
+            Encode Start{};
+            arcana::task_completion_source<Timings, std::exception_ptr> Completion{};
+            std::chrono::steady_clock::time_point Submitted{};
+        };
+
+        State(size_t maxInFlight, size_t maxQueued)
+            : MaxInFlight{std::max<size_t>(maxInFlight, 1)}
+            , MaxQueued{maxQueued}
+        {
+        }
+
+        // Starts waiting encodes while there is room for them. Only one thread pumps at a time,
+        // so that encodes that complete inline do not recurse into here.
+        void Pump()
+        {
+            {
+                std::scoped_lock lock{Mutex};
+                if (Pumping)
+                {
+                    return;
+                }
+                Pumping = true;
+            }
+
+            while (true)
+            {
+                Pending pending{};
+                size_t inFlight{};
+                {
+                    std::scoped_lock lock{Mutex};
+                    if (Cancelled || Queue.empty() || InFlight >= MaxInFlight)
+                    {
+                        CurrentStats.PeakQueued = std::max(CurrentStats.PeakQueued, Queue.size());
+                        Pumping = false;
+                        return;
+                    }
+                    pending = std::move(Queue.front());
+                    Queue.pop_front();
+                    inFlight = ++InFlight;
+                    CurrentStats.PeakInFlight = std::max(CurrentStats.PeakInFlight, inFlight);
+                }
+                Start(std::move(pending), inFlight);
+            }
+        }
+
+        void Start(Pending pending, size_t inFlight)
+        {
+            const auto started{std::chrono::steady_clock::now()};
+            arcana::task<void, std::exception_ptr> encode{};
+            try
+            {
+                encode = pending.Start(*CancellationSource);
+            }
+            catch (...)
+            {
+                arcana::task_completion_source<void, std::exception_ptr> failed{};
+                failed.complete(arcana::make_unexpected(std::current_exception()));
+                encode = failed.as_task();
+            }
+
+            const Timings timings{started - pending.Submitted, {}, inFlight};
+            encode.then(arcana::inline_scheduler, arcana::cancellation_source::none(),
+                [state{shared_from_this()}, completion{std::move(pending.Completion)}, timings, started](const arcana::expected<void, std::exception_ptr>& result) mutable {
+                    {
+                        std::scoped_lock lock{state->Mutex};
+                        ++(result.has_error() ? state->CurrentStats.Failed : state->CurrentStats.Completed);
+                    }
+
+                    if (result.has_error())
+                    {
+                        completion.complete(arcana::make_unexpected(result.error()));
+                    }
+                    else
+                    {
+                        completion.complete(Timings{timings.Queued, std::chrono::steady_clock::now() - started, timings.InFlight});
+                    }
+
+                    // Only now, so that Wait also covers the continuations of the completion.
+                    state->Finish();
+                });
+        }
+
+        void Finish()
+        {
+            {
+                std::scoped_lock lock{Mutex};
+                --InFlight;
+            }
+            Condition.notify_all();
+            Pump();
+        }
+
+        const size_t MaxInFlight;
+        const size_t MaxQueued;
+
+        mutable std::mutex Mutex{};
+        std::condition_variable Condition{};
+        std::deque<Pending> Queue{};
+        size_t InFlight{};
+        bool Pumping{};
+        bool Cancelled{};
+        Stats CurrentStats{};
+
+        // Shared, so that the continuations chained on it can keep it alive.
+        std::shared_ptr<arcana::cancellation_source> CancellationSource{std::make_shared<arcana::cancellation_source>()};
+    };
+
+    EncodeQueue::EncodeQueue(size_t maxInFlight, size_t maxQueued)
+        : m_state{std::make_shared<State>(maxInFlight, maxQueued)}
+    {
+    }
+
+    EncodeQueue::~EncodeQueue()
+    {
+        Cancel();
+        Wait();
+    }
+
+    arcana::task<EncodeQueue::Timings, std::exception_ptr> EncodeQueue::Submit(Encode encode)
+    {
+        arcana::task_completion_source<Timings, std::exception_ptr> completion{};
+        {
+            std::scoped_lock lock{m_state->Mutex};
+            if (m_state->Cancelled)
+            {
+                ++m_state->CurrentStats.Cancelled;
+                completion.complete(CancelledError());
+                return completion.as_task();
+            }
+            if (m_state->Queue.size() >= m_state->MaxQueued)
+            {
+                ++m_state->CurrentStats.Rejected;
+                throw std::length_error("NativeEncoding: " + std::to_string(m_state->Queue.size()) + " encodes are already waiting.");
+            }
+            m_state->Queue.push_back({std::move(encode), completion, std::chrono::steady_clock::now()});
+            ++m_state->CurrentStats.Submitted;
+        }
+
+        m_state->Pump();
+        return completion.as_task();
+    }
+
+    void EncodeQueue::Cancel()
+    {
+        std::deque<State::Pending> cancelled{};
+        {
+            std::scoped_lock lock{m_state->Mutex};
+            if (m_state->Cancelled)
+            {
+                return;
+            }
+            m_state->Cancelled = true;
+            cancelled.swap(m_state->Queue);
+            m_state->CurrentStats.Cancelled += cancelled.size();
+        }
+
+        m_state->CancellationSource->cancel();
+        for (auto& pending : cancelled)
+        {
+            pending.Completion.complete(CancelledError());
+        }
+    }
+
+    void EncodeQueue::Wait()
+    {
+        std::unique_lock lock{m_state->Mutex};
+        m_state->Condition.wait(lock, [this]() { return m_state->InFlight == 0; });
+    }
+
+    std::shared_ptr<arcana::cancellation_source> EncodeQueue::Cancellation()
+    {
+        return m_state->CancellationSource;
+    }
+
+    EncodeQueue::Stats EncodeQueue::GetStats() const
+    {
+        std::scoped_lock lock{m_state->Mutex};
+        return m_state->CurrentStats;
+    }
+}
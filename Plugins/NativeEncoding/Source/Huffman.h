@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Babylon::Plugins::NativeEncoding
+{
+    // Lossless WebP packs its Huffman codes least significant bit first, and describes the code
+    // lengths of a code with the run-length scheme of deflate.
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<std::byte>& output)
+            : m_output{output}
+        {
+        }
+
+        void Write(uint32_t bits, uint32_t count)
+        {
+            m_buffer |= uint64_t{bits} << m_count;
+            m_count += count;
+            if (m_count >= 32)
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    m_output.push_back(static_cast<std::byte>(m_buffer));
+                    m_buffer >>= 8;
+                }
+                m_count -= 32;
+            }
+        }
+
+        // Pads the last byte with zeros.
+        void Align()
+        {
+            while (m_count > 0)
+            {
+                m_output.push_back(static_cast<std::byte>(m_buffer));
+                m_buffer >>= 8;
+                m_count = m_count > 8 ? m_count - 8 : 0;
+            }
+            m_buffer = 0;
+        }
+
+        // Only after Align.
+        void WriteBytes(const uint8_t* data, size_t size)
+        {
+            const auto bytes{reinterpret_cast<const std::byte*>(data)};
+            m_output.insert(m_output.end(), bytes, bytes + size);
+        }
+
+    private:
+        std::vector<std::byte>& m_output;
+        uint64_t m_buffer{};
+        uint32_t m_count{};
+    };
+
+    template<size_t SymbolCount>
+    struct Huffman
+    {
+        size_t UsedSymbols() const
+        {
+            return static_cast<size_t>(std::count_if(Frequencies.begin(), Frequencies.end(), [](uint32_t frequency) { return frequency > 0; }));
+        }
+
+        // Builds codes of at most `maxLength` bits for the frequencies.
+        void Build(uint32_t maxLength)
+        {
+            // Use at least two symbols, so that every code is complete.
+            for (size_t symbol = 0, used = UsedSymbols(); used < 2; ++symbol)
+            {
+                if (Frequencies[symbol] == 0)
+                {
+                    Frequencies[symbol] = 1;
+                    ++used;
+                }
+            }
+
+            std::array<uint16_t, SymbolCount> symbols{};
+            size_t count{};
+            for (size_t symbol = 0; symbol < SymbolCount; ++symbol)
+            {
+                if (Frequencies[symbol] > 0)
+                {
+                    symbols[count++] = static_cast<uint16_t>(symbol);
+                }
+            }
+            std::sort(symbols.begin(), symbols.begin() + count, [this](uint16_t a, uint16_t b) {
+                return Frequencies[a] < Frequencies[b] || (Frequencies[a] == Frequencies[b] && a < b);
+            });
+
+            // The sorted leaves and the internal nodes, which are created in increasing weight,
+            // make two queues to take the two lightest nodes from.
+            std::array<uint32_t, SymbolCount * 2> weights{};
+            std::array<uint16_t, SymbolCount * 2> parents{};
+            for (size_t i = 0; i < count; ++i)
+            {
+                weights[i] = Frequencies[symbols[i]];
+            }
+            size_t leaf{};
+            size_t node{count};
+            const auto lightest = [&](size_t end) {
+                return leaf < count && (node >= end || weights[leaf] <= weights[node]) ? leaf++ : node++;
+            };
+            for (size_t next = count; next < count * 2 - 1; ++next)
+            {
+                const size_t first{lightest(next)};
+                const size_t second{lightest(next)};
+                weights[next] = weights[first] + weights[second];
+                parents[first] = parents[second] = static_cast<uint16_t>(next);
+            }
+
+            std::array<uint8_t, SymbolCount * 2> depths{};
+            std::array<uint32_t, 64> lengthCounts{};
+            for (size_t i = count * 2 - 2; i-- > 0;)
+            {
+                depths[i] = static_cast<uint8_t>(depths[parents[i]] + 1);
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                ++lengthCounts[depths[i]];
+            }
+
+            // Cap the lengths, then lengthen shorter codes until the code is complete again, as
+            // miniz does.
+            for (size_t length = maxLength + 1; length < lengthCounts.size(); ++length)
+            {
+                lengthCounts[maxLength] += lengthCounts[length];
+                lengthCounts[length] = 0;
+            }
+            uint32_t total{};
+            for (uint32_t length = 1; length <= maxLength; ++length)
+            {
+                total += lengthCounts[length] << (maxLength - length);
+            }
+            for (; total != (1u << maxLength); --total)
+            {
+                --lengthCounts[maxLength];
+                for (uint32_t length = maxLength - 1; length > 0; --length)
+                {
+                    if (lengthCounts[length] > 0)
+                    {
+                        --lengthCounts[length];
+                        lengthCounts[length + 1] += 2;
+                        break;
+                    }
+                }
+            }
+
+            // The least frequent symbols get the longest codes.
+            Lengths.fill(0);
+            size_t symbol{};
+            for (uint32_t length = maxLength; length > 0; --length)
+            {
+                for (uint32_t i = 0; i < lengthCounts[length]; ++i)
+                {
+                    Lengths[symbols[symbol++]] = static_cast<uint8_t>(length);
+                }
+            }
+
+            // Canonical codes, bit reversed for the writer.
+            std::array<uint16_t, 16> nextCode{};
+            for (uint32_t length = 1, code = 0; length <= maxLength; ++length)
+            {
+                code = (code + lengthCounts[length - 1]) << 1;
+                nextCode[length] = static_cast<uint16_t>(code);
+            }
+            for (size_t s = 0; s < SymbolCount; ++s)
+            {
+                if (Lengths[s] > 0)
+                {
+                    uint32_t code{nextCode[Lengths[s]]++};
+                    uint32_t reversed{};
+                    for (uint32_t bit = 0; bit < Lengths[s]; ++bit, code >>= 1)
+                    {
+                        reversed = (reversed << 1) | (code & 1);
+                    }
+                    Codes[s] = static_cast<uint16_t>(reversed);
+                }
+            }
+        }
+
+        void Write(BitWriter& writer, size_t symbol) const
+        {
+            writer.Write(Codes[symbol], Lengths[symbol]);
+        }
+
+        std::array<uint32_t, SymbolCount> Frequencies{};
+        std::array<uint8_t, SymbolCount> Lengths{};
+        std::array<uint16_t, SymbolCount> Codes{};
+    };
+
+    // Code lengths run-length encoded with the repeat symbols 16 (the previous length 3 to 6
+    // times), 17 (3 to 10 zeros) and 18 (11 to 138 zeros), and the code for the result.
+    class CodeLengths
+    {
+    public:
+        static constexpr size_t SYMBOLS{19};
+        static constexpr uint32_t MAX_LENGTH{7};
+
+        CodeLengths(const uint8_t* lengths, size_t count)
+        {
+            m_symbols.reserve(count);
+            for (size_t i = 0; i < count;)
+            {
+                const uint8_t length{lengths[i]};
+                size_t run{1};
+                while (i + run < count && lengths[i + run] == length)
+                {
+                    ++run;
+                }
+
+                if (length == 0 && run >= 3)
+                {
+                    run = std::min<size_t>(run, 138);
+                    run >= 11 ? Add(18, run - 11) : Add(17, run - 3);
+                    i += run;
+                }
+                else if (length != 0 && run >= 4)
+                {
+                    const size_t repeat{std::min<size_t>(run - 1, 6)};
+                    Add(length, 0);
+                    Add(16, repeat - 3);
+                    i += 1 + repeat;
+                }
+                else
+                {
+                    Add(length, 0);
+                    ++i;
+                }
+            }
+            m_code.Build(MAX_LENGTH);
+        }
+
+        const Huffman<SYMBOLS>& Code() const
+        {
+            return m_code;
+        }
+
+        // The number of entries of `order` to write the code with: the trailing unused ones are
+        // left out, down to `minimum`.
+        size_t OrderCount(const std::array<uint8_t, SYMBOLS>& order, size_t minimum) const
+        {
+            size_t count{SYMBOLS};
+            while (count > minimum && m_code.Lengths[order[count - 1]] == 0)
+            {
+                --count;
+            }
+            return count;
+        }
+
+        // The bits of the encoded lengths, not counting the code.
+        uint64_t Bits() const
+        {
+            uint64_t bits{};
+            for (const auto& symbol : m_symbols)
+            {
+                bits += m_code.Lengths[symbol.Symbol] + ExtraBits(symbol.Symbol);
+            }
+            return bits;
+        }
+
+        void Write(BitWriter& writer) const
+        {
+            for (const auto& symbol : m_symbols)
+            {
+                m_code.Write(writer, symbol.Symbol);
+                writer.Write(symbol.Extra, ExtraBits(symbol.Symbol));
+            }
+        }
+
+    private:
+        struct Symbol
+        {
+            uint8_t Symbol;
+            uint8_t Extra;
+        };
+
+        static uint32_t ExtraBits(uint8_t symbol)
+        {
+            constexpr std::array<uint8_t, 3> REPEAT_EXTRA{2, 3, 7};
+            return symbol >= 16 ? REPEAT_EXTRA[symbol - 16] : 0;
+        }
+
+        void Add(uint8_t symbol, size_t extra)
+        {
+            m_symbols.push_back({symbol, static_cast<uint8_t>(extra)});
+            ++m_code.Frequencies[symbol];
+        }
+
+        std::vector<Symbol> m_symbols{};
+        Huffman<SYMBOLS> m_code{};
+    };
+}
@@ -1,98 +1,255 @@
 #include <Babylon/Plugins/NativeEncoding.h>
+#include <Babylon/Plugins/NativeEncodingInternal.h>
 #include <Babylon/JsRuntime.h>
 #include <Babylon/JsRuntimeScheduler.h>
-#include <Babylon/Graphics/DeviceContext.h>
 
 #include <napi/napi.h>
 
-#include <bimg/encode.h>
-#include <bx/readerwriter.h>
-
 #include <arcana/threading/task.h>
 #include <arcana/threading/task_schedulers.h>
 
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 namespace Babylon::Plugins
 {
     namespace
     {
-        std::shared_ptr<std::vector<std::byte>> EncodePNG(const std::vector<std::byte>& pixelData, uint32_t width, uint32_t height, bool invertY)
-        {
-            auto memoryBlock{bx::MemoryBlock(&Graphics::DeviceContext::GetDefaultAllocator())};
-            auto writer{bx::MemoryWriter(&memoryBlock)};
-            auto err{bx::Error()};
+        namespace Png = NativeEncoding::Png;
+        namespace Jpeg = NativeEncoding::Jpeg;
+        namespace WebP = NativeEncoding::WebP;
 
-            bimg::imageWritePng(&writer, width, height, width * 4, pixelData.data(), bimg::TextureFormat::RGBA8, !invertY, &err);
+        constexpr const char* PNG_TYPE{"image/png"};
+        constexpr const char* JPEG_TYPE{"image/jpeg"};
+        constexpr const char* WEBP_TYPE{"image/webp"};
 
-            auto byteLength{memoryBlock.getSize()};
+        Napi::Value ReadOption(const Napi::CallbackInfo& info, const char* name)
+        {
+            return info.Length() > 5 && info[5].IsObject() ? info[5].As<Napi::Object>().Get(name) : info.Env().Undefined();
+        }
 
-            if (!err.isOk())
+        // The rows become image rows bottom-up by default, as they come from a texture readback.
+        Png::Options ReadPngOptions(const Napi::CallbackInfo& info, bool invertY)
+        {
+            Png::Options options{};
+            options.FlipY = !invertY;
+            const auto compressionLevel{ReadOption(info, "compressionLevel")};
+            if (!compressionLevel.IsUndefined())
+            {
+                options.CompressionLevel = compressionLevel.As<Napi::Number>().Int32Value();
+            }
+            return options;
+        }
+
+        // As with canvas.toBlob, the quality is from 0 to 1, and anything else means the default.
+        Jpeg::Options ReadJpegOptions(const Napi::CallbackInfo& info, bool invertY)
+        {
+            Jpeg::Options options{};
+            options.FlipY = !invertY;
+            const auto quality{ReadOption(info, "quality")};
+            if (quality.IsNumber())
             {
-                throw std::runtime_error("Failed to encode PNG image: " + std::string(err.getMessage().getCPtr()));
+                const double value{quality.As<Napi::Number>().DoubleValue()};
+                if (value >= 0 && value <= 1)
+                {
+                    options.Quality = std::max(Jpeg::MIN_QUALITY, static_cast<int>(std::lround(value * Jpeg::MAX_QUALITY)));
+                }
             }
+            return options;
+        }
 
-            if (byteLength == 0)
+        // Calls `options.onTimings`, if it is a function, with the timings of the encode.
+        void ReportTimings(Napi::Env env, const Napi::FunctionReference& onTimings, const NativeEncoding::EncodeQueue::Timings& timings, size_t byteLength)
+        {
+            if (onTimings.IsEmpty())
             {
-                throw std::runtime_error("Failed to encode PNG image: output is empty");
+                return;
             }
 
-            auto result{std::make_shared<std::vector<std::byte>>(byteLength)};
-            std::memcpy(result->data(), memoryBlock.more(0), byteLength);
+            const auto milliseconds = [](std::chrono::steady_clock::duration duration) {
+                return std::chrono::duration<double, std::milli>(duration).count();
+            };
 
-            return result;
+            auto report{Napi::Object::New(env)};
+            report.Set("queuedMilliseconds", milliseconds(timings.Queued));
+            report.Set("encodeMilliseconds", milliseconds(timings.Encoding));
+            report.Set("inFlight", static_cast<double>(timings.InFlight));
+            report.Set("byteLength", static_cast<double>(byteLength));
+            onTimings.Call({report});
         }
 
-        Napi::Value EncodeImageAsync(const Napi::CallbackInfo& info)
+        constexpr auto JS_ENCODER_NAME = "_nativeEncoder";
+
+        // The encodes of one JavaScript environment. The environment owns it, so tearing the
+        // environment down cancels the encodes that have not started, and waits for the running
+        // ones as NativeEngine does for its thread pool work.
+        class Encoder final
         {
-            auto buffer{info[0].As<Napi::TypedArray>()}; // ArrayBufferView
-            auto width{info[1].As<Napi::Number>().Uint32Value()};
-            auto height{info[2].As<Napi::Number>().Uint32Value()};
-            auto mimeType{info.Length() > 3 && !info[3].IsUndefined() ? info[3].As<Napi::String>().Utf8Value() : "image/png"};
-            auto invertY{info.Length() > 4 && !info[4].IsUndefined() ? info[4].As<Napi::Boolean>().Value() : false};
+        public:
+            static void CreateForJavaScript(Napi::Env env, const NativeEncoding::Configuration& configuration)
+            {
+                auto* encoder{new Encoder(env, configuration)};
+                auto native{JsRuntime::NativeObject::GetFromJavaScript(env)};
+                native.Set(JS_ENCODER_NAME, Napi::External<Encoder>::New(env, encoder, [](Napi::Env, Encoder* encoder) { delete encoder; }));
+                native.Set("EncodeImageAsync", Napi::Function::New(env, EncodeImageAsync, "EncodeImageAsync"));
+            }
 
-            auto env{info.Env()};
-            auto deferred{Napi::Promise::Deferred::New(env)};
+            ~Encoder()
+            {
+                m_queue.Cancel();
+                m_queue.Wait();
+            }
 
-            if (buffer.ByteLength() != width * height * 4)
+        private:
+            Encoder(Napi::Env env, const NativeEncoding::Configuration& configuration)
+                : m_runtimeScheduler{JsRuntime::GetFromJavaScript(env)}
+                , m_queue{configuration.MaxInFlightEncodes != 0 ? configuration.MaxInFlightEncodes : std::max(std::thread::hardware_concurrency() / 2, 1u), configuration.MaxQueuedEncodes}
             {
-                deferred.Reject(Napi::Error::New(env, "Buffer byte length does not match RGBA8 format (4 bytes per pixel) of provided dimensions.").Value());
-                return deferred.Promise();
             }
 
-            auto runtimeScheduler{std::make_shared<JsRuntimeScheduler>(JsRuntime::GetFromJavaScript(env))};
-            auto start = static_cast<std::byte*>(buffer.ArrayBuffer().Data()) + buffer.ByteOffset();
-            auto pixelData{std::vector<std::byte>(start, start + buffer.ByteLength())};
+            static Encoder& GetFromJavaScript(Napi::Env env)
+            {
+                return *JsRuntime::NativeObject::GetFromJavaScript(env).Get(JS_ENCODER_NAME).As<Napi::External<Encoder>>().Data();
+            }
+
+            static Napi::Value EncodeImageAsync(const Napi::CallbackInfo& info)
+            {
+                return GetFromJavaScript(info.Env()).Encode(info);
+            }
+
+            // Queues an encode that encodes each range of rows with a thread pool task of its own
+            // and assembles the results on the thread pool, then resolves the promise with a Blob
+            // of the file. The pixels are kept alive by `pixelDataRef` until then.
+            template<typename EncodedT, typename EncodeRowsT, typename AssembleT>
+            void EncodeRangesAsync(Napi::Env env, Napi::Promise::Deferred deferred, std::shared_ptr<Napi::Reference<Napi::TypedArray>> pixelDataRef, Napi::FunctionReference onTimings,
+                const char* mimeType, const std::vector<NativeEncoding::RowRange>& ranges, EncodeRowsT encodeRows, AssembleT assemble)
+            {
+                auto imageData{std::make_shared<std::shared_ptr<std::vector<std::byte>>>()};
+                auto onTimingsRef{std::make_shared<Napi::FunctionReference>(std::move(onTimings))};
 
-            arcana::make_task(arcana::threadpool_scheduler, arcana::cancellation_source::none(),
-                [pixelData{std::move(pixelData)}, width, height, invertY]() {
-                    return EncodePNG(pixelData, width, height, invertY);
-                })
-                .then(*runtimeScheduler, arcana::cancellation_source::none(),
-                    [runtimeScheduler, deferred, env](const arcana::expected<std::shared_ptr<std::vector<std::byte>>, std::exception_ptr>& result) {
-                        // TODO: Crash risk on JS teardown - this async work isn't tied to any JS object lifetime,
-                        // unlike other plugins that cancel / clean up pending work in their destructors.
-                        if (result.has_error())
-                        {
-                            deferred.Reject(Napi::Error::New(env, result.error()).Value());
-                            return;
-                        }
+                auto encode = [ranges, encodeRows, assemble, imageData](arcana::cancellation& cancellation) {
+                    auto encodedRanges{std::make_shared<std::vector<EncodedT>>(ranges.size())};
+                    std::vector<arcana::task<size_t, std::exception_ptr>> tasks{};
+                    tasks.reserve(ranges.size());
+                    for (size_t index = 0; index < ranges.size(); ++index)
+                    {
+                        tasks.push_back(arcana::make_task(arcana::threadpool_scheduler, cancellation,
+                            [encodeRows, rows{ranges[index]}, encodedRanges, index]() {
+                                (*encodedRanges)[index] = encodeRows(rows);
+                                return index;
+                            }));
+                    }
 
-                        auto& imageData = result.value();
-                        auto arrayBuffer{Napi::ArrayBuffer::New(env, imageData->data(), imageData->size(), [imageData](Napi::Env, void*) {})};
+                    return arcana::when_all(gsl::make_span(tasks))
+                        .then(arcana::threadpool_scheduler, cancellation,
+                            [encodedRanges, assemble, imageData](const std::vector<size_t>&) {
+                                *imageData = std::make_shared<std::vector<std::byte>>(assemble(*encodedRanges));
+                            });
+                };
 
-                        auto blobCtor = env.Global().Get("Blob").As<Napi::Function>();
-                        auto blobParts = Napi::Array::New(env, 1);
-                        blobParts.Set(uint32_t{0}, arrayBuffer);
+                auto cancellationSource{m_queue.Cancellation()};
+                m_queue.Submit(std::move(encode))
+                    .then(m_runtimeScheduler, *cancellationSource,
+                        [cancellationSource, deferred, env, pixelDataRef, onTimingsRef, imageData, mimeType](const arcana::expected<NativeEncoding::EncodeQueue::Timings, std::exception_ptr>& result) {
+                            if (result.has_error())
+                            {
+                                deferred.Reject(Napi::Error::New(env, result.error()).Value());
+                                return;
+                            }
 
-                        auto options = Napi::Object::New(env);
-                        options.Set("type", Napi::String::New(env, "image/png"));
+                            auto data{*imageData};
+                            ReportTimings(env, *onTimingsRef, result.value(), data->size());
 
-                        auto blob = blobCtor.New({blobParts, options});
+                            auto arrayBuffer{Napi::ArrayBuffer::New(env, data->data(), data->size(), [data](Napi::Env, void*) {})};
 
-                        deferred.Resolve(blob);
-                    });
+                            auto blobCtor = env.Global().Get("Blob").As<Napi::Function>();
+                            auto blobParts = Napi::Array::New(env, 1);
+                            blobParts.Set(uint32_t{0}, arrayBuffer);
 
-            return deferred.Promise();
-        }
+                            auto options = Napi::Object::New(env);
+                            options.Set("type", Napi::String::New(env, mimeType));
+
+                            auto blob = blobCtor.New({blobParts, options});
+
+                            deferred.Resolve(blob);
+                        });
+            }
+
+            Napi::Value Encode(const Napi::CallbackInfo& info)
+            {
+                auto buffer{info[0].As<Napi::TypedArray>()}; // ArrayBufferView
+                auto width{info[1].As<Napi::Number>().Uint32Value()};
+                auto height{info[2].As<Napi::Number>().Uint32Value()};
+                auto mimeType{info.Length() > 3 && !info[3].IsUndefined() ? info[3].As<Napi::String>().Utf8Value() : PNG_TYPE};
+                auto invertY{info.Length() > 4 && !info[4].IsUndefined() ? info[4].As<Napi::Boolean>().Value() : false};
+                const auto onTimings{ReadOption(info, "onTimings")};
+
+                auto env{info.Env()};
+                auto deferred{Napi::Promise::Deferred::New(env)};
+
+                if (buffer.ByteLength() != uint64_t{width} * height * 4)
+                {
+                    deferred.Reject(Napi::Error::New(env, "Buffer byte length does not match RGBA8 format (4 bytes per pixel) of provided dimensions.").Value());
+                    return deferred.Promise();
+                }
+
+                // The thread pool reads the pixels in place rather than from a copy, so the array is
+                // kept alive until the promise settles and must not be written to until then.
+                auto pixelData{static_cast<const std::byte*>(buffer.ArrayBuffer().Data()) + buffer.ByteOffset()};
+                auto pixelDataRef{std::make_shared<Napi::Reference<Napi::TypedArray>>(Napi::Persistent(buffer))};
+                auto onTimingsRef{onTimings.IsFunction() ? Napi::Persistent(onTimings.As<Napi::Function>()) : Napi::FunctionReference{}};
+
+                // As with canvas.toBlob, a type that is not supported is encoded as PNG.
+                try
+                {
+                    if (mimeType == JPEG_TYPE)
+                    {
+                        const auto options{ReadJpegOptions(info, invertY)};
+                        Jpeg::Validate(width, height, options);
+                        EncodeRangesAsync<std::vector<std::byte>>(env, deferred, pixelDataRef, std::move(onTimingsRef), JPEG_TYPE, Jpeg::SplitRows(width, height, options),
+                            [pixelData, width, height, options](NativeEncoding::RowRange rows) { return Jpeg::EncodeRows(pixelData, width, height, rows, options); },
+                            [width, height, options](const std::vector<std::vector<std::byte>>& segments) { return Jpeg::Assemble(width, height, options, segments); });
+                    }
+                    else if (mimeType == WEBP_TYPE)
+                    {
+                        // Lossless, so any quality is ignored, and written by a single task.
+                        const WebP::Options options{!invertY};
+                        WebP::Validate(width, height);
+                        EncodeRangesAsync<std::vector<std::byte>>(env, deferred, pixelDataRef, std::move(onTimingsRef), WEBP_TYPE, std::vector<NativeEncoding::RowRange>{{0, height}},
+                            [pixelData, width, height, options](NativeEncoding::RowRange) { return WebP::Encode(pixelData, width, height, options); },
+                            [](std::vector<std::vector<std::byte>>& files) { return std::move(files.front()); });
+                    }
+                    else
+                    {
+                        const auto options{ReadPngOptions(info, invertY)};
+                        Png::Validate(width, height, options);
+                        // Each range of rows is filtered and deflated into an IDAT chunk of its own.
+                        EncodeRangesAsync<Png::EncodedRows>(env, deferred, pixelDataRef, std::move(onTimingsRef), PNG_TYPE, Png::SplitRows(width, height),
+                            [pixelData, width, height, options](NativeEncoding::RowRange rows) { return Png::EncodeRows(pixelData, width, height, rows, options); },
+                            [width, height](const std::vector<Png::EncodedRows>& ranges) { return Png::Assemble(width, height, ranges); });
+                    }
+                }
+                catch (const std::invalid_argument& exception)
+                {
+                    deferred.Reject(Napi::RangeError::New(env, exception.what()).Value());
+                }
+                catch (const std::length_error& exception)
+                {
+                    // Backpressure: MaxQueuedEncodes encodes are already waiting.
+                    deferred.Reject(Napi::Error::New(env, exception.what()).Value());
+                }
+
+                return deferred.Promise();
+            }
+
+            JsRuntimeScheduler m_runtimeScheduler;
+            NativeEncoding::EncodeQueue m_queue;
+        };
     }
 }
 
@@ -100,7 +257,11 @@ namespace Babylon::Plugins::NativeEncoding
 {
     void BABYLON_API Initialize(Napi::Env env)
     {
-        auto native{JsRuntime::NativeObject::GetFromJavaScript(env)};
-        native.Set("EncodeImageAsync", Napi::Function::New(env, EncodeImageAsync, "EncodeImageAsync"));
+        Initialize(env, Configuration{});
     }
-}
\ No newline at end of file
+
+    void BABYLON_API Initialize(Napi::Env env, const Configuration& configuration)
+    {
+        Encoder::CreateForJavaScript(env, configuration);
+    }
+}
@@ -0,0 +1,579 @@
+#include <Babylon/Plugins/NativeEncodingInternal.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+namespace
+{
+    using namespace Babylon::Plugins::NativeEncoding;
+    using namespace Babylon::Plugins::NativeEncoding::Jpeg;
+
+    constexpr size_t BYTES_PER_PIXEL{4};
+
+    // As for PNG, about 1 MB of pixels per range.
+    constexpr size_t RANGE_BYTES{1 << 20};
+
+    // The restart interval is a 16-bit count of MCUs.
+    constexpr size_t MAX_RESTART_INTERVAL{65535};
+
+    // From 90 up the chroma keeps its full resolution, as stb_image_write does.
+    constexpr int FULL_CHROMA_QUALITY{90};
+
+    // The natural index of each coefficient in zigzag order.
+    constexpr std::array<uint8_t, 64> ZIGZAG{
+        0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+    // The quantization tables of the JPEG standard, Annex K, in natural order.
+    constexpr std::array<uint8_t, 64> LUMINANCE_QUANTIZATION{
+        16, 11, 10, 16, 24, 40, 51, 61,
+        12, 12, 14, 19, 26, 58, 60, 55,
+        14, 13, 16, 24, 40, 57, 69, 56,
+        14, 17, 22, 29, 51, 87, 80, 62,
+        18, 22, 37, 56, 68, 109, 103, 77,
+        24, 35, 55, 64, 81, 104, 113, 92,
+        49, 64, 78, 87, 103, 121, 120, 101,
+        72, 92, 95, 98, 112, 100, 103, 99};
+
+    constexpr std::array<uint8_t, 64> CHROMINANCE_QUANTIZATION{
+        17, 18, 24, 47, 99, 99, 99, 99,
+        18, 21, 26, 66, 99, 99, 99, 99,
+        24, 26, 56, 99, 99, 99, 99, 99,
+        47, 66, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99};
+
+    // The Huffman tables of the JPEG standard, Annex K, as the number of codes of each length
+    // from 1 to 16 and the symbols in order of their codes.
+    struct HuffmanSpecification
+    {
+        std::array<uint8_t, 16> Counts;
+        std::vector<uint8_t> Symbols;
+    };
+
+    const HuffmanSpecification& LuminanceDc()
+    {
+        static const HuffmanSpecification specification{
+            {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0},
+            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}};
+        return specification;
+    }
+
+    const HuffmanSpecification& ChrominanceDc()
+    {
+        static const HuffmanSpecification specification{
+            {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0},
+            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}};
+        return specification;
+    }
+
+    const HuffmanSpecification& LuminanceAc()
+    {
+        static const HuffmanSpecification specification{
+            {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D},
+            {0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+                0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+                0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+                0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+                0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+                0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+                0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+                0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+                0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+                0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+                0xF9, 0xFA}};
+        return specification;
+    }
+
+    const HuffmanSpecification& ChrominanceAc()
+    {
+        static const HuffmanSpecification specification{
+            {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77},
+            {0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+                0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+                0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+                0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+                0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+                0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+                0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+                0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+                0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+                0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+                0xF9, 0xFA}};
+        return specification;
+    }
+
+    // The canonical codes of a specification, by symbol.
+    struct HuffmanTable
+    {
+        explicit HuffmanTable(const HuffmanSpecification& specification)
+        {
+            uint32_t code{};
+            size_t symbol{};
+            for (uint32_t length = 1; length <= 16; ++length, code <<= 1)
+            {
+                for (uint32_t i = 0; i < specification.Counts[length - 1]; ++i, ++code)
+                {
+                    Codes[specification.Symbols[symbol]] = static_cast<uint16_t>(code);
+                    Lengths[specification.Symbols[symbol]] = static_cast<uint8_t>(length);
+                    ++symbol;
+                }
+            }
+        }
+
+        std::array<uint16_t, 256> Codes{};
+        std::array<uint8_t, 256> Lengths{};
+    };
+
+    struct HuffmanTables
+    {
+        HuffmanTable LuminanceDc{::LuminanceDc()};
+        HuffmanTable LuminanceAc{::LuminanceAc()};
+        HuffmanTable ChrominanceDc{::ChrominanceDc()};
+        HuffmanTable ChrominanceAc{::ChrominanceAc()};
+    };
+
+    const HuffmanTables& GetHuffmanTables()
+    {
+        static const HuffmanTables tables{};
+        return tables;
+    }
+
+    // A quantization table scaled for the quality as libjpeg does, and the factors that
+    // quantize the output of the scaled DCT below with it.
+    struct Quantization
+    {
+        Quantization(const std::array<uint8_t, 64>& base, int quality)
+        {
+            constexpr std::array<float, 8> AAN_SCALE{1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f};
+
+            const int scale{quality < 50 ? 5000 / quality : 200 - quality * 2};
+            for (size_t i = 0; i < 64; ++i)
+            {
+                Table[i] = static_cast<uint8_t>(std::clamp((base[i] * scale + 50) / 100, 1, 255));
+                Factors[i] = 1.0f / (Table[i] * AAN_SCALE[i / 8] * AAN_SCALE[i % 8] * 8.0f);
+            }
+        }
+
+        // Natural order.
+        std::array<uint8_t, 64> Table{};
+        std::array<float, 64> Factors{};
+    };
+
+    // Writes codes most significant bit first, with a zero byte stuffed after each 0xFF.
+    class JpegBitWriter
+    {
+    public:
+        explicit JpegBitWriter(std::vector<std::byte>& output)
+            : m_output{output}
+        {
+        }
+
+        void Write(uint32_t bits, uint32_t count)
+        {
+            m_buffer = (m_buffer << count) | (bits & ((1u << count) - 1));
+            m_count += count;
+            while (m_count >= 8)
+            {
+                m_count -= 8;
+                const auto byte{static_cast<std::byte>(m_buffer >> m_count)};
+                m_output.push_back(byte);
+                if (byte == std::byte{0xFF})
+                {
+                    m_output.push_back(std::byte{0});
+                }
+            }
+        }
+
+        // Pads the last byte with ones.
+        void Flush()
+        {
+            if (m_count > 0)
+            {
+                Write(0x7F, 8 - m_count);
+            }
+        }
+
+    private:
+        std::vector<std::byte>& m_output;
+        uint64_t m_buffer{};
+        uint32_t m_count{};
+    };
+
+    // The forward DCT of eight values `stride` apart, scaled by the AAN factors, as libjpeg's
+    // jfdctflt.c does.
+    void Dct8(float* values, size_t stride)
+    {
+        float* const d0{values};
+        float* const d1{values + stride};
+        float* const d2{values + stride * 2};
+        float* const d3{values + stride * 3};
+        float* const d4{values + stride * 4};
+        float* const d5{values + stride * 5};
+        float* const d6{values + stride * 6};
+        float* const d7{values + stride * 7};
+
+        const float tmp0{*d0 + *d7};
+        const float tmp7{*d0 - *d7};
+        const float tmp1{*d1 + *d6};
+        const float tmp6{*d1 - *d6};
+        const float tmp2{*d2 + *d5};
+        const float tmp5{*d2 - *d5};
+        const float tmp3{*d3 + *d4};
+        const float tmp4{*d3 - *d4};
+
+        // Even part.
+        const float tmp10{tmp0 + tmp3};
+        const float tmp13{tmp0 - tmp3};
+        const float tmp11{tmp1 + tmp2};
+        const float tmp12{tmp1 - tmp2};
+        *d0 = tmp10 + tmp11;
+        *d4 = tmp10 - tmp11;
+        const float z1{(tmp12 + tmp13) * 0.707106781f};
+        *d2 = tmp13 + z1;
+        *d6 = tmp13 - z1;
+
+        // Odd part.
+        const float odd10{tmp4 + tmp5};
+        const float odd11{tmp5 + tmp6};
+        const float odd12{tmp6 + tmp7};
+        const float z5{(odd10 - odd12) * 0.382683433f};
+        const float z2{odd10 * 0.541196100f + z5};
+        const float z4{odd12 * 1.306562965f + z5};
+        const float z3{odd11 * 0.707106781f};
+        const float z11{tmp7 + z3};
+        const float z13{tmp7 - z3};
+        *d5 = z13 + z2;
+        *d3 = z13 - z2;
+        *d1 = z11 + z4;
+        *d7 = z11 - z4;
+    }
+
+    // The number of bits of a coefficient's magnitude, its category in the Huffman coding.
+    uint32_t Category(int value)
+    {
+        uint32_t magnitude{static_cast<uint32_t>(value < 0 ? -value : value)};
+        uint32_t category{};
+        for (; magnitude > 0; magnitude >>= 1)
+        {
+            ++category;
+        }
+        return category;
+    }
+
+    void WriteCoefficient(JpegBitWriter& writer, const HuffmanTable& table, uint32_t run, int value)
+    {
+        const uint32_t category{Category(value)};
+        const uint32_t symbol{(run << 4) | category};
+        writer.Write(table.Codes[symbol], table.Lengths[symbol]);
+        // Negative values are written as value - 1 in the category's bits.
+        writer.Write(static_cast<uint32_t>(value < 0 ? value - 1 : value), category);
+    }
+
+    // Transforms, quantizes and writes a block of level shifted samples in natural order.
+    void EncodeBlock(JpegBitWriter& writer, std::array<float, 64>& block, const Quantization& quantization, int& previousDc, const HuffmanTable& dcTable, const HuffmanTable& acTable)
+    {
+        for (size_t row = 0; row < 8; ++row)
+        {
+            Dct8(block.data() + row * 8, 1);
+        }
+        for (size_t column = 0; column < 8; ++column)
+        {
+            Dct8(block.data() + column, 8);
+        }
+
+        std::array<int, 64> coefficients{};
+        int last{};
+        for (size_t i = 0; i < 64; ++i)
+        {
+            const float value{block[ZIGZAG[i]] * quantization.Factors[ZIGZAG[i]]};
+            coefficients[i] = static_cast<int>(value < 0 ? value - 0.5f : value + 0.5f);
+            if (coefficients[i] != 0)
+            {
+                last = static_cast<int>(i);
+            }
+        }
+
+        WriteCoefficient(writer, dcTable, 0, coefficients[0] - previousDc);
+        previousDc = coefficients[0];
+
+        constexpr uint32_t END_OF_BLOCK{0x00};
+        constexpr uint32_t SIXTEEN_ZEROS{0xF0};
+        uint32_t run{};
+        for (int i = 1; i <= last; ++i)
+        {
+            if (coefficients[i] == 0)
+            {
+                ++run;
+                continue;
+            }
+            for (; run >= 16; run -= 16)
+            {
+                writer.Write(acTable.Codes[SIXTEEN_ZEROS], acTable.Lengths[SIXTEEN_ZEROS]);
+            }
+            WriteCoefficient(writer, acTable, run, coefficients[i]);
+            run = 0;
+        }
+        if (last < 63)
+        {
+            writer.Write(acTable.Codes[END_OF_BLOCK], acTable.Lengths[END_OF_BLOCK]);
+        }
+    }
+
+    bool SubsampleChroma(const Options& options)
+    {
+        return options.Quality < FULL_CHROMA_QUALITY;
+    }
+
+    uint32_t RowsPerRange(uint32_t width, const Options& options)
+    {
+        const uint32_t mcuSize{SubsampleChroma(options) ? 16u : 8u};
+        const size_t mcusPerRow{(width + mcuSize - 1) / mcuSize};
+        const size_t mcuRowBytes{size_t{width} * mcuSize * BYTES_PER_PIXEL};
+        const size_t mcuRows{std::max<size_t>(std::min(RANGE_BYTES / mcuRowBytes, MAX_RESTART_INTERVAL / mcusPerRow), 1)};
+        return static_cast<uint32_t>(mcuRows * mcuSize);
+    }
+
+    void AppendBigEndian16(std::vector<std::byte>& output, size_t value)
+    {
+        output.push_back(static_cast<std::byte>(value >> 8));
+        output.push_back(static_cast<std::byte>(value));
+    }
+
+    void AppendMarker(std::vector<std::byte>& output, uint8_t marker)
+    {
+        output.push_back(std::byte{0xFF});
+        output.push_back(static_cast<std::byte>(marker));
+    }
+
+    void AppendBytes(std::vector<std::byte>& output, std::initializer_list<uint8_t> bytes)
+    {
+        for (const auto byte : bytes)
+        {
+            output.push_back(static_cast<std::byte>(byte));
+        }
+    }
+}
+
+namespace Babylon::Plugins::NativeEncoding::Jpeg
+{
+    void Validate(uint32_t width, uint32_t height, const Options& options)
+    {
+        if (width == 0 || height == 0 || width > 65535 || height > 65535)
+        {
+            throw std::invalid_argument("JPEG: the image must be 1 to 65535 pixels on a side, got " + std::to_string(width) + " x " + std::to_string(height) + ".");
+        }
+        if (options.Quality < MIN_QUALITY || options.Quality > MAX_QUALITY)
+        {
+            throw std::invalid_argument("JPEG: quality must be in [1, 100], got " + std::to_string(options.Quality) + ".");
+        }
+    }
+
+    std::vector<RowRange> SplitRows(uint32_t width, uint32_t height, const Options& options)
+    {
+        const uint32_t rowsPerRange{RowsPerRange(width, options)};
+
+        std::vector<RowRange> ranges{};
+        ranges.reserve((height + rowsPerRange - 1) / rowsPerRange);
+        for (uint32_t row = 0; row < height; row += rowsPerRange)
+        {
+            ranges.push_back({row, std::min(rowsPerRange, height - row)});
+        }
+        return ranges;
+    }
+
+    std::vector<std::byte> EncodeRows(const std::byte* pixels, uint32_t width, uint32_t height, RowRange rows, const Options& options)
+    {
+        const auto& huffman{GetHuffmanTables()};
+        const Quantization luminance{LUMINANCE_QUANTIZATION, options.Quality};
+        const Quantization chrominance{CHROMINANCE_QUANTIZATION, options.Quality};
+        const bool subsample{SubsampleChroma(options)};
+        const uint32_t mcuSize{subsample ? 16u : 8u};
+
+        std::vector<std::byte> segment{};
+        segment.reserve(size_t{width} * rows.RowCount / 2);
+        JpegBitWriter writer{segment};
+
+        // The samples of one MCU, level shifted, with the pixels past the right and bottom edges
+        // repeating the last column and row.
+        std::array<float, 256> y{};
+        std::array<float, 256> cb{};
+        std::array<float, 256> cr{};
+        std::array<float, 64> block{};
+        int previousY{};
+        int previousCb{};
+        int previousCr{};
+        for (uint32_t top = rows.FirstRow; top < rows.FirstRow + rows.RowCount; top += mcuSize)
+        {
+            for (uint32_t left = 0; left < width; left += mcuSize)
+            {
+                for (uint32_t j = 0; j < mcuSize; ++j)
+                {
+                    const uint32_t row{std::min(top + j, height - 1)};
+                    const auto* source{reinterpret_cast<const uint8_t*>(pixels) + size_t{options.FlipY ? height - 1 - row : row} * width * BYTES_PER_PIXEL};
+                    for (uint32_t i = 0; i < mcuSize; ++i)
+                    {
+                        const auto* pixel{source + size_t{std::min(left + i, width - 1)} * BYTES_PER_PIXEL};
+                        float r{static_cast<float>(pixel[0])};
+                        float g{static_cast<float>(pixel[1])};
+                        float b{static_cast<float>(pixel[2])};
+                        if (pixel[3] != 255)
+                        {
+                            const float alpha{pixel[3] / 255.0f};
+                            r *= alpha;
+                            g *= alpha;
+                            b *= alpha;
+                        }
+                        const size_t index{j * mcuSize + i};
+                        y[index] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+                        cb[index] = -0.168736f * r - 0.331264f * g + 0.5f * b;
+                        cr[index] = 0.5f * r - 0.418688f * g - 0.081312f * b;
+                    }
+                }
+
+                if (!subsample)
+                {
+                    std::copy_n(y.begin(), 64, block.begin());
+                    EncodeBlock(writer, block, luminance, previousY, huffman.LuminanceDc, huffman.LuminanceAc);
+                    std::copy_n(cb.begin(), 64, block.begin());
+                    EncodeBlock(writer, block, chrominance, previousCb, huffman.ChrominanceDc, huffman.ChrominanceAc);
+                    std::copy_n(cr.begin(), 64, block.begin());
+                    EncodeBlock(writer, block, chrominance, previousCr, huffman.ChrominanceDc, huffman.ChrominanceAc);
+                    continue;
+                }
+
+                for (const auto& [blockX, blockY] : {std::pair{0u, 0u}, std::pair{8u, 0u}, std::pair{0u, 8u}, std::pair{8u, 8u}})
+                {
+                    for (size_t j = 0; j < 8; ++j)
+                    {
+                        std::copy_n(y.begin() + (blockY + j) * 16 + blockX, 8, block.begin() + j * 8);
+                    }
+                    EncodeBlock(writer, block, luminance, previousY, huffman.LuminanceDc, huffman.LuminanceAc);
+                }
+                for (auto* chroma : {&cb, &cr})
+                {
+                    for (size_t j = 0; j < 8; ++j)
+                    {
+                        for (size_t i = 0; i < 8; ++i)
+                        {
+                            const size_t index{j * 32 + i * 2};
+                            block[j * 8 + i] = ((*chroma)[index] + (*chroma)[index + 1] + (*chroma)[index + 16] + (*chroma)[index + 17]) * 0.25f;
+                        }
+                    }
+                    EncodeBlock(writer, block, chrominance, chroma == &cb ? previousCb : previousCr, huffman.ChrominanceDc, huffman.ChrominanceAc);
+                }
+            }
+        }
+        writer.Flush();
+
+        if (rows.FirstRow + rows.RowCount < height)
+        {
+            const uint32_t index{rows.FirstRow / RowsPerRange(width, options)};
+            AppendMarker(segment, static_cast<uint8_t>(0xD0 + index % 8));
+        }
+        return segment;
+    }
+
+    std::vector<std::byte> Assemble(uint32_t width, uint32_t height, const Options& options, const std::vector<std::vector<std::byte>>& segments)
+    {
+        const bool subsample{SubsampleChroma(options)};
+        const uint32_t mcuSize{subsample ? 16u : 8u};
+
+        size_t size{1024};
+        for (const auto& segment : segments)
+        {
+            size += segment.size();
+        }
+        std::vector<std::byte> jpeg{};
+        jpeg.reserve(size);
+
+        // Start of image, and a JFIF header with a square pixel aspect ratio.
+        AppendMarker(jpeg, 0xD8);
+        AppendMarker(jpeg, 0xE0);
+        AppendBigEndian16(jpeg, 16);
+        AppendBytes(jpeg, {'J', 'F', 'I', 'F', 0, 1, 1, 0});
+        AppendBigEndian16(jpeg, 1);
+        AppendBigEndian16(jpeg, 1);
+        AppendBytes(jpeg, {0, 0});
+
+        AppendMarker(jpeg, 0xDB);
+        AppendBigEndian16(jpeg, 2 + 2 * 65);
+        for (const auto& [id, base] : {std::pair{0, &LUMINANCE_QUANTIZATION}, std::pair{1, &CHROMINANCE_QUANTIZATION}})
+        {
+            const Quantization quantization{*base, options.Quality};
+            jpeg.push_back(static_cast<std::byte>(id));
+            for (const auto natural : ZIGZAG)
+            {
+                jpeg.push_back(static_cast<std::byte>(quantization.Table[natural]));
+            }
+        }
+
+        // Baseline, 8 bits, Y with the luminance table and Cb and Cr with the chrominance one.
+        AppendMarker(jpeg, 0xC0);
+        AppendBigEndian16(jpeg, 8 + 3 * 3);
+        jpeg.push_back(std::byte{8});
+        AppendBigEndian16(jpeg, height);
+        AppendBigEndian16(jpeg, width);
+        AppendBytes(jpeg, {3, 1, static_cast<uint8_t>(subsample ? 0x22 : 0x11), 0, 2, 0x11, 1, 3, 0x11, 1});
+
+        AppendMarker(jpeg, 0xC4);
+        size_t huffmanLength{2};
+        for (const auto* specification : {&LuminanceDc(), &LuminanceAc(), &ChrominanceDc(), &ChrominanceAc()})
+        {
+            huffmanLength += 1 + 16 + specification->Symbols.size();
+        }
+        AppendBigEndian16(jpeg, huffmanLength);
+        for (const auto& [classAndId, specification] : {std::pair{0x00, &LuminanceDc()}, std::pair{0x10, &LuminanceAc()}, std::pair{0x01, &ChrominanceDc()}, std::pair{0x11, &ChrominanceAc()}})
+        {
+            jpeg.push_back(static_cast<std::byte>(classAndId));
+            for (const auto count : specification->Counts)
+            {
+                jpeg.push_back(static_cast<std::byte>(count));
+            }
+            for (const auto symbol : specification->Symbols)
+            {
+                jpeg.push_back(static_cast<std::byte>(symbol));
+            }
+        }
+
+        if (segments.size() > 1)
+        {
+            AppendMarker(jpeg, 0xDD);
+            AppendBigEndian16(jpeg, 4);
+            AppendBigEndian16(jpeg, size_t{(width + mcuSize - 1) / mcuSize} * (RowsPerRange(width, options) / mcuSize));
+        }
+
+        AppendMarker(jpeg, 0xDA);
+        AppendBigEndian16(jpeg, 6 + 2 * 3);
+        AppendBytes(jpeg, {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0});
+
+        for (const auto& segment : segments)
+        {
+            jpeg.insert(jpeg.end(), segment.begin(), segment.end());
+        }
+
+        AppendMarker(jpeg, 0xD9);
+        return jpeg;
+    }
+
+    std::vector<std::byte> Encode(const std::byte* pixels, uint32_t width, uint32_t height, const Options& options)
+    {
+        Validate(width, height, options);
+
+        std::vector<std::vector<std::byte>> segments{};
+        for (const auto rows : SplitRows(width, height, options))
+        {
+            segments.push_back(EncodeRows(pixels, width, height, rows, options));
+        }
+        return Assemble(width, height, options, segments);
+    }
+}
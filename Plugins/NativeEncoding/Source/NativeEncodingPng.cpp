@@ -0,0 +1,351 @@
+#include <Babylon/Plugins/NativeEncodingInternal.h>
+
+#include <miniz.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    using namespace Babylon::Plugins::NativeEncoding;
+    using namespace Babylon::Plugins::NativeEncoding::Png;
+
+    constexpr size_t BYTES_PER_PIXEL{4};
+
+    // About 1 MB of filtered rows per range: enough for matches and Huffman tables to pay off,
+    // and a 4K frame still splits into a few dozen ranges for the thread pool.
+    constexpr size_t RANGE_BYTES{1 << 20};
+
+    // Largest stored block of RFC 1951.
+    constexpr size_t MAX_STORED{65535};
+
+    constexpr uint32_t ADLER_MODULO{65521};
+
+    // The Adler-32 of two byte sequences one after the other, as zlib's adler32_combine.
+    uint32_t CombineAdler32(uint32_t first, uint32_t second, size_t secondSize)
+    {
+        const uint32_t remainder{static_cast<uint32_t>(secondSize % ADLER_MODULO)};
+        uint32_t a{first & 0xFFFF};
+        uint32_t b{static_cast<uint32_t>((uint64_t{remainder} * a) % ADLER_MODULO)};
+        a += (second & 0xFFFF) + ADLER_MODULO - 1;
+        b += (first >> 16) + (second >> 16) + ADLER_MODULO - remainder;
+        if (a >= ADLER_MODULO)
+        {
+            a -= ADLER_MODULO;
+        }
+        if (a >= ADLER_MODULO)
+        {
+            a -= ADLER_MODULO;
+        }
+        if (b >= ADLER_MODULO * 2)
+        {
+            b -= ADLER_MODULO * 2;
+        }
+        if (b >= ADLER_MODULO)
+        {
+            b -= ADLER_MODULO;
+        }
+        return a | (b << 16);
+    }
+
+    void AppendBigEndian(std::vector<std::byte>& output, uint32_t value)
+    {
+        output.push_back(static_cast<std::byte>(value >> 24));
+        output.push_back(static_cast<std::byte>(value >> 16));
+        output.push_back(static_cast<std::byte>(value >> 8));
+        output.push_back(static_cast<std::byte>(value));
+    }
+
+    void AppendChunk(std::vector<std::byte>& output, const char (&type)[5], const std::vector<std::byte>& data)
+    {
+        AppendBigEndian(output, static_cast<uint32_t>(data.size()));
+        const size_t typeOffset{output.size()};
+        for (size_t i = 0; i < 4; ++i)
+        {
+            output.push_back(static_cast<std::byte>(type[i]));
+        }
+        output.insert(output.end(), data.begin(), data.end());
+        AppendBigEndian(output, static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const uint8_t*>(output.data() + typeOffset), output.size() - typeOffset)));
+    }
+
+    // Deflates `data` with miniz as a continuation of a zlib stream. Unless `final`, it ends with
+    // a sync flush, an empty stored block, so that the next range starts on a byte boundary with
+    // no history and can be deflated concurrently.
+    void Deflate(std::vector<std::byte>& output, const uint8_t* data, size_t size, int level, bool final)
+    {
+        // A few hundred KB, too large for the stack of a thread pool thread.
+        const auto compressor{std::make_unique<tdefl_compressor>()};
+        const auto append = [](const void* buffer, int length, void* user) -> mz_bool {
+            auto& chunk{*static_cast<std::vector<std::byte>*>(user)};
+            const auto* bytes{static_cast<const std::byte*>(buffer)};
+            chunk.insert(chunk.end(), bytes, bytes + length);
+            return MZ_TRUE;
+        };
+
+        // Negative window bits for raw deflate: the zlib header and Adler-32 go around the ranges.
+        const auto flags{static_cast<int>(tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY))};
+        if (tdefl_init(compressor.get(), append, &output, flags) != TDEFL_STATUS_OKAY ||
+            tdefl_compress_buffer(compressor.get(), data, size, final ? TDEFL_FINISH : TDEFL_SYNC_FLUSH) != (final ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY))
+        {
+            throw std::runtime_error("PNG: deflate failed.");
+        }
+    }
+
+    enum class Filter : uint8_t
+    {
+        None,
+        Sub,
+        Up,
+        Average,
+        Paeth,
+    };
+
+    // The neighbour closest to left + above - aboveLeft, with ties going to left, then above.
+    // Written without early returns so that it compiles to conditional moves.
+    uint8_t PaethPredictor(uint8_t left, uint8_t above, uint8_t aboveLeft)
+    {
+        const int toLeft{std::abs(above - aboveLeft)};
+        const int toAbove{std::abs(left - aboveLeft)};
+        const int toAboveLeft{std::abs(left + above - 2 * aboveLeft)};
+        const uint8_t nearest{toAbove <= toAboveLeft ? above : aboveLeft};
+        return toLeft <= toAbove && toLeft <= toAboveLeft ? left : nearest;
+    }
+
+    // Writes the filter type and the filtered row to `output`. `above` is all zeros for the first
+    // row.
+    void FilterRow(Filter filter, const uint8_t* row, const uint8_t* above, size_t size, uint8_t* output)
+    {
+        *output++ = static_cast<uint8_t>(filter);
+        switch (filter)
+        {
+            case Filter::None:
+                std::memcpy(output, row, size);
+                break;
+            case Filter::Sub:
+                std::memcpy(output, row, BYTES_PER_PIXEL);
+                for (size_t i = BYTES_PER_PIXEL; i < size; ++i)
+                {
+                    output[i] = static_cast<uint8_t>(row[i] - row[i - BYTES_PER_PIXEL]);
+                }
+                break;
+            case Filter::Up:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    output[i] = static_cast<uint8_t>(row[i] - above[i]);
+                }
+                break;
+            case Filter::Average:
+                for (size_t i = 0; i < BYTES_PER_PIXEL; ++i)
+                {
+                    output[i] = static_cast<uint8_t>(row[i] - (above[i] >> 1));
+                }
+                for (size_t i = BYTES_PER_PIXEL; i < size; ++i)
+                {
+                    output[i] = static_cast<uint8_t>(row[i] - ((row[i - BYTES_PER_PIXEL] + above[i]) >> 1));
+                }
+                break;
+            case Filter::Paeth:
+                for (size_t i = 0; i < BYTES_PER_PIXEL; ++i)
+                {
+                    output[i] = static_cast<uint8_t>(row[i] - above[i]);
+                }
+                for (size_t i = BYTES_PER_PIXEL; i < size; ++i)
+                {
+                    output[i] = static_cast<uint8_t>(row[i] - PaethPredictor(row[i - BYTES_PER_PIXEL], above[i], above[i - BYTES_PER_PIXEL]));
+                }
+                break;
+        }
+    }
+
+    // The sum of the filtered bytes as signed values, the usual estimate of how well a row will
+    // compress.
+    uint64_t FilteredCost(const uint8_t* filtered, size_t size)
+    {
+        uint64_t cost{};
+        for (size_t i = 0; i < size; ++i)
+        {
+            cost += static_cast<uint64_t>(std::abs(static_cast<int8_t>(filtered[i])));
+        }
+        return cost;
+    }
+
+    uint8_t ZlibFlags(int level)
+    {
+        // FLEVEL in the top two bits, and a check value making the header a multiple of 31.
+        if (level <= 1)
+        {
+            return 0x01;
+        }
+        if (level <= 5)
+        {
+            return 0x5E;
+        }
+        return level == 6 ? 0x9C : 0xDA;
+    }
+}
+
+namespace Babylon::Plugins::NativeEncoding::Png
+{
+    void Validate(uint32_t width, uint32_t height, const Options& options)
+    {
+        if (width == 0 || height == 0)
+        {
+            throw std::invalid_argument("PNG: the image must not be empty, got " + std::to_string(width) + " x " + std::to_string(height) + ".");
+        }
+        // PNG dimensions are at most 2^31 - 1, and the rows are indexed with size_t.
+        if (width > (1u << 30) / BYTES_PER_PIXEL || height > (1u << 31) - 1)
+        {
+            throw std::invalid_argument("PNG: the image is too large, got " + std::to_string(width) + " x " + std::to_string(height) + ".");
+        }
+        if (options.CompressionLevel < MIN_COMPRESSION_LEVEL || options.CompressionLevel > MAX_COMPRESSION_LEVEL)
+        {
+            throw std::invalid_argument("PNG: compression level must be in [0, 10], got " + std::to_string(options.CompressionLevel) + ".");
+        }
+    }
+
+    std::vector<RowRange> SplitRows(uint32_t width, uint32_t height)
+    {
+        const size_t rowSize{1 + size_t{width} * BYTES_PER_PIXEL};
+        const uint32_t rowsPerRange{static_cast<uint32_t>(std::clamp<size_t>(RANGE_BYTES / rowSize, 1, height))};
+
+        std::vector<RowRange> ranges{};
+        ranges.reserve((height + rowsPerRange - 1) / rowsPerRange);
+        for (uint32_t row = 0; row < height; row += rowsPerRange)
+        {
+            ranges.push_back({row, std::min(rowsPerRange, height - row)});
+        }
+        return ranges;
+    }
+
+    EncodedRows EncodeRows(const std::byte* pixels, uint32_t width, uint32_t height, RowRange rows, const Options& options)
+    {
+        const size_t rowBytes{size_t{width} * BYTES_PER_PIXEL};
+        const auto sourceRow = [&](uint32_t row) {
+            return reinterpret_cast<const uint8_t*>(pixels) + (options.FlipY ? height - 1 - row : row) * rowBytes;
+        };
+
+        std::vector<uint8_t> filtered((rowBytes + 1) * rows.RowCount);
+        const std::vector<uint8_t> zeros(options.CompressionLevel >= 1 && rows.FirstRow == 0 ? rowBytes : 0);
+        std::vector<uint8_t> candidate(options.CompressionLevel >= 2 ? rowBytes + 1 : 0);
+        for (uint32_t i = 0; i < rows.RowCount; ++i)
+        {
+            const uint32_t row{rows.FirstRow + i};
+            const uint8_t* above{row == 0 ? zeros.data() : sourceRow(row - 1)};
+            uint8_t* output{filtered.data() + i * (rowBytes + 1)};
+            if (options.CompressionLevel == 0)
+            {
+                FilterRow(Filter::None, sourceRow(row), above, rowBytes, output);
+            }
+            else if (options.CompressionLevel == 1)
+            {
+                FilterRow(Filter::Sub, sourceRow(row), above, rowBytes, output);
+            }
+            else
+            {
+                // Every filter, keeping the one with the smallest cost.
+                uint64_t bestCost{UINT64_MAX};
+                for (const auto filter : {Filter::None, Filter::Sub, Filter::Up, Filter::Average, Filter::Paeth})
+                {
+                    FilterRow(filter, sourceRow(row), above, rowBytes, candidate.data());
+                    const uint64_t cost{FilteredCost(candidate.data() + 1, rowBytes)};
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        std::memcpy(output, candidate.data(), rowBytes + 1);
+                    }
+                }
+            }
+        }
+
+        EncodedRows encoded{};
+        encoded.Adler = static_cast<uint32_t>(mz_adler32(MZ_ADLER32_INIT, filtered.data(), filtered.size()));
+        encoded.FilteredSize = filtered.size();
+
+        // Reserve for storing, or for compressing to half, and fill in the length and CRC of the
+        // chunk around the deflated data afterwards.
+        auto& chunk{encoded.Chunk};
+        chunk.reserve(options.CompressionLevel == 0 ? filtered.size() + filtered.size() / MAX_STORED * 5 + 32 : filtered.size() / 2);
+        chunk.resize(4);
+        for (const char letter : {'I', 'D', 'A', 'T'})
+        {
+            chunk.push_back(static_cast<std::byte>(letter));
+        }
+        if (rows.FirstRow == 0)
+        {
+            chunk.push_back(std::byte{0x78});
+            chunk.push_back(static_cast<std::byte>(ZlibFlags(options.CompressionLevel)));
+        }
+
+        Deflate(chunk, filtered.data(), filtered.size(), options.CompressionLevel, rows.FirstRow + rows.RowCount == height);
+
+        const uint32_t length{static_cast<uint32_t>(chunk.size() - 8)};
+        for (size_t i = 0; i < 4; ++i)
+        {
+            chunk[i] = static_cast<std::byte>(length >> (24 - 8 * i));
+        }
+        AppendBigEndian(chunk, static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const uint8_t*>(chunk.data() + 4), chunk.size() - 4)));
+        return encoded;
+    }
+
+    std::vector<std::byte> Assemble(uint32_t width, uint32_t height, const std::vector<EncodedRows>& ranges)
+    {
+        constexpr std::array<uint8_t, 8> SIGNATURE{137, 80, 78, 71, 13, 10, 26, 10};
+        constexpr size_t CHUNK_OVERHEAD{12};
+        constexpr size_t HEADER_SIZE{13};
+
+        size_t size{SIGNATURE.size() + CHUNK_OVERHEAD + HEADER_SIZE + (CHUNK_OVERHEAD + 4) + CHUNK_OVERHEAD};
+        uint32_t adler{1};
+        for (const auto& range : ranges)
+        {
+            size += range.Chunk.size();
+            adler = CombineAdler32(adler, range.Adler, range.FilteredSize);
+        }
+
+        std::vector<std::byte> png{};
+        png.reserve(size);
+        for (const auto byte : SIGNATURE)
+        {
+            png.push_back(static_cast<std::byte>(byte));
+        }
+
+        // 8 bits per channel, RGBA, deflate, adaptive filtering, not interlaced.
+        std::vector<std::byte> header{};
+        AppendBigEndian(header, width);
+        AppendBigEndian(header, height);
+        for (const uint8_t field : {8, 6, 0, 0, 0})
+        {
+            header.push_back(static_cast<std::byte>(field));
+        }
+        AppendChunk(png, "IHDR", header);
+
+        for (const auto& range : ranges)
+        {
+            png.insert(png.end(), range.Chunk.begin(), range.Chunk.end());
+        }
+
+        // The zlib stream ends with the Adler-32 of all filtered rows, in a chunk of its own
+        // since only it depends on every range.
+        std::vector<std::byte> trailer{};
+        AppendBigEndian(trailer, adler);
+        AppendChunk(png, "IDAT", trailer);
+        AppendChunk(png, "IEND", {});
+        return png;
+    }
+
+    std::vector<std::byte> Encode(const std::byte* pixels, uint32_t width, uint32_t height, const Options& options)
+    {
+        Validate(width, height, options);
+
+        std::vector<EncodedRows> ranges{};
+        for (const auto rows : SplitRows(width, height))
+        {
+            ranges.push_back(EncodeRows(pixels, width, height, rows, options));
+        }
+        return Assemble(width, height, ranges);
+    }
+}
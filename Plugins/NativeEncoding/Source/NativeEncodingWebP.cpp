@@ -0,0 +1,555 @@
+#include <Babylon/Plugins/NativeEncodingInternal.h>
+
+#include "Huffman.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    using namespace Babylon::Plugins::NativeEncoding;
+    using namespace Babylon::Plugins::NativeEncoding::WebP;
+
+    constexpr size_t BYTES_PER_PIXEL{4};
+
+    // Limits of the lossless bitstream, from the WebP lossless bitstream specification.
+    constexpr uint32_t MAX_SIZE{16384};
+    constexpr size_t MAX_LENGTH{4096};
+    constexpr size_t LITERAL_SYMBOLS{256};
+    constexpr size_t GREEN_SYMBOLS{LITERAL_SYMBOLS + 24};
+    constexpr size_t DISTANCE_SYMBOLS{40};
+    constexpr uint32_t MAX_CODE_LENGTH{15};
+    constexpr std::array<uint8_t, CodeLengths::SYMBOLS> CODE_LENGTH_ORDER{17, 18, 0, 1, 2, 3, 4, 5, 16, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+    // Distance codes up to 120 stand for nearby pixels in two dimensions. Only the two used
+    // most often are emitted: 1 for the pixel above and 2 for the one to the left.
+    constexpr uint32_t ABOVE_CODE{1};
+    constexpr uint32_t LEFT_CODE{2};
+    constexpr uint32_t PLANE_CODES{120};
+
+    enum class Transform : uint32_t
+    {
+        Predictor = 0,
+        SubtractGreen = 2,
+    };
+
+    // The predictor is chosen per 16 x 16 tile.
+    constexpr uint32_t TILE_BITS{4};
+    constexpr uint32_t PREDICTOR_MODES{14};
+
+    constexpr size_t MIN_MATCH{3};
+    constexpr size_t HASH_BITS{18};
+    constexpr uint32_t MAX_CHAIN{16};
+    constexpr size_t WINDOW_SIZE{(size_t{1} << 20) - PLANE_CODES};
+
+    // ARGB, as the bitstream orders the channels of a pixel.
+    uint32_t ToArgb(const uint8_t* pixel)
+    {
+        return (uint32_t{pixel[3]} << 24) | (uint32_t{pixel[0]} << 16) | (uint32_t{pixel[1]} << 8) | pixel[2];
+    }
+
+    uint32_t Channel(uint32_t argb, uint32_t shift)
+    {
+        return (argb >> shift) & 0xFF;
+    }
+
+    // Per channel arithmetic on ARGB pixels, as libwebp does it.
+    uint32_t Subtract(uint32_t a, uint32_t b)
+    {
+        const uint32_t alphaGreen{0x00FF00FFu + (a & 0xFF00FF00u) - (b & 0xFF00FF00u)};
+        const uint32_t redBlue{0xFF00FF00u + (a & 0x00FF00FFu) - (b & 0x00FF00FFu)};
+        return (alphaGreen & 0xFF00FF00u) | (redBlue & 0x00FF00FFu);
+    }
+
+    uint32_t Average(uint32_t a, uint32_t b)
+    {
+        return (((a ^ b) & 0xFEFEFEFEu) >> 1) + (a & b);
+    }
+
+    uint32_t Select(uint32_t left, uint32_t top, uint32_t topLeft)
+    {
+        int leftDistance{};
+        int topDistance{};
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            leftDistance += std::abs(static_cast<int>(Channel(top, shift)) - static_cast<int>(Channel(topLeft, shift)));
+            topDistance += std::abs(static_cast<int>(Channel(left, shift)) - static_cast<int>(Channel(topLeft, shift)));
+        }
+        return leftDistance < topDistance ? left : top;
+    }
+
+    uint32_t ClampAddSubtractFull(uint32_t a, uint32_t b, uint32_t c)
+    {
+        uint32_t result{};
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            const int value{static_cast<int>(Channel(a, shift)) + static_cast<int>(Channel(b, shift)) - static_cast<int>(Channel(c, shift))};
+            result |= static_cast<uint32_t>(std::clamp(value, 0, 255)) << shift;
+        }
+        return result;
+    }
+
+    uint32_t ClampAddSubtractHalf(uint32_t a, uint32_t b)
+    {
+        uint32_t result{};
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            const int value{static_cast<int>(Channel(a, shift))};
+            result |= static_cast<uint32_t>(std::clamp(value + (value - static_cast<int>(Channel(b, shift))) / 2, 0, 255)) << shift;
+        }
+        return result;
+    }
+
+    uint32_t Predict(uint32_t mode, uint32_t left, uint32_t top, uint32_t topRight, uint32_t topLeft)
+    {
+        switch (mode)
+        {
+            case 0:
+                return 0xFF000000u;
+            case 1:
+                return left;
+            case 2:
+                return top;
+            case 3:
+                return topRight;
+            case 4:
+                return topLeft;
+            case 5:
+                return Average(Average(left, topRight), top);
+            case 6:
+                return Average(left, topLeft);
+            case 7:
+                return Average(left, top);
+            case 8:
+                return Average(topLeft, top);
+            case 9:
+                return Average(top, topRight);
+            case 10:
+                return Average(Average(left, topLeft), Average(top, topRight));
+            case 11:
+                return Select(left, top, topLeft);
+            case 12:
+                return ClampAddSubtractFull(left, top, topLeft);
+            default:
+                return ClampAddSubtractHalf(Average(left, top), topLeft);
+        }
+    }
+
+    // How far a residual is from zero, with each channel taken as signed.
+    uint32_t Cost(uint32_t residual)
+    {
+        uint32_t cost{};
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            cost += static_cast<uint32_t>(std::abs(static_cast<int8_t>(Channel(residual, shift))));
+        }
+        return cost;
+    }
+
+    // Replaces the pixels with their residuals from the predictor of their tile, and returns the
+    // predictor of each tile, in its green channel as the bitstream stores it.
+    std::vector<uint32_t> ApplyPredictor(std::vector<uint32_t>& pixels, uint32_t width, uint32_t height)
+    {
+        const uint32_t tileSize{1u << TILE_BITS};
+        const uint32_t tilesX{(width + tileSize - 1) >> TILE_BITS};
+        const uint32_t tilesY{(height + tileSize - 1) >> TILE_BITS};
+
+        // The top-left pixel always predicts black, the rest of the top row the pixel to the
+        // left and the rest of the left column the pixel above.
+        const auto prediction = [&](uint32_t mode, uint32_t x, uint32_t y) {
+            const size_t i{size_t{y} * width + x};
+            if (y == 0)
+            {
+                return x == 0 ? 0xFF000000u : pixels[i - 1];
+            }
+            if (x == 0)
+            {
+                return pixels[i - width];
+            }
+            // The top right pixel of the last column wraps to the first pixel of the row.
+            return Predict(mode, pixels[i - 1], pixels[i - width], pixels[i - width + 1], pixels[i - width - 1]);
+        };
+
+        std::vector<uint32_t> modes(size_t{tilesX} * tilesY);
+        for (uint32_t tileY = 0; tileY < tilesY; ++tileY)
+        {
+            for (uint32_t tileX = 0; tileX < tilesX; ++tileX)
+            {
+                const uint32_t left{tileX << TILE_BITS};
+                const uint32_t top{tileY << TILE_BITS};
+                const uint32_t right{std::min(left + tileSize, width)};
+                const uint32_t bottom{std::min(top + tileSize, height)};
+
+                std::array<uint32_t, PREDICTOR_MODES> costs{};
+                for (uint32_t y = std::max(top, 1u); y < bottom; ++y)
+                {
+                    for (uint32_t x = std::max(left, 1u); x < right; ++x)
+                    {
+                        const uint32_t pixel{pixels[size_t{y} * width + x]};
+                        for (uint32_t mode = 0; mode < PREDICTOR_MODES; ++mode)
+                        {
+                            costs[mode] += Cost(Subtract(pixel, prediction(mode, x, y)));
+                        }
+                    }
+                }
+                modes[size_t{tileY} * tilesX + tileX] = static_cast<uint32_t>(std::min_element(costs.begin(), costs.end()) - costs.begin());
+            }
+        }
+
+        // Bottom up, so that the pixels that predict a row are still the original ones.
+        for (uint32_t y = height; y-- > 0;)
+        {
+            for (uint32_t x = width; x-- > 0;)
+            {
+                const uint32_t mode{modes[size_t{y >> TILE_BITS} * tilesX + (x >> TILE_BITS)]};
+                const size_t i{size_t{y} * width + x};
+                pixels[i] = Subtract(pixels[i], prediction(mode, x, y));
+            }
+        }
+
+        for (auto& mode : modes)
+        {
+            mode <<= 8;
+        }
+        return modes;
+    }
+
+    // A pixel, or a copy of `Length` pixels from `Distance` pixels back.
+    struct Token
+    {
+        uint32_t Pixel{};
+        uint32_t Length{};
+        uint32_t Distance{};
+    };
+
+    size_t MatchLength(const std::vector<uint32_t>& pixels, size_t position, size_t distance, size_t maxLength)
+    {
+        size_t length{};
+        while (length < maxLength && pixels[position + length] == pixels[position + length - distance])
+        {
+            ++length;
+        }
+        return length;
+    }
+
+    // Greedy backward references, trying the pixels to the left and above before the earlier
+    // positions with the same next two pixels.
+    std::vector<Token> FindMatches(const std::vector<uint32_t>& pixels, uint32_t width)
+    {
+        const size_t count{pixels.size()};
+        std::vector<uint32_t> head(size_t{1} << HASH_BITS, UINT32_MAX);
+        std::vector<uint32_t> previous(count, UINT32_MAX);
+        const auto insert = [&](size_t position) {
+            if (position + 1 < count)
+            {
+                const uint32_t hash{(pixels[position] * 0x1E35A7BDu + pixels[position + 1] * 0x9E3779B1u) >> (32 - HASH_BITS)};
+                previous[position] = head[hash];
+                head[hash] = static_cast<uint32_t>(position);
+                return hash;
+            }
+            return UINT32_MAX;
+        };
+
+        std::vector<Token> tokens{};
+        tokens.reserve(count / 2);
+        for (size_t position = 0; position < count;)
+        {
+            const size_t maxLength{std::min(MAX_LENGTH, count - position)};
+            size_t bestLength{};
+            size_t bestDistance{};
+            for (const size_t distance : {size_t{1}, size_t{width}})
+            {
+                if (distance <= position)
+                {
+                    const size_t length{MatchLength(pixels, position, distance, maxLength)};
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = distance;
+                    }
+                }
+            }
+
+            const uint32_t hash{insert(position)};
+            if (hash != UINT32_MAX && bestLength < maxLength)
+            {
+                uint32_t chain{MAX_CHAIN};
+                for (uint32_t candidate = previous[position]; candidate != UINT32_MAX && chain > 0; candidate = previous[candidate], --chain)
+                {
+                    const size_t distance{position - candidate};
+                    if (distance > WINDOW_SIZE)
+                    {
+                        break;
+                    }
+                    if (pixels[candidate + bestLength] != pixels[position + bestLength])
+                    {
+                        continue;
+                    }
+                    const size_t length{MatchLength(pixels, position, distance, maxLength)};
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = distance;
+                        if (length == maxLength)
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if (bestLength >= MIN_MATCH)
+            {
+                tokens.push_back({0, static_cast<uint32_t>(bestLength), static_cast<uint32_t>(bestDistance)});
+                for (size_t i = 1; i < bestLength; ++i)
+                {
+                    insert(position + i);
+                }
+                position += bestLength;
+            }
+            else
+            {
+                tokens.push_back({pixels[position], 0, 0});
+                ++position;
+            }
+        }
+        return tokens;
+    }
+
+    // Lengths and distance codes are written as a prefix symbol and extra bits.
+    struct Prefix
+    {
+        uint32_t Symbol;
+        uint32_t ExtraBits;
+        uint32_t Extra;
+    };
+
+    Prefix ToPrefix(uint32_t value)
+    {
+        const uint32_t x{value - 1};
+        if (x < 4)
+        {
+            return {x, 0, 0};
+        }
+        uint32_t highest{};
+        while ((x >> (highest + 1)) != 0)
+        {
+            ++highest;
+        }
+        const uint32_t second{(x >> (highest - 1)) & 1};
+        return {2 * highest + second, highest - 1, x & ((1u << (highest - 1)) - 1)};
+    }
+
+    uint32_t DistanceCode(uint32_t distance, uint32_t width)
+    {
+        if (distance == width)
+        {
+            return ABOVE_CODE;
+        }
+        return distance == 1 ? LEFT_CODE : distance + PLANE_CODES;
+    }
+
+    // The five codes of a group: green with the length prefixes, red, blue, alpha and distance.
+    struct Codes
+    {
+        Huffman<GREEN_SYMBOLS> Green{};
+        Huffman<LITERAL_SYMBOLS> Red{};
+        Huffman<LITERAL_SYMBOLS> Blue{};
+        Huffman<LITERAL_SYMBOLS> Alpha{};
+        Huffman<DISTANCE_SYMBOLS> Distance{};
+    };
+
+    template<size_t SymbolCount>
+    void WriteCode(BitWriter& writer, Huffman<SymbolCount>& code)
+    {
+        // A code of a single literal is written as a simple code, and reading it takes no bits.
+        const auto used{std::find_if(code.Frequencies.begin(), code.Frequencies.end(), [](uint32_t frequency) { return frequency > 0; })};
+        const size_t symbol{used == code.Frequencies.end() ? 0 : static_cast<size_t>(used - code.Frequencies.begin())};
+        if (code.UsedSymbols() <= 1 && symbol < LITERAL_SYMBOLS)
+        {
+            code.Lengths.fill(0);
+            writer.Write(1, 1);
+            writer.Write(0, 1);
+            if (symbol < 2)
+            {
+                writer.Write(0, 1);
+                writer.Write(static_cast<uint32_t>(symbol), 1);
+            }
+            else
+            {
+                writer.Write(1, 1);
+                writer.Write(static_cast<uint32_t>(symbol), 8);
+            }
+            return;
+        }
+
+        code.Build(MAX_CODE_LENGTH);
+        writer.Write(0, 1);
+        const CodeLengths codeLengths{code.Lengths.data(), SymbolCount};
+        const size_t orderCount{codeLengths.OrderCount(CODE_LENGTH_ORDER, 4)};
+        writer.Write(static_cast<uint32_t>(orderCount - 4), 4);
+        for (size_t i = 0; i < orderCount; ++i)
+        {
+            writer.Write(codeLengths.Code().Lengths[CODE_LENGTH_ORDER[i]], 3);
+        }
+        // The lengths of all symbols follow.
+        writer.Write(0, 1);
+        codeLengths.Write(writer);
+    }
+
+    void CountLiteral(Codes& codes, uint32_t pixel)
+    {
+        ++codes.Green.Frequencies[Channel(pixel, 8)];
+        ++codes.Red.Frequencies[Channel(pixel, 16)];
+        ++codes.Blue.Frequencies[Channel(pixel, 0)];
+        ++codes.Alpha.Frequencies[Channel(pixel, 24)];
+    }
+
+    void WriteLiteral(BitWriter& writer, const Codes& codes, uint32_t pixel)
+    {
+        codes.Green.Write(writer, Channel(pixel, 8));
+        codes.Red.Write(writer, Channel(pixel, 16));
+        codes.Blue.Write(writer, Channel(pixel, 0));
+        codes.Alpha.Write(writer, Channel(pixel, 24));
+    }
+
+    // The codes and pixels of an image without a color cache or further prefix code groups.
+    void WriteImage(BitWriter& writer, const std::vector<Token>& tokens, uint32_t width)
+    {
+        Codes codes{};
+        for (const auto& token : tokens)
+        {
+            if (token.Length == 0)
+            {
+                CountLiteral(codes, token.Pixel);
+            }
+            else
+            {
+                ++codes.Green.Frequencies[LITERAL_SYMBOLS + ToPrefix(token.Length).Symbol];
+                ++codes.Distance.Frequencies[ToPrefix(DistanceCode(token.Distance, width)).Symbol];
+            }
+        }
+
+        WriteCode(writer, codes.Green);
+        WriteCode(writer, codes.Red);
+        WriteCode(writer, codes.Blue);
+        WriteCode(writer, codes.Alpha);
+        WriteCode(writer, codes.Distance);
+
+        for (const auto& token : tokens)
+        {
+            if (token.Length == 0)
+            {
+                WriteLiteral(writer, codes, token.Pixel);
+                continue;
+            }
+            const Prefix length{ToPrefix(token.Length)};
+            codes.Green.Write(writer, LITERAL_SYMBOLS + length.Symbol);
+            writer.Write(length.Extra, length.ExtraBits);
+            const Prefix distance{ToPrefix(DistanceCode(token.Distance, width))};
+            codes.Distance.Write(writer, distance.Symbol);
+            writer.Write(distance.Extra, distance.ExtraBits);
+        }
+    }
+
+    void AppendLittleEndian32(std::vector<std::byte>& output, size_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            output.push_back(static_cast<std::byte>(value >> (i * 8)));
+        }
+    }
+
+    void AppendTag(std::vector<std::byte>& output, const char (&tag)[5])
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            output.push_back(static_cast<std::byte>(tag[i]));
+        }
+    }
+}
+
+namespace Babylon::Plugins::NativeEncoding::WebP
+{
+    void Validate(uint32_t width, uint32_t height)
+    {
+        if (width == 0 || height == 0 || width > MAX_SIZE || height > MAX_SIZE)
+        {
+            throw std::invalid_argument("WebP: the image must be 1 to 16384 pixels on a side, got " + std::to_string(width) + " x " + std::to_string(height) + ".");
+        }
+    }
+
+    std::vector<std::byte> Encode(const std::byte* pixels, uint32_t width, uint32_t height, const Options& options)
+    {
+        Validate(width, height);
+
+        std::vector<uint32_t> argb(size_t{width} * height);
+        bool hasAlpha{};
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const auto* source{reinterpret_cast<const uint8_t*>(pixels) + size_t{options.FlipY ? height - 1 - y : y} * width * BYTES_PER_PIXEL};
+            auto* destination{argb.data() + size_t{y} * width};
+            for (uint32_t x = 0; x < width; ++x, source += BYTES_PER_PIXEL)
+            {
+                destination[x] = ToArgb(source);
+                hasAlpha |= source[3] != 255;
+            }
+        }
+
+        // Subtract green, which the predictor then works on.
+        for (auto& pixel : argb)
+        {
+            const uint32_t green{Channel(pixel, 8)};
+            pixel = (pixel & 0xFF00FF00u) | (((Channel(pixel, 16) - green) & 0xFF) << 16) | ((Channel(pixel, 0) - green) & 0xFF);
+        }
+        const std::vector<uint32_t> modes{ApplyPredictor(argb, width, height)};
+
+        std::vector<std::byte> bitstream{};
+        bitstream.reserve(argb.size());
+        BitWriter writer{bitstream};
+
+        constexpr uint32_t SIGNATURE{0x2F};
+        writer.Write(SIGNATURE, 8);
+        writer.Write(width - 1, 14);
+        writer.Write(height - 1, 14);
+        writer.Write(hasAlpha ? 1 : 0, 1);
+        writer.Write(0, 3);
+
+        // The decoder undoes the transforms in the reverse order of these.
+        writer.Write(1, 1);
+        writer.Write(static_cast<uint32_t>(Transform::SubtractGreen), 2);
+        writer.Write(1, 1);
+        writer.Write(static_cast<uint32_t>(Transform::Predictor), 2);
+        writer.Write(TILE_BITS - 2, 3);
+        {
+            std::vector<Token> tokens(modes.size());
+            std::transform(modes.begin(), modes.end(), tokens.begin(), [](uint32_t mode) { return Token{mode, 0, 0}; });
+            // No color cache.
+            writer.Write(0, 1);
+            WriteImage(writer, tokens, (width + (1u << TILE_BITS) - 1) >> TILE_BITS);
+        }
+        writer.Write(0, 1);
+
+        // No color cache, and a single prefix code group.
+        writer.Write(0, 1);
+        writer.Write(0, 1);
+        WriteImage(writer, FindMatches(argb, width), width);
+        writer.Align();
+
+        // The RIFF container, with the chunk padded to an even size.
+        const size_t paddedSize{(bitstream.size() + 1) & ~size_t{1}};
+        std::vector<std::byte> webp{};
+        webp.reserve(20 + paddedSize);
+        AppendTag(webp, "RIFF");
+        AppendLittleEndian32(webp, 12 + paddedSize);
+        AppendTag(webp, "WEBP");
+        AppendTag(webp, "VP8L");
+        AppendLittleEndian32(webp, bitstream.size());
+        webp.insert(webp.end(), bitstream.begin(), bitstream.end());
+        webp.resize(20 + paddedSize);
+        return webp;
+    }
+}
@@ -1068,28 +1068,6 @@ namespace Babylon
         m_asyncTaskTracker->Wait();
     }
 
-    NativeEngine::AsyncTaskTracker::Scope::Scope(std::shared_ptr<AsyncTaskTracker> tracker)
-        : m_tracker{std::move(tracker)}
-    {
-        std::lock_guard<std::mutex> lock{m_tracker->m_mutex};
-        ++m_tracker->m_count;
-    }
-
-    NativeEngine::AsyncTaskTracker::Scope::~Scope()
-    {
-        {
-            std::lock_guard<std::mutex> lock{m_tracker->m_mutex};
-            --m_tracker->m_count;
-        }
-        m_tracker->m_condition.notify_all();
-    }
-
-    void NativeEngine::AsyncTaskTracker::Wait()
-    {
-        std::unique_lock<std::mutex> lock{m_mutex};
-        m_condition.wait(lock, [this]() { return m_count == 0; });
-    }
-
     std::shared_ptr<void> NativeEngine::TrackAsyncTask()
     {
         return std::make_shared<AsyncTaskTracker::Scope>(m_asyncTaskTracker);
@@ -2262,7 +2240,7 @@ namespace Babylon
         const Napi::Env env{info.Env()};
 
         Graphics::Texture* texture{info[0].As<Napi::Pointer<Graphics::Texture>>().Get()};
-        uint8_t mipLevel{static_cast<uint8_t>(info[1].As<Napi::Number>().Uint32Value())};
+        const uint8_t mipLevel{static_cast<uint8_t>(info[1].As<Napi::Number>().Uint32Value())};
         const uint16_t x{static_cast<uint16_t>(info[2].As<Napi::Number>().Uint32Value())};
         const uint16_t y{static_cast<uint16_t>(info[3].As<Napi::Number>().Uint32Value())};
         const uint16_t width{static_cast<uint16_t>(info[4].As<Napi::Number>().Uint32Value())};
@@ -2338,71 +2316,54 @@ namespace Babylon
             // bgfx::readTexture lands in the same frame as the blit.
             Graphics::FrameCompletionScope scope{m_deviceContext.AcquireFrameCompletionScope()};
 
-            bgfx::TextureHandle sourceTextureHandle{texture->Handle()};
-            auto tempTexture = std::make_shared<bool>(false);
-
             // Extents of the requested mip. mipLevel was validated against the mip chain above, so the
             // shifts are well defined here; they floor at 1 to match how bgfx sizes the tail of the chain.
             const uint32_t mipWidth{std::max(1u, static_cast<uint32_t>(texture->Width()) >> mipLevel)};
             const uint32_t mipHeight{std::max(1u, static_cast<uint32_t>(texture->Height()) >> mipLevel)};
 
             // If the image needs to be cropped, the texture lacks the READ_BACK flag, or we are reading a
-            // specific cube-map face, blit to a temp 2D texture. bgfx::readTexture cannot address an
-            // individual cube face, so a cube-face read always goes through the blit (srcZ = face index).
-            if (isCubeFace || x != 0 || y != 0 || width != mipWidth || height != mipHeight || (texture->Flags() & BGFX_TEXTURE_READ_BACK) == 0)
-            {
-                const bgfx::TextureHandle blitTextureHandle{bgfx::createTexture2D(width, height, /*hasMips*/ false, /*numLayers*/ 1, sourceTextureFormat, BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK)};
-
-                bgfx::Encoder* encoder = GetEncoder();
-                encoder->blit(static_cast<uint16_t>(bgfx::getCaps()->limits.maxViews - 1), blitTextureHandle, /*dstMip*/ 0, /*dstX*/ 0, /*dstY*/ 0, /*dstZ*/ 0, sourceTextureHandle, mipLevel, x, y, srcZ, width, height, /*depth*/ 0);
-
-                sourceTextureHandle = blitTextureHandle;
-                *tempTexture = true;
-                mipLevel = 0;
-            }
-
-            // Allocate a buffer to store the source pixel data.
-            std::vector<uint8_t> textureBuffer(sourceTextureInfo.storageSize);
-
-            // Read the source texture (async — completes after bgfx::frame).
-            m_deviceContext.ReadTextureAsync(sourceTextureHandle, textureBuffer, mipLevel)
-                .then(arcana::inline_scheduler, *m_cancellationSource, [textureBuffer{std::move(textureBuffer)}, sourceTextureInfo, targetTextureInfo]() mutable {
-                    if (targetTextureInfo.format != sourceTextureInfo.format)
+            // specific cube-map face, blit to a (pooled) 2D texture first. bgfx::readTexture cannot address
+            // an individual cube face, so a cube-face read always goes through the blit (srcZ = face index).
+            const bool blit{isCubeFace || x != 0 || y != 0 || width != mipWidth || height != mipHeight || (texture->Flags() & BGFX_TEXTURE_READ_BACK) == 0};
+
+            // The pixels are read back and converted in native memory, and only copied into the
+            // caller's buffer on the JavaScript thread, so the render thread never writes into
+            // memory the runtime may free while the read is pending.
+            m_deviceContext.ReadTextureRegionAsync(texture->Handle(), sourceTextureFormat, {mipLevel, x, y, srcZ, width, height}, blit)
+                .then(arcana::inline_scheduler, *m_cancellationSource, [sourceTextureInfo, targetTextureInfo](const std::shared_ptr<const std::vector<uint8_t>>& sourceData) -> std::shared_ptr<const std::vector<uint8_t>> {
+                    if (targetTextureInfo.format == sourceTextureInfo.format)
                     {
+                        return sourceData;
+                    }
 #ifndef BABYLON_NATIVE_PLUGIN_NATIVEENGINE_LOAD_IMAGES
-                        throw std::runtime_error{"Texture format conversion is disabled in this build (BABYLON_NATIVE_PLUGIN_NATIVEENGINE_LOAD_IMAGES=OFF)."};
+                    throw std::runtime_error{"Texture format conversion is disabled in this build (BABYLON_NATIVE_PLUGIN_NATIVEENGINE_LOAD_IMAGES=OFF)."};
 #else
-                        std::vector<uint8_t> convertedTextureBuffer(targetTextureInfo.storageSize);
-                        if (!bimg::imageConvert(&Graphics::DeviceContext::GetDefaultAllocator(), convertedTextureBuffer.data(), bimg::TextureFormat::Enum(targetTextureInfo.format), textureBuffer.data(), bimg::TextureFormat::Enum(sourceTextureInfo.format), sourceTextureInfo.width, sourceTextureInfo.height, /*depth*/ 1))
-                        {
-                            throw std::runtime_error{"Texture conversion to RGBA8 failed."};
-                        }
-                        textureBuffer = convertedTextureBuffer;
-#endif
-                    }
-                    assert(textureBuffer.size() == targetTextureInfo.storageSize);
-                    if (bgfx::getCaps()->originBottomLeft)
+                    auto targetData{std::make_shared<std::vector<uint8_t>>(targetTextureInfo.storageSize)};
+                    if (!bimg::imageConvert(&Graphics::DeviceContext::GetDefaultAllocator(), targetData->data(), bimg::TextureFormat::Enum(targetTextureInfo.format), sourceData->data(), bimg::TextureFormat::Enum(sourceTextureInfo.format), sourceTextureInfo.width, sourceTextureInfo.height, /*depth*/ 1))
                     {
-                        FlipImage(textureBuffer, targetTextureInfo.height);
+                        throw std::runtime_error{"Texture conversion to RGBA8 failed."};
                     }
-                    return textureBuffer;
+                    return targetData;
+#endif
                 })
-                .then(m_runtimeScheduler, *m_cancellationSource, [this, bufferRef{Napi::Persistent(buffer)}, bufferOffset, deferred, tempTexture, sourceTextureHandle](std::vector<uint8_t> textureBuffer) mutable {
-                    assert(bufferRef.Value().ByteLength() - bufferOffset >= textureBuffer.size());
-                    uint8_t* buf{static_cast<uint8_t*>(bufferRef.Value().Data())};
-                    std::memcpy(buf + bufferOffset, textureBuffer.data(), textureBuffer.size());
-                    if (*tempTexture && !m_cancellationSource->cancelled())
+                .then(m_runtimeScheduler, *m_cancellationSource, [bufferRef{Napi::Persistent(buffer)}, bufferOffset, deferred, targetTextureInfo](const std::shared_ptr<const std::vector<uint8_t>>& targetData) {
+                    auto destinationBuffer{bufferRef.Value()};
+                    // The buffer may have been detached while the read was pending.
+                    if (destinationBuffer.ByteLength() < static_cast<uint64_t>(bufferOffset) + targetTextureInfo.storageSize)
                     {
-                        bgfx::destroy(sourceTextureHandle);
-                        *tempTexture = false;
+                        throw std::runtime_error{"Provided buffer is too small to contain the pixel data."};
                     }
-                    deferred.Resolve(bufferRef.Value());
-                })
-                .then(m_runtimeScheduler, arcana::cancellation::none(), [this, deferred, tempTexture, sourceTextureHandle](const arcana::expected<void, std::exception_ptr>& result) {
-                    if (*tempTexture && !m_cancellationSource->cancelled())
+
+                    uint8_t* const destination{static_cast<uint8_t*>(destinationBuffer.Data()) + bufferOffset};
+                    std::memcpy(destination, targetData->data(), targetTextureInfo.storageSize);
+                    if (bgfx::getCaps()->originBottomLeft)
                     {
-                        bgfx::destroy(sourceTextureHandle);
+                        FlipImage({destination, targetTextureInfo.storageSize}, targetTextureInfo.height);
                     }
+
+                    deferred.Resolve(destinationBuffer);
+                })
+                .then(m_runtimeScheduler, arcana::cancellation::none(), [this, deferred](const arcana::expected<void, std::exception_ptr>& result) {
                     if (result.has_error())
                     {
                         deferred.Reject(Napi::Error::New(Env(), result.error()).Value());
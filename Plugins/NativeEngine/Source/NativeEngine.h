@@ -6,6 +6,7 @@
 #include "ShaderProvider.h"
 #include "VertexArray.h"
 
+#include <Babylon/AsyncWork.h>
 #include <Babylon/JsRuntime.h>
 #include <Babylon/JsRuntimeScheduler.h>
 
@@ -155,34 +156,8 @@ namespace Babylon
         std::shared_ptr<arcana::cancellation_source> m_cancellationSource{};
 
         // Tracks in-flight threadpool work that touches graphics resources (bgfx handles,
-        // textures, the shader provider). Cancellation only short-circuits scheduling, so a
-        // task already running on a threadpool thread keeps going; Dispose() drains these
-        // before teardown frees the resources they reference.
-        struct AsyncTaskTracker
-        {
-            // RAII token: increments the in-flight count on construction and decrements it
-            // (notifying any waiter) on destruction. Counting is tied to the token's lifetime
-            // so the Enter/Leave pair can never be split by an exception.
-            struct Scope
-            {
-                explicit Scope(std::shared_ptr<AsyncTaskTracker> tracker);
-                ~Scope();
-                Scope(const Scope&) = delete;
-                Scope& operator=(const Scope&) = delete;
-
-            private:
-                std::shared_ptr<AsyncTaskTracker> m_tracker;
-            };
-
-            // Blocks until the in-flight count reaches zero.
-            void Wait();
-
-        private:
-            std::mutex m_mutex{};
-            std::condition_variable m_condition{};
-            uint32_t m_count{};
-        };
-
+        // textures, the shader provider); Dispose() drains these before teardown frees the
+        // resources they reference.
         std::shared_ptr<AsyncTaskTracker> m_asyncTaskTracker{std::make_shared<AsyncTaskTracker>()};
 
         // Returns an RAII token whose destruction marks the tracked task complete. Call on the
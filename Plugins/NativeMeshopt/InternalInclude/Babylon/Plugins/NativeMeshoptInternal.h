@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Babylon::Plugins::NativeMeshopt::Decoding
+{
+    // The JavaScript-free part of MeshoptCodec: decoding one buffer view into memory the caller
+    // owns, which DecodeBatchAsync runs on the thread pool.
+
+    enum class Mode
+    {
+        Attributes,
+        Triangles,
+        Indices,
+    };
+
+    enum class Filter
+    {
+        None,
+        Octahedral,
+        Quaternion,
+        Exponential,
+    };
+
+    // An EXT_meshopt_compression buffer view, and where to decode it.
+    struct BufferView
+    {
+        const unsigned char* Source{};
+        size_t SourceSize{};
+        size_t Count{};
+        size_t Stride{};
+        Decoding::Mode Mode{Decoding::Mode::Attributes};
+        Decoding::Filter Filter{Decoding::Filter::None};
+        // Count * Stride bytes.
+        unsigned char* Destination{};
+    };
+
+    // Parse the mode and filter names of the JavaScript API. Throw std::invalid_argument for an
+    // unknown name.
+    Mode ParseMode(const std::string& mode);
+    Filter ParseFilter(const std::string& filter);
+
+    // Checks the count and stride of a view against its mode, since meshoptimizer only asserts
+    // them. Throws std::out_of_range if they are invalid.
+    void Validate(int64_t count, int64_t stride, Mode mode);
+
+    // Decodes a validated view. Throws std::runtime_error if the data is malformed, after which
+    // the destination holds partial output. Safe to call from any thread.
+    void Decode(const BufferView& view);
+}
+
+namespace Babylon::Plugins::NativeMeshopt::Processing
+{
+    // The JavaScript-free part of MeshoptProcessing: meshoptimizer's simplification and
+    // optimization on 32-bit index buffers and float positions, which the async functions run
+    // on the thread pool. Positions are `positionStride` floats apart, the first 3 being x, y, z.
+
+    // Check an index buffer of triangles against `vertexCount`, a position stride and a vertex
+    // size in bytes, since meshoptimizer only asserts them. Throw std::out_of_range if they are
+    // invalid.
+    void ValidateIndices(const std::vector<uint32_t>& indices, size_t vertexCount);
+    void ValidatePositionStride(size_t positionStride);
+    void ValidateVertexSize(size_t vertexSize);
+
+    struct Simplified
+    {
+        std::vector<uint32_t> Indices{};
+        // The resulting error, relative to the mesh extent.
+        float Error{};
+    };
+
+    // Simplifies towards `targetIndexCount` indices without exceeding `targetError`, keeping the
+    // topology, and with `lockBorder` the vertices on the mesh border.
+    Simplified Simplify(const std::vector<uint32_t>& indices, const std::vector<float>& positions, size_t positionStride,
+        size_t targetIndexCount, float targetError, bool lockBorder);
+
+    // Simplifies as Simplify, but may merge any vertices, so it reaches lower counts.
+    Simplified SimplifySloppy(const std::vector<uint32_t>& indices, const std::vector<float>& positions, size_t positionStride,
+        size_t targetIndexCount, float targetError);
+
+    // Simplifies each level from the previous one, to `ratios[i]` of the original index count,
+    // and optimizes each for the vertex cache. A level that could not be simplified further ends
+    // the chain, so it may have fewer levels than ratios.
+    std::vector<Simplified> BuildLods(const std::vector<uint32_t>& indices, const std::vector<float>& positions, size_t positionStride,
+        const std::vector<float>& ratios, float targetError);
+
+    // Reorders triangles for the post-transform vertex cache.
+    std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount);
+
+    // Reorders triangles to reduce overdraw, losing at most `threshold` of vertex cache
+    // efficiency (1.05 allows 5%). Expects vertex cache optimized indices.
+    std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<float>& positions, size_t positionStride, float threshold);
+
+    struct VertexFetchOptimized
+    {
+        std::vector<uint32_t> Indices{};
+        std::vector<unsigned char> Vertices{};
+        size_t VertexCount{};
+    };
+
+    // Reorders the vertices, `vertexSize` bytes each, in the order the indices first use them,
+    // dropping unused ones, and remaps the indices.
+    VertexFetchOptimized OptimizeVertexFetch(const std::vector<uint32_t>& indices, const std::vector<unsigned char>& vertices, size_t vertexSize);
+
+    // Average cache miss ratio, transformed vertices per triangle, of a 16 entry FIFO cache.
+    float AverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount);
+}
@@ -1,27 +1,31 @@
 #include <Babylon/Plugins/NativeMeshopt.h>
+#include <Babylon/Plugins/NativeMeshoptInternal.h>
+#include <Babylon/AsyncWork.h>
 #include <Babylon/JsRuntime.h>
 
 #include <napi/napi.h>
 
 #include <meshoptimizer.h>
 
-// bgfx vendors its own copy of meshoptimizer under bgfx/3rdparty/meshoptimizer. It is reached
-// as <meshoptimizer/src/meshoptimizer.h> rather than <meshoptimizer.h>, so it does not collide
-// today, but the guard in Dependencies/CMakeLists.txt skips our FetchContent when a target named
-// meshoptimizer already exists. If that ever resolves the other way we would decode with a
-// different codec version than the one this file was written against, which fails as silent
-// data corruption rather than a build break. Pin it.
-static_assert(MESHOPTIMIZER_VERSION == 220, "NativeMeshopt expects meshoptimizer 0.22; check the include path and revalidate the decode paths before bumping.");
+#include <arcana/threading/task.h>
+#include <arcana/threading/task_schedulers.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
-#include <cstring>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace Babylon::Plugins
 {
     namespace
     {
+        namespace Decoding = NativeMeshopt::Decoding;
+        namespace Processing = NativeMeshopt::Processing;
+
         // MESHOPTIMIZER_VERSION is an integer like 220 meaning 0.22. Render it the way the
         // project versions its own releases so the JavaScript side can compare it directly
         // against the version a stream was produced with.
@@ -29,13 +33,51 @@ namespace Babylon::Plugins
         {
             return std::to_string(MESHOPTIMIZER_VERSION / 1000) + "." + std::to_string((MESHOPTIMIZER_VERSION / 10) % 100);
         }
+
+        // Reads the source, count, stride, mode and filter of a buffer view, validated, for
+        // `destination` to be set. Throws the JavaScript error of an invalid view.
+        Decoding::BufferView ReadBufferView(Napi::Env env, const Napi::Value& source, const Napi::Value& count, const Napi::Value& stride, const Napi::Value& mode, const Napi::Value& filter)
+        {
+            if (!source.IsTypedArray())
+            {
+                throw Napi::TypeError::New(env, "Meshopt: a buffer view requires a source typed array.");
+            }
+
+            const auto sourceArray = source.As<Napi::TypedArray>();
+            const int64_t countIn = count.As<Napi::Number>().Int64Value();
+            const int64_t strideIn = stride.As<Napi::Number>().Int64Value();
+
+            Decoding::BufferView view{};
+            view.Source = static_cast<const unsigned char*>(sourceArray.ArrayBuffer().Data()) + sourceArray.ByteOffset();
+            view.SourceSize = sourceArray.ByteLength();
+            try
+            {
+                view.Mode = Decoding::ParseMode(mode.As<Napi::String>().Utf8Value());
+                Decoding::Validate(countIn, strideIn, view.Mode);
+                if (filter.IsString())
+                {
+                    view.Filter = Decoding::ParseFilter(filter.As<Napi::String>().Utf8Value());
+                }
+            }
+            catch (const std::out_of_range& exception)
+            {
+                throw Napi::RangeError::New(env, exception.what());
+            }
+            catch (const std::invalid_argument& exception)
+            {
+                throw Napi::Error::New(env, exception.what());
+            }
+
+            view.Count = static_cast<size_t>(countIn);
+            view.Stride = static_cast<size_t>(strideIn);
+            return view;
+        }
+
         // Native equivalent of MeshoptDecoder.decodeGltfBufferAsync:
         //   decodeMeshopt(source: Uint8Array, count, stride, mode, filter?) -> Uint8Array
         // where mode is "ATTRIBUTES" | "TRIANGLES" | "INDICES" and filter (optional)
-        // is "NONE" | "OCTAHEDRAL" | "QUATERNION" | "EXPONENTIAL". Mirrors the
-        // reference meshopt_decoder.js decode() helper exactly: decode into a buffer
-        // sized for count rounded up to a multiple of 4, then apply the filter
-        // in-place over that rounded count, then return the first count*stride bytes.
+        // is "NONE" | "OCTAHEDRAL" | "QUATERNION" | "EXPONENTIAL". Returns the same bytes as the
+        // reference meshopt_decoder.js decode() helper, decoded straight into the result.
         Napi::Value DecodeMeshopt(const Napi::CallbackInfo& info)
         {
             const auto env = info.Env();
@@ -45,108 +87,386 @@ namespace Babylon::Plugins
                 throw Napi::TypeError::New(env, "Meshopt: decodeMeshopt(source, count, stride, mode, filter?) requires a source typed array.");
             }
 
-            const auto sourceArray = info[0].As<Napi::TypedArray>();
-            const auto* source = static_cast<const unsigned char*>(sourceArray.ArrayBuffer().Data()) + sourceArray.ByteOffset();
-            const size_t sourceSize = sourceArray.ByteLength();
+            auto view = ReadBufferView(env, info[0], info[1], info[2], info[3], info[4]);
+            auto output = Napi::Uint8Array::New(env, view.Count * view.Stride);
+            view.Destination = output.Data();
 
-            const int64_t countIn = info[1].As<Napi::Number>().Int64Value();
-            const int64_t strideIn = info[2].As<Napi::Number>().Int64Value();
-            const std::string mode = info[3].As<Napi::String>().Utf8Value();
-
-            // meshoptimizer validates these with assert(), which compiles out in release builds,
-            // so out-of-range values would be undefined behavior rather than a thrown error.
-            if (countIn < 0)
+            try
             {
-                throw Napi::RangeError::New(env, "Meshopt: count must not be negative, got " + std::to_string(countIn));
+                Decoding::Decode(view);
             }
-            if (strideIn <= 0 || strideIn > 256)
+            catch (const std::exception& exception)
             {
-                throw Napi::RangeError::New(env, "Meshopt: stride must be in [1, 256], got " + std::to_string(strideIn));
+                throw Napi::Error::New(env, exception.what());
             }
-            if (mode == "ATTRIBUTES")
+
+            return output;
+        }
+
+        // decodeBatchAsync(views: Array<{ source, count, stride, mode, filter?, destination }>)
+        // decodes every view into its destination, an ArrayBufferView of at least count * stride
+        // bytes, on the thread pool, and returns a promise resolved once all are written. The
+        // promise is rejected with the error of the first view that fails, after the others
+        // finished. Sources and destinations must not be touched until then.
+        Napi::Value DecodeMeshoptBatchAsync(const Napi::CallbackInfo& info)
+        {
+            const auto env = info.Env();
+
+            if (info.Length() < 1 || !info[0].IsArray())
             {
-                if (strideIn % 4 != 0)
+                throw Napi::TypeError::New(env, "Meshopt: decodeBatchAsync(views) requires an array of buffer views.");
+            }
+
+            const auto descriptors = info[0].As<Napi::Array>();
+            auto views = std::make_shared<std::vector<Decoding::BufferView>>();
+            views->reserve(descriptors.Length());
+            std::vector<Napi::Reference<Napi::TypedArray>> arrayRefs{};
+            arrayRefs.reserve(descriptors.Length() * 2);
+            for (uint32_t i = 0; i < descriptors.Length(); ++i)
+            {
+                const auto descriptor = descriptors.Get(i).As<Napi::Object>();
+                auto view = ReadBufferView(env, descriptor.Get("source"), descriptor.Get("count"), descriptor.Get("stride"), descriptor.Get("mode"), descriptor.Get("filter"));
+
+                const auto destination = descriptor.Get("destination");
+                if (!destination.IsTypedArray() || destination.As<Napi::TypedArray>().ByteLength() < view.Count * view.Stride)
                 {
-                    throw Napi::RangeError::New(env, "Meshopt: ATTRIBUTES stride must be a multiple of 4, got " + std::to_string(strideIn));
+                    throw Napi::TypeError::New(env, "Meshopt: buffer view " + std::to_string(i) + " requires a destination typed array of count * stride bytes.");
                 }
+
+                const auto destinationArray = destination.As<Napi::TypedArray>();
+                view.Destination = static_cast<unsigned char*>(destinationArray.ArrayBuffer().Data()) + destinationArray.ByteOffset();
+                views->push_back(view);
+                arrayRefs.push_back(Napi::Persistent(descriptor.Get("source").As<Napi::TypedArray>()));
+                arrayRefs.push_back(Napi::Persistent(destinationArray));
             }
-            else if (mode == "TRIANGLES" || mode == "INDICES")
+
+            auto deferred{Napi::Promise::Deferred::New(env)};
+            auto& asyncWork{AsyncWork::GetFromJavaScript(env)};
+
+            // A few tasks take views in turn until none are left, so large and small views
+            // balance out. A task records failures instead of throwing, so that the promise
+            // settles only once no task writes to the destinations anymore. Once the environment
+            // is torn down, the tasks stop after the view they are decoding.
+            auto next = std::make_shared<std::atomic<size_t>>(0);
+            auto errors = std::make_shared<std::vector<std::string>>(views->size());
+            const size_t taskCount{std::clamp<size_t>(views->size(), 1, std::max(std::thread::hardware_concurrency(), 1u))};
+            std::vector<arcana::task<size_t, std::exception_ptr>> tasks{};
+            for (size_t task = 0; task < taskCount; ++task)
+            {
+                tasks.push_back(asyncWork.Run([views, next, errors](const arcana::cancellation& cancellation) {
+                    size_t decoded{};
+                    for (size_t index = (*next)++; index < views->size() && !cancellation.cancelled(); index = (*next)++)
+                    {
+                        try
+                        {
+                            Decoding::Decode((*views)[index]);
+                            ++decoded;
+                        }
+                        catch (const std::exception& exception)
+                        {
+                            (*errors)[index] = exception.what();
+                        }
+                    }
+                    return decoded;
+                }));
+            }
+
+            asyncWork.Then(arcana::when_all(gsl::make_span(tasks)),
+                [deferred, env, errors, arrayRefs{std::move(arrayRefs)}](const arcana::expected<std::vector<size_t>, std::exception_ptr>& result) {
+                    if (result.has_error())
+                    {
+                        deferred.Reject(Napi::Error::New(env, result.error()).Value());
+                        return;
+                    }
+
+                    for (size_t index = 0; index < errors->size(); ++index)
+                    {
+                        if (!(*errors)[index].empty())
+                        {
+                            deferred.Reject(Napi::Error::New(env, "Meshopt: buffer view " + std::to_string(index) + ": " + (*errors)[index]).Value());
+                            return;
+                        }
+                    }
+
+                    deferred.Resolve(env.Undefined());
+                });
+
+            return deferred.Promise();
+        }
+
+        // Runs a Processing call with the std::out_of_range it throws for invalid arguments
+        // turned into a JavaScript RangeError.
+        template<typename CallableT>
+        auto Validated(Napi::Env env, CallableT callable)
+        {
+            try
+            {
+                return callable();
+            }
+            catch (const std::out_of_range& exception)
             {
-                if (strideIn != 2 && strideIn != 4)
+                throw Napi::RangeError::New(env, exception.what());
+            }
+        }
+
+        // Copies a Uint8Array, Uint16Array or Uint32Array of indices, so that the thread pool
+        // works on memory JavaScript cannot change under it.
+        std::vector<uint32_t> ReadIndices(Napi::Env env, const Napi::Value& value)
+        {
+            if (!value.IsTypedArray())
+            {
+                throw Napi::TypeError::New(env, "Meshopt: indices must be a Uint8Array, Uint16Array or Uint32Array.");
+            }
+
+            const auto indices = value.As<Napi::TypedArray>();
+            switch (indices.TypedArrayType())
+            {
+                case napi_typedarray_type::napi_uint8_array:
+                {
+                    const auto array = indices.As<Napi::Uint8Array>();
+                    return {array.Data(), array.Data() + array.ElementLength()};
+                }
+                case napi_typedarray_type::napi_uint16_array:
                 {
-                    throw Napi::RangeError::New(env, "Meshopt: " + mode + " stride must be 2 or 4, got " + std::to_string(strideIn));
+                    const auto array = indices.As<Napi::Uint16Array>();
+                    return {array.Data(), array.Data() + array.ElementLength()};
                 }
-                if (mode == "TRIANGLES" && countIn % 3 != 0)
+                case napi_typedarray_type::napi_uint32_array:
                 {
-                    throw Napi::RangeError::New(env, "Meshopt: TRIANGLES count must be a multiple of 3, got " + std::to_string(countIn));
+                    const auto array = indices.As<Napi::Uint32Array>();
+                    return {array.Data(), array.Data() + array.ElementLength()};
                 }
+                default:
+                    throw Napi::TypeError::New(env, "Meshopt: indices must be a Uint8Array, Uint16Array or Uint32Array.");
             }
-            else
+        }
+
+        // Copies a Float32Array of positions `positionStride` floats apart and checks `indices`
+        // against the vertices it holds.
+        std::vector<float> ReadPositions(Napi::Env env, const Napi::Value& value, size_t positionStride, const std::vector<uint32_t>& indices)
+        {
+            if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_typedarray_type::napi_float32_array)
             {
-                throw Napi::Error::New(env, "Meshopt: Unsupported decode mode: " + mode);
+                throw Napi::TypeError::New(env, "Meshopt: positions must be a Float32Array.");
             }
 
-            const size_t count = static_cast<size_t>(countIn);
-            const size_t stride = static_cast<size_t>(strideIn);
+            const auto array = value.As<Napi::Float32Array>();
+            std::vector<float> positions{array.Data(), array.Data() + array.ElementLength()};
+            Validated(env, [&]() {
+                Processing::ValidatePositionStride(positionStride);
+                Processing::ValidateIndices(indices, positions.size() / positionStride);
+            });
+            return positions;
+        }
 
-            // Round count up to a multiple of 4 (the reference decoder over-allocates
-            // and runs the vertex filter over count4 elements).
-            const size_t count4 = (count + 3) & ~static_cast<size_t>(3);
+        size_t ReadSize(const Napi::Value& value)
+        {
+            return static_cast<size_t>(std::max<int64_t>(value.As<Napi::Number>().Int64Value(), 0));
+        }
 
-            // Guard the allocation size so a huge count cannot wrap size_t.
-            constexpr int64_t maxDecodedBytes = 1LL << 31;
-            if (static_cast<int64_t>(count4) * strideIn > maxDecodedBytes)
+        // Hands `data` to JavaScript as an external ArrayBuffer that keeps it alive, without a copy.
+        template<typename T>
+        Napi::ArrayBuffer ToArrayBuffer(Napi::Env env, std::shared_ptr<std::vector<T>> data)
+        {
+            if (data->empty())
             {
-                throw Napi::RangeError::New(env, "Meshopt: decoded size (" + std::to_string(count4) + " x " +
-                    std::to_string(strideIn) + " bytes) exceeds the 2 GB limit.");
+                return Napi::ArrayBuffer::New(env, 0);
             }
 
-            std::vector<unsigned char> temp(count4 * stride, 0);
+            return Napi::ArrayBuffer::New(env, data->data(), data->size() * sizeof(T), [data](Napi::Env, void*) {});
+        }
 
-            int result;
-            if (mode == "ATTRIBUTES")
+        Napi::Uint32Array ToUint32Array(Napi::Env env, std::vector<uint32_t> indices)
+        {
+            const size_t length{indices.size()};
+            return Napi::Uint32Array::New(env, length, ToArrayBuffer(env, std::make_shared<std::vector<uint32_t>>(std::move(indices))), 0);
+        }
+
+        Napi::Object ToJavaScript(Napi::Env env, Processing::Simplified simplified)
+        {
+            auto object = Napi::Object::New(env);
+            object.Set("indices", ToUint32Array(env, std::move(simplified.Indices)));
+            object.Set("error", Napi::Number::New(env, simplified.Error));
+            return object;
+        }
+
+        // Runs `work` on the thread pool and returns a promise resolved with what `toJavaScript`
+        // makes of its result, on the JavaScript thread, or rejected with the error it threw.
+        // Neither happens once the environment is torn down.
+        template<typename WorkT, typename ToJavaScriptT>
+        Napi::Value RunAsync(Napi::Env env, WorkT work, ToJavaScriptT toJavaScript)
+        {
+            using ResultT = decltype(work());
+
+            auto deferred{Napi::Promise::Deferred::New(env)};
+            auto& asyncWork{AsyncWork::GetFromJavaScript(env)};
+
+            asyncWork.Then(asyncWork.Run([work{std::move(work)}](const arcana::cancellation&) {
+                return std::make_shared<ResultT>(work());
+            }), [deferred, env, toJavaScript{std::move(toJavaScript)}](const arcana::expected<std::shared_ptr<ResultT>, std::exception_ptr>& result) {
+                if (result.has_error())
+                {
+                    deferred.Reject(Napi::Error::New(env, result.error()).Value());
+                    return;
+                }
+
+                deferred.Resolve(toJavaScript(env, std::move(*result.value())));
+            });
+
+            return deferred.Promise();
+        }
+
+        // simplifyAsync(indices, positions, positionStride, targetIndexCount, targetError, lockBorder?)
+        //   -> Promise<{ indices: Uint32Array, error: number }>
+        Napi::Value SimplifyAsync(const Napi::CallbackInfo& info)
+        {
+            const auto env = info.Env();
+            if (info.Length() < 5)
             {
-                result = meshopt_decodeVertexBuffer(temp.data(), count, stride, source, sourceSize);
+                throw Napi::TypeError::New(env, "Meshopt: SimplifyAsync(indices, positions, positionStride, targetIndexCount, targetError, lockBorder?) requires 5 arguments.");
             }
-            else if (mode == "TRIANGLES")
+
+            auto indices{ReadIndices(env, info[0])};
+            const size_t positionStride{ReadSize(info[2])};
+            auto positions{ReadPositions(env, info[1], positionStride, indices)};
+            const size_t targetIndexCount{ReadSize(info[3])};
+            const float targetError{info[4].As<Napi::Number>().FloatValue()};
+            const bool lockBorder{info.Length() > 5 && info[5].ToBoolean().Value()};
+
+            return RunAsync(env, [indices{std::move(indices)}, positions{std::move(positions)}, positionStride, targetIndexCount, targetError, lockBorder]() {
+                return Processing::Simplify(indices, positions, positionStride, targetIndexCount, targetError, lockBorder);
+            }, [](Napi::Env env, Processing::Simplified simplified) {
+                return ToJavaScript(env, std::move(simplified));
+            });
+        }
+
+        // simplifySloppyAsync(indices, positions, positionStride, targetIndexCount, targetError)
+        //   -> Promise<{ indices: Uint32Array, error: number }>
+        Napi::Value SimplifySloppyAsync(const Napi::CallbackInfo& info)
+        {
+            const auto env = info.Env();
+            if (info.Length() < 5)
             {
-                result = meshopt_decodeIndexBuffer(temp.data(), count, stride, source, sourceSize);
+                throw Napi::TypeError::New(env, "Meshopt: SimplifySloppyAsync(indices, positions, positionStride, targetIndexCount, targetError) requires 5 arguments.");
             }
-            else
+
+            auto indices{ReadIndices(env, info[0])};
+            const size_t positionStride{ReadSize(info[2])};
+            auto positions{ReadPositions(env, info[1], positionStride, indices)};
+            const size_t targetIndexCount{ReadSize(info[3])};
+            const float targetError{info[4].As<Napi::Number>().FloatValue()};
+
+            return RunAsync(env, [indices{std::move(indices)}, positions{std::move(positions)}, positionStride, targetIndexCount, targetError]() {
+                return Processing::SimplifySloppy(indices, positions, positionStride, targetIndexCount, targetError);
+            }, [](Napi::Env env, Processing::Simplified simplified) {
+                return ToJavaScript(env, std::move(simplified));
+            });
+        }
+
+        // buildLodsAsync(indices, positions, positionStride, ratios: number[], targetError)
+        //   -> Promise<Array<{ indices: Uint32Array, error: number }>>
+        Napi::Value BuildLodsAsync(const Napi::CallbackInfo& info)
+        {
+            const auto env = info.Env();
+            if (info.Length() < 5 || !info[3].IsArray())
             {
-                result = meshopt_decodeIndexSequence(temp.data(), count, stride, source, sourceSize);
+                throw Napi::TypeError::New(env, "Meshopt: BuildLodsAsync(indices, positions, positionStride, ratios, targetError) requires an array of ratios.");
             }
 
-            if (result != 0)
+            auto indices{ReadIndices(env, info[0])};
+            const size_t positionStride{ReadSize(info[2])};
+            auto positions{ReadPositions(env, info[1], positionStride, indices)};
+            const auto ratioArray = info[3].As<Napi::Array>();
+            std::vector<float> ratios(ratioArray.Length());
+            for (uint32_t i = 0; i < ratioArray.Length(); ++i)
             {
-                throw Napi::Error::New(env, "Meshopt: Malformed buffer data: " + std::to_string(result));
+                ratios[i] = ratioArray.Get(i).As<Napi::Number>().FloatValue();
             }
+            const float targetError{info[4].As<Napi::Number>().FloatValue()};
 
-            if (info.Length() > 4 && info[4].IsString())
-            {
-                const std::string filter = info[4].As<Napi::String>().Utf8Value();
-                if (filter == "OCTAHEDRAL")
+            return RunAsync(env, [indices{std::move(indices)}, positions{std::move(positions)}, positionStride, ratios{std::move(ratios)}, targetError]() {
+                return Processing::BuildLods(indices, positions, positionStride, ratios, targetError);
+            }, [](Napi::Env env, std::vector<Processing::Simplified> lods) {
+                auto array = Napi::Array::New(env, lods.size());
+                for (uint32_t i = 0; i < lods.size(); ++i)
                 {
-                    meshopt_decodeFilterOct(temp.data(), count4, stride);
-                }
-                else if (filter == "QUATERNION")
-                {
-                    meshopt_decodeFilterQuat(temp.data(), count4, stride);
-                }
-                else if (filter == "EXPONENTIAL")
-                {
-                    meshopt_decodeFilterExp(temp.data(), count4, stride);
-                }
-                else if (filter != "NONE")
-                {
-                    throw Napi::Error::New(env, std::string("Meshopt: Unsupported decode filter: ") + filter);
+                    array.Set(i, ToJavaScript(env, std::move(lods[i])));
                 }
+                return array;
+            });
+        }
+
+        // optimizeVertexCacheAsync(indices, vertexCount) -> Promise<Uint32Array>
+        Napi::Value OptimizeVertexCacheAsync(const Napi::CallbackInfo& info)
+        {
+            const auto env = info.Env();
+            if (info.Length() < 2)
+            {
+                throw Napi::TypeError::New(env, "Meshopt: OptimizeVertexCacheAsync(indices, vertexCount) requires 2 arguments.");
             }
 
-            const size_t outSize = count * stride;
-            auto output = Napi::Uint8Array::New(env, outSize);
-            std::memcpy(output.Data(), temp.data(), outSize);
-            return output;
+            auto indices{ReadIndices(env, info[0])};
+            const size_t vertexCount{ReadSize(info[1])};
+            Validated(env, [&]() { Processing::ValidateIndices(indices, vertexCount); });
+
+            return RunAsync(env, [indices{std::move(indices)}, vertexCount]() {
+                return Processing::OptimizeVertexCache(indices, vertexCount);
+            }, [](Napi::Env env, std::vector<uint32_t> optimized) {
+                return ToUint32Array(env, std::move(optimized));
+            });
+        }
+
+        // optimizeOverdrawAsync(indices, positions, positionStride, threshold) -> Promise<Uint32Array>
+        Napi::Value OptimizeOverdrawAsync(const Napi::CallbackInfo& info)
+        {
+            const auto env = info.Env();
+            if (info.Length() < 4)
+            {
+                throw Napi::TypeError::New(env, "Meshopt: OptimizeOverdrawAsync(indices, positions, positionStride, threshold) requires 4 arguments.");
+            }
+
+            auto indices{ReadIndices(env, info[0])};
+            const size_t positionStride{ReadSize(info[2])};
+            auto positions{ReadPositions(env, info[1], positionStride, indices)};
+            const float threshold{info[3].As<Napi::Number>().FloatValue()};
+
+            return RunAsync(env, [indices{std::move(indices)}, positions{std::move(positions)}, positionStride, threshold]() {
+                return Processing::OptimizeOverdraw(indices, positions, positionStride, threshold);
+            }, [](Napi::Env env, std::vector<uint32_t> optimized) {
+                return ToUint32Array(env, std::move(optimized));
+            });
+        }
+
+        // optimizeVertexFetchAsync(indices, vertices: ArrayBufferView, vertexSize)
+        //   -> Promise<{ indices: Uint32Array, vertices: Uint8Array, vertexCount: number }>
+        Napi::Value OptimizeVertexFetchAsync(const Napi::CallbackInfo& info)
+        {
+            const auto env = info.Env();
+            if (info.Length() < 3 || !info[1].IsTypedArray())
+            {
+                throw Napi::TypeError::New(env, "Meshopt: OptimizeVertexFetchAsync(indices, vertices, vertexSize) requires a vertices typed array.");
+            }
+
+            auto indices{ReadIndices(env, info[0])};
+            const auto vertexArray = info[1].As<Napi::TypedArray>();
+            const auto* vertexData = static_cast<const unsigned char*>(vertexArray.ArrayBuffer().Data()) + vertexArray.ByteOffset();
+            std::vector<unsigned char> vertices{vertexData, vertexData + vertexArray.ByteLength()};
+            const size_t vertexSize{ReadSize(info[2])};
+            Validated(env, [&]() {
+                Processing::ValidateVertexSize(vertexSize);
+                Processing::ValidateIndices(indices, vertices.size() / vertexSize);
+            });
+
+            return RunAsync(env, [indices{std::move(indices)}, vertices{std::move(vertices)}, vertexSize]() {
+                return Processing::OptimizeVertexFetch(indices, vertices, vertexSize);
+            }, [](Napi::Env env, Processing::VertexFetchOptimized optimized) {
+                auto object = Napi::Object::New(env);
+                const size_t vertexBytes{optimized.Vertices.size()};
+                object.Set("indices", ToUint32Array(env, std::move(optimized.Indices)));
+                object.Set("vertices", Napi::Uint8Array::New(env, vertexBytes, ToArrayBuffer(env, std::make_shared<std::vector<unsigned char>>(std::move(optimized.Vertices))), 0));
+                object.Set("vertexCount", Napi::Number::New(env, static_cast<double>(optimized.VertexCount)));
+                return object;
+            });
         }
     }
 }
@@ -155,6 +475,8 @@ namespace Babylon::Plugins::NativeMeshopt
 {
     void BABYLON_API Initialize(Napi::Env env)
     {
+        AsyncWork::CreateForJavaScript(env);
+
         auto native{JsRuntime::NativeObject::GetFromJavaScript(env)};
 
         // Grouped for the same reasons as DracoCodec. Version matters more here: meshoptimizer
@@ -163,7 +485,20 @@ namespace Babylon::Plugins::NativeMeshopt
         // version lets the JavaScript side fall back before it tries.
         auto codec = Napi::Object::New(env);
         codec.Set("Decode", Napi::Function::New(env, DecodeMeshopt, "Decode"));
+        codec.Set("DecodeBatchAsync", Napi::Function::New(env, DecodeMeshoptBatchAsync, "DecodeBatchAsync"));
         codec.Set("Version", Napi::String::New(env, MeshoptVersionString()));
         native.Set("MeshoptCodec", codec);
+
+        // Simplification and optimization are not part of the codec: they run on meshes that
+        // need not have been compressed, so they get an object of their own.
+        auto processing = Napi::Object::New(env);
+        processing.Set("SimplifyAsync", Napi::Function::New(env, SimplifyAsync, "SimplifyAsync"));
+        processing.Set("SimplifySloppyAsync", Napi::Function::New(env, SimplifySloppyAsync, "SimplifySloppyAsync"));
+        processing.Set("BuildLodsAsync", Napi::Function::New(env, BuildLodsAsync, "BuildLodsAsync"));
+        processing.Set("OptimizeVertexCacheAsync", Napi::Function::New(env, OptimizeVertexCacheAsync, "OptimizeVertexCacheAsync"));
+        processing.Set("OptimizeOverdrawAsync", Napi::Function::New(env, OptimizeOverdrawAsync, "OptimizeOverdrawAsync"));
+        processing.Set("OptimizeVertexFetchAsync", Napi::Function::New(env, OptimizeVertexFetchAsync, "OptimizeVertexFetchAsync"));
+        processing.Set("Version", Napi::String::New(env, MeshoptVersionString()));
+        native.Set("MeshoptProcessing", processing);
     }
 }
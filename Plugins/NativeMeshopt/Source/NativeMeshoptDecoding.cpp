@@ -0,0 +1,157 @@
+#include <Babylon/Plugins/NativeMeshoptInternal.h>
+
+#include <meshoptimizer.h>
+
+// bgfx vendors its own copy of meshoptimizer under bgfx/3rdparty/meshoptimizer. It is reached
+// as <meshoptimizer/src/meshoptimizer.h> rather than <meshoptimizer.h>, so it does not collide
+// today, but the guard in Dependencies/CMakeLists.txt skips our FetchContent when a target named
+// meshoptimizer already exists. If that ever resolves the other way we would decode with a
+// different codec version than the one this file was written against, which fails as silent
+// data corruption rather than a build break. Pin it.
+static_assert(MESHOPTIMIZER_VERSION == 220, "NativeMeshopt expects meshoptimizer 0.22; check the include path and revalidate the decode paths before bumping.");
+
+#include <stdexcept>
+
+namespace
+{
+    using Babylon::Plugins::NativeMeshopt::Decoding::Mode;
+
+    const char* ModeName(Mode mode)
+    {
+        switch (mode)
+        {
+            case Mode::Attributes:
+                return "ATTRIBUTES";
+            case Mode::Triangles:
+                return "TRIANGLES";
+            case Mode::Indices:
+                return "INDICES";
+        }
+
+        return "unknown";
+    }
+}
+
+namespace Babylon::Plugins::NativeMeshopt::Decoding
+{
+    Mode ParseMode(const std::string& mode)
+    {
+        if (mode == "ATTRIBUTES")
+        {
+            return Mode::Attributes;
+        }
+        if (mode == "TRIANGLES")
+        {
+            return Mode::Triangles;
+        }
+        if (mode == "INDICES")
+        {
+            return Mode::Indices;
+        }
+        throw std::invalid_argument("Meshopt: Unsupported decode mode: " + mode);
+    }
+
+    Filter ParseFilter(const std::string& filter)
+    {
+        if (filter == "NONE")
+        {
+            return Filter::None;
+        }
+        if (filter == "OCTAHEDRAL")
+        {
+            return Filter::Octahedral;
+        }
+        if (filter == "QUATERNION")
+        {
+            return Filter::Quaternion;
+        }
+        if (filter == "EXPONENTIAL")
+        {
+            return Filter::Exponential;
+        }
+        throw std::invalid_argument("Meshopt: Unsupported decode filter: " + filter);
+    }
+
+    void Validate(int64_t count, int64_t stride, Mode mode)
+    {
+        // meshoptimizer validates these with assert(), which compiles out in release builds,
+        // so out-of-range values would be undefined behavior rather than a thrown error.
+        if (count < 0)
+        {
+            throw std::out_of_range("Meshopt: count must not be negative, got " + std::to_string(count));
+        }
+        if (stride <= 0 || stride > 256)
+        {
+            throw std::out_of_range("Meshopt: stride must be in [1, 256], got " + std::to_string(stride));
+        }
+        if (mode == Mode::Attributes)
+        {
+            if (stride % 4 != 0)
+            {
+                throw std::out_of_range("Meshopt: ATTRIBUTES stride must be a multiple of 4, got " + std::to_string(stride));
+            }
+        }
+        else
+        {
+            if (stride != 2 && stride != 4)
+            {
+                throw std::out_of_range(std::string("Meshopt: ") + ModeName(mode) + " stride must be 2 or 4, got " + std::to_string(stride));
+            }
+            if (mode == Mode::Triangles && count % 3 != 0)
+            {
+                throw std::out_of_range("Meshopt: TRIANGLES count must be a multiple of 3, got " + std::to_string(count));
+            }
+        }
+
+        // Guard the decoded size so a huge count cannot wrap size_t. The reference decoder
+        // allocates count rounded up to a multiple of 4, so the limit stays the one it had.
+        constexpr int64_t maxDecodedBytes = 1LL << 31;
+        const int64_t count4 = (count + 3) & ~int64_t{3};
+        if (count4 * stride > maxDecodedBytes)
+        {
+            throw std::out_of_range("Meshopt: decoded size (" + std::to_string(count4) + " x " +
+                std::to_string(stride) + " bytes) exceeds the 2 GB limit.");
+        }
+    }
+
+    // Matches the reference meshopt_decoder.js decode() helper, which decodes into a buffer
+    // of count rounded up to a multiple of 4 and filters all of it. The filters work on each
+    // element alone and meshoptimizer handles a count that is not a multiple of 4, so decoding
+    // and filtering count elements in place gives the same first count * stride bytes.
+    void Decode(const BufferView& view)
+    {
+        int result;
+        switch (view.Mode)
+        {
+            case Mode::Attributes:
+                result = meshopt_decodeVertexBuffer(view.Destination, view.Count, view.Stride, view.Source, view.SourceSize);
+                break;
+            case Mode::Triangles:
+                result = meshopt_decodeIndexBuffer(view.Destination, view.Count, view.Stride, view.Source, view.SourceSize);
+                break;
+            default:
+                result = meshopt_decodeIndexSequence(view.Destination, view.Count, view.Stride, view.Source, view.SourceSize);
+                break;
+        }
+
+        if (result != 0)
+        {
+            throw std::runtime_error("Meshopt: Malformed buffer data: " + std::to_string(result));
+        }
+
+        switch (view.Filter)
+        {
+            case Filter::None:
+                break;
+            case Filter::Octahedral:
+                meshopt_decodeFilterOct(view.Destination, view.Count, view.Stride);
+                break;
+            case Filter::Quaternion:
+                meshopt_decodeFilterQuat(view.Destination, view.Count, view.Stride);
+                break;
+            case Filter::Exponential:
+                meshopt_decodeFilterExp(view.Destination, view.Count, view.Stride);
+                break;
+        }
+    }
+}
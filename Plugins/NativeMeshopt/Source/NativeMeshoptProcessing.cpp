@@ -0,0 +1,131 @@
+#include <Babylon/Plugins/NativeMeshoptInternal.h>
+
+#include <meshoptimizer.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    using Babylon::Plugins::NativeMeshopt::Processing::Simplified;
+
+    // The entry size, in vertices, of the FIFO cache AverageCacheMissRatio models.
+    constexpr unsigned int CACHE_SIZE{16};
+
+    size_t VertexCount(const std::vector<float>& positions, size_t positionStride)
+    {
+        return positions.size() / positionStride;
+    }
+}
+
+namespace Babylon::Plugins::NativeMeshopt::Processing
+{
+    void ValidateIndices(const std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        if (indices.size() % 3 != 0)
+        {
+            throw std::out_of_range("Meshopt: index count must be a multiple of 3, got " + std::to_string(indices.size()));
+        }
+
+        const auto maxIndex = std::max_element(indices.begin(), indices.end());
+        if (maxIndex != indices.end() && *maxIndex >= vertexCount)
+        {
+            throw std::out_of_range("Meshopt: index " + std::to_string(*maxIndex) + " is out of range for " + std::to_string(vertexCount) + " vertices");
+        }
+    }
+
+    void ValidatePositionStride(size_t positionStride)
+    {
+        if (positionStride < 3 || positionStride > 64)
+        {
+            throw std::out_of_range("Meshopt: position stride must be in [3, 64] floats, got " + std::to_string(positionStride));
+        }
+    }
+
+    void ValidateVertexSize(size_t vertexSize)
+    {
+        if (vertexSize == 0 || vertexSize > 256)
+        {
+            throw std::out_of_range("Meshopt: vertex size must be in [1, 256] bytes, got " + std::to_string(vertexSize));
+        }
+    }
+
+    Simplified Simplify(const std::vector<uint32_t>& indices, const std::vector<float>& positions, size_t positionStride,
+        size_t targetIndexCount, float targetError, bool lockBorder)
+    {
+        Simplified result{};
+        result.Indices.resize(indices.size());
+        result.Indices.resize(meshopt_simplify(result.Indices.data(), indices.data(), indices.size(), positions.data(),
+            VertexCount(positions, positionStride), positionStride * sizeof(float), targetIndexCount, targetError,
+            lockBorder ? meshopt_SimplifyLockBorder : 0, &result.Error));
+        return result;
+    }
+
+    Simplified SimplifySloppy(const std::vector<uint32_t>& indices, const std::vector<float>& positions, size_t positionStride,
+        size_t targetIndexCount, float targetError)
+    {
+        Simplified result{};
+        result.Indices.resize(indices.size());
+        result.Indices.resize(meshopt_simplifySloppy(result.Indices.data(), indices.data(), indices.size(), positions.data(),
+            VertexCount(positions, positionStride), positionStride * sizeof(float), targetIndexCount, targetError, &result.Error));
+        return result;
+    }
+
+    std::vector<Simplified> BuildLods(const std::vector<uint32_t>& indices, const std::vector<float>& positions, size_t positionStride,
+        const std::vector<float>& ratios, float targetError)
+    {
+        const size_t vertexCount{VertexCount(positions, positionStride)};
+
+        std::vector<Simplified> lods{};
+        const std::vector<uint32_t>* previous{&indices};
+        float previousError{};
+        for (const float ratio : ratios)
+        {
+            const size_t targetIndexCount{static_cast<size_t>(static_cast<double>(indices.size()) * std::clamp(ratio, 0.0f, 1.0f)) / 3 * 3};
+            auto lod{Simplify(*previous, positions, positionStride, targetIndexCount, targetError, false)};
+            if (lod.Indices.empty() || lod.Indices.size() >= previous->size())
+            {
+                break;
+            }
+
+            // Each level adds its error to the one of the level it was simplified from.
+            lod.Error += previousError;
+            previousError = lod.Error;
+            lod.Indices = OptimizeVertexCache(lod.Indices, vertexCount);
+            lods.push_back(std::move(lod));
+            previous = &lods.back().Indices;
+        }
+        return lods;
+    }
+
+    std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        std::vector<uint32_t> result(indices.size());
+        meshopt_optimizeVertexCache(result.data(), indices.data(), indices.size(), vertexCount);
+        return result;
+    }
+
+    std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<float>& positions, size_t positionStride, float threshold)
+    {
+        std::vector<uint32_t> result(indices.size());
+        meshopt_optimizeOverdraw(result.data(), indices.data(), indices.size(), positions.data(),
+            VertexCount(positions, positionStride), positionStride * sizeof(float), threshold);
+        return result;
+    }
+
+    VertexFetchOptimized OptimizeVertexFetch(const std::vector<uint32_t>& indices, const std::vector<unsigned char>& vertices, size_t vertexSize)
+    {
+        VertexFetchOptimized result{};
+        result.Indices = indices;
+        result.Vertices.resize(vertices.size());
+        result.VertexCount = meshopt_optimizeVertexFetch(result.Vertices.data(), result.Indices.data(), result.Indices.size(),
+            vertices.data(), vertices.size() / vertexSize, vertexSize);
+        result.Vertices.resize(result.VertexCount * vertexSize);
+        return result;
+    }
+
+    float AverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        return meshopt_analyzeVertexCache(indices.data(), indices.size(), vertexCount, CACHE_SIZE, 0, 0).acmr;
+    }
+}
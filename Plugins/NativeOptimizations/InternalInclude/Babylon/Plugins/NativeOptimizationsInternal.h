@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Babylon::Plugins::NativeOptimizations::Kernels
+{
+    // The kernels behind the NativeOptimizations functions, on raw arrays.
+    //
+    // The functions in this namespace process SSE or NEON width blocks when the target has them
+    // (see SimdName), and otherwise are the scalar ones in Scalar. Both perform the same float
+    // operations in the same order, without fused multiply-adds or approximate reciprocals, so
+    // they return the same bits. The only exception is the sign of a zero bound found by the
+    // min/max extraction when the data holds both 0 and -0.
+    //
+    // Vertex ranges are given as in the JavaScript API: `offset` and `length` in floats, with a
+    // vertex starting at every 3 (or 4) floats from `offset` below `offset + length`.
+
+    struct Bounds
+    {
+        float Min[3];
+        float Max[3];
+    };
+
+    // "SSE2", "NEON" or "Scalar".
+    const char* SimdName();
+
+    void TransformVector3Coordinates(float* coordinates, size_t offset, size_t length, const float matrix[16]);
+    void TransformVector3Normals(float* normals, size_t offset, size_t length, const float matrix[16]);
+    void TransformVector4Normals(float* normals, size_t offset, size_t length, const float matrix[16]);
+
+    // Extends `bounds` with `count` vertices of `positions` from vertex `start`, `stride` floats apart.
+    void ExtractMinAndMax(const float* positions, size_t start, size_t count, size_t stride, Bounds& bounds);
+    // Extends `bounds` with the vertices of `positions` (3 floats each) referenced by `count`
+    // indices from `indexStart`.
+    void ExtractMinAndMaxIndexed(const float* positions, const int32_t* indices, size_t indexStart, size_t count, Bounds& bounds);
+    void ExtractMinAndMaxIndexed(const float* positions, const uint32_t* indices, size_t indexStart, size_t count, Bounds& bounds);
+    void ExtractMinAndMaxIndexed(const float* positions, const uint16_t* indices, size_t indexStart, size_t count, Bounds& bounds);
+
+    // Skins `length` floats of positions or normals in place, from 4 (or 8, with the extra
+    // arrays) bone influences per vertex. The extra arrays are optional.
+    void ApplySkeleton(float* data, size_t length, bool normals, const float* skeletonMatrices,
+        const float* matricesIndices, const float* matricesWeights,
+        const float* matricesIndicesExtra, const float* matricesWeightsExtra);
+
+    // A morph target of SkinAndMorph, with VertexCount * 3 floats of absolute positions and
+    // optionally normals, as MorphTarget.getPositions() and getNormals() return them.
+    struct MorphTarget
+    {
+        const float* Positions{};
+        const float* Normals{};
+        float Influence{};
+    };
+
+    // The vertices SkinAndMorph reads and writes. Positions and normals are `Stride` floats apart,
+    // so they are either separate arrays or one interleaved array. Normals, the morph targets and
+    // the skeleton are optional; a skeleton is given as ApplySkeleton takes it.
+    struct SkinMorphVertices
+    {
+        size_t VertexCount{};
+        const float* Positions{};
+        size_t PositionStride{3};
+        const float* Normals{};
+        size_t NormalStride{3};
+
+        std::vector<MorphTarget> MorphTargets{};
+
+        const float* SkeletonMatrices{};
+        const float* MatricesIndices{};
+        const float* MatricesWeights{};
+        const float* MatricesIndicesExtra{};
+        const float* MatricesWeightsExtra{};
+
+        // VertexCount * 3 floats each, OutNormals only with Normals. They may be the input arrays
+        // when those have a stride of 3.
+        float* OutPositions{};
+        float* OutNormals{};
+    };
+
+    // Blends the morph targets into `count` vertices from vertex `start`, as the morph target
+    // manager does, then skins them from up to 8 bone influences as ApplySkeleton does, computing
+    // the blended matrix once for both the position and the normal. Disjoint ranges can be
+    // processed concurrently.
+    void SkinAndMorph(const SkinMorphVertices& vertices, size_t start, size_t count);
+
+    // Frustum culling of objects by their local bounding boxes, as BoundingInfo.update followed by
+    // isInFrustum with the standard culling strategy: a bounding sphere test, then a box test.
+    //
+    // `localBoxes` holds 6 floats per object (min x, y, z, max x, y, z) and `worldMatrices` 16, an
+    // affine matrix laid out as Matrix.m. `planes` holds 6 planes of 4 floats (normal x, y, z, d)
+    // with the normals pointing inwards, as Frustum.GetPlanes returns them. For each object i in
+    // [start, start + count), sets bit i % 32 of visibility[i / 32] if it is visible and clears it
+    // otherwise, and writes its world box, 6 floats, to `worldBoxes` and its world sphere (center
+    // x, y, z, radius) to `worldSpheres` if they are not null. Ranges that start at multiples of
+    // 32 can be culled concurrently.
+    void CullBoundingBoxes(const float* localBoxes, const float* worldMatrices, const float planes[24], size_t start, size_t count,
+        uint32_t* visibility, float* worldBoxes, float* worldSpheres);
+
+    // Gaussian splat depth sorting, as a radix sort of integer keys that order as the splat
+    // depths do. Unlike the functions above, these have no SIMD version.
+
+    // Scratch memory of the splat sort, kept by the caller to reuse across sorts. Keys holds one
+    // key per splat, written by ComputeSplatDepthKeys.
+    struct SplatSortBuffers
+    {
+        std::vector<uint32_t> Keys{};
+        std::vector<uint32_t> SortedKeys{};
+        std::vector<uint32_t> Order{};
+        std::vector<uint32_t> SortedOrder{};
+    };
+
+    // Writes to `keys + start` the keys of `count` splats from splat `start`, 4 floats each in
+    // `positions`. The depth of a splat is 10000 + dot(direction, position) * depthFactor.
+    // Disjoint ranges can be computed concurrently.
+    void ComputeSplatDepthKeys(const float* positions, size_t start, size_t count, const float direction[3], float depthFactor, uint32_t* keys);
+
+    // Writes to `indices` the first `count` splats of buffers.Keys by increasing depth, splats at
+    // the same depth by increasing index.
+    void SortSplatKeys(SplatSortBuffers& buffers, size_t count, float* indices);
+
+    // Both of the above, on the calling thread.
+    void SortSplats(const float* positions, size_t count, const float direction[3], float depthFactor, SplatSortBuffers& buffers, float* indices);
+
+    namespace Scalar
+    {
+        void TransformVector3Coordinates(float* coordinates, size_t offset, size_t length, const float matrix[16]);
+        void TransformVector3Normals(float* normals, size_t offset, size_t length, const float matrix[16]);
+        void TransformVector4Normals(float* normals, size_t offset, size_t length, const float matrix[16]);
+        void ExtractMinAndMax(const float* positions, size_t start, size_t count, size_t stride, Bounds& bounds);
+        void ExtractMinAndMaxIndexed(const float* positions, const int32_t* indices, size_t indexStart, size_t count, Bounds& bounds);
+        void ExtractMinAndMaxIndexed(const float* positions, const uint32_t* indices, size_t indexStart, size_t count, Bounds& bounds);
+        void ExtractMinAndMaxIndexed(const float* positions, const uint16_t* indices, size_t indexStart, size_t count, Bounds& bounds);
+        void ApplySkeleton(float* data, size_t length, bool normals, const float* skeletonMatrices,
+            const float* matricesIndices, const float* matricesWeights,
+            const float* matricesIndicesExtra, const float* matricesWeightsExtra);
+        void SkinAndMorph(const SkinMorphVertices& vertices, size_t start, size_t count);
+        void CullBoundingBoxes(const float* localBoxes, const float* worldMatrices, const float planes[24], size_t start, size_t count,
+            uint32_t* visibility, float* worldBoxes, float* worldSpheres);
+    }
+}
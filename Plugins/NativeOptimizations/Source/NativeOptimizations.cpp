@@ -1,96 +1,60 @@
 #include <Babylon/Plugins/NativeOptimizations.h>
+#include <Babylon/Plugins/NativeOptimizationsInternal.h>
+#include <Babylon/AsyncWork.h>
 #include <Babylon/JsRuntime.h>
+
+#include <arcana/threading/task.h>
+#include <arcana/threading/task_schedulers.h>
+
+#include <algorithm>
+#include <memory>
 #include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace
 {
-    void MatrixScaleAdd(const float inputMatrix[16], float scale, float outputMatrix[16])
-    {
-        for (size_t i = 0; i < 16; ++i)
-        {
-            outputMatrix[i] += inputMatrix[i] * scale;
-        }
-    }
-
-    void MatrixTransformNormal(const float matrix[16], float &x, float &y, float &z)
-    {
-        float rx = x * matrix[0] + y * matrix[4] + z * matrix[8];
-        float ry = x * matrix[1] + y * matrix[5] + z * matrix[9];
-        float rz = x * matrix[2] + y * matrix[6] + z * matrix[10];
+    namespace Kernels = Babylon::Plugins::NativeOptimizations::Kernels;
 
-        x = rx;
-        y = ry;
-        z = rz;
-    }
+    // The functions below read the typed arrays once and run the kernels of
+    // NativeOptimizationsInternal.h on their data, instead of going through the arrays element
+    // by element.
 
-    void MatrixTransformCoordinates(const float matrix[16], float& x, float& y, float& z)
+    void ReadMatrix(const Napi::Object& transform, float matrix[16])
     {
-        float rx = x * matrix[0] + y * matrix[4] + z * matrix[8] + matrix[12];
-        float ry = x * matrix[1] + y * matrix[5] + z * matrix[9] + matrix[13];
-        float rz = x * matrix[2] + y * matrix[6] + z * matrix[10] + matrix[14];
-        float rw = 1.0f / (x * matrix[3] + y * matrix[7] + z * matrix[11] + matrix[15]);
-
-        x = rx * rw;
-        y = ry * rw;
-        z = rz * rw;
+        const auto m{transform.Get("_m").As<Napi::Float32Array>()};
+        std::copy_n(m.Data(), 16, matrix);
     }
 
-    void TransformVector3Coordinates(const Napi::CallbackInfo& info)
+    Kernels::Bounds ReadBounds(const Napi::Object& minVector, const Napi::Object& maxVector)
     {
-        auto coordinates{info[0].As<Napi::Float32Array>()};
-        const auto transform{info[1].As<Napi::Object>()};
-        const auto m{transform.Get("_m").As<Napi::Float32Array>()};
-        const auto offset{info[2].As<Napi::Number>().Uint32Value()};
-        const auto length{info[3].As<Napi::Number>().Uint32Value()};
-
-        for (size_t index = offset; index < offset + length; index += 3)
-        {
-            const auto x{coordinates[index]}, y{coordinates[index + 1]}, z{coordinates[index + 2]};
-            const auto rx{x * m[0U] + y * m[4U] + z * m[8U] + m[12U]};
-            const auto ry{x * m[1U] + y * m[5U] + z * m[9U] + m[13U]};
-            const auto rz{x * m[2U] + y * m[6U] + z * m[10U] + m[14U]};
-            const auto rw{1 / (x * m[3U] + y * m[7U] + z * m[11U] + m[15U])};
-
-            coordinates[index + 0] = rx * rw;
-            coordinates[index + 1] = ry * rw;
-            coordinates[index + 2] = rz * rw;
-        }
+        return {
+            {minVector.Get("_x").As<Napi::Number>().FloatValue(), minVector.Get("_y").As<Napi::Number>().FloatValue(), minVector.Get("_z").As<Napi::Number>().FloatValue()},
+            {maxVector.Get("_x").As<Napi::Number>().FloatValue(), maxVector.Get("_y").As<Napi::Number>().FloatValue(), maxVector.Get("_z").As<Napi::Number>().FloatValue()},
+        };
     }
 
-    void TransformVector3Normals(const Napi::CallbackInfo& info)
+    void WriteBounds(const Kernels::Bounds& bounds, Napi::Object& minVector, Napi::Object& maxVector)
     {
-        auto normals{info[0].As<Napi::Float32Array>()};
-        const auto transform{info[1].As<Napi::Object>()};
-        const auto m{transform.Get("_m").As<Napi::Float32Array>()};
-        const auto offset{info[2].As<Napi::Number>().Uint32Value()};
-        const auto length{info[3].As<Napi::Number>().Uint32Value()};
-
-        for (size_t index = offset; index < offset + length; index += 3)
-        {
-            const auto x{normals[index]}, y{normals[index + 1]}, z{normals[index + 2]};
-
-            normals[index + 0] = x * m[0U] + y * m[4U] + z * m[8U];
-            normals[index + 1] = x * m[1U] + y * m[5U] + z * m[9U];
-            normals[index + 2] = x * m[2U] + y * m[6U] + z * m[10U];
-        }
+        minVector.Set("_x", bounds.Min[0]);
+        minVector.Set("_y", bounds.Min[1]);
+        minVector.Set("_z", bounds.Min[2]);
+        maxVector.Set("_x", bounds.Max[0]);
+        maxVector.Set("_y", bounds.Max[1]);
+        maxVector.Set("_z", bounds.Max[2]);
     }
 
-    void TransformVector4Normals(const Napi::CallbackInfo& info)
+    template<void (*Kernel)(float*, size_t, size_t, const float*)>
+    void TransformVectors(const Napi::CallbackInfo& info)
     {
-        auto normals{info[0].As<Napi::Float32Array>()};
-        const auto transform{info[1].As<Napi::Object>()};
-        const auto m{transform.Get("_m").As<Napi::Float32Array>()};
+        auto vectors{info[0].As<Napi::Float32Array>()};
+        float matrix[16];
+        ReadMatrix(info[1].As<Napi::Object>(), matrix);
         const auto offset{info[2].As<Napi::Number>().Uint32Value()};
         const auto length{info[3].As<Napi::Number>().Uint32Value()};
 
-        for (size_t index = offset; index < offset + length; index += 4)
-        {
-            const auto x{normals[index]}, y{normals[index + 1]}, z{normals[index + 2]};
-
-            normals[index + 0] = x * m[0U] + y * m[4U] + z * m[8U];
-            normals[index + 1] = x * m[1U] + y * m[5U] + z * m[9U];
-            normals[index + 2] = x * m[2U] + y * m[6U] + z * m[10U];
-        }
+        Kernel(vectors.Data(), offset, length, matrix);
     }
 
     template<typename IndexT>
@@ -128,39 +92,6 @@ namespace
         }
     }
 
-    template<typename IndexT>
-    void ExtractMinAndMaxIndexedT(const Napi::Float32Array positions, const Napi::TypedArrayOf<IndexT> indices, uint32_t indexStart, uint32_t indexCount, Napi::Object minVector, Napi::Object maxVector)
-    {
-        auto minX{minVector.Get("_x").As<Napi::Number>().FloatValue()};
-        auto minY{minVector.Get("_y").As<Napi::Number>().FloatValue()};
-        auto minZ{minVector.Get("_z").As<Napi::Number>().FloatValue()};
-        auto maxX{maxVector.Get("_x").As<Napi::Number>().FloatValue()};
-        auto maxY{maxVector.Get("_y").As<Napi::Number>().FloatValue()};
-        auto maxZ{maxVector.Get("_z").As<Napi::Number>().FloatValue()};
-
-        for (auto index = indexStart; index < indexStart + indexCount; index++)
-        {
-            const auto offset{static_cast<size_t>(indices[index] * 3)};
-            const auto x{positions[offset]};
-            const auto y{positions[offset + 1]};
-            const auto z{positions[offset + 2]};
-
-            minX = std::min(minX, x);
-            minY = std::min(minY, y);
-            minZ = std::min(minZ, z);
-            maxX = std::max(maxX, x);
-            maxY = std::max(maxY, y);
-            maxZ = std::max(maxZ, z);
-        }
-
-        minVector.Set("_x", minX);
-        minVector.Set("_y", minY);
-        minVector.Set("_z", minZ);
-        maxVector.Set("_x", maxX);
-        maxVector.Set("_y", maxY);
-        maxVector.Set("_z", maxZ);
-    }
-
     void ExtractMinAndMaxIndexed(const Napi::CallbackInfo& info)
     {
         const auto positions{info[0].As<Napi::Float32Array>()};
@@ -170,22 +101,24 @@ namespace
         auto minVector{info[4].As<Napi::Object>()};
         auto maxVector{info[5].As<Napi::Object>()};
 
+        auto bounds{ReadBounds(minVector, maxVector)};
         if (indices.TypedArrayType() == napi_typedarray_type::napi_int32_array)
         {
-            ExtractMinAndMaxIndexedT<int32_t>(positions, indices.As<Napi::Int32Array>(), indexStart, indexCount, minVector, maxVector);
+            Kernels::ExtractMinAndMaxIndexed(positions.Data(), indices.As<Napi::Int32Array>().Data(), indexStart, indexCount, bounds);
         }
         else if (indices.TypedArrayType() == napi_typedarray_type::napi_uint32_array)
         {
-            ExtractMinAndMaxIndexedT<uint32_t>(positions, indices.As<Napi::Uint32Array>(), indexStart, indexCount, minVector, maxVector);
+            Kernels::ExtractMinAndMaxIndexed(positions.Data(), indices.As<Napi::Uint32Array>().Data(), indexStart, indexCount, bounds);
         }
         else if (indices.TypedArrayType() == napi_typedarray_type::napi_uint16_array)
         {
-            ExtractMinAndMaxIndexedT<uint16_t>(positions, indices.As<Napi::Uint16Array>(), indexStart, indexCount, minVector, maxVector);
+            Kernels::ExtractMinAndMaxIndexed(positions.Data(), indices.As<Napi::Uint16Array>().Data(), indexStart, indexCount, bounds);
         }
         else
         {
             throw std::runtime_error{"Indices TypedArray element type was unexpected."};
         }
+        WriteBounds(bounds, minVector, maxVector);
     }
 
     void ExtractMinAndMax(const Napi::CallbackInfo& info)
@@ -197,33 +130,9 @@ namespace
         auto minVector{info[4].As<Napi::Object>()};
         auto maxVector{info[5].As<Napi::Object>()};
 
-        auto minX{minVector.Get("_x").As<Napi::Number>().FloatValue()};
-        auto minY{minVector.Get("_y").As<Napi::Number>().FloatValue()};
-        auto minZ{minVector.Get("_z").As<Napi::Number>().FloatValue()};
-        auto maxX{maxVector.Get("_x").As<Napi::Number>().FloatValue()};
-        auto maxY{maxVector.Get("_y").As<Napi::Number>().FloatValue()};
-        auto maxZ{maxVector.Get("_z").As<Napi::Number>().FloatValue()};
-
-        for (auto index = start, offset = start * stride; index < start + count; index++, offset += stride)
-        {
-            const auto x{positions[offset]};
-            const auto y{positions[offset + 1]};
-            const auto z{positions[offset + 2]};
-
-            minX = std::min(minX, x);
-            minY = std::min(minY, y);
-            minZ = std::min(minZ, z);
-            maxX = std::max(maxX, x);
-            maxY = std::max(maxY, y);
-            maxZ = std::max(maxZ, z);
-        }
-
-        minVector.Set("_x", minX);
-        minVector.Set("_y", minY);
-        minVector.Set("_z", minZ);
-        maxVector.Set("_x", maxX);
-        maxVector.Set("_y", maxY);
-        maxVector.Set("_z", maxZ);
+        auto bounds{ReadBounds(minVector, maxVector)};
+        Kernels::ExtractMinAndMax(positions.Data(), start, count, stride, bounds);
+        WriteBounds(bounds, minVector, maxVector);
     }
 
     // Ported from `applySkeleton` function in abstractMesh.ts
@@ -247,82 +156,306 @@ namespace
             matricesWeightsExtraData = info[6].As<Napi::Float32Array>();
         }
 
-        auto matrixTransform = kind == "normal" ? MatrixTransformNormal : MatrixTransformCoordinates;
+        Kernels::ApplySkeleton(data.Data(), data.ElementLength(), kind == "normal", skeletonMatrices.Data(),
+            matricesIndicesData.Data(), matricesWeightsData.Data(),
+            matricesIndicesExtraData.has_value() ? matricesIndicesExtraData->Data() : nullptr,
+            matricesWeightsExtraData.has_value() ? matricesWeightsExtraData->Data() : nullptr);
+    }
 
-        for (size_t index = 0, matWeightIdx = 0; index < data.ElementLength(); index += 3, matWeightIdx += 4)
+    // Reads the Float32Array `name` of a skinAndMorph descriptor, checking it holds `length`
+    // floats from `offset`, and keeps it in `arrays`. Returns null for a missing optional array.
+    float* ReadSkinMorphArray(const Napi::Object& descriptor, const char* name, bool required, size_t offset, size_t length, std::vector<Napi::Float32Array>& arrays)
+    {
+        const auto value{descriptor.Get(name)};
+        if (value.IsUndefined() || value.IsNull())
         {
-            float finalMatrix[16]{};
-
-            for (size_t inf = 0; inf < 4; ++inf) {
-                float weight = matricesWeightsData[matWeightIdx + inf];
-                if (weight > 0.0f) {
-                    MatrixScaleAdd(&skeletonMatrices[static_cast<size_t>(matricesIndicesData[matWeightIdx + inf] * 16.0f)], weight, finalMatrix);
-                }
-            }
-            if (matricesIndicesExtraData.has_value() && matricesWeightsExtraData.has_value()) {
-                const auto& indices = matricesIndicesExtraData.value();
-                const auto& weights = matricesWeightsExtraData.value();
-                for (size_t inf = 0; inf < 4; ++inf) {
-                    float weight = weights[matWeightIdx + inf];
-                    if (weight > 0.0f) {
-                        MatrixScaleAdd(&skeletonMatrices[static_cast<size_t>(indices[matWeightIdx + inf] * 16.0f)], weight, finalMatrix);
-                    }
-                }
+            if (required)
+            {
+                throw Napi::Error::New(descriptor.Env(), std::string{"skinAndMorph: "} + name + " is required.");
             }
+            return nullptr;
+        }
+
+        if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_typedarray_type::napi_float32_array)
+        {
+            throw Napi::Error::New(descriptor.Env(), std::string{"skinAndMorph: "} + name + " must be a Float32Array.");
+        }
 
-            matrixTransform(finalMatrix, data[index], data[index + 1], data[index + 2]);
+        const auto array{value.As<Napi::Float32Array>()};
+        if (length > 0 && array.ElementLength() < offset + length)
+        {
+            throw Napi::Error::New(descriptor.Env(), std::string{"skinAndMorph: "} + name + " holds " + std::to_string(array.ElementLength()) + " floats, fewer than the " + std::to_string(offset + length) + " read.");
         }
+
+        arrays.push_back(array);
+        return array.Data() + offset;
+    }
+
+    size_t ReadSkinMorphSize(const Napi::Object& descriptor, const char* name, size_t defaultValue)
+    {
+        const auto value{descriptor.Get(name)};
+        return value.IsNumber() ? value.As<Napi::Number>().Uint32Value() : defaultValue;
     }
 
-    static int sortSplatQSort(const void* p1, const void* p2) {
-        const float* a = (const float*)p1;
-        const float* b = (const float*)p2;
-        if (a[1] < b[1]) {
-            return -1;
+    // Reads the descriptor of skinAndMorph and skinAndMorphAsync:
+    //   { vertexCount, positions, positionOffset?, positionStride?, normals?, normalOffset?,
+    //     normalStride?, morphTargets?: [{ positions, normals?, influence }], skeletonMatrices?,
+    //     matricesIndices?, matricesWeights?, matricesIndicesExtra?, matricesWeightsExtra?,
+    //     outPositions, outNormals? }
+    // Offsets and strides are in floats, and positions and normals may be the same interleaved
+    // array. Every array is checked to hold what the kernel reads or writes, and kept in `arrays`.
+    Kernels::SkinMorphVertices ReadSkinMorphVertices(const Napi::Value& value, std::vector<Napi::Float32Array>& arrays)
+    {
+        if (!value.IsObject())
+        {
+            throw Napi::Error::New(value.Env(), "skinAndMorph: expected a descriptor object.");
         }
-        if (a[1] > b[1]) {
-            return 1;
+
+        const auto descriptor{value.As<Napi::Object>()};
+        Kernels::SkinMorphVertices vertices{};
+        vertices.VertexCount = ReadSkinMorphSize(descriptor, "vertexCount", 0);
+        const size_t count{vertices.VertexCount};
+        // The floats from the first vertex to the end of the last one, `stride` floats apart.
+        const auto span = [count](size_t stride) { return count == 0 ? 0 : (count - 1) * stride + 3; };
+
+        vertices.PositionStride = std::max<size_t>(ReadSkinMorphSize(descriptor, "positionStride", 3), 3);
+        vertices.Positions = ReadSkinMorphArray(descriptor, "positions", true, ReadSkinMorphSize(descriptor, "positionOffset", 0), span(vertices.PositionStride), arrays);
+        vertices.NormalStride = std::max<size_t>(ReadSkinMorphSize(descriptor, "normalStride", 3), 3);
+        vertices.Normals = ReadSkinMorphArray(descriptor, "normals", false, ReadSkinMorphSize(descriptor, "normalOffset", 0), span(vertices.NormalStride), arrays);
+
+        const auto targets{descriptor.Get("morphTargets")};
+        if (targets.IsArray())
+        {
+            const auto targetArray{targets.As<Napi::Array>()};
+            for (uint32_t i = 0; i < targetArray.Length(); ++i)
+            {
+                const auto target{targetArray.Get(i).As<Napi::Object>()};
+                Kernels::MorphTarget morphTarget{};
+                morphTarget.Influence = target.Get("influence").As<Napi::Number>().FloatValue();
+                morphTarget.Positions = ReadSkinMorphArray(target, "positions", true, 0, count * 3, arrays);
+                morphTarget.Normals = ReadSkinMorphArray(target, "normals", false, 0, count * 3, arrays);
+                vertices.MorphTargets.push_back(morphTarget);
+            }
         }
-        return 0;
+
+        vertices.SkeletonMatrices = ReadSkinMorphArray(descriptor, "skeletonMatrices", false, 0, 0, arrays);
+        const bool skeleton{vertices.SkeletonMatrices != nullptr};
+        vertices.MatricesIndices = ReadSkinMorphArray(descriptor, "matricesIndices", skeleton, 0, count * 4, arrays);
+        vertices.MatricesWeights = ReadSkinMorphArray(descriptor, "matricesWeights", skeleton, 0, count * 4, arrays);
+        vertices.MatricesIndicesExtra = ReadSkinMorphArray(descriptor, "matricesIndicesExtra", false, 0, count * 4, arrays);
+        vertices.MatricesWeightsExtra = ReadSkinMorphArray(descriptor, "matricesWeightsExtra", false, 0, count * 4, arrays);
+
+        vertices.OutPositions = ReadSkinMorphArray(descriptor, "outPositions", true, 0, count * 3, arrays);
+        vertices.OutNormals = ReadSkinMorphArray(descriptor, "outNormals", vertices.Normals != nullptr, 0, count * 3, arrays);
+        return vertices;
     }
 
+    // skinAndMorph(descriptor) blends the morph targets into the vertices, then skins them, writing
+    // positions and normals in one pass on the calling thread.
+    void SkinAndMorph(const Napi::CallbackInfo& info)
+    {
+        std::vector<Napi::Float32Array> arrays{};
+        const auto vertices{ReadSkinMorphVertices(info[0], arrays)};
+        Kernels::SkinAndMorph(vertices, 0, vertices.VertexCount);
+    }
 
-    // This function is not threadsafe because of static
-    void sortSplats(const Napi::CallbackInfo& info)
+    // Vertices per task of skinAndMorphAsync, below which splitting costs more than it saves.
+    constexpr size_t MIN_VERTICES_PER_TASK{1 << 14};
+
+    // skinAndMorphAsync(descriptor) runs skinAndMorph on the thread pool, split in ranges of
+    // vertices, and returns a promise resolved once the outputs are written. None of the arrays
+    // may change until then.
+    Napi::Value SkinAndMorphAsync(const Napi::CallbackInfo& info)
     {
-        const auto modelView{ info[0].As<Napi::Object>() };
-        const auto m{ modelView.Get("_m").As<Napi::Float32Array>() };
+        std::vector<Napi::Float32Array> arrays{};
+        auto vertices{std::make_shared<const Kernels::SkinMorphVertices>(ReadSkinMorphVertices(info[0], arrays))};
+
+        auto env{info.Env()};
+        auto deferred{Napi::Promise::Deferred::New(env)};
+        auto& asyncWork{Babylon::AsyncWork::GetFromJavaScript(env)};
+
+        std::vector<Napi::Reference<Napi::Float32Array>> arrayRefs{};
+        arrayRefs.reserve(arrays.size());
+        for (const auto& array : arrays)
+        {
+            arrayRefs.push_back(Napi::Persistent(array));
+        }
+
+        const size_t vertexCount{vertices->VertexCount};
+        const size_t taskCount{std::clamp<size_t>(vertexCount / MIN_VERTICES_PER_TASK, 1, std::max(std::thread::hardware_concurrency(), 1u))};
+        const size_t verticesPerTask{(vertexCount + taskCount - 1) / taskCount};
+        std::vector<arcana::task<size_t, std::exception_ptr>> tasks{};
+        for (size_t start = 0; start < vertexCount || tasks.empty(); start += verticesPerTask)
+        {
+            const size_t count{std::min(verticesPerTask, vertexCount - start)};
+            tasks.push_back(asyncWork.Run([vertices, start, count](const arcana::cancellation&) {
+                Kernels::SkinAndMorph(*vertices, start, count);
+                return count;
+            }));
+        }
+
+        asyncWork.Then(arcana::when_all(gsl::make_span(tasks)),
+            [deferred, env, arrayRefs{std::move(arrayRefs)}](const arcana::expected<std::vector<size_t>, std::exception_ptr>& result) {
+                if (result.has_error())
+                {
+                    deferred.Reject(Napi::Error::New(env, result.error()).Value());
+                    return;
+                }
 
-        auto positions{ info[1].As<Napi::Float32Array>() };
+                deferred.Resolve(env.Undefined());
+            });
 
-        auto indices{ info[2].As<Napi::Float32Array>() };
+        return deferred.Promise();
+    }
+
+    // Reads the 6 frustum planes of cullBoundingBoxes, either a Float32Array of 24 floats or the
+    // Plane array of Scene.frustumPlanes.
+    void ReadFrustumPlanes(const Napi::Value& value, float planes[24])
+    {
+        if (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_typedarray_type::napi_float32_array &&
+            value.As<Napi::Float32Array>().ElementLength() >= 24)
+        {
+            std::copy_n(value.As<Napi::Float32Array>().Data(), 24, planes);
+            return;
+        }
+
+        if (!value.IsArray() || value.As<Napi::Array>().Length() < 6)
+        {
+            throw Napi::Error::New(value.Env(), "cullBoundingBoxes: planes must be a Float32Array of 24 floats or an array of 6 Planes.");
+        }
 
-        auto rightHand{ info[3].As<Napi::Boolean>() };
+        const auto array{value.As<Napi::Array>()};
+        for (uint32_t plane = 0; plane < 6; ++plane)
+        {
+            const auto object{array.Get(plane).As<Napi::Object>()};
+            const auto normal{object.Get("normal").As<Napi::Object>()};
+            planes[plane * 4] = normal.Get("_x").As<Napi::Number>().FloatValue();
+            planes[plane * 4 + 1] = normal.Get("_y").As<Napi::Number>().FloatValue();
+            planes[plane * 4 + 2] = normal.Get("_z").As<Napi::Number>().FloatValue();
+            planes[plane * 4 + 3] = object.Get("d").As<Napi::Number>().FloatValue();
+        }
+    }
 
+    // cullBoundingBoxes(count, localBoxes, worldMatrices, planes, visibility, worldBoxes?, worldSpheres?)
+    // culls `count` objects packed in Float32Arrays, 6 floats of local box and 16 of world matrix
+    // each, setting bit i % 32 of the Uint32Array visibility[i / 32] for every visible object i.
+    // worldBoxes (6 floats each) and worldSpheres (4 floats each) receive the world bounds if given.
+    void CullBoundingBoxes(const Napi::CallbackInfo& info)
+    {
+        const auto env{info.Env()};
+        const size_t count{info[0].As<Napi::Number>().Uint32Value()};
+        const auto localBoxes{info[1].As<Napi::Float32Array>()};
+        const auto worldMatrices{info[2].As<Napi::Float32Array>()};
+        float planes[24];
+        ReadFrustumPlanes(info[3], planes);
+        const auto visibility{info[4].As<Napi::Uint32Array>()};
+
+        const auto optionalArray = [&info](size_t index) {
+            return info.Length() > index && info[index].IsTypedArray() ? std::optional<Napi::Float32Array>{info[index].As<Napi::Float32Array>()} : std::nullopt;
+        };
+        const auto worldBoxes{optionalArray(5)};
+        const auto worldSpheres{optionalArray(6)};
 
-        float depthFactor = -1.f;
-        if (rightHand) {
-            depthFactor = 1.f;
+        if (localBoxes.ElementLength() < count * 6 || worldMatrices.ElementLength() < count * 16 || visibility.ElementLength() < (count + 31) / 32 ||
+            (worldBoxes.has_value() && worldBoxes->ElementLength() < count * 6) || (worldSpheres.has_value() && worldSpheres->ElementLength() < count * 4))
+        {
+            throw Napi::Error::New(env, "cullBoundingBoxes: an array holds fewer elements than count objects need.");
         }
 
-        const auto splatCount = indices.ElementLength();
-        float vp[3] = { m[2u], m[6u], m[10u] };
-        static std::vector<float> depthMix;
+        Kernels::CullBoundingBoxes(localBoxes.Data(), worldMatrices.Data(), planes, 0, count, visibility.Data(),
+            worldBoxes.has_value() ? worldBoxes->Data() : nullptr, worldSpheres.has_value() ? worldSpheres->Data() : nullptr);
+    }
+
+    // Splats per depth task of sortSplatsAsync, below which splitting costs more than it saves.
+    constexpr size_t MIN_SPLATS_PER_TASK{1 << 16};
+
+    struct SplatSortArguments
+    {
+        float Direction[3];
+        float DepthFactor;
+    };
+
+    SplatSortArguments ReadSplatSortArguments(const Napi::CallbackInfo& info)
+    {
+        const auto m{info[0].As<Napi::Object>().Get("_m").As<Napi::Float32Array>()};
+        const bool rightHand{info[3].As<Napi::Boolean>()};
+        return {{m[2u], m[6u], m[10u]}, rightHand ? 1.f : -1.f};
+    }
+
+    // sortSplats(modelView, positions, indices, rightHand) writes to indices the splats by
+    // increasing depth. The sort buffers are per thread, so runtimes on different threads can sort
+    // concurrently.
+    void SortSplats(const Napi::CallbackInfo& info)
+    {
+        const auto arguments{ReadSplatSortArguments(info)};
+        const auto positions{info[1].As<Napi::Float32Array>()};
+        auto indices{info[2].As<Napi::Float32Array>()};
 
-        depthMix.resize(splatCount * 2);
+        thread_local Kernels::SplatSortBuffers buffers{};
+        Kernels::SortSplats(positions.Data(), indices.ElementLength(), arguments.Direction, arguments.DepthFactor, buffers, indices.Data());
+    }
 
-        for (size_t i = 0; i < splatCount; i++)
+    // sortSplatsAsync(modelView, positions, indices, rightHand) sorts as sortSplats on the thread
+    // pool, computing the depths in parallel, and returns a promise resolved with indices once
+    // they are written. positions must not change until then.
+    Napi::Value SortSplatsAsync(const Napi::CallbackInfo& info)
+    {
+        const auto arguments{ReadSplatSortArguments(info)};
+        const auto positions{info[1].As<Napi::Float32Array>()};
+        const auto indices{info[2].As<Napi::Float32Array>()};
+
+        auto env{info.Env()};
+        auto deferred{Napi::Promise::Deferred::New(env)};
+
+        const size_t splatCount{indices.ElementLength()};
+        if (positions.ElementLength() < splatCount * 4)
         {
-            depthMix[i * 2 + 0] = float(i);
-            depthMix[i * 2 + 1] = 10000.f + (vp[0] * positions[4 * i + 0] + vp[1] * positions[4 * i + 1] + vp[2] * positions[4 * i + 2]) * depthFactor;
+            deferred.Reject(Napi::Error::New(env, "sortSplatsAsync: positions holds fewer than 4 floats per index.").Value());
+            return deferred.Promise();
         }
 
-        qsort(depthMix.data(), splatCount, 2 * sizeof(float), sortSplatQSort);
+        auto& asyncWork{Babylon::AsyncWork::GetFromJavaScript(env)};
+        auto buffers{std::make_shared<Kernels::SplatSortBuffers>()};
+        buffers->Keys.resize(splatCount);
+        auto sortedIndices{std::make_shared<std::vector<float>>(splatCount)};
 
-        for (size_t i = 0; i < splatCount; i++)
+        const float* positionData{positions.Data()};
+        const size_t taskCount{std::clamp<size_t>(splatCount / MIN_SPLATS_PER_TASK, 1, std::max(std::thread::hardware_concurrency(), 1u))};
+        const size_t splatsPerTask{(splatCount + taskCount - 1) / taskCount};
+        std::vector<arcana::task<size_t, std::exception_ptr>> tasks{};
+        for (size_t start = 0; start < splatCount || tasks.empty(); start += splatsPerTask)
         {
-            indices[i] = depthMix[i * 2 + 0];
+            const size_t count{std::min(splatsPerTask, splatCount - start)};
+            tasks.push_back(asyncWork.Run([positionData, start, count, arguments, buffers](const arcana::cancellation&) {
+                Kernels::ComputeSplatDepthKeys(positionData, start, count, arguments.Direction, arguments.DepthFactor, buffers->Keys.data());
+                return count;
+            }));
         }
+
+        auto sorted{asyncWork.ThenRun(arcana::when_all(gsl::make_span(tasks)), [buffers, sortedIndices](const std::vector<size_t>&) {
+            Kernels::SortSplatKeys(*buffers, sortedIndices->size(), sortedIndices->data());
+        })};
+
+        asyncWork.Then(std::move(sorted),
+            [deferred, env, sortedIndices, positionsRef{Napi::Persistent(positions)}, indicesRef{Napi::Persistent(indices)}](const arcana::expected<void, std::exception_ptr>& result) {
+                if (result.has_error())
+                {
+                    deferred.Reject(Napi::Error::New(env, result.error()).Value());
+                    return;
+                }
+
+                auto indices{indicesRef.Value()};
+                if (indices.ElementLength() != sortedIndices->size())
+                {
+                    deferred.Reject(Napi::Error::New(env, "sortSplatsAsync: indices was resized during the sort.").Value());
+                    return;
+                }
+
+                std::copy(sortedIndices->begin(), sortedIndices->end(), indices.Data());
+                deferred.Resolve(indices);
+            });
+
+        return deferred.Promise();
     }
 }
 
@@ -330,14 +463,20 @@ namespace Babylon::Plugins::NativeOptimizations
 {
     void BABYLON_API Initialize(Napi::Env env)
     {
+        AsyncWork::CreateForJavaScript(env);
+
         auto nativeObject{JsRuntime::NativeObject::GetFromJavaScript(env)};
         nativeObject.Set("_ApplySkeleton", Napi::Function::New(env, ApplySkeleton, "_ApplySkeleton"));
-        nativeObject.Set("_TransformVector3Coordinates", Napi::Function::New(env, TransformVector3Coordinates, "_TransformVector3Coordinates"));
-        nativeObject.Set("_TransformVector3Normals", Napi::Function::New(env, TransformVector3Normals, "_TransformVector3Normals"));
-        nativeObject.Set("_TransformVector4Normals", Napi::Function::New(env, TransformVector4Normals, "_TransformVector4Normals"));
+        nativeObject.Set("_TransformVector3Coordinates", Napi::Function::New(env, TransformVectors<Kernels::TransformVector3Coordinates>, "_TransformVector3Coordinates"));
+        nativeObject.Set("_TransformVector3Normals", Napi::Function::New(env, TransformVectors<Kernels::TransformVector3Normals>, "_TransformVector3Normals"));
+        nativeObject.Set("_TransformVector4Normals", Napi::Function::New(env, TransformVectors<Kernels::TransformVector4Normals>, "_TransformVector4Normals"));
         nativeObject.Set("_FlipFaces", Napi::Function::New(env, FlipFaces, "_FlipFaces"));
         nativeObject.Set("extractMinAndMaxIndexed", Napi::Function::New(env, ExtractMinAndMaxIndexed, "extractMinAndMaxIndexed"));
         nativeObject.Set("extractMinAndMax", Napi::Function::New(env, ExtractMinAndMax, "extractMinAndMax"));
-        nativeObject.Set("sortSplats", Napi::Function::New(env, sortSplats, "sortSplats"));
+        nativeObject.Set("cullBoundingBoxes", Napi::Function::New(env, CullBoundingBoxes, "cullBoundingBoxes"));
+        nativeObject.Set("skinAndMorph", Napi::Function::New(env, SkinAndMorph, "skinAndMorph"));
+        nativeObject.Set("skinAndMorphAsync", Napi::Function::New(env, SkinAndMorphAsync, "skinAndMorphAsync"));
+        nativeObject.Set("sortSplats", Napi::Function::New(env, SortSplats, "sortSplats"));
+        nativeObject.Set("sortSplatsAsync", Napi::Function::New(env, SortSplatsAsync, "sortSplatsAsync"));
     }
 }
@@ -0,0 +1,961 @@
+#include <Babylon/Plugins/NativeOptimizationsInternal.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NATIVE_OPTIMIZATIONS_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+// 32-bit ARM NEON has no vector division, so it takes the scalar path.
+#define NATIVE_OPTIMIZATIONS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    using Babylon::Plugins::NativeOptimizations::Kernels::Bounds;
+    using Babylon::Plugins::NativeOptimizations::Kernels::MorphTarget;
+    using Babylon::Plugins::NativeOptimizations::Kernels::SkinMorphVertices;
+
+    // The float operations of every kernel, shared by the scalar kernels and the tails of the
+    // SIMD ones so that both round identically.
+
+    void TransformCoordinates(const float* m, float& x, float& y, float& z)
+    {
+        const float rx{x * m[0] + y * m[4] + z * m[8] + m[12]};
+        const float ry{x * m[1] + y * m[5] + z * m[9] + m[13]};
+        const float rz{x * m[2] + y * m[6] + z * m[10] + m[14]};
+        const float rw{1.0f / (x * m[3] + y * m[7] + z * m[11] + m[15])};
+
+        x = rx * rw;
+        y = ry * rw;
+        z = rz * rw;
+    }
+
+    void TransformNormal(const float* m, float& x, float& y, float& z)
+    {
+        const float rx{x * m[0] + y * m[4] + z * m[8]};
+        const float ry{x * m[1] + y * m[5] + z * m[9]};
+        const float rz{x * m[2] + y * m[6] + z * m[10]};
+
+        x = rx;
+        y = ry;
+        z = rz;
+    }
+
+    void Extend(Bounds& bounds, float x, float y, float z)
+    {
+        bounds.Min[0] = std::min(bounds.Min[0], x);
+        bounds.Min[1] = std::min(bounds.Min[1], y);
+        bounds.Min[2] = std::min(bounds.Min[2], z);
+        bounds.Max[0] = std::max(bounds.Max[0], x);
+        bounds.Max[1] = std::max(bounds.Max[1], y);
+        bounds.Max[2] = std::max(bounds.Max[2], z);
+    }
+
+    void MatrixScaleAdd(const float* inputMatrix, float scale, float* outputMatrix)
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            outputMatrix[i] += inputMatrix[i] * scale;
+        }
+    }
+
+    template<size_t Stride, typename TransformT>
+    void TransformScalar(float* data, size_t offset, size_t length, const float* matrix, TransformT transform)
+    {
+        for (size_t index = offset; index < offset + length; index += Stride)
+        {
+            transform(matrix, data[index], data[index + 1], data[index + 2]);
+        }
+    }
+
+    template<typename IndexT>
+    void ExtractMinAndMaxIndexedScalar(const float* positions, const IndexT* indices, size_t indexStart, size_t count, Bounds& bounds)
+    {
+        for (size_t index = indexStart; index < indexStart + count; ++index)
+        {
+            const auto offset{static_cast<size_t>(indices[index] * 3)};
+            Extend(bounds, positions[offset], positions[offset + 1], positions[offset + 2]);
+        }
+    }
+
+    // Adds to `finalMatrix` the bone matrices of the 4 (or 8, with the extra arrays) influences
+    // from `matWeightIdx`, scaled by their weights.
+    void BlendMatrix(const float* skeletonMatrices, const float* matricesIndices, const float* matricesWeights,
+        const float* matricesIndicesExtra, const float* matricesWeightsExtra, size_t matWeightIdx, float finalMatrix[16])
+    {
+        for (size_t inf = 0; inf < 4; ++inf)
+        {
+            const float weight{matricesWeights[matWeightIdx + inf]};
+            if (weight > 0.0f)
+            {
+                MatrixScaleAdd(&skeletonMatrices[static_cast<size_t>(matricesIndices[matWeightIdx + inf] * 16.0f)], weight, finalMatrix);
+            }
+        }
+        if (matricesIndicesExtra != nullptr && matricesWeightsExtra != nullptr)
+        {
+            for (size_t inf = 0; inf < 4; ++inf)
+            {
+                const float weight{matricesWeightsExtra[matWeightIdx + inf]};
+                if (weight > 0.0f)
+                {
+                    MatrixScaleAdd(&skeletonMatrices[static_cast<size_t>(matricesIndicesExtra[matWeightIdx + inf] * 16.0f)], weight, finalMatrix);
+                }
+            }
+        }
+    }
+
+    void ApplySkeletonScalar(float* data, size_t length, bool normals, const float* skeletonMatrices,
+        const float* matricesIndices, const float* matricesWeights,
+        const float* matricesIndicesExtra, const float* matricesWeightsExtra)
+    {
+        const auto matrixTransform{normals ? TransformNormal : TransformCoordinates};
+
+        for (size_t index = 0, matWeightIdx = 0; index < length; index += 3, matWeightIdx += 4)
+        {
+            float finalMatrix[16]{};
+            BlendMatrix(skeletonMatrices, matricesIndices, matricesWeights, matricesIndicesExtra, matricesWeightsExtra, matWeightIdx, finalMatrix);
+            matrixTransform(finalMatrix, data[index], data[index + 1], data[index + 2]);
+        }
+    }
+
+    // block[i] += (target[i] - base[i]) * influence, for `length` floats.
+    void MorphScalar(float* block, const float* base, const float* target, float influence, size_t length)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            block[i] += (target[i] - base[i]) * influence;
+        }
+    }
+
+    void SkinVertexScalar(const SkinMorphVertices& vertices, size_t vertex, float* position, float* normal)
+    {
+        float finalMatrix[16]{};
+        BlendMatrix(vertices.SkeletonMatrices, vertices.MatricesIndices, vertices.MatricesWeights,
+            vertices.MatricesIndicesExtra, vertices.MatricesWeightsExtra, vertex * 4, finalMatrix);
+
+        TransformCoordinates(finalMatrix, position[0], position[1], position[2]);
+        if (normal != nullptr)
+        {
+            TransformNormal(finalMatrix, normal[0], normal[1], normal[2]);
+        }
+    }
+
+    // Vertices per block of SkinAndMorph. The morph targets are added to a block one after the
+    // other, so each is read in runs long enough for the hardware prefetcher, while the block
+    // stays in L2. 64 vertex blocks were a third slower with 50 targets.
+    constexpr size_t SKIN_MORPH_BLOCK_SIZE{1024};
+
+    // Copies `count` vertices from vertex `start`, `stride` floats apart, to `block`, 3 floats each.
+    void GatherBlock(const float* data, size_t stride, size_t start, size_t count, float* block)
+    {
+        for (size_t vertex = 0; vertex < count; ++vertex)
+        {
+            const float* p{data + (start + vertex) * stride};
+            block[vertex * 3] = p[0];
+            block[vertex * 3 + 1] = p[1];
+            block[vertex * 3 + 2] = p[2];
+        }
+    }
+
+    // SkinAndMorph, with `morph` adding a target to a block as MorphScalar does and `skin` skinning
+    // a vertex as SkinVertexScalar does.
+    template<typename MorphT, typename SkinT>
+    void SkinAndMorphBlocks(const SkinMorphVertices& vertices, size_t start, size_t count, MorphT morph, SkinT skin)
+    {
+        std::vector<MorphTarget> targets{};
+        std::copy_if(vertices.MorphTargets.begin(), vertices.MorphTargets.end(), std::back_inserter(targets), [](const MorphTarget& target) {
+            return target.Influence != 0.0f;
+        });
+
+        const bool normals{vertices.Normals != nullptr && vertices.OutNormals != nullptr};
+        const bool skeleton{vertices.SkeletonMatrices != nullptr};
+
+        std::vector<float> blocks(SKIN_MORPH_BLOCK_SIZE * 3 * (normals ? 4 : 2));
+        float* basePositions{blocks.data()};
+        float* positions{basePositions + SKIN_MORPH_BLOCK_SIZE * 3};
+        float* baseNormals{positions + SKIN_MORPH_BLOCK_SIZE * 3};
+        float* normalBlock{baseNormals + SKIN_MORPH_BLOCK_SIZE * 3};
+        for (size_t blockStart = start; blockStart < start + count; blockStart += SKIN_MORPH_BLOCK_SIZE)
+        {
+            const size_t blockCount{std::min(SKIN_MORPH_BLOCK_SIZE, start + count - blockStart)};
+            const size_t length{blockCount * 3};
+
+            GatherBlock(vertices.Positions, vertices.PositionStride, blockStart, blockCount, basePositions);
+            std::copy_n(basePositions, length, positions);
+            if (normals)
+            {
+                GatherBlock(vertices.Normals, vertices.NormalStride, blockStart, blockCount, baseNormals);
+                std::copy_n(baseNormals, length, normalBlock);
+            }
+
+            for (const auto& target : targets)
+            {
+                morph(positions, basePositions, target.Positions + blockStart * 3, target.Influence, length);
+                if (normals && target.Normals != nullptr)
+                {
+                    morph(normalBlock, baseNormals, target.Normals + blockStart * 3, target.Influence, length);
+                }
+            }
+
+            if (skeleton)
+            {
+                for (size_t vertex = 0; vertex < blockCount; ++vertex)
+                {
+                    skin(vertices, blockStart + vertex, positions + vertex * 3, normals ? normalBlock + vertex * 3 : nullptr);
+                }
+            }
+
+            std::copy_n(positions, length, vertices.OutPositions + blockStart * 3);
+            if (normals)
+            {
+                std::copy_n(normalBlock, length, vertices.OutNormals + blockStart * 3);
+            }
+        }
+    }
+
+    void SetVisibility(uint32_t* visibility, size_t object, bool visible)
+    {
+        const uint32_t bit{1u << (object % 32)};
+        visibility[object / 32] = visible ? (visibility[object / 32] | bit) : (visibility[object / 32] & ~bit);
+    }
+
+    // Bounds and visibility of one object, as the SIMD version computes them for 4. The world box
+    // is the center and half extents of the local box transformed by an affine world matrix, and
+    // the box is outside a plane when its corner furthest along the plane normal is behind it.
+    bool CullBoundingBox(const float* box, const float* m, const float* planes, float* worldBox, float* worldSphere)
+    {
+        const float cx{(box[0] + box[3]) * 0.5f}, cy{(box[1] + box[4]) * 0.5f}, cz{(box[2] + box[5]) * 0.5f};
+        const float ex{(box[3] - box[0]) * 0.5f}, ey{(box[4] - box[1]) * 0.5f}, ez{(box[5] - box[2]) * 0.5f};
+
+        const float wx{cx * m[0] + cy * m[4] + cz * m[8] + m[12]};
+        const float wy{cx * m[1] + cy * m[5] + cz * m[9] + m[13]};
+        const float wz{cx * m[2] + cy * m[6] + cz * m[10] + m[14]};
+
+        // The box axes in world space, scaled by the half extents.
+        const float a0x{m[0] * ex}, a0y{m[1] * ex}, a0z{m[2] * ex};
+        const float a1x{m[4] * ey}, a1y{m[5] * ey}, a1z{m[6] * ey};
+        const float a2x{m[8] * ez}, a2y{m[9] * ez}, a2z{m[10] * ez};
+
+        // The sphere of BoundingSphere: the local box diagonal scaled by the largest component of
+        // the matrix applied to (1, 1, 1).
+        const float dx{box[3] - box[0]}, dy{box[4] - box[1]}, dz{box[5] - box[2]};
+        const float radius{std::sqrt(dx * dx + dy * dy + dz * dz) * 0.5f};
+        const float scale{std::max(std::max(std::abs(m[0] + m[4] + m[8]), std::abs(m[1] + m[5] + m[9])), std::abs(m[2] + m[6] + m[10]))};
+        const float worldRadius{scale * radius};
+
+        if (worldBox != nullptr)
+        {
+            const float hx{std::abs(a0x) + std::abs(a1x) + std::abs(a2x)};
+            const float hy{std::abs(a0y) + std::abs(a1y) + std::abs(a2y)};
+            const float hz{std::abs(a0z) + std::abs(a1z) + std::abs(a2z)};
+            worldBox[0] = wx - hx;
+            worldBox[1] = wy - hy;
+            worldBox[2] = wz - hz;
+            worldBox[3] = wx + hx;
+            worldBox[4] = wy + hy;
+            worldBox[5] = wz + hz;
+        }
+        if (worldSphere != nullptr)
+        {
+            worldSphere[0] = wx;
+            worldSphere[1] = wy;
+            worldSphere[2] = wz;
+            worldSphere[3] = worldRadius;
+        }
+
+        bool culled{false};
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            const float* p{planes + plane * 4};
+            const float distance{wx * p[0] + wy * p[1] + wz * p[2] + p[3]};
+            const float reach{std::abs(a0x * p[0] + a0y * p[1] + a0z * p[2]) + std::abs(a1x * p[0] + a1y * p[1] + a1z * p[2]) + std::abs(a2x * p[0] + a2y * p[1] + a2z * p[2])};
+            culled = culled || distance <= -worldRadius || distance + reach < 0.0f;
+        }
+        return !culled;
+    }
+
+#if defined(NATIVE_OPTIMIZATIONS_SSE2) || defined(NATIVE_OPTIMIZATIONS_NEON)
+
+#if defined(NATIVE_OPTIMIZATIONS_SSE2)
+    using Vector = __m128;
+
+    Vector Load(const float* p) { return _mm_loadu_ps(p); }
+    void Store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+    Vector Splat(float v) { return _mm_set1_ps(v); }
+    Vector Set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+    Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+    Vector Sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+    Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+    Vector Div(Vector a, Vector b) { return _mm_div_ps(a, b); }
+    // (v < bound) ? v : bound, which is std::min(bound, v), NaNs included.
+    Vector Min(Vector bound, Vector v) { return _mm_min_ps(v, bound); }
+    // (bound < v) ? v : bound, which is std::max(bound, v).
+    Vector Max(Vector bound, Vector v) { return _mm_max_ps(v, bound); }
+    Vector SplatW(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+// Lanes i0 and i1 of a, then lanes i2 and i3 of b.
+#define NATIVE_OPTIMIZATIONS_SHUFFLE(a, b, i0, i1, i2, i3) _mm_shuffle_ps((a), (b), _MM_SHUFFLE((i3), (i2), (i1), (i0)))
+
+    // Loads 4 vertices of 3 floats as x, y and z vectors.
+    void Load3(const float* p, Vector& x, Vector& y, Vector& z)
+    {
+        const Vector a{_mm_loadu_ps(p)};     // x0 y0 z0 x1
+        const Vector b{_mm_loadu_ps(p + 4)}; // y1 z1 x2 y2
+        const Vector c{_mm_loadu_ps(p + 8)}; // z2 x3 y3 z3
+
+        x = NATIVE_OPTIMIZATIONS_SHUFFLE(a, NATIVE_OPTIMIZATIONS_SHUFFLE(b, c, 2, 2, 1, 1), 0, 3, 0, 2);
+        y = NATIVE_OPTIMIZATIONS_SHUFFLE(NATIVE_OPTIMIZATIONS_SHUFFLE(a, b, 1, 1, 0, 0), NATIVE_OPTIMIZATIONS_SHUFFLE(b, c, 3, 3, 2, 2), 0, 2, 0, 2);
+        z = NATIVE_OPTIMIZATIONS_SHUFFLE(NATIVE_OPTIMIZATIONS_SHUFFLE(a, b, 2, 2, 1, 1), NATIVE_OPTIMIZATIONS_SHUFFLE(c, c, 0, 0, 3, 3), 0, 2, 0, 2);
+    }
+
+    void Store3(float* p, Vector x, Vector y, Vector z)
+    {
+        _mm_storeu_ps(p, NATIVE_OPTIMIZATIONS_SHUFFLE(NATIVE_OPTIMIZATIONS_SHUFFLE(x, y, 0, 0, 0, 0), NATIVE_OPTIMIZATIONS_SHUFFLE(z, x, 0, 0, 1, 1), 0, 2, 0, 2));
+        _mm_storeu_ps(p + 4, NATIVE_OPTIMIZATIONS_SHUFFLE(NATIVE_OPTIMIZATIONS_SHUFFLE(y, z, 1, 1, 1, 1), NATIVE_OPTIMIZATIONS_SHUFFLE(x, y, 2, 2, 2, 2), 0, 2, 0, 2));
+        _mm_storeu_ps(p + 8, NATIVE_OPTIMIZATIONS_SHUFFLE(NATIVE_OPTIMIZATIONS_SHUFFLE(z, x, 2, 2, 3, 3), NATIVE_OPTIMIZATIONS_SHUFFLE(y, z, 3, 3, 3, 3), 0, 2, 0, 2));
+    }
+
+    // Loads 4 vertices of 4 floats as x, y, z and w vectors.
+    void Load4(const float* p, Vector& x, Vector& y, Vector& z, Vector& w)
+    {
+        x = _mm_loadu_ps(p);
+        y = _mm_loadu_ps(p + 4);
+        z = _mm_loadu_ps(p + 8);
+        w = _mm_loadu_ps(p + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+    }
+
+    void Store4(float* p, Vector x, Vector y, Vector z, Vector w)
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(p, x);
+        _mm_storeu_ps(p + 4, y);
+        _mm_storeu_ps(p + 8, z);
+        _mm_storeu_ps(p + 12, w);
+    }
+
+    void Transpose4(Vector& a, Vector& b, Vector& c, Vector& d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+    Vector Abs(Vector v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+    Vector Sqrt(Vector v) { return _mm_sqrt_ps(v); }
+
+    // Lane masks of comparisons, and their lanes as the low 4 bits of an integer.
+    using Mask = __m128;
+    Mask LessEqual(Vector a, Vector b) { return _mm_cmple_ps(a, b); }
+    Mask Less(Vector a, Vector b) { return _mm_cmplt_ps(a, b); }
+    Mask Or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+    Mask NoLanes() { return _mm_setzero_ps(); }
+    unsigned int LaneBits(Mask mask) { return static_cast<unsigned int>(_mm_movemask_ps(mask)); }
+
+#undef NATIVE_OPTIMIZATIONS_SHUFFLE
+#else
+    using Vector = float32x4_t;
+
+    Vector Load(const float* p) { return vld1q_f32(p); }
+    void Store(float* p, Vector v) { vst1q_f32(p, v); }
+    Vector Splat(float v) { return vdupq_n_f32(v); }
+    Vector Set(float a, float b, float c, float d)
+    {
+        const float lanes[4]{a, b, c, d};
+        return vld1q_f32(lanes);
+    }
+    Vector Add(Vector a, Vector b) { return vaddq_f32(a, b); }
+    Vector Sub(Vector a, Vector b) { return vsubq_f32(a, b); }
+    Vector Mul(Vector a, Vector b) { return vmulq_f32(a, b); }
+    Vector Div(Vector a, Vector b) { return vdivq_f32(a, b); }
+    // vminq/vmaxq return NaN for a NaN operand, unlike std::min/max, so select explicitly.
+    Vector Min(Vector bound, Vector v) { return vbslq_f32(vcltq_f32(v, bound), v, bound); }
+    Vector Max(Vector bound, Vector v) { return vbslq_f32(vcltq_f32(bound, v), v, bound); }
+    Vector SplatW(Vector v) { return vdupq_laneq_f32(v, 3); }
+
+    void Load3(const float* p, Vector& x, Vector& y, Vector& z)
+    {
+        const float32x4x3_t v{vld3q_f32(p)};
+        x = v.val[0];
+        y = v.val[1];
+        z = v.val[2];
+    }
+
+    void Store3(float* p, Vector x, Vector y, Vector z)
+    {
+        vst3q_f32(p, float32x4x3_t{{x, y, z}});
+    }
+
+    void Load4(const float* p, Vector& x, Vector& y, Vector& z, Vector& w)
+    {
+        const float32x4x4_t v{vld4q_f32(p)};
+        x = v.val[0];
+        y = v.val[1];
+        z = v.val[2];
+        w = v.val[3];
+    }
+
+    void Store4(float* p, Vector x, Vector y, Vector z, Vector w)
+    {
+        vst4q_f32(p, float32x4x4_t{{x, y, z, w}});
+    }
+
+    void Transpose4(Vector& a, Vector& b, Vector& c, Vector& d)
+    {
+        const float32x4x2_t ab{vtrnq_f32(a, b)}; // a0 b0 a2 b2, a1 b1 a3 b3
+        const float32x4x2_t cd{vtrnq_f32(c, d)}; // c0 d0 c2 d2, c1 d1 c3 d3
+        a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+    Vector Abs(Vector v) { return vabsq_f32(v); }
+    Vector Sqrt(Vector v) { return vsqrtq_f32(v); }
+
+    using Mask = uint32x4_t;
+    Mask LessEqual(Vector a, Vector b) { return vcleq_f32(a, b); }
+    Mask Less(Vector a, Vector b) { return vcltq_f32(a, b); }
+    Mask Or(Mask a, Mask b) { return vorrq_u32(a, b); }
+    Mask NoLanes() { return vdupq_n_u32(0); }
+    unsigned int LaneBits(Mask mask)
+    {
+        const uint32_t bits[4]{1, 2, 4, 8};
+        return vaddvq_u32(vandq_u32(mask, vld1q_u32(bits)));
+    }
+#endif
+
+    // Sums are evaluated left to right, as in the scalar expressions. The file is built without
+    // floating-point contraction (see CMakeLists.txt), so neither path is fused into FMAs.
+    Vector Dot3(Vector x, Vector y, Vector z, float m0, float m1, float m2)
+    {
+        const Vector xm{Mul(x, Splat(m0))};
+        const Vector ym{Mul(y, Splat(m1))};
+        const Vector zm{Mul(z, Splat(m2))};
+        return Add(Add(xm, ym), zm);
+    }
+
+    void TransformCoordinates4(const float* m, Vector& x, Vector& y, Vector& z)
+    {
+        const Vector rx{Add(Dot3(x, y, z, m[0], m[4], m[8]), Splat(m[12]))};
+        const Vector ry{Add(Dot3(x, y, z, m[1], m[5], m[9]), Splat(m[13]))};
+        const Vector rz{Add(Dot3(x, y, z, m[2], m[6], m[10]), Splat(m[14]))};
+        const Vector rw{Div(Splat(1.0f), Add(Dot3(x, y, z, m[3], m[7], m[11]), Splat(m[15])))};
+
+        x = Mul(rx, rw);
+        y = Mul(ry, rw);
+        z = Mul(rz, rw);
+    }
+
+    void TransformNormal4(const float* m, Vector& x, Vector& y, Vector& z)
+    {
+        const Vector rx{Dot3(x, y, z, m[0], m[4], m[8])};
+        const Vector ry{Dot3(x, y, z, m[1], m[5], m[9])};
+        const Vector rz{Dot3(x, y, z, m[2], m[6], m[10])};
+
+        x = rx;
+        y = ry;
+        z = rz;
+    }
+
+    // Vertices in [offset, offset + length) starting every `stride` floats.
+    size_t VertexCount(size_t length, size_t stride)
+    {
+        return (length + stride - 1) / stride;
+    }
+
+    // Transforms 4 vertices of 3 floats at a time, then the rest one by one.
+    template<typename Transform4T, typename TransformT>
+    void TransformVector3(float* data, size_t offset, size_t length, const float* matrix, Transform4T transform4, TransformT transform)
+    {
+        const size_t vertexCount{VertexCount(length, 3)};
+        const size_t blockEnd{offset + (vertexCount / 4) * 12};
+
+        size_t index{offset};
+        for (; index < blockEnd; index += 12)
+        {
+            Vector x, y, z;
+            Load3(data + index, x, y, z);
+            transform4(matrix, x, y, z);
+            Store3(data + index, x, y, z);
+        }
+
+        TransformScalar<3>(data, index, offset + length - index, matrix, transform);
+    }
+
+    void ExtendLanes(Vector& minX, Vector& minY, Vector& minZ, Vector& maxX, Vector& maxY, Vector& maxZ, Vector x, Vector y, Vector z)
+    {
+        minX = Min(minX, x);
+        minY = Min(minY, y);
+        minZ = Min(minZ, z);
+        maxX = Max(maxX, x);
+        maxY = Max(maxY, y);
+        maxZ = Max(maxZ, z);
+    }
+
+    // Bounds in each lane start from `bounds` and see a quarter of the vertices, so folding the
+    // lanes back into `bounds` gives the same extremes as visiting every vertex in turn.
+    struct LaneBounds
+    {
+        explicit LaneBounds(const Bounds& bounds)
+            : MinX{Splat(bounds.Min[0])}
+            , MinY{Splat(bounds.Min[1])}
+            , MinZ{Splat(bounds.Min[2])}
+            , MaxX{Splat(bounds.Max[0])}
+            , MaxY{Splat(bounds.Max[1])}
+            , MaxZ{Splat(bounds.Max[2])}
+        {
+        }
+
+        void Extend(Vector x, Vector y, Vector z)
+        {
+            ExtendLanes(MinX, MinY, MinZ, MaxX, MaxY, MaxZ, x, y, z);
+        }
+
+        void Fold(Bounds& bounds) const
+        {
+            float lanes[6][4];
+            Store(lanes[0], MinX);
+            Store(lanes[1], MinY);
+            Store(lanes[2], MinZ);
+            Store(lanes[3], MaxX);
+            Store(lanes[4], MaxY);
+            Store(lanes[5], MaxZ);
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                bounds.Min[0] = std::min(bounds.Min[0], lanes[0][lane]);
+                bounds.Min[1] = std::min(bounds.Min[1], lanes[1][lane]);
+                bounds.Min[2] = std::min(bounds.Min[2], lanes[2][lane]);
+                bounds.Max[0] = std::max(bounds.Max[0], lanes[3][lane]);
+                bounds.Max[1] = std::max(bounds.Max[1], lanes[4][lane]);
+                bounds.Max[2] = std::max(bounds.Max[2], lanes[5][lane]);
+            }
+        }
+
+        Vector MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
+    };
+
+    template<typename IndexT>
+    void ExtractMinAndMaxIndexedSimd(const float* positions, const IndexT* indices, size_t indexStart, size_t count, Bounds& bounds)
+    {
+        LaneBounds laneBounds{bounds};
+
+        const size_t blockEnd{indexStart + count - count % 4};
+        size_t index{indexStart};
+        for (; index < blockEnd; index += 4)
+        {
+            const float* p0{positions + static_cast<size_t>(indices[index] * 3)};
+            const float* p1{positions + static_cast<size_t>(indices[index + 1] * 3)};
+            const float* p2{positions + static_cast<size_t>(indices[index + 2] * 3)};
+            const float* p3{positions + static_cast<size_t>(indices[index + 3] * 3)};
+            laneBounds.Extend(Set(p0[0], p1[0], p2[0], p3[0]), Set(p0[1], p1[1], p2[1], p3[1]), Set(p0[2], p1[2], p2[2], p3[2]));
+        }
+
+        laneBounds.Fold(bounds);
+        ExtractMinAndMaxIndexedScalar(positions, indices, index, indexStart + count - index, bounds);
+    }
+
+    // BlendMatrix on the rows of the matrix, each the sum of the bone rows scaled by their weight.
+    void BlendRows(const float* skeletonMatrices, const float* matricesIndices, const float* matricesWeights,
+        const float* matricesIndicesExtra, const float* matricesWeightsExtra, size_t matWeightIdx, Vector rows[4])
+    {
+        rows[0] = rows[1] = rows[2] = rows[3] = Splat(0.0f);
+
+        const auto accumulate = [&](const float* boneIndices, const float* weights) {
+            for (size_t inf = 0; inf < 4; ++inf)
+            {
+                const float weight{weights[matWeightIdx + inf]};
+                if (weight > 0.0f)
+                {
+                    const float* bone{&skeletonMatrices[static_cast<size_t>(boneIndices[matWeightIdx + inf] * 16.0f)]};
+                    const Vector scale{Splat(weight)};
+                    for (size_t row = 0; row < 4; ++row)
+                    {
+                        rows[row] = Add(rows[row], Mul(Load(bone + row * 4), scale));
+                    }
+                }
+            }
+        };
+
+        accumulate(matricesIndices, matricesWeights);
+        if (matricesIndicesExtra != nullptr && matricesWeightsExtra != nullptr)
+        {
+            accumulate(matricesIndicesExtra, matricesWeightsExtra);
+        }
+    }
+
+    // Transforms the 3 floats at `v` by the matrix of `rows`: x * row0 + y * row1 + z * row2
+    // (+ row3) computes every component at once, in the order of the scalar expressions.
+    void TransformByRows(const Vector rows[4], bool normal, float* v)
+    {
+        const Vector xm{Mul(Splat(v[0]), rows[0])};
+        const Vector ym{Mul(Splat(v[1]), rows[1])};
+        const Vector zm{Mul(Splat(v[2]), rows[2])};
+        Vector result{Add(Add(xm, ym), zm)};
+        if (!normal)
+        {
+            result = Add(result, rows[3]);
+            result = Mul(result, Div(Splat(1.0f), SplatW(result)));
+        }
+
+        float lanes[4];
+        Store(lanes, result);
+        std::memcpy(v, lanes, 3 * sizeof(float));
+    }
+
+    void MorphSimd(float* block, const float* base, const float* target, float influence, size_t length)
+    {
+        const Vector scale{Splat(influence)};
+        const size_t blockEnd{length - length % 4};
+        size_t i{};
+        for (; i < blockEnd; i += 4)
+        {
+            Store(block + i, Add(Load(block + i), Mul(Sub(Load(target + i), Load(base + i)), scale)));
+        }
+
+        MorphScalar(block + i, base + i, target + i, influence, length - i);
+    }
+
+    void SkinVertexSimd(const SkinMorphVertices& vertices, size_t vertex, float* position, float* normal)
+    {
+        Vector rows[4];
+        BlendRows(vertices.SkeletonMatrices, vertices.MatricesIndices, vertices.MatricesWeights,
+            vertices.MatricesIndicesExtra, vertices.MatricesWeightsExtra, vertex * 4, rows);
+
+        TransformByRows(rows, false, position);
+        if (normal != nullptr)
+        {
+            TransformByRows(rows, true, normal);
+        }
+    }
+
+    // CullBoundingBox for the 4 objects from `box` and `matrix`, returning the visible ones as lane
+    // bits. The operations are the scalar ones, lane by lane.
+    unsigned int CullBoundingBoxes4(const float* box, const float* matrix, const Vector planes[6][4], float* worldBox, float* worldSphere)
+    {
+        // Loads of the 4 boxes, 6 floats each, transposed to a vector per component.
+        Vector minX{Load(box)}, minY{Load(box + 6)}, minZ{Load(box + 12)}, maxX{Load(box + 18)};
+        Transpose4(minX, minY, minZ, maxX);
+        Vector minZAgain{Load(box + 2)}, maxXAgain{Load(box + 8)}, maxY{Load(box + 14)}, maxZ{Load(box + 20)};
+        Transpose4(minZAgain, maxXAgain, maxY, maxZ);
+
+        // m[i] holds element i of the 4 matrices.
+        Vector m[16];
+        for (size_t row = 0; row < 4; ++row)
+        {
+            m[row * 4] = Load(matrix + row * 4);
+            m[row * 4 + 1] = Load(matrix + 16 + row * 4);
+            m[row * 4 + 2] = Load(matrix + 32 + row * 4);
+            m[row * 4 + 3] = Load(matrix + 48 + row * 4);
+            Transpose4(m[row * 4], m[row * 4 + 1], m[row * 4 + 2], m[row * 4 + 3]);
+        }
+
+        const Vector half{Splat(0.5f)};
+        const Vector cx{Mul(Add(minX, maxX), half)}, cy{Mul(Add(minY, maxY), half)}, cz{Mul(Add(minZ, maxZ), half)};
+        const Vector ex{Mul(Sub(maxX, minX), half)}, ey{Mul(Sub(maxY, minY), half)}, ez{Mul(Sub(maxZ, minZ), half)};
+
+        const Vector wx{Add(Add(Add(Mul(cx, m[0]), Mul(cy, m[4])), Mul(cz, m[8])), m[12])};
+        const Vector wy{Add(Add(Add(Mul(cx, m[1]), Mul(cy, m[5])), Mul(cz, m[9])), m[13])};
+        const Vector wz{Add(Add(Add(Mul(cx, m[2]), Mul(cy, m[6])), Mul(cz, m[10])), m[14])};
+
+        const Vector a0x{Mul(m[0], ex)}, a0y{Mul(m[1], ex)}, a0z{Mul(m[2], ex)};
+        const Vector a1x{Mul(m[4], ey)}, a1y{Mul(m[5], ey)}, a1z{Mul(m[6], ey)};
+        const Vector a2x{Mul(m[8], ez)}, a2y{Mul(m[9], ez)}, a2z{Mul(m[10], ez)};
+
+        const Vector dx{Sub(maxX, minX)}, dy{Sub(maxY, minY)}, dz{Sub(maxZ, minZ)};
+        const Vector radius{Mul(Sqrt(Add(Add(Mul(dx, dx), Mul(dy, dy)), Mul(dz, dz))), half)};
+        const Vector scale{Max(Max(Abs(Add(Add(m[0], m[4]), m[8])), Abs(Add(Add(m[1], m[5]), m[9]))), Abs(Add(Add(m[2], m[6]), m[10])))};
+        const Vector worldRadius{Mul(scale, radius)};
+
+        if (worldBox != nullptr)
+        {
+            const Vector hx{Add(Add(Abs(a0x), Abs(a1x)), Abs(a2x))};
+            const Vector hy{Add(Add(Abs(a0y), Abs(a1y)), Abs(a2y))};
+            const Vector hz{Add(Add(Abs(a0z), Abs(a1z)), Abs(a2z))};
+
+            Vector lowX{Sub(wx, hx)}, lowY{Sub(wy, hy)}, lowZ{Sub(wz, hz)}, highX{Add(wx, hx)};
+            Vector highY{Add(wy, hy)}, highZ{Add(wz, hz)};
+            float lanes[6][4];
+            Store(lanes[0], lowX);
+            Store(lanes[1], lowY);
+            Store(lanes[2], lowZ);
+            Store(lanes[3], highX);
+            Store(lanes[4], highY);
+            Store(lanes[5], highZ);
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                for (size_t component = 0; component < 6; ++component)
+                {
+                    worldBox[lane * 6 + component] = lanes[component][lane];
+                }
+            }
+        }
+        if (worldSphere != nullptr)
+        {
+            Store4(worldSphere, wx, wy, wz, worldRadius);
+        }
+
+        const Vector negativeRadius{Sub(Splat(0.0f), worldRadius)};
+        const Vector zero{Splat(0.0f)};
+        Mask culled{NoLanes()};
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            const Vector* p{planes[plane]};
+            const Vector distance{Add(Add(Add(Mul(wx, p[0]), Mul(wy, p[1])), Mul(wz, p[2])), p[3])};
+            const Vector reach0{Abs(Add(Add(Mul(a0x, p[0]), Mul(a0y, p[1])), Mul(a0z, p[2])))};
+            const Vector reach1{Abs(Add(Add(Mul(a1x, p[0]), Mul(a1y, p[1])), Mul(a1z, p[2])))};
+            const Vector reach2{Abs(Add(Add(Mul(a2x, p[0]), Mul(a2y, p[1])), Mul(a2z, p[2])))};
+            culled = Or(culled, LessEqual(distance, negativeRadius));
+            culled = Or(culled, Less(Add(distance, Add(Add(reach0, reach1), reach2)), zero));
+        }
+        return ~LaneBits(culled) & 0xF;
+    }
+#endif
+}
+
+namespace Babylon::Plugins::NativeOptimizations::Kernels
+{
+    namespace Scalar
+    {
+        void TransformVector3Coordinates(float* coordinates, size_t offset, size_t length, const float matrix[16])
+        {
+            TransformScalar<3>(coordinates, offset, length, matrix, TransformCoordinates);
+        }
+
+        void TransformVector3Normals(float* normals, size_t offset, size_t length, const float matrix[16])
+        {
+            TransformScalar<3>(normals, offset, length, matrix, TransformNormal);
+        }
+
+        void TransformVector4Normals(float* normals, size_t offset, size_t length, const float matrix[16])
+        {
+            TransformScalar<4>(normals, offset, length, matrix, TransformNormal);
+        }
+
+        void ExtractMinAndMax(const float* positions, size_t start, size_t count, size_t stride, Bounds& bounds)
+        {
+            for (size_t index = start, offset = start * stride; index < start + count; ++index, offset += stride)
+            {
+                Extend(bounds, positions[offset], positions[offset + 1], positions[offset + 2]);
+            }
+        }
+
+        void ExtractMinAndMaxIndexed(const float* positions, const int32_t* indices, size_t indexStart, size_t count, Bounds& bounds)
+        {
+            ExtractMinAndMaxIndexedScalar(positions, indices, indexStart, count, bounds);
+        }
+
+        void ExtractMinAndMaxIndexed(const float* positions, const uint32_t* indices, size_t indexStart, size_t count, Bounds& bounds)
+        {
+            ExtractMinAndMaxIndexedScalar(positions, indices, indexStart, count, bounds);
+        }
+
+        void ExtractMinAndMaxIndexed(const float* positions, const uint16_t* indices, size_t indexStart, size_t count, Bounds& bounds)
+        {
+            ExtractMinAndMaxIndexedScalar(positions, indices, indexStart, count, bounds);
+        }
+
+        void ApplySkeleton(float* data, size_t length, bool normals, const float* skeletonMatrices,
+            const float* matricesIndices, const float* matricesWeights,
+            const float* matricesIndicesExtra, const float* matricesWeightsExtra)
+        {
+            ApplySkeletonScalar(data, length, normals, skeletonMatrices, matricesIndices, matricesWeights, matricesIndicesExtra, matricesWeightsExtra);
+        }
+
+        void SkinAndMorph(const SkinMorphVertices& vertices, size_t start, size_t count)
+        {
+            SkinAndMorphBlocks(vertices, start, count, MorphScalar, SkinVertexScalar);
+        }
+
+        void CullBoundingBoxes(const float* localBoxes, const float* worldMatrices, const float planes[24], size_t start, size_t count,
+            uint32_t* visibility, float* worldBoxes, float* worldSpheres)
+        {
+            for (size_t object = start; object < start + count; ++object)
+            {
+                SetVisibility(visibility, object, CullBoundingBox(localBoxes + object * 6, worldMatrices + object * 16, planes,
+                    worldBoxes != nullptr ? worldBoxes + object * 6 : nullptr, worldSpheres != nullptr ? worldSpheres + object * 4 : nullptr));
+            }
+        }
+    }
+
+#if defined(NATIVE_OPTIMIZATIONS_SSE2) || defined(NATIVE_OPTIMIZATIONS_NEON)
+    const char* SimdName()
+    {
+#if defined(NATIVE_OPTIMIZATIONS_SSE2)
+        return "SSE2";
+#else
+        return "NEON";
+#endif
+    }
+
+    void TransformVector3Coordinates(float* coordinates, size_t offset, size_t length, const float matrix[16])
+    {
+        TransformVector3(coordinates, offset, length, matrix, TransformCoordinates4, TransformCoordinates);
+    }
+
+    void TransformVector3Normals(float* normals, size_t offset, size_t length, const float matrix[16])
+    {
+        TransformVector3(normals, offset, length, matrix, TransformNormal4, TransformNormal);
+    }
+
+    void TransformVector4Normals(float* normals, size_t offset, size_t length, const float matrix[16])
+    {
+        const size_t vertexCount{VertexCount(length, 4)};
+        const size_t blockEnd{offset + (vertexCount / 4) * 16};
+
+        size_t index{offset};
+        for (; index < blockEnd; index += 16)
+        {
+            // w is stored back untouched.
+            Vector x, y, z, w;
+            Load4(normals + index, x, y, z, w);
+            TransformNormal4(matrix, x, y, z);
+            Store4(normals + index, x, y, z, w);
+        }
+
+        TransformScalar<4>(normals, index, offset + length - index, matrix, TransformNormal);
+    }
+
+    void ExtractMinAndMax(const float* positions, size_t start, size_t count, size_t stride, Bounds& bounds)
+    {
+        LaneBounds laneBounds{bounds};
+
+        const size_t blockEnd{start + count - count % 4};
+        size_t index{start};
+        for (; index < blockEnd; index += 4)
+        {
+            const float* p{positions + index * stride};
+            Vector x, y, z;
+            if (stride == 3)
+            {
+                Load3(p, x, y, z);
+            }
+            else
+            {
+                x = Set(p[0], p[stride], p[2 * stride], p[3 * stride]);
+                y = Set(p[1], p[stride + 1], p[2 * stride + 1], p[3 * stride + 1]);
+                z = Set(p[2], p[stride + 2], p[2 * stride + 2], p[3 * stride + 2]);
+            }
+            laneBounds.Extend(x, y, z);
+        }
+
+        laneBounds.Fold(bounds);
+        Scalar::ExtractMinAndMax(positions, index, start + count - index, stride, bounds);
+    }
+
+    void ExtractMinAndMaxIndexed(const float* positions, const int32_t* indices, size_t indexStart, size_t count, Bounds& bounds)
+    {
+        ExtractMinAndMaxIndexedSimd(positions, indices, indexStart, count, bounds);
+    }
+
+    void ExtractMinAndMaxIndexed(const float* positions, const uint32_t* indices, size_t indexStart, size_t count, Bounds& bounds)
+    {
+        ExtractMinAndMaxIndexedSimd(positions, indices, indexStart, count, bounds);
+    }
+
+    void ExtractMinAndMaxIndexed(const float* positions, const uint16_t* indices, size_t indexStart, size_t count, Bounds& bounds)
+    {
+        ExtractMinAndMaxIndexedSimd(positions, indices, indexStart, count, bounds);
+    }
+
+    void ApplySkeleton(float* data, size_t length, bool normals, const float* skeletonMatrices,
+        const float* matricesIndices, const float* matricesWeights,
+        const float* matricesIndicesExtra, const float* matricesWeightsExtra)
+    {
+        for (size_t index = 0, matWeightIdx = 0; index < length; index += 3, matWeightIdx += 4)
+        {
+            Vector rows[4];
+            BlendRows(skeletonMatrices, matricesIndices, matricesWeights, matricesIndicesExtra, matricesWeightsExtra, matWeightIdx, rows);
+            TransformByRows(rows, normals, data + index);
+        }
+    }
+
+    void SkinAndMorph(const SkinMorphVertices& vertices, size_t start, size_t count)
+    {
+        SkinAndMorphBlocks(vertices, start, count, MorphSimd, SkinVertexSimd);
+    }
+
+    void CullBoundingBoxes(const float* localBoxes, const float* worldMatrices, const float planes[24], size_t start, size_t count,
+        uint32_t* visibility, float* worldBoxes, float* worldSpheres)
+    {
+        Vector planeVectors[6][4];
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            for (size_t component = 0; component < 4; ++component)
+            {
+                planeVectors[plane][component] = Splat(planes[plane * 4 + component]);
+            }
+        }
+
+        const size_t blockEnd{start + count - count % 4};
+        size_t object{start};
+        for (; object < blockEnd; object += 4)
+        {
+            const unsigned int visible{CullBoundingBoxes4(localBoxes + object * 6, worldMatrices + object * 16, planeVectors,
+                worldBoxes != nullptr ? worldBoxes + object * 6 : nullptr, worldSpheres != nullptr ? worldSpheres + object * 4 : nullptr)};
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                SetVisibility(visibility, object + lane, (visible >> lane) & 1);
+            }
+        }
+
+        Scalar::CullBoundingBoxes(localBoxes, worldMatrices, planes, object, start + count - object, visibility, worldBoxes, worldSpheres);
+    }
+#else
+    const char* SimdName()
+    {
+        return "Scalar";
+    }
+
+    void TransformVector3Coordinates(float* coordinates, size_t offset, size_t length, const float matrix[16])
+    {
+        Scalar::TransformVector3Coordinates(coordinates, offset, length, matrix);
+    }
+
+    void TransformVector3Normals(float* normals, size_t offset, size_t length, const float matrix[16])
+    {
+        Scalar::TransformVector3Normals(normals, offset, length, matrix);
+    }
+
+    void TransformVector4Normals(float* normals, size_t offset, size_t length, const float matrix[16])
+    {
+        Scalar::TransformVector4Normals(normals, offset, length, matrix);
+    }
+
+    void ExtractMinAndMax(const float* positions, size_t start, size_t count, size_t stride, Bounds& bounds)
+    {
+        Scalar::ExtractMinAndMax(positions, start, count, stride, bounds);
+    }
+
+    void ExtractMinAndMaxIndexed(const float* positions, const int32_t* indices, size_t indexStart, size_t count, Bounds& bounds)
+    {
+        Scalar::ExtractMinAndMaxIndexed(positions, indices, indexStart, count, bounds);
+    }
+
+    void ExtractMinAndMaxIndexed(const float* positions, const uint32_t* indices, size_t indexStart, size_t count, Bounds& bounds)
+    {
+        Scalar::ExtractMinAndMaxIndexed(positions, indices, indexStart, count, bounds);
+    }
+
+    void ExtractMinAndMaxIndexed(const float* positions, const uint16_t* indices, size_t indexStart, size_t count, Bounds& bounds)
+    {
+        Scalar::ExtractMinAndMaxIndexed(positions, indices, indexStart, count, bounds);
+    }
+
+    void ApplySkeleton(float* data, size_t length, bool normals, const float* skeletonMatrices,
+        const float* matricesIndices, const float* matricesWeights,
+        const float* matricesIndicesExtra, const float* matricesWeightsExtra)
+    {
+        Scalar::ApplySkeleton(data, length, normals, skeletonMatrices, matricesIndices, matricesWeights, matricesIndicesExtra, matricesWeightsExtra);
+    }
+
+    void SkinAndMorph(const SkinMorphVertices& vertices, size_t start, size_t count)
+    {
+        Scalar::SkinAndMorph(vertices, start, count);
+    }
+
+    void CullBoundingBoxes(const float* localBoxes, const float* worldMatrices, const float planes[24], size_t start, size_t count,
+        uint32_t* visibility, float* worldBoxes, float* worldSpheres)
+    {
+        Scalar::CullBoundingBoxes(localBoxes, worldMatrices, planes, start, count, visibility, worldBoxes, worldSpheres);
+    }
+#endif
+}
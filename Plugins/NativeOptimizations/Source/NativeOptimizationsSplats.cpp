@@ -0,0 +1,161 @@
+#include <Babylon/Plugins/NativeOptimizationsInternal.h>
+
+#include <array>
+#include <cstring>
+
+namespace
+{
+    // The keys are sorted 11 bits at a time, least significant digit first.
+    constexpr uint32_t DIGIT_BITS{11};
+    constexpr uint32_t DIGIT_COUNT{3};
+    constexpr uint32_t BUCKET_COUNT{1u << DIGIT_BITS};
+
+    using Histogram = std::array<uint32_t, BUCKET_COUNT>;
+
+    uint32_t Digit(uint32_t key, uint32_t digit)
+    {
+        return (key >> (digit * DIGIT_BITS)) & (BUCKET_COUNT - 1);
+    }
+
+    // Maps the bits of a float to an unsigned integer with the same order: negative floats have
+    // all their bits flipped, so larger magnitudes come first, and positive ones their sign bit set.
+    uint32_t DepthKey(float depth)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    // Scatters the splats to the buckets of one digit. The first pass reads the splats in index
+    // order instead of an order array, and the last one writes the sorted indices.
+    template<bool First, bool Last>
+    void Scatter(const uint32_t* keys, const uint32_t* order, uint32_t* sortedKeys, uint32_t* sortedOrder, float* indices,
+        size_t count, uint32_t digit, Histogram& offsets)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint32_t key{keys[i]};
+            const uint32_t splat{First ? static_cast<uint32_t>(i) : order[i]};
+            const uint32_t position{offsets[Digit(key, digit)]++};
+            if constexpr (Last)
+            {
+                indices[position] = static_cast<float>(splat);
+            }
+            else
+            {
+                sortedKeys[position] = key;
+                sortedOrder[position] = splat;
+            }
+        }
+    }
+}
+
+namespace Babylon::Plugins::NativeOptimizations::Kernels
+{
+    void ComputeSplatDepthKeys(const float* positions, size_t start, size_t count, const float direction[3], float depthFactor, uint32_t* keys)
+    {
+        // Same expression, in the same order, as the qsort based sort this replaced.
+        for (size_t i = start; i < start + count; ++i)
+        {
+            const float* position{positions + 4 * i};
+            keys[i] = DepthKey(10000.f + (direction[0] * position[0] + direction[1] * position[1] + direction[2] * position[2]) * depthFactor);
+        }
+    }
+
+    void SortSplatKeys(SplatSortBuffers& buffers, size_t count, float* indices)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        // One read of the keys counts every digit.
+        std::array<Histogram, DIGIT_COUNT> histograms{};
+        const uint32_t* keys{buffers.Keys.data()};
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint32_t key{keys[i]};
+            for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit)
+            {
+                ++histograms[digit][Digit(key, digit)];
+            }
+        }
+
+        // A digit all keys share leaves the order as it is, which is common for the high bits
+        // since the depths of a scene fall in a narrow range.
+        std::array<uint32_t, DIGIT_COUNT> passes{};
+        uint32_t passCount{};
+        for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit)
+        {
+            if (histograms[digit][Digit(keys[0], digit)] != count)
+            {
+                passes[passCount++] = digit;
+            }
+        }
+
+        if (passCount == 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                indices[i] = static_cast<float>(i);
+            }
+            return;
+        }
+
+        if (passCount > 1)
+        {
+            buffers.SortedKeys.resize(count);
+            buffers.Order.resize(count);
+            buffers.SortedOrder.resize(count);
+        }
+
+        for (uint32_t pass = 0; pass < passCount; ++pass)
+        {
+            const uint32_t digit{passes[pass]};
+
+            Histogram offsets;
+            uint32_t offset{};
+            for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+            {
+                offsets[bucket] = offset;
+                offset += histograms[digit][bucket];
+            }
+
+            const bool first{pass == 0};
+            const bool last{pass == passCount - 1};
+            uint32_t* sortedKeys{buffers.SortedKeys.data()};
+            uint32_t* sortedOrder{buffers.SortedOrder.data()};
+            const uint32_t* order{buffers.Order.data()};
+            if (first && last)
+            {
+                Scatter<true, true>(keys, order, sortedKeys, sortedOrder, indices, count, digit, offsets);
+            }
+            else if (first)
+            {
+                Scatter<true, false>(keys, order, sortedKeys, sortedOrder, indices, count, digit, offsets);
+            }
+            else if (last)
+            {
+                Scatter<false, true>(keys, order, sortedKeys, sortedOrder, indices, count, digit, offsets);
+            }
+            else
+            {
+                Scatter<false, false>(keys, order, sortedKeys, sortedOrder, indices, count, digit, offsets);
+            }
+
+            if (!last)
+            {
+                buffers.Keys.swap(buffers.SortedKeys);
+                buffers.Order.swap(buffers.SortedOrder);
+                keys = buffers.Keys.data();
+            }
+        }
+    }
+
+    void SortSplats(const float* positions, size_t count, const float direction[3], float depthFactor, SplatSortBuffers& buffers, float* indices)
+    {
+        buffers.Keys.resize(count);
+        ComputeSplatDepthKeys(positions, 0, count, direction, depthFactor, buffers.Keys.data());
+        SortSplatKeys(buffers, count, indices);
+    }
+}
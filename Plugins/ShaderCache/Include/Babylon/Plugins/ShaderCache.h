@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <fstream>
+#include <string>
 
 namespace Babylon::Plugins::ShaderCache
 {
@@ -24,4 +25,25 @@ namespace Babylon::Plugins::ShaderCache
     // Loads the shader cache from an input file stream.
     // Returns the number of entries in the shader cache.
     uint32_t Load(std::istream& stream);
+
+    // Opens an append-only journal at `path` (creating it if needed) and loads its entries
+    // into the cache. From then on every shader added to the cache is appended to the
+    // journal on a background thread, so nothing needs to be saved in one go. A record left
+    // incomplete by a crash is discarded. A file written by Save() is migrated to the journal
+    // format. Does nothing if this journal is already open, and throws std::runtime_error if a
+    // journal at a different path is: the cache is process-wide, so CloseJournal() the old one
+    // first to switch files.
+    // Returns the number of entries loaded.
+    uint32_t OpenJournal(const std::string& path);
+
+    // Blocks until every shader added so far has been written to the journal and synced to
+    // disk. Cheap when the background writer has kept up. No-op without a journal.
+    void FlushJournal();
+
+    // Rewrites the journal on a background thread to hold one record per cached shader.
+    // No-op without a journal.
+    void CompactJournal();
+
+    // Flushes and closes the journal. Disable() also closes it.
+    void CloseJournal();
 }
@@ -1,73 +1,98 @@
 #include <Babylon/Plugins/ShaderCache.h>
 #include "ShaderCacheImpl.h"
 
+namespace
+{
+    using Babylon::Plugins::ShaderCache::ShaderCacheImpl;
+
+    // Returns a strong reference so the cache outlives the call even if another thread
+    // disables it concurrently.
+    std::shared_ptr<ShaderCacheImpl> GetInstance()
+    {
+        std::scoped_lock lock{ShaderCacheImpl::InstanceMutex};
+        if (!ShaderCacheImpl::Instance)
+        {
+            throw std::runtime_error("ShaderCache is not enabled.");
+        }
+
+        return ShaderCacheImpl::Instance;
+    }
+}
+
 namespace Babylon::Plugins::ShaderCache
 {
     void Enable()
     {
-        if (!IsEnabled())
+        std::scoped_lock lock{ShaderCacheImpl::InstanceMutex};
+        if (!ShaderCacheImpl::Instance)
         {
-            ShaderCacheImpl::Instance = std::make_unique<ShaderCacheImpl>();
+            ShaderCacheImpl::Instance = std::make_shared<ShaderCacheImpl>();
         }
     }
 
     void Disable()
     {
-        ShaderCacheImpl::Instance.reset();
+        std::shared_ptr<ShaderCacheImpl> instance;
+        {
+            std::scoped_lock lock{ShaderCacheImpl::InstanceMutex};
+            instance = std::move(ShaderCacheImpl::Instance);
+        }
+
+        // Close the journal now rather than when the last in-flight lookup lets go of the cache.
+        if (instance)
+        {
+            instance->CloseJournal();
+        }
     }
 
     bool IsEnabled()
     {
+        std::scoped_lock lock{ShaderCacheImpl::InstanceMutex};
         return !!ShaderCacheImpl::Instance;
     }
 
     void Clear()
     {
-        if (!ShaderCacheImpl::Instance)
-        {
-            throw std::runtime_error("ShaderCache is not enabled.");
-        }
-
-        ShaderCacheImpl::Instance->Clear();
+        GetInstance()->Clear();
     }
 
     uint32_t Save(std::ostream& stream)
     {
-        if (!ShaderCacheImpl::Instance)
-        {
-            throw std::runtime_error("ShaderCache is not enabled.");
-        }
-
-        return ShaderCacheImpl::Instance->Save(stream);
+        return GetInstance()->Save(stream);
     }
 
     uint32_t Load(std::istream& stream)
     {
-        if (!ShaderCacheImpl::Instance)
-        {
-            throw std::runtime_error("ShaderCache is not enabled.");
-        }
+        return GetInstance()->Load(stream);
+    }
 
-        return ShaderCacheImpl::Instance->Load(stream);
+    uint32_t OpenJournal(const std::string& path)
+    {
+        return GetInstance()->OpenJournal(path);
     }
 
-    std::shared_ptr<Graphics::BgfxShaderInfo> AddShader(std::string_view vertexSource, std::string_view fragmentSource, Graphics::BgfxShaderInfo shaderInfo)
+    void FlushJournal()
     {
-        if (!ShaderCacheImpl::Instance)
-        {
-            throw std::runtime_error("ShaderCache is not enabled.");
-        }
+        GetInstance()->FlushJournal();
+    }
 
-        return ShaderCacheImpl::Instance->AddShader(vertexSource, fragmentSource, std::move(shaderInfo));
+    void CompactJournal()
+    {
+        GetInstance()->CompactJournal();
     }
 
-    std::shared_ptr<Graphics::BgfxShaderInfo> GetShader(std::string_view vertexSource, std::string_view fragmentSource)
+    void CloseJournal()
     {
-        if (!ShaderCacheImpl::Instance)
-        {
-            throw std::runtime_error("ShaderCache is not enabled.");
-        }
+        GetInstance()->CloseJournal();
+    }
 
-        return ShaderCacheImpl::Instance->GetShader(vertexSource, fragmentSource);
+    std::shared_ptr<Graphics::BgfxShaderInfo> AddShader(std::string_view vertexSource, std::string_view fragmentSource, Graphics::BgfxShaderInfo shaderInfo)
+    {
+        return GetInstance()->AddShader(vertexSource, fragmentSource, std::move(shaderInfo));
+    }
+
+    std::shared_ptr<Graphics::BgfxShaderInfo> GetShader(std::string_view vertexSource, std::string_view fragmentSource)
+    {
+        return GetInstance()->GetShader(vertexSource, fragmentSource);
     }
 }
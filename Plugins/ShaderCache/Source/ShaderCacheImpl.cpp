@@ -1,4 +1,8 @@
 #include "ShaderCacheImpl.h"
+#include "ShaderCacheJournal.h"
+
+#include <set>
+#include <stdexcept>
 
 namespace
 {
@@ -35,49 +39,102 @@ namespace
 
 namespace Babylon::Plugins::ShaderCache
 {
-    // 3: sampler uniforms are stored under their original GLSL name rather than the
-    //    SPIRV-Cross-renamed identifier, which changes both the bgfx uniform table in
-    //    Vertex/FragmentBytes and the keys of UniformStages.
-    static const uint32_t CACHE_VERSION = 3;
-
     void ShaderCacheImpl::Clear()
     {
+        std::unique_lock lock{m_mutex};
         m_cache.clear();
+
+        // Compacting to an empty snapshot empties the journal too.
+        if (m_journal)
+        {
+            m_journal->Compact({});
+        }
+    }
+
+    ShaderCacheImpl::~ShaderCacheImpl()
+    {
+        // Flush and close before the cache goes away; the journal's writer holds shared
+        // references to the entries it has yet to write, not to the cache itself.
+        CloseJournal();
+    }
+
+    void ShaderCacheImpl::SaveEntry(std::ostream& stream, const ShaderHash& hash, const Graphics::BgfxShaderInfo& info)
+    {
+        stream.write(reinterpret_cast<const char*>(&hash), sizeof(ShaderHash));
+
+        uint32_t vertexBytes{static_cast<uint32_t>(info.VertexBytes.size())};
+        stream.write(reinterpret_cast<const char*>(&vertexBytes), sizeof(uint32_t));
+        stream.write((const char*)info.VertexBytes.data(), info.VertexBytes.size());
+
+        uint32_t fragmentBytes{static_cast<uint32_t>(info.FragmentBytes.size())};
+        stream.write(reinterpret_cast<const char*>(&fragmentBytes), sizeof(uint32_t));
+        stream.write((const char*)info.FragmentBytes.data(), info.FragmentBytes.size());
+
+        uint32_t vertexAttributeLocationCount{static_cast<uint32_t>(info.VertexAttributeLocations.size())};
+        stream.write(reinterpret_cast<const char*>(&vertexAttributeLocationCount), sizeof(uint32_t));
+        for (auto& attributeLocation : info.VertexAttributeLocations)
+        {
+            SaveString(stream, attributeLocation.first);
+            stream.write(reinterpret_cast<const char*>(&attributeLocation.second), sizeof(uint32_t));
+        }
+
+        uint32_t stageCount{static_cast<uint32_t>(info.UniformStages.size())};
+        stream.write(reinterpret_cast<const char*>(&stageCount), sizeof(uint32_t));
+        for (auto& uniformStages : info.UniformStages)
+        {
+            SaveString(stream, uniformStages.first);
+            stream.write(reinterpret_cast<const char*>(&uniformStages.second), sizeof(uint8_t));
+        }
+    }
+
+    void ShaderCacheImpl::LoadEntry(std::istream& stream, ShaderHash& hash, Graphics::BgfxShaderInfo& info)
+    {
+        stream.read(reinterpret_cast<char*>(&hash), sizeof(ShaderHash));
+
+        uint32_t vertexBytes;
+        stream.read(reinterpret_cast<char*>(&vertexBytes), sizeof(uint32_t));
+        info.VertexBytes.resize(vertexBytes);
+        stream.read(reinterpret_cast<char*>(info.VertexBytes.data()), info.VertexBytes.size());
+
+        uint32_t fragmentBytes;
+        stream.read(reinterpret_cast<char*>(&fragmentBytes), sizeof(uint32_t));
+        info.FragmentBytes.resize(fragmentBytes);
+        stream.read(reinterpret_cast<char*>(info.FragmentBytes.data()), info.FragmentBytes.size());
+
+        uint32_t vertexAttributeLocationCount;
+        stream.read(reinterpret_cast<char*>(&vertexAttributeLocationCount), sizeof(uint32_t));
+        for (unsigned int vertexAttributeLocation = 0; vertexAttributeLocation < vertexAttributeLocationCount; vertexAttributeLocation++)
+        {
+            std::string locationName;
+            LoadString(stream, locationName);
+            uint32_t locationIndex;
+            stream.read(reinterpret_cast<char*>(&locationIndex), sizeof(uint32_t));
+            info.VertexAttributeLocations[locationName] = locationIndex;
+        }
+
+        uint32_t stageCount;
+        stream.read(reinterpret_cast<char*>(&stageCount), sizeof(uint32_t));
+        for (unsigned int stage = 0; stage < stageCount; stage++)
+        {
+            std::string stageName;
+            LoadString(stream, stageName);
+            uint8_t stageIndex;
+            stream.read(reinterpret_cast<char*>(&stageIndex), sizeof(uint8_t));
+            info.UniformStages[stageName] = stageIndex;
+        }
     }
 
     uint32_t ShaderCacheImpl::Save(std::ostream& stream)
     {
+        std::shared_lock lock{m_mutex};
+
         uint32_t cacheVersion{CACHE_VERSION};
         stream.write(reinterpret_cast<const char*>(&cacheVersion), sizeof(uint32_t));
         uint32_t cacheSize{static_cast<uint32_t>(m_cache.size())};
         stream.write(reinterpret_cast<const char*>(&cacheSize), sizeof(uint32_t));
         for (auto& entry : m_cache)
         {
-            stream.write(reinterpret_cast<const char*>(&entry.first), sizeof(ShaderHash));
-            const auto& info = entry.second;
-            uint32_t vertexBytes{static_cast<uint32_t>(info->VertexBytes.size())};
-            stream.write(reinterpret_cast<const char*>(&vertexBytes), sizeof(uint32_t));
-            stream.write((const char*)info->VertexBytes.data(), info->VertexBytes.size());
-
-            uint32_t fragmentBytes{static_cast<uint32_t>(info->FragmentBytes.size())};
-            stream.write(reinterpret_cast<const char*>(&fragmentBytes), sizeof(uint32_t));
-            stream.write((const char*)info->FragmentBytes.data(), info->FragmentBytes.size());
-
-            uint32_t vertexAttributeLocationCount{static_cast<uint32_t>(info->VertexAttributeLocations.size())};
-            stream.write(reinterpret_cast<const char*>(&vertexAttributeLocationCount), sizeof(uint32_t));
-            for (auto& attributeLocation : info->VertexAttributeLocations)
-            {
-                SaveString(stream, attributeLocation.first);
-                stream.write(reinterpret_cast<const char*>(&attributeLocation.second), sizeof(uint32_t));
-            }
-
-            uint32_t stageCount{static_cast<uint32_t>(info->UniformStages.size())};
-            stream.write(reinterpret_cast<const char*>(&stageCount), sizeof(uint32_t));
-            for (auto& uniformStages : info->UniformStages)
-            {
-                SaveString(stream, uniformStages.first);
-                stream.write(reinterpret_cast<const char*>(&uniformStages.second), sizeof(uint8_t));
-            }
+            SaveEntry(stream, entry.first, *entry.second);
         }
         return cacheSize;
     }
@@ -96,51 +153,145 @@ namespace Babylon::Plugins::ShaderCache
         for (unsigned int i = 0; i < cacheSize; i++)
         {
             ShaderHash hash;
-            stream.read(reinterpret_cast<char*>(&hash), sizeof(ShaderHash));
             std::shared_ptr<Graphics::BgfxShaderInfo> info = std::make_shared<Graphics::BgfxShaderInfo>();
-            uint32_t vertexBytes;
-            stream.read(reinterpret_cast<char*>(&vertexBytes), sizeof(uint32_t));
-            info->VertexBytes.resize(vertexBytes);
-            stream.read(reinterpret_cast<char*>(info->VertexBytes.data()), info->VertexBytes.size());
-            uint32_t fragmentBytes;
-            stream.read(reinterpret_cast<char*>(&fragmentBytes), sizeof(uint32_t));
-            info->FragmentBytes.resize(fragmentBytes);
-            stream.read(reinterpret_cast<char*>(info->FragmentBytes.data()), info->FragmentBytes.size());
-            uint32_t vertexAttributeLocationCount;
-            stream.read(reinterpret_cast<char*>(&vertexAttributeLocationCount), sizeof(uint32_t));
-            for (unsigned int vertexAttributeLocation = 0; vertexAttributeLocation < vertexAttributeLocationCount; vertexAttributeLocation++)
+            LoadEntry(stream, hash, *info);
+
+            std::unique_lock lock{m_mutex};
+            const auto [iter, inserted] = m_cache.emplace(hash, std::move(info));
+            if (inserted && m_journal)
             {
-                std::string locationName;
-                LoadString(stream, locationName);
-                uint32_t locationIndex;
-                stream.read(reinterpret_cast<char*>(&locationIndex), sizeof(uint32_t));
-                info->VertexAttributeLocations[locationName] = locationIndex;
+                m_journal->Append(iter->first, iter->second);
             }
+        }
+        return cacheSize;
+    }
 
-            uint32_t stageCount;
-            stream.read(reinterpret_cast<char*>(&stageCount), sizeof(uint32_t));
-            for (unsigned int stage = 0; stage < stageCount; stage++)
+    uint32_t ShaderCacheImpl::OpenJournal(const std::string& path)
+    {
+        const auto journalPath = std::filesystem::absolute(path).lexically_normal();
+
+        std::unique_lock lock{m_mutex};
+        if (m_journal)
+        {
+            // Every runtime in the process shares the one cache, so they all share its journal.
+            // Silently keeping the old file would leave the caller believing it persists to one
+            // it never touches.
+            if (journalPath != m_journalPath)
             {
-                std::string stageName;
-                LoadString(stream, stageName);
-                uint8_t stageIndex;
-                stream.read(reinterpret_cast<char*>(&stageIndex), sizeof(uint8_t));
-                info->UniformStages[stageName] = stageIndex;
+                throw std::runtime_error{"Shader cache journal " + m_journalPath.string() + " is already open; close it before opening " + journalPath.string()};
             }
+            return 0;
+        }
 
-            m_cache.emplace(hash, std::move(info));
+        // A file written by Save() (the whole-cache snapshot format) is migrated: its entries
+        // are loaded here and then written to the fresh journal that replaces it.
+        uint32_t loadedCount{0};
+        {
+            std::ifstream stream{path, std::ios::binary};
+            uint32_t cacheVersion{};
+            if (stream.read(reinterpret_cast<char*>(&cacheVersion), sizeof(uint32_t)) && cacheVersion == CACHE_VERSION)
+            {
+                uint32_t cacheSize{};
+                stream.read(reinterpret_cast<char*>(&cacheSize), sizeof(uint32_t));
+                for (uint32_t i = 0; i < cacheSize && stream.good(); ++i)
+                {
+                    ShaderHash hash;
+                    auto info = std::make_shared<Graphics::BgfxShaderInfo>();
+                    LoadEntry(stream, hash, *info);
+                    if (stream.good() && m_cache.emplace(hash, std::move(info)).second)
+                    {
+                        ++loadedCount;
+                    }
+                }
+            }
+        }
+
+        std::set<ShaderHash> journaled;
+        m_journalPath = journalPath;
+        m_journal = std::make_shared<ShaderCacheJournal>(path, CACHE_VERSION, [&](const ShaderHash& hash, std::shared_ptr<Graphics::BgfxShaderInfo> info) {
+            journaled.insert(hash);
+            if (m_cache.emplace(hash, std::move(info)).second)
+            {
+                ++loadedCount;
+            }
+        });
+
+        if (m_journal->GetRecordCount() > journaled.size())
+        {
+            // Duplicate records (e.g. two processes appending to the same file): rewrite it.
+            m_journal->Compact({m_cache.begin(), m_cache.end()});
+        }
+        else
+        {
+            // Persist what the cache already held, or the snapshot migrated, that the journal lacks.
+            for (const auto& [hash, info] : m_cache)
+            {
+                if (journaled.find(hash) == journaled.end())
+                {
+                    m_journal->Append(hash, info);
+                }
+            }
+        }
+
+        return loadedCount;
+    }
+
+    void ShaderCacheImpl::FlushJournal()
+    {
+        std::shared_ptr<ShaderCacheJournal> journal;
+        {
+            std::shared_lock lock{m_mutex};
+            journal = m_journal;
+        }
+
+        if (journal)
+        {
+            journal->Flush();
+        }
+    }
+
+    void ShaderCacheImpl::CompactJournal()
+    {
+        std::unique_lock lock{m_mutex};
+        if (m_journal)
+        {
+            m_journal->Compact({m_cache.begin(), m_cache.end()});
         }
-        return cacheSize;
+    }
+
+    void ShaderCacheImpl::CloseJournal()
+    {
+        std::shared_ptr<ShaderCacheJournal> journal;
+        {
+            std::unique_lock lock{m_mutex};
+            journal = std::move(m_journal);
+        }
+
+        // Destroying the journal drains pending records and compaction, then syncs the file.
+        // Done outside the lock so compiles on other threads are not held up by the disk.
+        journal.reset();
     }
 
     std::shared_ptr<Graphics::BgfxShaderInfo> ShaderCacheImpl::AddShader(std::string_view vertexSource, std::string_view fragmentSource, Graphics::BgfxShaderInfo shaderInfo)
     {
-        return m_cache.try_emplace(Hash(vertexSource, fragmentSource), std::make_shared<Graphics::BgfxShaderInfo>(std::move(shaderInfo))).first->second;
+        const auto hash = Hash(vertexSource, fragmentSource);
+        auto info = std::make_shared<Graphics::BgfxShaderInfo>(std::move(shaderInfo));
+
+        std::unique_lock lock{m_mutex};
+        const auto [iter, inserted] = m_cache.try_emplace(hash, std::move(info));
+        if (inserted && m_journal)
+        {
+            m_journal->Append(iter->first, iter->second);
+        }
+        return iter->second;
     }
 
     std::shared_ptr<Graphics::BgfxShaderInfo> ShaderCacheImpl::GetShader(std::string_view vertexSource, std::string_view fragmentSource)
     {
-        const auto iter = m_cache.find(Hash(vertexSource, fragmentSource));
+        const auto hash = Hash(vertexSource, fragmentSource);
+
+        std::shared_lock lock{m_mutex};
+        const auto iter = m_cache.find(hash);
         return (iter == m_cache.end() ? nullptr : iter->second);
     }
 
@@ -2,8 +2,12 @@
 
 #include <Babylon/Plugins/ShaderCacheInternal.h>
 
+#include <filesystem>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
 #include <string_view>
 #include <map>
 
@@ -11,26 +15,59 @@
 
 namespace Babylon::Plugins::ShaderCache
 {
+    class ShaderCacheJournal;
+
+    // Thread-safe: shaders are added from the thread pool while programs compile, and one
+    // cache is shared by every runtime in the process.
     class ShaderCacheImpl final
     {
     public:
+        using ShaderHash = std::pair<uint64_t, uint64_t>;
+
+        // 3: sampler uniforms are stored under their original GLSL name rather than the
+        //    SPIRV-Cross-renamed identifier, which changes both the bgfx uniform table in
+        //    Vertex/FragmentBytes and the keys of UniformStages.
+        static constexpr uint32_t CACHE_VERSION = 3;
+
         ShaderCacheImpl() = default;
+        ~ShaderCacheImpl();
 
         uint32_t Save(std::ostream& stream);
         uint32_t Load(std::istream& stream);
 
         void Clear();
 
+        uint32_t OpenJournal(const std::string& path);
+        void FlushJournal();
+        void CompactJournal();
+        void CloseJournal();
+
         std::shared_ptr<Graphics::BgfxShaderInfo> AddShader(std::string_view vertexSource, std::string_view fragmentSource, Graphics::BgfxShaderInfo shaderInfo);
         std::shared_ptr<Graphics::BgfxShaderInfo> GetShader(std::string_view vertexSource, std::string_view fragmentSource);
 
-        static inline std::unique_ptr<ShaderCacheImpl> Instance;
+        // Serialization of a single cache entry, shared by the snapshot format (Save/Load)
+        // and the journal records.
+        static void SaveEntry(std::ostream& stream, const ShaderHash& hash, const Graphics::BgfxShaderInfo& info);
+        static void LoadEntry(std::istream& stream, ShaderHash& hash, Graphics::BgfxShaderInfo& info);
 
-    private:
-        using ShaderHash = std::pair<uint64_t, uint64_t>;
+        // Process-wide cache. Held by shared_ptr so that Disable() on one thread cannot free
+        // the cache under another thread that is mid-lookup. Guarded by InstanceMutex.
+        static inline std::shared_ptr<ShaderCacheImpl> Instance;
+        static inline std::mutex InstanceMutex;
 
+    private:
         ShaderHash Hash(std::string_view vertexSource, std::string_view fragmentSource);
 
+        mutable std::shared_mutex m_mutex;
         std::map<ShaderHash, std::shared_ptr<Graphics::BgfxShaderInfo>> m_cache;
+
+        // Open journal, if any. Appended to under the unique lock so that records reach the
+        // journal in the same order as compaction snapshots. Held by shared_ptr so a flush can
+        // run without holding m_mutex.
+        std::shared_ptr<ShaderCacheJournal> m_journal;
+
+        // Absolute, normalized path of m_journal, to tell a reopen of the same file from a
+        // request for a different one.
+        std::filesystem::path m_journalPath;
     };
 }
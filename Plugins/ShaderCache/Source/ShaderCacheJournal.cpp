@@ -0,0 +1,397 @@
+#include "ShaderCacheJournal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Babylon::Plugins::ShaderCache::ShaderCacheImpl;
+    using Babylon::Plugins::ShaderCache::ShaderCacheJournal;
+
+    // "BNSJ" in little-endian byte order.
+    constexpr uint32_t JOURNAL_MAGIC = 0x4A534E42;
+    constexpr uint32_t JOURNAL_VERSION = 1;
+
+    constexpr size_t RECORD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t);
+
+    std::FILE* OpenFile(const std::filesystem::path& path, const wchar_t* wideMode, const char* mode)
+    {
+#ifdef _WIN32
+        (void)mode;
+        std::FILE* file{nullptr};
+        return _wfopen_s(&file, path.c_str(), wideMode) == 0 ? file : nullptr;
+#else
+        (void)wideMode;
+        return std::fopen(path.c_str(), mode);
+#endif
+    }
+
+    // fflush only hands the data to the OS; the journal is only crash consistent once the
+    // OS has written it out.
+    void SyncFile(std::FILE* file)
+    {
+        if (file == nullptr)
+        {
+            return;
+        }
+
+        std::fflush(file);
+#ifdef _WIN32
+        _commit(_fileno(file));
+#else
+        fsync(fileno(file));
+#endif
+    }
+
+    // Writes the record in one call so that a crash tears at most this record.
+    void WriteRecord(std::FILE* file, const ShaderCacheJournal::Entry& entry)
+    {
+        if (file == nullptr)
+        {
+            return;
+        }
+
+        std::ostringstream payloadStream{};
+        ShaderCacheImpl::SaveEntry(payloadStream, entry.first, *entry.second);
+        const auto payload = payloadStream.str();
+
+        const uint32_t payloadSize{static_cast<uint32_t>(payload.size())};
+        const uint64_t checksum{XXH3_64bits(payload.data(), payload.size())};
+
+        std::string record(RECORD_HEADER_SIZE + payload.size(), '\0');
+        std::memcpy(record.data(), &payloadSize, sizeof(uint32_t));
+        std::memcpy(record.data() + sizeof(uint32_t), &checksum, sizeof(uint64_t));
+        std::memcpy(record.data() + RECORD_HEADER_SIZE, payload.data(), payload.size());
+
+        std::fwrite(record.data(), 1, record.size(), file);
+    }
+
+    // Reads one record that must fit in the `remaining` bytes of the file. Returns false for
+    // a short, corrupt or unparseable record, which ends the intact part of the journal.
+    bool ReadRecord(std::istream& stream, uint64_t remaining, const ShaderCacheJournal::EntryCallback& onEntry)
+    {
+        if (remaining < RECORD_HEADER_SIZE)
+        {
+            return false;
+        }
+
+        uint32_t payloadSize{};
+        uint64_t checksum{};
+        stream.read(reinterpret_cast<char*>(&payloadSize), sizeof(uint32_t));
+        stream.read(reinterpret_cast<char*>(&checksum), sizeof(uint64_t));
+        if (!stream || payloadSize > remaining - RECORD_HEADER_SIZE)
+        {
+            return false;
+        }
+
+        std::string payload(payloadSize, '\0');
+        stream.read(payload.data(), payloadSize);
+        if (!stream || XXH3_64bits(payload.data(), payload.size()) != checksum)
+        {
+            return false;
+        }
+
+        std::istringstream payloadStream{std::move(payload)};
+        ShaderCacheJournal::ShaderHash hash{};
+        auto info = std::make_shared<Babylon::Graphics::BgfxShaderInfo>();
+        ShaderCacheImpl::LoadEntry(payloadStream, hash, *info);
+        if (!payloadStream)
+        {
+            return false;
+        }
+
+        onEntry(hash, std::move(info));
+        return true;
+    }
+}
+
+namespace Babylon::Plugins::ShaderCache
+{
+    ShaderCacheJournal::ShaderCacheJournal(std::string path, uint32_t cacheVersion, const EntryCallback& onEntry)
+        : m_path{std::move(path)}
+        , m_compactionPath{m_path + ".compact"}
+        , m_cacheVersion{cacheVersion}
+    {
+        // A compaction interrupted before its rename leaves its side file behind, but the
+        // journal it was replacing is still complete.
+        std::error_code error{};
+        std::filesystem::remove(m_compactionPath, error);
+
+        bool validHeader{false};
+        uint64_t validLength{0};
+        const uint64_t fileLength{std::filesystem::exists(m_path, error) ? std::filesystem::file_size(m_path, error) : 0};
+        {
+            std::ifstream stream{m_path, std::ios::binary};
+            uint32_t header[3]{};
+            if (stream.read(reinterpret_cast<char*>(header), sizeof(header)) &&
+                header[0] == JOURNAL_MAGIC && header[1] == JOURNAL_VERSION && header[2] == m_cacheVersion)
+            {
+                validHeader = true;
+                validLength = sizeof(header);
+                while (ReadRecord(stream, fileLength - validLength, onEntry))
+                {
+                    ++m_recordCount;
+                    validLength = static_cast<uint64_t>(stream.tellg());
+                }
+            }
+        }
+
+        if (validHeader)
+        {
+            // Drop a torn tail so that new records follow the last intact one.
+            if (validLength != fileLength)
+            {
+                std::filesystem::resize_file(m_path, validLength, error);
+            }
+            m_file = OpenFile(m_path, L"ab", "ab");
+        }
+        else
+        {
+            m_file = OpenFile(m_path, L"wb", "wb");
+            if (m_file != nullptr)
+            {
+                WriteHeader(m_file);
+                SyncFile(m_file);
+            }
+        }
+
+        if (m_file == nullptr)
+        {
+            throw std::runtime_error{"Unable to open shader cache journal " + m_path};
+        }
+
+        m_writerThread = std::thread{[this]() { Run(); }};
+    }
+
+    ShaderCacheJournal::~ShaderCacheJournal()
+    {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_stopping = true;
+            m_syncRequested = m_enqueued;
+        }
+        m_condition.notify_all();
+
+        m_writerThread.join();
+        if (m_compactionThread.joinable())
+        {
+            m_compactionThread.join();
+        }
+
+        if (m_file != nullptr)
+        {
+            std::fclose(m_file);
+        }
+    }
+
+    size_t ShaderCacheJournal::GetRecordCount() const
+    {
+        return m_recordCount;
+    }
+
+    void ShaderCacheJournal::Append(const ShaderHash& hash, std::shared_ptr<const Graphics::BgfxShaderInfo> info)
+    {
+        Push({JobType::Append, {hash, std::move(info)}, {}});
+    }
+
+    void ShaderCacheJournal::Flush()
+    {
+        std::unique_lock lock{m_mutex};
+        const auto target = m_enqueued;
+        m_syncRequested = std::max(m_syncRequested, target);
+        m_condition.notify_all();
+        m_condition.wait(lock, [this, target]() { return m_synced >= target; });
+    }
+
+    void ShaderCacheJournal::Compact(std::vector<Entry> snapshot)
+    {
+        {
+            std::scoped_lock lock{m_mutex};
+            ++m_compactionRequests;
+        }
+
+        Push({JobType::BeginCompaction, {}, std::move(snapshot)});
+    }
+
+    void ShaderCacheJournal::Push(Job job)
+    {
+        {
+            std::scoped_lock lock{m_mutex};
+            if (job.Type == JobType::Append)
+            {
+                ++m_enqueued;
+            }
+            m_jobs.push_back(std::move(job));
+        }
+        m_condition.notify_all();
+    }
+
+    void ShaderCacheJournal::Run()
+    {
+        std::unique_lock lock{m_mutex};
+        while (true)
+        {
+            if (!m_jobs.empty())
+            {
+                Job job{std::move(m_jobs.front())};
+                m_jobs.pop_front();
+
+                lock.unlock();
+                Process(job);
+                lock.lock();
+
+                if (job.Type == JobType::Append)
+                {
+                    ++m_written;
+                }
+                continue;
+            }
+
+            // Only reached with the queue empty, so everything enqueued so far is written.
+            if (m_syncRequested > m_synced)
+            {
+                const auto written = m_written;
+                lock.unlock();
+                SyncFile(m_file);
+                lock.lock();
+
+                m_synced = written;
+                m_condition.notify_all();
+                continue;
+            }
+
+            if (m_stopping && m_compactionRequests == 0)
+            {
+                break;
+            }
+
+            m_condition.wait(lock);
+        }
+    }
+
+    void ShaderCacheJournal::Process(Job& job)
+    {
+        switch (job.Type)
+        {
+            case JobType::Append:
+            {
+                WriteRecord(m_file, job.Record);
+                if (m_deferredCompaction)
+                {
+                    m_deferredCompaction->second.push_back(job.Record);
+                }
+                if (m_appendedDuringCompaction)
+                {
+                    m_appendedDuringCompaction->push_back(std::move(job.Record));
+                }
+                break;
+            }
+            case JobType::BeginCompaction:
+            {
+                if (m_appendedDuringCompaction)
+                {
+                    // One compaction at a time. A newer snapshot supersedes any deferred one,
+                    // which only drops an outstanding request.
+                    if (m_deferredCompaction)
+                    {
+                        std::scoped_lock lock{m_mutex};
+                        --m_compactionRequests;
+                    }
+                    m_deferredCompaction.emplace(std::move(job.Snapshot), std::vector<Entry>{});
+                }
+                else
+                {
+                    StartCompaction(std::move(job.Snapshot), {});
+                }
+                break;
+            }
+            case JobType::EndCompaction:
+            {
+                if (m_compactionFile != nullptr)
+                {
+                    for (const auto& entry : *m_appendedDuringCompaction)
+                    {
+                        WriteRecord(m_compactionFile, entry);
+                    }
+
+                    // The compacted file must be durable before it replaces the journal, or a
+                    // crash right after the rename could lose entries the old journal had.
+                    SyncFile(m_compactionFile);
+                    std::fclose(m_compactionFile);
+                    m_compactionFile = nullptr;
+
+                    if (m_file != nullptr)
+                    {
+                        std::fclose(m_file);
+                    }
+
+                    std::error_code error{};
+                    std::filesystem::rename(m_compactionPath, m_path, error);
+                    if (error)
+                    {
+                        std::filesystem::remove(m_compactionPath, error);
+                    }
+
+                    m_file = OpenFile(m_path, L"ab", "ab");
+                }
+
+                m_appendedDuringCompaction.reset();
+
+                if (m_deferredCompaction)
+                {
+                    auto [snapshot, appended] = std::move(*m_deferredCompaction);
+                    m_deferredCompaction.reset();
+                    StartCompaction(std::move(snapshot), std::move(appended));
+                }
+
+                std::scoped_lock lock{m_mutex};
+                --m_compactionRequests;
+                break;
+            }
+        }
+    }
+
+    void ShaderCacheJournal::StartCompaction(std::vector<Entry> snapshot, std::vector<Entry> appendedSinceSnapshot)
+    {
+        // Records written from here on are not in the snapshot; they are replayed into the
+        // compacted file just before the swap.
+        m_appendedDuringCompaction.emplace(std::move(appendedSinceSnapshot));
+
+        if (m_compactionThread.joinable())
+        {
+            m_compactionThread.join();
+        }
+
+        m_compactionThread = std::thread{[this, snapshot = std::move(snapshot)]() {
+            std::FILE* file{OpenFile(m_compactionPath, L"wb", "wb")};
+            if (file != nullptr)
+            {
+                WriteHeader(file);
+                for (const auto& entry : snapshot)
+                {
+                    WriteRecord(file, entry);
+                }
+            }
+
+            // Handed to the writer thread through the queue.
+            m_compactionFile = file;
+            Push({JobType::EndCompaction, {}, {}});
+        }};
+    }
+
+    void ShaderCacheJournal::WriteHeader(std::FILE* file)
+    {
+        const uint32_t header[3]{JOURNAL_MAGIC, JOURNAL_VERSION, m_cacheVersion};
+        std::fwrite(header, sizeof(uint32_t), 3, file);
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "ShaderCacheImpl.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Babylon::Plugins::ShaderCache
+{
+    // Append-only on-disk log of shader cache entries.
+    //
+    // Layout: a header (magic, journal format version, cache version) followed by records of
+    // [uint32 payload size][uint64 XXH3 of payload][payload], where the payload is one entry
+    // in the ShaderCacheImpl::SaveEntry format. Records are only ever appended, so a crash can
+    // at worst leave a torn last record; on open, reading stops at the first record that is
+    // short or fails its checksum and the file is truncated back to the last good record.
+    //
+    // All file writes happen on a dedicated writer thread, so Append only queues. Compaction
+    // serializes a snapshot into a side file on its own thread; the writer then appends what
+    // was journaled since the snapshot and renames the side file over the journal.
+    class ShaderCacheJournal final
+    {
+    public:
+        using ShaderHash = ShaderCacheImpl::ShaderHash;
+        using Entry = std::pair<ShaderHash, std::shared_ptr<const Graphics::BgfxShaderInfo>>;
+        using EntryCallback = std::function<void(const ShaderHash&, std::shared_ptr<Graphics::BgfxShaderInfo>)>;
+
+        // Opens or creates the journal at `path` and reports every intact record through
+        // `onEntry` before returning. A file with a different header starts over empty.
+        ShaderCacheJournal(std::string path, uint32_t cacheVersion, const EntryCallback& onEntry);
+
+        // Drains queued records and any running compaction, then syncs the file.
+        ~ShaderCacheJournal();
+
+        ShaderCacheJournal(const ShaderCacheJournal&) = delete;
+        ShaderCacheJournal& operator=(const ShaderCacheJournal&) = delete;
+
+        // Number of intact records found when the journal was opened.
+        size_t GetRecordCount() const;
+
+        // Queues an entry to be appended.
+        void Append(const ShaderHash& hash, std::shared_ptr<const Graphics::BgfxShaderInfo> info);
+
+        // Blocks until every entry queued before the call is written and synced to disk.
+        void Flush();
+
+        // Rewrites the journal to hold exactly `snapshot` plus anything appended after this
+        // call. Runs in the background; a request made while another compaction is running
+        // starts when that one finishes.
+        void Compact(std::vector<Entry> snapshot);
+
+    private:
+        enum class JobType
+        {
+            Append,
+            BeginCompaction,
+            EndCompaction,
+        };
+
+        struct Job
+        {
+            JobType Type{};
+            Entry Record{};
+            std::vector<Entry> Snapshot{};
+        };
+
+        void Run();
+        void Process(Job& job);
+        void StartCompaction(std::vector<Entry> snapshot, std::vector<Entry> appendedSinceSnapshot);
+        void WriteHeader(std::FILE* file);
+        void Push(Job job);
+
+        const std::string m_path;
+        const std::string m_compactionPath;
+        const uint32_t m_cacheVersion;
+
+        size_t m_recordCount{0};
+
+        // Writer-thread state.
+        std::FILE* m_file{nullptr};
+        std::optional<std::vector<Entry>> m_appendedDuringCompaction{};
+        std::optional<std::pair<std::vector<Entry>, std::vector<Entry>>> m_deferredCompaction{};
+        std::FILE* m_compactionFile{nullptr};
+        std::thread m_compactionThread{};
+
+        // Shared state, guarded by m_mutex.
+        std::mutex m_mutex{};
+        std::condition_variable m_condition{};
+        std::deque<Job> m_jobs{};
+        uint64_t m_enqueued{0};
+        uint64_t m_written{0};
+        uint64_t m_syncRequested{0};
+        uint64_t m_synced{0};
+        uint32_t m_compactionRequests{0};
+        bool m_stopping{false};
+
+        std::thread m_writerThread{};
+    };
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Babylon::Polyfills::Internal
+{
+    // Writes a `readWidth` x `readHeight` RGBA8 readback of the canvas into the RGBA8 pixels of
+    // an ImageData `imageDataWidth` pixels wide, with the readback's top left corner at (`x`, `y`).
+    // The readback is premultiplied, as nanovg renders it, and its rows run bottom up when
+    // `bottomUp` (the renderer's texture origin is at the bottom left). ImageData rows run top
+    // down and are not premultiplied. Pixels of the ImageData outside the readback are left as
+    // they are.
+    void CopyReadbackToImageData(const uint8_t* readback, uint32_t readWidth, uint32_t readHeight, bool bottomUp, uint8_t* imageData, uint32_t imageDataWidth, uint32_t x, uint32_t y);
+}
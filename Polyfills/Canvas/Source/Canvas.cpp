@@ -35,7 +35,10 @@ namespace Babylon::Polyfills::Internal
                 InstanceMethod("getCanvasTexture", &NativeCanvas::GetCanvasTexture),
                 InstanceMethod("dispose", &NativeCanvas::Dispose),
                 InstanceMethod("remove", &NativeCanvas::Remove),
-                StaticMethod("parseColor", &NativeCanvas::ParseColor)});
+                InstanceMethod("getFrameBufferPoolStats", &NativeCanvas::GetFrameBufferPoolStats),
+                StaticMethod("parseColor", &NativeCanvas::ParseColor),
+                StaticMethod("prewarmGlyphs", &NativeCanvas::PrewarmGlyphs),
+                StaticMethod("getGlyphCacheStats", &NativeCanvas::GetGlyphCacheStats)});
 
         JsRuntime::NativeObject::GetFromJavaScript(env).Set(JS_CONSTRUCTOR_NAME, func);
     }
@@ -74,12 +77,13 @@ namespace Babylon::Polyfills::Internal
             throw Napi::TypeError::New(info.Env(), std::string{methodName} + " expects the font name as a string in argument 1.");
         }
 
-        // don't allow same font to be loaded more than once
-        // why? because Context doesn't update nvgCreateFontMem when old fontBuffer released
+        // Fonts are registered once per process and shared by every context, so loading the
+        // same font again keeps the first one.
         auto fontName = info[0].As<Napi::String>().Utf8Value();
-        if (fontsInfos.find(fontName) == fontsInfos.end())
+        if (nanovg_glyphcache::FindFont(fontName) == -1
+            && nanovg_glyphcache::AddFont(fontName, GetFontDataArgument(info, 1, methodName)) == -1)
         {
-            fontsInfos[fontName] = GetFontDataArgument(info, 1, methodName);
+            throw Napi::Error::New(info.Env(), std::string{methodName} + ": the font data for '" + fontName + "' could not be loaded.");
         }
     }
 
@@ -205,8 +209,8 @@ namespace Babylon::Polyfills::Internal
                 m_texture.reset();
             }
 
-            m_frameBufferPool.Clear();
-            m_frameBufferPool.SetDimensions(m_width, m_height);
+            // Buffers pooled at the previous size stay until the pool trims or evicts them, so a
+            // canvas that switches back and forth between sizes keeps hitting the pool.
             m_frameBufferPool.SetGraphicsContext(&m_graphicsContext);
 
             return true;
@@ -229,6 +233,62 @@ namespace Babylon::Polyfills::Internal
         return Napi::Pointer<Graphics::Texture>::Create(info.Env(), m_texture.get());
     }
 
+    // Counters for the filter render target pool, for diagnostics and tests.
+    Napi::Value NativeCanvas::GetFrameBufferPoolStats(const Napi::CallbackInfo& info)
+    {
+        const auto stats = m_frameBufferPool.GetStats();
+
+        auto result = Napi::Object::New(info.Env());
+        result.Set("hits", Napi::Value::From(info.Env(), static_cast<double>(stats.Hits)));
+        result.Set("misses", Napi::Value::From(info.Env(), static_cast<double>(stats.Misses)));
+        result.Set("evictions", Napi::Value::From(info.Env(), static_cast<double>(stats.Evictions)));
+        result.Set("buffers", Napi::Value::From(info.Env(), static_cast<double>(stats.Buffers)));
+        result.Set("acquired", Napi::Value::From(info.Env(), static_cast<double>(stats.Acquired)));
+        result.Set("bytes", Napi::Value::From(info.Env(), static_cast<double>(stats.Bytes)));
+        return result;
+    }
+
+    void NativeCanvas::PrewarmGlyphs(const Napi::CallbackInfo& info)
+    {
+        if (info.Length() < 3 || !info[0].IsString() || !info[1].IsString() || !info[2].IsArray())
+        {
+            throw Napi::TypeError::New(info.Env(), "Canvas.prewarmGlyphs expects a font name, a string of characters and an array of font sizes.");
+        }
+
+        const auto fontName = info[0].As<Napi::String>().Utf8Value();
+        const int fontId = nanovg_glyphcache::FindFont(fontName);
+        if (fontId == -1)
+        {
+            throw Napi::Error::New(info.Env(), "Canvas.prewarmGlyphs: font '" + fontName + "' is not loaded.");
+        }
+
+        const auto sizesArray = info[2].As<Napi::Array>();
+        std::vector<float> fontSizes(sizesArray.Length());
+        for (uint32_t index = 0; index < sizesArray.Length(); ++index)
+        {
+            fontSizes[index] = sizesArray.Get(index).As<Napi::Number>().FloatValue();
+        }
+
+        nanovg_glyphcache::Get()->Prewarm(fontId, fontSizes, info[1].As<Napi::String>().Utf8Value());
+    }
+
+    Napi::Value NativeCanvas::GetGlyphCacheStats(const Napi::CallbackInfo& info)
+    {
+        const auto stats = nanovg_glyphcache::Get()->GetStats();
+
+        auto result = Napi::Object::New(info.Env());
+        result.Set("fonts", Napi::Value::From(info.Env(), static_cast<double>(stats.Fonts)));
+        result.Set("fontBytes", Napi::Value::From(info.Env(), static_cast<double>(stats.FontBytes)));
+        result.Set("atlases", Napi::Value::From(info.Env(), static_cast<double>(stats.Atlases)));
+        result.Set("atlasBytes", Napi::Value::From(info.Env(), static_cast<double>(stats.AtlasBytes)));
+        result.Set("growths", Napi::Value::From(info.Env(), static_cast<double>(stats.Growths)));
+        result.Set("evictions", Napi::Value::From(info.Env(), static_cast<double>(stats.Evictions)));
+        result.Set("uploads", Napi::Value::From(info.Env(), static_cast<double>(stats.Uploads)));
+        result.Set("uploadedBytes", Napi::Value::From(info.Env(), static_cast<double>(stats.UploadedBytes)));
+        result.Set("retiredTextures", Napi::Value::From(info.Env(), static_cast<double>(stats.RetiredTextures)));
+        return result;
+    }
+
     Napi::Value NativeCanvas::ParseColor(const Napi::CallbackInfo& info)
     {
         const auto colorString = info[0].As<Napi::String>().Utf8Value();
@@ -299,6 +359,7 @@ namespace Babylon::Polyfills
         {
             monitoredResource->FlushGraphicResources();
         }
+        m_glyphCache->FlushGraphicResources();
     }
 
     Canvas::Canvas(std::shared_ptr<Impl> impl)
@@ -7,6 +7,7 @@
 #include <Babylon/Graphics/Texture.h>
 
 #include "FrameBufferPool.h"
+#include "nanovg/nanovg_glyphcache.h"
 
 namespace Babylon::Polyfills
 {
@@ -45,6 +46,9 @@ namespace Babylon::Polyfills
 
         std::vector<MonitoredResource*> m_monitoredResources{};
 
+        // Keeps the glyph atlases alive between contexts, e.g. after Canvas.prewarmGlyphs.
+        std::shared_ptr<nanovg_glyphcache> m_glyphCache{nanovg_glyphcache::Get()};
+
         void AddMonitoredResource(MonitoredResource* monitoredResource);
         void RemoveMonitoredResource(MonitoredResource* monitoredResource);
 
@@ -65,8 +69,6 @@ namespace Babylon::Polyfills::Internal
         uint32_t GetWidth() const { return m_width; }
         uint32_t GetHeight() const { return m_height; }
 
-        static inline std::map<std::string, std::vector<uint8_t>> fontsInfos;
-
         bool UpdateRenderTarget();
         Babylon::Graphics::FrameBuffer& GetFrameBuffer() { return *m_frameBuffer; }
         FrameBufferPool m_frameBufferPool;
@@ -92,12 +94,15 @@ namespace Babylon::Polyfills::Internal
         Napi::Value GetHeight(const Napi::CallbackInfo&);
         void SetHeight(const Napi::CallbackInfo&, const Napi::Value& value);
         Napi::Value GetCanvasTexture(const Napi::CallbackInfo& info);
+        Napi::Value GetFrameBufferPoolStats(const Napi::CallbackInfo& info);
         static void LoadTTF(const Napi::CallbackInfo& info);
         static Napi::Value LoadTTFAsync(const Napi::CallbackInfo& info);
         // Both entry points share this; each passes its own name so the diagnostics name the
         // method the caller actually invoked rather than the one it happens to delegate to.
         static void LoadTTFCore(const Napi::CallbackInfo& info, const char* methodName);
         static Napi::Value ParseColor(const Napi::CallbackInfo& info);
+        static void PrewarmGlyphs(const Napi::CallbackInfo& info);
+        static Napi::Value GetGlyphCacheStats(const Napi::CallbackInfo& info);
         void Remove(const Napi::CallbackInfo& info);
         void Dispose(const Napi::CallbackInfo& info);
         void Dispose();
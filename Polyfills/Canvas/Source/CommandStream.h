@@ -0,0 +1,111 @@
+#pragma once
+
+#include <gsl/gsl>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace Babylon::Polyfills::Internal
+{
+    // Opcodes of the binary command stream replayed by Context::SubmitCommands, exposed to
+    // JavaScript as Context.COMMAND_* so the encoder never hardcodes them.
+    //
+    // The stream is a sequence of 32-bit words: an opcode followed by its arguments, which are
+    // float32 unless noted. Strings are passed as a uint32 index into the array of strings
+    // submitted with the stream.
+    enum class CanvasCommand : uint32_t
+    {
+        BeginPath,        // -
+        ClosePath,        // -
+        MoveTo,           // x, y
+        LineTo,           // x, y
+        QuadraticCurveTo, // cpx, cpy, x, y
+        Arc,              // x, y, radius, startAngle, endAngle, counterclockwise (uint32)
+        Rect,             // x, y, width, height
+        Fill,             // -
+        Stroke,           // -
+        Clip,             // -
+        FillRect,         // x, y, width, height
+        StrokeRect,       // x, y, width, height
+        ClearRect,        // x, y, width, height
+        Save,             // -
+        Restore,          // -
+        Translate,        // x, y
+        Rotate,           // angle
+        Scale,            // x, y
+        SetTransform,     // a, b, c, d, e, f
+        Transform,        // a, b, c, d, e, f
+        SetFillStyle,     // color (string)
+        SetStrokeStyle,   // color (string)
+        SetLineWidth,     // width
+        SetGlobalAlpha,   // alpha
+        FillText,         // text (string), x, y
+        Count,
+    };
+
+    // Reads a command stream in the JavaScript-owned buffer it was submitted in. Unlike
+    // NativeDataStream::Reader, every read is bounds checked: the buffer comes straight from
+    // script, so a truncated command throws instead of reading past the end.
+    class CommandStreamReader final
+    {
+    public:
+        explicit CommandStreamReader(gsl::span<const uint32_t> buffer)
+            : m_buffer{buffer}
+        {
+        }
+
+        CommandStreamReader(const CommandStreamReader&) = delete;
+        CommandStreamReader& operator=(const CommandStreamReader&) = delete;
+
+        bool CanRead() const
+        {
+            return m_position < static_cast<size_t>(m_buffer.size());
+        }
+
+        CanvasCommand ReadCommand()
+        {
+            const uint32_t command{ReadUint32()};
+            if (command >= static_cast<uint32_t>(CanvasCommand::Count))
+            {
+                throw std::runtime_error{"Canvas command stream: unknown command " + std::to_string(command) + "."};
+            }
+            return static_cast<CanvasCommand>(command);
+        }
+
+        uint32_t ReadUint32()
+        {
+            if (!CanRead())
+            {
+                throw std::runtime_error{"Canvas command stream: the last command is truncated."};
+            }
+            return m_buffer[m_position++];
+        }
+
+        float ReadFloat32()
+        {
+            const uint32_t bits{ReadUint32()};
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        // Reads the arguments of a command in order, which a braced call to the command would
+        // not guarantee.
+        template<size_t N>
+        std::array<float, N> ReadFloat32s()
+        {
+            std::array<float, N> values{};
+            for (auto& value : values)
+            {
+                value = ReadFloat32();
+            }
+            return values;
+        }
+
+    private:
+        gsl::span<const uint32_t> m_buffer{};
+        size_t m_position{0};
+    };
+}
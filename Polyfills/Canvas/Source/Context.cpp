@@ -9,6 +9,9 @@
 #include <optional>
 #include <regex>
 
+#include <arcana/threading/task_schedulers.h>
+#include <Babylon/Polyfills/CanvasInternal.h>
+
 #ifdef __GNUC__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
@@ -34,6 +37,7 @@
 #include "Colors.h"
 #include "LineCaps.h"
 #include "Gradient.h"
+#include "CommandStream.h"
 
 #ifdef BABYLON_NATIVE_PLUGIN_NATIVEENGINE_LOAD_IMAGES
 #include <bimg/bimg.h>
@@ -55,6 +59,13 @@ namespace Babylon::Polyfills::Internal
                 value <= static_cast<double>(std::numeric_limits<uint32_t>::max()) &&
                 value == std::trunc(value);
         }
+
+        // Applies the color functions of the filter to a color of the draw.
+        NVGcolor FilterColor(const nanovg_filterstack& filterStack, NVGcolor color)
+        {
+            filterStack.TransformColor(color.rgba);
+            return color;
+        }
     }
 
     void Context::Initialize(Napi::Env env)
@@ -88,9 +99,11 @@ namespace Babylon::Polyfills::Internal
                 InstanceMethod("fill", &Context::Fill),
                 InstanceMethod("drawImage", &Context::DrawImage),
                 InstanceMethod("getImageData", &Context::GetImageData),
+                InstanceMethod("getImageDataAsync", &Context::GetImageDataAsync),
                 InstanceMethod("createImageData", &Context::CreateImageData),
                 InstanceMethod("setLineDash", &Context::SetLineDash),
                 InstanceMethod("getLineDash", &Context::GetLineDash),
+                InstanceAccessor("lineDashOffset", &Context::GetLineDashOffset, &Context::SetLineDashOffset),
                 InstanceMethod("fillText", &Context::FillText),
                 InstanceMethod("strokeText", &Context::StrokeText),
                 InstanceMethod("createLinearGradient", &Context::CreateLinearGradient),
@@ -100,6 +113,11 @@ namespace Babylon::Polyfills::Internal
                 InstanceMethod("transform", &Context::Transform),
                 InstanceMethod("dispose", &Context::Dispose),
                 InstanceMethod("flush", &Context::Flush),
+                InstanceMethod("getFlushStats", &Context::GetFlushStats),
+                InstanceMethod("getFilterCacheStats", &Context::GetFilterCacheStats),
+                InstanceMethod("getImageUploadStats", &Context::GetImageUploadStats),
+                InstanceMethod("getGradientAtlasStats", &Context::GetGradientAtlasStats),
+                InstanceMethod("submitCommands", &Context::SubmitCommands),
                 InstanceAccessor("lineCap", &Context::GetLineCap, &Context::SetLineCap),
                 InstanceAccessor("lineJoin", &Context::GetLineJoin, &Context::SetLineJoin),
                 InstanceAccessor("miterLimit", &Context::GetMiterLimit, &Context::SetMiterLimit),
@@ -115,6 +133,31 @@ namespace Babylon::Polyfills::Internal
                 InstanceAccessor("shadowOffsetX", &Context::GetShadowOffsetX, &Context::SetShadowOffsetX),
                 InstanceAccessor("shadowOffsetY", &Context::GetShadowOffsetY, &Context::SetShadowOffsetY),
                 InstanceAccessor("lineWidth", &Context::GetLineWidth, &Context::SetLineWidth),
+                StaticValue("COMMAND_BEGINPATH", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::BeginPath))),
+                StaticValue("COMMAND_CLOSEPATH", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::ClosePath))),
+                StaticValue("COMMAND_MOVETO", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::MoveTo))),
+                StaticValue("COMMAND_LINETO", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::LineTo))),
+                StaticValue("COMMAND_QUADRATICCURVETO", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::QuadraticCurveTo))),
+                StaticValue("COMMAND_ARC", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Arc))),
+                StaticValue("COMMAND_RECT", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Rect))),
+                StaticValue("COMMAND_FILL", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Fill))),
+                StaticValue("COMMAND_STROKE", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Stroke))),
+                StaticValue("COMMAND_CLIP", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Clip))),
+                StaticValue("COMMAND_FILLRECT", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::FillRect))),
+                StaticValue("COMMAND_STROKERECT", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::StrokeRect))),
+                StaticValue("COMMAND_CLEARRECT", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::ClearRect))),
+                StaticValue("COMMAND_SAVE", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Save))),
+                StaticValue("COMMAND_RESTORE", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Restore))),
+                StaticValue("COMMAND_TRANSLATE", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Translate))),
+                StaticValue("COMMAND_ROTATE", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Rotate))),
+                StaticValue("COMMAND_SCALE", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Scale))),
+                StaticValue("COMMAND_SETTRANSFORM", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::SetTransform))),
+                StaticValue("COMMAND_TRANSFORM", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::Transform))),
+                StaticValue("COMMAND_SETFILLSTYLE", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::SetFillStyle))),
+                StaticValue("COMMAND_SETSTROKESTYLE", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::SetStrokeStyle))),
+                StaticValue("COMMAND_SETLINEWIDTH", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::SetLineWidth))),
+                StaticValue("COMMAND_SETGLOBALALPHA", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::SetGlobalAlpha))),
+                StaticValue("COMMAND_FILLTEXT", Napi::Number::From(env, static_cast<uint32_t>(CanvasCommand::FillText))),
             });
         JsRuntime::NativeObject::GetFromJavaScript(env).Set(JS_CONTEXT_CONSTRUCTOR_NAME, func);
     }
@@ -138,6 +181,8 @@ namespace Babylon::Polyfills::Internal
         //info.This().ToObject().DefineProperty(Napi::PropertyDescriptor::Value("canvas", info[0], napi_enumerable));
         info.This().ToObject().Set("canvas", info[0]);
 
+        nvgSetGlyphCache(*m_nvg, m_glyphCache.get());
+
         // Fonts loaded after this Context is created are picked up in Flush().
     }
 
@@ -161,6 +206,9 @@ namespace Babylon::Polyfills::Internal
     {
         if (m_nvg)
         {
+            DeleteUploadImages();
+            m_gradientAtlas->DeleteImages(**m_nvg);
+            m_gradientAtlas.reset();
             for (auto& image : m_nvgImageIndices)
             {
                 nvgDeleteImage(*m_nvg, image.second);
@@ -170,7 +218,7 @@ namespace Babylon::Polyfills::Internal
         }
     }
 
-    void Context::BindFillStyle(const Napi::CallbackInfo& info)
+    void Context::BindFillStyle(Napi::Env env)
     {
         if (std::holds_alternative<std::string>(m_state.fillStyle))
         {
@@ -178,21 +226,21 @@ namespace Babylon::Polyfills::Internal
             // Treat unset/empty fillStyle as opaque white (nvg's default fill color) instead of
             // the transparent black returned by StringToColor("") — this matches how fillStyle
             // behaves before any explicit assignment via SetFillStyle.
-            const auto color = str.empty() ? nvgRGBA(255, 255, 255, 255) : StringToColor(info.Env(), str);
-            nvgFillColor(*m_nvg, color);
+            const auto color = str.empty() ? nvgRGBA(255, 255, 255, 255) : StringToColor(env, str);
+            nvgFillColor(*m_nvg, FilterColor(m_state.filterStack, color));
         }
         else if (std::holds_alternative<GradientStyle>(m_state.fillStyle))
         {
             CanvasGradient* gradient = CanvasGradient::Unwrap(std::get<GradientStyle>(m_state.fillStyle)->Value());
-            nvgFillPaint(*m_nvg, gradient->Paint());
+            nvgFillPaint(*m_nvg, gradient->Paint(&m_state.filterStack));
         }
         else
         {
-            throw Napi::Error::New(info.Env(), "Fillstyle is not a color string or a gradient.");
+            throw Napi::Error::New(env, "Fillstyle is not a color string or a gradient.");
         }
     }
 
-    void Context::BindStrokeStyle(const Napi::CallbackInfo& info)
+    void Context::BindStrokeStyle(Napi::Env env)
     {
         if (std::holds_alternative<std::string>(m_state.strokeStyle))
         {
@@ -200,30 +248,39 @@ namespace Babylon::Polyfills::Internal
             // Treat unset/empty strokeStyle as opaque black -- both the Canvas2D default
             // ("#000000") and nvg's default stroke color -- instead of the transparent black
             // StringToColor("") would return.
-            const auto color = str.empty() ? nvgRGBA(0, 0, 0, 255) : StringToColor(info.Env(), str);
-            nvgStrokeColor(*m_nvg, color);
+            const auto color = str.empty() ? nvgRGBA(0, 0, 0, 255) : StringToColor(env, str);
+            nvgStrokeColor(*m_nvg, FilterColor(m_state.filterStack, color));
         }
         else if (std::holds_alternative<GradientStyle>(m_state.strokeStyle))
         {
             CanvasGradient* gradient = CanvasGradient::Unwrap(std::get<GradientStyle>(m_state.strokeStyle)->Value());
-            nvgStrokePaint(*m_nvg, gradient->Paint());
+            nvgStrokePaint(*m_nvg, gradient->Paint(&m_state.filterStack));
         }
         else
         {
-            throw Napi::Error::New(info.Env(), "Strokestyle is not a color string or a gradient.");
+            throw Napi::Error::New(env, "Strokestyle is not a color string or a gradient.");
         }
+
+        // The dash pattern is part of the stroke style, and like it is lost when the frame is flushed.
+        const std::vector<float> dashes{m_state.lineDash.begin(), m_state.lineDash.end()};
+        nvgLineDash(*m_nvg, dashes.data(), static_cast<int>(dashes.size()), static_cast<float>(m_state.lineDashOffset));
+    }
+
+    void Context::BindShadow(Napi::Env env)
+    {
+        const auto color = FilterColor(m_state.filterStack, StringToColor(env, m_state.shadowColor));
+        nvgShadow(*m_nvg, color, static_cast<float>(m_state.shadowBlur),
+            static_cast<float>(m_state.shadowOffsetX), static_cast<float>(m_state.shadowOffsetY));
     }
 
     void Context::SetFilterStack()
     {
-        if (m_state.filter.length())
-        {
-            nanovg_filterstack filterStack;
-            filterStack.ParseString(m_state.filter);
-            nvgFilterStack(*m_nvg, filterStack); // sets filterStack on nanovg
-        }
+        // Parsed when the filter is set. Only the blur passes are run by nanovg; the color
+        // functions are applied to the colors, gradients and images of the draw as they are bound.
+        nvgFilterStack(*m_nvg, m_state.filterStack);
     }
 
+
     void Context::FillRect(const Napi::CallbackInfo& info)
     {
         auto left = info[0].As<Napi::Number>().FloatValue();
@@ -231,6 +288,11 @@ namespace Babylon::Polyfills::Internal
         auto width = info[2].As<Napi::Number>().FloatValue();
         auto height = info[3].As<Napi::Number>().FloatValue();
 
+        FillRectCore(info.Env(), left, top, width, height);
+    }
+
+    void Context::FillRectCore(Napi::Env env, float left, float top, float width, float height)
+    {
         // fillRect neither reads nor modifies the current path per spec, so it
         // would normally start its own. But Clip() can only express a rectangle
         // (nvgScissor), so a non-rectangular clip path is emulated by leaving it
@@ -242,9 +304,10 @@ namespace Babylon::Polyfills::Internal
 
         nvgRect(*m_nvg, left, top, width, height);
 
-        BindFillStyle(info);
+        BindFillStyle(env);
 
         SetFilterStack();
+        BindShadow(env);
         nvgFill(*m_nvg);
     }
 
@@ -269,10 +332,7 @@ namespace Babylon::Polyfills::Internal
         // than for "is an object", so `ctx.fillStyle = {}` cannot reach Unwrap.
         if (value.IsString())
         {
-            auto string = value.As<Napi::String>().Utf8Value();
-            const auto color = StringToColor(info.Env(), string);
-            m_state.fillStyle = string;
-            nvgFillColor(*m_nvg, color);
+            SetFillStyleCore(info.Env(), value.As<Napi::String>().Utf8Value());
         }
         else if (CanvasGradient::IsInstance(info.Env(), value))
         {
@@ -281,6 +341,13 @@ namespace Babylon::Polyfills::Internal
         // Anything else leaves fillStyle unchanged, as the spec requires.
     }
 
+    void Context::SetFillStyleCore(Napi::Env env, std::string color)
+    {
+        const auto nvgColor = StringToColor(env, color);
+        m_state.fillStyle = std::move(color);
+        nvgFillColor(*m_nvg, nvgColor);
+    }
+
     Napi::Value Context::GetStrokeStyle(const Napi::CallbackInfo&)
     {
         if (std::holds_alternative<std::string>(m_state.strokeStyle))
@@ -299,10 +366,7 @@ namespace Babylon::Polyfills::Internal
         // Line and the border of a Button assign one directly.
         if (value.IsString())
         {
-            auto string = value.As<Napi::String>().Utf8Value();
-            const auto color = StringToColor(info.Env(), string);
-            m_state.strokeStyle = string;
-            nvgStrokeColor(*m_nvg, color);
+            SetStrokeStyleCore(info.Env(), value.As<Napi::String>().Utf8Value());
         }
         else if (CanvasGradient::IsInstance(info.Env(), value))
         {
@@ -312,6 +376,13 @@ namespace Babylon::Polyfills::Internal
         // gradient/pattern leaves strokeStyle unchanged.
     }
 
+    void Context::SetStrokeStyleCore(Napi::Env env, std::string color)
+    {
+        const auto nvgColor = StringToColor(env, color);
+        m_state.strokeStyle = std::move(color);
+        nvgStrokeColor(*m_nvg, nvgColor);
+    }
+
     Napi::Value Context::GetLineWidth(const Napi::CallbackInfo&)
     {
         return Napi::Value::From(Env(), m_state.lineWidth);
@@ -319,34 +390,56 @@ namespace Babylon::Polyfills::Internal
 
     void Context::SetLineWidth(const Napi::CallbackInfo&, const Napi::Value& value)
     {
-        m_state.lineWidth = value.As<Napi::Number>().FloatValue();
+        SetLineWidthCore(value.As<Napi::Number>().FloatValue());
+    }
+
+    void Context::SetLineWidthCore(float width)
+    {
+        m_state.lineWidth = width;
         nvgStrokeWidth(*m_nvg, m_state.lineWidth);
     }
 
     void Context::Fill(const Napi::CallbackInfo& info)
     {
-        SetFilterStack();
-
         const NativeCanvasPath2D* path = info.Length() >= 1 && info[0].IsObject()
             ? NativeCanvasPath2D::Unwrap(info[0].As<Napi::Object>())
             : nullptr;
+
+        // nanovg only fills nonzero; the rule just keeps the cached tessellations apart.
         // TODO: handle fillRule: nonzero, evenodd
+        const Napi::Value fillRule = path != nullptr ? info[1] : info[0];
+        const int evenOdd = fillRule.IsString() && fillRule.As<Napi::String>().Utf8Value() == "evenodd" ? 1 : 0;
 
         // draw Path2D if exists
         if (path != nullptr)
         {
             PlayPath2D(path);
+            FillCore(info.Env(), path->GetTessCache(), evenOdd);
+            return;
         }
 
+        FillCore(info.Env());
+    }
+
+    void Context::FillCore(Napi::Env env, NVGtessCache* tessCache, int fillRule)
+    {
+        SetFilterStack();
+        BindShadow(env);
+
         // Bind the current fillStyle here rather than relying on the nvg state SetFillStyle
         // leaves behind: assigning a gradient only records the pointer (the paint has to be
         // rebuilt per draw), and nvgRestore can pop a color set after the last assignment.
-        BindFillStyle(info);
+        BindFillStyle(env);
 
-        nvgFill(*m_nvg);
+        nvgFillCached(*m_nvg, tessCache, fillRule);
     }
 
     void Context::Save(const Napi::CallbackInfo&)
+    {
+        SaveCore();
+    }
+
+    void Context::SaveCore()
     {
         nvgSave(*m_nvg);
         // Track the wrapper-side drawing state alongside the nvg state stack so that
@@ -357,6 +450,11 @@ namespace Babylon::Polyfills::Internal
     }
 
     void Context::Restore(const Napi::CallbackInfo&)
+    {
+        RestoreCore();
+    }
+
+    void Context::RestoreCore()
     {
         nvgRestore(*m_nvg);
         m_isClipped = false;
@@ -374,6 +472,11 @@ namespace Babylon::Polyfills::Internal
         const float width = info[2].As<Napi::Number>().FloatValue();
         const float height = info[3].As<Napi::Number>().FloatValue();
 
+        ClearRectCore(x, y, width, height);
+    }
+
+    void Context::ClearRectCore(float x, float y, float width, float height)
+    {
         nvgSave(*m_nvg);
         nvgGlobalCompositeOperation(*m_nvg, NVG_COPY);
 
@@ -387,6 +490,8 @@ namespace Babylon::Polyfills::Internal
         nvgClosePath(*m_nvg);
 
         nvgFillColor(*m_nvg, TRANSPARENT_BLACK);
+        // clearRect draws no shadow, whatever the last draw left bound.
+        nvgShadow(*m_nvg, TRANSPARENT_BLACK, 0.f, 0.f, 0.f);
         nvgFill(*m_nvg);
         nvgRestore(*m_nvg);
     }
@@ -435,6 +540,11 @@ namespace Babylon::Polyfills::Internal
         const auto width = info[2].As<Napi::Number>().FloatValue();
         const auto height = info[3].As<Napi::Number>().FloatValue();
 
+        RectCore(left, top, width, height);
+    }
+
+    void Context::RectCore(float left, float top, float width, float height)
+    {
         nvgRect(*m_nvg, left, top, width, height);
         m_rectangleClipping = {left, top, width, height};
     }
@@ -515,6 +625,11 @@ namespace Babylon::Polyfills::Internal
     }
 
     void Context::Clip(const Napi::CallbackInfo& /*info*/)
+    {
+        ClipCore();
+    }
+
+    void Context::ClipCore()
     {
         // A non-rectangular clip path cannot be expressed as a scissor rectangle.
         // Emulate it by leaving the path current so the next fill draws it, and
@@ -543,9 +658,15 @@ namespace Babylon::Polyfills::Internal
         const auto width = info[2].As<Napi::Number>().FloatValue();
         const auto height = info[3].As<Napi::Number>().FloatValue();
 
+        StrokeRectCore(info.Env(), left, top, width, height);
+    }
+
+    void Context::StrokeRectCore(Napi::Env env, float left, float top, float width, float height)
+    {
         nvgRect(*m_nvg, left, top, width, height);
-        BindStrokeStyle(info);
+        BindStrokeStyle(env);
         SetFilterStack();
+        BindShadow(env);
         nvgStroke(*m_nvg);
     }
 
@@ -633,11 +754,19 @@ namespace Babylon::Polyfills::Internal
         if (path != nullptr)
         {
             PlayPath2D(path);
+            StrokeCore(info.Env(), path->GetTessCache());
+            return;
         }
 
-        BindStrokeStyle(info);
+        StrokeCore(info.Env());
+    }
+
+    void Context::StrokeCore(Napi::Env env, NVGtessCache* tessCache)
+    {
+        BindStrokeStyle(env);
         SetFilterStack();
-        nvgStroke(*m_nvg);
+        BindShadow(env);
+        nvgStrokeCached(*m_nvg, tessCache);
     }
 
     void Context::MoveTo(const Napi::CallbackInfo& info)
@@ -645,6 +774,11 @@ namespace Babylon::Polyfills::Internal
         const auto x = info[0].As<Napi::Number>().FloatValue();
         const auto y = info[1].As<Napi::Number>().FloatValue();
 
+        MoveToCore(x, y);
+    }
+
+    void Context::MoveToCore(float x, float y)
+    {
         m_pathHasNonRect = true;
         nvgMoveTo(*m_nvg, x, y);
     }
@@ -654,6 +788,11 @@ namespace Babylon::Polyfills::Internal
         const auto x = info[0].As<Napi::Number>().FloatValue();
         const auto y = info[1].As<Napi::Number>().FloatValue();
 
+        LineToCore(x, y);
+    }
+
+    void Context::LineToCore(float x, float y)
+    {
         m_pathHasNonRect = true;
         nvgLineTo(*m_nvg, x, y);
     }
@@ -665,6 +804,11 @@ namespace Babylon::Polyfills::Internal
         const auto x = info[2].As<Napi::Number>().FloatValue();
         const auto y = info[3].As<Napi::Number>().FloatValue();
 
+        QuadraticCurveToCore(cx, cy, x, y);
+    }
+
+    void Context::QuadraticCurveToCore(float cx, float cy, float x, float y)
+    {
         m_pathHasNonRect = true;
         nvgBezierTo(*m_nvg, cx, cy, cx, cy, x, y);
     }
@@ -729,6 +873,11 @@ namespace Babylon::Polyfills::Internal
         auto x = info[1].As<Napi::Number>().FloatValue();
         auto y = info[2].As<Napi::Number>().FloatValue();
 
+        FillTextCore(info.Env(), std::move(text), x, y);
+    }
+
+    void Context::FillTextCore(Napi::Env env, std::string text, float x, float y)
+    {
         // TODO: support ligatures, etc.
         if (m_state.direction.compare("rtl") == 0) {
             std::reverse(text.begin(), text.end());
@@ -736,14 +885,9 @@ namespace Babylon::Polyfills::Internal
 
         if (SetFontFaceId())
         {
-            BindFillStyle(info);
-
-            if (m_state.filter.length())
-            {
-                nanovg_filterstack filterStack;
-                filterStack.ParseString(m_state.filter);
-                nvgFilterStack(*m_nvg, filterStack); // sets filterStack on nanovg
-            }
+            BindFillStyle(env);
+            SetFilterStack();
+            BindShadow(env);
 
             nvgText(*m_nvg, x, y, text.c_str(), nullptr);
         }
@@ -751,18 +895,217 @@ namespace Babylon::Polyfills::Internal
 
     void Context::EnsureFontsLoaded()
     {
-        // Pick up any fonts that were loaded after this Context was created.
-        for (auto& font : NativeCanvas::fontsInfos)
+        // Pick up any fonts that were loaded after this Context was created. Fonts are never
+        // unregistered, so the count tells whether there are any.
+        if (nanovg_glyphcache::GetFontCount() != m_fonts.size())
         {
-            if (m_fonts.end() == m_fonts.find(font.first))
+            for (auto& [name, id] : nanovg_glyphcache::GetFonts())
             {
-                // TODO: update nvgCreateFontMem safely when old font buffer invalidated
-                m_fonts[font.first] = nvgCreateFontMem(*m_nvg, font.first.c_str(), font.second.data(), static_cast<int>(font.second.size()), 0);
+                m_fonts[name] = id;
             }
         }
     }
 
+    void Context::SubmitCommands(const Napi::CallbackInfo& info)
+    {
+        ReplayCommands(info);
+    }
+
+    void Context::ReplayCommands(const Napi::CallbackInfo& info)
+    {
+        const auto env = info.Env();
+
+        const uint8_t* data{};
+        size_t byteLength{};
+        if (info[0].IsArrayBuffer())
+        {
+            const auto buffer = info[0].As<Napi::ArrayBuffer>();
+            data = static_cast<const uint8_t*>(buffer.Data());
+            byteLength = buffer.ByteLength();
+        }
+        else if (info[0].IsTypedArray())
+        {
+            const auto array = info[0].As<Napi::TypedArray>();
+            data = static_cast<const uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+            byteLength = array.ByteLength();
+        }
+        else
+        {
+            throw Napi::TypeError::New(env, "submitCommands expects an ArrayBuffer or a typed array in argument 1.");
+        }
+
+        const uint32_t length = info[1].As<Napi::Number>().Uint32Value();
+        if (reinterpret_cast<uintptr_t>(data) % sizeof(uint32_t) != 0 || length > byteLength / sizeof(uint32_t))
+        {
+            throw Napi::Error::New(env, "submitCommands: the command buffer must be 4-byte aligned and hold at least `length` 32-bit words.");
+        }
+
+        std::vector<std::string> strings{};
+        if (info.Length() > 2 && info[2].IsArray())
+        {
+            const auto array = info[2].As<Napi::Array>();
+            strings.reserve(array.Length());
+            for (uint32_t index = 0; index < array.Length(); ++index)
+            {
+                strings.push_back(array.Get(index).ToString().Utf8Value());
+            }
+        }
+
+        CommandStreamReader reader{gsl::make_span(reinterpret_cast<const uint32_t*>(data), length)};
+        const auto readString = [&reader, &strings]() -> const std::string& {
+            const uint32_t index = reader.ReadUint32();
+            if (index >= strings.size())
+            {
+                throw std::runtime_error{"Canvas command stream: string index " + std::to_string(index) + " is out of range."};
+            }
+            return strings[index];
+        };
+
+        try
+        {
+            while (reader.CanRead())
+            {
+                switch (reader.ReadCommand())
+                {
+                    case CanvasCommand::BeginPath:
+                        ResetPathState();
+                        break;
+                    case CanvasCommand::ClosePath:
+                        nvgClosePath(*m_nvg);
+                        break;
+                    case CanvasCommand::MoveTo:
+                    {
+                        const auto [x, y] = reader.ReadFloat32s<2>();
+                        MoveToCore(x, y);
+                        break;
+                    }
+                    case CanvasCommand::LineTo:
+                    {
+                        const auto [x, y] = reader.ReadFloat32s<2>();
+                        LineToCore(x, y);
+                        break;
+                    }
+                    case CanvasCommand::QuadraticCurveTo:
+                    {
+                        const auto [cx, cy, x, y] = reader.ReadFloat32s<4>();
+                        QuadraticCurveToCore(cx, cy, x, y);
+                        break;
+                    }
+                    case CanvasCommand::Arc:
+                    {
+                        const auto [x, y, radius, startAngle, endAngle] = reader.ReadFloat32s<5>();
+                        ArcCore(x, y, radius, startAngle, endAngle, reader.ReadUint32() != 0);
+                        break;
+                    }
+                    case CanvasCommand::Rect:
+                    {
+                        const auto [x, y, width, height] = reader.ReadFloat32s<4>();
+                        RectCore(x, y, width, height);
+                        break;
+                    }
+                    case CanvasCommand::Fill:
+                        FillCore(env);
+                        break;
+                    case CanvasCommand::Stroke:
+                        StrokeCore(env);
+                        break;
+                    case CanvasCommand::Clip:
+                        ClipCore();
+                        break;
+                    case CanvasCommand::FillRect:
+                    {
+                        const auto [x, y, width, height] = reader.ReadFloat32s<4>();
+                        FillRectCore(env, x, y, width, height);
+                        break;
+                    }
+                    case CanvasCommand::StrokeRect:
+                    {
+                        const auto [x, y, width, height] = reader.ReadFloat32s<4>();
+                        StrokeRectCore(env, x, y, width, height);
+                        break;
+                    }
+                    case CanvasCommand::ClearRect:
+                    {
+                        const auto [x, y, width, height] = reader.ReadFloat32s<4>();
+                        ClearRectCore(x, y, width, height);
+                        break;
+                    }
+                    case CanvasCommand::Save:
+                        SaveCore();
+                        break;
+                    case CanvasCommand::Restore:
+                        RestoreCore();
+                        break;
+                    case CanvasCommand::Translate:
+                    {
+                        const auto [x, y] = reader.ReadFloat32s<2>();
+                        nvgTranslate(*m_nvg, x, y);
+                        break;
+                    }
+                    case CanvasCommand::Rotate:
+                        nvgRotate(*m_nvg, reader.ReadFloat32());
+                        break;
+                    case CanvasCommand::Scale:
+                    {
+                        const auto [x, y] = reader.ReadFloat32s<2>();
+                        nvgScale(*m_nvg, x, y);
+                        break;
+                    }
+                    case CanvasCommand::SetTransform:
+                    {
+                        const auto [a, b, c, d, e, f] = reader.ReadFloat32s<6>();
+                        SetTransformCore(a, b, c, d, e, f);
+                        break;
+                    }
+                    case CanvasCommand::Transform:
+                    {
+                        const auto [a, b, c, d, e, f] = reader.ReadFloat32s<6>();
+                        nvgTransform(*m_nvg, a, b, c, d, e, f);
+                        break;
+                    }
+                    case CanvasCommand::SetFillStyle:
+                        SetFillStyleCore(env, readString());
+                        break;
+                    case CanvasCommand::SetStrokeStyle:
+                        SetStrokeStyleCore(env, readString());
+                        break;
+                    case CanvasCommand::SetLineWidth:
+                        SetLineWidthCore(reader.ReadFloat32());
+                        break;
+                    case CanvasCommand::SetGlobalAlpha:
+                        SetGlobalAlphaCore(reader.ReadFloat32());
+                        break;
+                    case CanvasCommand::FillText:
+                    {
+                        std::string text = readString();
+                        const auto [x, y] = reader.ReadFloat32s<2>();
+                        FillTextCore(env, std::move(text), x, y);
+                        break;
+                    }
+                    case CanvasCommand::Count:
+                        break;
+                }
+            }
+        }
+        catch (const std::runtime_error& exception)
+        {
+            throw Napi::Error::New(env, exception.what());
+        }
+    }
+
     void Context::Flush(const Napi::CallbackInfo& info)
+    {
+        // flush(commands, length, strings) replays a command stream first, so a frame encoded
+        // on the JavaScript side costs a single call.
+        if (info.Length() > 0)
+        {
+            ReplayCommands(info);
+        }
+
+        FlushCore(info.Env());
+    }
+
+    void Context::FlushCore(Napi::Env env)
     {
         // Pick up any fonts loaded after this Context was created (#1683).
         EnsureFontsLoaded();
@@ -778,9 +1121,10 @@ namespace Babylon::Polyfills::Internal
 
         // A canvas flush is the one stretch of a frame that acquires views without ever
         // reaching NativeEngine::GetEncoder, so no budget check runs inside it. Its cost is
-        // not bounded either: the pool recycles framebuffers but not view ids (Acquire ->
-        // Bind() drops the cached id, the draw re-acquires, Release -> Clear() acquires
-        // again), so it scales with filter-op count. That means kViewFlushMargin cannot be
+        // not bounded either: unfiltered draws share one canvas view, but the pool recycles
+        // framebuffers and not view ids (every filter pass renders into a freshly cleared
+        // pool buffer on its own view, and the final pass re-binds the canvas), so it scales
+        // with the number of filtered draw calls. That means kViewFlushMargin cannot be
         // sized to cover it, and a frame that is just under the flush threshold on entry
         // here would run past maxViews and throw "Too many views".
         //
@@ -816,38 +1160,48 @@ namespace Babylon::Polyfills::Internal
 
             Graphics::FrameBuffer& frameBuffer = m_canvas->GetFrameBuffer();
 
+            const bgfx::ViewId firstViewId = m_graphicsContext.PeekNextViewId();
+            const uint32_t viewIdGeneration = m_graphicsContext.ViewIdGeneration();
+
+            // The canvas framebuffer keeps its full-target viewport, so its view is acquired by
+            // the clear or, failing that, lazily by the first unfiltered draw. A flush that draws
+            // nothing, or starts with a filtered call (which re-binds), then costs no extra view.
             frameBuffer.Bind();
             if (needClear)
             {
                 frameBuffer.Clear(*encoder, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH | BGFX_CLEAR_STENCIL, 0, 1.f, 0);
             }
-            frameBuffer.SetViewPort(0.f, 0.f, 1.f, 1.f);
             const auto width = m_canvas->GetWidth();
             const auto height = m_canvas->GetHeight();
 
-            for (auto& buffer : m_canvas->m_frameBufferPool.GetPoolBuffers())
-            {
-                // sanity check no buffers should have been acquired yet
-                assert(buffer.isAvailable == true);
-            }
-            std::function<Babylon::Graphics::FrameBuffer*()> acquire = [this]() -> Babylon::Graphics::FrameBuffer* {
-                Babylon::Graphics::FrameBuffer *frameBuffer = this->m_canvas->m_frameBufferPool.Acquire();
-                frameBuffer->Bind();
-                return frameBuffer;
+            // sanity check no buffers should have been acquired yet
+            assert(m_canvas->m_frameBufferPool.GetStats().Acquired == 0);
+
+            // Filter passes render at the canvas size; the pool clears each buffer as it is acquired.
+            std::function<Babylon::Graphics::FrameBuffer*()> acquire = [this, encoder, width, height]() -> Babylon::Graphics::FrameBuffer* {
+                return this->m_canvas->m_frameBufferPool.Acquire(*encoder, static_cast<uint16_t>(width), static_cast<uint16_t>(height));
             };
-            std::function<void(Babylon::Graphics::FrameBuffer*)> release = [this, encoder](Babylon::Graphics::FrameBuffer* frameBuffer) -> void {
-                // clear framebuffer when released
-                frameBuffer->Clear(*encoder, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH | BGFX_CLEAR_STENCIL, 0, 1.f, 0);
+            std::function<void(Babylon::Graphics::FrameBuffer*)> release = [this](Babylon::Graphics::FrameBuffer* frameBuffer) -> void {
                 this->m_canvas->m_frameBufferPool.Release(frameBuffer);
                 frameBuffer->Unbind();
             };
 
+            m_lastFlushDrawCalls = static_cast<uint32_t>(nvgDrawCallCount(*m_nvg));
+            m_lastFlushStrokeTriangles = static_cast<uint32_t>(nvgStrokeTriCount(*m_nvg));
+            m_lastFlushFillTriangles = static_cast<uint32_t>(nvgFillTriCount(*m_nvg));
             nvgBeginFrame(*m_nvg, float(width), float(height), 1.0f);
             nvgSetFrameBufferAndEncoder(*m_nvg, frameBuffer, encoder);
             nvgSetFrameBufferPool(*m_nvg, { acquire, release });
             nvgEndFrame(*m_nvg);
             frameBuffer.Unbind();
 
+            ScheduleUploadImageRelease();
+            ScheduleGradientRowRelease();
+
+            m_lastFlushViews = m_graphicsContext.ViewIdGeneration() == viewIdGeneration
+                ? static_cast<uint32_t>(m_graphicsContext.PeekNextViewId() - firstViewId)
+                : m_graphicsContext.PeekNextViewId();
+
             // Reserve the view id for the eventual canvas->texture blit NOW, while we are
             // sequenced immediately after this canvas' draws but before the scene/backbuffer
             // render is recorded. bgfx processes blits in numeric view-id order, so the copy
@@ -857,16 +1211,188 @@ namespace Babylon::Polyfills::Internal
             // would sample the previous frame's content (a one-frame GUI latency).
             m_canvas->SetBlitViewId(m_graphicsContext.AcquireNewViewId(), m_graphicsContext.ViewIdGeneration());
 
-            for (auto& buffer : m_canvas->m_frameBufferPool.GetPoolBuffers())
+            // sanity check no unreleased buffers
+            assert(m_canvas->m_frameBufferPool.GetStats().Acquired == 0);
+            m_canvas->m_frameBufferPool.Trim();
+        }
+        catch (const std::exception& ex)
+        {
+            throw Napi::Error::New(env, ex.what());
+        }
+    }
+
+    Napi::Value Context::GetFlushStats(const Napi::CallbackInfo& info)
+    {
+        Napi::Object stats = Napi::Object::New(info.Env());
+        stats.Set("views", Napi::Value::From(info.Env(), m_lastFlushViews));
+        stats.Set("drawCalls", Napi::Value::From(info.Env(), m_lastFlushDrawCalls));
+        stats.Set("strokeTriangles", Napi::Value::From(info.Env(), m_lastFlushStrokeTriangles));
+        stats.Set("fillTriangles", Napi::Value::From(info.Env(), m_lastFlushFillTriangles));
+        return stats;
+    }
+
+    Napi::Value Context::GetFilterCacheStats(const Napi::CallbackInfo& info)
+    {
+        const auto cacheStats = nanovg_filterstack::GetCacheStats();
+        Napi::Object stats = Napi::Object::New(info.Env());
+        stats.Set("hits", Napi::Value::From(info.Env(), static_cast<double>(cacheStats.Hits)));
+        stats.Set("misses", Napi::Value::From(info.Env(), static_cast<double>(cacheStats.Misses)));
+        stats.Set("entries", Napi::Value::From(info.Env(), static_cast<uint32_t>(cacheStats.Entries)));
+        return stats;
+    }
+
+    Napi::Value Context::GetImageUploadStats(const Napi::CallbackInfo& info)
+    {
+        const auto env{info.Env()};
+        const auto acquired{std::count_if(m_uploadImages.begin(), m_uploadImages.end(), [](const UploadImage& image) { return image.Acquired; })};
+
+        Napi::Object stats = Napi::Object::New(env);
+        stats.Set("imagesCreated", Napi::Value::From(env, static_cast<double>(m_uploadImageStats.ImagesCreated)));
+        stats.Set("imagesReused", Napi::Value::From(env, static_cast<double>(m_uploadImageStats.ImagesReused)));
+        stats.Set("uploads", Napi::Value::From(env, static_cast<double>(m_uploadImageStats.Uploads)));
+        stats.Set("uploadedBytes", Napi::Value::From(env, static_cast<double>(m_uploadImageStats.UploadedBytes)));
+        stats.Set("images", Napi::Value::From(env, static_cast<uint32_t>(m_uploadImages.size())));
+        stats.Set("acquired", Napi::Value::From(env, static_cast<uint32_t>(acquired)));
+        return stats;
+    }
+
+    Napi::Value Context::GetGradientAtlasStats(const Napi::CallbackInfo& info)
+    {
+        const auto env{info.Env()};
+        const auto atlasStats{m_gradientAtlas ? m_gradientAtlas->GetStats() : GradientAtlas::Stats{}};
+
+        Napi::Object stats = Napi::Object::New(env);
+        stats.Set("pagesCreated", Napi::Value::From(env, static_cast<double>(atlasStats.PagesCreated)));
+        stats.Set("rowsUploaded", Napi::Value::From(env, static_cast<double>(atlasStats.RowsUploaded)));
+        stats.Set("deduplicated", Napi::Value::From(env, static_cast<double>(atlasStats.Deduplicated)));
+        stats.Set("pages", Napi::Value::From(env, static_cast<uint32_t>(atlasStats.Pages)));
+        stats.Set("rowsInUse", Napi::Value::From(env, static_cast<uint32_t>(atlasStats.RowsInUse)));
+        return stats;
+    }
+
+    int Context::AcquireUploadImage(uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint8_t* pixels)
+    {
+        // Prefer the most recently released image, so the least recently used ones are evicted.
+        UploadImage* uploadImage{};
+        for (auto& candidate : m_uploadImages)
+        {
+            if (!candidate.Acquired && candidate.Width == width && candidate.Height == height
+                && (uploadImage == nullptr || candidate.LastReleased > uploadImage->LastReleased))
             {
-                // sanity check no unreleased buffers
-                assert(buffer.isAvailable == true);
+                uploadImage = &candidate;
             }
         }
-        catch (const std::exception& ex)
+
+        if (uploadImage != nullptr)
         {
-            throw Napi::Error::New(info.Env(), ex.what());
+            ++m_uploadImageStats.ImagesReused;
         }
+        else
+        {
+            const int image{nvgCreateImageRGBA(*m_nvg, static_cast<int>(width), static_cast<int>(height), 0, nullptr)};
+            if (image == 0)
+            {
+                return 0;
+            }
+            uploadImage = &m_uploadImages.emplace_back(UploadImage{image, width, height});
+            ++m_uploadImageStats.ImagesCreated;
+        }
+
+        nvgUpdateImageRegion(*m_nvg, uploadImage->Image, static_cast<int>(x), static_cast<int>(y), static_cast<int>(w), static_cast<int>(h), pixels);
+        ++m_uploadImageStats.Uploads;
+        m_uploadImageStats.UploadedBytes += static_cast<uint64_t>(w) * h * 4;
+
+        uploadImage->Acquired = true;
+        uploadImage->Epoch = m_uploadImageEpoch;
+        return uploadImage->Image;
+    }
+
+    void Context::ScheduleUploadImageRelease()
+    {
+        const uint32_t epoch{m_uploadImageEpoch};
+        if (std::none_of(m_uploadImages.begin(), m_uploadImages.end(), [epoch](const UploadImage& image) { return image.Acquired && image.Epoch == epoch; }))
+        {
+            return;
+        }
+
+        // Called within the frame that renders this flush, so the render-thread continuation runs
+        // once it has.
+        ++m_uploadImageEpoch;
+        arcana::make_task(m_graphicsContext.AfterRenderScheduler(), *m_cancellationSource, []() {})
+            .then(m_runtimeScheduler, *m_cancellationSource, [this, cancellationSource{m_cancellationSource}, epoch]() {
+                ReleaseUploadImages(epoch);
+            });
+    }
+
+    void Context::ScheduleGradientRowRelease()
+    {
+        uint32_t epoch{};
+        if (!m_gradientAtlas->EndFlush(epoch))
+        {
+            return;
+        }
+
+        // As for upload images: released rows keep their ramp until this frame has rendered.
+        arcana::make_task(m_graphicsContext.AfterRenderScheduler(), *m_cancellationSource, []() {})
+            .then(m_runtimeScheduler, *m_cancellationSource, [this, cancellationSource{m_cancellationSource}, epoch]() {
+                if (m_gradientAtlas)
+                {
+                    m_gradientAtlas->ReleasePendingRows(epoch);
+                }
+            });
+    }
+
+    void Context::ReleaseUploadImages(uint32_t epoch)
+    {
+        // Idle images kept beyond this many, or this many bytes, are deleted oldest first.
+        constexpr size_t MAX_IDLE_UPLOAD_IMAGES{8};
+        constexpr uint64_t MAX_IDLE_UPLOAD_IMAGE_BYTES{32 * 1024 * 1024};
+
+        for (auto& image : m_uploadImages)
+        {
+            // Epochs wrap, so compare their distance.
+            if (image.Acquired && static_cast<int32_t>(epoch - image.Epoch) >= 0)
+            {
+                image.Acquired = false;
+                image.LastReleased = ++m_uploadImageReleases;
+            }
+        }
+
+        while (true)
+        {
+            size_t idleImages{};
+            uint64_t idleBytes{};
+            auto oldest{m_uploadImages.end()};
+            for (auto it = m_uploadImages.begin(); it != m_uploadImages.end(); ++it)
+            {
+                if (!it->Acquired)
+                {
+                    ++idleImages;
+                    idleBytes += static_cast<uint64_t>(it->Width) * it->Height * 4;
+                    if (oldest == m_uploadImages.end() || it->LastReleased < oldest->LastReleased)
+                    {
+                        oldest = it;
+                    }
+                }
+            }
+
+            if (idleImages <= MAX_IDLE_UPLOAD_IMAGES && idleBytes <= MAX_IDLE_UPLOAD_IMAGE_BYTES)
+            {
+                break;
+            }
+
+            nvgDeleteImage(*m_nvg, oldest->Image);
+            m_uploadImages.erase(oldest);
+        }
+    }
+
+    void Context::DeleteUploadImages()
+    {
+        for (const auto& image : m_uploadImages)
+        {
+            nvgDeleteImage(*m_nvg, image.Image);
+        }
+        m_uploadImages.clear();
     }
 
     void Context::PutImageData(const Napi::CallbackInfo& info)
@@ -958,17 +1484,6 @@ namespace Babylon::Polyfills::Internal
         const auto copyWidth = static_cast<uint32_t>(x1 - x0);
         const auto copyHeight = static_cast<uint32_t>(y1 - y0);
 
-        // nvgImagePattern needs a tightly packed image, so extract the dirty
-        // sub-rectangle into its own buffer.
-        std::vector<uint8_t> patch(static_cast<size_t>(copyWidth) * copyHeight * 4u);
-        for (uint32_t row = 0; row < copyHeight; ++row)
-        {
-            std::memcpy(
-                patch.data() + static_cast<size_t>(row) * copyWidth * 4u,
-                srcPixels + (static_cast<size_t>(y0 + row) * srcWidth + static_cast<size_t>(x0)) * 4u,
-                static_cast<size_t>(copyWidth) * 4u);
-        }
-
         // dx/dy are arbitrary int32s from JS, so offsetting them by the clipped origin is done in
         // int64_t and saturated back. Anything that saturates is far enough off-canvas that it
         // clips to nothing downstream regardless.
@@ -983,7 +1498,9 @@ namespace Babylon::Polyfills::Internal
         const auto destWidth = static_cast<float>(copyWidth);
         const auto destHeight = static_cast<float>(copyHeight);
 
-        const int imageIndex = nvgCreateImageRGBA(*m_nvg, static_cast<int>(copyWidth), static_cast<int>(copyHeight), 0, patch.data());
+        // An image the size of the whole ImageData, with only the dirty rectangle uploaded. It is
+        // sampled 1:1 at integer offsets, at texel centers, so nothing outside that region is read.
+        const int imageIndex = AcquireUploadImage(srcWidth, srcHeight, static_cast<uint32_t>(x0), static_cast<uint32_t>(y0), copyWidth, copyHeight, srcPixels);
         if (imageIndex == 0)
         {
             throw Napi::Error::New(env, "Context2D.putImageData: failed to create the source image.");
@@ -997,17 +1514,17 @@ namespace Babylon::Polyfills::Internal
         nvgReset(*m_nvg);
         nvgGlobalCompositeOperation(*m_nvg, NVG_COPY);
 
-        NVGpaint imagePaint = nvgImagePattern(*m_nvg, destX, destY, destWidth, destHeight, 0.f, imageIndex, 1.f);
+        NVGpaint imagePaint = nvgImagePattern(*m_nvg, destX - static_cast<float>(x0), destY - static_cast<float>(y0),
+            static_cast<float>(srcWidth), static_cast<float>(srcHeight), 0.f, imageIndex, 1.f);
         ResetPathState();
         nvgRect(*m_nvg, destX, destY, destWidth, destHeight);
         nvgFillPaint(*m_nvg, imagePaint);
         nvgFill(*m_nvg);
 
         nvgRestore(*m_nvg);
-        nvgDeleteImage(*m_nvg, imageIndex);
 
         // Keep the CPU mirror that getImageData() reads from in sync.
-        BlitPixelsToCpu(patch.data(), copyWidth, copyHeight, 0, 0, copyWidth, copyHeight,
+        BlitPixelsToCpu(srcPixels, srcWidth, srcHeight, static_cast<int32_t>(x0), static_cast<int32_t>(y0), copyWidth, copyHeight,
             destLeft, destTop, copyWidth, copyHeight);
     }
 
@@ -1018,9 +1535,14 @@ namespace Babylon::Polyfills::Internal
         const auto radius = static_cast<float>(info[2].As<Napi::Number>().DoubleValue());
         const auto startAngle = static_cast<float>(info[3].As<Napi::Number>().DoubleValue());
         const auto endAngle = static_cast<float>(info[4].As<Napi::Number>().DoubleValue());
-        const NVGwinding winding = (info.Length() == 6 && info[5].As<Napi::Boolean>()) ? NVGwinding::NVG_CCW : NVGwinding::NVG_CW;
+        const bool counterclockwise = info.Length() == 6 && info[5].As<Napi::Boolean>();
+        ArcCore(x, y, radius, startAngle, endAngle, counterclockwise);
+    }
+
+    void Context::ArcCore(float x, float y, float radius, float startAngle, float endAngle, bool counterclockwise)
+    {
         m_pathHasNonRect = true;
-        nvgArc(*m_nvg, x, y, radius, startAngle, endAngle, winding);
+        nvgArc(*m_nvg, x, y, radius, startAngle, endAngle, counterclockwise ? NVGwinding::NVG_CCW : NVGwinding::NVG_CW);
     }
 
     void Context::EnsureCpuBuffer()
@@ -1191,20 +1713,22 @@ namespace Babylon::Polyfills::Internal
                 throw Napi::Error::New(info.Env(), "drawImage: ImageBitmap data is smaller than width*height for its format.");
             }
 
-            const uint8_t* srcBytes = data.Data();
-            std::vector<uint8_t> rgba(static_cast<size_t>(pixelCount) * 4);
-            if (format == bimg::TextureFormat::RGBA8)
+            // RGBA8 bitmaps are uploaded straight from the caller's buffer.
+            const uint8_t* rgba = data.Data();
+            std::vector<uint8_t> converted{};
+            if (format != bimg::TextureFormat::RGBA8)
             {
-                std::memcpy(rgba.data(), srcBytes, rgba.size());
-            }
-            else if (!bimg::imageConvert(&Graphics::DeviceContext::GetDefaultAllocator(), rgba.data(), bimg::TextureFormat::RGBA8, srcBytes, format, width, height, 1))
-            {
-                throw Napi::Error::New(info.Env(), "drawImage: unsupported ImageBitmap pixel format.");
+                converted.resize(static_cast<size_t>(pixelCount) * 4);
+                if (!bimg::imageConvert(&Graphics::DeviceContext::GetDefaultAllocator(), converted.data(), bimg::TextureFormat::RGBA8, rgba, format, width, height, 1))
+                {
+                    throw Napi::Error::New(info.Env(), "drawImage: unsupported ImageBitmap pixel format.");
+                }
+                rgba = converted.data();
             }
 
-            const int imageIndex = nvgCreateImageRGBA(*m_nvg, static_cast<int>(width), static_cast<int>(height), 0, rgba.data());
-            DrawImageCommon(info, imageIndex, rgba.data(), width, height);
-            nvgDeleteImage(*m_nvg, imageIndex);
+            // With a color filter, DrawImageCommon uploads the filtered copy instead.
+            const int imageIndex = m_state.filterStack.HasColorMatrix() ? -1 : AcquireUploadImage(width, height, 0, 0, width, height, rgba);
+            DrawImageCommon(info, imageIndex, rgba, width, height);
             return;
 #else
             throw Napi::Error::New(info.Env(), "drawImage: image loading disabled in this build.");
@@ -1213,6 +1737,14 @@ namespace Babylon::Polyfills::Internal
 
         const NativeCanvasImage* canvasImage = NativeCanvasImage::Unwrap(imageObj);
 
+#ifdef BABYLON_NATIVE_PLUGIN_NATIVEENGINE_LOAD_IMAGES
+        // An image that has not loaded yet has nothing to draw, per spec.
+        if (canvasImage->GetPixels() == nullptr)
+        {
+            return;
+        }
+#endif
+
         int imageIndex{-1};
         const auto nvgImageIter = m_nvgImageIndices.find(canvasImage);
         if (nvgImageIter == m_nvgImageIndices.end())
@@ -1231,6 +1763,18 @@ namespace Babylon::Polyfills::Internal
 
     void Context::DrawImageCommon(const Napi::CallbackInfo& info, int imageIndex, const uint8_t* srcPixels, uint32_t srcWidth, uint32_t srcHeight)
     {
+        // The color functions of the filter are applied to a copy of the pixels, uploaded for
+        // this frame. Every image that can be drawn keeps its pixels on the CPU.
+        assert(srcPixels != nullptr);
+        if (m_state.filterStack.HasColorMatrix())
+        {
+            const size_t pixelCount = static_cast<size_t>(srcWidth) * srcHeight;
+            m_filteredPixels.resize(pixelCount * 4);
+            m_state.filterStack.TransformPixels(srcPixels, m_filteredPixels.data(), pixelCount);
+            srcPixels = m_filteredPixels.data();
+            imageIndex = AcquireUploadImage(srcWidth, srcHeight, 0, 0, srcWidth, srcHeight, srcPixels);
+        }
+
         const auto imgWidth = static_cast<float>(srcWidth);
         const auto imgHeight = static_cast<float>(srcHeight);
 
@@ -1251,6 +1795,7 @@ namespace Babylon::Polyfills::Internal
             nvgRect(*m_nvg, dx, dy, imgWidth, imgHeight);
             nvgFillPaint(*m_nvg, imagePaint);
             SetFilterStack();
+            BindShadow(info.Env());
             nvgFill(*m_nvg);
 
             BlitPixelsToCpu(srcPixels, srcWidth, srcHeight, 0, 0, srcWidth, srcHeight,
@@ -1283,6 +1828,7 @@ namespace Babylon::Polyfills::Internal
             nvgRect(*m_nvg, dx, dy, dWidth, dHeight);
             nvgFillPaint(*m_nvg, imagePaint);
             SetFilterStack();
+            BindShadow(info.Env());
             nvgFill(*m_nvg);
 
             BlitPixelsToCpu(srcPixels, srcWidth, srcHeight, 0, 0, srcWidth, srcHeight,
@@ -1319,6 +1865,7 @@ namespace Babylon::Polyfills::Internal
             nvgRect(*m_nvg, dx, dy, dWidth, dHeight);
             nvgFillPaint(*m_nvg, imagePaint);
             SetFilterStack();
+            BindShadow(info.Env());
             nvgFill(*m_nvg);
 
             BlitPixelsToCpu(srcPixels, srcWidth, srcHeight, sx, sy, sWidth, sHeight,
@@ -1398,15 +1945,15 @@ namespace Babylon::Polyfills::Internal
         return ImageData::CreateInstance(info.Env(), nullptr, 0, 0, width, height);
     }
 
-    Napi::Value Context::GetImageData(const Napi::CallbackInfo& info)
+    void Context::ParseImageDataRegion(const Napi::CallbackInfo& info, const char* methodName, int32_t& sx, int32_t& sy, uint32_t& sw, uint32_t& sh)
     {
         if (info.Length() < 4)
         {
-            throw Napi::Error::New(info.Env(), "Context2D.getImageData: invalid number of parameters");
+            throw Napi::Error::New(info.Env(), std::string{methodName} + ": invalid number of parameters");
         }
 
-        auto sx = info[0].As<Napi::Number>().Int32Value();
-        auto sy = info[1].As<Napi::Number>().Int32Value();
+        sx = info[0].As<Napi::Number>().Int32Value();
+        sy = info[1].As<Napi::Number>().Int32Value();
         const auto swInt = info[2].As<Napi::Number>().Int32Value();
         const auto shInt = info[3].As<Napi::Number>().Int32Value();
 
@@ -1420,10 +1967,9 @@ namespace Babylon::Polyfills::Internal
         // rejected outright instead of being negated into itself.
         if (swInt == std::numeric_limits<int32_t>::min() || shInt == std::numeric_limits<int32_t>::min())
         {
-            throw Napi::RangeError::New(info.Env(), "Context2D.getImageData: requested region is too large.");
+            throw Napi::RangeError::New(info.Env(), std::string{methodName} + ": requested region is too large.");
         }
 
-        uint32_t sw, sh;
         if (swInt < 0)
         {
             sw = static_cast<uint32_t>(-swInt);
@@ -1448,24 +1994,82 @@ namespace Babylon::Polyfills::Internal
         // that would overflow size_t before ImageData tries to allocate them.
         if (static_cast<uint64_t>(sw) * sh > std::numeric_limits<size_t>::max() / 4)
         {
-            throw Napi::RangeError::New(info.Env(), "Context2D.getImageData: requested region is too large.");
+            throw Napi::RangeError::New(info.Env(), std::string{methodName} + ": requested region is too large.");
         }
+    }
+
+    Napi::Value Context::GetImageData(const Napi::CallbackInfo& info)
+    {
+        int32_t sx, sy;
+        uint32_t sw, sh;
+        ParseImageDataRegion(info, "Context2D.getImageData", sx, sy, sw, sh);
 
         return ImageData::CreateInstance(info.Env(), this, sx, sy, sw, sh);
     }
 
+    Napi::Value Context::GetImageDataAsync(const Napi::CallbackInfo& info)
+    {
+        const Napi::Env env{info.Env()};
+
+        int32_t sx, sy;
+        uint32_t sw, sh;
+        ParseImageDataRegion(info, "Context2D.getImageDataAsync", sx, sy, sw, sh);
+
+        const auto deferred{Napi::Promise::Deferred::New(env)};
+        const auto imageData{ImageData::CreateInstance(env, nullptr, 0, 0, sw, sh).As<Napi::Object>()};
+
+        // Held from the flush to the blit, so the read lands in the frame that draws what is
+        // pending on this context.
+        Graphics::FrameCompletionScope scope{m_graphicsContext.AcquireFrameCompletionScope()};
+        FlushCore(env);
+
+        // Only the part of the region inside the canvas is read back; the rest stays transparent
+        // black, as the ImageData was created.
+        const int64_t canvasWidth{m_canvas->GetWidth()};
+        const int64_t canvasHeight{m_canvas->GetHeight()};
+        const int64_t left{std::max<int64_t>(sx, 0)};
+        const int64_t top{std::max<int64_t>(sy, 0)};
+        const int64_t right{std::min<int64_t>(static_cast<int64_t>(sx) + sw, canvasWidth)};
+        const int64_t bottom{std::min<int64_t>(static_cast<int64_t>(sy) + sh, canvasHeight)};
+        if (right <= left || bottom <= top)
+        {
+            deferred.Resolve(imageData);
+            return deferred.Promise();
+        }
+
+        const auto readWidth{static_cast<uint16_t>(right - left)};
+        const auto readHeight{static_cast<uint16_t>(bottom - top)};
+        const bool originBottomLeft{bgfx::getCaps()->originBottomLeft};
+        const Graphics::TextureRegion region{0, static_cast<uint16_t>(left), static_cast<uint16_t>(originBottomLeft ? canvasHeight - bottom : top), 0, readWidth, readHeight};
+
+        // The canvas target is not BGFX_TEXTURE_READ_BACK, so the region is always blitted into
+        // a pooled readback texture first.
+        const bgfx::TextureHandle texture{bgfx::getTexture(m_canvas->GetFrameBuffer().Handle())};
+
+        m_graphicsContext.ReadTextureRegionAsync(texture, bgfx::TextureFormat::RGBA8, region, true)
+            .then(m_runtimeScheduler, *m_cancellationSource, [cancellationSource{m_cancellationSource}, imageDataRef{Napi::Persistent(imageData)}, deferred, sx, sy, sw, left, top, readWidth, readHeight, originBottomLeft](const std::shared_ptr<const std::vector<uint8_t>>& pixels) {
+                auto data{imageDataRef.Value().Get("data").As<Napi::Uint8Array>()};
+                CopyReadbackToImageData(pixels->data(), readWidth, readHeight, originBottomLeft, data.Data(), sw, static_cast<uint32_t>(left - sx), static_cast<uint32_t>(top - sy));
+                deferred.Resolve(imageDataRef.Value());
+            })
+            .then(m_runtimeScheduler, arcana::cancellation::none(), [env, deferred](const arcana::expected<void, std::exception_ptr>& result) {
+                if (result.has_error())
+                {
+                    deferred.Reject(Napi::Error::New(env, result.error()).Value());
+                }
+            });
+
+        return deferred.Promise();
+    }
+
     void Context::SetLineDash(const Napi::CallbackInfo& info)
     {
-        // An empty (or absent) dash list means "solid", which is exactly what we
-        // already draw -- so accept it silently. Babylon GUI's Line and MultiLine
-        // controls call setLineDash(this._dash) unconditionally on every render,
-        // and _dash defaults to [], so throwing here aborted any scene containing
-        // a GUI line even though nothing was actually being asked for.
+        // An empty (or absent) dash list means "solid". Babylon GUI's Line and
+        // MultiLine controls call setLineDash(this._dash) unconditionally on every
+        // render, and _dash defaults to [], so that must be accepted silently.
         //
-        // A non-empty pattern we genuinely cannot honor: nanovg has no dashed
-        // stroke, and emulating one means splitting every path into segments.
-        // Draw solid and warn once rather than failing the whole scene, and keep
-        // the list so getLineDash() round-trips as the spec requires.
+        // BindStrokeStyle hands the list to nanovg, which splits the flattened path
+        // into dashes when stroking.
         //
         // Parsed into a temporary and committed only once every segment
         // validates, because the spec keeps the previous list when the argument
@@ -1505,17 +2109,18 @@ namespace Babylon::Polyfills::Internal
             }
         }
 
-        m_state.lineDash = std::move(parsed);
-
-        if (!m_state.lineDash.empty())
+        // Per spec an odd list is repeated to make it even, and getLineDash() returns that.
+        const size_t count = parsed.size();
+        if (count % 2 == 1)
         {
-            static bool warned = false;
-            if (!warned)
+            parsed.reserve(count * 2);
+            for (size_t index = 0; index < count; ++index)
             {
-                warned = true;
-                fprintf(stderr, "Context2D.setLineDash: dashed strokes are not supported; drawing solid.\n");
+                parsed.push_back(parsed[index]);
             }
         }
+
+        m_state.lineDash = std::move(parsed);
     }
 
     Napi::Value Context::GetLineDash(const Napi::CallbackInfo& info)
@@ -1528,6 +2133,23 @@ namespace Babylon::Polyfills::Internal
         return segments;
     }
 
+    Napi::Value Context::GetLineDashOffset(const Napi::CallbackInfo& info)
+    {
+        return Napi::Number::New(info.Env(), m_state.lineDashOffset);
+    }
+
+    void Context::SetLineDashOffset(const Napi::CallbackInfo&, const Napi::Value& value)
+    {
+        // Per spec, non-finite values are ignored.
+        const double offset = value.As<Napi::Number>().DoubleValue();
+        if (!std::isfinite(offset))
+        {
+            return;
+        }
+
+        m_state.lineDashOffset = offset;
+    }
+
     void Context::StrokeText(const Napi::CallbackInfo& info)
     {
         std::string text = info[0].As<Napi::String>().Utf8Value();
@@ -1541,7 +2163,8 @@ namespace Babylon::Polyfills::Internal
 
         if (SetFontFaceId())
         {
-            BindStrokeStyle(info);
+            BindStrokeStyle(info.Env());
+            BindShadow(info.Env());
             nvgStrokeText(*m_nvg, x, y, text.c_str(), nullptr);
         }
     }
@@ -1553,7 +2176,7 @@ namespace Babylon::Polyfills::Internal
         const auto x1 = info[2].As<Napi::Number>().FloatValue();
         const auto y1 = info[3].As<Napi::Number>().FloatValue();
 
-        auto gradient = CanvasGradient::CreateLinear(info.Env(), m_nvg, x0, y0, x1, y1);
+        auto gradient = CanvasGradient::CreateLinear(info.Env(), m_nvg, m_gradientAtlas, x0, y0, x1, y1);
         return gradient;
     }
 
@@ -1612,6 +2235,11 @@ namespace Babylon::Polyfills::Internal
         const auto d = info[3].As<Napi::Number>().FloatValue();
         const auto e = info[4].As<Napi::Number>().FloatValue();
         const auto f = info[5].As<Napi::Number>().FloatValue();
+        SetTransformCore(a, b, c, d, e, f);
+    }
+
+    void Context::SetTransformCore(float a, float b, float c, float d, float e, float f)
+    {
         nvgResetTransform(*m_nvg);
         nvgTransform(*m_nvg, a, b, c, d, e, f);
     }
@@ -1671,9 +2299,11 @@ namespace Babylon::Polyfills::Internal
     {
         std::string filterString = value.As<Napi::String>().Utf8Value();
         // Keep existing filter if the new one is invalid
-        if (nanovg_filterstack::ValidString(filterString))
+        nanovg_filterstack filterStack;
+        if (filterStack.ParseString(filterString))
         {
-            m_state.filter = filterString;
+            m_state.filter = std::move(filterString);
+            m_state.filterStack = filterStack;
         }
     }
 
@@ -1760,9 +2390,13 @@ namespace Babylon::Polyfills::Internal
         return Napi::Number::New(info.Env(), m_state.globalAlpha);
     }
 
-    void Context::SetGlobalAlpha(const Napi::CallbackInfo& info, const Napi::Value& value)
+    void Context::SetGlobalAlpha(const Napi::CallbackInfo&, const Napi::Value& value)
+    {
+        SetGlobalAlphaCore(value.As<Napi::Number>().DoubleValue());
+    }
+
+    void Context::SetGlobalAlphaCore(double alpha)
     {
-        const double alpha = value.As<Napi::Number>().DoubleValue();
         // Per spec a value that is not finite, or outside [0, 1], is ignored rather than
         // clamped or thrown, and leaves the previous value in place.
         if (!std::isfinite(alpha) || alpha < 0.0 || alpha > 1.0)
@@ -1774,33 +2408,10 @@ namespace Babylon::Polyfills::Internal
         nvgGlobalAlpha(*m_nvg, m_state.globalAlpha);
     }
 
-    // nanovg has no shadow primitive, so the shadow attributes are stored and
-    // reported back but not rendered. Throwing was the wrong response: these are
-    // ordinary state attributes, and reading one, or writing the default, asks
-    // for nothing at all. Babylon GUI resets shadowBlur/shadowOffsetX/OffsetY to
-    // 0 after drawing a shadowed control, so the throw killed the scene on the
-    // *reset* path as well as the request path, and any control with a drop
-    // shadow aborted outright rather than drawing without one.
-    //
-    // Storing them keeps the spec-required round trip working and lets content
-    // that saves and restores canvas state continue to function; a shadow that
-    // is genuinely requested warns once instead of failing the scene.
-    void Context::WarnShadowUnsupported()
-    {
-        if (m_state.shadowBlur == 0.0 && m_state.shadowOffsetX == 0.0 && m_state.shadowOffsetY == 0.0)
-        {
-            // Nothing is being asked for: no offset and no blur draws no shadow.
-            return;
-        }
-
-        static bool warned = false;
-        if (!warned)
-        {
-            warned = true;
-            fprintf(stderr, "Context2D: shadows are not supported; drawing without a shadow.\n");
-        }
-    }
-
+    // The shadow attributes are bound to nanovg by BindShadow at every draw, which draws a
+    // copy of the shape offset and blurred through the filter stack before the shape itself.
+    // Babylon GUI resets shadowBlur/shadowOffsetX/OffsetY to 0 after drawing a shadowed
+    // control, so writing the defaults must stay cheap: it only updates the state.
     Napi::Value Context::GetShadowColor(const Napi::CallbackInfo& info)
     {
         return Napi::String::New(info.Env(), m_state.shadowColor);
@@ -1837,7 +2448,6 @@ namespace Babylon::Polyfills::Internal
         }
 
         m_state.shadowBlur = blur;
-        WarnShadowUnsupported();
     }
 
     Napi::Value Context::GetShadowOffsetX(const Napi::CallbackInfo& info)
@@ -1854,7 +2464,6 @@ namespace Babylon::Polyfills::Internal
         }
 
         m_state.shadowOffsetX = offset;
-        WarnShadowUnsupported();
     }
 
     Napi::Value Context::GetShadowOffsetY(const Napi::CallbackInfo& info)
@@ -1871,6 +2480,5 @@ namespace Babylon::Polyfills::Internal
         }
 
         m_state.shadowOffsetY = offset;
-        WarnShadowUnsupported();
     }
 }
@@ -6,7 +6,9 @@
 #include "Image.h"
 #include "Path2D.h"
 #include "Font.h"
+#include "GradientAtlas.h"
 #include "nanovg/nanovg_filterstack.h"
+#include "nanovg/nanovg_glyphcache.h"
 #include <variant>
 #include <vector>
 #include <cstdint>
@@ -57,9 +59,16 @@ namespace Babylon::Polyfills::Internal
         void Arc(const Napi::CallbackInfo&);
         void DrawImage(const Napi::CallbackInfo&);
         Napi::Value GetImageData(const Napi::CallbackInfo&);
+        // Reads the region back from the canvas framebuffer on the GPU, after flushing pending
+        // draws, and resolves with an ImageData once the readback completes a frame or two later.
+        Napi::Value GetImageDataAsync(const Napi::CallbackInfo&);
+        // Validates the (sx, sy, sw, sh) arguments of getImageData and normalizes negative extents.
+        static void ParseImageDataRegion(const Napi::CallbackInfo& info, const char* methodName, int32_t& sx, int32_t& sy, uint32_t& sw, uint32_t& sh);
         Napi::Value CreateImageData(const Napi::CallbackInfo&);
         void SetLineDash(const Napi::CallbackInfo&);
         Napi::Value GetLineDash(const Napi::CallbackInfo&);
+        Napi::Value GetLineDashOffset(const Napi::CallbackInfo&);
+        void SetLineDashOffset(const Napi::CallbackInfo&, const Napi::Value& value);
         void StrokeText(const Napi::CallbackInfo&);
         Napi::Value CreateLinearGradient(const Napi::CallbackInfo&);
         Napi::Value CreateRadialGradient(const Napi::CallbackInfo&);
@@ -97,15 +106,49 @@ namespace Babylon::Polyfills::Internal
         void SetShadowOffsetX(const Napi::CallbackInfo&, const Napi::Value& value);
         Napi::Value GetShadowOffsetY(const Napi::CallbackInfo&);
         void SetShadowOffsetY(const Napi::CallbackInfo&, const Napi::Value& value);
-        void WarnShadowUnsupported();
+
+        // Bodies of the methods above, shared by the JavaScript entry points and ReplayCommands.
+        void FillRectCore(Napi::Env env, float left, float top, float width, float height);
+        void StrokeRectCore(Napi::Env env, float left, float top, float width, float height);
+        void ClearRectCore(float x, float y, float width, float height);
+        void RectCore(float left, float top, float width, float height);
+        // tessCache, if any, must be the one of the Path2D just played.
+        void FillCore(Napi::Env env, NVGtessCache* tessCache = nullptr, int fillRule = 0);
+        void StrokeCore(Napi::Env env, NVGtessCache* tessCache = nullptr);
+        void ClipCore();
+        void SaveCore();
+        void RestoreCore();
+        void MoveToCore(float x, float y);
+        void LineToCore(float x, float y);
+        void QuadraticCurveToCore(float cx, float cy, float x, float y);
+        void ArcCore(float x, float y, float radius, float startAngle, float endAngle, bool counterclockwise);
+        void SetTransformCore(float a, float b, float c, float d, float e, float f);
+        void SetFillStyleCore(Napi::Env env, std::string color);
+        void SetStrokeStyleCore(Napi::Env env, std::string color);
+        void SetLineWidthCore(float width);
+        void SetGlobalAlphaCore(double alpha);
+        void FillTextCore(Napi::Env env, std::string text, float x, float y);
         void Dispose(const Napi::CallbackInfo&);
         void Dispose();
         bool SetFontFaceId();
         void EnsureFontsLoaded();
         void Flush(const Napi::CallbackInfo&);
+        void FlushCore(Napi::Env env);
+        void SubmitCommands(const Napi::CallbackInfo&);
+        // Replays the command stream (see CommandStream.h) in arguments 0 to 2: an ArrayBuffer or
+        // typed array, its length in 32-bit words, and optionally the strings it refers to.
+        void ReplayCommands(const Napi::CallbackInfo&);
+        Napi::Value GetFlushStats(const Napi::CallbackInfo&);
+        Napi::Value GetFilterCacheStats(const Napi::CallbackInfo&);
+        Napi::Value GetImageUploadStats(const Napi::CallbackInfo&);
+        Napi::Value GetGradientAtlasStats(const Napi::CallbackInfo&);
 
         NativeCanvas* m_canvas;
         std::shared_ptr<NVGcontext*> m_nvg;
+        // Fonts and glyph atlases, shared with every other context in the process.
+        std::shared_ptr<nanovg_glyphcache> m_glyphCache{nanovg_glyphcache::Get()};
+        // Color ramps of this context's linear gradients, which hold it weakly.
+        std::shared_ptr<GradientAtlas> m_gradientAtlas{std::make_shared<GradientAtlas>()};
 
         // A gradient style holds the assigned JavaScript object, not a bare CanvasGradient*.
         // CanvasGradient is an ObjectWrap, so its native instance is deleted by the wrapper's
@@ -137,18 +180,20 @@ namespace Babylon::Polyfills::Internal
             std::string lineCap{"butt"};   // 'butt', 'round', 'square'
             std::string lineJoin{"miter"}; // 'round', 'bevel', 'miter'
 
-            // Dash pattern from setLineDash. Retained only so getLineDash() round-trips;
-            // strokes are always drawn solid (nanovg has no dashed stroke).
+            // Dash pattern from setLineDash, as given so getLineDash() round-trips, and
+            // lineDashOffset. Bound to nanovg with the stroke style.
             std::vector<double> lineDash{};
+            double lineDashOffset{0.0};
 
-            // Shadow attributes from shadowColor/shadowBlur/shadowOffsetX/shadowOffsetY.
-            // Retained only so the getters round-trip; nanovg has no shadow primitive,
-            // so nothing is ever drawn from them. Defaults are the spec's.
+            // Shadow attributes from shadowColor/shadowBlur/shadowOffsetX/shadowOffsetY,
+            // bound to nanovg by BindShadow at every draw. Defaults are the spec's.
             std::string shadowColor{"rgba(0, 0, 0, 0)"};
             double shadowBlur{0.0};
             double shadowOffsetX{0.0};
             double shadowOffsetY{0.0};
             std::string filter{};
+            // `filter`, parsed.
+            nanovg_filterstack filterStack{};
             std::string direction{"ltr"}; // 'ltr', 'rtl'
             float miterLimit{10.f};
             float lineWidth{1.f};
@@ -164,7 +209,7 @@ namespace Babylon::Polyfills::Internal
         State m_state{};
         std::vector<State> m_savedStates;
 
-        // Registry of font faces loaded into nanovg, keyed by family. Not part of State:
+        // Font faces registered with the glyph cache, keyed by family. Not part of State:
         // it is a resource cache for the whole context, not an attribute save() rewinds.
         std::map<std::string, int> m_fonts;
 
@@ -184,8 +229,58 @@ namespace Babylon::Polyfills::Internal
         JsRuntimeScheduler m_runtimeScheduler;
 
         std::unordered_map<const NativeCanvasImage*, int> m_nvgImageIndices;
-        void BindFillStyle(const Napi::CallbackInfo& info);
-        void BindStrokeStyle(const Napi::CallbackInfo& info);
+
+        // bgfx views acquired by the last flush, not counting the reserved blit view, and the
+        // nanovg draw calls and stroke and fill triangles it rendered.
+        uint32_t m_lastFlushViews{};
+        uint32_t m_lastFlushDrawCalls{};
+        uint32_t m_lastFlushStrokeTriangles{};
+        uint32_t m_lastFlushFillTriangles{};
+
+        // nvg images for pixels that come from script (putImageData, drawImage of an
+        // ImageBitmap), reused by size instead of created and deleted on every call. Only the
+        // region drawn is uploaded. The texture update of an image applies to the whole bgfx
+        // frame it lands in, so an image stays acquired until the frame that drew it has
+        // rendered, and two uploads drawn in one frame use two images.
+        struct UploadImage
+        {
+            int Image{};
+            uint32_t Width{};
+            uint32_t Height{};
+            bool Acquired{};
+            // Flush epoch (see m_uploadImageEpoch) the image was last acquired in.
+            uint32_t Epoch{};
+            // Order in which idle images were released, oldest first evicted.
+            uint64_t LastReleased{};
+        };
+
+        struct UploadImageStats
+        {
+            uint64_t ImagesCreated{};
+            uint64_t ImagesReused{};
+            uint64_t Uploads{};
+            uint64_t UploadedBytes{};
+        };
+
+        std::vector<UploadImage> m_uploadImages{};
+        // Bumped by every flush that drew an upload image; the flush schedules the release of
+        // the images acquired before it, once the frame has rendered.
+        uint32_t m_uploadImageEpoch{};
+        uint64_t m_uploadImageReleases{};
+        UploadImageStats m_uploadImageStats{};
+        // Scratch for the copy of an image drawn with a color filter.
+        std::vector<uint8_t> m_filteredPixels{};
+
+        // Returns an image of this size holding `pixels` (width*height RGBA8) in the region
+        // (x, y, w, h), which is all the caller may draw from it until the next flush.
+        int AcquireUploadImage(uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint8_t* pixels);
+        void ScheduleUploadImageRelease();
+        void ScheduleGradientRowRelease();
+        void ReleaseUploadImages(uint32_t epoch);
+        void DeleteUploadImages();
+        void BindFillStyle(Napi::Env env);
+        void BindStrokeStyle(Napi::Env env);
+        void BindShadow(Napi::Env env);
         void FlushGraphicResources() override;
         void PlayPath2D(const NativeCanvasPath2D* path);
         void SetFilterStack();
@@ -1,30 +1,31 @@
 #include <array>
-#include <cstring>
-#include <vector>
+#include <cassert>
+#include <iterator>
 #include <stdexcept>
 
 #include <bgfx/bgfx.h>
 #include "FrameBufferPool.h"
 
-namespace Babylon::Polyfills
+namespace
 {
-    const std::vector<FrameBufferPool::PoolBuffer>& FrameBufferPool::GetPoolBuffers()
+    // Idle buffers not acquired during this many flushes are destroyed by Trim.
+    constexpr uint32_t MAX_IDLE_TRIMS = 120;
+
+    // RGBA8 color plus D24S8 depth/stencil.
+    constexpr size_t BYTES_PER_PIXEL = 8;
+
+    uint32_t SizeClass(uint16_t width, uint16_t height)
     {
-        return mPoolBuffers;
+        return (static_cast<uint32_t>(width) << 16) | height;
     }
+}
 
-    // sets dimension of framebuffers, can only be set if no buffers in pool
-    void FrameBufferPool::SetDimensions(int width, int height)
+namespace Babylon::Polyfills
+{
+    void FrameBufferPool::SetMemoryBudget(size_t bytes)
     {
-        assert(width > 0 && height > 0);
-        // TODO: support multiple framebuffer dimensions
-        if (mPoolBuffers.size() > 0)
-        {
-            throw std::runtime_error("Cannot set dimensions. FrameBufferPool already has buffers.");
-        }
-
-        this->m_width = width;
-        this->m_height = height;
+        m_memoryBudget = bytes;
+        EnforceBudget();
     }
 
     // sets graphics context to be used for creating framebuffers
@@ -33,104 +34,171 @@ namespace Babylon::Polyfills
         m_graphicsContext = graphicsContext;
     }
 
-    void FrameBufferPool::Add(int nBuffers)
+    FrameBufferPool::Stats FrameBufferPool::GetStats() const
+    {
+        return m_stats;
+    }
+
+    FrameBufferPool::Entry& FrameBufferPool::Create(uint16_t width, uint16_t height)
     {
         if (m_graphicsContext == nullptr)
         {
             throw std::runtime_error("Cannot add framebuffer to pool. Graphics context is not set.");
         }
 
-        for (int i = 0; i < nBuffers; ++i)
+        // No initial data: Acquire clears the buffer on the GPU before it is rendered into.
+        // TODO: make sampler flags configurable
+        // border sampling will result in transparent edge artifacts for blur, but this behaviour is consistent with browser implementation
+        std::array<bgfx::TextureHandle, 2> textures{
+            bgfx::createTexture2D(width, height, false, 1, bgfx::TextureFormat::RGBA8, BGFX_TEXTURE_RT | BGFX_SAMPLER_U_BORDER | BGFX_SAMPLER_V_BORDER | BGFX_SAMPLER_BORDER_COLOR(0)),
+            bgfx::createTexture2D(width, height, false, 1, bgfx::TextureFormat::D24S8, BGFX_TEXTURE_RT | BGFX_SAMPLER_U_BORDER | BGFX_SAMPLER_V_BORDER | BGFX_SAMPLER_BORDER_COLOR(0))};
+
+        // See NativeEngine::CreateFrameBuffer: bgfx validation now asserts when BGFX_RESOLVE_AUTO_GEN_MIPS is used
+        // with a texture whose format doesn't have BGFX_CAPS_FORMAT_TEXTURE_MIP_AUTOGEN. Gate the color attachment
+        // on the capability and pass BGFX_RESOLVE_NONE for the depth attachment (depth formats never support autogen).
+        const bgfx::Caps* caps = bgfx::getCaps();
+        const uint8_t colorResolve = 0 != (caps->formats[bgfx::TextureFormat::RGBA8] & BGFX_CAPS_FORMAT_TEXTURE_MIP_AUTOGEN)
+            ? BGFX_RESOLVE_AUTO_GEN_MIPS
+            : BGFX_RESOLVE_NONE;
+
+        std::array<bgfx::Attachment, textures.size()> attachments{};
+        attachments[0].init(textures[0], bgfx::Access::Write, 0, 1, 0, colorResolve);
+        attachments[1].init(textures[1], bgfx::Access::Write, 0, 1, 0, BGFX_RESOLVE_NONE);
+        const bgfx::FrameBufferHandle handle{bgfx::createFrameBuffer(static_cast<uint8_t>(attachments.size()), attachments.data(), true)};
+
+        if (!bgfx::isValid(handle))
         {
-            bgfx::FrameBufferHandle TextBuffer{bgfx::kInvalidHandle};
-            Graphics::FrameBuffer* FrameBuffer;
-
-            // make sure render targets are filled with 0 : https://registry.khronos.org/webgl/specs/latest/1.0/#TEXIMAGE2D
-            const bgfx::Memory* mem = bgfx::alloc(static_cast<uint32_t>(m_width) * static_cast<uint32_t>(m_height) * 4);
-            std::memset(mem->data, 0, mem->size);
-            // TODO: make sampler flags configurable
-            // border sampling will result in transparent edge artifacts for blur, but this behaviour is consistent with browser implementation
-            std::array<bgfx::TextureHandle, 2> textures{
-                bgfx::createTexture2D(m_width, m_height, false, 1, bgfx::TextureFormat::RGBA8, BGFX_TEXTURE_RT | BGFX_SAMPLER_U_BORDER | BGFX_SAMPLER_V_BORDER | BGFX_SAMPLER_BORDER_COLOR(0), mem),
-                bgfx::createTexture2D(m_width, m_height, false, 1, bgfx::TextureFormat::D24S8, BGFX_TEXTURE_RT | BGFX_SAMPLER_U_BORDER | BGFX_SAMPLER_V_BORDER | BGFX_SAMPLER_BORDER_COLOR(0))};
-
-            // See NativeEngine::CreateFrameBuffer: bgfx validation now asserts when BGFX_RESOLVE_AUTO_GEN_MIPS is used
-            // with a texture whose format doesn't have BGFX_CAPS_FORMAT_TEXTURE_MIP_AUTOGEN. Gate the color attachment
-            // on the capability and pass BGFX_RESOLVE_NONE for the depth attachment (depth formats never support autogen).
-            const bgfx::Caps* caps = bgfx::getCaps();
-            const uint8_t colorResolve = 0 != (caps->formats[bgfx::TextureFormat::RGBA8] & BGFX_CAPS_FORMAT_TEXTURE_MIP_AUTOGEN)
-                ? BGFX_RESOLVE_AUTO_GEN_MIPS
-                : BGFX_RESOLVE_NONE;
-
-            std::array<bgfx::Attachment, textures.size()> attachments{};
-            attachments[0].init(textures[0], bgfx::Access::Write, 0, 1, 0, colorResolve);
-            attachments[1].init(textures[1], bgfx::Access::Write, 0, 1, 0, BGFX_RESOLVE_NONE);
-            TextBuffer = bgfx::createFrameBuffer(static_cast<uint8_t>(attachments.size()), attachments.data(), true);
-
-            if (!bgfx::isValid(TextBuffer))
+            // Guard with isValid: a failed createTexture2D returns an invalid handle that bgfx::destroy would assert on.
+            for (auto texture : textures)
             {
-                // Guard with isValid: a failed createTexture2D returns an invalid handle that bgfx::destroy would assert on.
-                for (auto texture : textures)
+                if (bgfx::isValid(texture))
                 {
-                    if (bgfx::isValid(texture))
-                    {
-                        bgfx::destroy(texture);
-                    }
+                    bgfx::destroy(texture);
                 }
-                throw std::runtime_error{"FrameBufferPool::Add: bgfx::createFrameBuffer returned invalid handle (pool exhausted)"};
             }
+            throw std::runtime_error{"FrameBufferPool::Acquire: bgfx::createFrameBuffer returned invalid handle (pool exhausted)"};
+        }
+
+        auto frameBuffer{std::make_unique<Graphics::FrameBuffer>(*m_graphicsContext, handle, width, height, false, false, false)};
+        Graphics::FrameBuffer* key{frameBuffer.get()};
+
+        Entry& entry{m_entries[key]};
+        entry.FrameBuffer = std::move(frameBuffer);
+        entry.SizeClass = SizeClass(width, height);
+        entry.Bytes = static_cast<size_t>(width) * height * BYTES_PER_PIXEL;
 
-            FrameBuffer = new Graphics::FrameBuffer(*m_graphicsContext, TextBuffer, m_width, m_height, false, false, false);
-            m_available++;
-            mPoolBuffers.push_back({FrameBuffer, true});
+        ++m_stats.Buffers;
+        m_stats.Bytes += entry.Bytes;
+        return entry;
+    }
+
+    void FrameBufferPool::Destroy(Entry& entry)
+    {
+        assert(!entry.Acquired);
+
+        auto freeList{m_freeLists.find(entry.SizeClass)};
+        freeList->second.erase(entry.FreePosition);
+        if (freeList->second.empty())
+        {
+            m_freeLists.erase(freeList);
         }
+        m_idle.erase(entry.IdlePosition);
+
+        --m_stats.Buffers;
+        m_stats.Bytes -= entry.Bytes;
+        ++m_stats.Evictions;
+
+        entry.FrameBuffer->Dispose();
+        m_entries.erase(entry.FrameBuffer.get());
     }
 
-    void FrameBufferPool::Clear()
+    // Only idle buffers can go, so the pool may stay over budget while enough buffers are acquired.
+    void FrameBufferPool::EnforceBudget()
     {
-        for (auto& buffer : mPoolBuffers)
+        while (m_stats.Bytes > m_memoryBudget && !m_idle.empty())
         {
-            if (buffer.frameBuffer)
-            {
-                buffer.frameBuffer->Dispose();
-                delete buffer.frameBuffer;
-            }
+            Destroy(*m_idle.front());
         }
-        m_available = 0;
-        mPoolBuffers.clear();
     }
 
-    Graphics::FrameBuffer* FrameBufferPool::Acquire()
+    void FrameBufferPool::Clear()
     {
-        // no buffers in pool, add one
-        if (m_available == 0)
+        for (auto& [frameBuffer, entry] : m_entries)
         {
-            Add(1);
+            entry.FrameBuffer->Dispose();
         }
+        m_entries.clear();
+        m_freeLists.clear();
+        m_idle.clear();
 
-        for (auto& buffer : mPoolBuffers)
+        m_stats.Buffers = 0;
+        m_stats.Acquired = 0;
+        m_stats.Bytes = 0;
+    }
+
+    void FrameBufferPool::Trim()
+    {
+        ++m_trimGeneration;
+
+        for (auto it = m_idle.begin(); it != m_idle.end();)
         {
-            if (buffer.isAvailable)
+            Entry& entry{**it++};
+            if (m_trimGeneration - entry.LastAcquired > MAX_IDLE_TRIMS)
             {
-                buffer.isAvailable = false;
-                m_available--;
-                return buffer.frameBuffer;
+                Destroy(entry);
             }
         }
+    }
+
+    Graphics::FrameBuffer* FrameBufferPool::Acquire(bgfx::Encoder& encoder, uint16_t width, uint16_t height)
+    {
+        Entry* entry{};
+
+        auto freeList{m_freeLists.find(SizeClass(width, height))};
+        if (freeList != m_freeLists.end() && !freeList->second.empty())
+        {
+            entry = freeList->second.back();
+            freeList->second.pop_back();
+            m_idle.erase(entry->IdlePosition);
+            ++m_stats.Hits;
+        }
+        else
+        {
+            entry = &Create(width, height);
+            ++m_stats.Misses;
+        }
+
+        entry->Acquired = true;
+        entry->LastAcquired = m_trimGeneration;
+        ++m_stats.Acquired;
+
+        // A new buffer may have just pushed the pool over budget; make room from the idle ones.
+        EnforceBudget();
 
-        throw std::runtime_error("No available frame buffer in pool.");
+        // The buffer holds whatever its previous user drew, or undefined contents if new. The
+        // clear acquires the view that the caller's draws are then submitted to.
+        Graphics::FrameBuffer* frameBuffer{entry->FrameBuffer.get()};
+        frameBuffer->Bind();
+        frameBuffer->Clear(encoder, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH | BGFX_CLEAR_STENCIL, 0, 1.f, 0);
+        return frameBuffer;
     }
 
     void FrameBufferPool::Release(Graphics::FrameBuffer* frameBuffer)
     {
-        for (auto& buffer : mPoolBuffers)
+        const auto it{m_entries.find(frameBuffer)};
+        if (it == m_entries.end() || !it->second.Acquired)
         {
-            if (buffer.frameBuffer == frameBuffer)
-            {
-                buffer.isAvailable = true;
-                m_available++;
-                return;
-            }
+            return;
         }
+
+        Entry& entry{it->second};
+        entry.Acquired = false;
+        --m_stats.Acquired;
+
+        auto& freeList{m_freeLists[entry.SizeClass]};
+        entry.FreePosition = freeList.insert(freeList.end(), &entry);
+        entry.IdlePosition = m_idle.insert(m_idle.end(), &entry);
+
+        EnforceBudget();
     }
 }
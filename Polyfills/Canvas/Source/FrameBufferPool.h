@@ -3,31 +3,77 @@
 #include <Babylon/Graphics/DeviceContext.h>
 #include <Babylon/Graphics/FrameBuffer.h>
 
+#include <list>
+#include <memory>
+#include <unordered_map>
+
 namespace Babylon::Polyfills
 {
+    // Intermediate render targets for the nanovg filter passes, bucketed by size class. The
+    // passes sample the whole target through a screen-space quad, so a size class is an exact
+    // width and height. Each bucket keeps a free list, so Acquire and Release are O(1).
+    //
+    // Buffers are not cleared on creation or release; Acquire clears them on the GPU, on the view
+    // the caller then renders into. Idle buffers are destroyed least recently used first once the
+    // pool exceeds its memory budget, and by Trim once they have gone unused for a while.
     class FrameBufferPool final
     {
     public:
-        struct PoolBuffer
+        struct Stats
         {
-            Graphics::FrameBuffer* frameBuffer;
-            bool isAvailable;
+            // Acquires served from a free list, and acquires that had to create a buffer.
+            uint64_t Hits{};
+            uint64_t Misses{};
+
+            // Idle buffers destroyed to stay within the budget or by Trim.
+            uint64_t Evictions{};
+
+            // Buffers alive (acquired or idle), how many are acquired, and the GPU memory they hold.
+            size_t Buffers{};
+            size_t Acquired{};
+            size_t Bytes{};
         };
-        // acquire a frame buffer from the pool, graphics context must be set
-        Graphics::FrameBuffer* Acquire();
-        void Add(int nBuffers);
-        void Clear();
+
+        // acquire a cleared frame buffer from the pool, graphics context must be set
+        Graphics::FrameBuffer* Acquire(bgfx::Encoder& encoder, uint16_t width, uint16_t height);
         void Release(Graphics::FrameBuffer* frameBuffer);
-        void SetDimensions(int width, int height);
+        void Clear();
+
+        // Destroys idle buffers that have not been acquired in the last MAX_IDLE_TRIMS calls.
+        // Called once per canvas flush.
+        void Trim();
+
+        void SetMemoryBudget(size_t bytes);
         // sets graphics context to be used for creating framebuffers
-        void SetGraphicsContext(Graphics::DeviceContext *graphicsContext);
-        const std::vector<PoolBuffer>& GetPoolBuffers();
+        void SetGraphicsContext(Graphics::DeviceContext* graphicsContext);
+        Stats GetStats() const;
 
     private:
-        std::vector<PoolBuffer> mPoolBuffers{};
-        Graphics::DeviceContext* m_graphicsContext;
-        int m_available{0};
-        int m_width{256};
-        int m_height{256};
+        struct Entry
+        {
+            std::unique_ptr<Graphics::FrameBuffer> FrameBuffer{};
+            uint32_t SizeClass{};
+            size_t Bytes{};
+            uint32_t LastAcquired{};
+            bool Acquired{};
+            std::list<Entry*>::iterator FreePosition{};
+            std::list<Entry*>::iterator IdlePosition{};
+        };
+
+        Entry& Create(uint16_t width, uint16_t height);
+        void Destroy(Entry& entry);
+        void EnforceBudget();
+
+        Graphics::DeviceContext* m_graphicsContext{};
+
+        std::unordered_map<Graphics::FrameBuffer*, Entry> m_entries{};
+        std::unordered_map<uint32_t, std::list<Entry*>> m_freeLists{};
+
+        // Every idle buffer across all size classes, least recently released first.
+        std::list<Entry*> m_idle{};
+
+        size_t m_memoryBudget{64 * 1024 * 1024};
+        uint32_t m_trimGeneration{};
+        Stats m_stats{};
     };
 }
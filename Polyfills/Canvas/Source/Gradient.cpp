@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <map>
 
 #ifdef __GNUC__
@@ -21,18 +22,12 @@
 
 namespace Babylon::Polyfills::Internal
 {
-    static const int GRADIENT_SAMPLES_L = 256;
+    static const int GRADIENT_SAMPLES_L = GradientAtlas::RAMP_WIDTH;
     // The radial field is baked over the bounding box of both circles, which can be much larger
     // than the shape being filled, so it needs more samples than the 1D linear ramp to stay
     // smooth after nanovg's bilinear stretch.
     static const int GRADIENT_SAMPLES_R = 512;
 
-    typedef struct LVGColorTransform
-    {
-        float mul[4];
-        float add[4];
-    } LVGColorTransform;
-
     struct ColorStop
     {
         float offset;
@@ -92,13 +87,13 @@ namespace Babylon::Polyfills::Internal
         }
     }
 
-    NVGcolor transformColor(NVGcolor color, LVGColorTransform* x)
+    // Applies the color functions of the context's filter to a stop, so they are baked into
+    // the ramp rather than run as a pass.
+    NVGcolor transformColor(NVGcolor color, const nanovg_filterstack* x)
     {
         if (!x)
             return color;
-        color = nvgRGBAf(color.r * x->mul[0], color.g * x->mul[1], color.b * x->mul[2], color.a * x->mul[3]);
-        color = nvgRGBAf(color.r + x->add[0], color.g + x->add[1], color.b + x->add[2], color.a + x->add[3]);
-        color = nvgRGBAf(std::max(0.0f, std::min(color.r, 1.0f)), std::max(0.0f, std::min(color.g, 1.0f)), std::max(0.0f, std::min(color.b, 1.0f)), std::max(0.0f, std::min(color.a, 1.0f)));
+        x->TransformColor(color.rgba);
         return color;
     }
 
@@ -129,7 +124,7 @@ namespace Babylon::Polyfills::Internal
         return constructor.IsFunction() && value.As<Napi::Object>().InstanceOf(constructor.As<Napi::Function>());
     }
 
-    Napi::Object CanvasGradient::CreateLinear(Napi::Env env, const std::shared_ptr<NVGcontext*>& context, float x0, float y0, float x1, float y1)
+    Napi::Object CanvasGradient::CreateLinear(Napi::Env env, const std::shared_ptr<NVGcontext*>& context, const std::shared_ptr<GradientAtlas>& atlas, float x0, float y0, float x1, float y1)
     {
         // NOTE: Do not open a Napi::HandleScope here. The gradient object created below is
         // returned to the caller, and a plain (non-escapable) HandleScope would release the
@@ -137,7 +132,9 @@ namespace Babylon::Polyfills::Internal
         // object's only reference, yielding a dangling value (typeof "unknown", no prototype).
         auto func = JsRuntime::NativeObject::GetFromJavaScript(env).Get(JS_CANVAS_GRADIENT_CONSTRUCTOR_NAME).As<Napi::Function>();
         auto gradientValue = func.New({ Napi::Value::From(env, x0), Napi::Value::From(env, y0), Napi::Value::From(env, x1), Napi::Value::From(env, y1) });
-        CanvasGradient::Unwrap(gradientValue)->context = context;
+        auto gradient = CanvasGradient::Unwrap(gradientValue);
+        gradient->context = context;
+        gradient->atlas = atlas;
         return gradientValue;
     }
 
@@ -182,6 +179,15 @@ namespace Babylon::Polyfills::Internal
             }
             cachedImage = -1;
         }
+        if (atlasSlot >= 0)
+        {
+            // The atlas goes with the context; its rows need no release once it has.
+            if (auto gradientAtlas = atlas.lock())
+            {
+                gradientAtlas->Release(atlasSlot);
+            }
+            atlasSlot = -1;
+        }
     }
 
     void CanvasGradient::AddColorStop(const Napi::CallbackInfo& info)
@@ -194,12 +200,12 @@ namespace Babylon::Polyfills::Internal
         dirty = true;
     }
 
-    int CanvasGradient::LinearGradientStops(NVGcontext& nvg, LVGColorTransform* x)
+    int CanvasGradient::LinearGradientStops(NVGcontext& nvg, GradientAtlas& gradientAtlas, const nanovg_filterstack* x)
     {
         size_t nstops = colors.size();
         if (!nstops)
         {
-            return 0;
+            return -1;
         }
         // Zero-initialize: the spans below only cover the range the stops span, so any
         // sample left untouched would otherwise be read from uninitialized stack memory.
@@ -227,7 +233,7 @@ namespace Babylon::Polyfills::Internal
             NVGcolor s0 = transformColor(colorStops[nstops - 1].color, x);
             gradientSpan(data, s0, s0, colorStops[nstops - 1].offset, 1.0f);
         }
-        return nvgCreateImageRGBA(&nvg, GRADIENT_SAMPLES_L, 1, 0, (unsigned char*)data);
+        return gradientAtlas.Acquire(nvg, data);
     }
 
     NVGcolor lerpColor(NVGcolor color0, NVGcolor color1, float offset0, float offset1, float g)
@@ -243,7 +249,7 @@ namespace Babylon::Polyfills::Internal
         return unpremultiply(dst);
     }
 
-    void calcStops(const std::vector<ColorStop>& gradient, LVGColorTransform* x, NVGcolor* color0, NVGcolor* color1, float* stop0, float* stop1, float g)
+    void calcStops(const std::vector<ColorStop>& gradient, const nanovg_filterstack* x, NVGcolor* color0, NVGcolor* color1, float* stop0, float* stop1, float g)
     {
         const float* s0{};
         const float* s1{};
@@ -331,7 +337,7 @@ namespace Babylon::Polyfills::Internal
         return false;
     }
 
-    int CanvasGradient::RadialGradientStops(NVGcontext& nvg, LVGColorTransform* cxform)
+    int CanvasGradient::RadialGradientStops(NVGcontext& nvg, const nanovg_filterstack* cxform)
     {
         const size_t nstops = colors.size();
         if (!nstops)
@@ -399,38 +405,36 @@ namespace Babylon::Polyfills::Internal
         return nvgCreateImageRGBA(&nvg, width, height, 0, (unsigned char*)image.data());
     }
 
-    NVGpaint CanvasGradient::Paint()
+    NVGpaint CanvasGradient::Paint(const nanovg_filterstack* colorFilter)
     {
-        UpdateCache();
+        UpdateCache(colorFilter);
 
         auto nvg = context.lock();
-        if (!nvg || *nvg == nullptr || cachedImage < 0)
+        if (!nvg || *nvg == nullptr)
         {
-            // The owning context is gone, or the ramp could not be baked; there is nothing
-            // sensible to paint with.
+            // The owning context is gone; there is nothing sensible to paint with.
             return NVGpaint{};
         }
 
         if (gradientType == GradientType::Linear)
         {
-            // The linear ramp is baked into a GRADIENT_SAMPLES_L x 1 image, so orient the
-            // pattern along (x0,y0)->(x1,y1) and let it span exactly that distance. The
-            // vertical extent is irrelevant (the image is one texel tall and clamps), but it
-            // must be non-zero, and matching it to the length keeps u and v on the same scale
-            // -- nanovg divides the fragment position by the extent, so a small fixed height
-            // against a long gradient would cost float precision. Sampling outside the extent
-            // clamps to the edge texel, which is precisely the "pad" behavior the spec
-            // requires beyond the end stops.
-            const float dx = x1 - x0;
-            const float dy = y1 - y0;
-            float length = std::sqrt(dx * dx + dy * dy);
-            if (length < 1e-4f)
+            auto gradientAtlas = atlas.lock();
+            if (!gradientAtlas || atlasSlot < 0)
             {
-                // A zero-length gradient would divide by zero in the shader; keep it finite so
-                // the whole shape clamps to a single stop instead of rendering garbage.
-                length = 1e-4f;
+                // The ramp could not be baked.
+                return NVGpaint{};
             }
-            return nvgImagePattern(*nvg, x0, y0, length, length, std::atan2(dy, dx), cachedImage, 1.f);
+
+            // The linear ramp is baked into a row of the atlas, so stretch that row along
+            // (x0,y0)->(x1,y1). Sampling past either end clamps to the edge texel, which is
+            // precisely the "pad" behavior the spec requires beyond the end stops; a zero-length
+            // gradient clamps the whole shape to a single stop.
+            return nvgImageRowPattern(*nvg, x0, y0, x1, y1, gradientAtlas->Image(atlasSlot), GradientAtlas::Row(atlasSlot), 1.f);
+        }
+
+        if (cachedImage < 0)
+        {
+            return NVGpaint{};
         }
 
         // The radial ramp is baked over the bounding box of both circles (see
@@ -438,8 +442,16 @@ namespace Babylon::Polyfills::Internal
         return nvgImagePattern(*nvg, imageX, imageY, std::max(imageW, 1e-4f), std::max(imageH, 1e-4f), 0.f, cachedImage, 1.f);
     }
 
-    void CanvasGradient::UpdateCache()
+    void CanvasGradient::UpdateCache(const nanovg_filterstack* colorFilter)
     {
+        // The ramp is rebaked when the color functions of the filter it is drawn with change.
+        const float* colorMatrix = colorFilter ? colorFilter->ColorMatrix() : nullptr;
+        if ((colorMatrix != nullptr) != bakedColorFiltered
+            || (colorMatrix && std::memcmp(colorMatrix, bakedColorMatrix.data(), sizeof(bakedColorMatrix)) != 0))
+        {
+            dirty = true;
+        }
+
         if (!dirty)
         {
             return;
@@ -457,12 +469,34 @@ namespace Babylon::Polyfills::Internal
             return;
         }
 
-        if (cachedImage >= 0)
+        colorFilter = colorMatrix ? colorFilter : nullptr;
+        if (gradientType == GradientType::Linear)
         {
-            nvgDeleteImage(*nvg, cachedImage);
-            cachedImage = -1;
+            auto gradientAtlas = atlas.lock();
+            if (!gradientAtlas)
+            {
+                return;
+            }
+            // Acquire the new row before releasing the old one, so a ramp that did not actually
+            // change keeps its row instead of being uploaded again.
+            const int slot = LinearGradientStops(**nvg, *gradientAtlas, colorFilter);
+            gradientAtlas->Release(atlasSlot);
+            atlasSlot = slot;
+        }
+        else
+        {
+            if (cachedImage >= 0)
+            {
+                nvgDeleteImage(*nvg, cachedImage);
+                cachedImage = -1;
+            }
+            cachedImage = RadialGradientStops(**nvg, colorFilter);
+        }
+        bakedColorFiltered = colorMatrix != nullptr;
+        if (colorMatrix)
+        {
+            std::memcpy(bakedColorMatrix.data(), colorMatrix, sizeof(bakedColorMatrix));
         }
-        cachedImage = gradientType == GradientType::Linear ? LinearGradientStops(**nvg, nullptr) : RadialGradientStops(**nvg, nullptr);
         dirty = false;
     }
 }
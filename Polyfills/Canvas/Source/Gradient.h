@@ -1,19 +1,21 @@
 #pragma once
 
 #include <Babylon/Polyfills/Canvas.h>
+#include <array>
 #include <map>
 #include "nanovg/nanovg.h"
+#include "nanovg/nanovg_filterstack.h"
+#include "GradientAtlas.h"
 
 struct NVGcontext;
 
 namespace Babylon::Polyfills::Internal
 {
-    struct LVGColorTransform;
     class CanvasGradient final : public Napi::ObjectWrap<CanvasGradient>
     {
     public:
         static void Initialize(Napi::Env);
-        static Napi::Object CreateLinear(Napi::Env env, const std::shared_ptr<NVGcontext*>& context, float x0, float y0, float x1, float y1);
+        static Napi::Object CreateLinear(Napi::Env env, const std::shared_ptr<NVGcontext*>& context, const std::shared_ptr<GradientAtlas>& atlas, float x0, float y0, float x1, float y1);
         static Napi::Object CreateRadial(Napi::Env env, const std::shared_ptr<NVGcontext*>& context, float x0, float y0, float r0, float x1, float y1, float r1);
 
         // True only for objects this polyfill's own constructor produced. Unwrap() is a
@@ -25,14 +27,15 @@ namespace Babylon::Polyfills::Internal
         explicit CanvasGradient(const Napi::CallbackInfo& info);
         virtual ~CanvasGradient();
 
-        void UpdateCache();
-        int CachedImage() const { return cachedImage; }
+        // `colorFilter`, if any, is the filter of the draw: its color functions are baked into
+        // the ramp.
+        void UpdateCache(const nanovg_filterstack* colorFilter = nullptr);
 
         // Builds the nanovg paint that maps the baked color ramp onto this gradient's own
         // geometry. Callers must not derive the pattern from the shape being filled: per the
         // Canvas2D spec a gradient is positioned by the coordinates given to
         // createLinear/RadialGradient, in user space, independently of what it fills.
-        NVGpaint Paint();
+        NVGpaint Paint(const nanovg_filterstack* colorFilter = nullptr);
         void Dispose();
 
     protected:
@@ -45,7 +48,13 @@ namespace Babylon::Polyfills::Internal
         // drop the second one. Equivalent keys keep insertion order, which is the order
         // the spec resolves them in, and both consumers below just walk this in order.
         std::multimap<float, NVGcolor> colors;
+        // The baked radial field. Linear ramps are baked into a row of the context's atlas.
         int cachedImage{-1};
+        int atlasSlot{-1};
+        std::weak_ptr<GradientAtlas> atlas;
+        // The color matrix the ramp was baked with, if any.
+        std::array<float, 20> bakedColorMatrix{};
+        bool bakedColorFiltered{};
         std::weak_ptr< NVGcontext*> context;
         bool dirty{};
         enum class GradientType
@@ -57,7 +66,8 @@ namespace Babylon::Polyfills::Internal
         void AddColorStop(const Napi::CallbackInfo& info);
         // Both take the context by reference rather than re-locking `context` themselves: the
         // caller owns the lock for the whole bake, so it cannot expire midway through.
-        int LinearGradientStops(NVGcontext& nvg, LVGColorTransform* x);
-        int RadialGradientStops(NVGcontext& nvg, LVGColorTransform* cxform);
+        // Returns the atlas slot of the ramp, or -1.
+        int LinearGradientStops(NVGcontext& nvg, GradientAtlas& gradientAtlas, const nanovg_filterstack* x);
+        int RadialGradientStops(NVGcontext& nvg, const nanovg_filterstack* cxform);
     };
 }
\ No newline at end of file
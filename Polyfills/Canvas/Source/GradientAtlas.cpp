@@ -0,0 +1,203 @@
+#include "GradientAtlas.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+#include "nanovg/nanovg.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+    // FNV-1a over the samples of a ramp.
+    uint64_t HashRamp(const uint32_t* ramp)
+    {
+        uint64_t hash{14695981039346656037ull};
+        for (int i = 0; i < Babylon::Polyfills::Internal::GradientAtlas::RAMP_WIDTH; ++i)
+        {
+            hash = (hash ^ ramp[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+namespace Babylon::Polyfills::Internal
+{
+    int GradientAtlas::Acquire(NVGcontext& nvg, const uint32_t* ramp)
+    {
+        const uint64_t hash{HashRamp(ramp)};
+
+        int slot{FindRow(hash, ramp)};
+        if (slot >= 0)
+        {
+            auto& entry{m_slots[slot]};
+            if (entry.State == SlotState::Idle)
+            {
+                m_idle.erase(entry.IdlePosition);
+            }
+            if (entry.State != SlotState::InUse)
+            {
+                entry.State = SlotState::InUse;
+                ++m_stats.RowsInUse;
+            }
+            ++entry.References;
+            ++m_stats.Deduplicated;
+            return slot;
+        }
+
+        slot = AllocateRow(nvg);
+        if (slot < 0)
+        {
+            return -1;
+        }
+
+        auto& page{m_pages[slot / PAGE_ROWS]};
+        const int row{Row(slot)};
+        std::memcpy(page.Pixels.data() + static_cast<size_t>(row) * RAMP_WIDTH, ramp, RAMP_WIDTH * sizeof(uint32_t));
+        nvgUpdateImageRegion(&nvg, page.Image, 0, row, RAMP_WIDTH, 1, reinterpret_cast<const unsigned char*>(page.Pixels.data()));
+        ++m_stats.RowsUploaded;
+
+        auto& entry{m_slots[slot]};
+        entry.State = SlotState::InUse;
+        entry.References = 1;
+        entry.Hash = hash;
+        m_slotsByHash.emplace(hash, slot);
+        ++m_stats.RowsInUse;
+        return slot;
+    }
+
+    void GradientAtlas::Release(int slot)
+    {
+        if (slot < 0 || static_cast<size_t>(slot) >= m_slots.size())
+        {
+            return;
+        }
+
+        auto& entry{m_slots[slot]};
+        assert(entry.State == SlotState::InUse && entry.References > 0);
+        if (--entry.References == 0)
+        {
+            entry.State = SlotState::Pending;
+            entry.Epoch = m_epoch;
+            m_released = true;
+            --m_stats.RowsInUse;
+        }
+    }
+
+    int GradientAtlas::Image(int slot) const
+    {
+        return m_pages[slot / PAGE_ROWS].Image;
+    }
+
+    bool GradientAtlas::EndFlush(uint32_t& epoch)
+    {
+        if (!m_released)
+        {
+            return false;
+        }
+
+        epoch = m_epoch++;
+        m_released = false;
+        return true;
+    }
+
+    void GradientAtlas::ReleasePendingRows(uint32_t epoch)
+    {
+        for (size_t slot = 0; slot < m_slots.size(); ++slot)
+        {
+            auto& entry{m_slots[slot]};
+            // Epochs wrap, so compare their distance.
+            if (entry.State == SlotState::Pending && static_cast<int32_t>(epoch - entry.Epoch) >= 0)
+            {
+                entry.State = SlotState::Idle;
+                entry.IdlePosition = m_idle.insert(m_idle.end(), static_cast<int>(slot));
+            }
+        }
+    }
+
+    void GradientAtlas::DeleteImages(NVGcontext& nvg)
+    {
+        for (const auto& page : m_pages)
+        {
+            nvgDeleteImage(&nvg, page.Image);
+        }
+        m_pages.clear();
+        m_slots.clear();
+        m_slotsByHash.clear();
+        m_unused.clear();
+        m_idle.clear();
+        m_released = false;
+        m_stats.Pages = 0;
+        m_stats.RowsInUse = 0;
+    }
+
+    GradientAtlas::Stats GradientAtlas::GetStats() const
+    {
+        return m_stats;
+    }
+
+    int GradientAtlas::FindRow(uint64_t hash, const uint32_t* ramp)
+    {
+        const auto range{m_slotsByHash.equal_range(hash)};
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (std::memcmp(RowPixels(it->second), ramp, RAMP_WIDTH * sizeof(uint32_t)) == 0)
+            {
+                return it->second;
+            }
+        }
+        return -1;
+    }
+
+    int GradientAtlas::AllocateRow(NVGcontext& nvg)
+    {
+        if (m_unused.empty() && m_idle.empty())
+        {
+            const int image{nvgCreateImageRGBA(&nvg, RAMP_WIDTH, PAGE_ROWS, 0, nullptr)};
+            if (image == 0)
+            {
+                return -1;
+            }
+
+            const int firstSlot{static_cast<int>(m_slots.size())};
+            m_pages.push_back(Page{image, std::vector<uint32_t>(static_cast<size_t>(RAMP_WIDTH) * PAGE_ROWS)});
+            m_slots.resize(m_slots.size() + PAGE_ROWS);
+            for (int slot = firstSlot + PAGE_ROWS - 1; slot >= firstSlot; --slot)
+            {
+                m_unused.push_back(slot);
+            }
+            ++m_stats.PagesCreated;
+            ++m_stats.Pages;
+        }
+
+        // Unused rows first, so idle ones keep their ramp for as long as possible.
+        if (!m_unused.empty())
+        {
+            const int slot{m_unused.back()};
+            m_unused.pop_back();
+            return slot;
+        }
+
+        const int slot{m_idle.front()};
+        m_idle.pop_front();
+
+        const auto range{m_slotsByHash.equal_range(m_slots[slot].Hash)};
+        const auto it{std::find_if(range.first, range.second, [slot](const auto& entry) { return entry.second == slot; })};
+        assert(it != range.second);
+        m_slotsByHash.erase(it);
+        return slot;
+    }
+
+    const uint32_t* GradientAtlas::RowPixels(int slot) const
+    {
+        return m_pages[slot / PAGE_ROWS].Pixels.data() + static_cast<size_t>(Row(slot)) * RAMP_WIDTH;
+    }
+}
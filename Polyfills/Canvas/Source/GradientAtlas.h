@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+struct NVGcontext;
+
+namespace Babylon::Polyfills::Internal
+{
+    // The color ramps of a context's linear gradients, packed one per row into shared atlas
+    // pages instead of one tiny texture per gradient. Gradients with the same baked ramp share
+    // a row, found by a hash of its content, and only the rows that change are uploaded.
+    //
+    // A texture update applies to the whole bgfx frame it lands in, so a released row keeps its
+    // content until the frame that may have drawn it has rendered (see ReleasePendingRows); until
+    // then it can only be taken back by a gradient with the same ramp. Idle rows are reused
+    // least recently released first, once the pages have no unused rows left.
+    class GradientAtlas final
+    {
+    public:
+        // Samples in a ramp, and ramps in a page.
+        static constexpr int RAMP_WIDTH{256};
+        static constexpr int PAGE_ROWS{256};
+
+        struct Stats
+        {
+            // Pages created, each one texture.
+            uint64_t PagesCreated{};
+
+            // Rows uploaded, and acquires served by a row that already held the ramp.
+            uint64_t RowsUploaded{};
+            uint64_t Deduplicated{};
+
+            // Pages alive, and rows held by at least one gradient.
+            size_t Pages{};
+            size_t RowsInUse{};
+        };
+
+        GradientAtlas() = default;
+
+        GradientAtlas(const GradientAtlas&) = delete;
+        GradientAtlas& operator=(const GradientAtlas&) = delete;
+
+        // Returns the slot of the row holding `ramp` (RAMP_WIDTH RGBA8 samples), uploading it to a
+        // free row if no row does, or -1 if a page could not be created.
+        int Acquire(NVGcontext& nvg, const uint32_t* ramp);
+        void Release(int slot);
+
+        // The nanovg image of the page holding a slot, and its row in the page.
+        int Image(int slot) const;
+        static int Row(int slot) { return slot % PAGE_ROWS; }
+
+        // Called by every flush. Returns true, and the epoch to pass to ReleasePendingRows once the
+        // frame has rendered, if rows were released since the last flush.
+        bool EndFlush(uint32_t& epoch);
+        void ReleasePendingRows(uint32_t epoch);
+
+        void DeleteImages(NVGcontext& nvg);
+
+        Stats GetStats() const;
+
+    private:
+        enum class SlotState
+        {
+            Unused,
+            InUse,
+            // Released, but maybe drawn in a frame that has not rendered yet.
+            Pending,
+            Idle,
+        };
+
+        struct Slot
+        {
+            SlotState State{SlotState::Unused};
+            uint32_t References{};
+            uint64_t Hash{};
+            // Flush epoch the slot was released in, while Pending.
+            uint32_t Epoch{};
+            std::list<int>::iterator IdlePosition{};
+        };
+
+        struct Page
+        {
+            int Image{};
+            std::vector<uint32_t> Pixels{};
+        };
+
+        int FindRow(uint64_t hash, const uint32_t* ramp);
+        int AllocateRow(NVGcontext& nvg);
+        const uint32_t* RowPixels(int slot) const;
+
+        std::vector<Page> m_pages{};
+        std::vector<Slot> m_slots{};
+        std::unordered_multimap<uint64_t, int> m_slotsByHash{};
+
+        // Slots never written, lowest first, and idle slots, least recently released first.
+        std::vector<int> m_unused{};
+        std::list<int> m_idle{};
+
+        uint32_t m_epoch{};
+        bool m_released{};
+        Stats m_stats{};
+    };
+}
@@ -1,4 +1,6 @@
 #include <bgfx/bgfx.h>
+#include <Babylon/Polyfills/CanvasInternal.h>
+#include <algorithm>
 #include <map>
 #include <cstring>
 #include <limits>
@@ -21,6 +23,28 @@ namespace Babylon::Polyfills::Internal
 {
     static constexpr auto JS_IMAGEDATA_CONSTRUCTOR_NAME = "ImageData";
 
+    void CopyReadbackToImageData(const uint8_t* readback, uint32_t readWidth, uint32_t readHeight, bool bottomUp, uint8_t* imageData, uint32_t imageDataWidth, uint32_t x, uint32_t y)
+    {
+        const size_t stride{static_cast<size_t>(readWidth) * 4};
+        for (uint32_t row = 0; row < readHeight; ++row)
+        {
+            const uint8_t* source{readback + (bottomUp ? readHeight - 1 - row : row) * stride};
+            uint8_t* destination{imageData + ((static_cast<size_t>(y) + row) * imageDataWidth + x) * 4};
+            for (size_t index = 0; index < stride; index += 4)
+            {
+                const uint32_t alpha{source[index + 3]};
+                for (size_t channel = 0; channel < 3; ++channel)
+                {
+                    const uint32_t value{source[index + channel]};
+                    destination[index + channel] = alpha == 255 ? static_cast<uint8_t>(value)
+                        : alpha == 0                            ? 0
+                                                                : static_cast<uint8_t>(std::min<uint32_t>(255, (value * 255 + alpha / 2) / alpha));
+                }
+                destination[index + 3] = static_cast<uint8_t>(alpha);
+            }
+        }
+    }
+
     Napi::Value ImageData::CreateInstance(Napi::Env env, Context* context, int32_t sx, int32_t sy, uint32_t width, uint32_t height)
     {
         // No Napi::HandleScope here: the object created by func.New() is returned to the caller.
@@ -1,8 +1,10 @@
 #include <bgfx/bgfx.h>
+#include <atomic>
 #include <cassert>
 #include <map>
 #include "Canvas.h"
 #include "Path2D.h"
+#include "nanovg/nanovg.h"
 #include <napi/pointer.h>
 
 #ifdef __GNUC__
@@ -21,6 +23,9 @@ namespace Babylon::Polyfills::Internal
 {
     static constexpr auto JS_PATH2D_CONSTRUCTOR_NAME = "Path2D";
 
+    // Turned off to measure drawing without the tessellation cache; shared by every runtime.
+    static std::atomic<bool> s_tessCacheEnabled{true};
+
     void NativeCanvasPath2D::Initialize(Napi::Env env)
     {
         Napi::HandleScope scope{env};
@@ -40,6 +45,8 @@ namespace Babylon::Polyfills::Internal
                 InstanceMethod("ellipse", &NativeCanvasPath2D::Ellipse),
                 InstanceMethod("rect", &NativeCanvasPath2D::Rect),
                 InstanceMethod("roundRect", &NativeCanvasPath2D::RoundRect),
+                InstanceMethod("getTessellationStats", &NativeCanvasPath2D::GetTessellationStats),
+                StaticMethod("setTessellationCacheEnabled", &NativeCanvasPath2D::SetTessellationCacheEnabled),
             });
 
         JsRuntime::NativeObject::GetFromJavaScript(env).Set(JS_PATH2D_CONSTRUCTOR_NAME, func);
@@ -61,6 +68,7 @@ namespace Babylon::Polyfills::Internal
     NativeCanvasPath2D::NativeCanvasPath2D(const Napi::CallbackInfo& info)
         : Napi::ObjectWrap<NativeCanvasPath2D>{info}
         , m_commands{std::deque<Path2DCommand>()}
+        , m_tessCache{nvgCreateTessCache()}
     {
         const NativeCanvasPath2D* path = info.Length() == 1 && info[0].IsObject()
             ? NativeCanvasPath2D::Unwrap(info[0].As<Napi::Object>())
@@ -139,9 +147,37 @@ namespace Babylon::Polyfills::Internal
         return m_commands.end();
     }
 
+    NVGtessCache* NativeCanvasPath2D::GetTessCache() const
+    {
+        return s_tessCacheEnabled ? m_tessCache.get() : nullptr;
+    }
+
+    void NativeCanvasPath2D::TessCacheDeleter::operator()(NVGtessCache* cache) const
+    {
+        nvgDeleteTessCache(cache);
+    }
+
+    Napi::Value NativeCanvasPath2D::GetTessellationStats(const Napi::CallbackInfo& info)
+    {
+        int hits{}, misses{}, entries{};
+        nvgTessCacheStats(m_tessCache.get(), &hits, &misses, &entries);
+
+        auto stats = Napi::Object::New(info.Env());
+        stats.Set("hits", hits);
+        stats.Set("misses", misses);
+        stats.Set("entries", entries);
+        return stats;
+    }
+
+    void NativeCanvasPath2D::SetTessellationCacheEnabled(const Napi::CallbackInfo& info)
+    {
+        s_tessCacheEnabled = info[0].ToBoolean();
+    }
+
     void NativeCanvasPath2D::AppendCommand(Path2DCommandTypes type, Path2DCommandArgs args)
     {
         m_commands.push_back({type, args});
+        nvgResetTessCache(m_tessCache.get());
     }
 
     void NativeCanvasPath2D::AddPath(const Napi::CallbackInfo& info)
@@ -174,6 +210,7 @@ namespace Babylon::Polyfills::Internal
         {
             m_commands.push_back(command);
         }
+        nvgResetTessCache(m_tessCache.get());
 
         // invert transform after all commands played
         if (info.Length() == 2)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <queue>
+#include <memory>
 #include <Babylon/Polyfills/Canvas.h>
 #include <Babylon/JsRuntimeScheduler.h>
 
@@ -58,6 +59,8 @@ struct Path2DCommand
     Path2DCommandArgs args;
 };
 
+struct NVGtessCache;
+
 namespace Babylon::Polyfills::Internal
 {
     class NativeCanvasPath2D final : public Napi::ObjectWrap<NativeCanvasPath2D>
@@ -73,6 +76,10 @@ namespace Babylon::Polyfills::Internal
         typename std::deque<Path2DCommand>::const_iterator begin() const;
         typename std::deque<Path2DCommand>::const_iterator end() const;
 
+        // Tessellations of this path kept between draws, emptied whenever the path changes.
+        // nullptr while caching is turned off with Path2D.setTessellationCacheEnabled.
+        NVGtessCache* GetTessCache() const;
+
     private:
         void AddPath(const Napi::CallbackInfo&);
         void ClosePath(const Napi::CallbackInfo&);
@@ -86,9 +93,17 @@ namespace Babylon::Polyfills::Internal
         void Rect(const Napi::CallbackInfo&);
         void RoundRect(const Napi::CallbackInfo&);
         void RoundRectVarying(const Napi::CallbackInfo&);
+        Napi::Value GetTessellationStats(const Napi::CallbackInfo&);
+        static void SetTessellationCacheEnabled(const Napi::CallbackInfo&);
 
         void AppendCommand(Path2DCommandTypes type, Path2DCommandArgs args);
 
+        struct TessCacheDeleter
+        {
+            void operator()(NVGtessCache* cache) const;
+        };
+
         std::deque<Path2DCommand> m_commands; // use deque because iterable
+        std::unique_ptr<NVGtessCache, TessCacheDeleter> m_tessCache;
     };
 }
@@ -105,6 +105,7 @@ int fonsResetAtlas(FONScontext* stash, int width, int height);
 int fonsAddFont(FONScontext* s, const char* name, const char* path);
 int fonsAddFontMem(FONScontext* s, const char* name, unsigned char* data, int ndata, int freeData);
 int fonsGetFontByName(FONScontext* s, const char* name);
+int fonsAddFallbackFont(FONScontext* s, int base, int fallback);
 
 // State handling
 void fonsPushState(FONScontext* s);
@@ -25,6 +25,8 @@
 
 #include <bx/bx.h>
 #include "nanovg_filterstack.h"
+#include "nanovg_glyphcache.h"
+#include <vector>
 
 BX_PRAGMA_DIAGNOSTIC_IGNORED_MSVC(4701) // error C4701: potentially uninitialized local variable 'cint' used
 // -Wunused-function and 4505 must be file scope, can't be disabled between push/pop.
@@ -46,15 +48,14 @@ BX_PRAGMA_DIAGNOSTIC_POP();
 #pragma warning(disable: 4706)  // assignment within conditional expression
 #endif
 
-#define NVG_INIT_FONTIMAGE_SIZE  512
-#define NVG_MAX_FONTIMAGE_SIZE   2048
-#define NVG_MAX_FONTIMAGES       4
-
 #define NVG_INIT_COMMANDS_SIZE 256
 #define NVG_INIT_POINTS_SIZE 128
 #define NVG_INIT_PATHS_SIZE 16
 #define NVG_INIT_VERTS_SIZE 256
 #define NVG_MAX_STATES 32
+#define NVG_MAX_DASHES 64
+// Dashes generated by a single stroke before it is drawn solid instead.
+#define NVG_MAX_DASH_SEGMENTS (1 << 20)
 
 #define NVG_KAPPA90 0.5522847493f	// Length proportional to radius of a cubic bezier handle for 90deg arcs.
 
@@ -95,6 +96,13 @@ struct NVGstate {
 	float fontBlur;
 	int textAlign;
 	int fontId;
+	float dashes[NVG_MAX_DASHES];
+	int ndashes;
+	float dashOffset;
+	NVGcolor shadowColor;
+	float shadowBlur;
+	float shadowOffsetX;
+	float shadowOffsetY;
 	nanovg_filterstack m_filterStack;
 };
 typedef struct NVGstate NVGstate;
@@ -135,13 +143,18 @@ struct NVGcontext {
 	float distTol;
 	float fringeWidth;
 	float devicePxRatio;
-	struct FONScontext* fs;
-	int fontImages[NVG_MAX_FONTIMAGES];
-	int fontImageIdx;
+	nanovg_glyphcache* glyphCache;
+	// Set while draws of a glyph cache texture are recorded and not yet submitted.
+	int glyphDrawsPending;
 	int drawCallCount;
 	int fillTriCount;
 	int strokeTriCount;
 	int textTriCount;
+	// Scratch for the offset copy of the geometry drawn as a shadow.
+	NVGpath* shadowPaths;
+	int cshadowPaths;
+	NVGvertex* shadowVerts;
+	int cshadowVerts;
 };
 
 static float nvg__sqrtf(float a) { return sqrtf(a); }
@@ -298,15 +311,11 @@ static NVGstate* nvg__getState(NVGcontext* ctx)
 
 NVGcontext* nvgCreateInternal(NVGparams* params)
 {
-	FONSparams fontParams;
 	NVGcontext* ctx = (NVGcontext*)malloc(sizeof(NVGcontext));
-	int i;
 	if (ctx == NULL) goto error;
 	memset(ctx, 0, sizeof(NVGcontext));
 
 	ctx->params = *params;
-	for (i = 0; i < NVG_MAX_FONTIMAGES; i++)
-		ctx->fontImages[i] = 0;
 
 	ctx->commands = (float*)malloc(sizeof(float)*NVG_INIT_COMMANDS_SIZE);
 	if (!ctx->commands) goto error;
@@ -323,23 +332,7 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 
 	if (ctx->params.renderCreate(ctx->params.userPtr) == 0) goto error;
 
-	// Init font rendering
-	memset(&fontParams, 0, sizeof(fontParams));
-	fontParams.width = NVG_INIT_FONTIMAGE_SIZE;
-	fontParams.height = NVG_INIT_FONTIMAGE_SIZE;
-	fontParams.flags = FONS_ZERO_TOPLEFT;
-	fontParams.renderCreate = NULL;
-	fontParams.renderUpdate = NULL;
-	fontParams.renderDraw = NULL;
-	fontParams.renderDelete = NULL;
-	fontParams.userPtr = NULL;
-	ctx->fs = fonsCreateInternal(&fontParams);
-	if (ctx->fs == NULL) goto error;
-
-	// Create font texture
-	ctx->fontImages[0] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, fontParams.width, fontParams.height, 0, NULL);
-	if (ctx->fontImages[0] == 0) goto error;
-	ctx->fontImageIdx = 0;
+	// Fonts and glyph atlases live in the glyph cache, see nvgSetGlyphCache.
 
 	return ctx;
 
@@ -353,22 +346,22 @@ NVGparams* nvgInternalParams(NVGcontext* ctx)
 	return &ctx->params;
 }
 
+static void nvg__submittedGlyphDraws(NVGcontext* ctx)
+{
+	if (ctx->glyphDrawsPending) {
+		ctx->glyphCache->SubmittedDraws(ctx);
+		ctx->glyphDrawsPending = 0;
+	}
+}
+
 void nvgDeleteInternal(NVGcontext* ctx)
 {
-	int i;
 	if (ctx == NULL) return;
+	nvg__submittedGlyphDraws(ctx);
 	if (ctx->commands != NULL) free(ctx->commands);
 	if (ctx->cache != NULL) nvg__deletePathCache(ctx->cache);
-
-	if (ctx->fs)
-		fonsDeleteInternal(ctx->fs);
-
-	for (i = 0; i < NVG_MAX_FONTIMAGES; i++) {
-		if (ctx->fontImages[i] != 0) {
-			nvgDeleteImage(ctx, ctx->fontImages[i]);
-			ctx->fontImages[i] = 0;
-		}
-	}
+	if (ctx->shadowPaths != NULL) free(ctx->shadowPaths);
+	if (ctx->shadowVerts != NULL) free(ctx->shadowVerts);
 
 	if (ctx->params.renderDelete != NULL)
 		ctx->params.renderDelete(ctx->params.userPtr);
@@ -399,36 +392,28 @@ void nvgBeginFrame(NVGcontext* ctx, float windowWidth, float windowHeight, float
 void nvgCancelFrame(NVGcontext* ctx)
 {
 	ctx->params.renderCancel(ctx->params.userPtr);
+	nvg__submittedGlyphDraws(ctx);
+}
+
+int nvgDrawCallCount(NVGcontext* ctx)
+{
+	return ctx->drawCallCount;
+}
+
+int nvgStrokeTriCount(NVGcontext* ctx)
+{
+	return ctx->strokeTriCount;
+}
+
+int nvgFillTriCount(NVGcontext* ctx)
+{
+	return ctx->fillTriCount;
 }
 
 void nvgEndFrame(NVGcontext* ctx)
 {
 	ctx->params.renderFlush(ctx->params.userPtr);
-	if (ctx->fontImageIdx != 0) {
-		int fontImage = ctx->fontImages[ctx->fontImageIdx];
-		int i, j, iw, ih;
-		// delete images that smaller than current one
-		if (fontImage == 0)
-			return;
-		nvgImageSize(ctx, fontImage, &iw, &ih);
-		for (i = j = 0; i < ctx->fontImageIdx; i++) {
-			if (ctx->fontImages[i] != 0) {
-				int nw, nh;
-				nvgImageSize(ctx, ctx->fontImages[i], &nw, &nh);
-				if (nw < iw || nh < ih)
-					nvgDeleteImage(ctx, ctx->fontImages[i]);
-				else
-					ctx->fontImages[j++] = ctx->fontImages[i];
-			}
-		}
-		// make current font image to first
-		ctx->fontImages[j++] = ctx->fontImages[0];
-		ctx->fontImages[0] = fontImage;
-		ctx->fontImageIdx = 0;
-		// clear all images after j
-		for (i = j; i < NVG_MAX_FONTIMAGES; i++)
-			ctx->fontImages[i] = 0;
-	}
+	nvg__submittedGlyphDraws(ctx);
 }
 
 NVGcolor nvgRGB(unsigned char r, unsigned char g, unsigned char b)
@@ -709,6 +694,31 @@ void nvgLineJoin(NVGcontext* ctx, int join)
 	state->lineJoin = join;
 }
 
+void nvgLineDash(NVGcontext* ctx, const float* dashes, int count, float offset)
+{
+	NVGstate* state = nvg__getState(ctx);
+	int i, n = nvg__mini(count, NVG_MAX_DASHES);
+	for (i = 0; i < n; i++)
+		state->dashes[i] = nvg__maxf(dashes[i], 0.0f);
+	// An odd pattern is repeated, so that dashes and gaps alternate.
+	if (n % 2 == 1) {
+		for (i = 0; i < n && n + i < NVG_MAX_DASHES; i++)
+			state->dashes[n + i] = state->dashes[i];
+		n = nvg__mini(n * 2, NVG_MAX_DASHES) & ~1;
+	}
+	state->ndashes = n;
+	state->dashOffset = offset;
+}
+
+void nvgShadow(NVGcontext* ctx, NVGcolor color, float blur, float offsetX, float offsetY)
+{
+	NVGstate* state = nvg__getState(ctx);
+	state->shadowColor = color;
+	state->shadowBlur = nvg__maxf(blur, 0.0f);
+	state->shadowOffsetX = offsetX;
+	state->shadowOffsetY = offsetY;
+}
+
 void nvgGlobalAlpha(NVGcontext* ctx, float alpha)
 {
 	NVGstate* state = nvg__getState(ctx);
@@ -801,6 +811,12 @@ void nvgFilterStack(NVGcontext* ctx, nanovg_filterstack& filterStack)
 	state->m_filterStack = filterStack;
 }
 
+void nvgSetGlyphCache(NVGcontext* ctx, nanovg_glyphcache* glyphCache)
+{
+	nvg__submittedGlyphDraws(ctx);
+	ctx->glyphCache = glyphCache;
+}
+
 void nvgFillPaint(NVGcontext* ctx, NVGpaint paint)
 {
 	NVGstate* state = nvg__getState(ctx);
@@ -820,6 +836,11 @@ void nvgUpdateImage(NVGcontext* ctx, int image, const unsigned char* data)
 	ctx->params.renderUpdateTexture(ctx->params.userPtr, image, 0,0, w,h, data);
 }
 
+void nvgUpdateImageRegion(NVGcontext* ctx, int image, int x, int y, int w, int h, const unsigned char* data)
+{
+	ctx->params.renderUpdateTexture(ctx->params.userPtr, image, x,y, w,h, data);
+}
+
 void nvgImageSize(NVGcontext* ctx, int image, int* w, int* h)
 {
 	ctx->params.renderGetTextureSize(ctx->params.userPtr, image, w, h);
@@ -945,6 +966,27 @@ NVGpaint nvgImagePattern(NVGcontext* ctx,
 	return p;
 }
 
+NVGpaint nvgImageRowPattern(NVGcontext* ctx,
+								float sx, float sy, float ex, float ey,
+								int image, int row, float alpha)
+{
+	float dx = ex - sx;
+	float dy = ey - sy;
+	float d = sqrtf(dx*dx + dy*dy);
+	int w = 0, h = 0;
+	NVGpaint p;
+
+	// The extent across the row is irrelevant, since v is fixed by the renderer, but must not
+	// be zero; matching it to the length keeps u and v on the same scale.
+	d = nvg__maxf(d, 1e-4f);
+	p = nvgImagePattern(ctx, sx, sy, d, d, nvg__atan2f(dy, dx), image, alpha);
+
+	ctx->params.renderGetTextureSize(ctx->params.userPtr, image, &w, &h);
+	p.imageRow = ((float)row + 0.5f) / (float)nvg__maxi(h, 1);
+
+	return p;
+}
+
 // Scissoring
 void nvgScissor(NVGcontext* ctx, float x, float y, float w, float h)
 {
@@ -1310,20 +1352,69 @@ static void nvg__tesselateBezier(NVGcontext* ctx,
 	nvg__tesselateBezier(ctx, x1234,y1234, x234,y234, x34,y34, x4,y4, level+1, type);
 }
 
-static void nvg__flattenPaths(NVGcontext* ctx)
+// Closes paths whose ends meet, enforces winding, and computes the direction and length of
+// every segment and the bounds of the flattened paths.
+static void nvg__measurePaths(NVGcontext* ctx)
 {
 	NVGpathCache* cache = ctx->cache;
-//	NVGstate* state = nvg__getState(ctx);
-	NVGpoint* last;
 	NVGpoint* p0;
 	NVGpoint* p1;
 	NVGpoint* pts;
 	NVGpath* path;
 	int i, j;
+	float area;
+
+	cache->bounds[0] = cache->bounds[1] = 1e6f;
+	cache->bounds[2] = cache->bounds[3] = -1e6f;
+
+	// Calculate the direction and length of line segments.
+	for (j = 0; j < cache->npaths; j++) {
+		path = &cache->paths[j];
+		pts = &cache->points[path->first];
+
+		// If the first and last points are the same, remove the last, mark as closed path.
+		p0 = &pts[path->count-1];
+		p1 = &pts[0];
+		if (nvg__ptEquals(p0->x,p0->y, p1->x,p1->y, ctx->distTol)) {
+			path->count--;
+			p0 = &pts[path->count-1];
+			path->closed = 1;
+		}
+
+		// Enforce winding.
+		if (path->count > 2) {
+			area = nvg__polyArea(pts, path->count);
+			if (path->winding == NVG_CCW && area < 0.0f)
+				nvg__polyReverse(pts, path->count);
+			if (path->winding == NVG_CW && area > 0.0f)
+				nvg__polyReverse(pts, path->count);
+		}
+
+		for(i = 0; i < path->count; i++) {
+			// Calculate segment direction and length
+			p0->dx = p1->x - p0->x;
+			p0->dy = p1->y - p0->y;
+			p0->len = nvg__normalize(&p0->dx, &p0->dy);
+			// Update bounds
+			cache->bounds[0] = nvg__minf(cache->bounds[0], p0->x);
+			cache->bounds[1] = nvg__minf(cache->bounds[1], p0->y);
+			cache->bounds[2] = nvg__maxf(cache->bounds[2], p0->x);
+			cache->bounds[3] = nvg__maxf(cache->bounds[3], p0->y);
+			// Advance
+			p0 = p1++;
+		}
+	}
+}
+
+static void nvg__flattenPaths(NVGcontext* ctx)
+{
+	NVGpathCache* cache = ctx->cache;
+//	NVGstate* state = nvg__getState(ctx);
+	NVGpoint* last;
 	float* cp1;
 	float* cp2;
 	float* p;
-	float area;
+	int i;
 
 	if (cache->npaths > 0)
 		return;
@@ -1367,46 +1458,107 @@ static void nvg__flattenPaths(NVGcontext* ctx)
 		}
 	}
 
-	cache->bounds[0] = cache->bounds[1] = 1e6f;
-	cache->bounds[2] = cache->bounds[3] = -1e6f;
+	nvg__measurePaths(ctx);
+}
+
+// Ends the dash being built, dropping it if it has collapsed to a single point.
+static void nvg__endDash(NVGcontext* ctx)
+{
+	NVGpath* path = nvg__lastPath(ctx);
+	if (path != NULL && path->count < 2) {
+		ctx->cache->npoints = path->first;
+		ctx->cache->npaths--;
+	}
+}
+
+// Replaces the flattened paths by the open paths of their dashes. `dashes` holds an even number
+// of lengths, already scaled like the points, and the pattern restarts on every subpath.
+// Returns 0 and leaves the paths solid if the pattern is empty or would generate too many dashes.
+static int nvg__dashPaths(NVGcontext* ctx, const float* dashes, int ndashes, float offset)
+{
+	NVGpathCache* cache = ctx->cache;
+	std::vector<NVGpoint> points;
+	std::vector<NVGpath> paths;
+	float patternLength = 0.0f, pathLength = 0.0f;
+	int i, j, k;
+
+	for (i = 0; i < ndashes; i++)
+		patternLength += dashes[i];
+	if (patternLength <= 1e-6f)
+		return 0;
 
-	// Calculate the direction and length of line segments.
 	for (j = 0; j < cache->npaths; j++) {
-		path = &cache->paths[j];
-		pts = &cache->points[path->first];
+		const NVGpath* path = &cache->paths[j];
+		const NVGpoint* pts = &cache->points[path->first];
+		for (i = 0; i < path->count - (path->closed ? 0 : 1); i++)
+			pathLength += pts[i].len;
+	}
+	if (pathLength / patternLength * ndashes > NVG_MAX_DASH_SEGMENTS)
+		return 0;
 
-		// If the first and last points are the same, remove the last, mark as closed path.
-		p0 = &pts[path->count-1];
-		p1 = &pts[0];
-		if (nvg__ptEquals(p0->x,p0->y, p1->x,p1->y, ctx->distTol)) {
-			path->count--;
-			p0 = &pts[path->count-1];
-			path->closed = 1;
-		}
+	points.assign(cache->points, cache->points + cache->npoints);
+	paths.assign(cache->paths, cache->paths + cache->npaths);
+	nvg__clearPathCache(ctx);
 
-		// Enforce winding.
-		if (path->count > 2) {
-			area = nvg__polyArea(pts, path->count);
-			if (path->winding == NVG_CCW && area < 0.0f)
-				nvg__polyReverse(pts, path->count);
-			if (path->winding == NVG_CW && area > 0.0f)
-				nvg__polyReverse(pts, path->count);
+	offset = nvg__modf(offset, patternLength);
+	if (offset < 0.0f)
+		offset += patternLength;
+
+	for (j = 0; j < (int)paths.size(); j++) {
+		const NVGpath& path = paths[j];
+		const NVGpoint* pts = &points[path.first];
+		int nsegments = path.count - (path.closed ? 0 : 1);
+		float remaining;
+		int dash = 0, inDash = 0;
+
+		// Skip into the pattern by the offset.
+		remaining = dashes[0] - offset;
+		while (remaining <= 0.0f) {
+			dash = (dash + 1) % ndashes;
+			remaining += dashes[dash];
 		}
 
-		for(i = 0; i < path->count; i++) {
-			// Calculate segment direction and length
-			p0->dx = p1->x - p0->x;
-			p0->dy = p1->y - p0->y;
-			p0->len = nvg__normalize(&p0->dx, &p0->dy);
-			// Update bounds
-			cache->bounds[0] = nvg__minf(cache->bounds[0], p0->x);
-			cache->bounds[1] = nvg__minf(cache->bounds[1], p0->y);
-			cache->bounds[2] = nvg__maxf(cache->bounds[2], p0->x);
-			cache->bounds[3] = nvg__maxf(cache->bounds[3], p0->y);
-			// Advance
-			p0 = p1++;
+		for (i = 0; i < nsegments; i++) {
+			const NVGpoint* p0 = &pts[i];
+			const NVGpoint* p1 = &pts[(i + 1) % path.count];
+			float len = p0->len, t = 0.0f;
+
+			while (t < len) {
+				float step = nvg__minf(remaining, len - t);
+				// Even entries of the pattern are dashes, odd ones gaps.
+				if ((dash & 1) == 0) {
+					if (!inDash) {
+						nvg__addPath(ctx);
+						nvg__addPoint(ctx, p0->x + p0->dx * t, p0->y + p0->dy * t, NVG_PT_CORNER);
+						inDash = 1;
+					}
+					if (t + step < len)
+						nvg__addPoint(ctx, p0->x + p0->dx * (t + step), p0->y + p0->dy * (t + step), NVG_PT_CORNER);
+					else
+						nvg__addPoint(ctx, p1->x, p1->y, NVG_PT_CORNER);
+				}
+				t += step;
+				remaining -= step;
+				if (remaining <= 0.0f) {
+					if (inDash) {
+						nvg__endDash(ctx);
+						inDash = 0;
+					}
+					for (k = 0; k < ndashes && remaining <= 0.0f; k++) {
+						dash = (dash + 1) % ndashes;
+						remaining = dashes[dash];
+					}
+					if (remaining <= 0.0f)
+						break;
+				}
+			}
 		}
+		if (inDash)
+			nvg__endDash(ctx);
 	}
+
+	nvg__measurePaths(ctx);
+	return 1;
 }
 
 static int nvg__curveDivs(float r, float arc, float tol)
@@ -2216,18 +2368,137 @@ void nvgDebugDumpPathCache(NVGcontext* ctx)
 	}
 }
 
-void nvgFill(NVGcontext* ctx)
+static int nvg__hasShadow(NVGstate* state)
+{
+	return state->shadowColor.a > 0.0f &&
+		(state->shadowBlur > 0.0f || state->shadowOffsetX != 0.0f || state->shadowOffsetY != 0.0f);
+}
+
+// The filters of the draw, followed by the blur of the shadow.
+static nanovg_filterstack nvg__shadowFilterStack(NVGstate* state)
+{
+	nanovg_filterstack filterStack = state->m_filterStack;
+	if (state->shadowBlur > 0.0f)
+		filterStack.AddBlur(state->shadowBlur * 0.5f, state->shadowBlur * 0.5f);
+	return filterStack;
+}
+
+// The shadow color, faded like the paint when that is a solid color. Gradients and patterns
+// cast the shadow of their shape.
+static NVGcolor nvg__shadowColor(NVGstate* state, const NVGpaint* paint, float coverage)
+{
+	NVGcolor color = state->shadowColor;
+	if (paint->image == 0 && paint->image2 == 0 &&
+		memcmp(&paint->innerColor, &paint->outerColor, sizeof(NVGcolor)) == 0)
+		color.a *= paint->innerColor.a;
+	color.a *= coverage * state->alpha;
+	return color;
+}
+
+static NVGvertex* nvg__allocShadowVerts(NVGcontext* ctx, int nverts)
+{
+	if (nverts > ctx->cshadowVerts) {
+		NVGvertex* verts;
+		int cverts = (nverts + 0xff) & ~0xff; // Round up to prevent allocations when things change just slightly.
+		verts = (NVGvertex*)realloc(ctx->shadowVerts, sizeof(NVGvertex)*cverts);
+		if (verts == NULL) return NULL;
+		ctx->shadowVerts = verts;
+		ctx->cshadowVerts = cverts;
+	}
+	return ctx->shadowVerts;
+}
+
+static void nvg__offsetVerts(NVGvertex* dst, const NVGvertex* src, int nverts, float dx, float dy)
+{
+	int i;
+	for (i = 0; i < nverts; i++) {
+		dst[i] = src[i];
+		dst[i].x += dx;
+		dst[i].y += dy;
+	}
+}
+
+// Copies the tessellated paths moved by the shadow offset into the context's scratch arrays.
+// Returns NULL if they could not be allocated.
+static NVGpath* nvg__offsetPaths(NVGcontext* ctx, const NVGpath* paths, int npaths, float dx, float dy)
+{
+	NVGvertex* verts;
+	int i, nverts = 0;
+
+	for (i = 0; i < npaths; i++)
+		nverts += paths[i].nfill + paths[i].nstroke;
+	verts = nvg__allocShadowVerts(ctx, nverts);
+	if (verts == NULL && nverts > 0) return NULL;
+
+	if (npaths > ctx->cshadowPaths) {
+		NVGpath* shadowPaths = (NVGpath*)realloc(ctx->shadowPaths, sizeof(NVGpath)*npaths);
+		if (shadowPaths == NULL) return NULL;
+		ctx->shadowPaths = shadowPaths;
+		ctx->cshadowPaths = npaths;
+	}
+
+	for (i = 0; i < npaths; i++) {
+		NVGpath* path = &ctx->shadowPaths[i];
+		*path = paths[i];
+		if (path->nfill > 0) {
+			nvg__offsetVerts(verts, paths[i].fill, path->nfill, dx, dy);
+			path->fill = verts;
+			verts += path->nfill;
+		}
+		if (path->nstroke > 0) {
+			nvg__offsetVerts(verts, paths[i].stroke, path->nstroke, dx, dy);
+			path->stroke = verts;
+			verts += path->nstroke;
+		}
+	}
+	return ctx->shadowPaths;
+}
+
+// Draws the shadow of a fill, or of a stroke if strokeWidth > 0, before the shape itself.
+static void nvg__submitShadow(NVGcontext* ctx, const NVGpaint* paint, float coverage, float strokeWidth,
+							  const float* bounds, const NVGpath* paths, int npaths)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGpaint shadowPaint;
+	NVGpath* shadowPaths;
+	nanovg_filterstack filterStack;
+	float shadowBounds[4];
+	int i;
+
+	shadowPaths = nvg__offsetPaths(ctx, paths, npaths, state->shadowOffsetX, state->shadowOffsetY);
+	if (shadowPaths == NULL) return;
+
+	nvg__setPaintColor(&shadowPaint, nvg__shadowColor(state, paint, coverage));
+	filterStack = nvg__shadowFilterStack(state);
+
+	if (strokeWidth > 0.0f) {
+		ctx->params.renderStroke(ctx->params.userPtr, &shadowPaint, state->compositeOperation, &state->scissor, ctx->fringeWidth,
+								 strokeWidth, shadowPaths, npaths, filterStack);
+		for (i = 0; i < npaths; i++)
+			ctx->strokeTriCount += paths[i].nstroke-2;
+	} else {
+		shadowBounds[0] = bounds[0] + state->shadowOffsetX;
+		shadowBounds[1] = bounds[1] + state->shadowOffsetY;
+		shadowBounds[2] = bounds[2] + state->shadowOffsetX;
+		shadowBounds[3] = bounds[3] + state->shadowOffsetY;
+		ctx->params.renderFill(ctx->params.userPtr, &shadowPaint, state->compositeOperation, &state->scissor, ctx->fringeWidth,
+							   shadowBounds, shadowPaths, npaths, filterStack);
+		for (i = 0; i < npaths; i++) {
+			ctx->fillTriCount += paths[i].nfill-2;
+			ctx->fillTriCount += paths[i].nstroke-2;
+		}
+	}
+	ctx->drawCallCount++;
+}
+
+static void nvg__submitFill(NVGcontext* ctx, const float* bounds, const NVGpath* paths, int npaths)
 {
 	NVGstate* state = nvg__getState(ctx);
-	const NVGpath* path;
 	NVGpaint fillPaint = state->fill;
 	int i;
 
-	nvg__flattenPaths(ctx);
-	if (ctx->params.edgeAntiAlias && state->shapeAntiAlias)
-		nvg__expandFill(ctx, ctx->fringeWidth, NVG_MITER, 2.4f);
-	else
-		nvg__expandFill(ctx, 0.0f, NVG_MITER, 2.4f);
+	if (nvg__hasShadow(state))
+		nvg__submitShadow(ctx, &fillPaint, 1.0f, 0.0f, bounds, paths, npaths);
 
 	// Apply global alpha
 	fillPaint.innerColor.a *= state->alpha;
@@ -2235,81 +2506,374 @@ void nvgFill(NVGcontext* ctx)
 	fillPaint.image2 = 0;
 
 	ctx->params.renderFill(ctx->params.userPtr, &fillPaint, state->compositeOperation, &state->scissor, ctx->fringeWidth,
-						   ctx->cache->bounds, ctx->cache->paths, ctx->cache->npaths, state->m_filterStack);
+						   bounds, paths, npaths, state->m_filterStack);
 
 	// Count triangles
-	for (i = 0; i < ctx->cache->npaths; i++) {
-		path = &ctx->cache->paths[i];
-		ctx->fillTriCount += path->nfill-2;
-		ctx->fillTriCount += path->nstroke-2;
+	for (i = 0; i < npaths; i++) {
+		ctx->fillTriCount += paths[i].nfill-2;
+		ctx->fillTriCount += paths[i].nstroke-2;
 		ctx->drawCallCount += 2;
 	}
 }
 
-void nvgStroke(NVGcontext* ctx)
+// Stroke width in pixels, and the coverage its paint is scaled by when that is thinner than a pixel.
+static float nvg__getStrokeWidth(NVGcontext* ctx, float* coverage)
 {
 	NVGstate* state = nvg__getState(ctx);
 	float scale = nvg__getAverageScale(state->xform);
 	float strokeWidth = nvg__clampf(state->strokeWidth * scale, 0.0f, 200.0f);
-	NVGpaint strokePaint = state->stroke;
-	const NVGpath* path;
-	int i;
-
 
+	*coverage = 1.0f;
 	if (strokeWidth < ctx->fringeWidth) {
 		// If the stroke width is less than pixel size, use alpha to emulate coverage.
 		// Since coverage is area, scale by alpha*alpha.
 		float alpha = nvg__clampf(strokeWidth / ctx->fringeWidth, 0.0f, 1.0f);
-		strokePaint.innerColor.a *= alpha*alpha;
-		strokePaint.outerColor.a *= alpha*alpha;
+		*coverage = alpha*alpha;
 		strokeWidth = ctx->fringeWidth;
 	}
+	return strokeWidth;
+}
+
+static void nvg__submitStroke(NVGcontext* ctx, float strokeWidth, float coverage, const NVGpath* paths, int npaths)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGpaint strokePaint = state->stroke;
+	int i;
+
+	if (nvg__hasShadow(state))
+		nvg__submitShadow(ctx, &strokePaint, coverage, strokeWidth, NULL, paths, npaths);
+
+	strokePaint.innerColor.a *= coverage;
+	strokePaint.outerColor.a *= coverage;
 
 	// Apply global alpha
 	strokePaint.innerColor.a *= state->alpha;
 	strokePaint.outerColor.a *= state->alpha;
 	strokePaint.image2 = 0;
 
+	ctx->params.renderStroke(ctx->params.userPtr, &strokePaint, state->compositeOperation, &state->scissor, ctx->fringeWidth,
+							 strokeWidth, paths, npaths, state->m_filterStack);
+
+	// Count triangles
+	for (i = 0; i < npaths; i++) {
+		ctx->strokeTriCount += paths[i].nstroke-2;
+		ctx->drawCallCount++;
+	}
+}
+
+static void nvg__tessellateFill(NVGcontext* ctx)
+{
+	NVGstate* state = nvg__getState(ctx);
+
 	nvg__flattenPaths(ctx);
+	if (ctx->params.edgeAntiAlias && state->shapeAntiAlias)
+		nvg__expandFill(ctx, ctx->fringeWidth, NVG_MITER, 2.4f);
+	else
+		nvg__expandFill(ctx, 0.0f, NVG_MITER, 2.4f);
+}
+
+// Returns 1 if the flattened paths were replaced by dashes, which the caller clears once drawn
+// so that the next fill or stroke flattens the path again.
+static int nvg__tessellateStroke(NVGcontext* ctx, float strokeWidth)
+{
+	NVGstate* state = nvg__getState(ctx);
+	int dashed = 0;
 
+	nvg__flattenPaths(ctx);
+	if (state->ndashes > 0) {
+		// The points are already transformed, so the pattern is scaled like the stroke width.
+		float dashes[NVG_MAX_DASHES];
+		float scale = nvg__getAverageScale(state->xform);
+		int i;
+		for (i = 0; i < state->ndashes; i++)
+			dashes[i] = state->dashes[i] * scale;
+		dashed = nvg__dashPaths(ctx, dashes, state->ndashes, state->dashOffset * scale);
+	}
 	if (ctx->params.edgeAntiAlias && state->shapeAntiAlias)
 		nvg__expandStroke(ctx, strokeWidth*0.5f, ctx->fringeWidth, state->lineCap, state->lineJoin, state->miterLimit);
 	else
 		nvg__expandStroke(ctx, strokeWidth*0.5f, 0.0f, state->lineCap, state->lineJoin, state->miterLimit);
+	return dashed;
+}
 
-	ctx->params.renderStroke(ctx->params.userPtr, &strokePaint, state->compositeOperation, &state->scissor, ctx->fringeWidth,
-							 strokeWidth, ctx->cache->paths, ctx->cache->npaths, state->m_filterStack);
+void nvgFill(NVGcontext* ctx)
+{
+	nvg__tessellateFill(ctx);
+	nvg__submitFill(ctx, ctx->cache->bounds, ctx->cache->paths, ctx->cache->npaths);
+}
 
-	// Count triangles
-	for (i = 0; i < ctx->cache->npaths; i++) {
-		path = &ctx->cache->paths[i];
-		ctx->strokeTriCount += path->nstroke-2;
-		ctx->drawCallCount++;
+void nvgStroke(NVGcontext* ctx)
+{
+	float coverage;
+	float strokeWidth = nvg__getStrokeWidth(ctx, &coverage);
+
+	int dashed = nvg__tessellateStroke(ctx, strokeWidth);
+	nvg__submitStroke(ctx, strokeWidth, coverage, ctx->cache->paths, ctx->cache->npaths);
+	if (dashed)
+		nvg__clearPathCache(ctx);
+}
+
+// Everything the output of nvg__tessellateFill/nvg__tessellateStroke depends on, besides the path.
+struct NVGtessKey {
+	int stroke;
+	int fillRule;
+	int antiAlias;
+	int translationOnly;
+	// The transform, without its translation if translationOnly.
+	float xform[6];
+	float fringeWidth;
+	float tessTol;
+	float distTol;
+	float strokeWidth;
+	int lineCap;
+	int lineJoin;
+	float miterLimit;
+};
+typedef struct NVGtessKey NVGtessKey;
+
+struct NVGtessEntry {
+	NVGtessKey key;
+	std::vector<NVGpath> paths;
+	// Offsets of each path's fill and stroke vertices in verts.
+	std::vector<int> fillOffsets;
+	std::vector<int> strokeOffsets;
+	std::vector<NVGvertex> verts;
+	float bounds[4];
+};
+typedef struct NVGtessEntry NVGtessEntry;
+
+// Entries for general transforms only hit while the transform stays put, so an animated one
+// would keep adding entries; the oldest is replaced past this many.
+#define NVG_MAX_TESS_ENTRIES 4
+
+struct NVGtessCache {
+	std::vector<NVGtessEntry> entries;
+	int nextReplaced = 0;
+	// Paths and translated vertices handed to the renderer on a hit.
+	std::vector<NVGpath> drawPaths;
+	std::vector<NVGvertex> drawVerts;
+	int hits = 0;
+	int misses = 0;
+};
+
+NVGtessCache* nvgCreateTessCache(void)
+{
+	return new NVGtessCache();
+}
+
+void nvgDeleteTessCache(NVGtessCache* cache)
+{
+	delete cache;
+}
+
+void nvgResetTessCache(NVGtessCache* cache)
+{
+	if (cache == NULL) return;
+	cache->entries.clear();
+	cache->nextReplaced = 0;
+}
+
+void nvgTessCacheStats(NVGtessCache* cache, int* hits, int* misses, int* entries)
+{
+	if (hits) *hits = cache ? cache->hits : 0;
+	if (misses) *misses = cache ? cache->misses : 0;
+	if (entries) *entries = cache ? (int)cache->entries.size() : 0;
+}
+
+static NVGtessKey nvg__tessKey(NVGcontext* ctx, int stroke, int fillRule, float strokeWidth)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGtessKey key;
+	memset(&key, 0, sizeof(key)); // compared with memcmp
+	key.stroke = stroke;
+	key.fillRule = fillRule;
+	key.antiAlias = ctx->params.edgeAntiAlias && state->shapeAntiAlias;
+	key.translationOnly = state->xform[0] == 1.0f && state->xform[1] == 0.0f && state->xform[2] == 0.0f && state->xform[3] == 1.0f;
+	memcpy(key.xform, state->xform, sizeof(key.xform));
+	if (key.translationOnly) {
+		key.xform[4] = 0.0f;
+		key.xform[5] = 0.0f;
+	}
+	key.fringeWidth = ctx->fringeWidth;
+	key.tessTol = ctx->tessTol;
+	key.distTol = ctx->distTol;
+	if (stroke) {
+		key.strokeWidth = strokeWidth;
+		key.lineCap = state->lineCap;
+		key.lineJoin = state->lineJoin;
+		key.miterLimit = state->miterLimit;
+	}
+	return key;
+}
+
+static NVGtessEntry* nvg__findTess(NVGtessCache* cache, const NVGtessKey* key)
+{
+	for (auto& entry : cache->entries) {
+		if (memcmp(&entry.key, key, sizeof(*key)) == 0)
+			return &entry;
 	}
+	return NULL;
+}
+
+// Copies the tessellation nanovg just produced into the cache, minus the translation dx, dy.
+static NVGtessEntry* nvg__storeTess(NVGcontext* ctx, NVGtessCache* cache, const NVGtessKey* key, float dx, float dy)
+{
+	NVGpathCache* source = ctx->cache;
+	NVGtessEntry* entry;
+	int i, j;
+
+	if ((int)cache->entries.size() < NVG_MAX_TESS_ENTRIES) {
+		cache->entries.emplace_back();
+		entry = &cache->entries.back();
+	} else {
+		entry = &cache->entries[cache->nextReplaced];
+		cache->nextReplaced = (cache->nextReplaced + 1) % NVG_MAX_TESS_ENTRIES;
+	}
+
+	entry->key = *key;
+	entry->paths.assign(source->paths, source->paths + source->npaths);
+	entry->fillOffsets.resize(source->npaths);
+	entry->strokeOffsets.resize(source->npaths);
+	entry->verts.clear();
+	for (i = 0; i < source->npaths; i++) {
+		const NVGpath* path = &source->paths[i];
+		entry->fillOffsets[i] = (int)entry->verts.size();
+		for (j = 0; j < path->nfill; j++)
+			entry->verts.push_back({path->fill[j].x - dx, path->fill[j].y - dy, path->fill[j].u, path->fill[j].v});
+		entry->strokeOffsets[i] = (int)entry->verts.size();
+		for (j = 0; j < path->nstroke; j++)
+			entry->verts.push_back({path->stroke[j].x - dx, path->stroke[j].y - dy, path->stroke[j].u, path->stroke[j].v});
+	}
+	entry->bounds[0] = source->bounds[0] - dx;
+	entry->bounds[1] = source->bounds[1] - dy;
+	entry->bounds[2] = source->bounds[2] - dx;
+	entry->bounds[3] = source->bounds[3] - dy;
+	return entry;
+}
+
+// Points the cache's draw paths at the entry's vertices, offset by dx, dy, and returns them.
+static const NVGpath* nvg__placeTess(NVGtessCache* cache, const NVGtessEntry* entry, float dx, float dy, float* bounds)
+{
+	const NVGvertex* verts = entry->verts.data();
+	size_t i;
+
+	if (dx != 0.0f || dy != 0.0f) {
+		cache->drawVerts.resize(entry->verts.size());
+		for (i = 0; i < entry->verts.size(); i++) {
+			const NVGvertex& v = entry->verts[i];
+			cache->drawVerts[i] = {v.x + dx, v.y + dy, v.u, v.v};
+		}
+		verts = cache->drawVerts.data();
+	}
+
+	cache->drawPaths.assign(entry->paths.begin(), entry->paths.end());
+	for (i = 0; i < cache->drawPaths.size(); i++) {
+		// The renderer only reads the vertex arrays, which are never written through these.
+		cache->drawPaths[i].fill = (NVGvertex*)verts + entry->fillOffsets[i];
+		cache->drawPaths[i].stroke = (NVGvertex*)verts + entry->strokeOffsets[i];
+	}
+
+	bounds[0] = entry->bounds[0] + dx;
+	bounds[1] = entry->bounds[1] + dy;
+	bounds[2] = entry->bounds[2] + dx;
+	bounds[3] = entry->bounds[3] + dy;
+	return cache->drawPaths.data();
+}
+
+static const NVGpath* nvg__cachedTess(NVGcontext* ctx, NVGtessCache* cache, const NVGtessKey* key, float strokeWidth, float* bounds)
+{
+	NVGstate* state = nvg__getState(ctx);
+	float dx = key->translationOnly ? state->xform[4] : 0.0f;
+	float dy = key->translationOnly ? state->xform[5] : 0.0f;
+	NVGtessEntry* entry = nvg__findTess(cache, key);
+
+	if (entry != NULL) {
+		cache->hits++;
+	} else {
+		cache->misses++;
+		if (key->stroke)
+			nvg__tessellateStroke(ctx, strokeWidth);
+		else
+			nvg__tessellateFill(ctx);
+		entry = nvg__storeTess(ctx, cache, key, dx, dy);
+	}
+	return nvg__placeTess(cache, entry, dx, dy, bounds);
+}
+
+void nvgFillCached(NVGcontext* ctx, NVGtessCache* cache, int fillRule)
+{
+	NVGtessKey key;
+	const NVGpath* paths;
+	float bounds[4];
+
+	if (cache == NULL) {
+		nvgFill(ctx);
+		return;
+	}
+
+	key = nvg__tessKey(ctx, 0, fillRule, 0.0f);
+	paths = nvg__cachedTess(ctx, cache, &key, 0.0f, bounds);
+	nvg__submitFill(ctx, bounds, paths, (int)cache->drawPaths.size());
+}
+
+void nvgStrokeCached(NVGcontext* ctx, NVGtessCache* cache)
+{
+	NVGtessKey key;
+	const NVGpath* paths;
+	float bounds[4];
+	float coverage;
+	float strokeWidth;
+
+	// Dashed strokes are not cached, the key would have to hold the pattern and offset.
+	if (cache == NULL || nvg__getState(ctx)->ndashes > 0) {
+		nvgStroke(ctx);
+		return;
+	}
+
+	strokeWidth = nvg__getStrokeWidth(ctx, &coverage);
+	key = nvg__tessKey(ctx, 1, 0, strokeWidth);
+	paths = nvg__cachedTess(ctx, cache, &key, strokeWidth, bounds);
+	nvg__submitStroke(ctx, strokeWidth, coverage, paths, (int)cache->drawPaths.size());
 }
 
 // Add fonts
+// Fonts are registered process wide with the glyph cache, so they are available to every
+// context, including ones created later.
 int nvgCreateFont(NVGcontext* ctx, const char* name, const char* path)
 {
-	return fonsAddFont(ctx->fs, name, path);
+	FILE* fp = fopen(path, "rb");
+	if (fp == NULL) return FONS_INVALID;
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	std::vector<uint8_t> data(size > 0 ? (size_t)size : 0);
+	size_t read = fread(data.data(), 1, data.size(), fp);
+	fclose(fp);
+	if (read != data.size()) return FONS_INVALID;
+	return nvgCreateFontMem(ctx, name, data.data(), (int)data.size(), 0);
 }
 
 int nvgCreateFontMem(NVGcontext* ctx, const char* name, unsigned char* data, int ndata, int freeData)
 {
-	return fonsAddFontMem(ctx->fs, name, data, ndata, freeData);
+	NVG_NOTUSED(ctx);
+	int font = nanovg_glyphcache::AddFont(name, std::vector<uint8_t>(data, data + ndata));
+	if (freeData) free(data);
+	return font;
 }
 
 int nvgFindFont(NVGcontext* ctx, const char* name)
 {
+	NVG_NOTUSED(ctx);
 	if (name == NULL) return -1;
-	return fonsGetFontByName(ctx->fs, name);
+	return nanovg_glyphcache::FindFont(name);
 }
 
 
 int nvgAddFallbackFontId(NVGcontext* ctx, int baseFont, int fallbackFont)
 {
+	NVG_NOTUSED(ctx);
 	if(baseFont == -1 || fallbackFont == -1) return 0;
-	return fonsAddFallbackFont(ctx->fs, baseFont, fallbackFont);
+	return nanovg_glyphcache::AddFallbackFont(baseFont, fallbackFont) ? 1 : 0;
 }
 
 int nvgAddFallbackFont(NVGcontext* ctx, const char* baseFont, const char* fallbackFont)
@@ -2357,7 +2921,7 @@ void nvgFontFaceId(NVGcontext* ctx, int font)
 void nvgFontFace(NVGcontext* ctx, const char* font)
 {
 	NVGstate* state = nvg__getState(ctx);
-	state->fontId = fonsGetFontByName(ctx->fs, font);
+	state->fontId = nvgFindFont(ctx, font);
 }
 
 static float nvg__quantize(float a, float d)
@@ -2370,50 +2934,7 @@ static float nvg__getFontScale(NVGstate* state)
 	return nvg__minf(nvg__quantize(nvg__getAverageScale(state->xform), 0.01f), 4.0f);
 }
 
-static void nvg__flushTextTexture(NVGcontext* ctx)
-{
-	int dirty[4];
-
-	if (fonsValidateTexture(ctx->fs, dirty)) {
-		int fontImage = ctx->fontImages[ctx->fontImageIdx];
-		// Update texture
-		if (fontImage != 0) {
-			int iw, ih;
-			const unsigned char* data = fonsGetTextureData(ctx->fs, &iw, &ih);
-			int x = dirty[0];
-			int y = dirty[1];
-			int w = dirty[2] - dirty[0];
-			int h = dirty[3] - dirty[1];
-			ctx->params.renderUpdateTexture(ctx->params.userPtr, fontImage, x,y, w,h, data);
-		}
-	}
-}
-
-static int nvg__allocTextAtlas(NVGcontext* ctx)
-{
-	int iw, ih;
-	nvg__flushTextTexture(ctx);
-	if (ctx->fontImageIdx >= NVG_MAX_FONTIMAGES-1)
-		return 0;
-	// if next fontImage already have a texture
-	if (ctx->fontImages[ctx->fontImageIdx+1] != 0)
-		nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx+1], &iw, &ih);
-	else { // calculate the new font image size and create it.
-		nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx], &iw, &ih);
-		if (iw > ih)
-			ih *= 2;
-		else
-			iw *= 2;
-		if (iw > NVG_MAX_FONTIMAGE_SIZE || ih > NVG_MAX_FONTIMAGE_SIZE)
-			iw = ih = NVG_MAX_FONTIMAGE_SIZE;
-		ctx->fontImages[ctx->fontImageIdx+1] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, iw, ih, 0, NULL);
-	}
-	++ctx->fontImageIdx;
-	fonsResetAtlas(ctx->fs, iw, ih);
-	return 1;
-}
-
-static void nvg__renderText(NVGcontext* ctx, NVGpaint* paint, NVGvertex* verts, int nverts)
+static void nvg__renderText(NVGcontext* ctx, NVGpaint* paint, int fontImage, NVGvertex* verts, int nverts)
 {
 	NVGstate* state = nvg__getState(ctx);
 
@@ -2423,7 +2944,24 @@ static void nvg__renderText(NVGcontext* ctx, NVGpaint* paint, NVGvertex* verts,
 		// if an image (gradient) has already been bound, then use image for font image and move previous image to image2
 		paint->image2 = paint->image;
 	}
-	paint->image = ctx->fontImages[ctx->fontImageIdx];
+	paint->image = fontImage;
+
+	if (nvg__hasShadow(state)) {
+		// Glyphs keep their atlas, so the shadow takes their shape.
+		NVGpaint shadowPaint = *paint;
+		NVGvertex* shadowVerts = nvg__allocShadowVerts(ctx, nverts);
+		if (shadowVerts != NULL) {
+			nanovg_filterstack filterStack = nvg__shadowFilterStack(state);
+			shadowPaint.image = 0;
+			shadowPaint.innerColor = shadowPaint.outerColor = nvg__shadowColor(state, &shadowPaint, 1.0f);
+			shadowPaint.image = fontImage;
+			shadowPaint.image2 = 0;
+			nvg__offsetVerts(shadowVerts, verts, nverts, state->shadowOffsetX, state->shadowOffsetY);
+			ctx->params.renderTriangles(ctx->params.userPtr, &shadowPaint, state->compositeOperation, &state->scissor,
+										shadowVerts, nverts, filterStack);
+			ctx->drawCallCount++;
+		}
+	}
 
 	// Apply global alpha
 	paint->innerColor.a *= state->alpha;
@@ -2437,16 +2975,7 @@ static void nvg__renderText(NVGcontext* ctx, NVGpaint* paint, NVGvertex* verts,
 
 static float nvg__getSdfFontSize(NVGstate* state, float scale)
 {
-	int fontSize = static_cast<int>(state->fontSize * scale);
-	int sdfFontSize = 32;
-
-	// We double the font size so that SDFs are also used for smaller font sizes
-	// For instance an SDF font size of 128 is used for the target font size range of 64-256
-	fontSize *= 2;
-	// Reduce the font size to a powers of 4 after 32 (e.g. 32, 32*4, 32*4*4)
-	fontSize /= sdfFontSize;
-	while (fontSize /= 4) sdfFontSize *= 4;
-	return static_cast<float>(sdfFontSize);
+	return nanovg_glyphcache::SdfFontSize(state->fontSize * scale);
 }
 
 // Computes the distance in SDF values of a single pixel
@@ -2475,31 +3004,42 @@ float nvg__text(NVGcontext* ctx, NVGpaint* paint, float scale, float x, float y,
 	if (end == NULL)
 		end = string + strlen(string);
 
-	if (state->fontId == FONS_INVALID) return x;
+	if (state->fontId == FONS_INVALID || ctx->glyphCache == NULL) return x;
+
+	// The atlas is shared with other contexts, possibly on other threads.
+	std::unique_lock<std::mutex> lock = ctx->glyphCache->Lock();
+	FONScontext* fs = ctx->glyphCache->Atlas(sdfFontSize);
+	if (fs == NULL) return x;
+
+	// The draws below keep the atlas texture in use until nvgEndFrame submits them.
+	if (!ctx->glyphDrawsPending) {
+		ctx->glyphCache->RecordingDraws(ctx);
+		ctx->glyphDrawsPending = 1;
+	}
 
-	fonsSetSize(ctx->fs, sdfFontSize);
-	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
-	fonsSetBlur(ctx->fs, state->fontBlur*scale);
-	fonsSetAlign(ctx->fs, state->textAlign);
-	fonsSetFont(ctx->fs, state->fontId);
+	fonsSetSize(fs, sdfFontSize);
+	fonsSetSpacing(fs, state->letterSpacing*scale);
+	fonsSetBlur(fs, state->fontBlur*scale);
+	fonsSetAlign(fs, state->textAlign);
+	fonsSetFont(fs, state->fontId);
 
 	cverts = nvg__maxi(2, (int)(end - string)) * 6; // conservative estimate.
 	verts = nvg__allocTempVerts(ctx, cverts);
 	if (verts == NULL) return x;
 
-	fonsTextIterInit(ctx->fs, &iter, 0, 0, string, end, FONS_GLYPH_BITMAP_REQUIRED);
+	fonsTextIterInit(fs, &iter, 0, 0, string, end, FONS_GLYPH_BITMAP_REQUIRED);
 	prevIter = iter;
-	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
+	while (fonsTextIterNext(fs, &iter, &q)) {
 		float c[4*2];
 		if (iter.prevGlyphIndex == -1) { // can not retrieve glyph?
 			if (nverts != 0) {
-				nvg__renderText(ctx, paint, verts, nverts);
+				nvg__renderText(ctx, paint, ctx->glyphCache->Upload(sdfFontSize), verts, nverts);
 				nverts = 0;
 			}
-			if (!nvg__allocTextAtlas(ctx))
+			if (!ctx->glyphCache->MakeRoom(sdfFontSize))
 				break; // no memory :(
 			iter = prevIter;
-			fonsTextIterNext(ctx->fs, &iter, &q); // try again
+			fonsTextIterNext(fs, &iter, &q); // try again
 			if (iter.prevGlyphIndex == -1) // still can not find glyph?
 				break;
 		}
@@ -2521,9 +3061,7 @@ float nvg__text(NVGcontext* ctx, NVGpaint* paint, float scale, float x, float y,
 	}
 
 	// TODO: add back-end bit to do this just once per frame.
-	nvg__flushTextTexture(ctx);
-
-	nvg__renderText(ctx, paint, verts, nverts);
+	nvg__renderText(ctx, paint, ctx->glyphCache->Upload(sdfFontSize), verts, nverts);
 
 	return iter.nextx * vtxscale;
 }
@@ -2598,11 +3136,11 @@ int nvgTextGlyphPositions(NVGcontext* ctx, float x, float y, const char* string,
 	NVGstate* state = nvg__getState(ctx);
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
 	float invscale = 1.0f / scale;
-	FONStextIter iter, prevIter;
+	FONStextIter iter;
 	FONSquad q;
 	int npos = 0;
 
-	if (state->fontId == FONS_INVALID) return 0;
+	if (state->fontId == FONS_INVALID || ctx->glyphCache == NULL) return 0;
 
 	if (end == NULL)
 		end = string + strlen(string);
@@ -2610,20 +3148,18 @@ int nvgTextGlyphPositions(NVGcontext* ctx, float x, float y, const char* string,
 	if (string == end)
 		return 0;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
-	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
-	fonsSetBlur(ctx->fs, state->fontBlur*scale);
-	fonsSetAlign(ctx->fs, state->textAlign);
-	fonsSetFont(ctx->fs, state->fontId);
+	std::unique_lock<std::mutex> lock = ctx->glyphCache->Lock();
+	FONScontext* fs = ctx->glyphCache->Metrics();
+	if (fs == NULL) return 0;
 
-	fonsTextIterInit(ctx->fs, &iter, x*scale, y*scale, string, end, FONS_GLYPH_BITMAP_OPTIONAL);
-	prevIter = iter;
-	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
-		if (iter.prevGlyphIndex < 0 && nvg__allocTextAtlas(ctx)) { // can not retrieve glyph?
-			iter = prevIter;
-			fonsTextIterNext(ctx->fs, &iter, &q); // try again
-		}
-		prevIter = iter;
+	fonsSetSize(fs, state->fontSize*scale);
+	fonsSetSpacing(fs, state->letterSpacing*scale);
+	fonsSetBlur(fs, state->fontBlur*scale);
+	fonsSetAlign(fs, state->textAlign);
+	fonsSetFont(fs, state->fontId);
+
+	fonsTextIterInit(fs, &iter, x*scale, y*scale, string, end, FONS_GLYPH_BITMAP_OPTIONAL);
+	while (fonsTextIterNext(fs, &iter, &q)) {
 		positions[npos].str = iter.str;
 		positions[npos].x = iter.x * invscale;
 		positions[npos].minx = nvg__minf(iter.x, q.x0) * invscale;
@@ -2648,7 +3184,7 @@ int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, floa
 	NVGstate* state = nvg__getState(ctx);
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
 	float invscale = 1.0f / scale;
-	FONStextIter iter, prevIter;
+	FONStextIter iter;
 	FONSquad q;
 	int nrows = 0;
 	float rowStartX = 0;
@@ -2667,29 +3203,27 @@ int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, floa
 	unsigned int pcodepoint = 0;
 
 	if (maxRows == 0) return 0;
-	if (state->fontId == FONS_INVALID) return 0;
+	if (state->fontId == FONS_INVALID || ctx->glyphCache == NULL) return 0;
 
 	if (end == NULL)
 		end = string + strlen(string);
 
 	if (string == end) return 0;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
-	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
-	fonsSetBlur(ctx->fs, state->fontBlur*scale);
-	fonsSetAlign(ctx->fs, state->textAlign);
-	fonsSetFont(ctx->fs, state->fontId);
+	std::unique_lock<std::mutex> lock = ctx->glyphCache->Lock();
+	FONScontext* fs = ctx->glyphCache->Metrics();
+	if (fs == NULL) return 0;
+
+	fonsSetSize(fs, state->fontSize*scale);
+	fonsSetSpacing(fs, state->letterSpacing*scale);
+	fonsSetBlur(fs, state->fontBlur*scale);
+	fonsSetAlign(fs, state->textAlign);
+	fonsSetFont(fs, state->fontId);
 
 	breakRowWidth *= scale;
 
-	fonsTextIterInit(ctx->fs, &iter, 0, 0, string, end, FONS_GLYPH_BITMAP_OPTIONAL);
-	prevIter = iter;
-	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
-		if (iter.prevGlyphIndex < 0 && nvg__allocTextAtlas(ctx)) { // can not retrieve glyph?
-			iter = prevIter;
-			fonsTextIterNext(ctx->fs, &iter, &q); // try again
-		}
-		prevIter = iter;
+	fonsTextIterInit(fs, &iter, 0, 0, string, end, FONS_GLYPH_BITMAP_OPTIONAL);
+	while (fonsTextIterNext(fs, &iter, &q)) {
 		switch (iter.codepoint) {
 			case 9:			// \t
 			case 11:		// \v
@@ -2856,18 +3390,22 @@ float nvgTextBounds(NVGcontext* ctx, float x, float y, const char* string, const
 	float invscale = 1.0f / scale;
 	float width;
 
-	if (state->fontId == FONS_INVALID) return 0;
+	if (state->fontId == FONS_INVALID || ctx->glyphCache == NULL) return 0;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
-	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
-	fonsSetBlur(ctx->fs, state->fontBlur*scale);
-	fonsSetAlign(ctx->fs, state->textAlign);
-	fonsSetFont(ctx->fs, state->fontId);
+	std::unique_lock<std::mutex> lock = ctx->glyphCache->Lock();
+	FONScontext* fs = ctx->glyphCache->Metrics();
+	if (fs == NULL) return 0;
 
-	width = fonsTextBounds(ctx->fs, x*scale, y*scale, string, end, bounds);
+	fonsSetSize(fs, state->fontSize*scale);
+	fonsSetSpacing(fs, state->letterSpacing*scale);
+	fonsSetBlur(fs, state->fontBlur*scale);
+	fonsSetAlign(fs, state->textAlign);
+	fonsSetFont(fs, state->fontId);
+
+	width = fonsTextBounds(fs, x*scale, y*scale, string, end, bounds);
 	if (bounds != NULL) {
 		// Use line bounds for height.
-		fonsLineBounds(ctx->fs, y*scale, &bounds[1], &bounds[3]);
+		fonsLineBounds(fs, y*scale, &bounds[1], &bounds[3]);
 		bounds[0] *= invscale;
 		bounds[1] *= invscale;
 		bounds[2] *= invscale;
@@ -2889,7 +3427,7 @@ void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, co
 	float lineh = 0, rminy = 0, rmaxy = 0;
 	float minx, miny, maxx, maxy;
 
-	if (state->fontId == FONS_INVALID) {
+	if (state->fontId == FONS_INVALID || ctx->glyphCache == NULL) {
 		if (bounds != NULL)
 			bounds[0] = bounds[1] = bounds[2] = bounds[3] = 0.0f;
 		return;
@@ -2902,12 +3440,19 @@ void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, co
 	minx = maxx = x;
 	miny = maxy = y;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
-	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
-	fonsSetBlur(ctx->fs, state->fontBlur*scale);
-	fonsSetAlign(ctx->fs, state->textAlign);
-	fonsSetFont(ctx->fs, state->fontId);
-	fonsLineBounds(ctx->fs, 0, &rminy, &rmaxy);
+	{
+		// Released before nvgTextBreakLines below, which takes the lock itself.
+		std::unique_lock<std::mutex> lock = ctx->glyphCache->Lock();
+		FONScontext* fs = ctx->glyphCache->Metrics();
+		if (fs == NULL) return;
+
+		fonsSetSize(fs, state->fontSize*scale);
+		fonsSetSpacing(fs, state->letterSpacing*scale);
+		fonsSetBlur(fs, state->fontBlur*scale);
+		fonsSetAlign(fs, state->textAlign);
+		fonsSetFont(fs, state->fontId);
+		fonsLineBounds(fs, 0, &rminy, &rmaxy);
+	}
 	rminy *= invscale;
 	rmaxy *= invscale;
 
@@ -2951,15 +3496,19 @@ void nvgTextMetrics(NVGcontext* ctx, float* ascender, float* descender, float* l
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
 	float invscale = 1.0f / scale;
 
-	if (state->fontId == FONS_INVALID) return;
+	if (state->fontId == FONS_INVALID || ctx->glyphCache == NULL) return;
+
+	std::unique_lock<std::mutex> lock = ctx->glyphCache->Lock();
+	FONScontext* fs = ctx->glyphCache->Metrics();
+	if (fs == NULL) return;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
-	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
-	fonsSetBlur(ctx->fs, state->fontBlur*scale);
-	fonsSetAlign(ctx->fs, state->textAlign);
-	fonsSetFont(ctx->fs, state->fontId);
+	fonsSetSize(fs, state->fontSize*scale);
+	fonsSetSpacing(fs, state->letterSpacing*scale);
+	fonsSetBlur(fs, state->fontBlur*scale);
+	fonsSetAlign(fs, state->textAlign);
+	fonsSetFont(fs, state->fontId);
 
-	fonsVertMetrics(ctx->fs, ascender, descender, lineh);
+	fonsVertMetrics(fs, ascender, descender, lineh);
 	if (ascender != NULL)
 		*ascender *= invscale;
 	if (descender != NULL)
@@ -31,6 +31,7 @@ extern "C" {
 #endif
 
 class nanovg_filterstack;
+class nanovg_glyphcache;
 typedef struct NVGcontext NVGcontext;
 
 struct NVGcolor {
@@ -55,6 +56,8 @@ struct NVGpaint {
 	float sdfMin;
 	float sdfMax;
 	float sdfBlur;
+	// If positive, the v coordinate every fragment samples image at (see nvgImageRowPattern).
+	float imageRow;
 };
 typedef struct NVGpaint NVGpaint;
 
@@ -165,6 +168,15 @@ void nvgCancelFrame(NVGcontext* ctx);
 // Ends drawing flushing remaining render state.
 void nvgEndFrame(NVGcontext* ctx);
 
+// Returns the draw calls submitted since nvgBeginFrame(), counting both passes of a fill.
+int nvgDrawCallCount(NVGcontext* ctx);
+
+// Returns the triangles of the strokes submitted since nvgBeginFrame(), shadows included.
+int nvgStrokeTriCount(NVGcontext* ctx);
+
+// Returns the triangles of the fills submitted since nvgBeginFrame(), shadows included.
+int nvgFillTriCount(NVGcontext* ctx);
+
 //
 // Composite operation
 //
@@ -273,6 +285,16 @@ void nvgLineCap(NVGcontext* ctx, int cap);
 // Can be one of NVG_MITER (default), NVG_ROUND, NVG_BEVEL.
 void nvgLineJoin(NVGcontext* ctx, int join);
 
+// Sets the dash pattern of the stroke style: alternating dash and gap lengths in local units,
+// starting `offset` into the pattern. A pattern with an odd count is repeated to make it even.
+// Strokes are solid when count is 0 or the lengths are all zero.
+void nvgLineDash(NVGcontext* ctx, const float* dashes, int count, float offset);
+
+// Sets the shadow drawn under shapes and text: a copy in `color` offset by offsetX,offsetY
+// and blurred with a gaussian of standard deviation blur/2, all in pixels and unaffected by
+// the transform. No shadow is drawn when color is transparent or blur and offset are 0.
+void nvgShadow(NVGcontext* ctx, NVGcolor color, float blur, float offsetX, float offsetY);
+
 // Sets the transparency applied to all rendered shapes.
 // Already transparent paths will get proportionally more transparent as well.
 void nvgGlobalAlpha(NVGcontext* ctx, float alpha);
@@ -379,6 +401,10 @@ int nvgCreateImageRGBA(NVGcontext* ctx, int w, int h, int imageFlags, const unsi
 // Updates image data specified by image handle.
 void nvgUpdateImage(NVGcontext* ctx, int image, const unsigned char* data);
 
+// Updates the region (x, y, w, h) of image. data holds the whole image, as for nvgUpdateImage,
+// but only the region is uploaded.
+void nvgUpdateImageRegion(NVGcontext* ctx, int image, int x, int y, int w, int h, const unsigned char* data);
+
 // Returns the dimensions of a created image.
 void nvgImageSize(NVGcontext* ctx, int image, int* w, int* h);
 
@@ -417,6 +443,13 @@ NVGpaint nvgRadialGradient(NVGcontext* ctx, float cx, float cy, float inr, float
 NVGpaint nvgImagePattern(NVGcontext* ctx, float ox, float oy, float ex, float ey,
 						 float angle, int image, float alpha);
 
+// Creates and returns a pattern that samples a single row of an image, such as one ramp of an atlas
+// of 1D gradients. The row is stretched along (sx,sy)-(ex,ey), clamping past either end, and is
+// constant across that direction.
+// The gradient is transformed by the current transform when it is passed to nvgFillPaint() or nvgStrokePaint().
+NVGpaint nvgImageRowPattern(NVGcontext* ctx, float sx, float sy, float ex, float ey,
+							int image, int row, float alpha);
+
 //
 // Scissoring
 //
@@ -508,6 +541,24 @@ void nvgFill(NVGcontext* ctx);
 // Fills the current path with current stroke style.
 void nvgStroke(NVGcontext* ctx);
 
+// Tessellations of a path drawn again and again (e.g. a Path2D), cached between draws.
+// Entries are keyed by the draw kind, the fill rule or stroke style, and the transform: only
+// its translation-free part for translations (the geometry is offset on reuse), the whole
+// matrix otherwise. Not tied to a context.
+typedef struct NVGtessCache NVGtessCache;
+NVGtessCache* nvgCreateTessCache(void);
+void nvgDeleteTessCache(NVGtessCache* cache);
+// Drops every tessellation; call it when the path the cache was made for changes.
+void nvgResetTessCache(NVGtessCache* cache);
+void nvgTessCacheStats(NVGtessCache* cache, int* hits, int* misses, int* entries);
+
+// Like nvgFill and nvgStroke, but reuse the tessellation cached for the current draw state if
+// there is one, and cache it otherwise. The current path must be the one the cache was made
+// for. fillRule is 0 for nonzero and 1 for evenodd; nanovg only fills nonzero, so it only
+// keeps the two apart. A NULL cache draws without caching.
+void nvgFillCached(NVGcontext* ctx, NVGtessCache* cache, int fillRule);
+void nvgStrokeCached(NVGcontext* ctx, NVGtessCache* cache);
+
 
 //
 // Text
@@ -614,6 +665,10 @@ void nvgTextMetrics(NVGcontext* ctx, float* ascender, float* descender, float* l
 int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, float breakRowWidth, NVGtextRow* rows, int maxRows);
 
 void nvgFilterStack(NVGcontext* ctx, nanovg_filterstack& filterStack);
+
+// Sets the glyph cache text is rasterized into and drawn from, shared with other contexts.
+// Text is not drawn or measured without one.
+void nvgSetGlyphCache(NVGcontext* ctx, nanovg_glyphcache* glyphCache);
 //
 // Internal Render API
 //
@@ -622,6 +677,10 @@ enum NVGtexture {
 	NVG_TEXTURE_RGBA = 0x02,
 };
 
+// Images with this bit set are textures owned by the shared glyph cache rather than the
+// context; the low bits are the bgfx texture handle. They are always NVG_TEXTURE_ALPHA.
+#define NVG_SHARED_IMAGE_BIT 0x10000
+
 struct NVGscissor {
 	float xform[6];
 	float extent[2];
@@ -259,15 +259,9 @@ namespace
         PoolInterface frameBufferPool;
         bgfx::Encoder* encoder;
 
-        // When true, the next non-filtered draw call must acquire a fresh (higher)
-        // bgfx view on the canvas framebuffer so it is ordered after any pool-buffer
-        // views used by a preceding filtered draw. Consecutive non-filtered draws
-        // otherwise share a single view to avoid exhausting the bgfx view budget
-        // (a canvas painted with thousands of ops would otherwise leak thousands of
-        // views within a single device frame -> "Too many views").
-        bool canvasViewNeedsRefresh;
-
         struct GLNVGtexture* textures;
+        // Entry returned for images of textures shared between contexts (see NVG_SHARED_IMAGE_BIT).
+        struct GLNVGtexture sharedTexture;
         float view[2];
         int ntextures;
         int ctextures;
@@ -329,6 +323,17 @@ namespace
 
     static struct GLNVGtexture* glnvg__findTexture(struct GLNVGcontext* gl, int id)
     {
+        if (id & NVG_SHARED_IMAGE_BIT)
+        {
+            // Owned by the glyph cache, which only shares single channel atlases.
+            gl->sharedTexture.id.idx = (uint16_t)(id & 0xffff);
+            gl->sharedTexture.width = 1;
+            gl->sharedTexture.height = 1;
+            gl->sharedTexture.type = NVG_TEXTURE_ALPHA;
+            gl->sharedTexture.flags = NVG_IMAGE_NODELETE;
+            return &gl->sharedTexture;
+        }
+
         int i;
         for (i = 0; i < gl->ntextures; i++)
         {
@@ -584,6 +589,15 @@ namespace
             nvgTransformInverse(invxform, paint->xform);
             frag->type = NSVG_SHADER_FILLIMG;
 
+            if (paint->imageRow > 0.0f)
+            {
+                // A row pattern: v is the same on every fragment, so the paint never bleeds
+                // into the neighbouring rows however far the shape extends across it.
+                invxform[1] = 0.0f;
+                invxform[3] = 0.0f;
+                invxform[5] = paint->imageRow * paint->extent[1];
+            }
+
             if (tex->type == NVG_TEXTURE_RGBA)
             {
                 frag->texType = (tex->flags & NVG_IMAGE_PREMULTIPLIED) ? 0.0f : 1.0f;
@@ -710,27 +724,22 @@ namespace
         encoder->setIndexBuffer(&tib);
     }
 
-    // Gates acquisition of a fresh bgfx view for a canvas draw call. A filtered draw
-    // (blur/etc.) uses intermediate pool framebuffers on higher-id views, so the next
-    // canvas draw must be re-bound to a fresh (higher) view to preserve draw order.
-    // Consecutive non-filtered draws instead share the canvas framebuffer's current
-    // view, preventing view-budget exhaustion ("Too many views") when a DynamicTexture
-    // is painted with thousands of ops in a single device frame.
+    // Only a filtered draw call re-binds the canvas framebuffer: its intermediate passes
+    // run on pool framebuffers with views acquired after the canvas' current one, so the
+    // final pass needs a fresh (higher) canvas view to be ordered after them. That view
+    // then stays bound, and every following unfiltered call keeps drawing into it, as
+    // nothing else is ordered between them. A run of unfiltered calls therefore shares
+    // a single view, and a filtered call costs one view per pass, including the final one.
     static Babylon::Graphics::FrameBuffer* glnvg__beginFinalFrameBuffer(struct GLNVGcontext* gl, struct GLNVGcall* call)
     {
         Babylon::Graphics::FrameBuffer* finalFrameBuffer = gl->frameBuffer;
-        if (call->filterStack.HasFilters() || gl->canvasViewNeedsRefresh)
+        if (call->filterStack.HasFilters())
         {
             finalFrameBuffer->Bind();
         }
         return finalFrameBuffer;
     }
 
-    static void glnvg__endFinalFrameBuffer(struct GLNVGcontext* gl, struct GLNVGcall* call)
-    {
-        gl->canvasViewNeedsRefresh = call->filterStack.HasFilters();
-    }
-
     static void glnvg__fill(struct GLNVGcontext* gl, struct GLNVGcall* call)
     {
         bgfx::ProgramHandle firstProg = gl->prog;
@@ -828,7 +837,6 @@ namespace
         };
         Babylon::Graphics::FrameBuffer *finalFrameBuffer = glnvg__beginFinalFrameBuffer(gl, call);
         call->filterStack.Render(firstProg, setUniform, firstPass, filterPass, finalPass, finalFrameBuffer, gl->frameBufferPool.acquire, gl->frameBufferPool.release);
-        glnvg__endFinalFrameBuffer(gl, call);
     }
 
     static void glnvg__convexFill(struct GLNVGcontext* gl, struct GLNVGcall* call)
@@ -887,7 +895,6 @@ namespace
         };
         Babylon::Graphics::FrameBuffer *finalFrameBuffer = glnvg__beginFinalFrameBuffer(gl, call);
         call->filterStack.Render(firstProg, setUniform, firstPass, filterPass, finalPass, finalFrameBuffer, gl->frameBufferPool.acquire, gl->frameBufferPool.release);
-        glnvg__endFinalFrameBuffer(gl, call);
     }
 
     static void glnvg__stroke(struct GLNVGcontext* gl, struct GLNVGcall* call)
@@ -929,7 +936,6 @@ namespace
         };
         Babylon::Graphics::FrameBuffer *finalFrameBuffer = glnvg__beginFinalFrameBuffer(gl, call);
         call->filterStack.Render(firstProg, setUniform, firstPass, filterPass, finalPass, finalFrameBuffer, gl->frameBufferPool.acquire, gl->frameBufferPool.release);
-        glnvg__endFinalFrameBuffer(gl, call);
     }
 
     static void glnvg__triangles(struct GLNVGcontext* gl, struct GLNVGcall* call)
@@ -966,7 +972,6 @@ namespace
 			};
             Babylon::Graphics::FrameBuffer *finalFrameBuffer = glnvg__beginFinalFrameBuffer(gl, call);
             call->filterStack.Render(firstProg, setUniform, firstPass, filterPass, finalPass, finalFrameBuffer, gl->frameBufferPool.acquire, gl->frameBufferPool.release);
-            glnvg__endFinalFrameBuffer(gl, call);
         }
     }
 
@@ -1015,7 +1020,6 @@ namespace
         //gl->frameBuffer->SetViewPort(gl->encoder, 0.f, 0.f, gl->view[0], gl->view[1]);
         // The canvas framebuffer is bound with a fresh view by Context::Flush before this
         // flush runs, so the first draw call can reuse that view without re-binding.
-        gl->canvasViewNeedsRefresh = false;
         if (!gl->prog.idx)
         {
             bgfx::RendererType::Enum type = bgfx::getRendererType();
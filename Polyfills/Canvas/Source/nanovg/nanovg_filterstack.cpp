@@ -1,14 +1,15 @@
 #include "nanovg_filterstack.h"
-#include <regex>
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <cmath>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 #include <bgfx/bgfx.h>
 #include <bgfx/embedded_shader.h>
 
-std::regex blurRegex(R"(blur\((\d*\.?\d+)(px|rem)?\)|blur\(\))");
-std::regex noneRegex(R"(^\s*none\s*$)");
-
 #include "Shaders/dxbc/vs_fspass.h"
 #include "Shaders/dxil/vs_fspass.h"
 #include "Shaders/metal/vs_fspass.h"
@@ -33,6 +34,8 @@ std::regex noneRegex(R"(^\s*none\s*$)");
 #define BLUR_MAX_PX 1000
 #define BLUR_TAPS 13
 #define BLUR_UNIFORM_SIZE 5 // fit into vec4: ceil(BLUR_TAPS / 4)
+#define MAX_CACHED_FILTERS 256 // the parse cache is cleared when it holds this many strings
+#define ROOT_FONT_SIZE_PX 16.f
 
 static const bgfx::EmbeddedShader s_embeddedShadersFilterStack[] =
 {
@@ -80,45 +83,457 @@ void nanovg_filterstack::DisposeBgfx()
         bgfx::destroy(s_boxBlurProg);
 }
 
+namespace
+{
+    struct ParseCache
+    {
+        struct Entry
+        {
+            bool Valid;
+            nanovg_filterstack Stack;
+        };
+
+        std::mutex Mutex{};
+        std::unordered_map<std::string, Entry> Entries{};
+        nanovg_filterstack::CacheStats Stats{};
+    };
+
+    ParseCache& GetParseCache()
+    {
+        static ParseCache cache{};
+        return cache;
+    }
+
+    // Splits a CSS filter list into identifiers, numbers with their unit, and punctuation.
+    class FilterTokenizer
+    {
+    public:
+        explicit FilterTokenizer(const std::string& string)
+            : m_current{string.data()}
+            , m_end{string.data() + string.size()}
+        {
+        }
+
+        void SkipSpace()
+        {
+            while (m_current < m_end && (*m_current == ' ' || *m_current == '\t' || *m_current == '\n' || *m_current == '\r' || *m_current == '\f'))
+            {
+                ++m_current;
+            }
+        }
+
+        bool AtEnd() const
+        {
+            return m_current == m_end;
+        }
+
+        bool Char(char c)
+        {
+            if (m_current < m_end && *m_current == c)
+            {
+                ++m_current;
+                return true;
+            }
+            return false;
+        }
+
+        // Letters and dashes, lowercased: function names and units are ASCII case-insensitive.
+        std::string Identifier()
+        {
+            std::string identifier;
+            while (m_current < m_end && (std::isalpha(static_cast<unsigned char>(*m_current)) || *m_current == '-' || *m_current == '%'))
+            {
+                identifier.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(*m_current++))));
+            }
+            return identifier;
+        }
+
+        // [+-]digits[.digits][e[+-]digits], with digits optional on one side of the point.
+        bool Number(float& value)
+        {
+            const char* start = m_current;
+            const char* p = m_current;
+            double sign = 1.0;
+            if (p < m_end && (*p == '+' || *p == '-'))
+            {
+                sign = *p++ == '-' ? -1.0 : 1.0;
+            }
+
+            double mantissa = 0.0;
+            int digits = 0;
+            while (p < m_end && std::isdigit(static_cast<unsigned char>(*p)))
+            {
+                mantissa = mantissa * 10.0 + (*p++ - '0');
+                ++digits;
+            }
+            if (p < m_end && *p == '.')
+            {
+                double scale = 0.1;
+                for (++p; p < m_end && std::isdigit(static_cast<unsigned char>(*p)); ++p, scale *= 0.1)
+                {
+                    mantissa += (*p - '0') * scale;
+                    ++digits;
+                }
+            }
+            if (digits == 0)
+            {
+                m_current = start;
+                return false;
+            }
+
+            // An exponent needs digits, otherwise the 'e' starts a unit ("1em").
+            if (p + 1 < m_end && (*p == 'e' || *p == 'E'))
+            {
+                const char* q = p + 1;
+                int exponentSign = 1;
+                if (*q == '+' || *q == '-')
+                {
+                    exponentSign = *q++ == '-' ? -1 : 1;
+                }
+                if (q < m_end && std::isdigit(static_cast<unsigned char>(*q)))
+                {
+                    int exponent = 0;
+                    while (q < m_end && std::isdigit(static_cast<unsigned char>(*q)))
+                    {
+                        exponent = std::min(exponent * 10 + (*q++ - '0'), 1000);
+                    }
+                    mantissa *= std::pow(10.0, exponentSign * exponent);
+                    p = q;
+                }
+            }
+
+            value = static_cast<float>(sign * mantissa);
+            m_current = p;
+            return std::isfinite(value);
+        }
+
+    private:
+        const char* m_current;
+        const char* m_end;
+    };
+
+    // Matrices of the Filter Effects spec, as 4 rows of 5 over (r, g, b, a, 1).
+    void SetMatrix3(float matrix[20], const float rgb[9])
+    {
+        std::memset(matrix, 0, sizeof(float) * 20);
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int column = 0; column < 3; ++column)
+            {
+                matrix[row * 5 + column] = rgb[row * 3 + column];
+            }
+        }
+        matrix[18] = 1.f;
+    }
+
+    void SetLinear(float matrix[20], float slope, float intercept, bool alpha)
+    {
+        std::memset(matrix, 0, sizeof(float) * 20);
+        for (int row = 0; row < 4; ++row)
+        {
+            const bool scaled = alpha ? row == 3 : row < 3;
+            matrix[row * 5 + row] = scaled ? slope : 1.f;
+            matrix[row * 5 + 4] = scaled ? intercept : 0.f;
+        }
+    }
+
+    bool ColorFunctionMatrix(const std::string& name, float amount, float matrix[20])
+    {
+        if (name == "grayscale")
+        {
+            const float a = 1.f - std::min(amount, 1.f);
+            const float rgb[9] = {
+                0.2126f + 0.7874f * a, 0.7152f - 0.7152f * a, 0.0722f - 0.0722f * a,
+                0.2126f - 0.2126f * a, 0.7152f + 0.2848f * a, 0.0722f - 0.0722f * a,
+                0.2126f - 0.2126f * a, 0.7152f - 0.7152f * a, 0.0722f + 0.9278f * a};
+            SetMatrix3(matrix, rgb);
+        }
+        else if (name == "sepia")
+        {
+            const float a = 1.f - std::min(amount, 1.f);
+            const float rgb[9] = {
+                0.393f + 0.607f * a, 0.769f - 0.769f * a, 0.189f - 0.189f * a,
+                0.349f - 0.349f * a, 0.686f + 0.314f * a, 0.168f - 0.168f * a,
+                0.272f - 0.272f * a, 0.534f - 0.534f * a, 0.131f + 0.869f * a};
+            SetMatrix3(matrix, rgb);
+        }
+        else if (name == "saturate")
+        {
+            const float s = amount;
+            const float rgb[9] = {
+                0.213f + 0.787f * s, 0.715f - 0.715f * s, 0.072f - 0.072f * s,
+                0.213f - 0.213f * s, 0.715f + 0.285f * s, 0.072f - 0.072f * s,
+                0.213f - 0.213f * s, 0.715f - 0.715f * s, 0.072f + 0.928f * s};
+            SetMatrix3(matrix, rgb);
+        }
+        else if (name == "brightness")
+        {
+            SetLinear(matrix, amount, 0.f, false);
+        }
+        else if (name == "contrast")
+        {
+            SetLinear(matrix, amount, 0.5f - 0.5f * amount, false);
+        }
+        else if (name == "invert")
+        {
+            const float a = std::min(amount, 1.f);
+            SetLinear(matrix, 1.f - 2.f * a, a, false);
+        }
+        else if (name == "opacity")
+        {
+            SetLinear(matrix, std::min(amount, 1.f), 0.f, true);
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    void HueRotateMatrix(float radians, float matrix[20])
+    {
+        const float c = std::cos(radians);
+        const float s = std::sin(radians);
+        const float rgb[9] = {
+            0.213f + c * 0.787f - s * 0.213f, 0.715f - c * 0.715f - s * 0.715f, 0.072f - c * 0.072f + s * 0.928f,
+            0.213f - c * 0.213f + s * 0.143f, 0.715f + c * 0.285f + s * 0.140f, 0.072f - c * 0.072f - s * 0.283f,
+            0.213f - c * 0.213f - s * 0.787f, 0.715f - c * 0.715f + s * 0.715f, 0.072f + c * 0.928f + s * 0.072f};
+        SetMatrix3(matrix, rgb);
+    }
+}
+
 bool nanovg_filterstack::ValidString(const std::string& string)
 {
-    std::smatch match;
-    return std::regex_match(string, match, noneRegex) || std::regex_match(string, match, blurRegex);
+    nanovg_filterstack filterStack;
+    return filterStack.ParseString(string);
 }
 
-void nanovg_filterstack::ParseString(const std::string& string)
+bool nanovg_filterstack::ParseString(const std::string& string)
+{
+    ParseCache& cache = GetParseCache();
+    std::lock_guard<std::mutex> lock{cache.Mutex};
+
+    const auto found = cache.Entries.find(string);
+    if (found != cache.Entries.end())
+    {
+        ++cache.Stats.Hits;
+        *this = found->second.Stack;
+        return found->second.Valid;
+    }
+
+    ++cache.Stats.Misses;
+    const bool valid = Parse(string);
+    if (!valid)
+    {
+        stackElementCount = 0;
+        hasColorMatrix = false;
+    }
+
+    // Animated filters produce a new string every frame; start over rather than grow forever.
+    if (cache.Entries.size() >= MAX_CACHED_FILTERS)
+    {
+        cache.Entries.clear();
+    }
+    cache.Entries.emplace(string, ParseCache::Entry{valid, *this});
+    return valid;
+}
+
+nanovg_filterstack::CacheStats nanovg_filterstack::GetCacheStats()
+{
+    ParseCache& cache = GetParseCache();
+    std::lock_guard<std::mutex> lock{cache.Mutex};
+    CacheStats stats = cache.Stats;
+    stats.Entries = cache.Entries.size();
+    return stats;
+}
+
+bool nanovg_filterstack::Parse(const std::string& string)
 {
     stackElementCount = 0;
+    hasColorMatrix = false;
 
-    std::smatch match;
-    if (std::regex_match(string, match, blurRegex))
+    FilterTokenizer tokenizer{string};
+    tokenizer.SkipSpace();
+    if (tokenizer.AtEnd())
     {
-        if (match.size() > 1 && match[1].matched)
+        return false;
+    }
+
+    do
+    {
+        const std::string name = tokenizer.Identifier();
+        if (name == "none")
+        {
+            tokenizer.SkipSpace();
+            return stackElementCount == 0 && !hasColorMatrix && tokenizer.AtEnd();
+        }
+        if (name.empty() || !tokenizer.Char('('))
         {
-            float radius = std::stof(match[1].str());
-            std::string unit = match[2].matched ? match[2].str() : "px";
-            std::transform(unit.begin(), unit.end(), unit.begin(), ::tolower);
+            return false;
+        }
+
+        tokenizer.SkipSpace();
+        float value = 0.f;
+        const bool hasValue = tokenizer.Number(value);
+        const std::string unit = hasValue ? tokenizer.Identifier() : std::string{};
+        tokenizer.SkipSpace();
+        if (!tokenizer.Char(')'))
+        {
+            return false;
+        }
 
-            if (unit != "px")
+        float matrix[20];
+        if (name == "blur")
+        {
+            // Unitless lengths other than 0 are not CSS, but were always accepted here as px.
+            if (unit == "rem" || unit == "em")
             {
-                // TODO: convert non-px radius
+                value *= ROOT_FONT_SIZE_PX;
             }
-
-            assert(stackElementCount < MAX_STACK_SIZE);
-            if (radius > 0 && stackElementCount < MAX_STACK_SIZE)
+            else if (!unit.empty() && unit != "px")
+            {
+                return false;
+            }
+            if (value < 0.f)
+            {
+                return false;
+            }
+            AddBlur(value, value);
+        }
+        else if (name == "hue-rotate")
+        {
+            float radians;
+            if (unit == "deg" || (unit.empty() && value == 0.f))
+            {
+                radians = value * 3.14159265f / 180.f;
+            }
+            else if (unit == "rad")
             {
-                StackElement& element = stackElements[stackElementCount++];
-                element.type = SE_BLUR;
-                element.blurElement = {radius, radius};
+                radians = value;
             }
+            else if (unit == "grad")
+            {
+                radians = value * 3.14159265f / 200.f;
+            }
+            else if (unit == "turn")
+            {
+                radians = value * 2.f * 3.14159265f;
+            }
+            else
+            {
+                return false;
+            }
+            HueRotateMatrix(radians, matrix);
+            AddColorMatrix(matrix);
         }
         else
         {
-            // defaults to blur(0), which is no blur
+            // Color functions take a number or a percentage, and default to 1 (100%).
+            float amount = hasValue ? value : 1.f;
+            if (unit == "%")
+            {
+                amount /= 100.f;
+            }
+            else if (!unit.empty())
+            {
+                return false;
+            }
+            if (amount < 0.f || !ColorFunctionMatrix(name, amount, matrix))
+            {
+                return false;
+            }
+            AddColorMatrix(matrix);
+        }
+
+        tokenizer.SkipSpace();
+    } while (!tokenizer.AtEnd());
+
+    return true;
+}
+
+void nanovg_filterstack::AddColorMatrix(const float matrix[20])
+{
+    if (!hasColorMatrix)
+    {
+        std::memcpy(colorMatrix, matrix, sizeof(colorMatrix));
+        hasColorMatrix = true;
+        return;
+    }
+
+    // The new matrix applies after the current one.
+    float fused[20];
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 5; ++column)
+        {
+            float sum = column == 4 ? matrix[row * 5 + 4] : 0.f;
+            for (int k = 0; k < 4; ++k)
+            {
+                sum += matrix[row * 5 + k] * colorMatrix[k * 5 + column];
+            }
+            fused[row * 5 + column] = sum;
+        }
+    }
+    std::memcpy(colorMatrix, fused, sizeof(colorMatrix));
+}
+
+void nanovg_filterstack::TransformColor(float rgba[4]) const
+{
+    if (!hasColorMatrix)
+    {
+        return;
+    }
+
+    float result[4];
+    for (int row = 0; row < 4; ++row)
+    {
+        const float* m = &colorMatrix[row * 5];
+        const float value = m[0] * rgba[0] + m[1] * rgba[1] + m[2] * rgba[2] + m[3] * rgba[3] + m[4];
+        result[row] = std::clamp(value, 0.f, 1.f);
+    }
+    std::memcpy(rgba, result, sizeof(result));
+}
+
+void nanovg_filterstack::TransformPixels(const uint8_t* src, uint8_t* dst, size_t count) const
+{
+    if (!hasColorMatrix)
+    {
+        if (src != dst)
+        {
+            std::memcpy(dst, src, count * 4);
+        }
+        return;
+    }
+
+    // Scaled so each row maps bytes to bytes.
+    float m[20];
+    for (int i = 0; i < 20; ++i)
+    {
+        m[i] = (i % 5 == 4) ? colorMatrix[i] * 255.f : colorMatrix[i];
+    }
+    for (size_t i = 0; i < count; ++i, src += 4, dst += 4)
+    {
+        const float r = src[0], g = src[1], b = src[2], a = src[3];
+        for (int row = 0; row < 4; ++row)
+        {
+            const float* mr = &m[row * 5];
+            const float value = mr[0] * r + mr[1] * g + mr[2] * b + mr[3] * a + mr[4];
+            dst[row] = static_cast<uint8_t>(std::clamp(value, 0.f, 255.f) + 0.5f);
         }
     }
 }
 
+void nanovg_filterstack::AddBlur(float horizontal, float vertical)
+{
+    assert(stackElementCount < MAX_STACK_SIZE);
+    if ((horizontal > 0 || vertical > 0) && stackElementCount < MAX_STACK_SIZE)
+    {
+        StackElement& element = stackElements[stackElementCount++];
+        element.type = SE_BLUR;
+        element.blurElement = {horizontal, vertical};
+    }
+}
+
 std::vector<float> nanovg_filterstack::CalculateGaussianKernel(float sigma, int kernelSize)
 {
     assert(kernelSize % 2 == 1); // kernel size must be odd
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <vector>
@@ -21,9 +23,19 @@ public:
         bgfx::UniformHandle u_weights;
     } static m_uniforms;
 
-    void AddSepia(float strength) {}
-    void AddContrast(float strength) {}
-    void AddBlur(int horizontal, int vertical) {}
+    struct CacheStats
+    {
+        // Strings found already parsed, and strings that had to be parsed.
+        uint64_t Hits{};
+        uint64_t Misses{};
+        size_t Entries{};
+    };
+
+    // Fuses a color matrix into the one of this stack: 4 rows of 5, mapping unpremultiplied
+    // (r, g, b, a, 1) to the output color.
+    void AddColorMatrix(const float matrix[20]);
+    // Appends a gaussian blur with these standard deviations in pixels, ignored if both are 0.
+    void AddBlur(float horizontal, float vertical);
 
     void Render(
         bgfx::ProgramHandle firstProg,
@@ -37,36 +49,36 @@ public:
     );
     void Render(std::function<void()> element);
 
-    // Returns true if this stack has any filter elements (blur/sepia/etc.) that
+    // Returns true if this stack has any filter elements (blur passes) that
     // require intermediate pool framebuffers. When false, draws render straight
     // into the final (canvas) framebuffer and can share a single bgfx view.
     bool HasFilters() const { return stackElementCount > 0; }
 
-    void ParseString(const std::string& string);
-    static bool ValidString(const std::string& string);
+    // The color functions of the stack (brightness, contrast, grayscale, hue-rotate, invert,
+    // opacity, saturate, sepia), fused into one matrix. A draw is filtered on its own, so they
+    // are applied to its colors and images before it is drawn rather than by a pass: the
+    // pixels of the draw are its paint times coverage, and the matrix commutes with the
+    // coverage and with blurring, clamping aside.
+    bool HasColorMatrix() const { return hasColorMatrix; }
+    const float* ColorMatrix() const { return hasColorMatrix ? colorMatrix : nullptr; }
+    void TransformColor(float rgba[4]) const;
+    // Transforms `count` pixels of unpremultiplied RGBA8.
+    void TransformPixels(const uint8_t* src, uint8_t* dst, size_t count) const;
 
-    void AddDropShadow()
-    {
-        // break down shadow as blur + color
-    }
+    // Parses a CSS filter list ("none", or functions separated by whitespace). Parsed strings
+    // are cached process wide. Returns false, leaving this stack empty, for a string that is
+    // not a valid filter list.
+    bool ParseString(const std::string& string);
+    static bool ValidString(const std::string& string);
+    static CacheStats GetCacheStats();
 
 protected:
 
     enum StackElementTypes
     {
-        SE_SEPIA = 0,
-        SE_CONTRAST = 1,
         SE_BLUR = 2,
     };
 
-    struct SepiaElement
-    {
-        float strength;
-    };
-    struct Contrast
-    {
-        float strength;
-    };
     struct Blur
     {
         float horizontal, vertical; // blur strength (standard deviation px)
@@ -74,18 +86,17 @@ protected:
     struct StackElement
     {
         StackElementTypes type;
-        union
-        {
-            SepiaElement sepiaElement;
-            Contrast contrastElement;
-            Blur blurElement;
-        };
+        Blur blurElement;
     };
-    int stackElementCount;
+    int stackElementCount{};
     static const int MAX_STACK_SIZE = 32;
     StackElement stackElements[MAX_STACK_SIZE];
 
+    bool hasColorMatrix{};
+    float colorMatrix[20];
+
 private:
+    bool Parse(const std::string& string);
     std::vector<float> CalculateGaussianKernel(float sigma, int kernelSize);
     std::array<float, 2> CalculateBoxKernel(float sigma);
 };
\ No newline at end of file
@@ -0,0 +1,550 @@
+#include "nanovg_glyphcache.h"
+#include "nanovg.h"
+#include "fontstash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr int INITIAL_ATLAS_SIZE = 512;
+    constexpr int MAX_ATLAS_SIZE = 2048;
+
+    // The metrics stash only records glyph metrics, never bitmaps.
+    constexpr int METRICS_ATLAS_SIZE = 64;
+
+    struct Font
+    {
+        std::string Name;
+        std::vector<uint8_t> Data;
+    };
+
+    // Font ids are indices into Fonts: every stash gets the fonts added in this order.
+    struct FontRegistry
+    {
+        std::mutex Mutex;
+        std::vector<std::unique_ptr<Font>> Fonts;
+        std::vector<std::pair<int, int>> Fallbacks;
+    };
+
+    FontRegistry& Registry()
+    {
+        static FontRegistry registry{};
+        return registry;
+    }
+
+    FONScontext* CreateFontStash(int width, int height)
+    {
+        FONSparams params{};
+        params.width = width;
+        params.height = height;
+        params.flags = FONS_ZERO_TOPLEFT;
+        return fonsCreateInternal(&params);
+    }
+
+    size_t AtlasBytes(int width, int height)
+    {
+        // The CPU copy fontstash rasterizes into, and the R8 texture.
+        return static_cast<size_t>(width) * height * 2;
+    }
+}
+
+std::shared_ptr<nanovg_glyphcache> nanovg_glyphcache::Get()
+{
+    static std::mutex mutex{};
+    static std::weak_ptr<nanovg_glyphcache> instance{};
+
+    std::scoped_lock lock{mutex};
+    auto glyphCache = instance.lock();
+    if (!glyphCache)
+    {
+        glyphCache = std::make_shared<nanovg_glyphcache>();
+        instance = glyphCache;
+    }
+    return glyphCache;
+}
+
+int nanovg_glyphcache::AddFont(const std::string& name, std::vector<uint8_t> data)
+{
+    auto& registry = Registry();
+    std::scoped_lock lock{registry.Mutex};
+
+    for (size_t i = 0; i < registry.Fonts.size(); ++i)
+    {
+        if (registry.Fonts[i]->Name == name)
+        {
+            return static_cast<int>(i);
+        }
+    }
+
+    // Fonts are added to every stash in registration order, so one that fontstash rejects must
+    // not be registered or it would shift the ids of the fonts after it.
+    FONScontext* probe = CreateFontStash(1, 1);
+    if (probe == nullptr)
+    {
+        return FONS_INVALID;
+    }
+    const int probeId = fonsAddFontMem(probe, name.c_str(), data.data(), static_cast<int>(data.size()), 0);
+    fonsDeleteInternal(probe);
+    if (probeId == FONS_INVALID)
+    {
+        return FONS_INVALID;
+    }
+
+    registry.Fonts.push_back(std::make_unique<Font>(Font{name, std::move(data)}));
+    return static_cast<int>(registry.Fonts.size() - 1);
+}
+
+int nanovg_glyphcache::FindFont(const std::string& name)
+{
+    auto& registry = Registry();
+    std::scoped_lock lock{registry.Mutex};
+
+    for (size_t i = 0; i < registry.Fonts.size(); ++i)
+    {
+        if (registry.Fonts[i]->Name == name)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return FONS_INVALID;
+}
+
+size_t nanovg_glyphcache::GetFontCount()
+{
+    auto& registry = Registry();
+    std::scoped_lock lock{registry.Mutex};
+    return registry.Fonts.size();
+}
+
+std::vector<std::pair<std::string, int>> nanovg_glyphcache::GetFonts()
+{
+    auto& registry = Registry();
+    std::scoped_lock lock{registry.Mutex};
+
+    std::vector<std::pair<std::string, int>> fonts{};
+    fonts.reserve(registry.Fonts.size());
+    for (size_t i = 0; i < registry.Fonts.size(); ++i)
+    {
+        fonts.emplace_back(registry.Fonts[i]->Name, static_cast<int>(i));
+    }
+    return fonts;
+}
+
+bool nanovg_glyphcache::AddFallbackFont(int baseFont, int fallbackFont)
+{
+    auto& registry = Registry();
+    std::scoped_lock lock{registry.Mutex};
+
+    const int fontCount = static_cast<int>(registry.Fonts.size());
+    if (baseFont < 0 || baseFont >= fontCount || fallbackFont < 0 || fallbackFont >= fontCount)
+    {
+        return false;
+    }
+
+    registry.Fallbacks.emplace_back(baseFont, fallbackFont);
+    return true;
+}
+
+float nanovg_glyphcache::SdfFontSize(float fontSize)
+{
+    int size = static_cast<int>(fontSize);
+    int sdfFontSize = 32;
+
+    // We double the font size so that SDFs are also used for smaller font sizes
+    // For instance an SDF font size of 128 is used for the target font size range of 64-256
+    size *= 2;
+    // Reduce the font size to a powers of 4 after 32 (e.g. 32, 32*4, 32*4*4)
+    size /= sdfFontSize;
+    while (size /= 4) sdfFontSize *= 4;
+    return static_cast<float>(sdfFontSize);
+}
+
+nanovg_glyphcache::~nanovg_glyphcache()
+{
+    // Every context holding this instance is gone, and with it any unsubmitted draw.
+    for (auto& [size, entry] : m_atlases)
+    {
+        if (bgfx::isValid(entry.Texture))
+        {
+            bgfx::destroy(entry.Texture);
+        }
+        fonsDeleteInternal(entry.Stash);
+    }
+    DestroyRetiredTextures();
+
+    if (m_metrics != nullptr)
+    {
+        fonsDeleteInternal(m_metrics);
+    }
+}
+
+std::unique_lock<std::mutex> nanovg_glyphcache::Lock()
+{
+    std::unique_lock lock{m_mutex};
+    SyncFonts();
+    return lock;
+}
+
+FONScontext* nanovg_glyphcache::CreateStash(int width, int height)
+{
+    FONScontext* stash = CreateFontStash(width, height);
+    if (stash == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto& registry = Registry();
+    std::scoped_lock lock{registry.Mutex};
+    for (size_t i = 0; i < m_syncedFonts; ++i)
+    {
+        auto& font = *registry.Fonts[i];
+        fonsAddFontMem(stash, font.Name.c_str(), font.Data.data(), static_cast<int>(font.Data.size()), 0);
+    }
+    for (size_t i = 0; i < m_syncedFallbacks; ++i)
+    {
+        fonsAddFallbackFont(stash, registry.Fallbacks[i].first, registry.Fallbacks[i].second);
+    }
+    return stash;
+}
+
+// Brings every stash up to date with fonts registered since the last call. Stashes created in
+// between got the fonts synced at that point from CreateStash, so all of them are at the same
+// count.
+void nanovg_glyphcache::SyncFonts()
+{
+    auto& registry = Registry();
+    std::scoped_lock lock{registry.Mutex};
+    if (m_syncedFonts == registry.Fonts.size() && m_syncedFallbacks == registry.Fallbacks.size())
+    {
+        return;
+    }
+
+    auto sync = [&](FONScontext* stash) {
+        for (size_t i = m_syncedFonts; i < registry.Fonts.size(); ++i)
+        {
+            auto& font = *registry.Fonts[i];
+            fonsAddFontMem(stash, font.Name.c_str(), font.Data.data(), static_cast<int>(font.Data.size()), 0);
+        }
+        for (size_t i = m_syncedFallbacks; i < registry.Fallbacks.size(); ++i)
+        {
+            fonsAddFallbackFont(stash, registry.Fallbacks[i].first, registry.Fallbacks[i].second);
+        }
+    };
+
+    if (m_metrics != nullptr)
+    {
+        sync(m_metrics);
+    }
+    for (auto& [size, entry] : m_atlases)
+    {
+        sync(entry.Stash);
+    }
+
+    m_syncedFonts = registry.Fonts.size();
+    m_syncedFallbacks = registry.Fallbacks.size();
+}
+
+FONScontext* nanovg_glyphcache::Metrics()
+{
+    if (m_metrics == nullptr)
+    {
+        m_metrics = CreateStash(METRICS_ATLAS_SIZE, METRICS_ATLAS_SIZE);
+    }
+    return m_metrics;
+}
+
+FONScontext* nanovg_glyphcache::Atlas(float sdfFontSize)
+{
+    const int key = static_cast<int>(sdfFontSize);
+
+    auto it = m_atlases.find(key);
+    if (it == m_atlases.end())
+    {
+        FONScontext* stash = CreateStash(INITIAL_ATLAS_SIZE, INITIAL_ATLAS_SIZE);
+        if (stash == nullptr)
+        {
+            return nullptr;
+        }
+
+        AtlasEntry entry{};
+        entry.Stash = stash;
+        entry.Width = INITIAL_ATLAS_SIZE;
+        entry.Height = INITIAL_ATLAS_SIZE;
+        it = m_atlases.emplace(key, entry).first;
+
+        ++m_stats.Atlases;
+        m_stats.AtlasBytes += AtlasBytes(entry.Width, entry.Height);
+        EnforceBudget(key);
+    }
+
+    it->second.LastUsed = ++m_tick;
+    return it->second.Stash;
+}
+
+bool nanovg_glyphcache::MakeRoom(float sdfFontSize)
+{
+    const int key = static_cast<int>(sdfFontSize);
+    auto it = m_atlases.find(key);
+    if (it == m_atlases.end())
+    {
+        return false;
+    }
+
+    // Glyphs of a grown atlas move, and those of a reset one are overwritten, so the atlas
+    // always moves to a new texture and draws already recorded keep sampling the old one.
+    AtlasEntry& entry = it->second;
+    RetireTexture(entry);
+
+    if (entry.Width < MAX_ATLAS_SIZE || entry.Height < MAX_ATLAS_SIZE)
+    {
+        int width = entry.Width;
+        int height = entry.Height;
+        if (width > height)
+            height *= 2;
+        else
+            width *= 2;
+        width = std::min(width, MAX_ATLAS_SIZE);
+        height = std::min(height, MAX_ATLAS_SIZE);
+
+        if (fonsExpandAtlas(entry.Stash, width, height))
+        {
+            m_stats.AtlasBytes += AtlasBytes(width, height) - AtlasBytes(entry.Width, entry.Height);
+            entry.Width = width;
+            entry.Height = height;
+            ++m_stats.Growths;
+            EnforceBudget(key);
+            return true;
+        }
+    }
+
+    ++m_stats.Evictions;
+    return fonsResetAtlas(entry.Stash, entry.Width, entry.Height) != 0;
+}
+
+int nanovg_glyphcache::Upload(float sdfFontSize)
+{
+    auto it = m_atlases.find(static_cast<int>(sdfFontSize));
+    if (it == m_atlases.end())
+    {
+        return 0;
+    }
+
+    AtlasEntry& entry = it->second;
+    int width{};
+    int height{};
+    const unsigned char* data = fonsGetTextureData(entry.Stash, &width, &height);
+
+    int dirty[4]{};
+    const bool isDirty = fonsValidateTexture(entry.Stash, dirty) != 0;
+
+    if (!bgfx::isValid(entry.Texture))
+    {
+        const uint32_t size = static_cast<uint32_t>(width) * static_cast<uint32_t>(height);
+        entry.Texture = bgfx::createTexture2D(static_cast<uint16_t>(width), static_cast<uint16_t>(height), false, 1, bgfx::TextureFormat::R8, BGFX_SAMPLER_NONE, bgfx::copy(data, size));
+        if (!bgfx::isValid(entry.Texture))
+        {
+            return 0;
+        }
+
+        ++m_stats.Uploads;
+        m_stats.UploadedBytes += size;
+    }
+    else if (isDirty)
+    {
+        const int x = dirty[0];
+        const int y = dirty[1];
+        const int w = dirty[2] - dirty[0];
+        const int h = dirty[3] - dirty[1];
+
+        const bgfx::Memory* mem = bgfx::alloc(static_cast<uint32_t>(w * h));
+        for (int row = 0; row < h; ++row)
+        {
+            std::memcpy(mem->data + row * w, data + (y + row) * width + x, static_cast<size_t>(w));
+        }
+        bgfx::updateTexture2D(entry.Texture, 0, 0, static_cast<uint16_t>(x), static_cast<uint16_t>(y), static_cast<uint16_t>(w), static_cast<uint16_t>(h), mem);
+
+        ++m_stats.Uploads;
+        m_stats.UploadedBytes += mem->size;
+    }
+
+    return NVG_SHARED_IMAGE_BIT | entry.Texture.idx;
+}
+
+void nanovg_glyphcache::RecordingDraws(const void* recorder)
+{
+    if (std::find(m_recorders.begin(), m_recorders.end(), recorder) == m_recorders.end())
+    {
+        m_recorders.push_back(recorder);
+    }
+}
+
+void nanovg_glyphcache::SubmittedDraws(const void* recorder)
+{
+    std::scoped_lock lock{m_mutex};
+    m_recorders.erase(std::remove(m_recorders.begin(), m_recorders.end(), recorder), m_recorders.end());
+
+    // bgfx destroys a texture after rendering the frame it is destroyed in, so the draws just
+    // submitted still sample it.
+    for (auto it = m_retiredTextures.begin(); it != m_retiredTextures.end();)
+    {
+        auto& recorders = it->Recorders;
+        recorders.erase(std::remove(recorders.begin(), recorders.end(), recorder), recorders.end());
+        if (recorders.empty())
+        {
+            bgfx::destroy(it->Texture);
+            it = m_retiredTextures.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    m_stats.RetiredTextures = m_retiredTextures.size();
+}
+
+void nanovg_glyphcache::Prewarm(int fontId, const std::vector<float>& fontSizes, const std::string& characters)
+{
+    auto lock = Lock();
+    if (fontId < 0 || static_cast<size_t>(fontId) >= m_syncedFonts)
+    {
+        return;
+    }
+
+    for (const float fontSize : fontSizes)
+    {
+        const float sdfFontSize = SdfFontSize(fontSize);
+        FONScontext* stash = Atlas(sdfFontSize);
+        if (stash == nullptr)
+        {
+            continue;
+        }
+
+        fonsSetSize(stash, sdfFontSize);
+        fonsSetSpacing(stash, 0.f);
+        fonsSetBlur(stash, 0.f);
+        fonsSetAlign(stash, FONS_ALIGN_LEFT | FONS_ALIGN_BASELINE);
+        fonsSetFont(stash, fontId);
+
+        const char* string = characters.data();
+        const char* end = string + characters.size();
+        FONStextIter iter{};
+        FONStextIter prevIter{};
+        FONSquad quad{};
+        fonsTextIterInit(stash, &iter, 0, 0, string, end, FONS_GLYPH_BITMAP_REQUIRED);
+        prevIter = iter;
+        while (fonsTextIterNext(stash, &iter, &quad))
+        {
+            if (iter.prevGlyphIndex == -1)
+            {
+                if (!MakeRoom(sdfFontSize))
+                {
+                    break;
+                }
+                iter = prevIter;
+                fonsTextIterNext(stash, &iter, &quad);
+                if (iter.prevGlyphIndex == -1)
+                {
+                    break;
+                }
+            }
+            prevIter = iter;
+        }
+
+        Upload(sdfFontSize);
+    }
+}
+
+void nanovg_glyphcache::SetMemoryBudget(size_t bytes)
+{
+    std::scoped_lock lock{m_mutex};
+    m_memoryBudget = bytes;
+    EnforceBudget(-1);
+}
+
+void nanovg_glyphcache::FlushGraphicResources()
+{
+    // The draws recorded against the textures go with the device.
+    std::scoped_lock lock{m_mutex};
+    for (auto& [size, entry] : m_atlases)
+    {
+        if (bgfx::isValid(entry.Texture))
+        {
+            bgfx::destroy(entry.Texture);
+            entry.Texture = BGFX_INVALID_HANDLE;
+        }
+    }
+    DestroyRetiredTextures();
+}
+
+nanovg_glyphcache::Stats nanovg_glyphcache::GetStats()
+{
+    std::scoped_lock lock{m_mutex};
+
+    Stats stats{m_stats};
+    auto& registry = Registry();
+    std::scoped_lock registryLock{registry.Mutex};
+    stats.Fonts = registry.Fonts.size();
+    stats.FontBytes = 0;
+    for (const auto& font : registry.Fonts)
+    {
+        stats.FontBytes += font->Data.size();
+    }
+    return stats;
+}
+
+void nanovg_glyphcache::RetireTexture(AtlasEntry& entry)
+{
+    if (!bgfx::isValid(entry.Texture))
+    {
+        return;
+    }
+
+    if (m_recorders.empty())
+    {
+        bgfx::destroy(entry.Texture);
+    }
+    else
+    {
+        m_retiredTextures.push_back({entry.Texture, m_recorders});
+        m_stats.RetiredTextures = m_retiredTextures.size();
+    }
+    entry.Texture = BGFX_INVALID_HANDLE;
+}
+
+void nanovg_glyphcache::DestroyRetiredTextures()
+{
+    for (auto& retired : m_retiredTextures)
+    {
+        bgfx::destroy(retired.Texture);
+    }
+    m_retiredTextures.clear();
+    m_stats.RetiredTextures = 0;
+}
+
+// Destroys the least recently used atlases, other than `keep`, while over budget.
+void nanovg_glyphcache::EnforceBudget(int keep)
+{
+    while (m_stats.AtlasBytes > m_memoryBudget)
+    {
+        auto victim = m_atlases.end();
+        for (auto it = m_atlases.begin(); it != m_atlases.end(); ++it)
+        {
+            if (it->first != keep && (victim == m_atlases.end() || it->second.LastUsed < victim->second.LastUsed))
+            {
+                victim = it;
+            }
+        }
+        if (victim == m_atlases.end())
+        {
+            return;
+        }
+
+        RetireTexture(victim->second);
+        fonsDeleteInternal(victim->second.Stash);
+        m_stats.AtlasBytes -= AtlasBytes(victim->second.Width, victim->second.Height);
+        --m_stats.Atlases;
+        ++m_stats.Evictions;
+        m_atlases.erase(victim);
+    }
+}
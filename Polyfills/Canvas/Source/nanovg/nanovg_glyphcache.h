@@ -0,0 +1,147 @@
+#pragma once
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct FONScontext;
+
+// Fonts and glyph atlases shared by every nanovg context in the process, on any thread.
+//
+// Fonts are registered once, process wide, and have the same id in every context. Glyphs are
+// rasterized as SDFs at a few bucket sizes (see SdfFontSize), and each bucket has one fontstash
+// atlas and one texture, so a glyph is rasterized and uploaded once however many contexts draw
+// it. Atlases are grown when full, reset when full at the maximum size, and the least recently
+// used ones are destroyed to stay within the memory budget.
+//
+// fontstash keeps the text style (size, font, alignment) in the stash itself, so a caller holds
+// Lock() from setting the style until it is done with the stash and the atlas texture.
+//
+// Contexts record text draws against an atlas texture and only submit them at their next
+// nvgEndFrame, so a texture that is replaced (the atlas grew or was reset) or dropped (evicted)
+// is retired rather than destroyed: it stays alive until every context that had unsubmitted draws
+// at that point has submitted or discarded them.
+class nanovg_glyphcache
+{
+public:
+    struct Stats
+    {
+        // Fonts registered, and the bytes of font data they hold (once for the process).
+        size_t Fonts{};
+        size_t FontBytes{};
+
+        // Atlases alive, and the memory they hold, counting the CPU copy and the texture.
+        size_t Atlases{};
+        size_t AtlasBytes{};
+
+        // Atlases that filled up and were doubled, and atlases dropped: reset because they were
+        // full at the maximum size, or destroyed to stay within the budget.
+        uint64_t Growths{};
+        uint64_t Evictions{};
+
+        // Texture updates, and the bytes they uploaded.
+        uint64_t Uploads{};
+        uint64_t UploadedBytes{};
+
+        // Replaced or dropped textures still waiting for draws recorded against them.
+        size_t RetiredTextures{};
+    };
+
+    // The instance shared by everyone holding it, created on first use. Atlases and textures go
+    // with the last holder; fonts stay registered for the lifetime of the process.
+    static std::shared_ptr<nanovg_glyphcache> Get();
+
+    // Registers a font unless one with this name already is, and returns its id either way.
+    // Returns -1 (FONS_INVALID) if the data is not a font fontstash can load.
+    static int AddFont(const std::string& name, std::vector<uint8_t> data);
+    static int FindFont(const std::string& name);
+    static size_t GetFontCount();
+    static std::vector<std::pair<std::string, int>> GetFonts();
+    static bool AddFallbackFont(int baseFont, int fallbackFont);
+
+    // The SDF size glyphs are rasterized at for text drawn at `fontSize` pixels, which is also
+    // the bucket of the atlas they are stored in.
+    static float SdfFontSize(float fontSize);
+
+    nanovg_glyphcache() = default;
+    ~nanovg_glyphcache();
+
+    nanovg_glyphcache(const nanovg_glyphcache&) = delete;
+    nanovg_glyphcache& operator=(const nanovg_glyphcache&) = delete;
+
+    std::unique_lock<std::mutex> Lock();
+
+    // Lock() must be held for these.
+    // Stash for measuring text, which never rasterizes glyphs.
+    FONScontext* Metrics();
+    // Stash of the atlas for the bucket of `sdfFontSize`.
+    FONScontext* Atlas(float sdfFontSize);
+    // Called when a glyph did not fit in the atlas: grows it, or resets it at the maximum size.
+    bool MakeRoom(float sdfFontSize);
+    // Uploads the glyphs rasterized since the last upload, and returns the nanovg image of the
+    // atlas texture (see NVG_SHARED_IMAGE_BIT), or 0 if it could not be created.
+    int Upload(float sdfFontSize);
+    // Called before `recorder` records draws against an atlas texture, which it holds until it
+    // calls SubmittedDraws.
+    void RecordingDraws(const void* recorder);
+
+    // Rasterizes and uploads `characters` of `fontId` for text drawn at each of `fontSizes`.
+    // Takes the lock.
+    void Prewarm(int fontId, const std::vector<float>& fontSizes, const std::string& characters);
+
+    // Called once `recorder` has submitted or discarded its recorded draws. Destroys the textures
+    // retired while they were pending that no other recorder still uses. Takes the lock.
+    void SubmittedDraws(const void* recorder);
+
+    void SetMemoryBudget(size_t bytes);
+
+    // Destroys the atlas textures, which are recreated from the glyphs kept on the CPU when
+    // next used. Called when the graphics device goes away.
+    void FlushGraphicResources();
+
+    Stats GetStats();
+
+private:
+    struct AtlasEntry
+    {
+        FONScontext* Stash{};
+        bgfx::TextureHandle Texture{bgfx::kInvalidHandle};
+        int Width{};
+        int Height{};
+        uint64_t LastUsed{};
+    };
+
+    struct RetiredTexture
+    {
+        bgfx::TextureHandle Texture{bgfx::kInvalidHandle};
+        // Recorders whose draws may use the texture and are not submitted yet.
+        std::vector<const void*> Recorders{};
+    };
+
+    FONScontext* CreateStash(int width, int height);
+    void SyncFonts();
+    void RetireTexture(AtlasEntry& entry);
+    void DestroyRetiredTextures();
+    void EnforceBudget(int keep);
+
+    std::mutex m_mutex{};
+
+    FONScontext* m_metrics{};
+    std::map<int, AtlasEntry> m_atlases{};
+
+    // Recorders that may hold unsubmitted draws of an atlas texture.
+    std::vector<const void*> m_recorders{};
+    std::vector<RetiredTexture> m_retiredTextures{};
+
+    // Stashes of this instance hold the first m_syncedFonts fonts and m_syncedFallbacks fallbacks.
+    size_t m_syncedFonts{};
+    size_t m_syncedFallbacks{};
+
+    size_t m_memoryBudget{32 * 1024 * 1024};
+    uint64_t m_tick{};
+    Stats m_stats{};
+};